@@ -0,0 +1,149 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#define _DEFAULT_SOURCE
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/condition.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "linux_time.h"
+#include "linux_futex.h"
+
+DEFINE_ENUM_STRINGS(COND_RESULT, COND_RESULT_VALUES);
+
+/* the companion of lock_futex.c, whose LOCK_HANDLE is not a pthread_mutex_t.
+   A waiter sleeps on the sequence it read while holding the lock, every post moves the sequence,
+   so a post that lands between Unlock and the futex wait is not lost. */
+typedef struct CONDITION_TAG
+{
+    volatile uint32_t sequence;
+} CONDITION;
+
+COND_HANDLE Condition_Init(void)
+{
+    // Codes_SRS_CONDITION_18_002: [ Condition_Init shall create and return a CONDITION_HANDLE ]
+    // Codes_SRS_CONDITION_18_008: [ Condition_Init shall return NULL if it fails to allocate the CONDITION_HANDLE ]
+    CONDITION* cond = (CONDITION*)malloc(sizeof(CONDITION));
+    if (cond == NULL)
+    {
+        LogError("Failed to allocate condition handle");
+    }
+    else
+    {
+        cond->sequence = 0;
+    }
+    return (COND_HANDLE)cond;
+}
+
+COND_RESULT Condition_Post(COND_HANDLE handle)
+{
+    COND_RESULT result;
+    // Codes_SRS_CONDITION_18_001: [ Condition_Post shall return COND_INVALID_ARG if handle is NULL ]
+    if (handle == NULL)
+    {
+        result = COND_INVALID_ARG;
+    }
+    else
+    {
+        CONDITION* cond = (CONDITION*)handle;
+        (void)__atomic_add_fetch(&cond->sequence, 1, __ATOMIC_SEQ_CST);
+        // Codes_SRS_CONDITION_18_003: [ Condition_Post shall return COND_OK if it succcessfully posts the condition ]
+        if (futex_wake(&cond->sequence, 1) < 0)
+        {
+            LogError("Failed to wake a waiter, errno %d", errno);
+            result = COND_ERROR;
+        }
+        else
+        {
+            result = COND_OK;
+        }
+    }
+    return result;
+}
+
+COND_RESULT Condition_WaitNanoseconds(COND_HANDLE handle, LOCK_HANDLE lock, uint64_t timeout_nanoseconds)
+{
+    COND_RESULT result;
+    // Codes_SRS_CONDITION_99_001: [ Condition_WaitNanoseconds shall return COND_INVALID_ARG if handle or lock is NULL ]
+    if (handle == NULL || lock == NULL)
+    {
+        result = COND_INVALID_ARG;
+    }
+    else
+    {
+        CONDITION* cond = (CONDITION*)handle;
+        uint32_t sequence = __atomic_load_n(&cond->sequence, __ATOMIC_SEQ_CST);
+
+        if (Unlock(lock) != LOCK_OK)
+        {
+            LogError("Invalid lock passed which failed to unlock");
+            result = COND_ERROR;
+        }
+        else
+        {
+            int wait_result;
+            int wait_errno;
+
+            if (timeout_nanoseconds > 0)
+            {
+                // Codes_SRS_CONDITION_99_002: [ Condition_WaitNanoseconds shall measure timeout_nanoseconds on a monotonic clock when the platform has one ]
+                const time_t max_seconds = (sizeof(time_t) == 4) ? (time_t)INT32_MAX : (time_t)INT64_MAX;
+                struct timespec relative;
+                relative.tv_sec = (timeout_nanoseconds / NANOSECONDS_IN_1_SECOND >= (uint64_t)max_seconds) ? max_seconds : (time_t)(timeout_nanoseconds / NANOSECONDS_IN_1_SECOND);
+                relative.tv_nsec = (long)(timeout_nanoseconds % NANOSECONDS_IN_1_SECOND);
+                wait_result = futex_wait(&cond->sequence, sequence, &relative);
+            }
+            else
+            {
+                wait_result = futex_wait(&cond->sequence, sequence, NULL);
+            }
+            wait_errno = errno;
+
+            (void)Lock(lock);
+
+            if ((wait_result != 0) && (wait_errno == ETIMEDOUT))
+            {
+                // Codes_SRS_CONDITION_99_004: [ Condition_WaitNanoseconds shall return COND_TIMEOUT if the condition is NOT triggered and timeout_nanoseconds is not 0 ]
+                result = COND_TIMEOUT;
+            }
+            else if ((wait_result != 0) && (wait_errno != EAGAIN) && (wait_errno != EINTR))
+            {
+                LogError("Failed to wait on the condition, errno %d", wait_errno);
+                result = COND_ERROR;
+            }
+            else
+            {
+                /* EAGAIN: a post moved the sequence before the wait started, EINTR is a spurious wake up */
+                // Codes_SRS_CONDITION_99_003: [ Condition_WaitNanoseconds shall return COND_OK if the condition is triggered ]
+                result = COND_OK;
+            }
+        }
+    }
+    return result;
+}
+
+COND_RESULT Condition_Wait(COND_HANDLE handle, LOCK_HANDLE lock, int timeout_milliseconds)
+{
+    // Codes_SRS_CONDITION_18_004: [ Condition_Wait shall return COND_INVALID_ARG if handle is NULL ]
+    // Codes_SRS_CONDITION_18_005: [ Condition_Wait shall return COND_INVALID_ARG if lock is NULL and timeout_milliseconds is 0 ]
+    // Codes_SRS_CONDITION_18_006: [ Condition_Wait shall return COND_INVALID_ARG if lock is NULL and timeout_milliseconds is not 0 ]
+    // Codes_SRS_CONDITION_18_010: [ Condition_Wait shall return COND_OK if the condition is triggered and timeout_milliseconds is 0 ]
+    // Codes_SRS_CONDITION_18_011: [ Condition_Wait shall return COND_TIMEOUT if the condition is NOT triggered and timeout_milliseconds is not 0 ]
+    // Codes_SRS_CONDITION_18_012: [ Condition_Wait shall return COND_OK if the condition is triggered and timeout_milliseconds is not 0 ]
+    // Codes_SRS_CONDITION_18_013: [ Condition_Wait shall accept relative timeouts ]
+    return Condition_WaitNanoseconds(handle, lock, (timeout_milliseconds > 0) ? (uint64_t)timeout_milliseconds * NANOSECONDS_IN_1_MILLISECOND : 0);
+}
+
+void Condition_Deinit(COND_HANDLE handle)
+{
+    // Codes_SRS_CONDITION_18_007: [ Condition_Deinit will not fail if handle is NULL ]
+    if (handle != NULL)
+    {
+        // Codes_SRS_CONDITION_18_009: [ Condition_Deinit will deallocate handle if it is not NULL
+        free(handle);
+    }
+}
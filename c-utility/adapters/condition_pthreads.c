@@ -2,6 +2,7 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
+#include <stdint.h>
 #include "azure_c_shared_utility/lock.h"
 #include "azure_c_shared_utility/condition.h"
 #include "azure_c_shared_utility/xlogging.h"
@@ -13,32 +14,111 @@
 
 DEFINE_ENUM_STRINGS(COND_RESULT, COND_RESULT_VALUES);
 
-pthread_cond_t* create_cond(void)
+typedef struct CONDITION_TAG
 {
-    pthread_cond_t * cond = (pthread_cond_t*)malloc(sizeof(pthread_cond_t));
-    if (cond != NULL)
+    pthread_cond_t cond;
+#ifndef __MACH__
+    /* the clock pthread_cond_timedwait compares the deadline with, it is CLOCK_MONOTONIC unless the platform refused it */
+    clockid_t clock;
+#endif
+} CONDITION;
+
+static CONDITION* create_cond(void)
+{
+    CONDITION* cond = (CONDITION*)malloc(sizeof(CONDITION));
+    if (cond == NULL)
+    {
+        LogError("Failed to allocate condition handle");
+    }
+    else
     {
 #ifdef __MACH__
-        pthread_cond_init(cond, NULL);
+        /* OSX has no pthread_condattr_setclock, timed waits use pthread_cond_timedwait_relative_np instead */
+        if (pthread_cond_init(&cond->cond, NULL) != 0)
+        {
+            LogError("pthread_cond_init failed");
+            free(cond);
+            cond = NULL;
+        }
 #else
         pthread_condattr_t cattr;
-        pthread_condattr_init(&cattr);
-        pthread_condattr_setclock(&cattr, time_basis);
-        pthread_cond_init(cond, &cattr);
-        pthread_condattr_destroy(&cattr);
+        if (pthread_condattr_init(&cattr) != 0)
+        {
+            LogError("pthread_condattr_init failed");
+            free(cond);
+            cond = NULL;
+        }
+        else
+        {
+            /* a deadline on the realtime clock moves with every NTP step, fall back to it only when the monotonic clock is refused */
+#if defined(CLOCK_MONOTONIC)
+            if (pthread_condattr_setclock(&cattr, CLOCK_MONOTONIC) == 0)
+            {
+                cond->clock = CLOCK_MONOTONIC;
+            }
+            else
+#endif
+            {
+                LogInfo("the monotonic clock is not available for condition variables, timed waits follow the realtime clock");
+                (void)pthread_condattr_setclock(&cattr, CLOCK_REALTIME);
+                cond->clock = CLOCK_REALTIME;
+            }
+
+            if (pthread_cond_init(&cond->cond, &cattr) != 0)
+            {
+                LogError("pthread_cond_init failed");
+                free(cond);
+                cond = NULL;
+            }
+            (void)pthread_condattr_destroy(&cattr);
+        }
 #endif
     }
 
     return cond;
 }
 
-COND_HANDLE Condition_Init(void)
+#ifndef __MACH__
+static int get_deadline(clockid_t clock, uint64_t timeout_nanoseconds, struct timespec* deadline)
 {
-    set_time_basis();
+    int result;
+    if (clock_gettime(clock, deadline) != 0)
+    {
+        LogError("Failed to get the current time");
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* the largest time_t, a deadline past it waits as long as the platform can express */
+        const time_t max_seconds = (sizeof(time_t) == 4) ? (time_t)INT32_MAX : (time_t)INT64_MAX;
+        uint64_t seconds = timeout_nanoseconds / NANOSECONDS_IN_1_SECOND;
+
+        deadline->tv_nsec += (long)(timeout_nanoseconds % NANOSECONDS_IN_1_SECOND);
+        if (deadline->tv_nsec >= NANOSECONDS_IN_1_SECOND)
+        {
+            deadline->tv_nsec -= NANOSECONDS_IN_1_SECOND;
+            seconds++;
+        }
+
+        if (seconds >= (uint64_t)(max_seconds - deadline->tv_sec))
+        {
+            deadline->tv_sec = max_seconds;
+        }
+        else
+        {
+            deadline->tv_sec += (time_t)seconds;
+        }
+        result = 0;
+    }
+    return result;
+}
+#endif
 
+COND_HANDLE Condition_Init(void)
+{
     // Codes_SRS_CONDITION_18_002: [ Condition_Init shall create and return a CONDITION_HANDLE ]
     // Codes_SRS_CONDITION_18_008: [ Condition_Init shall return NULL if it fails to allocate the CONDITION_HANDLE ]
-    return create_cond();
+    return (COND_HANDLE)create_cond();
 }
 
 COND_RESULT Condition_Post(COND_HANDLE handle)
@@ -52,7 +132,7 @@ COND_RESULT Condition_Post(COND_HANDLE handle)
     else
     {
         // Codes_SRS_CONDITION_18_003: [ Condition_Post shall return COND_OK if it succcessfully posts the condition ]
-        if (pthread_cond_signal((pthread_cond_t*)handle) == 0)
+        if (pthread_cond_signal(&((CONDITION*)handle)->cond) == 0)
         {
             result = COND_OK;
         }
@@ -64,77 +144,83 @@ COND_RESULT Condition_Post(COND_HANDLE handle)
     return result;
 }
 
-COND_RESULT Condition_Wait(COND_HANDLE handle, LOCK_HANDLE lock, int timeout_milliseconds)
+COND_RESULT Condition_WaitNanoseconds(COND_HANDLE handle, LOCK_HANDLE lock, uint64_t timeout_nanoseconds)
 {
     COND_RESULT result;
-    // Codes_SRS_CONDITION_18_004: [ Condition_Wait shall return COND_INVALID_ARG if handle is NULL ]
-    // Codes_SRS_CONDITION_18_005: [ Condition_Wait shall return COND_INVALID_ARG if lock is NULL and timeout_milliseconds is 0 ]
-    // Codes_SRS_CONDITION_18_006: [ Condition_Wait shall return COND_INVALID_ARG if lock is NULL and timeout_milliseconds is not 0 ]
+    // Codes_SRS_CONDITION_99_001: [ Condition_WaitNanoseconds shall return COND_INVALID_ARG if handle or lock is NULL ]
     if (handle == NULL || lock == NULL)
     {
         result = COND_INVALID_ARG;
     }
     else
     {
-        if (timeout_milliseconds > 0)
-        {
-            // Codes_SRS_CONDITION_18_013: [ Condition_Wait shall accept relative timeouts ]
-            struct timespec tm;
-            if (get_time_ns(&tm) != 0)
-            {
-                LogError("Failed to get the current time");
-                return COND_ERROR;
-            }
+        CONDITION* cond = (CONDITION*)handle;
+        int wait_result;
 
-            tm.tv_nsec += (timeout_milliseconds % MILLISECONDS_IN_1_SECOND) * NANOSECONDS_IN_1_MILLISECOND;
-            tm.tv_sec += timeout_milliseconds / MILLISECONDS_IN_1_SECOND;
-            // handle overflow in tv_nsec
-            tm.tv_sec+= tm.tv_nsec / NANOSECONDS_IN_1_SECOND;
-            tm.tv_nsec %= NANOSECONDS_IN_1_SECOND;
-            int wait_result = pthread_cond_timedwait((pthread_cond_t *)handle, (pthread_mutex_t *)lock, &tm);
-            if (wait_result == ETIMEDOUT)
-            {
-                // Codes_SRS_CONDITION_18_011: [ Condition_Wait shall return COND_TIMEOUT if the condition is NOT triggered and timeout_milliseconds is not 0 ]
-                return COND_TIMEOUT;
-            }
-            else if (wait_result == 0)
+        if (timeout_nanoseconds > 0)
+        {
+            // Codes_SRS_CONDITION_99_002: [ Condition_WaitNanoseconds shall measure timeout_nanoseconds on a monotonic clock when the platform has one ]
+#ifdef __MACH__
+            struct timespec relative;
+            relative.tv_sec = (time_t)(timeout_nanoseconds / NANOSECONDS_IN_1_SECOND);
+            relative.tv_nsec = (long)(timeout_nanoseconds % NANOSECONDS_IN_1_SECOND);
+            wait_result = pthread_cond_timedwait_relative_np(&cond->cond, (pthread_mutex_t *)lock, &relative);
+#else
+            struct timespec deadline;
+            if (get_deadline(cond->clock, timeout_nanoseconds, &deadline) != 0)
             {
-                // Codes_SRS_CONDITION_18_012: [ Condition_Wait shall return COND_OK if the condition is triggered and timeout_milliseconds is not 0 ]
-                result = COND_OK;
+                wait_result = EINVAL;
             }
             else
             {
-                LogError("Failed to pthread_cond_timedwait");
-                return COND_ERROR;
+                wait_result = pthread_cond_timedwait(&cond->cond, (pthread_mutex_t *)lock, &deadline);
             }
+#endif
         }
         else
         {
-            if (pthread_cond_wait((pthread_cond_t*)handle, (pthread_mutex_t *)lock) != 0)
-            {
-                LogError("Failed to pthread_cond_wait");
-                return COND_ERROR;
-            }
-            else
-            {
-                // Codes_SRS_CONDITION_18_010: [ Condition_Wait shall return COND_OK if the condition is triggered and timeout_milliseconds is 0 ]
-                result = COND_OK;
-            }
+            wait_result = pthread_cond_wait(&cond->cond, (pthread_mutex_t *)lock);
+        }
+
+        if (wait_result == 0)
+        {
+            // Codes_SRS_CONDITION_99_003: [ Condition_WaitNanoseconds shall return COND_OK if the condition is triggered ]
+            result = COND_OK;
+        }
+        else if (wait_result == ETIMEDOUT)
+        {
+            // Codes_SRS_CONDITION_99_004: [ Condition_WaitNanoseconds shall return COND_TIMEOUT if the condition is NOT triggered and timeout_nanoseconds is not 0 ]
+            result = COND_TIMEOUT;
+        }
+        else
+        {
+            LogError("Failed to wait on the condition, error %d", wait_result);
+            result = COND_ERROR;
         }
     }
     return result;
 }
 
+COND_RESULT Condition_Wait(COND_HANDLE handle, LOCK_HANDLE lock, int timeout_milliseconds)
+{
+    // Codes_SRS_CONDITION_18_004: [ Condition_Wait shall return COND_INVALID_ARG if handle is NULL ]
+    // Codes_SRS_CONDITION_18_005: [ Condition_Wait shall return COND_INVALID_ARG if lock is NULL and timeout_milliseconds is 0 ]
+    // Codes_SRS_CONDITION_18_006: [ Condition_Wait shall return COND_INVALID_ARG if lock is NULL and timeout_milliseconds is not 0 ]
+    // Codes_SRS_CONDITION_18_010: [ Condition_Wait shall return COND_OK if the condition is triggered and timeout_milliseconds is 0 ]
+    // Codes_SRS_CONDITION_18_011: [ Condition_Wait shall return COND_TIMEOUT if the condition is NOT triggered and timeout_milliseconds is not 0 ]
+    // Codes_SRS_CONDITION_18_012: [ Condition_Wait shall return COND_OK if the condition is triggered and timeout_milliseconds is not 0 ]
+    // Codes_SRS_CONDITION_18_013: [ Condition_Wait shall accept relative timeouts ]
+    return Condition_WaitNanoseconds(handle, lock, (timeout_milliseconds > 0) ? (uint64_t)timeout_milliseconds * NANOSECONDS_IN_1_MILLISECOND : 0);
+}
+
 void Condition_Deinit(COND_HANDLE handle)
 {
 // Codes_SRS_CONDITION_18_007: [ Condition_Deinit will not fail if handle is NULL ]
     if (handle != NULL)
     {
-        // Codes_SRS_CONDITION_18_009: [ Condition_Deinit will deallocate handle if it is not NULL 
-        pthread_cond_t* cond = (pthread_cond_t*)handle;
-        pthread_cond_destroy(cond);
+        // Codes_SRS_CONDITION_18_009: [ Condition_Deinit will deallocate handle if it is not NULL
+        CONDITION* cond = (CONDITION*)handle;
+        pthread_cond_destroy(&cond->cond);
         free(cond);
     }
 }
-
-
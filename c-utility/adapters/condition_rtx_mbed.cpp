@@ -39,6 +39,20 @@ COND_RESULT Condition_Wait(COND_HANDLE  handle, LOCK_HANDLE lock, int timeout_mi
     return result;
 }
 
+COND_RESULT Condition_WaitNanoseconds(COND_HANDLE handle, LOCK_HANDLE lock, uint64_t timeout_nanoseconds)
+{
+    COND_RESULT result;
+    if (handle == NULL)
+    {
+        result = COND_INVALID_ARG;
+    }
+    else
+    {
+        result = COND_ERROR;
+    }
+    return result;
+}
+
 void Condition_Deinit(COND_HANDLE handle)
 {
     if (handle != NULL)
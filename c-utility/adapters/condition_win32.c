@@ -2,6 +2,8 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
 
 #include "azure_c_shared_utility/condition.h"
 #include "windows.h"
@@ -138,6 +140,19 @@ COND_RESULT Condition_Wait(COND_HANDLE handle, LOCK_HANDLE lock, int timeout_mil
     return result;
 }
 
+COND_RESULT Condition_WaitNanoseconds(COND_HANDLE handle, LOCK_HANDLE lock, uint64_t timeout_nanoseconds)
+{
+    /* WaitForSingleObject counts its timeout on the tick count, steps of the wall clock do not move it.
+       The timeout is rounded up so that a short wait never becomes a wait without timeout. */
+    uint64_t timeout_milliseconds = (timeout_nanoseconds / 1000000) + ((timeout_nanoseconds % 1000000) != 0 ? 1 : 0);
+
+    // Codes_SRS_CONDITION_99_001: [ Condition_WaitNanoseconds shall return COND_INVALID_ARG if handle or lock is NULL ]
+    // Codes_SRS_CONDITION_99_002: [ Condition_WaitNanoseconds shall measure timeout_nanoseconds on a monotonic clock when the platform has one ]
+    // Codes_SRS_CONDITION_99_003: [ Condition_WaitNanoseconds shall return COND_OK if the condition is triggered ]
+    // Codes_SRS_CONDITION_99_004: [ Condition_WaitNanoseconds shall return COND_TIMEOUT if the condition is NOT triggered and timeout_nanoseconds is not 0 ]
+    return Condition_Wait(handle, lock, (timeout_milliseconds > INT_MAX) ? INT_MAX : (int)timeout_milliseconds);
+}
+
 void Condition_Deinit(COND_HANDLE handle)
 {
     // Codes_SRS_CONDITION_18_007: [ Condition_Deinit will not fail if handle is NULL ]
@@ -24,20 +24,23 @@
 /*Codes_SRS_HTTPAPI_COMPACT_21_002: [ The httpapi_compact shall support the http requests. ]*/
 /*Codes_SRS_HTTPAPI_COMPACT_21_003: [ The httpapi_compact shall return error codes defined by HTTPAPI_RESULT. ]*/
 #include "azure_c_shared_utility/httpapi.h"
+#include "httpapi_streaming.h"
 
 #define MAX_HOSTNAME     64
 #define TEMP_BUFFER_SIZE 1024
+#define CHUNK_HEADER_MAX_SIZE 10 /*up to 8 hexadecimal digits and \r\n*/
 
 /*Codes_SRS_HTTPAPI_COMPACT_21_077: [ The HTTPAPI_ExecuteRequest shall wait, at least, 10 seconds for the SSL open process. ]*/
-#define MAX_OPEN_RETRY   100
+#define OPEN_TIMEOUT_IN_MILLISECONDS   10000
 /*Codes_SRS_HTTPAPI_COMPACT_21_084: [ The HTTPAPI_CloseConnection shall wait, at least, 10 seconds for the SSL close process. ]*/
-#define MAX_CLOSE_RETRY   100
+#define CLOSE_TIMEOUT_IN_MILLISECONDS   10000
 /*Codes_SRS_HTTPAPI_COMPACT_21_079: [ The HTTPAPI_ExecuteRequest shall wait, at least, 20 seconds to send a buffer using the SSL connection. ]*/
-#define MAX_SEND_RETRY   200
+#define SEND_TIMEOUT_IN_MILLISECONDS   20000
 /*Codes_SRS_HTTPAPI_COMPACT_21_081: [ The HTTPAPI_ExecuteRequest shall try to read the message with the response up to 20 seconds. ]*/
-#define MAX_RECEIVE_RETRY   200
-/*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall wait, at least, 100 milliseconds between retries. ]*/
-#define RETRY_INTERVAL_IN_MICROSECONDS  100
+#define RECEIVE_TIMEOUT_IN_MILLISECONDS   20000
+/*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall retry without waiting while the transport delivers bytes, otherwise it shall wait between retries starting with 1 millisecond and doubling up to 10 milliseconds. ]*/
+#define MIN_RETRY_INTERVAL_IN_MILLISECONDS  1
+#define MAX_RETRY_INTERVAL_IN_MILLISECONDS  10
 
 DEFINE_ENUM_STRINGS(HTTPAPI_RESULT, HTTPAPI_RESULT_VALUES)
 
@@ -48,12 +51,56 @@ typedef struct HTTP_HANDLE_DATA_TAG
     char*           x509ClientPrivateKey;
     XIO_HANDLE      xio_handle;
     size_t          received_bytes_count;
+    size_t          received_bytes_offset;
     unsigned char*  received_bytes;
     unsigned int    is_io_error : 1;
     unsigned int    is_connected : 1;
     unsigned int    send_completed : 1;
 } HTTP_HANDLE_DATA;
 
+/*the xio callbacks run inside xio_dowork on the calling thread, so waiting for the transport means calling xio_dowork
+  again. The wait starts short and grows while nothing happens, so a reply that is already on the way is picked up
+  within a millisecond or two and an idle transport is not polled harder than every MAX_RETRY_INTERVAL_IN_MILLISECONDS.
+  Only the time spent sleeping counts toward the timeout.*/
+typedef struct RETRY_WAIT_TAG
+{
+    unsigned int    interval;
+    unsigned int    waited;
+    unsigned int    timeout;
+} RETRY_WAIT;
+
+static void retry_wait_init(RETRY_WAIT* retry_wait, unsigned int timeout)
+{
+    retry_wait->interval = MIN_RETRY_INTERVAL_IN_MILLISECONDS;
+    retry_wait->waited = 0;
+    retry_wait->timeout = timeout;
+}
+
+static void retry_wait_restart(RETRY_WAIT* retry_wait)
+{
+    retry_wait->interval = MIN_RETRY_INTERVAL_IN_MILLISECONDS;
+}
+
+/*returns false, without sleeping, once the timeout is spent*/
+static bool retry_wait_sleep(RETRY_WAIT* retry_wait)
+{
+    bool result;
+
+    if (retry_wait->waited >= retry_wait->timeout)
+    {
+        result = false;
+    }
+    else
+    {
+        ThreadAPI_Sleep(retry_wait->interval);
+        retry_wait->waited += retry_wait->interval;
+        retry_wait->interval = ((retry_wait->interval * 2) > MAX_RETRY_INTERVAL_IN_MILLISECONDS) ? MAX_RETRY_INTERVAL_IN_MILLISECONDS : (retry_wait->interval * 2);
+        result = true;
+    }
+
+    return result;
+}
+
 /*the following function does the same as sscanf(pos2, "%d", &sec)*/
 /*this function only exists because some of platforms do not have sscanf. */
 static int ParseStringToDecimal(const char *src, int* dst)
@@ -239,6 +286,7 @@ HTTP_HANDLE HTTPAPI_CreateConnection(const char* hostName)
                 http_instance->is_connected = 0;
                 http_instance->is_io_error = 0;
                 http_instance->received_bytes_count = 0;
+                http_instance->received_bytes_offset = 0;
                 http_instance->received_bytes = NULL;
                 http_instance->certificate = NULL;
                 http_instance->x509ClientCertificate = NULL;
@@ -261,50 +309,55 @@ static void on_io_close_complete(void* context)
     }
 }
 
-void HTTPAPI_CloseConnection(HTTP_HANDLE handle)
+static void CloseXIOConnection(HTTP_HANDLE_DATA* http_instance)
 {
-    HTTP_HANDLE_DATA* http_instance = (HTTP_HANDLE_DATA*)handle;
-
-    /*Codes_SRS_HTTPAPI_COMPACT_21_020: [ If the connection handle is NULL, the HTTPAPI_CloseConnection shall not do anything. ]*/
-    if (http_instance != NULL)
+    http_instance->is_io_error = 0;
+    /*Codes_SRS_HTTPAPI_COMPACT_21_017: [ The HTTPAPI_CloseConnection shall close the connection previously created in HTTPAPI_ExecuteRequest. ]*/
+    if (xio_close(http_instance->xio_handle, on_io_close_complete, http_instance) != 0)
     {
-        /*Codes_SRS_HTTPAPI_COMPACT_21_019: [ If there is no previous connection, the HTTPAPI_CloseConnection shall not do anything. ]*/
-        if (http_instance->xio_handle != NULL)
+        LogError("The SSL got error closing the connection");
+        /*Codes_SRS_HTTPAPI_COMPACT_21_087: [ If the xio return anything different than 0, the HTTPAPI_CloseConnection shall destroy the connection anyway. ]*/
+        http_instance->is_connected = 0;
+    }
+    else
+    {
+        RETRY_WAIT retry_wait;
+        /*Codes_SRS_HTTPAPI_COMPACT_21_084: [ The HTTPAPI_CloseConnection shall wait, at least, 10 seconds for the SSL close process. ]*/
+        retry_wait_init(&retry_wait, CLOSE_TIMEOUT_IN_MILLISECONDS);
+        while (http_instance->is_connected == 1)
         {
-            http_instance->is_io_error = 0;
-            /*Codes_SRS_HTTPAPI_COMPACT_21_017: [ The HTTPAPI_CloseConnection shall close the connection previously created in HTTPAPI_ExecuteRequest. ]*/
-            if (xio_close(http_instance->xio_handle, on_io_close_complete, http_instance) != 0)
+            xio_dowork(http_instance->xio_handle);
+            if (http_instance->is_io_error == 1)
             {
                 LogError("The SSL got error closing the connection");
-                /*Codes_SRS_HTTPAPI_COMPACT_21_087: [ If the xio return anything different than 0, the HTTPAPI_CloseConnection shall destroy the connection anyway. ]*/
                 http_instance->is_connected = 0;
             }
-            else
+            else if (http_instance->is_connected == 1)
             {
-                /*Codes_SRS_HTTPAPI_COMPACT_21_084: [ The HTTPAPI_CloseConnection shall wait, at least, 10 seconds for the SSL close process. ]*/
-                int countRetry = MAX_CLOSE_RETRY;
-                while (http_instance->is_connected == 1)
+                LogInfo("Waiting for TLS close connection");
+                /*Codes_SRS_HTTPAPI_COMPACT_21_086: [ The HTTPAPI_CloseConnection shall wait between retries starting with 1 millisecond and doubling up to 10 milliseconds. ]*/
+                if (!retry_wait_sleep(&retry_wait))
                 {
-                    xio_dowork(http_instance->xio_handle);
-                    if ((countRetry--) < 0)
-                    {
-                        /*Codes_SRS_HTTPAPI_COMPACT_21_085: [ If the HTTPAPI_CloseConnection retries 10 seconds to close the connection without success, it shall destroy the connection anyway. ]*/
-                        LogError("Close timeout. The SSL didn't close the connection");
-                        http_instance->is_connected = 0;
-                    }
-                    else if (http_instance->is_io_error == 1)
-                    {
-                        LogError("The SSL got error closing the connection");
-                        http_instance->is_connected = 0;
-                    }
-                    else if (http_instance->is_connected == 1)
-                    {
-                        LogInfo("Waiting for TLS close connection");
-                        /*Codes_SRS_HTTPAPI_COMPACT_21_086: [ The HTTPAPI_CloseConnection shall wait, at least, 100 milliseconds between retries. ]*/
-                        ThreadAPI_Sleep(RETRY_INTERVAL_IN_MICROSECONDS);
-                    }
+                    /*Codes_SRS_HTTPAPI_COMPACT_21_085: [ If the HTTPAPI_CloseConnection retries 10 seconds to close the connection without success, it shall destroy the connection anyway. ]*/
+                    LogError("Close timeout. The SSL didn't close the connection");
+                    http_instance->is_connected = 0;
                 }
             }
+        }
+    }
+}
+
+void HTTPAPI_CloseConnection(HTTP_HANDLE handle)
+{
+    HTTP_HANDLE_DATA* http_instance = (HTTP_HANDLE_DATA*)handle;
+
+    /*Codes_SRS_HTTPAPI_COMPACT_21_020: [ If the connection handle is NULL, the HTTPAPI_CloseConnection shall not do anything. ]*/
+    if (http_instance != NULL)
+    {
+        /*Codes_SRS_HTTPAPI_COMPACT_21_019: [ If there is no previous connection, the HTTPAPI_CloseConnection shall not do anything. ]*/
+        if (http_instance->xio_handle != NULL)
+        {
+            CloseXIOConnection(http_instance);
             /*Codes_SRS_HTTPAPI_COMPACT_21_076: [ After close the connection, The HTTPAPI_CloseConnection shall destroy the connection previously created in HTTPAPI_CreateConnection. ]*/
             xio_destroy(http_instance->xio_handle);
         }
@@ -409,6 +462,13 @@ static void on_bytes_received(void* context, const unsigned char* buffer, size_t
         }
         else
         {
+            /* Consumed bytes are only skipped by the readers, so move what is left to the front before growing the buffer */
+            if (http_instance->received_bytes_offset != 0)
+            {
+                (void)memmove(http_instance->received_bytes, http_instance->received_bytes + http_instance->received_bytes_offset, http_instance->received_bytes_count);
+                http_instance->received_bytes_offset = 0;
+            }
+
             /* Here we got some bytes so we'll buffer them so the receive functions can consumer it */
             new_received_bytes = (unsigned char*)realloc(http_instance->received_bytes, http_instance->received_bytes_count + size);
             if (new_received_bytes == NULL)
@@ -443,6 +503,43 @@ static void on_io_error(void* context)
     }
 }
 
+/*returns true when xio_dowork delivered new bytes, in which case the caller shall look at them before waiting again*/
+static bool conn_receive_dowork(HTTP_HANDLE_DATA* http_instance)
+{
+    size_t received_bytes_count = http_instance->received_bytes_count;
+
+    xio_dowork(http_instance->xio_handle);
+
+    return (http_instance->received_bytes_count != received_bytes_count);
+}
+
+static void conn_receive_discard_buffer(HTTP_HANDLE_DATA* http_instance)
+{
+    if (http_instance != NULL)
+    {
+        if (http_instance->received_bytes != NULL)
+        {
+            free(http_instance->received_bytes);
+            http_instance->received_bytes = NULL;
+        }
+        http_instance->received_bytes_count = 0;
+        http_instance->received_bytes_offset = 0;
+    }
+}
+
+static void conn_receive_consume(HTTP_HANDLE_DATA* http_instance, size_t size)
+{
+    /* Consuming bytes only moves the offset, the remaining bytes are moved once, when more bytes arrive */
+    http_instance->received_bytes_offset += size;
+    http_instance->received_bytes_count -= size;
+
+    /* we're not reallocating at each consumption so that we don't trash due to byte by byte consumption */
+    if (http_instance->received_bytes_count == 0)
+    {
+        conn_receive_discard_buffer(http_instance);
+    }
+}
+
 static int conn_receive(HTTP_HANDLE_DATA* http_instance, char* buffer, int count)
 {
     int result;
@@ -454,10 +551,13 @@ static int conn_receive(HTTP_HANDLE_DATA* http_instance, char* buffer, int count
     }
     else
     {
+        RETRY_WAIT retry_wait;
+        /*Codes_SRS_HTTPAPI_COMPACT_21_081: [ The HTTPAPI_ExecuteRequest shall try to read the message with the response up to 20 seconds. ]*/
+        retry_wait_init(&retry_wait, RECEIVE_TIMEOUT_IN_MILLISECONDS);
         result = 0;
         while (result < count)
         {
-            xio_dowork(http_instance->xio_handle);
+            bool received = conn_receive_dowork(http_instance);
 
             /* if any error was detected while receiving then simply break and report it */
             if (http_instance->is_io_error != 0)
@@ -470,42 +570,31 @@ static int conn_receive(HTTP_HANDLE_DATA* http_instance, char* buffer, int count
             if (http_instance->received_bytes_count >= (size_t)count)
             {
                 /* Consuming bytes from the receive buffer */
-                (void)memcpy(buffer, http_instance->received_bytes, count);
-                (void)memmove(http_instance->received_bytes, http_instance->received_bytes + count, http_instance->received_bytes_count - count);
-                http_instance->received_bytes_count -= count;
-
-                /* we're not reallocating at each consumption so that we don't trash due to byte by byte consumption */
-                if (http_instance->received_bytes_count == 0)
-                {
-                    free(http_instance->received_bytes);
-                    http_instance->received_bytes = NULL;
-                }
+                (void)memcpy(buffer, http_instance->received_bytes + http_instance->received_bytes_offset, count);
+                conn_receive_consume(http_instance, (size_t)count);
 
                 result = count;
                 break;
             }
 
-            /*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall wait, at least, 100 milliseconds between retries. ]*/
-            ThreadAPI_Sleep(RETRY_INTERVAL_IN_MICROSECONDS);
+            if (received)
+            {
+                retry_wait_restart(&retry_wait);
+            }
+            /*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall retry without waiting while the transport delivers bytes, otherwise it shall wait between retries starting with 1 millisecond and doubling up to 10 milliseconds. ]*/
+            else if (!retry_wait_sleep(&retry_wait))
+            {
+                /*Codes_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
+                LogError("Receive timeout. The HTTP request is incomplete");
+                result = -1;
+                break;
+            }
         }
     }
 
     return result;
 }
 
-static void conn_receive_discard_buffer(HTTP_HANDLE_DATA* http_instance)
-{
-    if (http_instance != NULL)
-    {
-        if (http_instance->received_bytes != NULL)
-        {
-            free(http_instance->received_bytes);
-            http_instance->received_bytes = NULL;
-        }
-        http_instance->received_bytes_count = 0;
-    }
-}
-
 static int readLine(HTTP_HANDLE_DATA* http_instance, char* buf, const size_t maxBufSize)
 {
     int resultLineSize;
@@ -518,13 +607,14 @@ static int readLine(HTTP_HANDLE_DATA* http_instance, char* buf, const size_t max
     else
     {
         char* destByte = buf;
-        /*Codes_SRS_HTTPAPI_COMPACT_21_081: [ The HTTPAPI_ExecuteRequest shall try to read the message with the response up to 20 seconds. ]*/
-        int countRetry = MAX_RECEIVE_RETRY;
+        RETRY_WAIT retry_wait;
         bool endOfSearch = false;
+        /*Codes_SRS_HTTPAPI_COMPACT_21_081: [ The HTTPAPI_ExecuteRequest shall try to read the message with the response up to 20 seconds. ]*/
+        retry_wait_init(&retry_wait, RECEIVE_TIMEOUT_IN_MILLISECONDS);
         resultLineSize = -1;
         while (!endOfSearch)
         {
-            xio_dowork(http_instance->xio_handle);
+            bool received = conn_receive_dowork(http_instance);
 
             /* if any error was detected while receiving then simply break and report it */
             if (http_instance->is_io_error != 0)
@@ -534,8 +624,10 @@ static int readLine(HTTP_HANDLE_DATA* http_instance, char* buf, const size_t max
             }
             else
             {
-                unsigned char* receivedByte = http_instance->received_bytes;
-                while (receivedByte < (http_instance->received_bytes + http_instance->received_bytes_count))
+                unsigned char* firstByte = http_instance->received_bytes + http_instance->received_bytes_offset;
+                unsigned char* lastByte = firstByte + http_instance->received_bytes_count;
+                unsigned char* receivedByte = firstByte;
+                while (receivedByte < lastByte)
                 {
                     if ((*receivedByte) != '\r')
                     {
@@ -546,7 +638,7 @@ static int readLine(HTTP_HANDLE_DATA* http_instance, char* buf, const size_t max
                         if (destByte >= (buf + maxBufSize - 1))
                         {
                             LogError("Received message is bigger than the http buffer");
-                            receivedByte = http_instance->received_bytes + http_instance->received_bytes_count;
+                            receivedByte = lastByte;
                             endOfSearch = true;
                             break;
                         }
@@ -554,7 +646,7 @@ static int readLine(HTTP_HANDLE_DATA* http_instance, char* buf, const size_t max
                     else
                     {
                         receivedByte++;
-                        if ((receivedByte < (http_instance->received_bytes + http_instance->received_bytes_count)) && ((*receivedByte) == '\n'))
+                        if ((receivedByte < lastByte) && ((*receivedByte) == '\n'))
                         {
                             receivedByte++;
                         }
@@ -565,25 +657,17 @@ static int readLine(HTTP_HANDLE_DATA* http_instance, char* buf, const size_t max
                     }
                 }
 
-                http_instance->received_bytes_count -= (receivedByte - http_instance->received_bytes);
-                if (http_instance->received_bytes_count != 0)
-                {
-                    (void)memmove(http_instance->received_bytes, receivedByte, http_instance->received_bytes_count);
-                }
-                else
-                {
-                    conn_receive_discard_buffer(http_instance);
-                }
+                conn_receive_consume(http_instance, (size_t)(receivedByte - firstByte));
             }
 
             if (!endOfSearch)
             {
-                if ((countRetry--) > 0)
+                if (received)
                 {
-                    /*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall wait, at least, 100 milliseconds between retries. ]*/
-                    ThreadAPI_Sleep(RETRY_INTERVAL_IN_MICROSECONDS);
+                    retry_wait_restart(&retry_wait);
                 }
-                else
+                /*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall retry without waiting while the transport delivers bytes, otherwise it shall wait between retries starting with 1 millisecond and doubling up to 10 milliseconds. ]*/
+                else if (!retry_wait_sleep(&retry_wait))
                 {
                     /*Codes_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
                     LogError("Receive timeout. The HTTP request is incomplete");
@@ -636,12 +720,13 @@ static int skipN(HTTP_HANDLE_DATA* http_instance, size_t n)
     }
     else
     {
+        RETRY_WAIT retry_wait;
         /*Codes_SRS_HTTPAPI_COMPACT_21_081: [ The HTTPAPI_ExecuteRequest shall try to read the message with the response up to 20 seconds. ]*/
-        int countRetry = MAX_RECEIVE_RETRY;
+        retry_wait_init(&retry_wait, RECEIVE_TIMEOUT_IN_MILLISECONDS);
         result = (int)n;
         while (n > 0)
         {
-            xio_dowork(http_instance->xio_handle);
+            bool received = conn_receive_dowork(http_instance);
 
             /* if any error was detected while receiving then simply break and report it */
             if (http_instance->is_io_error != 0)
@@ -656,22 +741,22 @@ static int skipN(HTTP_HANDLE_DATA* http_instance, size_t n)
                 {
                     n -= http_instance->received_bytes_count;
                     http_instance->received_bytes_count = 0;
+                    http_instance->received_bytes_offset = 0;
                 }
                 else
                 {
-                    http_instance->received_bytes_count -= n;
-                    (void)memmove(http_instance->received_bytes, http_instance->received_bytes + n, http_instance->received_bytes_count);
+                    conn_receive_consume(http_instance, n);
                     n = 0;
                 }
 
                 if (n > 0)
                 {
-                    if ((countRetry--) > 0)
+                    if (received)
                     {
-                        /*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall wait, at least, 100 milliseconds between retries. ]*/
-                        ThreadAPI_Sleep(RETRY_INTERVAL_IN_MICROSECONDS);
+                        retry_wait_restart(&retry_wait);
                     }
-                    else
+                    /*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall retry without waiting while the transport delivers bytes, otherwise it shall wait between retries starting with 1 millisecond and doubling up to 10 milliseconds. ]*/
+                    else if (!retry_wait_sleep(&retry_wait))
                     {
                         /*Codes_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
                         LogError("Receive timeout. The HTTP request is incomplete");
@@ -735,27 +820,27 @@ static HTTPAPI_RESULT OpenXIOConnection(HTTP_HANDLE_DATA* http_instance)
             }
             else
             {
-				int countRetry;
+                RETRY_WAIT retry_wait;
                 /*Codes_SRS_HTTPAPI_COMPACT_21_033: [ If the whole process succeed, the HTTPAPI_ExecuteRequest shall retur HTTPAPI_OK. ]*/
                 result = HTTPAPI_OK;
                 /*Codes_SRS_HTTPAPI_COMPACT_21_077: [ The HTTPAPI_ExecuteRequest shall wait, at least, 10 seconds for the SSL open process. ]*/
-                countRetry = MAX_OPEN_RETRY;
+                retry_wait_init(&retry_wait, OPEN_TIMEOUT_IN_MILLISECONDS);
                 while ((http_instance->is_connected == 0) &&
                     (http_instance->is_io_error == 0))
                 {
                     xio_dowork(http_instance->xio_handle);
-                    LogInfo("Waiting for TLS connection");
-                    if ((countRetry--) < 0)
+                    if ((http_instance->is_connected == 0) &&
+                        (http_instance->is_io_error == 0))
                     {
-                        /*Codes_SRS_HTTPAPI_COMPACT_21_078: [ If the HTTPAPI_ExecuteRequest cannot open the connection in 10 seconds, it shall fail and return HTTPAPI_OPEN_REQUEST_FAILED. ]*/
-                        LogError("Open timeout. The HTTP request is incomplete");
-                        result = HTTPAPI_OPEN_REQUEST_FAILED;
-                        break;
-                    }
-                    else
-                    {
-                        /*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall wait, at least, 100 milliseconds between retries. ]*/
-                        ThreadAPI_Sleep(RETRY_INTERVAL_IN_MICROSECONDS);
+                        LogInfo("Waiting for TLS connection");
+                        /*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall retry without waiting while the transport delivers bytes, otherwise it shall wait between retries starting with 1 millisecond and doubling up to 10 milliseconds. ]*/
+                        if (!retry_wait_sleep(&retry_wait))
+                        {
+                            /*Codes_SRS_HTTPAPI_COMPACT_21_078: [ If the HTTPAPI_ExecuteRequest cannot open the connection in 10 seconds, it shall fail and return HTTPAPI_OPEN_REQUEST_FAILED. ]*/
+                            LogError("Open timeout. The HTTP request is incomplete");
+                            result = HTTPAPI_OPEN_REQUEST_FAILED;
+                            break;
+                        }
                     }
                 }
             }
@@ -784,8 +869,9 @@ static HTTPAPI_RESULT conn_send_all(HTTP_HANDLE_DATA* http_instance, const unsig
     }
     else
     {
+        RETRY_WAIT retry_wait;
         /*Codes_SRS_HTTPAPI_COMPACT_21_079: [ The HTTPAPI_ExecuteRequest shall wait, at least, 20 seconds to send a buffer using the SSL connection. ]*/
-        int countRetry = MAX_SEND_RETRY;
+        retry_wait_init(&retry_wait, SEND_TIMEOUT_IN_MILLISECONDS);
         /*Codes_SRS_HTTPAPI_COMPACT_21_033: [ If the whole process succeed, the HTTPAPI_ExecuteRequest shall retur HTTPAPI_OK. ]*/
         result = HTTPAPI_OK;
         while ((http_instance->send_completed == 0) && (result == HTTPAPI_OK))
@@ -796,18 +882,14 @@ static HTTPAPI_RESULT conn_send_all(HTTP_HANDLE_DATA* http_instance, const unsig
                 /*Codes_SRS_HTTPAPI_COMPACT_21_028: [ If the HTTPAPI_ExecuteRequest cannot send the request header, it shall return HTTPAPI_HTTP_HEADERS_FAILED. ]*/
                 result = HTTPAPI_SEND_REQUEST_FAILED;
             }
-            else if ((countRetry--) <= 0)
+            /*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall retry without waiting while the transport delivers bytes, otherwise it shall wait between retries starting with 1 millisecond and doubling up to 10 milliseconds. ]*/
+            else if ((http_instance->send_completed == 0) && !retry_wait_sleep(&retry_wait))
             {
                 /*Codes_SRS_HTTPAPI_COMPACT_21_080: [ If the HTTPAPI_ExecuteRequest retries to send the message for 20 seconds without success, it shall fail and return HTTPAPI_SEND_REQUEST_FAILED. ]*/
                 LogError("Send timeout. The HTTP request is incomplete");
                 /*Codes_SRS_HTTPAPI_COMPACT_21_028: [ If the HTTPAPI_ExecuteRequest cannot send the request header, it shall return HTTPAPI_HTTP_HEADERS_FAILED. ]*/
                 result = HTTPAPI_SEND_REQUEST_FAILED;
             }
-            else
-            {
-                /*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall wait, at least, 100 milliseconds between retries. ]*/
-                ThreadAPI_Sleep(RETRY_INTERVAL_IN_MICROSECONDS);
-            }
         }
     }
 
@@ -822,49 +904,75 @@ const char* get_request_type(HTTPAPI_REQUEST_TYPE requestType)
 }
 
 /*Codes_SRS_HTTPAPI_COMPACT_21_026: [ If the open process succeed, the HTTPAPI_ExecuteRequest shall send the request message to the host. ]*/
-static HTTPAPI_RESULT SendHeadsToXIO(HTTP_HANDLE_DATA* http_instance, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath, HTTP_HEADERS_HANDLE httpHeadersHandle, size_t headersCount)
+static HTTPAPI_RESULT SendHeadsToXIO(HTTP_HANDLE_DATA* http_instance, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath, HTTP_HEADERS_HANDLE httpHeadersHandle, bool chunked)
 {
     HTTPAPI_RESULT result;
     char    buf[TEMP_BUFFER_SIZE];
     int     ret;
 
+    /*Codes_SRS_HTTPAPI_COMPACT_99_001: [ If there is a onRequestBodyRead, the HTTPAPI_ExecuteRequestStreaming shall add the header `Transfer-Encoding: chunked` to the request. ]*/
+    static const char TransferEncodingChunked[] = "Transfer-Encoding: chunked\r\n";
+    /*what goes after the headers: the chunked header when needed and the empty line that closes the head*/
+    size_t tailSize = (chunked ? (sizeof(TransferEncodingChunked) - 1) : 0) + 2;
+
     //Send request
     /*Codes_SRS_HTTPAPI_COMPACT_21_038: [ The HTTPAPI_ExecuteRequest shall execute the resquest for the path in relativePath parameter. ]*/
     /*Codes_SRS_HTTPAPI_COMPACT_21_036: [ The request type shall be provided in the parameter requestType. ]*/
     if (((ret = snprintf(buf, sizeof(buf), "%s %s HTTP/1.1\r\n", get_request_type(requestType), relativePath)) < 0) ||
-        (ret >= sizeof(buf)))
+        ((size_t)ret + tailSize > sizeof(buf)))
     {
         /*Codes_SRS_HTTPAPI_COMPACT_21_027: [ If the HTTPAPI_ExecuteRequest cannot create a buffer to send the request, it shall not send any request and return HTTPAPI_STRING_PROCESSING_ERROR. ]*/
         result = HTTPAPI_STRING_PROCESSING_ERROR;
     }
-        /*Codes_SRS_HTTPAPI_COMPACT_21_028: [ If the HTTPAPI_ExecuteRequest cannot send the request header, it shall return HTTPAPI_HTTP_HEADERS_FAILED. ]*/
-    else if ((result = conn_send_all(http_instance, (const unsigned char*)buf, strlen(buf))) == HTTPAPI_OK)
+    else
     {
-		size_t i;
-        //Send default headers
-        /*Codes_SRS_HTTPAPI_COMPACT_21_033: [ If the whole process succeed, the HTTPAPI_ExecuteRequest shall retur HTTPAPI_OK. ]*/
-        for (i = 0; ((i < headersCount) && (result == HTTPAPI_OK)); i++)
+        /*Codes_SRS_HTTPAPI_COMPACT_99_009: [ The HTTPAPI_ExecuteRequest shall put the request line, all the headers and the empty line that ends them in a single buffer, using HTTPHeaders_Serialize, and send it at once. ]*/
+        char* head = buf;
+        size_t requestLineSize = (size_t)ret;
+        size_t headersSize;
+        HTTP_HEADERS_RESULT headersResult = HTTPHeaders_Serialize(httpHeadersHandle, buf + requestLineSize, sizeof(buf) - requestLineSize - tailSize, &headersSize);
+
+        if (headersResult == HTTP_HEADERS_INSUFFICIENT_BUFFER)
         {
-            char* header;
-            if (HTTPHeaders_GetHeader(httpHeadersHandle, i, &header) != HTTP_HEADERS_OK)
+            /*Codes_SRS_HTTPAPI_COMPACT_99_010: [ If the head does not fit in the stack buffer, the HTTPAPI_ExecuteRequest shall allocate one of the exact size. ]*/
+            if ((head = (char*)malloc(requestLineSize + headersSize + tailSize)) == NULL)
             {
-                /*Codes_SRS_HTTPAPI_COMPACT_21_027: [ If the HTTPAPI_ExecuteRequest cannot create a buffer to send the request, it shall not send any request and return HTTPAPI_STRING_PROCESSING_ERROR. ]*/
-                result = HTTPAPI_STRING_PROCESSING_ERROR;
+                LogError("Failed to allocate %lu bytes for the request head", (unsigned long)(requestLineSize + headersSize + tailSize));
+                headersResult = HTTP_HEADERS_ALLOC_FAILED;
             }
             else
             {
-                if ((result = conn_send_all(http_instance, (const unsigned char*)header, strlen(header))) == HTTPAPI_OK)
-                {
-                    result = conn_send_all(http_instance, (const unsigned char*)"\r\n", (size_t)2);
-                }
-                free(header);
+                /* copy the terminator as well, the tail always leaves room for it */
+                (void)memcpy(head, buf, requestLineSize + 1);
+                headersResult = HTTPHeaders_Serialize(httpHeadersHandle, head + requestLineSize, headersSize, &headersSize);
             }
         }
 
-        //Close headers
-        if (result == HTTPAPI_OK)
+        if (headersResult != HTTP_HEADERS_OK)
         {
-            result = conn_send_all(http_instance, (const unsigned char*)"\r\n", (size_t)2);
+            /*Codes_SRS_HTTPAPI_COMPACT_21_027: [ If the HTTPAPI_ExecuteRequest cannot create a buffer to send the request, it shall not send any request and return HTTPAPI_STRING_PROCESSING_ERROR. ]*/
+            LogError("Failed to serialize the request headers");
+            result = HTTPAPI_STRING_PROCESSING_ERROR;
+        }
+        else
+        {
+            size_t headSize = requestLineSize + headersSize;
+            if (chunked)
+            {
+                (void)memcpy(head + headSize, TransferEncodingChunked, sizeof(TransferEncodingChunked) - 1);
+                headSize += sizeof(TransferEncodingChunked) - 1;
+            }
+            //Close headers
+            head[headSize++] = '\r';
+            head[headSize++] = '\n';
+
+            /*Codes_SRS_HTTPAPI_COMPACT_21_028: [ If the HTTPAPI_ExecuteRequest cannot send the request header, it shall return HTTPAPI_HTTP_HEADERS_FAILED. ]*/
+            result = conn_send_all(http_instance, (const unsigned char*)head, headSize);
+        }
+
+        if ((head != buf) && (head != NULL))
+        {
+            free(head);
         }
     }
     return result;
@@ -891,6 +999,41 @@ static HTTPAPI_RESULT SendContentToXIO(HTTP_HANDLE_DATA* http_instance, const un
     return result;
 }
 
+/*Codes_SRS_HTTPAPI_COMPACT_99_002: [ The HTTPAPI_ExecuteRequestStreaming shall send each piece of the body returned by onRequestBodyRead as one chunk, and the empty chunk when onRequestBodyRead returns 0 bytes. ]*/
+static HTTPAPI_RESULT SendChunkedContentToXIO(HTTP_HANDLE_DATA* http_instance, ON_HTTPAPI_REQUEST_BODY_READ onRequestBodyRead, void* requestBodyContext)
+{
+    HTTPAPI_RESULT result = HTTPAPI_OK;
+    /*the body is read after room for the longest chunk size line, the line is then written right before it*/
+    unsigned char chunk[CHUNK_HEADER_MAX_SIZE + TEMP_BUFFER_SIZE + 2];
+    bool isLastChunk = false;
+
+    while ((result == HTTPAPI_OK) && !isLastChunk)
+    {
+        size_t size = 0;
+        if ((onRequestBodyRead(requestBodyContext, chunk + CHUNK_HEADER_MAX_SIZE, TEMP_BUFFER_SIZE, &size) != 0) ||
+            (size > TEMP_BUFFER_SIZE))
+        {
+            /*Codes_SRS_HTTPAPI_COMPACT_99_003: [ If onRequestBodyRead fails, the HTTPAPI_ExecuteRequestStreaming shall return HTTPAPI_SEND_REQUEST_FAILED. ]*/
+            LogError("Request body reader failed");
+            result = HTTPAPI_SEND_REQUEST_FAILED;
+        }
+        else
+        {
+            char chunkHeader[CHUNK_HEADER_MAX_SIZE + 1];
+            size_t chunkHeaderSize = (size_t)snprintf(chunkHeader, sizeof(chunkHeader), "%x\r\n", (unsigned int)size);
+            unsigned char* chunkStart = chunk + CHUNK_HEADER_MAX_SIZE - chunkHeaderSize;
+            (void)memcpy(chunkStart, chunkHeader, chunkHeaderSize);
+            chunk[CHUNK_HEADER_MAX_SIZE + size] = '\r';
+            chunk[CHUNK_HEADER_MAX_SIZE + size + 1] = '\n';
+            /*the last chunk is "0\r\n" followed by the empty line that ends the message*/
+            isLastChunk = (size == 0);
+            result = conn_send_all(http_instance, chunkStart, chunkHeaderSize + size + 2);
+        }
+    }
+
+    return result;
+}
+
 /*Codes_SRS_HTTPAPI_COMPACT_21_030: [ At the end of the transmission, the HTTPAPI_ExecuteRequest shall receive the response from the host. ]*/
 static HTTPAPI_RESULT ReceiveHeaderFromXIO(HTTP_HANDLE_DATA* http_instance, unsigned int* statusCode)
 {
@@ -1149,6 +1292,89 @@ static HTTPAPI_RESULT ReadHTTPResponseBodyFromXIO(HTTP_HANDLE_DATA* http_instanc
 }
 
 
+/*reads n bytes of the body and hands them to onResponseBodyReceived in pieces of at most TEMP_BUFFER_SIZE*/
+static HTTPAPI_RESULT StreamNFromXIO(HTTP_HANDLE_DATA* http_instance, size_t n, ON_HTTPAPI_RESPONSE_BODY_RECEIVED onResponseBodyReceived, void* responseBodyContext)
+{
+    HTTPAPI_RESULT result;
+
+    if (onResponseBodyReceived == NULL)
+    {
+        /*Codes_SRS_HTTPAPI_COMPACT_99_006: [ If the onResponseBodyReceived is NULL, the HTTPAPI_ExecuteRequestStreaming shall ignore any content in the response. ]*/
+        result = (skipN(http_instance, n) < 0) ? HTTPAPI_READ_DATA_FAILED : HTTPAPI_OK;
+    }
+    else
+    {
+        char buf[TEMP_BUFFER_SIZE];
+        result = HTTPAPI_OK;
+        while ((n > 0) && (result == HTTPAPI_OK))
+        {
+            size_t size = (n < sizeof(buf)) ? n : sizeof(buf);
+            if (conn_receive(http_instance, buf, (int)size) != (int)size)
+            {
+                /*Codes_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
+                result = HTTPAPI_READ_DATA_FAILED;
+            }
+            else if (onResponseBodyReceived(responseBodyContext, (const unsigned char*)buf, size) != 0)
+            {
+                /*Codes_SRS_HTTPAPI_COMPACT_99_005: [ If onResponseBodyReceived fails, the HTTPAPI_ExecuteRequestStreaming shall return HTTPAPI_READ_DATA_FAILED. ]*/
+                LogError("Response body consumer failed");
+                result = HTTPAPI_READ_DATA_FAILED;
+            }
+            else
+            {
+                n -= size;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*Codes_SRS_HTTPAPI_COMPACT_99_004: [ The HTTPAPI_ExecuteRequestStreaming shall call onResponseBodyReceived with the body of the response as it is received, in pieces of at most 1024 bytes, without holding the whole body in memory. ]*/
+static HTTPAPI_RESULT StreamHTTPResponseBodyFromXIO(HTTP_HANDLE_DATA* http_instance, size_t bodyLength, bool chunked, ON_HTTPAPI_RESPONSE_BODY_RECEIVED onResponseBodyReceived, void* responseBodyContext)
+{
+    HTTPAPI_RESULT result;
+
+    http_instance->is_io_error = 0;
+
+    if (!chunked)
+    {
+        result = StreamNFromXIO(http_instance, bodyLength, onResponseBodyReceived, responseBodyContext);
+    }
+    else
+    {
+        char buf[TEMP_BUFFER_SIZE];
+        bool isLastChunk = false;
+        result = HTTPAPI_OK;
+        while ((result == HTTPAPI_OK) && !isLastChunk)
+        {
+            size_t chunkSize;
+            if (readLine(http_instance, buf, sizeof(buf)) < 0)    // read [length in hex]/r/n
+            {
+                /*Codes_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
+                result = HTTPAPI_READ_DATA_FAILED;
+            }
+            else if (ParseStringToHexadecimal(buf, &chunkSize) != 1)
+            {
+                /*Codes_SRS_HTTPAPI_COMPACT_21_055: [ If the HTTPAPI_ExecuteRequest cannot parser the received message, it shall return HTTPAPI_RECEIVE_RESPONSE_FAILED. ]*/
+                result = HTTPAPI_RECEIVE_RESPONSE_FAILED;
+            }
+            else
+            {
+                // 0 length means next line is just '\r\n' and end of chunks
+                isLastChunk = (chunkSize == 0);
+                if (((result = StreamNFromXIO(http_instance, chunkSize, onResponseBodyReceived, responseBodyContext)) == HTTPAPI_OK) &&
+                    ((conn_receive(http_instance, buf, 2) != 2) || (buf[0] != '\r') || (buf[1] != '\n')))
+                {
+                    result = HTTPAPI_READ_DATA_FAILED;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
 /*Codes_SRS_HTTPAPI_COMPACT_21_037: [ If the request type is unknown, the HTTPAPI_ExecuteRequest shall return HTTPAPI_INVALID_ARG. ]*/
 static bool validRequestType(HTTPAPI_REQUEST_TYPE requestType)
 {
@@ -1207,7 +1433,7 @@ HTTPAPI_RESULT HTTPAPI_ExecuteRequest(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE r
         LogError("Open HTTP connection failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
     }
     /*Codes_SRS_HTTPAPI_COMPACT_21_026: [ If the open process succeed, the HTTPAPI_ExecuteRequest shall send the request message to the host. ]*/
-    else if ((result = SendHeadsToXIO(http_instance, requestType, relativePath, httpHeadersHandle, headersCount)) != HTTPAPI_OK)
+    else if ((result = SendHeadsToXIO(http_instance, requestType, relativePath, httpHeadersHandle, false)) != HTTPAPI_OK)
     {
         LogError("Send heads to HTTP failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
     }
@@ -1239,6 +1465,78 @@ HTTPAPI_RESULT HTTPAPI_ExecuteRequest(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE r
     return result;
 }
 
+/*one attempt of HTTPAPI_ExecuteRequestStreaming, the arguments are already validated*/
+static HTTPAPI_RESULT ExecuteRequestStreamingOnce(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
+    HTTP_HEADERS_HANDLE httpHeadersHandle, ON_HTTPAPI_REQUEST_BODY_READ onRequestBodyRead, void* requestBodyContext,
+    unsigned int* statusCode, HTTP_HEADERS_HANDLE responseHeadersHandle,
+    ON_HTTPAPI_RESPONSE_BODY_RECEIVED onResponseBodyReceived, void* responseBodyContext)
+{
+    HTTPAPI_RESULT result;
+    size_t  bodyLength = 0;
+    bool    chunked = false;
+    HTTP_HANDLE_DATA* http_instance = (HTTP_HANDLE_DATA*)handle;
+
+    if ((result = OpenXIOConnection(http_instance)) != HTTPAPI_OK)
+    {
+        LogError("Open HTTP connection failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+    }
+    else if ((result = SendHeadsToXIO(http_instance, requestType, relativePath, httpHeadersHandle, (onRequestBodyRead != NULL))) != HTTPAPI_OK)
+    {
+        LogError("Send heads to HTTP failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+    }
+    else if ((onRequestBodyRead != NULL) && ((result = SendChunkedContentToXIO(http_instance, onRequestBodyRead, requestBodyContext)) != HTTPAPI_OK))
+    {
+        LogError("Send content to HTTP failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+    }
+    else if ((result = ReceiveHeaderFromXIO(http_instance, statusCode)) != HTTPAPI_OK)
+    {
+        LogError("Receive header from HTTP failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+    }
+    else if ((result = ReceiveContentInfoFromXIO(http_instance, responseHeadersHandle, &bodyLength, &chunked)) != HTTPAPI_OK)
+    {
+        LogError("Receive content information from HTTP failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+    }
+    else if ((result = StreamHTTPResponseBodyFromXIO(http_instance, bodyLength, chunked, onResponseBodyReceived, responseBodyContext)) != HTTPAPI_OK)
+    {
+        LogError("Stream HTTP response body from HTTP failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+        /*Codes_SRS_HTTPAPI_COMPACT_99_012: [ If the response body cannot be read to its end, the HTTPAPI_ExecuteRequestStreaming shall close the connection, so that the next request opens a new one. ]*/
+        CloseXIOConnection(http_instance);
+    }
+
+    conn_receive_discard_buffer(http_instance);
+
+    return result;
+}
+
+/*Codes_SRS_HTTPAPI_COMPACT_99_007: [ The HTTPAPI_ExecuteRequestStreaming shall execute the http communication like HTTPAPI_ExecuteRequest, reading the request body from onRequestBodyRead and handing the response body to onResponseBodyReceived. ]*/
+HTTPAPI_RESULT HTTPAPI_ExecuteRequestStreaming(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
+    HTTP_HEADERS_HANDLE httpHeadersHandle, ON_HTTPAPI_REQUEST_BODY_READ onRequestBodyRead, void* requestBodyContext,
+    unsigned int* statusCode, HTTP_HEADERS_HANDLE responseHeadersHandle,
+    ON_HTTPAPI_RESPONSE_BODY_RECEIVED onResponseBodyReceived, void* responseBodyContext)
+{
+    HTTPAPI_RESULT result;
+    size_t  headersCount;
+
+    /*Codes_SRS_HTTPAPI_COMPACT_99_008: [ If handle, relativePath or httpHeadersHandle is NULL, or the requestType is unknown, the HTTPAPI_ExecuteRequestStreaming shall return HTTPAPI_INVALID_ARG. ]*/
+    if (handle == NULL ||
+        relativePath == NULL ||
+        httpHeadersHandle == NULL ||
+        !validRequestType(requestType) ||
+        HTTPHeaders_GetHeaderCount(httpHeadersHandle, &headersCount) != HTTP_HEADERS_OK)
+    {
+        result = HTTPAPI_INVALID_ARG;
+        LogError("(result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+    }
+    else
+    {
+        /*Codes_SRS_HTTPAPI_COMPACT_99_011: [ If the connection fails in the middle of the body of a 200 or 206 response to a GET that has a strong ETag or a Last-Modified header, the HTTPAPI_ExecuteRequestStreaming shall request the rest of the body with the headers `Range` and `If-Range`, at most 3 times, and hand onResponseBodyReceived only the bytes it did not get yet. ]*/
+        result = HTTPAPIStreaming_ExecuteWithResume(ExecuteRequestStreamingOnce, handle, requestType, relativePath, httpHeadersHandle, onRequestBodyRead, requestBodyContext,
+            statusCode, responseHeadersHandle, onResponseBodyReceived, responseBodyContext);
+    }
+
+    return result;
+}
+
 /*Codes_SRS_HTTPAPI_COMPACT_21_056: [ The HTTPAPI_SetOption shall change the HTTP options. ]*/
 /*Codes_SRS_HTTPAPI_COMPACT_21_057: [ The HTTPAPI_SetOption shall receive a handle that identiry the HTTP connection. ]*/
 /*Codes_SRS_HTTPAPI_COMPACT_21_058: [ The HTTPAPI_SetOption shall receive the option as a pair optionName/value. ]*/
@@ -22,6 +22,7 @@
 #include "wolfssl/error-ssl.h"
 #endif
 #include "azure_c_shared_utility/shared_util_options.h"
+#include "httpapi_streaming.h"
 
 #define TEMP_BUFFER_SIZE 1024
 
@@ -47,8 +48,17 @@ typedef struct HTTP_RESPONSE_CONTENT_BUFFER_TAG
     unsigned char* buffer;
     size_t bufferSize;
     unsigned char error;
+    /*when set, the content is handed to it as it arrives instead of being accumulated in buffer*/
+    ON_HTTPAPI_RESPONSE_BODY_RECEIVED onResponseBodyReceived;
+    void* responseBodyContext;
 } HTTP_RESPONSE_CONTENT_BUFFER;
 
+typedef struct HTTP_REQUEST_CONTENT_READER_TAG
+{
+    ON_HTTPAPI_REQUEST_BODY_READ onRequestBodyRead;
+    void* requestBodyContext;
+} HTTP_REQUEST_CONTENT_READER;
+
 static size_t nUsersOfHTTPAPI = 0; /*used for reference counting (a weak one)*/
 
 HTTPAPI_RESULT HTTPAPI_Init(void)
@@ -193,7 +203,21 @@ static size_t HeadersWriteFunction(void *ptr, size_t size, size_t nmemb, void *u
 static size_t ContentWriteFunction(void *ptr, size_t size, size_t nmemb, void *userdata)
 {
     HTTP_RESPONSE_CONTENT_BUFFER* responseContentBuffer = (HTTP_RESPONSE_CONTENT_BUFFER*)userdata;
+    size_t result = size * nmemb;
     if ((userdata != NULL) &&
+        (ptr != NULL) &&
+        (size * nmemb > 0) &&
+        (responseContentBuffer->onResponseBodyReceived != NULL))
+    {
+        if (responseContentBuffer->onResponseBodyReceived(responseContentBuffer->responseBodyContext, (const unsigned char*)ptr, size * nmemb) != 0)
+        {
+            LogError("Response body consumer failed");
+            responseContentBuffer->error = 1;
+            /*anything but size * nmemb makes curl abort the transfer*/
+            result = 0;
+        }
+    }
+    else if ((userdata != NULL) &&
         (ptr != NULL) &&
         (size * nmemb > 0))
     {
@@ -215,7 +239,27 @@ static size_t ContentWriteFunction(void *ptr, size_t size, size_t nmemb, void *u
         }
     }
 
-    return size * nmemb;
+    return result;
+}
+
+static size_t ContentReadFunction(char* buffer, size_t size, size_t nitems, void* userdata)
+{
+    HTTP_REQUEST_CONTENT_READER* requestContentReader = (HTTP_REQUEST_CONTENT_READER*)userdata;
+    size_t result;
+    size_t bytesWritten = 0;
+
+    if (requestContentReader->onRequestBodyRead(requestContentReader->requestBodyContext, (unsigned char*)buffer, size * nitems, &bytesWritten) != 0)
+    {
+        LogError("Request body reader failed");
+        result = CURL_READFUNC_ABORT;
+    }
+    else
+    {
+        /*curl sends the terminating chunk when this returns 0*/
+        result = bytesWritten;
+    }
+
+    return result;
 }
 
 static CURLcode ssl_ctx_callback(CURL *curl, void *ssl_ctx, void *userptr)
@@ -290,10 +334,12 @@ static CURLcode ssl_ctx_callback(CURL *curl, void *ssl_ctx, void *userptr)
     return result;
 }
 
-HTTPAPI_RESULT HTTPAPI_ExecuteRequest(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
-                                      HTTP_HEADERS_HANDLE httpHeadersHandle, const unsigned char* content,
-                                      size_t contentLength, unsigned int* statusCode,
-                                      HTTP_HEADERS_HANDLE responseHeadersHandle, BUFFER_HANDLE responseContent)
+/*the content comes either from content/contentLength or from requestContentReader, and goes either to responseContent or to onResponseBodyReceived*/
+static HTTPAPI_RESULT ExecuteRequest(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
+                                     HTTP_HEADERS_HANDLE httpHeadersHandle, const unsigned char* content,
+                                     size_t contentLength, HTTP_REQUEST_CONTENT_READER* requestContentReader, unsigned int* statusCode,
+                                     HTTP_HEADERS_HANDLE responseHeadersHandle, BUFFER_HANDLE responseContent,
+                                     ON_HTTPAPI_RESPONSE_BODY_RECEIVED onResponseBodyReceived, void* responseBodyContext)
 {
     HTTPAPI_RESULT result;
     HTTP_HANDLE_DATA* httpHandleData = (HTTP_HANDLE_DATA*)handle;
@@ -502,6 +548,21 @@ HTTPAPI_RESULT HTTPAPI_ExecuteRequest(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE r
                         }
                     }
 
+                    if ((result == HTTPAPI_OK) && (requestContentReader != NULL))
+                    {
+                        /*without a Content-Length curl would otherwise wait for the whole body*/
+                        struct curl_slist* newHeaders = curl_slist_append(headers, "Transfer-Encoding: chunked");
+                        if (newHeaders == NULL)
+                        {
+                            result = HTTPAPI_ALLOC_FAILED;
+                            LogError("(result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+                        }
+                        else
+                        {
+                            headers = newHeaders;
+                        }
+                    }
+
                     if (result == HTTPAPI_OK)
                     {
                         if (curl_easy_setopt(httpHandleData->curl, CURLOPT_HTTPHEADER, headers) != CURLE_OK)
@@ -512,7 +573,18 @@ HTTPAPI_RESULT HTTPAPI_ExecuteRequest(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE r
                         else
                         {
                             /* add content */
-                            if ((content != NULL) &&
+                            if (requestContentReader != NULL)
+                            {
+                                if ((curl_easy_setopt(httpHandleData->curl, CURLOPT_POSTFIELDS, (void*)NULL) != CURLE_OK) ||
+                                    (curl_easy_setopt(httpHandleData->curl, CURLOPT_POSTFIELDSIZE, -1L) != CURLE_OK) ||
+                                    (curl_easy_setopt(httpHandleData->curl, CURLOPT_READFUNCTION, ContentReadFunction) != CURLE_OK) ||
+                                    (curl_easy_setopt(httpHandleData->curl, CURLOPT_READDATA, requestContentReader) != CURLE_OK))
+                                {
+                                    result = HTTPAPI_SET_OPTION_FAILED;
+                                    LogError("(result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+                                }
+                            }
+                            else if ((content != NULL) &&
                                 (contentLength > 0))
                             {
                                 if ((curl_easy_setopt(httpHandleData->curl, CURLOPT_POSTFIELDS, (void*)content) != CURLE_OK) ||
@@ -566,6 +638,8 @@ HTTPAPI_RESULT HTTPAPI_ExecuteRequest(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE r
                                         responseContentBuffer.buffer = NULL;
                                         responseContentBuffer.bufferSize = 0;
                                         responseContentBuffer.error = 0;
+                                        responseContentBuffer.onResponseBodyReceived = onResponseBodyReceived;
+                                        responseContentBuffer.responseBodyContext = responseBodyContext;
 
                                         if (curl_easy_setopt(httpHandleData->curl, CURLOPT_WRITEDATA, &responseContentBuffer) != CURLE_OK)
                                         {
@@ -577,11 +651,38 @@ HTTPAPI_RESULT HTTPAPI_ExecuteRequest(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE r
                                         {
                                             /* Execute request */
                                             CURLcode curlRes = curl_easy_perform(httpHandleData->curl);
-                                            if (curlRes != CURLE_OK)
+                                            if (requestContentReader != NULL)
+                                            {
+                                                /*the reader belongs to this call, put back curl's defaults so a later request cannot reach it*/
+                                                (void)curl_easy_setopt(httpHandleData->curl, CURLOPT_READFUNCTION, NULL);
+                                                (void)curl_easy_setopt(httpHandleData->curl, CURLOPT_READDATA, stdin);
+                                            }
+
+                                            if ((curlRes == CURLE_WRITE_ERROR) && responseContentBuffer.error)
                                             {
+                                                result = HTTPAPI_READ_DATA_FAILED;
+                                                LogError("(result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+                                            }
+                                            else if (curlRes == CURLE_ABORTED_BY_CALLBACK)
+                                            {
+                                                result = HTTPAPI_SEND_REQUEST_FAILED;
+                                                LogError("(result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+                                            }
+                                            else if (curlRes != CURLE_OK)
+                                            {
+                                                long httpCode;
+
                                                 LogError("curl_easy_perform() failed: %s\n", curl_easy_strerror(curlRes));
                                                 result = HTTPAPI_OPEN_REQUEST_FAILED;
                                                 LogError("(result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+
+                                                /*a response cut short in its body still has its status code, which HTTPAPI_ExecuteRequestStreaming needs to resume it*/
+                                                if ((statusCode != NULL) &&
+                                                    (curl_easy_getinfo(httpHandleData->curl, CURLINFO_RESPONSE_CODE, &httpCode) == CURLE_OK) &&
+                                                    (httpCode != 0))
+                                                {
+                                                    *statusCode = (unsigned int)httpCode;
+                                                }
                                             }
                                             else
                                             {
@@ -652,6 +753,49 @@ HTTPAPI_RESULT HTTPAPI_ExecuteRequest(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE r
     return result;
 }
 
+HTTPAPI_RESULT HTTPAPI_ExecuteRequest(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
+                                      HTTP_HEADERS_HANDLE httpHeadersHandle, const unsigned char* content,
+                                      size_t contentLength, unsigned int* statusCode,
+                                      HTTP_HEADERS_HANDLE responseHeadersHandle, BUFFER_HANDLE responseContent)
+{
+    return ExecuteRequest(handle, requestType, relativePath, httpHeadersHandle, content, contentLength, NULL, statusCode,
+        responseHeadersHandle, responseContent, NULL, NULL);
+}
+
+static HTTPAPI_RESULT ExecuteRequestStreamingOnce(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
+                                                  HTTP_HEADERS_HANDLE httpHeadersHandle, ON_HTTPAPI_REQUEST_BODY_READ onRequestBodyRead, void* requestBodyContext,
+                                                  unsigned int* statusCode, HTTP_HEADERS_HANDLE responseHeadersHandle,
+                                                  ON_HTTPAPI_RESPONSE_BODY_RECEIVED onResponseBodyReceived, void* responseBodyContext)
+{
+    HTTPAPI_RESULT result;
+
+    if (onRequestBodyRead == NULL)
+    {
+        result = ExecuteRequest(handle, requestType, relativePath, httpHeadersHandle, NULL, 0, NULL, statusCode,
+            responseHeadersHandle, NULL, onResponseBodyReceived, responseBodyContext);
+    }
+    else
+    {
+        HTTP_REQUEST_CONTENT_READER requestContentReader;
+        requestContentReader.onRequestBodyRead = onRequestBodyRead;
+        requestContentReader.requestBodyContext = requestBodyContext;
+        result = ExecuteRequest(handle, requestType, relativePath, httpHeadersHandle, NULL, 0, &requestContentReader, statusCode,
+            responseHeadersHandle, NULL, onResponseBodyReceived, responseBodyContext);
+    }
+
+    return result;
+}
+
+HTTPAPI_RESULT HTTPAPI_ExecuteRequestStreaming(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
+                                               HTTP_HEADERS_HANDLE httpHeadersHandle, ON_HTTPAPI_REQUEST_BODY_READ onRequestBodyRead, void* requestBodyContext,
+                                               unsigned int* statusCode, HTTP_HEADERS_HANDLE responseHeadersHandle,
+                                               ON_HTTPAPI_RESPONSE_BODY_RECEIVED onResponseBodyReceived, void* responseBodyContext)
+{
+    /*curl opens a new connection by itself when the previous one failed*/
+    return HTTPAPIStreaming_ExecuteWithResume(ExecuteRequestStreamingOnce, handle, requestType, relativePath, httpHeadersHandle, onRequestBodyRead, requestBodyContext,
+        statusCode, responseHeadersHandle, onResponseBodyReceived, responseBodyContext);
+}
+
 HTTPAPI_RESULT HTTPAPI_SetOption(HTTP_HANDLE handle, const char* optionName, const void* value)
 {
     HTTPAPI_RESULT result;
@@ -0,0 +1,359 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/buffer_.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "httpapi_streaming.h"
+
+/*"bytes=" and two size_t in decimal*/
+#define RANGE_VALUE_SIZE 64
+
+typedef struct RESUMABLE_BODY_TAG
+{
+    ON_HTTPAPI_RESPONSE_BODY_RECEIVED onResponseBodyReceived;
+    void* responseBodyContext;
+    size_t received; /*bytes given to onResponseBodyReceived by all the attempts*/
+    HTTP_HEADERS_HANDLE resumedResponseHeadersHandle; /*NULL during the first attempt*/
+    size_t resumedFrom; /*the first byte asked by the current resumed attempt*/
+    bool isRangeChecked;
+    bool isRangeRejected;
+    bool isConsumerFailed;
+}RESUMABLE_BODY;
+
+/*HTTP/2 responses have lower case header names, and some adapters keep the spaces after the colon*/
+static const char* findHeaderValue(HTTP_HEADERS_HANDLE httpHeadersHandle, const char* name, const char* lowerCaseName)
+{
+    const char* result = HTTPHeaders_FindHeaderValue(httpHeadersHandle, name);
+    if (result == NULL)
+    {
+        result = HTTPHeaders_FindHeaderValue(httpHeadersHandle, lowerCaseName);
+    }
+    if (result != NULL)
+    {
+        while ((*result == ' ') || (*result == '\t'))
+        {
+            result++;
+        }
+    }
+    return result;
+}
+
+/*parses "bytes first-last/length", the length can be "*"*/
+static int parseContentRange(const char* value, size_t* first, size_t* last)
+{
+    int result;
+    const char* bytesUnit = "bytes ";
+    size_t bytesUnitLength = strlen(bytesUnit);
+
+    if ((strncmp(value, bytesUnit, bytesUnitLength) != 0) ||
+        (value[bytesUnitLength] < '0') || (value[bytesUnitLength] > '9'))
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        char* end;
+        unsigned long long firstValue = strtoull_s(value + bytesUnitLength, &end, 10);
+        if ((*end != '-') || (end[1] < '0') || (end[1] > '9'))
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            unsigned long long lastValue = strtoull_s(end + 1, &end, 10);
+            if ((*end != '/') || (lastValue < firstValue) || (lastValue > SIZE_MAX))
+            {
+                result = __FAILURE__;
+            }
+            else
+            {
+                *first = (size_t)firstValue;
+                *last = (size_t)lastValue;
+                result = 0;
+            }
+        }
+    }
+    return result;
+}
+
+static int getPartialRange(HTTP_HEADERS_HANDLE responseHeadersHandle, size_t* first, size_t* last)
+{
+    const char* contentRange = findHeaderValue(responseHeadersHandle, "Content-Range", "content-range");
+    return (contentRange == NULL) ? __FAILURE__ : parseContentRange(contentRange, first, last);
+}
+
+/*the validator the resumed attempts send in If-Range, NULL when the body cannot be resumed safely*/
+static const char* findValidator(HTTP_HEADERS_HANDLE responseHeadersHandle)
+{
+    const char* result = findHeaderValue(responseHeadersHandle, "ETag", "etag");
+    if ((result != NULL) && (strncmp(result, "W/", 2) == 0))
+    {
+        /*a weak ETag does not promise the same bytes*/
+        result = NULL;
+    }
+    if (result == NULL)
+    {
+        result = findHeaderValue(responseHeadersHandle, "Last-Modified", "last-modified");
+    }
+    return result;
+}
+
+static int buildRangeValue(char* destination, size_t destinationSize, size_t from, size_t last, bool hasLast)
+{
+    int result;
+    size_t length;
+
+    (void)strcpy_s(destination, destinationSize, "bytes=");
+    length = strlen(destination);
+    if (size_tToString(destination + length, destinationSize - length, from) != 0)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        length += strlen(destination + length);
+        if (strcat_s(destination + length, destinationSize - length, "-") != 0)
+        {
+            result = __FAILURE__;
+        }
+        else if (hasLast &&
+            (size_tToString(destination + length + 1, destinationSize - length - 1, last) != 0))
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+    return result;
+}
+
+static int onResumableBodyReceived(void* context, const unsigned char* buffer, size_t size)
+{
+    RESUMABLE_BODY* body = (RESUMABLE_BODY*)context;
+    int result;
+
+    if ((body->resumedResponseHeadersHandle != NULL) && !body->isRangeChecked)
+    {
+        size_t first;
+        size_t last;
+        if ((getPartialRange(body->resumedResponseHeadersHandle, &first, &last) != 0) ||
+            (first != body->resumedFrom))
+        {
+            /*a 200 with the whole body, or a range that does not start where the body was cut*/
+            body->isRangeRejected = true;
+        }
+        body->isRangeChecked = true;
+    }
+
+    if (body->isRangeRejected)
+    {
+        LogError("the resumed response does not continue the body");
+        result = __FAILURE__;
+    }
+    else if (body->onResponseBodyReceived(body->responseBodyContext, buffer, size) != 0)
+    {
+        body->isConsumerFailed = true;
+        result = __FAILURE__;
+    }
+    else
+    {
+        body->received += size;
+        result = 0;
+    }
+    return result;
+}
+
+static bool canResume(HTTPAPI_RESULT result, unsigned int firstStatusCode, const RESUMABLE_BODY* body)
+{
+    return (result != HTTPAPI_OK) &&
+        (result != HTTPAPI_INVALID_ARG) &&
+        !body->isConsumerFailed &&
+        !body->isRangeRejected &&
+        (body->received > 0) &&
+        ((firstStatusCode == 200) || (firstStatusCode == 206));
+}
+
+HTTPAPI_RESULT HTTPAPIStreaming_ExecuteWithResume(HTTPAPI_STREAMING_EXECUTE execute, HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
+    HTTP_HEADERS_HANDLE httpHeadersHandle, ON_HTTPAPI_REQUEST_BODY_READ onRequestBodyRead, void* requestBodyContext,
+    unsigned int* statusCode, HTTP_HEADERS_HANDLE responseHeadersHandle,
+    ON_HTTPAPI_RESPONSE_BODY_RECEIVED onResponseBodyReceived, void* responseBodyContext)
+{
+    HTTPAPI_RESULT result;
+
+    if ((requestType != HTTPAPI_REQUEST_GET) ||
+        (onResponseBodyReceived == NULL) ||
+        (responseHeadersHandle == NULL))
+    {
+        /*there is no body to resume, or no validator to resume it with*/
+        result = execute(handle, requestType, relativePath, httpHeadersHandle, onRequestBodyRead, requestBodyContext,
+            statusCode, responseHeadersHandle, onResponseBodyReceived, responseBodyContext);
+    }
+    else
+    {
+        RESUMABLE_BODY body;
+        unsigned int firstStatusCode = 0;
+        const char* validator;
+        size_t first = 0;
+        size_t last = 0;
+
+        (void)memset(&body, 0, sizeof(body));
+        body.onResponseBodyReceived = onResponseBodyReceived;
+        body.responseBodyContext = responseBodyContext;
+
+        result = execute(handle, requestType, relativePath, httpHeadersHandle, onRequestBodyRead, requestBodyContext,
+            &firstStatusCode, responseHeadersHandle, onResumableBodyReceived, &body);
+
+        if (!canResume(result, firstStatusCode, &body))
+        {
+            /*done, or failed in a way that a range does not fix*/
+        }
+        else if ((validator = findValidator(responseHeadersHandle)) == NULL)
+        {
+            LogError("the response has neither a strong ETag nor Last-Modified, its body cannot be resumed");
+        }
+        else if ((firstStatusCode == 206) &&
+            (getPartialRange(responseHeadersHandle, &first, &last) != 0))
+        {
+            LogError("the partial response has no valid Content-Range, its body cannot be resumed");
+        }
+        else
+        {
+            HTTP_HEADERS_HANDLE resumeHeadersHandle;
+            /*a 206 asked only up to its last byte, a 200 wants the rest of the resource*/
+            bool hasLast = (firstStatusCode == 206);
+            if ((resumeHeadersHandle = HTTPHeaders_Clone(httpHeadersHandle)) == NULL)
+            {
+                LogError("unable to HTTPHeaders_Clone, the body is not resumed");
+            }
+            else
+            {
+                if (HTTPHeaders_ReplaceHeaderNameValuePair(resumeHeadersHandle, "If-Range", validator) != HTTP_HEADERS_OK)
+                {
+                    LogError("unable to add If-Range, the body is not resumed");
+                }
+                else
+                {
+                    size_t resumes = 0;
+                    bool isResumable = true;
+                    while (isResumable &&
+                        (resumes < HTTPAPI_STREAMING_MAX_RESUMES) &&
+                        canResume(result, firstStatusCode, &body))
+                    {
+                        char range[RANGE_VALUE_SIZE];
+                        body.resumedFrom = first + body.received;
+                        if ((buildRangeValue(range, sizeof(range), body.resumedFrom, last, hasLast) != 0) ||
+                            (HTTPHeaders_ReplaceHeaderNameValuePair(resumeHeadersHandle, "Range", range) != HTTP_HEADERS_OK))
+                        {
+                            LogError("unable to add Range, the body is not resumed");
+                            isResumable = false;
+                        }
+                        else if ((body.resumedResponseHeadersHandle = HTTPHeaders_Alloc()) == NULL)
+                        {
+                            LogError("unable to HTTPHeaders_Alloc, the body is not resumed");
+                            isResumable = false;
+                        }
+                        else
+                        {
+                            unsigned int resumedStatusCode = 0;
+                            body.isRangeChecked = false;
+                            LogInfo("resuming the response body at byte %lu", (unsigned long)body.resumedFrom);
+                            result = execute(handle, HTTPAPI_REQUEST_GET, relativePath, resumeHeadersHandle, NULL, NULL,
+                                &resumedStatusCode, body.resumedResponseHeadersHandle, onResumableBodyReceived, &body);
+                            if ((result == HTTPAPI_OK) && (resumedStatusCode != 206))
+                            {
+                                /*the resource changed, or the range was not satisfiable: what came is not the rest of the body*/
+                                LogError("the resumed request got status %u instead of 206", resumedStatusCode);
+                                result = HTTPAPI_READ_DATA_FAILED;
+                                isResumable = false;
+                            }
+                            HTTPHeaders_Free(body.resumedResponseHeadersHandle);
+                            body.resumedResponseHeadersHandle = NULL;
+                            resumes++;
+                        }
+                    }
+                }
+                HTTPHeaders_Free(resumeHeadersHandle);
+            }
+        }
+
+        if ((statusCode != NULL) && (firstStatusCode != 0))
+        {
+            *statusCode = firstStatusCode;
+        }
+    }
+
+    return result;
+}
+
+HTTPAPI_RESULT HTTPAPIStreaming_ExecuteBuffered(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
+    HTTP_HEADERS_HANDLE httpHeadersHandle, ON_HTTPAPI_REQUEST_BODY_READ onRequestBodyRead, void* requestBodyContext,
+    unsigned int* statusCode, HTTP_HEADERS_HANDLE responseHeadersHandle,
+    ON_HTTPAPI_RESPONSE_BODY_RECEIVED onResponseBodyReceived, void* responseBodyContext)
+{
+    HTTPAPI_RESULT result = HTTPAPI_OK;
+    BUFFER_HANDLE requestContent;
+    BUFFER_HANDLE responseContent;
+
+    if ((requestContent = BUFFER_new()) == NULL)
+    {
+        result = HTTPAPI_ALLOC_FAILED;
+        LogError("(result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+    }
+    else
+    {
+        if ((responseContent = BUFFER_new()) == NULL)
+        {
+            result = HTTPAPI_ALLOC_FAILED;
+            LogError("(result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+        }
+        else
+        {
+            if (onRequestBodyRead != NULL)
+            {
+                unsigned char piece[256];
+                size_t pieceSize;
+                do
+                {
+                    pieceSize = 0;
+                    if ((onRequestBodyRead(requestBodyContext, piece, sizeof(piece), &pieceSize) != 0) ||
+                        (pieceSize > sizeof(piece)))
+                    {
+                        result = HTTPAPI_SEND_REQUEST_FAILED;
+                        LogError("Request body reader failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+                    }
+                    else if ((pieceSize > 0) && (BUFFER_append_build(requestContent, piece, pieceSize) != 0))
+                    {
+                        result = HTTPAPI_ALLOC_FAILED;
+                        LogError("(result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+                    }
+                } while ((result == HTTPAPI_OK) && (pieceSize > 0));
+            }
+
+            if ((result == HTTPAPI_OK) &&
+                ((result = HTTPAPI_ExecuteRequest(handle, requestType, relativePath, httpHeadersHandle,
+                    BUFFER_u_char(requestContent), BUFFER_length(requestContent), statusCode, responseHeadersHandle, responseContent)) == HTTPAPI_OK) &&
+                (onResponseBodyReceived != NULL) &&
+                (BUFFER_length(responseContent) > 0) &&
+                (onResponseBodyReceived(responseBodyContext, BUFFER_u_char(responseContent), BUFFER_length(responseContent)) != 0))
+            {
+                result = HTTPAPI_READ_DATA_FAILED;
+                LogError("Response body consumer failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+            }
+
+            BUFFER_delete(responseContent);
+        }
+        BUFFER_delete(requestContent);
+    }
+
+    return result;
+}
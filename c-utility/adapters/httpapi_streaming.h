@@ -0,0 +1,44 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/*this header is private to the httpapi adapters*/
+
+#ifndef HTTPAPI_STREAMING_H
+#define HTTPAPI_STREAMING_H
+
+#include "azure_c_shared_utility/httpapi.h"
+#include "azure_c_shared_utility/httpheaders.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*a response body cut short is resumed at most this many times*/
+#define HTTPAPI_STREAMING_MAX_RESUMES 3
+
+/*one attempt of HTTPAPI_ExecuteRequestStreaming, as the adapter implements it*/
+typedef HTTPAPI_RESULT(*HTTPAPI_STREAMING_EXECUTE)(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
+    HTTP_HEADERS_HANDLE httpHeadersHandle, ON_HTTPAPI_REQUEST_BODY_READ onRequestBodyRead, void* requestBodyContext,
+    unsigned int* statusCode, HTTP_HEADERS_HANDLE responseHeadersHandle,
+    ON_HTTPAPI_RESPONSE_BODY_RECEIVED onResponseBodyReceived, void* responseBodyContext);
+
+/*calls execute and, when the connection fails in the middle of the body of a 200 or 206 response to a GET that has a strong ETag or a Last-Modified header,
+calls it again with "Range: bytes=N-" and "If-Range" so that onResponseBodyReceived gets the rest of the body and never a byte twice.
+execute shall reopen the connection when the previous attempt failed. The resumed attempts need responseHeadersHandle to find the validator.*/
+extern HTTPAPI_RESULT HTTPAPIStreaming_ExecuteWithResume(HTTPAPI_STREAMING_EXECUTE execute, HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
+    HTTP_HEADERS_HANDLE httpHeadersHandle, ON_HTTPAPI_REQUEST_BODY_READ onRequestBodyRead, void* requestBodyContext,
+    unsigned int* statusCode, HTTP_HEADERS_HANDLE responseHeadersHandle,
+    ON_HTTPAPI_RESPONSE_BODY_RECEIVED onResponseBodyReceived, void* responseBodyContext);
+
+/*HTTPAPI_ExecuteRequestStreaming for the adapters that only send and receive whole bodies: the request body is read into memory,
+HTTPAPI_ExecuteRequest is called and the response body is handed to onResponseBodyReceived in one piece*/
+extern HTTPAPI_RESULT HTTPAPIStreaming_ExecuteBuffered(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
+    HTTP_HEADERS_HANDLE httpHeadersHandle, ON_HTTPAPI_REQUEST_BODY_READ onRequestBodyRead, void* requestBodyContext,
+    unsigned int* statusCode, HTTP_HEADERS_HANDLE responseHeadersHandle,
+    ON_HTTPAPI_RESPONSE_BODY_RECEIVED onResponseBodyReceived, void* responseBodyContext);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HTTPAPI_STREAMING_H */
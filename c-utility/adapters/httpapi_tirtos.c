@@ -10,6 +10,7 @@
 #include "azure_c_shared_utility/httpapi.h"
 #include "azure_c_shared_utility/strings.h"
 #include "azure_c_shared_utility/xlogging.h"
+#include "httpapi_streaming.h"
 
 #define CONTENT_BUF_LEN     128
 
@@ -285,6 +286,21 @@ headersDone:
     return (HTTPAPI_OK);
 }
 
+HTTPAPI_RESULT HTTPAPI_ExecuteRequestStreaming(HTTP_HANDLE handle,
+        HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
+        HTTP_HEADERS_HANDLE httpHeadersHandle,
+        ON_HTTPAPI_REQUEST_BODY_READ onRequestBodyRead, void* requestBodyContext,
+        unsigned int* statusCode,
+        HTTP_HEADERS_HANDLE responseHeadersHandle,
+        ON_HTTPAPI_RESPONSE_BODY_RECEIVED onResponseBodyReceived, void* responseBodyContext)
+{
+    /* HTTPCli needs the whole body up front, so the streams are buffered */
+    return (HTTPAPIStreaming_ExecuteBuffered(handle, requestType, relativePath,
+            httpHeadersHandle, onRequestBodyRead, requestBodyContext,
+            statusCode, responseHeadersHandle,
+            onResponseBodyReceived, responseBodyContext));
+}
+
 HTTPAPI_RESULT HTTPAPI_SetOption(HTTP_HANDLE handle, const char* optionName,
         const void* value)
 {
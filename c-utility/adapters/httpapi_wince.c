@@ -5,6 +5,7 @@
 #include "azure_c_shared_utility/httpheaders.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "azure_c_shared_utility/xlogging.h"
+#include "httpapi_streaming.h"
 #include "winsock2.h"
 #include "sslsock.h"
 #include "schnlsp.h"
@@ -597,6 +598,16 @@ exit:
     return result;
 }
 
+HTTPAPI_RESULT HTTPAPI_ExecuteRequestStreaming(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
+    HTTP_HEADERS_HANDLE httpHeadersHandle, ON_HTTPAPI_REQUEST_BODY_READ onRequestBodyRead, void* requestBodyContext,
+    unsigned int* statusCode, HTTP_HEADERS_HANDLE responseHeadersHandle,
+    ON_HTTPAPI_RESPONSE_BODY_RECEIVED onResponseBodyReceived, void* responseBodyContext)
+{
+    /*this adapter only sends and receives whole bodies, so the streams are buffered*/
+    return HTTPAPIStreaming_ExecuteBuffered(handle, requestType, relativePath, httpHeadersHandle, onRequestBodyRead, requestBodyContext,
+        statusCode, responseHeadersHandle, onResponseBodyReceived, responseBodyContext);
+}
+
 HTTPAPI_RESULT HTTPAPI_SetOption(HTTP_HANDLE handle, const char* optionName, const void* value)
 {
     HTTPAPI_RESULT result;
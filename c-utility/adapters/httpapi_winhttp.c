@@ -15,6 +15,7 @@
 #include "azure_c_shared_utility/strings.h"
 #include "azure_c_shared_utility/x509_schannel.h"
 #include "azure_c_shared_utility/shared_util_options.h"
+#include "httpapi_streaming.h"
 
 DEFINE_ENUM_STRINGS(HTTPAPI_RESULT, HTTPAPI_RESULT_VALUES)
 
@@ -760,6 +761,16 @@ HTTPAPI_RESULT HTTPAPI_ExecuteRequest(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE r
     return result;
 }
 
+HTTPAPI_RESULT HTTPAPI_ExecuteRequestStreaming(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
+    HTTP_HEADERS_HANDLE httpHeadersHandle, ON_HTTPAPI_REQUEST_BODY_READ onRequestBodyRead, void* requestBodyContext,
+    unsigned int* statusCode, HTTP_HEADERS_HANDLE responseHeadersHandle,
+    ON_HTTPAPI_RESPONSE_BODY_RECEIVED onResponseBodyReceived, void* responseBodyContext)
+{
+    /*this adapter only sends and receives whole bodies, so the streams are buffered*/
+    return HTTPAPIStreaming_ExecuteBuffered(handle, requestType, relativePath, httpHeadersHandle, onRequestBodyRead, requestBodyContext,
+        statusCode, responseHeadersHandle, onResponseBodyReceived, responseBodyContext);
+}
+
 HTTPAPI_RESULT HTTPAPI_SetOption(HTTP_HANDLE handle, const char* optionName, const void* value)
 {
     HTTPAPI_RESULT result;
@@ -0,0 +1,37 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef LINUX_FUTEX_H
+#define LINUX_FUTEX_H
+
+#include <stdint.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+/* the futex words are private to the process, the kernel can then skip the shared mapping lookup */
+static inline int futex_wait(volatile uint32_t* word, uint32_t expected, const struct timespec* relative_timeout)
+{
+    /* FUTEX_WAIT measures relative_timeout on CLOCK_MONOTONIC */
+    return (int)syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, expected, relative_timeout, NULL, 0);
+}
+
+static inline int futex_wake(volatile uint32_t* word, int count)
+{
+    return (int)syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+
+static inline void futex_cpu_relax(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+    __asm__ __volatile__("pause");
+#elif defined(__aarch64__) || (defined(__arm__) && defined(__ARM_ARCH) && (__ARM_ARCH >= 7))
+    __asm__ __volatile__("yield");
+#else
+    __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
+#endif /* LINUX_FUTEX_H */
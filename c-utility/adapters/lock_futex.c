@@ -0,0 +1,428 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#define _DEFAULT_SOURCE
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "linux_futex.h"
+
+/* upper bound of the adaptive spin before a thread parks on the futex */
+#ifndef FUTEX_LOCK_MAX_SPINS
+#define FUTEX_LOCK_MAX_SPINS 100
+#endif
+
+#define FUTEX_LOCK_UNLOCKED     0
+#define FUTEX_LOCK_LOCKED       1
+#define FUTEX_LOCK_CONTENDED    2
+
+#define FUTEX_RWLOCK_WRITER     0x80000000u
+
+typedef struct FUTEX_LOCK_TAG
+{
+    volatile uint32_t state;
+    /* running average of the spins that ended in an acquisition, the spin limit follows it */
+    volatile int32_t spin_budget;
+} FUTEX_LOCK;
+
+typedef struct FUTEX_RWLOCK_TAG
+{
+    /* FUTEX_RWLOCK_WRITER while a writer holds the lock, the number of readers otherwise */
+    volatile uint32_t state;
+    /* new readers stay out while a writer waits, so that a stream of readers cannot starve writers */
+    volatile uint32_t writers_waiting;
+    volatile uint32_t sleepers;
+} FUTEX_RWLOCK;
+
+/* spinning on a single core only delays the thread that holds the lock */
+static int32_t spin_limit = -1;
+
+static int32_t get_spin_limit(void)
+{
+    int32_t result = __atomic_load_n(&spin_limit, __ATOMIC_RELAXED);
+    if (result < 0)
+    {
+        result = (sysconf(_SC_NPROCESSORS_ONLN) > 1) ? FUTEX_LOCK_MAX_SPINS : 0;
+        __atomic_store_n(&spin_limit, result, __ATOMIC_RELAXED);
+    }
+    return result;
+}
+
+static int try_acquire(FUTEX_LOCK* lock)
+{
+    uint32_t expected = FUTEX_LOCK_UNLOCKED;
+    return __atomic_compare_exchange_n(&lock->state, &expected, FUTEX_LOCK_LOCKED, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+static int spin_acquire(FUTEX_LOCK* lock)
+{
+    int result = 0;
+    int32_t budget = __atomic_load_n(&lock->spin_budget, __ATOMIC_RELAXED);
+    int32_t max_spins = budget * 2 + 10;
+    int32_t spins;
+
+    if (max_spins > get_spin_limit())
+    {
+        max_spins = get_spin_limit();
+    }
+
+    for (spins = 0; spins < max_spins; spins++)
+    {
+        futex_cpu_relax();
+        /* read before the compare and swap, so that spinning threads share the cache line instead of bouncing it */
+        if ((__atomic_load_n(&lock->state, __ATOMIC_RELAXED) == FUTEX_LOCK_UNLOCKED) && try_acquire(lock))
+        {
+            result = 1;
+            break;
+        }
+    }
+
+    if (max_spins > 0)
+    {
+        /* the budget is a hint, concurrent updates may lose each other */
+        __atomic_store_n(&lock->spin_budget, budget + (spins - budget) / 8, __ATOMIC_RELAXED);
+    }
+    return result;
+}
+
+LOCK_HANDLE Lock_Init(void)
+{
+    /* Codes_SRS_LOCK_10_002: [Lock_Init on success shall return a valid lock handle which should be a non NULL value] */
+    FUTEX_LOCK* result = (FUTEX_LOCK*)malloc(sizeof(FUTEX_LOCK));
+    if (result == NULL)
+    {
+        /* Codes_SRS_LOCK_10_003: [Lock_Init on error shall return NULL ] */
+        LogError("malloc failed.");
+    }
+    else
+    {
+        result->state = FUTEX_LOCK_UNLOCKED;
+        result->spin_budget = 0;
+    }
+
+    return (LOCK_HANDLE)result;
+}
+
+LOCK_RESULT Lock(LOCK_HANDLE handle)
+{
+    LOCK_RESULT result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_LOCK_10_007: [Lock on NULL handle passed returns LOCK_ERROR] */
+        LogError("Invalid argument; handle is NULL.");
+        result = LOCK_ERROR;
+    }
+    else
+    {
+        FUTEX_LOCK* lock = (FUTEX_LOCK*)handle;
+        if (!try_acquire(lock) && !spin_acquire(lock))
+        {
+            /* mark the lock contended, so that the owner wakes a sleeper when it unlocks */
+            while (__atomic_exchange_n(&lock->state, FUTEX_LOCK_CONTENDED, __ATOMIC_ACQUIRE) != FUTEX_LOCK_UNLOCKED)
+            {
+                (void)futex_wait(&lock->state, FUTEX_LOCK_CONTENDED, NULL);
+            }
+        }
+
+        /* Codes_SRS_LOCK_10_005: [Lock on success shall return LOCK_OK] */
+        result = LOCK_OK;
+    }
+
+    return result;
+}
+
+LOCK_RESULT Lock_TryLock(LOCK_HANDLE handle)
+{
+    LOCK_RESULT result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_LOCK_99_002: [Lock_TryLock on NULL handle passed returns LOCK_ERROR] */
+        LogError("Invalid argument; handle is NULL.");
+        result = LOCK_ERROR;
+    }
+    else
+    {
+        /* Codes_SRS_LOCK_99_001: [Lock_TryLock shall return LOCK_OK when it acquired the lock and LOCK_BUSY when the lock is held, without blocking] */
+        result = try_acquire((FUTEX_LOCK*)handle) ? LOCK_OK : LOCK_BUSY;
+    }
+
+    return result;
+}
+
+LOCK_RESULT Unlock(LOCK_HANDLE handle)
+{
+    LOCK_RESULT result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_LOCK_10_007: [Unlock on NULL handle passed returns LOCK_ERROR] */
+        LogError("Invalid argument; handle is NULL.");
+        result = LOCK_ERROR;
+    }
+    else
+    {
+        FUTEX_LOCK* lock = (FUTEX_LOCK*)handle;
+        uint32_t previous = __atomic_exchange_n(&lock->state, FUTEX_LOCK_UNLOCKED, __ATOMIC_RELEASE);
+        if (previous == FUTEX_LOCK_UNLOCKED)
+        {
+            /* Codes_SRS_LOCK_10_010: [Unlock on error shall return LOCK_ERROR] */
+            LogError("Unlock called on a lock that is not held.");
+            result = LOCK_ERROR;
+        }
+        else
+        {
+            if (previous == FUTEX_LOCK_CONTENDED)
+            {
+                (void)futex_wake(&lock->state, 1);
+            }
+            /* Codes_SRS_LOCK_10_009: [Unlock on success shall return LOCK_OK] */
+            result = LOCK_OK;
+        }
+    }
+
+    return result;
+}
+
+LOCK_RESULT Lock_Deinit(LOCK_HANDLE handle)
+{
+    LOCK_RESULT result;
+    if (NULL == handle)
+    {
+        /* Codes_SRS_LOCK_10_007: [Lock_Deinit on NULL handle passed returns LOCK_ERROR] */
+        LogError("Invalid argument; handle is NULL.");
+        result = LOCK_ERROR;
+    }
+    else if (((FUTEX_LOCK*)handle)->state != FUTEX_LOCK_UNLOCKED)
+    {
+        LogError("Lock_Deinit called on a lock that is held.");
+        result = LOCK_ERROR;
+    }
+    else
+    {
+        /* Codes_SRS_LOCK_10_012: [Lock_Deinit frees the memory pointed by handle] */
+        free(handle);
+        result = LOCK_OK;
+    }
+
+    return result;
+}
+
+/* a sleeper registers itself before it reads the state one last time, releasers change the state before they look for sleepers */
+static void rwlock_sleep(FUTEX_RWLOCK* rwlock, int for_writer)
+{
+    uint32_t state;
+    (void)__atomic_add_fetch(&rwlock->sleepers, 1, __ATOMIC_SEQ_CST);
+    state = __atomic_load_n(&rwlock->state, __ATOMIC_SEQ_CST);
+    if (for_writer ? (state != 0) : (((state & FUTEX_RWLOCK_WRITER) != 0) || (__atomic_load_n(&rwlock->writers_waiting, __ATOMIC_SEQ_CST) != 0)))
+    {
+        (void)futex_wait(&rwlock->state, state, NULL);
+    }
+    (void)__atomic_sub_fetch(&rwlock->sleepers, 1, __ATOMIC_SEQ_CST);
+}
+
+static void rwlock_wake(FUTEX_RWLOCK* rwlock)
+{
+    if (__atomic_load_n(&rwlock->sleepers, __ATOMIC_SEQ_CST) != 0)
+    {
+        (void)futex_wake(&rwlock->state, INT_MAX);
+    }
+}
+
+RWLOCK_HANDLE RWLock_Init(void)
+{
+    /* Codes_SRS_LOCK_99_003: [RWLock_Init on success shall return a valid handle, NULL otherwise] */
+    FUTEX_RWLOCK* result = (FUTEX_RWLOCK*)malloc(sizeof(FUTEX_RWLOCK));
+    if (result == NULL)
+    {
+        LogError("malloc failed.");
+    }
+    else
+    {
+        result->state = 0;
+        result->writers_waiting = 0;
+        result->sleepers = 0;
+    }
+
+    return (RWLOCK_HANDLE)result;
+}
+
+LOCK_RESULT RWLock_ReadLock(RWLOCK_HANDLE handle)
+{
+    LOCK_RESULT result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_LOCK_99_005: [The RWLock functions return LOCK_ERROR on a NULL handle] */
+        LogError("Invalid argument; handle is NULL.");
+        result = LOCK_ERROR;
+    }
+    else
+    {
+        FUTEX_RWLOCK* rwlock = (FUTEX_RWLOCK*)handle;
+        int32_t max_spins = get_spin_limit();
+        int32_t spins = 0;
+
+        for (;;)
+        {
+            uint32_t state = __atomic_load_n(&rwlock->state, __ATOMIC_RELAXED);
+            if (((state & FUTEX_RWLOCK_WRITER) == 0) && (__atomic_load_n(&rwlock->writers_waiting, __ATOMIC_RELAXED) == 0))
+            {
+                if (__atomic_compare_exchange_n(&rwlock->state, &state, state + 1, 1, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+                {
+                    break;
+                }
+            }
+            else if (spins < max_spins)
+            {
+                spins++;
+                futex_cpu_relax();
+            }
+            else
+            {
+                rwlock_sleep(rwlock, 0);
+            }
+        }
+
+        /* Codes_SRS_LOCK_99_004: [RWLock_ReadLock shall let any number of readers hold the lock while no writer holds it] */
+        result = LOCK_OK;
+    }
+
+    return result;
+}
+
+LOCK_RESULT RWLock_ReadUnlock(RWLOCK_HANDLE handle)
+{
+    LOCK_RESULT result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_LOCK_99_005: [The RWLock functions return LOCK_ERROR on a NULL handle] */
+        LogError("Invalid argument; handle is NULL.");
+        result = LOCK_ERROR;
+    }
+    else
+    {
+        FUTEX_RWLOCK* rwlock = (FUTEX_RWLOCK*)handle;
+        uint32_t state = __atomic_load_n(&rwlock->state, __ATOMIC_RELAXED);
+
+        result = LOCK_OK;
+        do
+        {
+            if ((state == 0) || ((state & FUTEX_RWLOCK_WRITER) != 0))
+            {
+                LogError("RWLock_ReadUnlock called on a lock that is not read locked.");
+                result = LOCK_ERROR;
+                break;
+            }
+        } while (!__atomic_compare_exchange_n(&rwlock->state, &state, state - 1, 1, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED));
+
+        /* only the last reader can let a writer in */
+        if ((result == LOCK_OK) && (state == 1))
+        {
+            rwlock_wake(rwlock);
+        }
+    }
+
+    return result;
+}
+
+LOCK_RESULT RWLock_WriteLock(RWLOCK_HANDLE handle)
+{
+    LOCK_RESULT result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_LOCK_99_005: [The RWLock functions return LOCK_ERROR on a NULL handle] */
+        LogError("Invalid argument; handle is NULL.");
+        result = LOCK_ERROR;
+    }
+    else
+    {
+        FUTEX_RWLOCK* rwlock = (FUTEX_RWLOCK*)handle;
+        uint32_t state = 0;
+
+        if (!__atomic_compare_exchange_n(&rwlock->state, &state, FUTEX_RWLOCK_WRITER, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+        {
+            int32_t max_spins = get_spin_limit();
+            int32_t spins = 0;
+
+            (void)__atomic_add_fetch(&rwlock->writers_waiting, 1, __ATOMIC_SEQ_CST);
+            for (;;)
+            {
+                state = __atomic_load_n(&rwlock->state, __ATOMIC_RELAXED);
+                if (state == 0)
+                {
+                    if (__atomic_compare_exchange_n(&rwlock->state, &state, FUTEX_RWLOCK_WRITER, 1, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+                    {
+                        break;
+                    }
+                }
+                else if (spins < max_spins)
+                {
+                    spins++;
+                    futex_cpu_relax();
+                }
+                else
+                {
+                    rwlock_sleep(rwlock, 1);
+                }
+            }
+            (void)__atomic_sub_fetch(&rwlock->writers_waiting, 1, __ATOMIC_SEQ_CST);
+        }
+
+        /* Codes_SRS_LOCK_99_006: [RWLock_WriteLock shall give the lock to one writer while no reader holds it] */
+        result = LOCK_OK;
+    }
+
+    return result;
+}
+
+LOCK_RESULT RWLock_WriteUnlock(RWLOCK_HANDLE handle)
+{
+    LOCK_RESULT result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_LOCK_99_005: [The RWLock functions return LOCK_ERROR on a NULL handle] */
+        LogError("Invalid argument; handle is NULL.");
+        result = LOCK_ERROR;
+    }
+    else
+    {
+        FUTEX_RWLOCK* rwlock = (FUTEX_RWLOCK*)handle;
+        uint32_t state = FUTEX_RWLOCK_WRITER;
+        if (!__atomic_compare_exchange_n(&rwlock->state, &state, 0, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+        {
+            LogError("RWLock_WriteUnlock called on a lock that is not write locked.");
+            result = LOCK_ERROR;
+        }
+        else
+        {
+            rwlock_wake(rwlock);
+            result = LOCK_OK;
+        }
+    }
+
+    return result;
+}
+
+LOCK_RESULT RWLock_Deinit(RWLOCK_HANDLE handle)
+{
+    LOCK_RESULT result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_LOCK_99_005: [The RWLock functions return LOCK_ERROR on a NULL handle] */
+        LogError("Invalid argument; handle is NULL.");
+        result = LOCK_ERROR;
+    }
+    else if (((FUTEX_RWLOCK*)handle)->state != 0)
+    {
+        LogError("RWLock_Deinit called on a lock that is held.");
+        result = LOCK_ERROR;
+    }
+    else
+    {
+        free(handle);
+        result = LOCK_OK;
+    }
+
+    return result;
+}
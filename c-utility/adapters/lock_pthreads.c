@@ -1,7 +1,10 @@
 // Copyright (c) Microsoft. All rights reserved.
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
+#define _DEFAULT_SOURCE
+
 #include <stdlib.h>
+#include <errno.h>
 #include <pthread.h>
 #include "azure_c_shared_utility/lock.h"
 #include "azure_c_shared_utility/xlogging.h"
@@ -55,6 +58,37 @@ LOCK_RESULT Lock(LOCK_HANDLE handle)
 	return result;
 }
 
+LOCK_RESULT Lock_TryLock(LOCK_HANDLE handle)
+{
+    LOCK_RESULT result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_LOCK_99_002: [Lock_TryLock on NULL handle passed returns LOCK_ERROR] */
+        LogError("Invalid argument; handle is NULL.");
+        result = LOCK_ERROR;
+    }
+    else
+    {
+        /* Codes_SRS_LOCK_99_001: [Lock_TryLock shall return LOCK_OK when it acquired the lock and LOCK_BUSY when the lock is held, without blocking] */
+        int trylock_result = pthread_mutex_trylock((pthread_mutex_t*)handle);
+        if (trylock_result == 0)
+        {
+            result = LOCK_OK;
+        }
+        else if (trylock_result == EBUSY)
+        {
+            result = LOCK_BUSY;
+        }
+        else
+        {
+            LogError("pthread_mutex_trylock failed.");
+            result = LOCK_ERROR;
+        }
+    }
+
+    return result;
+}
+
 LOCK_RESULT Unlock(LOCK_HANDLE handle)
 {
 	LOCK_RESULT result;
@@ -109,3 +143,134 @@ LOCK_RESULT Lock_Deinit(LOCK_HANDLE handle)
 	
 	return result;
 }
+
+RWLOCK_HANDLE RWLock_Init(void)
+{
+    /* Codes_SRS_LOCK_99_003: [RWLock_Init on success shall return a valid handle, NULL otherwise] */
+    pthread_rwlock_t* result = (pthread_rwlock_t*)malloc(sizeof(pthread_rwlock_t));
+    if (result == NULL)
+    {
+        LogError("malloc failed.");
+    }
+    else if (pthread_rwlock_init(result, NULL) != 0)
+    {
+        LogError("pthread_rwlock_init failed.");
+        free(result);
+        result = NULL;
+    }
+
+    return (RWLOCK_HANDLE)result;
+}
+
+LOCK_RESULT RWLock_ReadLock(RWLOCK_HANDLE handle)
+{
+    LOCK_RESULT result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_LOCK_99_005: [The RWLock functions return LOCK_ERROR on a NULL handle] */
+        LogError("Invalid argument; handle is NULL.");
+        result = LOCK_ERROR;
+    }
+    else if (pthread_rwlock_rdlock((pthread_rwlock_t*)handle) != 0)
+    {
+        LogError("pthread_rwlock_rdlock failed.");
+        result = LOCK_ERROR;
+    }
+    else
+    {
+        /* Codes_SRS_LOCK_99_004: [RWLock_ReadLock shall let any number of readers hold the lock while no writer holds it] */
+        result = LOCK_OK;
+    }
+
+    return result;
+}
+
+LOCK_RESULT RWLock_ReadUnlock(RWLOCK_HANDLE handle)
+{
+    LOCK_RESULT result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_LOCK_99_005: [The RWLock functions return LOCK_ERROR on a NULL handle] */
+        LogError("Invalid argument; handle is NULL.");
+        result = LOCK_ERROR;
+    }
+    else if (pthread_rwlock_unlock((pthread_rwlock_t*)handle) != 0)
+    {
+        LogError("pthread_rwlock_unlock failed.");
+        result = LOCK_ERROR;
+    }
+    else
+    {
+        result = LOCK_OK;
+    }
+
+    return result;
+}
+
+LOCK_RESULT RWLock_WriteLock(RWLOCK_HANDLE handle)
+{
+    LOCK_RESULT result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_LOCK_99_005: [The RWLock functions return LOCK_ERROR on a NULL handle] */
+        LogError("Invalid argument; handle is NULL.");
+        result = LOCK_ERROR;
+    }
+    else if (pthread_rwlock_wrlock((pthread_rwlock_t*)handle) != 0)
+    {
+        LogError("pthread_rwlock_wrlock failed.");
+        result = LOCK_ERROR;
+    }
+    else
+    {
+        /* Codes_SRS_LOCK_99_006: [RWLock_WriteLock shall give the lock to one writer while no reader holds it] */
+        result = LOCK_OK;
+    }
+
+    return result;
+}
+
+LOCK_RESULT RWLock_WriteUnlock(RWLOCK_HANDLE handle)
+{
+    LOCK_RESULT result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_LOCK_99_005: [The RWLock functions return LOCK_ERROR on a NULL handle] */
+        LogError("Invalid argument; handle is NULL.");
+        result = LOCK_ERROR;
+    }
+    else if (pthread_rwlock_unlock((pthread_rwlock_t*)handle) != 0)
+    {
+        LogError("pthread_rwlock_unlock failed.");
+        result = LOCK_ERROR;
+    }
+    else
+    {
+        result = LOCK_OK;
+    }
+
+    return result;
+}
+
+LOCK_RESULT RWLock_Deinit(RWLOCK_HANDLE handle)
+{
+    LOCK_RESULT result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_LOCK_99_005: [The RWLock functions return LOCK_ERROR on a NULL handle] */
+        LogError("Invalid argument; handle is NULL.");
+        result = LOCK_ERROR;
+    }
+    else if (pthread_rwlock_destroy((pthread_rwlock_t*)handle) != 0)
+    {
+        LogError("pthread_rwlock_destroy failed.");
+        result = LOCK_ERROR;
+    }
+    else
+    {
+        free(handle);
+        result = LOCK_OK;
+    }
+
+    return result;
+}
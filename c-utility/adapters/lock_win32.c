@@ -84,6 +84,37 @@ LOCK_RESULT Lock(LOCK_HANDLE handle)
     return result;
 }
 
+LOCK_RESULT Lock_TryLock(LOCK_HANDLE handle)
+{
+    LOCK_RESULT result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_LOCK_99_002: [Lock_TryLock on NULL handle passed returns LOCK_ERROR] */
+        LogError("Invalid argument; handle is NULL.");
+        result = LOCK_ERROR;
+    }
+    else
+    {
+        /* Codes_SRS_LOCK_99_001: [Lock_TryLock shall return LOCK_OK when it acquired the lock and LOCK_BUSY when the lock is held, without blocking] */
+        DWORD rv = WaitForSingleObject((HANDLE)handle, 0);
+        switch (rv)
+        {
+            case WAIT_OBJECT_0:
+                result = LOCK_OK;
+                break;
+            case WAIT_TIMEOUT:
+                result = LOCK_BUSY;
+                break;
+            default:
+                LogError("WaitForSingleObject failed: %d", GetLastError());
+                result = LOCK_ERROR;
+                break;
+        }
+    }
+
+    return result;
+}
+
 LOCK_RESULT Unlock(LOCK_HANDLE handle)
 {
     LOCK_RESULT result;
@@ -110,3 +141,112 @@ LOCK_RESULT Unlock(LOCK_HANDLE handle)
     
     return result;
 }
+
+/* a slim reader/writer lock is a single pointer sized word, it does not need a kernel object */
+RWLOCK_HANDLE RWLock_Init(void)
+{
+    /* Codes_SRS_LOCK_99_003: [RWLock_Init on success shall return a valid handle, NULL otherwise] */
+    PSRWLOCK result = (PSRWLOCK)malloc(sizeof(SRWLOCK));
+    if (result == NULL)
+    {
+        LogError("malloc failed.");
+    }
+    else
+    {
+        InitializeSRWLock(result);
+    }
+
+    return (RWLOCK_HANDLE)result;
+}
+
+LOCK_RESULT RWLock_ReadLock(RWLOCK_HANDLE handle)
+{
+    LOCK_RESULT result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_LOCK_99_005: [The RWLock functions return LOCK_ERROR on a NULL handle] */
+        LogError("Invalid argument; handle is NULL.");
+        result = LOCK_ERROR;
+    }
+    else
+    {
+        /* Codes_SRS_LOCK_99_004: [RWLock_ReadLock shall let any number of readers hold the lock while no writer holds it] */
+        AcquireSRWLockShared((PSRWLOCK)handle);
+        result = LOCK_OK;
+    }
+
+    return result;
+}
+
+LOCK_RESULT RWLock_ReadUnlock(RWLOCK_HANDLE handle)
+{
+    LOCK_RESULT result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_LOCK_99_005: [The RWLock functions return LOCK_ERROR on a NULL handle] */
+        LogError("Invalid argument; handle is NULL.");
+        result = LOCK_ERROR;
+    }
+    else
+    {
+        ReleaseSRWLockShared((PSRWLOCK)handle);
+        result = LOCK_OK;
+    }
+
+    return result;
+}
+
+LOCK_RESULT RWLock_WriteLock(RWLOCK_HANDLE handle)
+{
+    LOCK_RESULT result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_LOCK_99_005: [The RWLock functions return LOCK_ERROR on a NULL handle] */
+        LogError("Invalid argument; handle is NULL.");
+        result = LOCK_ERROR;
+    }
+    else
+    {
+        /* Codes_SRS_LOCK_99_006: [RWLock_WriteLock shall give the lock to one writer while no reader holds it] */
+        AcquireSRWLockExclusive((PSRWLOCK)handle);
+        result = LOCK_OK;
+    }
+
+    return result;
+}
+
+LOCK_RESULT RWLock_WriteUnlock(RWLOCK_HANDLE handle)
+{
+    LOCK_RESULT result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_LOCK_99_005: [The RWLock functions return LOCK_ERROR on a NULL handle] */
+        LogError("Invalid argument; handle is NULL.");
+        result = LOCK_ERROR;
+    }
+    else
+    {
+        ReleaseSRWLockExclusive((PSRWLOCK)handle);
+        result = LOCK_OK;
+    }
+
+    return result;
+}
+
+LOCK_RESULT RWLock_Deinit(RWLOCK_HANDLE handle)
+{
+    LOCK_RESULT result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_LOCK_99_005: [The RWLock functions return LOCK_ERROR on a NULL handle] */
+        LogError("Invalid argument; handle is NULL.");
+        result = LOCK_ERROR;
+    }
+    else
+    {
+        free(handle);
+        result = LOCK_OK;
+    }
+
+    return result;
+}
@@ -449,7 +449,16 @@ function(build_c_test_artifacts whatIsBuilding use_gballoc folder)
     endif()
 
     #setting output type
-    if(WIN32)
+    #perf suites are matched first, their names can contain "ut" or "int" too
+    if("${whatIsBuilding}" MATCHES ".*_perf$")
+        if(${run_perf_tests})
+            if(WIN32)
+                c_windows_unittests_add_exe(${whatIsBuilding} ${folder} ${ARGN})
+            else()
+                c_linux_unittests_add_exe(${whatIsBuilding} ${folder} ${ARGN})
+            endif()
+        endif()
+    elseif(WIN32)
         if(
             (("${whatIsBuilding}" MATCHES ".*ut.*") AND ${run_unittests}) OR
             (("${whatIsBuilding}" MATCHES ".*e2e.*") AND ${run_e2e_tests}) OR
@@ -564,8 +573,17 @@ function(set_platform_files c_shared_dir)
         set(LOGGING_C_FILE ${c_shared_dir}/src/consolelogger.c PARENT_SCOPE)
         set(LOGGING_H_FILE ${c_shared_dir}/inc/azure_c_shared_utility/consolelogger.h PARENT_SCOPE)
         
-        if(${use_condition})
-            set(CONDITION_C_FILE ${c_shared_dir}/adapters/condition_pthreads.c PARENT_SCOPE)
+        if(${use_futex_lock} AND CMAKE_SYSTEM_NAME STREQUAL "Linux")
+            # the futex lock word is not a pthread_mutex_t, the condition adapter has to come with it
+            if(${use_condition})
+                set(CONDITION_C_FILE ${c_shared_dir}/adapters/condition_futex.c PARENT_SCOPE)
+            endif()
+            set(LOCK_C_FILE ${c_shared_dir}/adapters/lock_futex.c PARENT_SCOPE)
+        else()
+            if(${use_condition})
+                set(CONDITION_C_FILE ${c_shared_dir}/adapters/condition_pthreads.c PARENT_SCOPE)
+            endif()
+            set(LOCK_C_FILE ${c_shared_dir}/adapters/lock_pthreads.c PARENT_SCOPE)
         endif()
 
         if (${use_builtin_httpapi})
@@ -573,7 +591,6 @@ function(set_platform_files c_shared_dir)
         else()
             set(HTTP_C_FILE ${c_shared_dir}/adapters/httpapi_curl.c PARENT_SCOPE)
         endif()
-        set(LOCK_C_FILE ${c_shared_dir}/adapters/lock_pthreads.c PARENT_SCOPE)
         if (use_applessl)
             set(PLATFORM_C_FILE ${c_shared_dir}/pal/ios-osx/platform_appleios.c PARENT_SCOPE)
         else()
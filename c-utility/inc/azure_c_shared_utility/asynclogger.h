@@ -0,0 +1,64 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef ASYNCLOGGER_H
+#define ASYNCLOGGER_H
+
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#endif /* __cplusplus */
+
+/* Bytes kept from the formatted message of each record; longer messages are cut and end in "...". */
+#define ASYNC_LOGGER_MESSAGE_SIZE 200
+
+typedef struct ASYNC_LOGGER_STATISTICS_TAG
+{
+    /* records the background thread has written out */
+    size_t written;
+    /* records thrown away because the ring was full */
+    size_t dropped;
+} ASYNC_LOGGER_STATISTICS;
+
+/**
+ * @brief   Installs the asynchronous logger as the xlogging log function.
+ *
+ *          Every LogInfo/LogError formats its message into a fixed size record of a
+ *          lock-free ring and returns; a background thread takes the records out, in
+ *          order, and prints them like consolelogger_log does. The calling thread never
+ *          waits on stdio: when the ring is full the record is dropped and counted.
+ *
+ * @param   record_count    Number of records in the ring. It is rounded up to a power of two.
+ *
+ * @return  0 on success, a non-zero value if the logger is already started, @p record_count
+ *          is 0, or the ring or the thread cannot be created.
+ */
+MOCKABLE_FUNCTION(, int, asynclogger_start, size_t, record_count);
+
+/**
+ * @brief   Writes out every record still in the ring, stops the background thread and
+ *          puts back the log function that was installed before asynclogger_start.
+ */
+MOCKABLE_FUNCTION(, void, asynclogger_stop);
+
+/**
+ * @brief   Fills @p statistics with the number of records written and dropped since
+ *          the last asynclogger_start. The counters survive asynclogger_stop.
+ *
+ * @return  0 on success, a non-zero value if @p statistics is NULL.
+ */
+MOCKABLE_FUNCTION(, int, asynclogger_get_statistics, ASYNC_LOGGER_STATISTICS*, statistics);
+
+/* The LOGGER_LOG installed by asynclogger_start. */
+extern void asynclogger_log(LOG_CATEGORY log_category, const char* file, const char* func, int line, unsigned int options, const char* format, ...);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* ASYNCLOGGER_H */
@@ -9,6 +9,7 @@
 #ifndef BASE64_H
 #define BASE64_H
 
+#include "azure_c_shared_utility/macro_utils.h"
 #include "azure_c_shared_utility/strings.h"
 #include "azure_c_shared_utility/buffer_.h"
 
@@ -21,6 +22,21 @@ extern "C" {
 
 #include "azure_c_shared_utility/umock_c_prod.h"
 
+/** @brief	The number of characters, not counting the null terminator, of the base64 encoding of @p size bytes. */
+#define BASE64_ENCODED_LENGTH(size) ((((size) + 2) / 3) * 4)
+
+/** @brief	The most bytes that @p length base64 characters can decode to. */
+#define BASE64_DECODED_MAX_SIZE(length) ((((length) + 3) / 4) * 3)
+
+#define BASE64_IMPLEMENTATION_VALUES \
+    BASE64_IMPLEMENTATION_AUTO,      \
+    BASE64_IMPLEMENTATION_PORTABLE,  \
+    BASE64_IMPLEMENTATION_SSSE3,     \
+    BASE64_IMPLEMENTATION_AVX2,      \
+    BASE64_IMPLEMENTATION_NEON
+
+DEFINE_ENUM(BASE64_IMPLEMENTATION, BASE64_IMPLEMENTATION_VALUES)
+
 
 /**
  * @brief	Base64 encodes a buffer and returns the resulting string.
@@ -76,6 +92,68 @@ MOCKABLE_FUNCTION(, STRING_HANDLE, Base64_Encode_Bytes, const unsigned char*, so
  */
 MOCKABLE_FUNCTION(, BUFFER_HANDLE, Base64_Decoder, const char*, source);
 
+/**
+ * @brief	Base64 encodes the @p size bytes at @p source into the caller's buffer.
+ *
+ * @param	destination   	The buffer receiving the encoding and a null terminator.
+ * @param	destinationSize	The size of @p destination, at least BASE64_ENCODED_LENGTH(@p size) + 1.
+ * @param	source        	The bytes to encode, can be @c NULL when @p size is zero.
+ * @param	size          	The number of bytes to encode.
+ * @param	encodedLength 	Optional, receives the number of characters written, not counting the null terminator.
+ *
+ * 			@c Base64_EncodeInto does not allocate memory. Its output is the same as the one of
+ * 			@c Base64_Encode_Bytes, including the "=" padding.
+ *
+ * @return	0 on success, a non-zero value if an argument is invalid or @p destination is too small.
+ */
+MOCKABLE_FUNCTION(, int, Base64_EncodeInto, char*, destination, size_t, destinationSize, const unsigned char*, source, size_t, size, size_t*, encodedLength);
+
+/**
+ * @brief	Base64 decodes the @p length characters at @p source into the caller's buffer.
+ *
+ * @param	destination    	The buffer receiving the decoded bytes.
+ * @param	destinationSize	The size of @p destination, BASE64_DECODED_MAX_SIZE(@p length) is always enough.
+ * @param	source         	The characters to decode, they do not need to be null terminated.
+ * @param	length         	The number of characters to decode.
+ * @param	decodedSize    	Optional, receives the number of bytes written.
+ *
+ * 			The "=" padding is optional. @c Base64_DecodeInto fails on characters outside the
+ * 			alphabet, on a length that no encoding has and on a last character with bits that
+ * 			do not belong to the encoded bytes. @c Base64_DecodeInto does not allocate memory,
+ * 			the content of @p destination is unspecified when it fails.
+ *
+ * @return	0 on success, a non-zero value if an argument is invalid, @p source is not a
+ * 			base64 encoding or @p destination is too small.
+ */
+MOCKABLE_FUNCTION(, int, Base64_DecodeInto, unsigned char*, destination, size_t, destinationSize, const char*, source, size_t, length, size_t*, decodedSize);
+
+/**
+ * @brief	Same as @c Base64_EncodeInto, with the "base64url" alphabet of RFC 4648 that uses "-" and "_" for 62 and 63.
+ */
+MOCKABLE_FUNCTION(, int, Base64Url_EncodeInto, char*, destination, size_t, destinationSize, const unsigned char*, source, size_t, size, size_t*, encodedLength);
+
+/**
+ * @brief	Same as @c Base64_DecodeInto, with the "base64url" alphabet of RFC 4648 that uses "-" and "_" for 62 and 63.
+ */
+MOCKABLE_FUNCTION(, int, Base64Url_DecodeInto, unsigned char*, destination, size_t, destinationSize, const char*, source, size_t, length, size_t*, decodedSize);
+
+/**
+ * @brief	Selects the code encoding and decoding runs of base64 characters.
+ *
+ * @param	implementation	@c BASE64_IMPLEMENTATION_AUTO picks the widest vector instructions the CPU has.
+ *
+ * 			All implementations produce the same results, selecting one is meant for tests and
+ * 			benchmarks.
+ *
+ * @return	0 on success, a non-zero value if this CPU or build does not support @p implementation.
+ */
+MOCKABLE_FUNCTION(, int, Base64_SetImplementation, BASE64_IMPLEMENTATION, implementation);
+
+/**
+ * @brief	Returns the implementation in use, after resolving @c BASE64_IMPLEMENTATION_AUTO.
+ */
+MOCKABLE_FUNCTION(, BASE64_IMPLEMENTATION, Base64_GetImplementation);
+
 #ifdef __cplusplus
 }
 #endif
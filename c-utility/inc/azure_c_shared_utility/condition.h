@@ -4,6 +4,12 @@
 #ifndef CONDITION_H
 #define CONDITION_H
 
+#ifdef __cplusplus
+#include <cstdint>
+#else
+#include <stdint.h>
+#endif
+
 #include "azure_c_shared_utility/macro_utils.h"
 #include "azure_c_shared_utility/lock.h"
 #include "azure_c_shared_utility/umock_c_prod.h"
@@ -55,6 +61,22 @@ MOCKABLE_FUNCTION(, COND_RESULT, Condition_Post, COND_HANDLE, handle);
 */
 MOCKABLE_FUNCTION(, COND_RESULT, Condition_Wait, COND_HANDLE, handle, LOCK_HANDLE, lock, int, timeout_milliseconds);
 
+/**
+* @brief	block on the condition handle until the thread is signalled
+*           or until timeout_nanoseconds have elapsed. The timeout is
+*           measured on a monotonic clock where the platform has one, so
+*           steps of the wall clock neither shorten nor extend the wait.
+*
+* @param	handle	A valid handle to the condition.
+* @param	lock	The lock held by the caller, released while waiting.
+* @param	timeout_nanoseconds	The relative timeout, @c 0 waits until signalled.
+*
+* @return	Returns @c COND_OK when the condition was signalled,
+* 			@c COND_TIMEOUT when the timeout elapsed first
+* 			and @c COND_ERROR when an error occurs.
+*/
+MOCKABLE_FUNCTION(, COND_RESULT, Condition_WaitNanoseconds, COND_HANDLE, handle, LOCK_HANDLE, lock, uint64_t, timeout_nanoseconds);
+
 /**
 * @brief	The condition instance is deinitialized.
 *
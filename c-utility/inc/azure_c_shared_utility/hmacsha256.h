@@ -19,8 +19,19 @@ extern "C" {
 
 DEFINE_ENUM(HMACSHA256_RESULT, HMACSHA256_RESULT_VALUES)
 
+#define HMACSHA256_HASH_SIZE 32
+
+typedef struct HMACSHA256_KEY_TAG* HMACSHA256_KEY_HANDLE;
+
 MOCKABLE_FUNCTION(, HMACSHA256_RESULT, HMACSHA256_ComputeHash, const unsigned char*, key, size_t, keyLen, const unsigned char*, payload, size_t, payloadLen, BUFFER_HANDLE, hash);
 
+/*a key object holds the inner and outer SHA-256 states of the key, so signing with it does not hash the pads again*/
+MOCKABLE_FUNCTION(, HMACSHA256_KEY_HANDLE, HMACSHA256_CreateKey, const unsigned char*, key, size_t, keyLen);
+/*the payload of every hash computed with the key is prefix followed by payload, the prefix is hashed only once here*/
+MOCKABLE_FUNCTION(, HMACSHA256_KEY_HANDLE, HMACSHA256_CreateKeyWithPrefix, const unsigned char*, key, size_t, keyLen, const unsigned char*, prefix, size_t, prefixLen);
+MOCKABLE_FUNCTION(, HMACSHA256_RESULT, HMACSHA256_ComputeHashWithKey, HMACSHA256_KEY_HANDLE, key, const unsigned char*, payload, size_t, payloadLen, unsigned char*, hash);
+MOCKABLE_FUNCTION(, void, HMACSHA256_DestroyKey, HMACSHA256_KEY_HANDLE, key);
+
 #ifdef __cplusplus
 }
 #endif
@@ -163,6 +163,67 @@ MOCKABLE_FUNCTION(, HTTPAPI_RESULT, HTTPAPI_ExecuteRequest, HTTP_HANDLE, handle,
                                              size_t, contentLength, unsigned int*, statusCode,
                                              HTTP_HEADERS_HANDLE, responseHeadersHandle, BUFFER_HANDLE, responseContent);
 
+/**
+ * @brief	Supplies the next piece of a streamed request body.
+ *
+ * @param	context			The @c requestBodyContext given to ::HTTPAPI_ExecuteRequestStreaming.
+ * @param	buffer			Where to write the next piece of the body.
+ * @param	bufferSize		Size of @p buffer.
+ * @param	bytesWritten	Receives the number of bytes written to @p buffer, 0 when the body
+ * 							has ended.
+ *
+ * @return	0 on success, any other value aborts the request.
+ */
+typedef int(*ON_HTTPAPI_REQUEST_BODY_READ)(void* context, unsigned char* buffer, size_t bufferSize, size_t* bytesWritten);
+
+/**
+ * @brief	Receives the next piece of a streamed response body.
+ *
+ * @param	context		The @c responseBodyContext given to ::HTTPAPI_ExecuteRequestStreaming.
+ * @param	buffer		The piece of the body, only valid during the call.
+ * @param	size		Number of bytes in @p buffer.
+ *
+ * @return	0 on success, any other value aborts the request.
+ */
+typedef int(*ON_HTTPAPI_RESPONSE_BODY_RECEIVED)(void* context, const unsigned char* buffer, size_t size);
+
+/**
+ * @brief	Same as ::HTTPAPI_ExecuteRequest, except that the bodies are streamed
+ * 			instead of being held in memory.
+ *
+ * @param	handle					The handle to the HTTP connection created
+ * 									via ::HTTPAPI_CreateConnection.
+ * @param	requestType				Specifies which HTTP method is used.
+ * @param	relativePath			Specifies the relative path of the URL
+ * 									excluding the host name.
+ * @param	httpHeadersHandle		The HTTP headers of the request.
+ * @param	onRequestBodyRead		Called until it reports 0 bytes to get the request body,
+ * 									which is sent with <tt>Transfer-Encoding: chunked</tt>, so
+ * 									@p httpHeadersHandle shall not have a Content-Length header.
+ * 									@c NULL when the request has no body.
+ * @param	requestBodyContext		Passed to @p onRequestBodyRead.
+ * @param	statusCode				Receives the status code of the response.
+ * @param	responseHeadersHandle	Receives the HTTP headers of the response.
+ * @param	onResponseBodyReceived	Called with each piece of the response body as it arrives,
+ * 									@c NULL to ignore the body.
+ * @param	responseBodyContext		Passed to @p onResponseBodyReceived.
+ *
+ *			Adapters that can only send and receive whole bodies implement this
+ *			by buffering them. The streaming adapters (compact and curl) resume
+ *			a GET whose connection fails in the middle of the body: when the
+ *			response has a strong ETag or a Last-Modified header they ask for the
+ *			rest with <tt>Range: bytes=N-</tt> and <tt>If-Range</tt>, so
+ *			@p onResponseBodyReceived never gets a byte twice. Resuming needs
+ *			@p responseHeadersHandle.
+ *
+ * @return	@c HTTPAPI_OK if the API call is successful or an error
+ * 			code in case it fails.
+ */
+MOCKABLE_FUNCTION(, HTTPAPI_RESULT, HTTPAPI_ExecuteRequestStreaming, HTTP_HANDLE, handle, HTTPAPI_REQUEST_TYPE, requestType, const char*, relativePath,
+                                             HTTP_HEADERS_HANDLE, httpHeadersHandle, ON_HTTPAPI_REQUEST_BODY_READ, onRequestBodyRead, void*, requestBodyContext,
+                                             unsigned int*, statusCode, HTTP_HEADERS_HANDLE, responseHeadersHandle,
+                                             ON_HTTPAPI_RESPONSE_BODY_RECEIVED, onResponseBodyReceived, void*, responseBodyContext);
+
 /**
  * @brief	Sets the option named @p optionName bearing the value
  * 			@p value for the HTTP_HANDLE @p handle.
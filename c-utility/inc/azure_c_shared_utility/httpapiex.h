@@ -11,6 +11,7 @@
 *					- Implementation independent
 *					- Retry mechanism
 *					- Persistent options
+*					- Optional pool of idle connections shared by all handles
 */
 
 #ifndef HTTPAPIEX_H
@@ -22,9 +23,11 @@
  
 #ifdef __cplusplus
 #include <cstddef>
+#include <cstdint>
 extern "C" {
 #else
 #include <stddef.h>
+#include <stdint.h>
 #endif
 
 typedef struct HTTPAPIEX_HANDLE_DATA_TAG* HTTPAPIEX_HANDLE;
@@ -40,6 +43,24 @@ typedef struct HTTPAPIEX_HANDLE_DATA_TAG* HTTPAPIEX_HANDLE;
 */
 DEFINE_ENUM(HTTPAPIEX_RESULT, HTTPAPIEX_RESULT_VALUES);
 
+/** @brief Counters kept by the connection pool since it was enabled.
+*
+*	@details	The reuse ratio is requestsOnReusedConnections / (requestsOnNewConnections + requestsOnReusedConnections).
+*				estimatedHandshakeTimeSavedInMilliseconds is requestsOnReusedConnections times the difference between
+*				the average duration of a request on a new connection (which includes connecting and the TLS handshake)
+*				and the average duration of a request on a reused connection.
+*/
+typedef struct HTTPAPIEX_CONNECTION_POOL_STATISTICS_TAG
+{
+    uint64_t requestsOnNewConnections;
+    uint64_t requestsOnReusedConnections;
+    uint64_t newConnectionsRequestTimeInMilliseconds;
+    uint64_t reusedConnectionsRequestTimeInMilliseconds;
+    uint64_t estimatedHandshakeTimeSavedInMilliseconds;
+    uint64_t connectionsExpired;
+    uint64_t connectionsDiscarded;
+} HTTPAPIEX_CONNECTION_POOL_STATISTICS;
+
 /**
  * @brief	Creates an @c HTTPAPIEX_HANDLE that can be used in further calls.
  *
@@ -99,6 +120,40 @@ MOCKABLE_FUNCTION(, void, HTTPAPIEX_Destroy, HTTPAPIEX_HANDLE, handle);
  */
 MOCKABLE_FUNCTION(, HTTPAPIEX_RESULT, HTTPAPIEX_SetOption, HTTPAPIEX_HANDLE, handle, const char*, optionName, const void*, value);
 
+/**
+ * @brief	Enables a pool of idle connections shared by all the @c HTTPAPIEX_HANDLE objects.
+ *
+ * @param	maxIdleConnectionsPerHost	Maximum number of idle connections kept for the same host and
+ * 										connection options.
+ * @param	idleTimeoutInMilliseconds	Idle connections older than this are closed instead of reused.
+ *
+ *			When the pool is enabled a handle takes an idle connection to the same host, with the
+ *			same TLS options, before creating a new one and gives it back when the request completes,
+ *			so bursts of requests from different handles do not pay a TCP and TLS handshake each.
+ *			Handles with options that cannot be compared never share connections. Calling it again
+ *			changes the limits. It shall be called before the handles execute requests.
+ *
+ * @return	An @c HTTPAPIEX_RESULT indicating the status of the call.
+ */
+MOCKABLE_FUNCTION(, HTTPAPIEX_RESULT, HTTPAPIEX_EnableConnectionPool, size_t, maxIdleConnectionsPerHost, unsigned int, idleTimeoutInMilliseconds);
+
+/**
+ * @brief	Closes all the idle connections and disables the connection pool.
+ *
+ *			Requests that are using the pool keep it until they end, the last
+ *			of them frees it.
+ */
+MOCKABLE_FUNCTION(, void, HTTPAPIEX_DisableConnectionPool);
+
+/**
+ * @brief	Retrieves the counters of the connection pool.
+ *
+ * @param	statistics	Receives the counters.
+ *
+ * @return	An @c HTTPAPIEX_RESULT indicating the status of the call.
+ */
+MOCKABLE_FUNCTION(, HTTPAPIEX_RESULT, HTTPAPIEX_GetConnectionPoolStatistics, HTTPAPIEX_CONNECTION_POOL_STATISTICS*, statistics);
+
 #ifdef __cplusplus
 }
 #endif
@@ -15,6 +15,11 @@
 *				  of all the headers  
 *				- ::HTTPHeaders_GetHeader - when the application needs to retrieve the
 *				  <code>name + ": " + value</code> string based on an index.
+*				- ::HTTPHeaders_Serialize - when the application needs all the headers
+*				  as the lines of an HTTP message head.
+*
+*			 Header names are compared without regard to case, as HTTP requires. The
+*			 headers keep the order in which they were first added.
 */
 
 #ifndef HTTPHEADERS_H
@@ -105,7 +110,8 @@ MOCKABLE_FUNCTION(, HTTP_HEADERS_RESULT, HTTPHeaders_ReplaceHeaderNameValuePair,
  * @param	name			 	The name of the HTTP header to find.
  *
  * @return	The return value points to a string that shall be @c strcmp equal
- * 			to the original stored string.
+ * 			to the original stored string. It stays valid until the next call that
+ * 			adds or replaces a header in @p httpHeadersHandle.
  */
 MOCKABLE_FUNCTION(, const char*, HTTPHeaders_FindHeaderValue, HTTP_HEADERS_HANDLE, httpHeadersHandle, const char*, name);
 
@@ -138,6 +144,22 @@ MOCKABLE_FUNCTION(, HTTP_HEADERS_RESULT, HTTPHeaders_GetHeaderCount, HTTP_HEADER
  */
 MOCKABLE_FUNCTION(, HTTP_HEADERS_RESULT, HTTPHeaders_GetHeader, HTTP_HEADERS_HANDLE, handle, size_t, index, char**, destination);
 
+/**
+ * @brief	Writes every header as a <code>name + ": " + value + "\r\n"</code> line
+ * 			into @p destination, in the order they were added.
+ *
+ * @param	handle				A valid @c HTTP_HEADERS_HANDLE value.
+ * @param	destination			Where to write the lines, may be @c NULL when
+ * 								@p destinationSize is 0. No '\0' is written.
+ * @param	destinationSize		Size of @p destination.
+ * @param	serializedSize		Receives the number of bytes the lines take.
+ *
+ * @return	Returns @c HTTP_HEADERS_OK when execution is successful,
+ * 			@c HTTP_HEADERS_INSUFFICIENT_BUFFER, having written nothing, when the
+ * 			lines do not fit in @p destinationSize, or @c HTTP_HEADERS_INVALID_ARG.
+ */
+MOCKABLE_FUNCTION(, HTTP_HEADERS_RESULT, HTTPHeaders_Serialize, HTTP_HEADERS_HANDLE, handle, char*, destination, size_t, destinationSize, size_t*, serializedSize);
+
 /**
  * @brief	This API produces a clone of the @p handle parameter.
  *
@@ -22,10 +22,12 @@ extern "C" {
 #endif
 
 typedef void* LOCK_HANDLE;
+typedef void* RWLOCK_HANDLE;
 
 #define LOCK_RESULT_VALUES \
     LOCK_OK, \
-    LOCK_ERROR \
+    LOCK_ERROR, \
+    LOCK_BUSY \
 
 /** @brief Enumeration specifying the lock status.
 */
@@ -60,6 +62,18 @@ MOCKABLE_FUNCTION(, LOCK_RESULT, Lock, LOCK_HANDLE, handle);
  */
 MOCKABLE_FUNCTION(, LOCK_RESULT, Unlock, LOCK_HANDLE, handle);
 
+/**
+ * @brief	Acquires the lock on the given lock handle if it is free,
+ * 			without blocking.
+ *
+ * @param	handle	A valid handle to the lock.
+ *
+ * @return	Returns @c LOCK_OK when the lock has been acquired,
+ * 			@c LOCK_BUSY when another owner holds it and
+ * 			@c LOCK_ERROR when an error occurs.
+ */
+MOCKABLE_FUNCTION(, LOCK_RESULT, Lock_TryLock, LOCK_HANDLE, handle);
+
 /**
  * @brief	The lock instance is destroyed.
  *
@@ -70,6 +84,65 @@ MOCKABLE_FUNCTION(, LOCK_RESULT, Unlock, LOCK_HANDLE, handle);
  */
 MOCKABLE_FUNCTION(, LOCK_RESULT, Lock_Deinit, LOCK_HANDLE, handle);
 
+/**
+ * @brief	This API creates and returns a reader/writer lock handle. Any
+ * 			number of readers or a single writer can hold the lock. The
+ * 			lock is not recursive.
+ *
+ * @return	A valid @c RWLOCK_HANDLE when successful or @c NULL otherwise.
+ */
+MOCKABLE_FUNCTION(, RWLOCK_HANDLE, RWLock_Init);
+
+/**
+ * @brief	Acquires the reader/writer lock as a reader.
+ *
+ * @param	handle	A valid handle to the reader/writer lock.
+ *
+ * @return	Returns @c LOCK_OK when the lock has been acquired and
+ * 			@c LOCK_ERROR when an error occurs.
+ */
+MOCKABLE_FUNCTION(, LOCK_RESULT, RWLock_ReadLock, RWLOCK_HANDLE, handle);
+
+/**
+ * @brief	Releases the reader/writer lock held as a reader.
+ *
+ * @param	handle	A valid handle to the reader/writer lock.
+ *
+ * @return	Returns @c LOCK_OK when the lock has been released and
+ * 			@c LOCK_ERROR when an error occurs.
+ */
+MOCKABLE_FUNCTION(, LOCK_RESULT, RWLock_ReadUnlock, RWLOCK_HANDLE, handle);
+
+/**
+ * @brief	Acquires the reader/writer lock as the only writer.
+ *
+ * @param	handle	A valid handle to the reader/writer lock.
+ *
+ * @return	Returns @c LOCK_OK when the lock has been acquired and
+ * 			@c LOCK_ERROR when an error occurs.
+ */
+MOCKABLE_FUNCTION(, LOCK_RESULT, RWLock_WriteLock, RWLOCK_HANDLE, handle);
+
+/**
+ * @brief	Releases the reader/writer lock held as the writer.
+ *
+ * @param	handle	A valid handle to the reader/writer lock.
+ *
+ * @return	Returns @c LOCK_OK when the lock has been released and
+ * 			@c LOCK_ERROR when an error occurs.
+ */
+MOCKABLE_FUNCTION(, LOCK_RESULT, RWLock_WriteUnlock, RWLOCK_HANDLE, handle);
+
+/**
+ * @brief	The reader/writer lock instance is destroyed.
+ *
+ * @param	handle	A valid handle to the reader/writer lock.
+ *
+ * @return	Returns @c LOCK_OK when the lock object has been
+ * 			destroyed and @c LOCK_ERROR when an error occurs.
+ */
+MOCKABLE_FUNCTION(, LOCK_RESULT, RWLock_Deinit, RWLOCK_HANDLE, handle);
+
 #ifdef __cplusplus
 }
 #endif
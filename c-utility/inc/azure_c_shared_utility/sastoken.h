@@ -6,16 +6,24 @@
 
 #include "azure_c_shared_utility/strings.h"
 #include <stdbool.h>
+#include <stddef.h>
 #include "azure_c_shared_utility/umock_c_prod.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+    typedef struct SAS_TOKEN_GENERATOR_TAG* SAS_TOKEN_GENERATOR_HANDLE;
+
     MOCKABLE_FUNCTION(, bool, SASToken_Validate, STRING_HANDLE, sasToken);
     MOCKABLE_FUNCTION(, STRING_HANDLE, SASToken_Create, STRING_HANDLE, key, STRING_HANDLE, scope, STRING_HANDLE, keyName, size_t, expiry);
     MOCKABLE_FUNCTION(, STRING_HANDLE, SASToken_CreateString, const char*, key, const char*, scope, const char*, keyName, size_t, expiry);
 
+    /*a generator keeps the decoded key, the keyed HMAC state and the fixed parts of the token for one (key, scope, keyName)*/
+    MOCKABLE_FUNCTION(, SAS_TOKEN_GENERATOR_HANDLE, SASToken_CreateGenerator, const char*, key, const char*, scope, const char*, keyName);
+    MOCKABLE_FUNCTION(, int, SASToken_Generate, SAS_TOKEN_GENERATOR_HANDLE, generator, size_t, expiry, char*, destination, size_t, destinationSize, size_t*, tokenLength);
+    MOCKABLE_FUNCTION(, void, SASToken_DestroyGenerator, SAS_TOKEN_GENERATOR_HANDLE, generator);
+
 #ifdef __cplusplus
 }
 #endif
@@ -29,5 +29,32 @@
 
 #define SHA_Parity(x, y, z)  ((x) ^ (y) ^ (z))
 
+/*
+* SHA-256 block functions, see sha256_accel.c for the hardware ones.
+* A block function compresses blockCount consecutive 64 byte blocks
+* of data into the 8 word intermediate hash.
+*/
+#include <stddef.h>
+#include "azure_c_shared_utility/sha.h"
+
+typedef void (*SHA256BlocksFunction)(uint32_t Intermediate_Hash[8],
+    const uint8_t *data, size_t blockCount);
+
+/* Constants defined in FIPS-180-2, section 4.2.2 */
+extern const uint32_t SHA256_K[64];
+
+/* The block function of sha256ImplX86SHA or sha256ImplARMv8SHA2,
+* NULL if this CPU or build does not support it. */
+extern SHA256BlocksFunction SHA256AccelBlocks(
+    SHA256Implementation implementation);
+
+/* Whether SHA256AccelBlocks8 (sha256ImplX86AVX2) can be used. */
+extern int SHA256AccelHasBlocks8(void);
+
+/* Compresses one 64 byte block into each of 8 independent
+* intermediate hashes. */
+extern void SHA256AccelBlocks8(uint32_t Intermediate_Hash[8][8],
+    const uint8_t *const blocks[8]);
+
 #endif /* _SHA_PRIVATE__H */
 
@@ -84,6 +84,19 @@ typedef enum SHAversion {
     SHA1, SHA224, SHA256, SHA384, SHA512
 } SHAversion;
 
+/*
+ *  SHA-256 (and SHA-224) block implementations. By default the
+ *  fastest one the CPU supports is selected when the first block is
+ *  hashed; sha256ImplX86AVX2 only speeds up SHA256HashMany.
+ */
+typedef enum SHA256Implementation {
+    sha256ImplAuto,
+    sha256ImplPortable,     /* RFC 6234 reference code */
+    sha256ImplX86SHA,       /* x86 SHA extensions */
+    sha256ImplARMv8SHA2,    /* ARMv8 SHA2 instructions */
+    sha256ImplX86AVX2       /* 8 messages at once in AVX2 lanes */
+} SHA256Implementation;
+
 /*
  *  This structure will hold context information for the SHA-1
  *  hashing operation.
@@ -169,14 +182,17 @@ typedef struct USHAContext {
 /*
  *  This structure will hold context information for the HMAC
  *  keyed hashing operation.
+ *  Both passes are keyed by hmacReset, so a context that has not
+ *  been given any input yet can be copied to authenticate many
+ *  messages with the same key without hashing the pads again.
  */
 typedef struct HMACContext {
     int whichSha;               /* which SHA is being used */
     int hashSize;               /* hash size of SHA being used */
     int blockSize;              /* block size of SHA being used */
     USHAContext shaContext;     /* SHA context */
-    unsigned char k_opad[USHA_Max_Message_Block_Size];
-                        /* outer padding - key XORd with opad */
+    USHAContext outerContext;   /* SHA context of the outer pass */
+                        /* after absorbing key XORd with opad */
 } HMACContext;
 
 
@@ -211,6 +227,25 @@ extern int SHA256FinalBits(SHA256Context *, const uint8_t bits,
 extern int SHA256Result(SHA256Context *,
                         uint8_t Message_Digest[SHA256HashSize]);
 
+/*
+ * Selects the SHA-256 implementation, shaBadParam when it is not
+ * supported here. Meant for tests and benchmarks: it is not safe to
+ * call while other threads are hashing.
+ */
+extern int SHA256SetImplementation(SHA256Implementation);
+/* The implementation in use, never sha256ImplAuto. */
+extern SHA256Implementation SHA256GetImplementation(void);
+/*
+ * Computes the SHA-256 digests of count independent messages. This
+ * is the same as a SHA256Reset/Input/Result per message, but with
+ * sha256ImplX86AVX2 8 messages are hashed at a time. Lanes run in
+ * lock step so messages of similar lengths get the most out of it.
+ */
+extern int SHA256HashMany(const uint8_t *const messages[],
+                          const unsigned int lengths[],
+                          unsigned int count,
+                          uint8_t digests[][SHA256HashSize]);
+
 /* SHA-384 */
 extern int SHA384Reset(SHA384Context *);
 extern int SHA384Input(SHA384Context *, const uint8_t *bytes,
@@ -267,6 +302,7 @@ extern int hmacFinalBits(HMACContext *ctx, const uint8_t bits,
                          unsigned int bitcount);
 extern int hmacResult(HMACContext *ctx,
                       uint8_t digest[USHAMaxHashSize]);
+extern int hmacCopy(HMACContext *destination, const HMACContext *source);
 
 
 #ifdef __cplusplus
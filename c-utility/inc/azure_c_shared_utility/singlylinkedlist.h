@@ -5,8 +5,10 @@
 #define SINGLYLINKEDLIST_H
 
 #ifdef __cplusplus
+#include <cstddef>
 extern "C" {
 #else
+#include <stddef.h>
 #include "stdbool.h"
 #endif /* __cplusplus */
 
@@ -15,6 +17,17 @@ extern "C" {
 typedef struct SINGLYLINKEDLIST_INSTANCE_TAG* SINGLYLINKEDLIST_HANDLE;
 typedef struct LIST_ITEM_INSTANCE_TAG* LIST_ITEM_HANDLE;
 
+/**
+* @brief						List node for singlylinkedlist_add_node, usually a member of the structure it links so that adding it does not allocate.
+*								Its fields belong to the list; a node is in at most one list at a time and its storage must outlive its membership.
+*/
+typedef struct LIST_ITEM_INSTANCE_TAG
+{
+    const void* item;
+    struct LIST_ITEM_INSTANCE_TAG* next;
+    bool owned_by_list;
+} SINGLYLINKEDLIST_NODE;
+
 /**
 * @brief						Function passed to singlylinkedlist_find, which returns whichever first list item that matches it.
 * @param list_item				Current list node being evaluated.
@@ -39,8 +52,18 @@ typedef bool (*LIST_CONDITION_FUNCTION)(const void* item, const void* match_cont
 typedef void (*LIST_ACTION_FUNCTION)(const void* item, const void* action_context, bool* continue_processing);
 
 MOCKABLE_FUNCTION(, SINGLYLINKEDLIST_HANDLE, singlylinkedlist_create);
+/**
+* @brief						Creates a list that keeps up to max_free_nodes removed nodes and reuses them in singlylinkedlist_add instead of allocating.
+* @param max_free_nodes			Number of removed nodes the list keeps. 0 makes it behave like singlylinkedlist_create.
+*/
+MOCKABLE_FUNCTION(, SINGLYLINKEDLIST_HANDLE, singlylinkedlist_create_with_node_pool, size_t, max_free_nodes);
 MOCKABLE_FUNCTION(, void, singlylinkedlist_destroy, SINGLYLINKEDLIST_HANDLE, list);
 MOCKABLE_FUNCTION(, LIST_ITEM_HANDLE, singlylinkedlist_add, SINGLYLINKEDLIST_HANDLE, list, const void*, item);
+/**
+* @brief						Adds item to the tail of the list, linking it with the caller's node instead of allocating one.
+*								The returned handle is node itself and works with every other singlylinkedlist function. Removing it or destroying the list only unlinks it.
+*/
+MOCKABLE_FUNCTION(, LIST_ITEM_HANDLE, singlylinkedlist_add_node, SINGLYLINKEDLIST_HANDLE, list, SINGLYLINKEDLIST_NODE*, node, const void*, item);
 MOCKABLE_FUNCTION(, int, singlylinkedlist_remove, SINGLYLINKEDLIST_HANDLE, list, LIST_ITEM_HANDLE, item_handle);
 MOCKABLE_FUNCTION(, LIST_ITEM_HANDLE, singlylinkedlist_get_head_item, SINGLYLINKEDLIST_HANDLE, list);
 MOCKABLE_FUNCTION(, LIST_ITEM_HANDLE, singlylinkedlist_get_next_item, LIST_ITEM_HANDLE, item_handle);
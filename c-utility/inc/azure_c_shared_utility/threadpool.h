@@ -0,0 +1,112 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include "azure_c_shared_utility/macro_utils.h"
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+#include <cstdint>
+extern "C" {
+#else
+#include <stddef.h>
+#include <stdint.h>
+#endif /* __cplusplus */
+
+typedef struct THREADPOOL_TAG* THREADPOOL_HANDLE;
+typedef struct THREADPOOL_FUTURE_TAG* THREADPOOL_FUTURE_HANDLE;
+
+#define THREADPOOL_RESULT_VALUES \
+    THREADPOOL_OK, \
+    THREADPOOL_INVALID_ARG, \
+    THREADPOOL_ERROR, \
+    THREADPOOL_QUEUE_FULL, \
+    THREADPOOL_TIMEOUT
+
+DEFINE_ENUM(THREADPOOL_RESULT, THREADPOOL_RESULT_VALUES);
+
+#define THREADPOOL_WORK_STATUS_VALUES \
+    THREADPOOL_WORK_COMPLETED, \
+    THREADPOOL_WORK_CANCELLED
+
+DEFINE_ENUM(THREADPOOL_WORK_STATUS, THREADPOOL_WORK_STATUS_VALUES);
+
+/* The work run on one of the worker threads, its return value is handed to the completion callback or the future. */
+typedef int(*THREADPOOL_WORK_FUNCTION)(void* work_context);
+
+/* Called on the worker thread once the work ran, or from threadpool_destroy with THREADPOOL_WORK_CANCELLED for delayed work that never ran. */
+typedef void(*ON_THREADPOOL_WORK_COMPLETE)(void* complete_context, THREADPOOL_WORK_STATUS status, int work_result);
+
+/**
+ * @brief   Creates a pool of @p worker_count threads that share one bounded work queue.
+ *
+ * @param   worker_count    Number of worker threads, started right away.
+ * @param   queue_capacity  Number of scheduled works that may wait for a worker.
+ *
+ * @return  A valid @c THREADPOOL_HANDLE, or @c NULL if an argument is 0 or any of
+ *          the queue, the lock, the condition or the threads cannot be created.
+ */
+MOCKABLE_FUNCTION(, THREADPOOL_HANDLE, threadpool_create, size_t, worker_count, size_t, queue_capacity);
+
+/**
+ * @brief   Stops accepting work, lets the workers run every work already in the
+ *          queue, joins them, cancels the delayed works that are not due yet and
+ *          frees the pool. It must not be called from a worker thread.
+ */
+MOCKABLE_FUNCTION(, void, threadpool_destroy, THREADPOOL_HANDLE, threadpool);
+
+/**
+ * @brief   Queues @p work to run on the next free worker, without blocking.
+ *
+ * @param   on_complete     Optional, called on the worker thread after @p work returned.
+ *
+ * @return  @c THREADPOOL_OK when the work is queued, @c THREADPOOL_QUEUE_FULL when
+ *          @p queue_capacity works are already waiting, @c THREADPOOL_INVALID_ARG
+ *          and @c THREADPOOL_ERROR otherwise.
+ */
+MOCKABLE_FUNCTION(, THREADPOOL_RESULT, threadpool_schedule, THREADPOOL_HANDLE, threadpool, THREADPOOL_WORK_FUNCTION, work, void*, work_context, ON_THREADPOOL_WORK_COMPLETE, on_complete, void*, complete_context);
+
+/**
+ * @brief   Runs @p work on a worker once @p delay_ms milliseconds have passed on a
+ *          monotonic clock. Delayed works do not take room in the bounded queue.
+ *          Periodic work is a delayed work that schedules itself again.
+ *
+ * @return  @c THREADPOOL_OK when the work is scheduled, @c THREADPOOL_INVALID_ARG
+ *          and @c THREADPOOL_ERROR otherwise.
+ */
+MOCKABLE_FUNCTION(, THREADPOOL_RESULT, threadpool_schedule_delayed, THREADPOOL_HANDLE, threadpool, uint32_t, delay_ms, THREADPOOL_WORK_FUNCTION, work, void*, work_context, ON_THREADPOOL_WORK_COMPLETE, on_complete, void*, complete_context);
+
+/**
+ * @brief   Queues @p work like threadpool_schedule and returns a future that
+ *          threadpool_future_wait waits on.
+ *
+ * @param   future  Receives the future, it is released with threadpool_future_destroy.
+ */
+MOCKABLE_FUNCTION(, THREADPOOL_RESULT, threadpool_submit, THREADPOOL_HANDLE, threadpool, THREADPOOL_WORK_FUNCTION, work, void*, work_context, THREADPOOL_FUTURE_HANDLE*, future);
+
+/**
+ * @brief   Waits for the work of @p future to be done. One thread at a time
+ *          waits on a future.
+ *
+ * @param   timeout_milliseconds    0 waits for as long as it takes.
+ * @param   work_result             Optional, receives the value the work returned.
+ *
+ * @return  @c THREADPOOL_OK once the work ran, @c THREADPOOL_TIMEOUT if it did not
+ *          run in time, and @c THREADPOOL_INVALID_ARG or @c THREADPOOL_ERROR
+ *          otherwise.
+ */
+MOCKABLE_FUNCTION(, THREADPOOL_RESULT, threadpool_future_wait, THREADPOOL_FUTURE_HANDLE, future, unsigned int, timeout_milliseconds, int*, work_result);
+
+/**
+ * @brief   Releases @p future. The work still runs if it has not yet.
+ */
+MOCKABLE_FUNCTION(, void, threadpool_future_destroy, THREADPOOL_FUTURE_HANDLE, future);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* THREADPOOL_H */
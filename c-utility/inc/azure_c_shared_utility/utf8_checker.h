@@ -12,9 +12,34 @@ extern "C" {
 #include <stddef.h>
 #endif
 
+#include "azure_c_shared_utility/macro_utils.h"
 #include "azure_c_shared_utility/umock_c_prod.h"
 
+#define UTF8_CHECKER_IMPLEMENTATION_VALUES \
+    UTF8_CHECKER_IMPLEMENTATION_AUTO, \
+    UTF8_CHECKER_IMPLEMENTATION_PORTABLE, \
+    UTF8_CHECKER_IMPLEMENTATION_SSSE3, \
+    UTF8_CHECKER_IMPLEMENTATION_AVX2, \
+    UTF8_CHECKER_IMPLEMENTATION_NEON
+
+DEFINE_ENUM(UTF8_CHECKER_IMPLEMENTATION, UTF8_CHECKER_IMPLEMENTATION_VALUES);
+
+/* State of a validation of text that arrives in pieces, like the fragments of a WebSocket message.
+   It is owned by the caller, each byte is looked at once no matter how the text is split. */
+typedef struct UTF8_CHECKER_STREAM_TAG
+{
+    unsigned char pending[4];
+    unsigned char pending_length;
+    unsigned char sequence_length;
+    bool failed;
+} UTF8_CHECKER_STREAM;
+
 MOCKABLE_FUNCTION(, bool, utf8_checker_is_valid_utf8, const unsigned char*, utf8_str, size_t, length);
+MOCKABLE_FUNCTION(, void, utf8_checker_stream_init, UTF8_CHECKER_STREAM*, stream);
+MOCKABLE_FUNCTION(, bool, utf8_checker_stream_feed, UTF8_CHECKER_STREAM*, stream, const unsigned char*, utf8_str, size_t, length);
+MOCKABLE_FUNCTION(, bool, utf8_checker_stream_end, UTF8_CHECKER_STREAM*, stream);
+MOCKABLE_FUNCTION(, int, utf8_checker_set_implementation, UTF8_CHECKER_IMPLEMENTATION, implementation);
+MOCKABLE_FUNCTION(, UTF8_CHECKER_IMPLEMENTATION, utf8_checker_get_implementation);
 
 #ifdef __cplusplus
 }
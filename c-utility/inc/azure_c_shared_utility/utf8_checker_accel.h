@@ -0,0 +1,29 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/*this header is private to utf8_checker.c and utf8_checker_accel.c*/
+
+#ifndef UTF8_CHECKER_ACCEL_H
+#define UTF8_CHECKER_ACCEL_H
+
+#include "azure_c_shared_utility/utf8_checker.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stdbool.h>
+#include <stddef.h>
+#endif
+
+/*validates length bytes (length > 0) with the same rules as the portable code, never reads past utf8_str + length*/
+typedef bool(*UTF8_CHECKER_VALIDATE)(const unsigned char* utf8_str, size_t length);
+
+/*the validator of implementation, NULL when this CPU or build does not have it*/
+extern UTF8_CHECKER_VALIDATE utf8_checker_accel_get_validator(UTF8_CHECKER_IMPLEMENTATION implementation);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UTF8_CHECKER_ACCEL_H */
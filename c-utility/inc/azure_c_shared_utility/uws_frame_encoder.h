@@ -10,10 +10,12 @@
 
 #ifdef __cplusplus
 #include <cstddef>
+#include <cstdint>
 extern "C" {
 #else
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #endif
 
 #define RESERVED_1  0x04
@@ -40,7 +42,18 @@ extern "C" {
 
 DEFINE_ENUM(WS_FRAME_TYPE, WS_FRAME_TYPE_VALUES);
 
+/* 2 bytes, 8 bytes of extended payload length and 4 bytes of masking key */
+#define UWS_FRAME_ENCODER_MAX_HEADER_SIZE 14
+
+/* the masking keys of one connection; zero it before the first use, it seeds itself then */
+typedef struct UWS_FRAME_MASK_GENERATOR_TAG
+{
+    uint64_t state[2];
+} UWS_FRAME_MASK_GENERATOR;
+
 MOCKABLE_FUNCTION(, BUFFER_HANDLE, uws_frame_encoder_encode, WS_FRAME_TYPE, opcode, const unsigned char*, payload, size_t, length, bool, is_masked, bool, is_final, unsigned char, reserved);
+MOCKABLE_FUNCTION(, int, uws_frame_encoder_encode_header, unsigned char*, header, size_t, header_size, WS_FRAME_TYPE, opcode, size_t, length, UWS_FRAME_MASK_GENERATOR*, mask_generator, bool, is_final, unsigned char, reserved, size_t*, header_length);
+MOCKABLE_FUNCTION(, int, uws_frame_encoder_mask, unsigned char*, destination, const unsigned char*, source, size_t, length, const unsigned char*, mask_key);
 
 #ifdef __cplusplus
 }
@@ -26,6 +26,7 @@ extern "C" {
 #undef LOG_INFO
 #endif
 
+/*the categories go from the least to the most verbose, a log level lets through its own category and the ones before it*/
 typedef enum LOG_CATEGORY_TAG
 {
     AZ_LOG_ERROR,
@@ -56,6 +57,8 @@ typedef void(*LOGGER_LOG_GETLASTERROR)(const char* file, const char* func, int l
 #define LogError(...)
 #define xlogging_get_log_function() NULL
 #define xlogging_set_log_function(...)
+#define xlogging_get_log_level() AZ_LOG_ERROR
+#define xlogging_set_log_level(...)
 #define LogErrorWinHTTPWithGetLastErrorAsString(...)
 #define UNUSED(x) (void)(x)
 #elif (defined MINIMAL_LOGERROR)
@@ -65,6 +68,8 @@ typedef void(*LOGGER_LOG_GETLASTERROR)(const char* file, const char* func, int l
 #define LogError(...) printf("error %s: line %d\n",__FILE__,__LINE__);
 #define xlogging_get_log_function() NULL
 #define xlogging_set_log_function(...)
+#define xlogging_get_log_level() AZ_LOG_ERROR
+#define xlogging_set_log_level(...)
 #define LogErrorWinHTTPWithGetLastErrorAsString(...)
 #define UNUSED(x) (void)(x)
 
@@ -84,10 +89,21 @@ typedef void(*LOGGER_LOG_GETLASTERROR)(const char* file, const char* func, int l
 
 #else /* NOT ESP8266_RTOS */
 
+/*the most verbose category compiled in, for example -DXLOGGING_COMPILED_LEVEL=AZ_LOG_ERROR keeps only LogError.
+The calls to the categories after it are left as dead code that the compiler removes, so their arguments still have to compile*/
+#ifndef XLOGGING_COMPILED_LEVEL
+#define XLOGGING_COMPILED_LEVEL AZ_LOG_TRACE
+#endif
+
+/*read directly by LOG so a disabled category costs one compare, before any argument is evaluated; change it with xlogging_set_log_level*/
+extern LOG_CATEGORY global_log_level;
+
+#define XLOGGING_IS_ENABLED(log_category) (((log_category) <= XLOGGING_COMPILED_LEVEL) && ((log_category) <= global_log_level))
+
 #if defined _MSC_VER
-#define LOG(log_category, log_options, format, ...) { LOGGER_LOG l = xlogging_get_log_function(); if (l != NULL) l(log_category, __FILE__, FUNC_NAME, __LINE__, log_options, format, __VA_ARGS__); }
+#define LOG(log_category, log_options, format, ...) { if (XLOGGING_IS_ENABLED(log_category)) { LOGGER_LOG l = xlogging_get_log_function(); if (l != NULL) l(log_category, __FILE__, FUNC_NAME, __LINE__, log_options, format, __VA_ARGS__); } }
 #else
-#define LOG(log_category, log_options, format, ...) { LOGGER_LOG l = xlogging_get_log_function(); if (l != NULL) l(log_category, __FILE__, FUNC_NAME, __LINE__, log_options, format, ##__VA_ARGS__); } 
+#define LOG(log_category, log_options, format, ...) { if (XLOGGING_IS_ENABLED(log_category)) { LOGGER_LOG l = xlogging_get_log_function(); if (l != NULL) l(log_category, __FILE__, FUNC_NAME, __LINE__, log_options, format, ##__VA_ARGS__); } }
 #endif
 
 #if defined _MSC_VER
@@ -144,6 +160,10 @@ extern void LogBinary(const char* comment, const void* data, size_t size);
 extern void xlogging_set_log_function(LOGGER_LOG log_function);
 extern LOGGER_LOG xlogging_get_log_function(void);
 
+/*sets the most verbose category that is logged at run time, AZ_LOG_TRACE (everything) by default*/
+extern void xlogging_set_log_level(LOG_CATEGORY log_level);
+extern LOG_CATEGORY xlogging_get_log_level(void);
+
 #endif /* NOT ESP8266_RTOS */
 
 #ifdef __cplusplus
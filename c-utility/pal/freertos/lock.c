@@ -81,6 +81,24 @@ LOCK_RESULT Lock(LOCK_HANDLE handle)
     return result;
 }
 
+LOCK_RESULT Lock_TryLock(LOCK_HANDLE handle)
+{
+    LOCK_RESULT result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_LOCK_99_002: [Lock_TryLock on NULL handle passed returns LOCK_ERROR] */
+        LogError("Invalid argument; handle is NULL.");
+        result = LOCK_ERROR;
+    }
+    else
+    {
+        /* Codes_SRS_LOCK_99_001: [Lock_TryLock shall return LOCK_OK when it acquired the lock and LOCK_BUSY when the lock is held, without blocking] */
+        result = (xSemaphoreTake((SemaphoreHandle_t)handle, 0) == pdTRUE) ? LOCK_OK : LOCK_BUSY;
+    }
+
+    return result;
+}
+
 LOCK_RESULT Unlock(LOCK_HANDLE handle)
 {
     LOCK_RESULT result;
@@ -109,3 +127,37 @@ LOCK_RESULT Unlock(LOCK_HANDLE handle)
     
     return result;
 }
+
+/* a binary semaphore has no shared mode, readers take the lock exclusively like a writer */
+RWLOCK_HANDLE RWLock_Init(void)
+{
+    /* Codes_SRS_LOCK_99_003: [RWLock_Init on success shall return a valid handle, NULL otherwise] */
+    return (RWLOCK_HANDLE)Lock_Init();
+}
+
+LOCK_RESULT RWLock_ReadLock(RWLOCK_HANDLE handle)
+{
+    /* Codes_SRS_LOCK_99_005: [The RWLock functions return LOCK_ERROR on a NULL handle] */
+    return Lock((LOCK_HANDLE)handle);
+}
+
+LOCK_RESULT RWLock_ReadUnlock(RWLOCK_HANDLE handle)
+{
+    return Unlock((LOCK_HANDLE)handle);
+}
+
+LOCK_RESULT RWLock_WriteLock(RWLOCK_HANDLE handle)
+{
+    /* Codes_SRS_LOCK_99_006: [RWLock_WriteLock shall give the lock to one writer while no reader holds it] */
+    return Lock((LOCK_HANDLE)handle);
+}
+
+LOCK_RESULT RWLock_WriteUnlock(RWLOCK_HANDLE handle)
+{
+    return Unlock((LOCK_HANDLE)handle);
+}
+
+LOCK_RESULT RWLock_Deinit(RWLOCK_HANDLE handle)
+{
+    return Lock_Deinit((LOCK_HANDLE)handle);
+}
@@ -0,0 +1,423 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#define _DEFAULT_SOURCE
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/asynclogger.h"
+#include "azure_c_shared_utility/threadapi.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+/*the ring is a bounded multi producer queue where every record carries a sequence number:
+a record whose sequence equals the enqueue position is free, one whose sequence is the
+position + 1 is filled and waits for the background thread. Producers only race on the
+enqueue position, with a compare and swap, and never wait for each other or for stdio.*/
+
+#if defined(_MSC_VER)
+#include "windows.h"
+
+typedef LONG RING_POSITION;
+
+#define ATOMIC_LOAD(var) InterlockedCompareExchange(&(var), 0, 0)
+#define ATOMIC_STORE(var, value) (void)InterlockedExchange(&(var), (value))
+#define ATOMIC_INC(var) (void)InterlockedIncrement(&(var))
+#define ATOMIC_DEC(var) (void)InterlockedDecrement(&(var))
+#define ATOMIC_CAS(var, expected, desired) compare_and_swap(&(var), &(expected), (desired))
+
+static bool compare_and_swap(volatile LONG* var, LONG* expected, LONG desired)
+{
+    LONG previous = InterlockedCompareExchange(var, desired, *expected);
+    bool result = (previous == *expected);
+    *expected = previous;
+    return result;
+}
+
+static uint64_t get_monotonic_ms(void)
+{
+    return (uint64_t)GetTickCount64();
+}
+
+#elif defined(__GNUC__)
+#include <unistd.h>
+
+typedef uint32_t RING_POSITION;
+
+#define ATOMIC_LOAD(var) __atomic_load_n(&(var), __ATOMIC_SEQ_CST)
+#define ATOMIC_STORE(var, value) __atomic_store_n(&(var), (value), __ATOMIC_SEQ_CST)
+#define ATOMIC_INC(var) (void)__atomic_add_fetch(&(var), 1, __ATOMIC_SEQ_CST)
+#define ATOMIC_DEC(var) (void)__atomic_sub_fetch(&(var), 1, __ATOMIC_SEQ_CST)
+#define ATOMIC_CAS(var, expected, desired) __atomic_compare_exchange_n(&(var), &(expected), (desired), false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)
+
+static uint64_t get_monotonic_ms(void)
+{
+    uint64_t result;
+#if defined(_POSIX_MONOTONIC_CLOCK) && (_POSIX_MONOTONIC_CLOCK >= 0)
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+    {
+        result = ((uint64_t)ts.tv_sec * 1000) + ((uint64_t)ts.tv_nsec / 1000000);
+    }
+    else
+#endif
+    {
+        result = (uint64_t)time(NULL) * 1000;
+    }
+    return result;
+}
+
+#else
+#define ASYNC_LOGGER_NO_ATOMICS
+#endif
+
+/*how long the background thread sleeps when it finds the ring empty*/
+#define ASYNC_LOGGER_IDLE_MS 10
+
+#define TRUNCATED_MARK "..."
+
+#ifndef ASYNC_LOGGER_NO_ATOMICS
+
+typedef struct LOG_RECORD_TAG
+{
+    RING_POSITION sequence;
+    LOG_CATEGORY log_category;
+    const char* file;
+    const char* func;
+    int line;
+    unsigned int options;
+    uint64_t time_ms;
+    char message[ASYNC_LOGGER_MESSAGE_SIZE];
+} LOG_RECORD;
+
+typedef struct ASYNC_LOGGER_TAG
+{
+    LOG_RECORD* records;
+    RING_POSITION mask;
+    RING_POSITION enqueue_position;
+    RING_POSITION dequeue_position;
+    RING_POSITION running;
+    RING_POSITION stopping;
+    RING_POSITION producers;
+    RING_POSITION written;
+    RING_POSITION dropped;
+    uint64_t start_ms;
+    time_t start_time;
+    THREAD_HANDLE thread;
+    LOGGER_LOG previous_log_function;
+} ASYNC_LOGGER;
+
+static ASYNC_LOGGER async_logger;
+
+static void write_record(const LOG_RECORD* record)
+{
+    time_t t;
+
+    switch (record->log_category)
+    {
+    case AZ_LOG_INFO:
+        (void)printf("Info: %s", record->message);
+        break;
+    case AZ_LOG_ERROR:
+        /*ctime only ever runs on the background thread, so its static buffer is not shared*/
+        t = async_logger.start_time + (time_t)((record->time_ms - async_logger.start_ms) / 1000);
+        (void)printf("Error: Time:%.24s File:%s Func:%s Line:%d %s", ctime(&t), record->file, record->func, record->line, record->message);
+        break;
+    default:
+        (void)printf("%s", record->message);
+        break;
+    }
+
+    if (record->options & LOG_LINE)
+    {
+        (void)printf("\r\n");
+    }
+}
+
+/*Codes_SRS_ASYNCLOGGER_99_010: [ The background thread shall write the records out in the order they were taken, the way consolelogger_log prints them. ]*/
+/*writes out the oldest record, returns false if the ring is empty*/
+static bool write_next_record(void)
+{
+    bool result;
+    RING_POSITION position = async_logger.dequeue_position;
+    LOG_RECORD* record = &async_logger.records[position & async_logger.mask];
+
+    if (ATOMIC_LOAD(record->sequence) != (RING_POSITION)(position + 1))
+    {
+        result = false;
+    }
+    else
+    {
+        write_record(record);
+
+        /*hand the record back to the producers for the next lap of the ring*/
+        ATOMIC_STORE(record->sequence, (RING_POSITION)(position + async_logger.mask + 1));
+        async_logger.dequeue_position = position + 1;
+        ATOMIC_INC(async_logger.written);
+        result = true;
+    }
+
+    return result;
+}
+
+static int write_records(void* arg)
+{
+    (void)arg;
+
+    while (true)
+    {
+        /*read the flag first: once it is set no producer is left, so an empty ring stays empty*/
+        bool stopping = (ATOMIC_LOAD(async_logger.stopping) != 0);
+
+        if (write_next_record())
+        {
+            /*keep going while there are records*/
+        }
+        else if (stopping)
+        {
+            break;
+        }
+        else
+        {
+            (void)fflush(stdout);
+            ThreadAPI_Sleep(ASYNC_LOGGER_IDLE_MS);
+        }
+    }
+
+    (void)fflush(stdout);
+    return 0;
+}
+
+#if defined(__GNUC__)
+__attribute__ ((format (printf, 6, 7)))
+#endif
+void asynclogger_log(LOG_CATEGORY log_category, const char* file, const char* func, int line, unsigned int options, const char* format, ...)
+{
+    ATOMIC_INC(async_logger.producers);
+
+    /*Codes_SRS_ASYNCLOGGER_99_009: [ If the logger is not started, asynclogger_log shall do nothing. ]*/
+    if (ATOMIC_LOAD(async_logger.running) != 0)
+    {
+        RING_POSITION position = ATOMIC_LOAD(async_logger.enqueue_position);
+        LOG_RECORD* record = NULL;
+
+        while (true)
+        {
+            LOG_RECORD* candidate = &async_logger.records[position & async_logger.mask];
+            int32_t distance = (int32_t)(ATOMIC_LOAD(candidate->sequence) - position);
+
+            if (distance == 0)
+            {
+                if (ATOMIC_CAS(async_logger.enqueue_position, position, (RING_POSITION)(position + 1)))
+                {
+                    record = candidate;
+                    break;
+                }
+                /*another producer took this record, position now holds the new enqueue position*/
+            }
+            else if (distance < 0)
+            {
+                /*the background thread has not written this record out yet, the ring is full*/
+                break;
+            }
+            else
+            {
+                position = ATOMIC_LOAD(async_logger.enqueue_position);
+            }
+        }
+
+        if (record == NULL)
+        {
+            /*Codes_SRS_ASYNCLOGGER_99_007: [ If the ring is full, asynclogger_log shall drop the message and count it as dropped. ]*/
+            ATOMIC_INC(async_logger.dropped);
+        }
+        else
+        {
+            va_list args;
+            int length;
+
+            /*Codes_SRS_ASYNCLOGGER_99_006: [ asynclogger_log shall format the message into a free record of the ring, with a monotonic timestamp, and return without waiting for it to be written. ]*/
+            record->log_category = log_category;
+            record->file = file;
+            record->func = func;
+            record->line = line;
+            record->options = options;
+            record->time_ms = get_monotonic_ms();
+
+            /*the arguments may not outlive this call, so the message is formatted here into the record*/
+            va_start(args, format);
+            length = vsnprintf(record->message, sizeof(record->message), format, args);
+            va_end(args);
+
+            if (length < 0)
+            {
+                record->message[0] = '\0';
+            }
+            else if ((size_t)length >= sizeof(record->message))
+            {
+                /*Codes_SRS_ASYNCLOGGER_99_008: [ A message that does not fit in ASYNC_LOGGER_MESSAGE_SIZE bytes shall be cut and end in "...". ]*/
+                (void)memcpy(record->message + sizeof(record->message) - sizeof(TRUNCATED_MARK), TRUNCATED_MARK, sizeof(TRUNCATED_MARK));
+            }
+
+            ATOMIC_STORE(record->sequence, (RING_POSITION)(position + 1));
+        }
+    }
+
+    ATOMIC_DEC(async_logger.producers);
+}
+
+int asynclogger_start(size_t record_count)
+{
+    int result;
+
+    /*Codes_SRS_ASYNCLOGGER_99_001: [ If record_count is 0 or larger than 2^30, asynclogger_start shall fail and return a non-zero value. ]*/
+    if (record_count == 0 || record_count > (((size_t)1) << 30))
+    {
+        LogError("Invalid record count %lu", (unsigned long)record_count);
+        result = __FAILURE__;
+    }
+    /*Codes_SRS_ASYNCLOGGER_99_002: [ If the logger is already started, asynclogger_start shall fail and return a non-zero value. ]*/
+    else if (async_logger.records != NULL)
+    {
+        LogError("The async logger is already started");
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t capacity = 1;
+        while (capacity < record_count)
+        {
+            capacity <<= 1;
+        }
+
+        /*Codes_SRS_ASYNCLOGGER_99_003: [ asynclogger_start shall allocate a ring of record_count records, rounded up to a power of two. If that fails, it shall return a non-zero value. ]*/
+        if ((async_logger.records = (LOG_RECORD*)malloc(capacity * sizeof(LOG_RECORD))) == NULL)
+        {
+            LogError("Failed to allocate %lu log records", (unsigned long)capacity);
+            result = __FAILURE__;
+        }
+        else
+        {
+            size_t i;
+            for (i = 0; i < capacity; i++)
+            {
+                async_logger.records[i].sequence = (RING_POSITION)i;
+            }
+            async_logger.mask = (RING_POSITION)(capacity - 1);
+            async_logger.enqueue_position = 0;
+            async_logger.dequeue_position = 0;
+            async_logger.stopping = 0;
+            async_logger.producers = 0;
+            async_logger.written = 0;
+            async_logger.dropped = 0;
+            async_logger.start_ms = get_monotonic_ms();
+            async_logger.start_time = time(NULL);
+
+            /*Codes_SRS_ASYNCLOGGER_99_004: [ asynclogger_start shall start the background thread with ThreadAPI_Create. If that fails, it shall free the ring and return a non-zero value. ]*/
+            if (ThreadAPI_Create(&async_logger.thread, write_records, NULL) != THREADAPI_OK)
+            {
+                LogError("Failed to create the log thread");
+                free(async_logger.records);
+                async_logger.records = NULL;
+                result = __FAILURE__;
+            }
+            else
+            {
+                /*Codes_SRS_ASYNCLOGGER_99_005: [ On success, asynclogger_start shall remember the current log function, install asynclogger_log with xlogging_set_log_function and return 0. ]*/
+                async_logger.previous_log_function = xlogging_get_log_function();
+                ATOMIC_STORE(async_logger.running, 1);
+                xlogging_set_log_function(asynclogger_log);
+                result = 0;
+            }
+        }
+    }
+
+    return result;
+}
+
+void asynclogger_stop(void)
+{
+    /*Codes_SRS_ASYNCLOGGER_99_012: [ If the logger is not started, asynclogger_stop shall do nothing. ]*/
+    if (async_logger.records != NULL)
+    {
+        int thread_result;
+
+        /*Codes_SRS_ASYNCLOGGER_99_011: [ asynclogger_stop shall put back the previous log function, wait for the threads still in asynclogger_log, let the background thread write out every remaining record, join it and free the ring. ]*/
+        xlogging_set_log_function(async_logger.previous_log_function);
+
+        /*a thread that read the old log function may still be in asynclogger_log*/
+        ATOMIC_STORE(async_logger.running, 0);
+        while (ATOMIC_LOAD(async_logger.producers) != 0)
+        {
+            ThreadAPI_Sleep(1);
+        }
+
+        ATOMIC_STORE(async_logger.stopping, 1);
+        if (ThreadAPI_Join(async_logger.thread, &thread_result) != THREADAPI_OK)
+        {
+            LogError("Failed to join the log thread");
+        }
+
+        free(async_logger.records);
+        async_logger.records = NULL;
+    }
+}
+
+int asynclogger_get_statistics(ASYNC_LOGGER_STATISTICS* statistics)
+{
+    int result;
+
+    /*Codes_SRS_ASYNCLOGGER_99_013: [ If statistics is NULL, asynclogger_get_statistics shall fail and return a non-zero value. ]*/
+    if (statistics == NULL)
+    {
+        LogError("NULL statistics");
+        result = __FAILURE__;
+    }
+    else
+    {
+        /*Codes_SRS_ASYNCLOGGER_99_014: [ asynclogger_get_statistics shall fill statistics with the records written and dropped since the last asynclogger_start and return 0. ]*/
+        statistics->written = (size_t)ATOMIC_LOAD(async_logger.written);
+        statistics->dropped = (size_t)ATOMIC_LOAD(async_logger.dropped);
+        result = 0;
+    }
+
+    return result;
+}
+
+#else /* ASYNC_LOGGER_NO_ATOMICS */
+
+void asynclogger_log(LOG_CATEGORY log_category, const char* file, const char* func, int line, unsigned int options, const char* format, ...)
+{
+    (void)log_category;
+    (void)file;
+    (void)func;
+    (void)line;
+    (void)options;
+    (void)format;
+}
+
+int asynclogger_start(size_t record_count)
+{
+    (void)record_count;
+    LogError("The async logger needs atomic operations this compiler does not provide");
+    return __FAILURE__;
+}
+
+void asynclogger_stop(void)
+{
+}
+
+int asynclogger_get_statistics(ASYNC_LOGGER_STATISTICS* statistics)
+{
+    (void)statistics;
+    LogError("The async logger needs atomic operations this compiler does not provide");
+    return __FAILURE__;
+}
+
+#endif /* ASYNC_LOGGER_NO_ATOMICS */
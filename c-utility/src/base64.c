@@ -6,84 +6,155 @@
 #include <stddef.h>
 #include <stdint.h>
 #include "azure_c_shared_utility/base64.h"
+#include "base64_accel.h"
 #include "azure_c_shared_utility/xlogging.h"
 
+/*values of the characters outside the alphabet in the decoding tables*/
+#define BASE64_INVALID 0xFF
 
-#define splitInt(intVal, bytePos)   (char)((intVal >> (bytePos << 3)) & 0xFF)
-#define joinChars(a, b, c, d) (uint32_t)((uint32_t)a + ((uint32_t)b << 8) + ((uint32_t)c << 16) + ((uint32_t)d << 24))
+DEFINE_ENUM_STRINGS(BASE64_IMPLEMENTATION, BASE64_IMPLEMENTATION_VALUES);
 
-static char base64char(unsigned char val)
+typedef struct BASE64_ALPHABET_TAG
 {
-    char result;
+    const char* characters;
+    const unsigned char* values;
+    char character62;
+    char character63;
+} BASE64_ALPHABET;
 
-    if (val < 26)
-    {
-        result = 'A' + (char)val;
-    }
-    else if (val < 52)
-    {
-        result = 'a' + ((char)val - 26);
-    }
-    else if (val < 62)
-    {
-        result = '0' + ((char)val - 52);
-    }
-    else if (val == 62)
-    {
-        result = '+';
-    }
-    else
-    {
-        result = '/';
-    }
+static const unsigned char base64Values[256] =
+{
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF, 0xFF, 0x3F,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+    0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
 
-    return result;
+static const unsigned char base64UrlValues[256] =
+{
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+    0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0x3F,
+    0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+static const BASE64_ALPHABET base64Alphabet = { "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/", base64Values, '+', '/' };
+static const BASE64_ALPHABET base64UrlAlphabet = { "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_", base64UrlValues, '-', '_' };
+
+/*the portable code has no kernel, the scalar loops that finish after a vector kernel do all the work*/
+static size_t Base64EncodeGroupsPortable(char* destination, const unsigned char* source, size_t groupCount, char character62, char character63)
+{
+    (void)destination;
+    (void)source;
+    (void)groupCount;
+    (void)character62;
+    (void)character63;
+    return 0;
 }
 
-static char base64b16(unsigned char val)
+static size_t Base64DecodeGroupsPortable(unsigned char* destination, const char* source, size_t groupCount, char character62, char character63)
 {
-    const uint32_t base64b16values[4] = {
-        joinChars('A', 'E', 'I', 'M'),
-        joinChars('Q', 'U', 'Y', 'c'),
-        joinChars('g', 'k', 'o', 's'),
-        joinChars('w', '0', '4', '8')
-    };
-    return splitInt(base64b16values[val >> 2], (val & 0x03));
+    (void)destination;
+    (void)source;
+    (void)groupCount;
+    (void)character62;
+    (void)character63;
+    return 0;
 }
 
-static char base64b8(unsigned char val)
+static size_t Base64EncodeGroupsSelect(char* destination, const unsigned char* source, size_t groupCount, char character62, char character63);
+static size_t Base64DecodeGroupsSelect(unsigned char* destination, const char* source, size_t groupCount, char character62, char character63);
+
+/*the kernels in use, they start as the Select functions that pick the implementation on the first call*/
+static BASE64_ENCODE_GROUPS Base64EncodeGroups = Base64EncodeGroupsSelect;
+static BASE64_DECODE_GROUPS Base64DecodeGroups = Base64DecodeGroupsSelect;
+static BASE64_IMPLEMENTATION Base64CurrentImplementation = BASE64_IMPLEMENTATION_AUTO;
+
+static size_t Base64EncodeGroupsSelect(char* destination, const unsigned char* source, size_t groupCount, char character62, char character63)
 {
-    const uint32_t base64b8values = joinChars('A', 'Q', 'g', 'w');
-    return splitInt(base64b8values, val);
+    (void)Base64_SetImplementation(BASE64_IMPLEMENTATION_AUTO);
+    return Base64EncodeGroups(destination, source, groupCount, character62, character63);
 }
 
-static int base64toValue(char base64character, unsigned char* value)
+static size_t Base64DecodeGroupsSelect(unsigned char* destination, const char* source, size_t groupCount, char character62, char character63)
 {
-    int result = 0;
-    if (('A' <= base64character) && (base64character <= 'Z'))
-    {
-        *value = base64character - 'A';
-    }
-    else if (('a' <= base64character) && (base64character <= 'z'))
-    {
-        *value = ('Z' - 'A') + 1 + (base64character - 'a');
-    }
-    else if (('0' <= base64character) && (base64character <= '9'))
-    {
-        *value = ('Z' - 'A') + 1 + ('z' - 'a') + 1 + (base64character - '0');
-    }
-    else if ('+' == base64character)
-    {
-        *value = 62;
-    }
-    else if ('/' == base64character)
+    (void)Base64_SetImplementation(BASE64_IMPLEMENTATION_AUTO);
+    return Base64DecodeGroups(destination, source, groupCount, character62, character63);
+}
+
+/*b0            b1(+1)          b2(+2)
+7 6 5 4 3 2 1 0 7 6 5 4 3 2 1 0 7 6 5 4 3 2 1 0
+|----c1---| |----c2---| |----c3---| |----c4---|
+*/
+static void encodeGroups(const BASE64_ALPHABET* alphabet, char* destination, const unsigned char* source, size_t groupCount)
+{
+    size_t i;
+    size_t done = Base64EncodeGroups(destination, source, groupCount, alphabet->character62, alphabet->character63);
+
+    destination += 4 * done;
+    source += 3 * done;
+    for (i = done; i < groupCount; i++)
     {
-        *value = 63;
+        uint32_t group = ((uint32_t)source[0] << 16) | ((uint32_t)source[1] << 8) | source[2];
+        destination[0] = alphabet->characters[group >> 18];
+        destination[1] = alphabet->characters[(group >> 12) & 0x3F];
+        destination[2] = alphabet->characters[(group >> 6) & 0x3F];
+        destination[3] = alphabet->characters[group & 0x3F];
+        destination += 4;
+        source += 3;
     }
-    else
+}
+
+/*returns the number of groups decoded, it stops at the first group holding a character outside the alphabet*/
+static size_t decodeGroups(const BASE64_ALPHABET* alphabet, unsigned char* destination, const char* source, size_t groupCount)
+{
+    size_t result = Base64DecodeGroups(destination, source, groupCount, alphabet->character62, alphabet->character63);
+
+    destination += 3 * result;
+    source += 4 * result;
+    while (result < groupCount)
     {
-        *value = 0;
-        result = -1;
+        unsigned char c1 = alphabet->values[(unsigned char)source[0]];
+        unsigned char c2 = alphabet->values[(unsigned char)source[1]];
+        unsigned char c3 = alphabet->values[(unsigned char)source[2]];
+        unsigned char c4 = alphabet->values[(unsigned char)source[3]];
+        if (((c1 | c2 | c3 | c4) & 0x80) != 0)
+        {
+            break;
+        }
+        else
+        {
+            destination[0] = (unsigned char)((c1 << 2) | (c2 >> 4));
+            destination[1] = (unsigned char)((c2 << 4) | (c3 >> 2));
+            destination[2] = (unsigned char)((c3 << 6) | c4);
+            destination += 3;
+            source += 4;
+            result++;
+        }
     }
     return result;
 }
@@ -91,8 +162,7 @@ static int base64toValue(char base64character, unsigned char* value)
 static size_t numberOfBase64Characters(const char* encodedString)
 {
     size_t length = 0;
-    unsigned char junkChar;
-    while (base64toValue(encodedString[length],&junkChar) != -1)
+    while (base64Alphabet.values[(unsigned char)encodedString[length]] != BASE64_INVALID)
     {
         length++;
     }
@@ -105,7 +175,7 @@ static size_t Base64decode_len(const char *encodedString)
 {
     size_t result;
     size_t sourceLength = strlen(encodedString);
-    
+
     if (sourceLength == 0)
     {
         result = 0;
@@ -125,63 +195,178 @@ static size_t Base64decode_len(const char *encodedString)
     return result;
 }
 
+/*decodes the characters up to the first one outside the alphabet, without looking at the bits left over by the last one*/
 static void Base64decode(unsigned char *decodedString, const char *base64String)
 {
+    size_t numberOfEncodedChars = numberOfBase64Characters(base64String);
+    size_t groupCount = numberOfEncodedChars / 4;
+    const char* tail = base64String + 4 * groupCount;
+    unsigned char* decodedTail = decodedString + 3 * groupCount;
 
-    size_t numberOfEncodedChars;
-    size_t indexOfFirstEncodedChar;
-    size_t decodedIndex;
+    (void)decodeGroups(&base64Alphabet, decodedString, base64String, groupCount);
+
+    if (numberOfEncodedChars % 4 >= 2)
+    {
+        unsigned char c1 = base64Alphabet.values[(unsigned char)tail[0]];
+        unsigned char c2 = base64Alphabet.values[(unsigned char)tail[1]];
+        decodedTail[0] = (unsigned char)((c1 << 2) | (c2 >> 4));
+        if (numberOfEncodedChars % 4 == 3)
+        {
+            unsigned char c3 = base64Alphabet.values[(unsigned char)tail[2]];
+            decodedTail[1] = (unsigned char)((c2 << 4) | (c3 >> 2));
+        }
+    }
+}
 
-    //
-    // We can only operate on individual bytes.  If we attempt to work
-    // on anything larger we could get an alignment fault on some
-    // architectures
-    //
+static int encodeInto(const BASE64_ALPHABET* alphabet, char* destination, size_t destinationSize, const unsigned char* source, size_t size, size_t* encodedLength)
+{
+    int result;
 
-    numberOfEncodedChars = numberOfBase64Characters(base64String);
-    indexOfFirstEncodedChar = 0;
-    decodedIndex = 0;
-    while (numberOfEncodedChars >= 4)
+    /*Codes_SRS_BASE64_99_001: [ If destination is NULL, or source is NULL while size is not zero, then Base64_EncodeInto shall fail and return a non-zero value. ]*/
+    if ((destination == NULL) || ((source == NULL) && (size != 0)))
     {
-        unsigned char c1;
-        unsigned char c2;
-        unsigned char c3;
-        unsigned char c4;
-        (void)base64toValue(base64String[indexOfFirstEncodedChar], &c1);
-        (void)base64toValue(base64String[indexOfFirstEncodedChar + 1], &c2);
-        (void)base64toValue(base64String[indexOfFirstEncodedChar + 2], &c3);
-        (void)base64toValue(base64String[indexOfFirstEncodedChar + 3], &c4);
-        decodedString[decodedIndex] = (c1 << 2) | (c2 >> 4);
-        decodedIndex++;
-        decodedString[decodedIndex] = ((c2 & 0x0f) << 4) | (c3 >> 2);
-        decodedIndex++;
-        decodedString[decodedIndex] = ((c3 & 0x03) << 6) | c4;
-        decodedIndex++;
-        numberOfEncodedChars -= 4;
-        indexOfFirstEncodedChar += 4;
+        LogError("invalid parameter char* destination=%p, const unsigned char* source=%p, size_t size=%lu", destination, source, (unsigned long)size);
+        result = __FAILURE__;
+    }
+    /*Codes_SRS_BASE64_99_002: [ If destinationSize is smaller than BASE64_ENCODED_LENGTH(size) + 1 then Base64_EncodeInto shall fail and return a non-zero value. ]*/
+    else if ((size / 3 >= SIZE_MAX / 4) || (destinationSize < BASE64_ENCODED_LENGTH(size) + 1))
+    {
+        LogError("destination too small, size_t destinationSize=%lu, size_t size=%lu", (unsigned long)destinationSize, (unsigned long)size);
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t groupCount = size / 3;
+        char* tail = destination + 4 * groupCount;
+        const unsigned char* sourceTail = source + 3 * groupCount;
 
+        /*Codes_SRS_BASE64_99_003: [ Base64_EncodeInto shall write the base64 encoding of the size bytes at source, "=" padded, followed by a null terminator. ]*/
+        if (groupCount > 0)
+        {
+            encodeGroups(alphabet, destination, source, groupCount);
+        }
+        if (size % 3 == 2)
+        {
+            tail[0] = alphabet->characters[sourceTail[0] >> 2];
+            tail[1] = alphabet->characters[((sourceTail[0] & 0x03) << 4) | (sourceTail[1] >> 4)];
+            tail[2] = alphabet->characters[(sourceTail[1] & 0x0F) << 2];
+            tail[3] = '=';
+            tail += 4;
+        }
+        else if (size % 3 == 1)
+        {
+            tail[0] = alphabet->characters[sourceTail[0] >> 2];
+            tail[1] = alphabet->characters[(sourceTail[0] & 0x03) << 4];
+            tail[2] = '=';
+            tail[3] = '=';
+            tail += 4;
+        }
+        *tail = '\0';
+
+        /*Codes_SRS_BASE64_99_004: [ If encodedLength is not NULL, Base64_EncodeInto shall set it to the number of characters written, not counting the null terminator. ]*/
+        if (encodedLength != NULL)
+        {
+            *encodedLength = (size_t)(tail - destination);
+        }
+
+        /*Codes_SRS_BASE64_99_005: [ Otherwise Base64_EncodeInto shall succeed and return 0. ]*/
+        result = 0;
     }
+    return result;
+}
+
+static int decodeInto(const BASE64_ALPHABET* alphabet, unsigned char* destination, size_t destinationSize, const char* source, size_t length, size_t* decodedSize)
+{
+    int result;
 
-    if (numberOfEncodedChars == 2)
+    /*Codes_SRS_BASE64_99_006: [ If destination is NULL, or source is NULL while length is not zero, then Base64_DecodeInto shall fail and return a non-zero value. ]*/
+    if ((destination == NULL) || ((source == NULL) && (length != 0)))
     {
-        unsigned char c1;
-        unsigned char c2;
-        (void)base64toValue(base64String[indexOfFirstEncodedChar], &c1);
-        (void)base64toValue(base64String[indexOfFirstEncodedChar + 1], &c2);
-        decodedString[decodedIndex] = (c1 << 2) | (c2 >> 4);
+        LogError("invalid parameter unsigned char* destination=%p, const char* source=%p, size_t length=%lu", destination, source, (unsigned long)length);
+        result = __FAILURE__;
     }
-    else if (numberOfEncodedChars == 3)
+    else
     {
-        unsigned char c1;
-        unsigned char c2;
-        unsigned char c3;
-        (void)base64toValue(base64String[indexOfFirstEncodedChar], &c1);
-        (void)base64toValue(base64String[indexOfFirstEncodedChar + 1], &c2);
-        (void)base64toValue(base64String[indexOfFirstEncodedChar + 2], &c3);
-        decodedString[decodedIndex] = (c1 << 2) | (c2 >> 4);
-        decodedIndex++;
-        decodedString[decodedIndex] = ((c2 & 0x0f) << 4) | (c3 >> 2);
+        size_t needed;
+
+        /*Codes_SRS_BASE64_99_007: [ Base64_DecodeInto shall accept the encoding with or without its "=" padding. ]*/
+        if ((length > 0) && (length % 4 == 0) && (source[length - 1] == '='))
+        {
+            length--;
+            if (source[length - 1] == '=')
+            {
+                length--;
+            }
+        }
+        needed = (length / 4) * 3 + ((length % 4 == 0) ? 0 : (length % 4) - 1);
+
+        /*Codes_SRS_BASE64_99_008: [ If length, without the padding, is one more than a multiple of 4 then Base64_DecodeInto shall fail and return a non-zero value. ]*/
+        if (length % 4 == 1)
+        {
+            LogError("invalid length of a base64 encoding, size_t length=%lu", (unsigned long)length);
+            result = __FAILURE__;
+        }
+        /*Codes_SRS_BASE64_99_009: [ If destinationSize is smaller than the number of decoded bytes then Base64_DecodeInto shall fail and return a non-zero value. ]*/
+        else if (destinationSize < needed)
+        {
+            LogError("destination too small, size_t destinationSize=%lu, needed %lu", (unsigned long)destinationSize, (unsigned long)needed);
+            result = __FAILURE__;
+        }
+        else
+        {
+            size_t groupCount = length / 4;
+            const char* tail = source + 4 * groupCount;
+            unsigned char* decodedTail = destination + 3 * groupCount;
+            unsigned char c1 = 0;
+            unsigned char c2 = 0;
+            unsigned char c3 = 0;
+            unsigned char leftover = 0;
+
+            if (length % 4 >= 2)
+            {
+                c1 = alphabet->values[(unsigned char)tail[0]];
+                c2 = alphabet->values[(unsigned char)tail[1]];
+                c3 = (length % 4 == 3) ? alphabet->values[(unsigned char)tail[2]] : 0;
+                leftover = (length % 4 == 3) ? (unsigned char)(c3 & 0x03) : (unsigned char)(c2 & 0x0F);
+            }
+
+            /*Codes_SRS_BASE64_99_010: [ If a character is outside the alphabet then Base64_DecodeInto shall fail and return a non-zero value. ]*/
+            if ((decodeGroups(alphabet, destination, source, groupCount) != groupCount) ||
+                (((c1 | c2 | c3) & 0x80) != 0))
+            {
+                LogError("invalid character in a base64 encoding");
+                result = __FAILURE__;
+            }
+            /*Codes_SRS_BASE64_99_011: [ If the last character has bits set that do not belong to a decoded byte then Base64_DecodeInto shall fail and return a non-zero value. ]*/
+            else if (leftover != 0)
+            {
+                LogError("non canonical end of a base64 encoding");
+                result = __FAILURE__;
+            }
+            else
+            {
+                /*Codes_SRS_BASE64_99_012: [ Base64_DecodeInto shall write the decoded bytes to destination. ]*/
+                if (length % 4 >= 2)
+                {
+                    decodedTail[0] = (unsigned char)((c1 << 2) | (c2 >> 4));
+                    if (length % 4 == 3)
+                    {
+                        decodedTail[1] = (unsigned char)((c2 << 4) | (c3 >> 2));
+                    }
+                }
+
+                /*Codes_SRS_BASE64_99_013: [ If decodedSize is not NULL, Base64_DecodeInto shall set it to the number of bytes written. ]*/
+                if (decodedSize != NULL)
+                {
+                    *decodedSize = needed;
+                }
+
+                /*Codes_SRS_BASE64_99_014: [ Otherwise Base64_DecodeInto shall succeed and return 0. ]*/
+                result = 0;
+            }
+        }
     }
+    return result;
 }
 
 BUFFER_HANDLE Base64_Decoder(const char* source)
@@ -236,11 +421,8 @@ BUFFER_HANDLE Base64_Decoder(const char* source)
 static STRING_HANDLE Base64_Encode_Internal(const unsigned char* source, size_t size)
 {
     STRING_HANDLE result;
-    size_t neededSize = 0;
+    size_t neededSize = BASE64_ENCODED_LENGTH(size) + 1; /*+1 because \0 at the end of the string*/
     char* encoded;
-    size_t currentPosition = 0;
-    neededSize += (size == 0) ? (0) : ((((size - 1) / 3) + 1) * 4);
-    neededSize += 1; /*+1 because \0 at the end of the string*/
     /*Codes_SRS_BASE64_06_006: [If when allocating memory to produce the encoding a failure occurs then Base64_Encoder shall return NULL.]*/
     encoded = (char*)malloc(neededSize);
     if (encoded == NULL)
@@ -248,60 +430,14 @@ static STRING_HANDLE Base64_Encode_Internal(const unsigned char* source, size_t
         result = NULL;
         LogError("Base64_Encoder:: Allocation failed.");
     }
+    else if (encodeInto(&base64Alphabet, encoded, neededSize, source, size, NULL) != 0)
+    {
+        free(encoded);
+        result = NULL;
+        LogError("Base64_Encoder:: encoding failed.");
+    }
     else
     {
-        /*b0            b1(+1)          b2(+2)
-        7 6 5 4 3 2 1 0 7 6 5 4 3 2 1 0 7 6 5 4 3 2 1 0
-        |----c1---| |----c2---| |----c3---| |----c4---|
-        */
-
-        size_t destinationPosition = 0;
-        while (size - currentPosition >= 3)
-        {
-            char c1 = base64char(source[currentPosition] >> 2);
-            char c2 = base64char(
-                ((source[currentPosition] & 3) << 4) |
-                    (source[currentPosition + 1] >> 4)
-            );
-            char c3 = base64char(
-                ((source[currentPosition + 1] & 0x0F) << 2) |
-                    ((source[currentPosition + 2] >> 6) & 3)
-            );
-            char c4 = base64char(
-                source[currentPosition + 2] & 0x3F
-            );
-            currentPosition += 3;
-            encoded[destinationPosition++] = c1;
-            encoded[destinationPosition++] = c2;
-            encoded[destinationPosition++] = c3;
-            encoded[destinationPosition++] = c4;
-
-        }
-        if (size - currentPosition == 2)
-        {
-            char c1 = base64char(source[currentPosition] >> 2);
-            char c2 = base64char(
-                ((source[currentPosition] & 0x03) << 4) |
-                    (source[currentPosition + 1] >> 4)
-            );
-            char c3 = base64b16(source[currentPosition + 1] & 0x0F);
-            encoded[destinationPosition++] = c1;
-            encoded[destinationPosition++] = c2;
-            encoded[destinationPosition++] = c3;
-            encoded[destinationPosition++] = '=';
-        }
-        else if (size - currentPosition == 1)
-        {
-            char c1 = base64char(source[currentPosition] >> 2);
-            char c2 = base64b8(source[currentPosition] & 0x03);
-            encoded[destinationPosition++] = c1;
-            encoded[destinationPosition++] = c2;
-            encoded[destinationPosition++] = '=';
-            encoded[destinationPosition++] = '=';
-        }
-
-        /*null terminating the string*/
-        encoded[destinationPosition] = '\0';
         /*Codes_SRS_BASE64_06_007: [Otherwise Base64_Encoder shall return a pointer to STRING, that string contains the base 64 encoding of input.]*/
         result = STRING_new_with_memory(encoded);
         if (result == NULL)
@@ -366,3 +502,87 @@ STRING_HANDLE Base64_Encoder(BUFFER_HANDLE input)
     }
     return result;
 }
+
+int Base64_EncodeInto(char* destination, size_t destinationSize, const unsigned char* source, size_t size, size_t* encodedLength)
+{
+    return encodeInto(&base64Alphabet, destination, destinationSize, source, size, encodedLength);
+}
+
+int Base64_DecodeInto(unsigned char* destination, size_t destinationSize, const char* source, size_t length, size_t* decodedSize)
+{
+    return decodeInto(&base64Alphabet, destination, destinationSize, source, length, decodedSize);
+}
+
+/*Codes_SRS_BASE64_99_015: [ Base64Url_EncodeInto and Base64Url_DecodeInto shall behave as Base64_EncodeInto and Base64_DecodeInto with "-" and "_" in place of "+" and "/". ]*/
+int Base64Url_EncodeInto(char* destination, size_t destinationSize, const unsigned char* source, size_t size, size_t* encodedLength)
+{
+    return encodeInto(&base64UrlAlphabet, destination, destinationSize, source, size, encodedLength);
+}
+
+int Base64Url_DecodeInto(unsigned char* destination, size_t destinationSize, const char* source, size_t length, size_t* decodedSize)
+{
+    return decodeInto(&base64UrlAlphabet, destination, destinationSize, source, length, decodedSize);
+}
+
+int Base64_SetImplementation(BASE64_IMPLEMENTATION implementation)
+{
+    int result;
+    BASE64_ENCODE_GROUPS encoder = NULL;
+    BASE64_DECODE_GROUPS decoder = NULL;
+
+    /*Codes_SRS_BASE64_99_016: [ BASE64_IMPLEMENTATION_AUTO shall select AVX2, then SSSE3, then NEON, then the portable code, whichever this CPU and build support first. ]*/
+    if (implementation == BASE64_IMPLEMENTATION_AUTO)
+    {
+        static const BASE64_IMPLEMENTATION preferred[] = { BASE64_IMPLEMENTATION_AVX2, BASE64_IMPLEMENTATION_SSSE3, BASE64_IMPLEMENTATION_NEON };
+        size_t i;
+        implementation = BASE64_IMPLEMENTATION_PORTABLE;
+        for (i = 0; i < sizeof(preferred) / sizeof(preferred[0]); i++)
+        {
+            if (((encoder = Base64Accel_GetEncoder(preferred[i])) != NULL) &&
+                ((decoder = Base64Accel_GetDecoder(preferred[i])) != NULL))
+            {
+                implementation = preferred[i];
+                break;
+            }
+        }
+    }
+    else if ((implementation == BASE64_IMPLEMENTATION_SSSE3) ||
+        (implementation == BASE64_IMPLEMENTATION_AVX2) ||
+        (implementation == BASE64_IMPLEMENTATION_NEON))
+    {
+        encoder = Base64Accel_GetEncoder(implementation);
+        decoder = Base64Accel_GetDecoder(implementation);
+    }
+
+    if (implementation == BASE64_IMPLEMENTATION_PORTABLE)
+    {
+        encoder = Base64EncodeGroupsPortable;
+        decoder = Base64DecodeGroupsPortable;
+    }
+
+    /*Codes_SRS_BASE64_99_017: [ If this CPU or build does not support implementation then Base64_SetImplementation shall fail, return a non-zero value and keep the implementation in use. ]*/
+    if ((encoder == NULL) || (decoder == NULL))
+    {
+        LogError("base64 implementation %d is not supported", (int)implementation);
+        result = __FAILURE__;
+    }
+    else
+    {
+        /*Codes_SRS_BASE64_99_018: [ Otherwise Base64_SetImplementation shall make all the encoding and decoding functions use implementation and return 0. ]*/
+        Base64EncodeGroups = encoder;
+        Base64DecodeGroups = decoder;
+        Base64CurrentImplementation = implementation;
+        result = 0;
+    }
+    return result;
+}
+
+BASE64_IMPLEMENTATION Base64_GetImplementation(void)
+{
+    /*Codes_SRS_BASE64_99_019: [ Base64_GetImplementation shall return the implementation in use, selecting it as BASE64_IMPLEMENTATION_AUTO does if none was selected yet. ]*/
+    if (Base64CurrentImplementation == BASE64_IMPLEMENTATION_AUTO)
+    {
+        (void)Base64_SetImplementation(BASE64_IMPLEMENTATION_AUTO);
+    }
+    return Base64CurrentImplementation;
+}
@@ -0,0 +1,431 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/*
+* Vector base64 kernels and their run time detection.
+*
+* Like sha256_accel.c, the x86 kernels are compiled with per function
+* target attributes, so the library still runs on CPUs without SSSE3
+* or AVX2: Base64Accel_GetEncoder / Base64Accel_GetDecoder only hand
+* out a kernel after CPUID says the CPU has it. NEON is part of every
+* AArch64 CPU and needs no detection.
+*
+* The encoders follow Wojciech Mula's pshufb/multiply scheme, the
+* decoders map characters to values with range compares so that the
+* same kernels serve the standard and the base64url alphabets.
+*
+* Define NO_BASE64_ACCELERATION to build the portable code only.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include "azure_c_shared_utility/base64.h"
+#include "base64_accel.h"
+
+#if !defined(NO_BASE64_ACCELERATION)
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)))))
+#define BASE64_ACCEL_X86
+#define BASE64_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define BASE64_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#include <cpuid.h>
+#elif (defined(_M_X64) || defined(_M_IX86)) && defined(_MSC_VER) && (_MSC_VER >= 1900)
+#define BASE64_ACCEL_X86
+#define BASE64_TARGET_SSSE3
+#define BASE64_TARGET_AVX2
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define BASE64_ACCEL_NEON
+#include <arm_neon.h>
+#endif
+
+#endif /* NO_BASE64_ACCELERATION */
+
+#ifdef BASE64_ACCEL_X86
+
+/*
+* CPUID leaf 1 ECX: bit 9 SSSE3, bit 27 OSXSAVE.
+* CPUID leaf 7 EBX: bit 5 AVX2.
+*/
+static void Base64Cpuid(unsigned int leaf, unsigned int regs[4])
+{
+#ifdef _MSC_VER
+    int r[4];
+    __cpuidex(r, (int)leaf, 0);
+    regs[0] = (unsigned int)r[0];
+    regs[1] = (unsigned int)r[1];
+    regs[2] = (unsigned int)r[2];
+    regs[3] = (unsigned int)r[3];
+#else
+    if (__get_cpuid_max(0, NULL) < leaf)
+    {
+        regs[0] = regs[1] = regs[2] = regs[3] = 0;
+    }
+    else
+    {
+        __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+    }
+#endif
+}
+
+/*whether the OS saves the YMM registers, which AVX2 needs*/
+static int Base64OSSavesYMM(unsigned int leaf1Ecx)
+{
+    int result;
+    if ((leaf1Ecx & (1u << 27)) == 0)
+    {
+        result = 0;
+    }
+    else
+    {
+        uint64_t xcr0;
+#ifdef _MSC_VER
+        xcr0 = _xgetbv(0);
+#else
+        uint32_t eax, edx;
+        __asm__ __volatile__(".byte 0x0f, 0x01, 0xd0" : "=a"(eax), "=d"(edx) : "c"(0));
+        xcr0 = ((uint64_t)edx << 32) | eax;
+#endif
+        result = ((xcr0 & 0x6) == 0x6);
+    }
+    return result;
+}
+
+static int Base64HasSSSE3(void)
+{
+    unsigned int leaf1[4];
+    Base64Cpuid(1, leaf1);
+    return (leaf1[2] & (1u << 9)) != 0;
+}
+
+static int Base64HasAVX2(void)
+{
+    unsigned int leaf1[4];
+    unsigned int leaf7[4];
+    Base64Cpuid(1, leaf1);
+    Base64Cpuid(7, leaf7);
+    return ((leaf7[1] & (1u << 5)) != 0) && Base64OSSavesYMM(leaf1[2]);
+}
+
+/*
+* Encoding: pshufb spreads every 3 bytes over 4, two multiplies move
+* the 4 sextets to the low bits of their byte. The sextets become
+* characters by adding an offset that depends on their range: 0-25
+* 'A', 26-51 'a' - 26, 52-61 '0' - 52, 62 and 63 their character.
+*/
+static BASE64_TARGET_SSSE3 __m128i Base64EncodeShiftLUTSSSE3(char character62, char character63)
+{
+    return _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        (char)(character62 - 62), (char)(character63 - 63), 'A', 0, 0);
+}
+
+static BASE64_TARGET_SSSE3 size_t Base64EncodeSSSE3(char* destination, const unsigned char* source, size_t groupCount, char character62, char character63)
+{
+    const __m128i shiftLUT = Base64EncodeShiftLUTSSSE3(character62, character63);
+    const __m128i spread = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    size_t result = 0;
+
+    /*reads 16 bytes for 4 groups, so it stops while 2 more groups are left*/
+    while (groupCount - result >= 6)
+    {
+        __m128i in = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(source + 3 * result)), spread);
+        __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+        __m128i t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+        __m128i indices = _mm_or_si128(t0, t1);
+        __m128i range = _mm_or_si128(_mm_subs_epu8(indices, _mm_set1_epi8(51)),
+            _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+        _mm_storeu_si128((__m128i*)(destination + 4 * result), _mm_add_epi8(indices, _mm_shuffle_epi8(shiftLUT, range)));
+        result += 4;
+    }
+    return result;
+}
+
+static BASE64_TARGET_AVX2 size_t Base64EncodeAVX2(char* destination, const unsigned char* source, size_t groupCount, char character62, char character63)
+{
+    const __m256i shiftLUT = _mm256_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        (char)(character62 - 62), (char)(character63 - 63), 'A', 0, 0,
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        (char)(character62 - 62), (char)(character63 - 63), 'A', 0, 0);
+    const __m256i spread = _mm256_setr_epi8(
+        1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+        1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    size_t result = 0;
+
+    /*each lane reads 16 bytes for 4 groups, the second lane starts 12 bytes in, so it stops while 2 more groups are left*/
+    while (groupCount - result >= 10)
+    {
+        const unsigned char* block = source + 3 * result;
+        __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)block)), _mm_loadu_si128((const __m128i*)(block + 12)), 1);
+        __m256i t0;
+        __m256i t1;
+        __m256i indices;
+        __m256i range;
+        in = _mm256_shuffle_epi8(in, spread);
+        t0 = _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+        t1 = _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+        indices = _mm256_or_si256(t0, t1);
+        range = _mm256_or_si256(_mm256_subs_epu8(indices, _mm256_set1_epi8(51)),
+            _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices), _mm256_set1_epi8(13)));
+        _mm256_storeu_si256((__m256i*)(destination + 4 * result), _mm256_add_epi8(indices, _mm256_shuffle_epi8(shiftLUT, range)));
+        result += 8;
+    }
+    return result;
+}
+
+/*
+* Decoding: a character is in one of 5 ranges, each with the offset
+* that turns it into its value. Characters from 0x80 on are negative
+* for the signed compares and fall in none. maddubs / madd then pack
+* 4 sextets into 24 bits and pshufb drops the spare byte.
+*/
+#define BASE64_SSE_IN_RANGE(in, low, high) \
+    _mm_and_si128(_mm_cmpgt_epi8((in), _mm_set1_epi8((char)((low) - 1))), _mm_cmpgt_epi8(_mm_set1_epi8((char)((high) + 1)), (in)))
+
+static BASE64_TARGET_SSSE3 size_t Base64DecodeSSSE3(unsigned char* destination, const char* source, size_t groupCount, char character62, char character63)
+{
+    const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    size_t result = 0;
+
+    /*writes 16 bytes for 4 groups, so it stops while 2 more groups are left*/
+    while (groupCount - result >= 6)
+    {
+        __m128i in = _mm_loadu_si128((const __m128i*)(source + 4 * result));
+        __m128i upper = BASE64_SSE_IN_RANGE(in, 'A', 'Z');
+        __m128i lower = BASE64_SSE_IN_RANGE(in, 'a', 'z');
+        __m128i digit = BASE64_SSE_IN_RANGE(in, '0', '9');
+        __m128i is62 = _mm_cmpeq_epi8(in, _mm_set1_epi8(character62));
+        __m128i is63 = _mm_cmpeq_epi8(in, _mm_set1_epi8(character63));
+        __m128i valid = _mm_or_si128(_mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, is62)), is63);
+        if (_mm_movemask_epi8(valid) != 0xFFFF)
+        {
+            break;
+        }
+        else
+        {
+            __m128i shift = _mm_or_si128(
+                _mm_or_si128(_mm_and_si128(upper, _mm_set1_epi8(-'A')), _mm_and_si128(lower, _mm_set1_epi8(26 - 'a'))),
+                _mm_or_si128(_mm_and_si128(digit, _mm_set1_epi8(52 - '0')),
+                    _mm_or_si128(_mm_and_si128(is62, _mm_set1_epi8((char)(62 - character62))), _mm_and_si128(is63, _mm_set1_epi8((char)(63 - character63))))));
+            __m128i values = _mm_add_epi8(in, shift);
+            __m128i merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+            __m128i packed = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+            _mm_storeu_si128((__m128i*)(destination + 3 * result), _mm_shuffle_epi8(packed, pack));
+            result += 4;
+        }
+    }
+    return result;
+}
+
+#define BASE64_AVX2_IN_RANGE(in, low, high) \
+    _mm256_and_si256(_mm256_cmpgt_epi8((in), _mm256_set1_epi8((char)((low) - 1))), _mm256_cmpgt_epi8(_mm256_set1_epi8((char)((high) + 1)), (in)))
+
+static BASE64_TARGET_AVX2 size_t Base64DecodeAVX2(unsigned char* destination, const char* source, size_t groupCount, char character62, char character63)
+{
+    const __m256i pack = _mm256_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const __m256i compact = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+    size_t result = 0;
+
+    /*writes 32 bytes for 8 groups, so it stops while 3 more groups are left*/
+    while (groupCount - result >= 11)
+    {
+        __m256i in = _mm256_loadu_si256((const __m256i*)(source + 4 * result));
+        __m256i upper = BASE64_AVX2_IN_RANGE(in, 'A', 'Z');
+        __m256i lower = BASE64_AVX2_IN_RANGE(in, 'a', 'z');
+        __m256i digit = BASE64_AVX2_IN_RANGE(in, '0', '9');
+        __m256i is62 = _mm256_cmpeq_epi8(in, _mm256_set1_epi8(character62));
+        __m256i is63 = _mm256_cmpeq_epi8(in, _mm256_set1_epi8(character63));
+        __m256i valid = _mm256_or_si256(_mm256_or_si256(_mm256_or_si256(upper, lower), _mm256_or_si256(digit, is62)), is63);
+        if (_mm256_movemask_epi8(valid) != -1)
+        {
+            break;
+        }
+        else
+        {
+            __m256i shift = _mm256_or_si256(
+                _mm256_or_si256(_mm256_and_si256(upper, _mm256_set1_epi8(-'A')), _mm256_and_si256(lower, _mm256_set1_epi8(26 - 'a'))),
+                _mm256_or_si256(_mm256_and_si256(digit, _mm256_set1_epi8(52 - '0')),
+                    _mm256_or_si256(_mm256_and_si256(is62, _mm256_set1_epi8((char)(62 - character62))), _mm256_and_si256(is63, _mm256_set1_epi8((char)(63 - character63))))));
+            __m256i values = _mm256_add_epi8(in, shift);
+            __m256i merged = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+            __m256i packed = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+            packed = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(packed, pack), compact);
+            _mm256_storeu_si256((__m256i*)(destination + 3 * result), packed);
+            result += 8;
+        }
+    }
+    return result;
+}
+
+#endif /* BASE64_ACCEL_X86 */
+
+#ifdef BASE64_ACCEL_NEON
+
+/*
+* NEON has de-interleaving loads and stores of 3 and 4 registers, so
+* 48 bytes become 4 vectors of sextets (and back) without shuffles.
+* Encoding looks the characters up in the 64 byte alphabet with tbl.
+*/
+static size_t Base64EncodeNEON(char* destination, const unsigned char* source, size_t groupCount, char character62, char character63)
+{
+    static const char digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+    uint8_t alphabetBytes[64];
+    uint8x16x4_t alphabet;
+    const uint8x16_t sextet = vdupq_n_u8(0x3F);
+    size_t result = 0;
+    size_t i;
+
+    for (i = 0; i < 62; i++)
+    {
+        alphabetBytes[i] = (uint8_t)digits[i];
+    }
+    alphabetBytes[62] = (uint8_t)character62;
+    alphabetBytes[63] = (uint8_t)character63;
+    alphabet.val[0] = vld1q_u8(alphabetBytes);
+    alphabet.val[1] = vld1q_u8(alphabetBytes + 16);
+    alphabet.val[2] = vld1q_u8(alphabetBytes + 32);
+    alphabet.val[3] = vld1q_u8(alphabetBytes + 48);
+
+    while (groupCount - result >= 16)
+    {
+        uint8x16x3_t in = vld3q_u8(source + 3 * result);
+        uint8x16x4_t out;
+        out.val[0] = vqtbl4q_u8(alphabet, vshrq_n_u8(in.val[0], 2));
+        out.val[1] = vqtbl4q_u8(alphabet, vandq_u8(vorrq_u8(vshlq_n_u8(in.val[0], 4), vshrq_n_u8(in.val[1], 4)), sextet));
+        out.val[2] = vqtbl4q_u8(alphabet, vandq_u8(vorrq_u8(vshlq_n_u8(in.val[1], 2), vshrq_n_u8(in.val[2], 6)), sextet));
+        out.val[3] = vqtbl4q_u8(alphabet, vandq_u8(in.val[2], sextet));
+        vst4q_u8((uint8_t*)destination + 4 * result, out);
+        result += 16;
+    }
+    return result;
+}
+
+#define BASE64_NEON_IN_RANGE(in, low, high) \
+    vandq_u8(vcgeq_u8((in), vdupq_n_u8((uint8_t)(low))), vcleq_u8((in), vdupq_n_u8((uint8_t)(high))))
+
+/*returns 0 when one of the characters is outside the alphabet*/
+static int Base64DecodeValuesNEON(uint8x16_t in, uint8_t character62, uint8_t character63, uint8x16_t* values)
+{
+    int result;
+    uint8x16_t upper = BASE64_NEON_IN_RANGE(in, 'A', 'Z');
+    uint8x16_t lower = BASE64_NEON_IN_RANGE(in, 'a', 'z');
+    uint8x16_t digit = BASE64_NEON_IN_RANGE(in, '0', '9');
+    uint8x16_t is62 = vceqq_u8(in, vdupq_n_u8(character62));
+    uint8x16_t is63 = vceqq_u8(in, vdupq_n_u8(character63));
+    uint8x16_t valid = vorrq_u8(vorrq_u8(vorrq_u8(upper, lower), vorrq_u8(digit, is62)), is63);
+    if (vminvq_u8(valid) != 0xFF)
+    {
+        result = 0;
+    }
+    else
+    {
+        uint8x16_t shift = vorrq_u8(
+            vorrq_u8(vandq_u8(upper, vdupq_n_u8((uint8_t)(0 - 'A'))), vandq_u8(lower, vdupq_n_u8((uint8_t)(26 - 'a')))),
+            vorrq_u8(vandq_u8(digit, vdupq_n_u8((uint8_t)(52 - '0'))),
+                vorrq_u8(vandq_u8(is62, vdupq_n_u8((uint8_t)(62 - character62))), vandq_u8(is63, vdupq_n_u8((uint8_t)(63 - character63))))));
+        *values = vaddq_u8(in, shift);
+        result = 1;
+    }
+    return result;
+}
+
+static size_t Base64DecodeNEON(unsigned char* destination, const char* source, size_t groupCount, char character62, char character63)
+{
+    size_t result = 0;
+
+    while (groupCount - result >= 16)
+    {
+        uint8x16x4_t in = vld4q_u8((const uint8_t*)source + 4 * result);
+        uint8x16_t v0, v1, v2, v3;
+        if (!Base64DecodeValuesNEON(in.val[0], (uint8_t)character62, (uint8_t)character63, &v0) ||
+            !Base64DecodeValuesNEON(in.val[1], (uint8_t)character62, (uint8_t)character63, &v1) ||
+            !Base64DecodeValuesNEON(in.val[2], (uint8_t)character62, (uint8_t)character63, &v2) ||
+            !Base64DecodeValuesNEON(in.val[3], (uint8_t)character62, (uint8_t)character63, &v3))
+        {
+            break;
+        }
+        else
+        {
+            uint8x16x3_t out;
+            out.val[0] = vorrq_u8(vshlq_n_u8(v0, 2), vshrq_n_u8(v1, 4));
+            out.val[1] = vorrq_u8(vshlq_n_u8(v1, 4), vshrq_n_u8(v2, 2));
+            out.val[2] = vorrq_u8(vshlq_n_u8(v2, 6), v3);
+            vst3q_u8(destination + 3 * result, out);
+            result += 16;
+        }
+    }
+    return result;
+}
+
+#endif /* BASE64_ACCEL_NEON */
+
+BASE64_ENCODE_GROUPS Base64Accel_GetEncoder(BASE64_IMPLEMENTATION implementation)
+{
+    BASE64_ENCODE_GROUPS result = NULL;
+
+    switch (implementation)
+    {
+#ifdef BASE64_ACCEL_X86
+    case BASE64_IMPLEMENTATION_SSSE3:
+        if (Base64HasSSSE3())
+        {
+            result = Base64EncodeSSSE3;
+        }
+        break;
+    case BASE64_IMPLEMENTATION_AVX2:
+        if (Base64HasAVX2())
+        {
+            result = Base64EncodeAVX2;
+        }
+        break;
+#endif
+#ifdef BASE64_ACCEL_NEON
+    case BASE64_IMPLEMENTATION_NEON:
+        result = Base64EncodeNEON;
+        break;
+#endif
+    default:
+        break;
+    }
+
+    return result;
+}
+
+BASE64_DECODE_GROUPS Base64Accel_GetDecoder(BASE64_IMPLEMENTATION implementation)
+{
+    BASE64_DECODE_GROUPS result = NULL;
+
+    switch (implementation)
+    {
+#ifdef BASE64_ACCEL_X86
+    case BASE64_IMPLEMENTATION_SSSE3:
+        if (Base64HasSSSE3())
+        {
+            result = Base64DecodeSSSE3;
+        }
+        break;
+    case BASE64_IMPLEMENTATION_AVX2:
+        if (Base64HasAVX2())
+        {
+            result = Base64DecodeAVX2;
+        }
+        break;
+#endif
+#ifdef BASE64_ACCEL_NEON
+    case BASE64_IMPLEMENTATION_NEON:
+        result = Base64DecodeNEON;
+        break;
+#endif
+    default:
+        break;
+    }
+
+    return result;
+}
@@ -0,0 +1,36 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/*this header is private to base64.c and base64_accel.c*/
+
+#ifndef BASE64_ACCEL_H
+#define BASE64_ACCEL_H
+
+#include "azure_c_shared_utility/base64.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#endif
+
+/*encodes groups of 3 bytes into groups of 4 characters for as long as the kernel can do it with whole vectors, returns the number of groups encoded.
+character62 and character63 are the last two characters of the alphabet, the first 62 are always A-Z, a-z, 0-9.
+A kernel never reads past source + 3 * groupCount nor writes past destination + 4 * groupCount.*/
+typedef size_t(*BASE64_ENCODE_GROUPS)(char* destination, const unsigned char* source, size_t groupCount, char character62, char character63);
+
+/*decodes groups of 4 characters into groups of 3 bytes for as long as the kernel can do it with whole vectors, returns the number of groups decoded.
+A kernel stops before the first vector holding a character outside the alphabet, the caller finds out which one it was.
+A kernel never reads past source + 4 * groupCount nor writes past destination + 3 * groupCount.*/
+typedef size_t(*BASE64_DECODE_GROUPS)(unsigned char* destination, const char* source, size_t groupCount, char character62, char character63);
+
+/*the kernels of implementation, NULL when this CPU or build does not have them*/
+extern BASE64_ENCODE_GROUPS Base64Accel_GetEncoder(BASE64_IMPLEMENTATION implementation);
+extern BASE64_DECODE_GROUPS Base64Accel_GetDecoder(BASE64_IMPLEMENTATION implementation);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BASE64_ACCEL_H */
@@ -17,6 +17,7 @@
 #endif
 
 static LOGGER_LOG global_log_function = etwlogger_log;
+LOG_CATEGORY global_log_level = AZ_LOG_TRACE;
 
 void xlogging_set_log_function(LOGGER_LOG log_function)
 {
@@ -28,6 +29,16 @@ LOGGER_LOG xlogging_get_log_function(void)
     return global_log_function;
 }
 
+void xlogging_set_log_level(LOG_CATEGORY log_level)
+{
+    global_log_level = log_level;
+}
+
+LOG_CATEGORY xlogging_get_log_level(void)
+{
+    return global_log_level;
+}
+
 LOGGER_LOG_GETLASTERROR global_log_function_GetLastError = etwlogger_log_with_GetLastError;
 
 void xlogging_set_log_function_GetLastError(LOGGER_LOG_GETLASTERROR log_function_GetLastError)
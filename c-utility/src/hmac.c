@@ -77,6 +77,9 @@ int hmacReset(HMACContext *ctx, enum SHAversion whichSha,
     /* inner padding - key XORd with ipad */
     unsigned char k_ipad[USHA_Max_Message_Block_Size];
 
+    /* outer padding - key XORd with opad */
+    unsigned char k_opad[USHA_Max_Message_Block_Size];
+
     /* temporary buffer when keylen > blocksize */
     unsigned char tempkey[USHAMaxHashSize];
 
@@ -116,19 +119,24 @@ int hmacReset(HMACContext *ctx, enum SHAversion whichSha,
     /* store key into the pads, XOR'd with ipad and opad values */
     for (i = 0; i < key_len; i++) {
         k_ipad[i] = key[i] ^ 0x36;
-        ctx->k_opad[i] = key[i] ^ 0x5c;
+        k_opad[i] = key[i] ^ 0x5c;
     }
     /* remaining pad bytes are '\0' XOR'd with ipad and opad values */
     for (; i < blocksize; i++) {
         k_ipad[i] = 0x36;
-        ctx->k_opad[i] = 0x5c;
+        k_opad[i] = 0x5c;
     }
 
     /* perform inner hash */
     /* init context for 1st pass */
     return USHAReset(&ctx->shaContext, whichSha) ||
         /* and start with inner pad */
-        USHAInput(&ctx->shaContext, k_ipad, blocksize);
+        USHAInput(&ctx->shaContext, k_ipad, blocksize) ||
+
+        /* key the outer hash now, so hmacResult */
+        /* and copies of this context only finish it */
+        USHAReset(&ctx->outerContext, whichSha) ||
+        USHAInput(&ctx->outerContext, k_opad, blocksize);
 }
 
 /*
@@ -217,17 +225,38 @@ int hmacResult(HMACContext *ctx, uint8_t *digest)
     return USHAResult(&ctx->shaContext, digest) ||
 
         /* perform outer SHA */
-        /* init context for 2nd pass */
-        USHAReset(&ctx->shaContext, (SHAversion)ctx->whichSha) ||
-
-        /* start with outer pad */
-        USHAInput(&ctx->shaContext, ctx->k_opad, ctx->blockSize) ||
-
+        /* (the outer pad was absorbed by hmacReset) */
         /* then results of 1st hash */
-        USHAInput(&ctx->shaContext, digest, ctx->hashSize) ||
+        USHAInput(&ctx->outerContext, digest, ctx->hashSize) ||
 
         /* finish up 2nd pass */
-        USHAResult(&ctx->shaContext, digest);
+        USHAResult(&ctx->outerContext, digest);
+}
+
+/*
+* hmacCopy
+*
+* Description:
+*   This function will copy the state of an HMAC context. Copying a
+*   context right after hmacReset gives a new context keyed with the
+*   same key, without hashing the inner and outer pads again.
+*
+* Parameters:
+*   destination: [out]
+*     The context to copy the state into.
+*   source: [in]
+*     The context to copy the state from.
+*
+* Returns:
+*   sha Error Code.
+*
+*/
+int hmacCopy(HMACContext *destination, const HMACContext *source)
+{
+    if (!destination || !source) return shaNull;
+
+    *destination = *source;
+    return shaSuccess;
 }
 
 
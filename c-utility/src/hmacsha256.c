@@ -1,7 +1,9 @@
 // Copyright (c) Microsoft. All rights reserved.
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
+#include <stdlib.h>
 #include <stddef.h>
+#include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/hmacsha256.h"
 #include "azure_c_shared_utility/hmac.h"
 #include "azure_c_shared_utility/buffer_.h"
@@ -33,3 +35,85 @@ HMACSHA256_RESULT HMACSHA256_ComputeHash(const unsigned char* key, size_t keyLen
 
     return result;
 }
+
+typedef struct HMACSHA256_KEY_TAG
+{
+    HMACContext keyedContext;
+} HMACSHA256_KEY;
+
+HMACSHA256_KEY_HANDLE HMACSHA256_CreateKey(const unsigned char* key, size_t keyLen)
+{
+    return HMACSHA256_CreateKeyWithPrefix(key, keyLen, NULL, 0);
+}
+
+HMACSHA256_KEY_HANDLE HMACSHA256_CreateKeyWithPrefix(const unsigned char* key, size_t keyLen, const unsigned char* prefix, size_t prefixLen)
+{
+    HMACSHA256_KEY* result;
+
+    if (key == NULL ||
+        keyLen == 0 ||
+        (prefix == NULL && prefixLen != 0))
+    {
+        result = NULL;
+    }
+    else
+    {
+        result = (HMACSHA256_KEY*)malloc(sizeof(HMACSHA256_KEY));
+        if (result != NULL)
+        {
+            if ((hmacReset(&result->keyedContext, SHA256, key, (int)keyLen) != 0) ||
+                ((prefixLen > 0) && (hmacInput(&result->keyedContext, prefix, (int)prefixLen) != 0)))
+            {
+                free(result);
+                result = NULL;
+            }
+        }
+    }
+
+    return result;
+}
+
+HMACSHA256_RESULT HMACSHA256_ComputeHashWithKey(HMACSHA256_KEY_HANDLE key, const unsigned char* payload, size_t payloadLen, unsigned char* hash)
+{
+    HMACSHA256_RESULT result;
+
+    if (key == NULL ||
+        payload == NULL ||
+        payloadLen == 0 ||
+        hash == NULL)
+    {
+        result = HMACSHA256_INVALID_ARG;
+    }
+    else
+    {
+        /*the key keeps the state hmacReset left, every hash starts from a copy of it*/
+        HMACContext context;
+        if ((hmacCopy(&context, &key->keyedContext) != 0) ||
+            (hmacInput(&context, payload, (int)payloadLen) != 0) ||
+            (hmacResult(&context, hash) != 0))
+        {
+            result = HMACSHA256_ERROR;
+        }
+        else
+        {
+            result = HMACSHA256_OK;
+        }
+    }
+
+    return result;
+}
+
+void HMACSHA256_DestroyKey(HMACSHA256_KEY_HANDLE key)
+{
+    if (key != NULL)
+    {
+        /*the states are derived from the secret, do not leave them in freed memory*/
+        volatile unsigned char* bytes = (volatile unsigned char*)key;
+        size_t i;
+        for (i = 0; i < sizeof(HMACSHA256_KEY); i++)
+        {
+            bytes[i] = 0;
+        }
+        free(key);
+    }
+}
@@ -2,6 +2,8 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/httpapiex.h"
 #include "azure_c_shared_utility/optimize_size.h"
@@ -9,6 +11,9 @@
 #include "azure_c_shared_utility/strings.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "azure_c_shared_utility/vector.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/tickcounter.h"
+#include "azure_c_shared_utility/shared_util_options.h"
 
 typedef struct HTTPAPIEX_SAVED_OPTION_TAG
 {
@@ -22,8 +27,35 @@ typedef struct HTTPAPIEX_HANDLE_DATA_TAG
     int k;
     HTTP_HANDLE httpHandle;
     VECTOR_HANDLE savedOptions;
+    char* poolKey; /*identifies the connection in the connection pool, NULL when the connection cannot be pooled*/
+    size_t poolKeyLength;
+    bool isReusedConnection;
+    tickcounter_ms_t requestStartTime;
 }HTTPAPIEX_HANDLE_DATA;
 
+typedef struct HTTPAPIEX_IDLE_CONNECTION_TAG
+{
+    char* poolKey;
+    size_t poolKeyLength;
+    HTTP_HANDLE httpHandle;
+    tickcounter_ms_t idleSince;
+}HTTPAPIEX_IDLE_CONNECTION;
+
+typedef struct HTTPAPIEX_CONNECTION_POOL_TAG
+{
+    TICK_COUNTER_HANDLE tickCounter;
+    VECTOR_HANDLE idleConnections; /*of HTTPAPIEX_IDLE_CONNECTION, oldest first*/
+    size_t maxIdleConnectionsPerHost;
+    tickcounter_ms_t idleTimeoutInMilliseconds;
+    size_t requestsInFlight; /*requests that acquired the pool, the last one to end destroys a disabled pool*/
+    bool isDisabled;
+    HTTPAPIEX_CONNECTION_POOL_STATISTICS statistics;
+}HTTPAPIEX_CONNECTION_POOL;
+
+/*guards connectionPool and the pools, created by the first HTTPAPIEX_EnableConnectionPool and never destroyed so that a request can always take it*/
+static LOCK_HANDLE connectionPoolLock = NULL;
+static HTTPAPIEX_CONNECTION_POOL* connectionPool = NULL;
+
 DEFINE_ENUM_STRINGS(HTTPAPIEX_RESULT, HTTPAPIEX_RESULT_VALUES);
 
 #define LOG_HTTAPIEX_ERROR() LogError("error code = %s", ENUM_TO_STRING(HTTPAPIEX_RESULT, result))
@@ -70,6 +102,10 @@ HTTPAPIEX_HANDLE HTTPAPIEX_Create(const char* hostName)
                 {
                     handleData->k = -1;
                     handleData->httpHandle = NULL;
+                    handleData->poolKey = NULL;
+                    handleData->poolKeyLength = 0;
+                    handleData->isReusedConnection = false;
+                    handleData->requestStartTime = 0;
                     result = handleData;
                 }
             }
@@ -191,6 +227,322 @@ static int buildBufferIfNotExist(BUFFER_HANDLE originalRequestContent, bool* isO
 
 static unsigned int dummyStatusCode;
 
+#define POOLABLE_OPTION_COUNT 5
+
+/*builds the key under which the connection of handleData is pooled: the host name followed by the names and values of the TLS options, all '\0' terminated*/
+/*returns NULL when an option that cannot be compared has been set, such connections are never shared*/
+static char* buildPoolKey(HTTPAPIEX_HANDLE_DATA* handleData, size_t* poolKeyLength)
+{
+    char* result;
+    /*these options are strings, so two handles agree on them when the strings are equal*/
+    const char* optionNames[POOLABLE_OPTION_COUNT] = { OPTION_TRUSTED_CERT, SU_OPTION_X509_CERT, SU_OPTION_X509_PRIVATE_KEY, OPTION_X509_ECC_CERT, OPTION_X509_ECC_KEY };
+    const char* optionValues[POOLABLE_OPTION_COUNT] = { NULL, NULL, NULL, NULL, NULL };
+    const char* hostName = STRING_c_str(handleData->hostName);
+    size_t vectorSize = VECTOR_size(handleData->savedOptions);
+    bool isPoolable = (hostName != NULL);
+    size_t i;
+
+    for (i = 0; isPoolable && (i < vectorSize); i++)
+    {
+        HTTPAPIEX_SAVED_OPTION* option = (HTTPAPIEX_SAVED_OPTION*)VECTOR_element(handleData->savedOptions, i);
+        size_t j;
+        for (j = 0; (j < POOLABLE_OPTION_COUNT) && (strcmp(option->optionName, optionNames[j]) != 0); j++)
+        {
+        }
+
+        if (j == POOLABLE_OPTION_COUNT)
+        {
+            isPoolable = false;
+        }
+        else
+        {
+            optionValues[j] = (const char*)option->value;
+        }
+    }
+
+    if (!isPoolable)
+    {
+        result = NULL;
+    }
+    else
+    {
+        size_t length = strlen(hostName) + 1;
+        for (i = 0; i < POOLABLE_OPTION_COUNT; i++)
+        {
+            if (optionValues[i] != NULL)
+            {
+                length += strlen(optionNames[i]) + 1 + strlen(optionValues[i]) + 1;
+            }
+        }
+
+        if ((result = (char*)malloc(length)) == NULL)
+        {
+            LogError("unable to malloc");
+        }
+        else
+        {
+            char* where = result;
+            size_t fieldLength = strlen(hostName) + 1;
+            (void)memcpy(where, hostName, fieldLength);
+            where += fieldLength;
+            for (i = 0; i < POOLABLE_OPTION_COUNT; i++)
+            {
+                if (optionValues[i] != NULL)
+                {
+                    fieldLength = strlen(optionNames[i]) + 1;
+                    (void)memcpy(where, optionNames[i], fieldLength);
+                    where += fieldLength;
+                    fieldLength = strlen(optionValues[i]) + 1;
+                    (void)memcpy(where, optionValues[i], fieldLength);
+                    where += fieldLength;
+                }
+            }
+            *poolKeyLength = length;
+        }
+    }
+    return result;
+}
+
+static bool isSamePoolKey(const HTTPAPIEX_IDLE_CONNECTION* idleConnection, const char* poolKey, size_t poolKeyLength)
+{
+    return (idleConnection->poolKeyLength == poolKeyLength) && (memcmp(idleConnection->poolKey, poolKey, poolKeyLength) == 0);
+}
+
+/*called with connectionPoolLock locked*/
+static void closeExpiredConnections(HTTPAPIEX_CONNECTION_POOL* pool, tickcounter_ms_t now)
+{
+    size_t i = VECTOR_size(pool->idleConnections);
+    while (i > 0)
+    {
+        HTTPAPIEX_IDLE_CONNECTION* idleConnection;
+        i--;
+        idleConnection = (HTTPAPIEX_IDLE_CONNECTION*)VECTOR_element(pool->idleConnections, i);
+        if (now - idleConnection->idleSince >= pool->idleTimeoutInMilliseconds)
+        {
+            HTTPAPI_CloseConnection(idleConnection->httpHandle);
+            free(idleConnection->poolKey);
+            VECTOR_erase(pool->idleConnections, idleConnection, 1);
+            pool->statistics.connectionsExpired++;
+        }
+    }
+}
+
+/*prepares handleData to give its connection back to the pool after the request, when canReuse is true it also tries to take an idle connection*/
+/*returns true when handleData->httpHandle is an idle connection taken from the pool*/
+static bool takeIdleConnection(HTTPAPIEX_CONNECTION_POOL* pool, HTTPAPIEX_HANDLE_DATA* handleData, bool canReuse)
+{
+    if (handleData->poolKey != NULL)
+    {
+        free(handleData->poolKey);
+        handleData->poolKey = NULL;
+    }
+    handleData->isReusedConnection = false;
+
+    if (tickcounter_get_current_ms(pool->tickCounter, &handleData->requestStartTime) != 0)
+    {
+        LogError("unable to tickcounter_get_current_ms, the connection shall not be pooled");
+    }
+    else if ((handleData->poolKey = buildPoolKey(handleData, &handleData->poolKeyLength)) == NULL)
+    {
+        /*the connection is private to this request*/
+    }
+    else if (!canReuse)
+    {
+        /*a new connection is created*/
+    }
+    else if (Lock(connectionPoolLock) != LOCK_OK)
+    {
+        LogError("unable to Lock");
+    }
+    else
+    {
+        size_t i;
+        closeExpiredConnections(pool, handleData->requestStartTime);
+
+        /*the most recently used connection is the least likely to have been closed by the server*/
+        i = VECTOR_size(pool->idleConnections);
+        while (i > 0)
+        {
+            HTTPAPIEX_IDLE_CONNECTION* idleConnection;
+            i--;
+            idleConnection = (HTTPAPIEX_IDLE_CONNECTION*)VECTOR_element(pool->idleConnections, i);
+            if (isSamePoolKey(idleConnection, handleData->poolKey, handleData->poolKeyLength))
+            {
+                handleData->httpHandle = idleConnection->httpHandle;
+                handleData->isReusedConnection = true;
+                free(idleConnection->poolKey);
+                VECTOR_erase(pool->idleConnections, idleConnection, 1);
+                break;
+            }
+        }
+        (void)Unlock(connectionPoolLock);
+    }
+    return handleData->isReusedConnection;
+}
+
+static bool isConnectionClose(const char* connectionHeaderValue)
+{
+    const char* close = "close";
+    size_t i;
+    for (i = 0; (close[i] != '\0') && (tolower((unsigned char)connectionHeaderValue[i]) == close[i]); i++)
+    {
+    }
+    return (close[i] == '\0') && (connectionHeaderValue[i] == '\0');
+}
+
+/*ends the use of handleData->httpHandle by the request that completed, the connection becomes idle in the pool or is closed*/
+static void giveBackConnection(HTTPAPIEX_CONNECTION_POOL* pool, HTTPAPIEX_HANDLE_DATA* handleData, HTTP_HEADERS_HANDLE responseHttpHeadersHandle)
+{
+    bool isPooled = false;
+    if (handleData->poolKey != NULL)
+    {
+        const char* connectionHeaderValue = HTTPHeaders_FindHeaderValue(responseHttpHeadersHandle, "Connection");
+        tickcounter_ms_t now;
+        if (tickcounter_get_current_ms(pool->tickCounter, &now) != 0)
+        {
+            LogError("unable to tickcounter_get_current_ms");
+        }
+        else if (Lock(connectionPoolLock) != LOCK_OK)
+        {
+            LogError("unable to Lock");
+        }
+        else
+        {
+            tickcounter_ms_t elapsed = now - handleData->requestStartTime;
+            if (handleData->isReusedConnection)
+            {
+                pool->statistics.requestsOnReusedConnections++;
+                pool->statistics.reusedConnectionsRequestTimeInMilliseconds += elapsed;
+            }
+            else
+            {
+                pool->statistics.requestsOnNewConnections++;
+                pool->statistics.newConnectionsRequestTimeInMilliseconds += elapsed;
+            }
+
+            /*a pool disabled during the request takes no more connections*/
+            if (!pool->isDisabled &&
+                ((connectionHeaderValue == NULL) || !isConnectionClose(connectionHeaderValue)))
+            {
+                size_t sameKeyCount = 0;
+                size_t vectorSize = VECTOR_size(pool->idleConnections);
+                size_t i;
+                for (i = 0; i < vectorSize; i++)
+                {
+                    if (isSamePoolKey((HTTPAPIEX_IDLE_CONNECTION*)VECTOR_element(pool->idleConnections, i), handleData->poolKey, handleData->poolKeyLength))
+                    {
+                        sameKeyCount++;
+                    }
+                }
+
+                if (sameKeyCount < pool->maxIdleConnectionsPerHost)
+                {
+                    HTTPAPIEX_IDLE_CONNECTION idleConnection;
+                    idleConnection.poolKey = handleData->poolKey;
+                    idleConnection.poolKeyLength = handleData->poolKeyLength;
+                    idleConnection.httpHandle = handleData->httpHandle;
+                    idleConnection.idleSince = now;
+                    if (VECTOR_push_back(pool->idleConnections, &idleConnection, 1) != 0)
+                    {
+                        LogError("unable to VECTOR_push_back");
+                    }
+                    else
+                    {
+                        handleData->poolKey = NULL;
+                        isPooled = true;
+                    }
+                }
+            }
+
+            if (!isPooled)
+            {
+                pool->statistics.connectionsDiscarded++;
+            }
+            (void)Unlock(connectionPoolLock);
+        }
+    }
+
+    if (!isPooled)
+    {
+        HTTPAPI_CloseConnection(handleData->httpHandle);
+    }
+    handleData->httpHandle = NULL;
+    handleData->isReusedConnection = false;
+    if (handleData->poolKey != NULL)
+    {
+        free(handleData->poolKey);
+        handleData->poolKey = NULL;
+    }
+}
+
+/*called with connectionPoolLock locked or when no other thread can see the pool*/
+static void destroyConnectionPool(HTTPAPIEX_CONNECTION_POOL* pool)
+{
+    size_t i;
+    size_t vectorSize = VECTOR_size(pool->idleConnections);
+    for (i = 0; i < vectorSize; i++)
+    {
+        HTTPAPIEX_IDLE_CONNECTION* idleConnection = (HTTPAPIEX_IDLE_CONNECTION*)VECTOR_element(pool->idleConnections, i);
+        HTTPAPI_CloseConnection(idleConnection->httpHandle);
+        free(idleConnection->poolKey);
+    }
+    VECTOR_destroy(pool->idleConnections);
+    tickcounter_destroy(pool->tickCounter);
+    HTTPAPI_Deinit();
+    free(pool);
+}
+
+/*returns the enabled pool, which cannot be destroyed before releaseConnectionPool, or NULL when the pool is not enabled*/
+static HTTPAPIEX_CONNECTION_POOL* acquireConnectionPool(void)
+{
+    HTTPAPIEX_CONNECTION_POOL* result;
+    /*the unlocked read only spares the lock to the requests when the pool was never enabled, a request racing HTTPAPIEX_EnableConnectionPool may or may not use the pool*/
+    if (connectionPool == NULL)
+    {
+        result = NULL;
+    }
+    else if (Lock(connectionPoolLock) != LOCK_OK)
+    {
+        LogError("unable to Lock, the request shall not use the pool");
+        result = NULL;
+    }
+    else
+    {
+        result = connectionPool;
+        if (result != NULL)
+        {
+            result->requestsInFlight++;
+        }
+        (void)Unlock(connectionPoolLock);
+    }
+    return result;
+}
+
+static void releaseConnectionPool(HTTPAPIEX_CONNECTION_POOL* pool)
+{
+    if (pool != NULL)
+    {
+        if (Lock(connectionPoolLock) != LOCK_OK)
+        {
+            LogError("unable to Lock, the pool is leaked");
+        }
+        else
+        {
+            pool->requestsInFlight--;
+            if (pool->isDisabled && (pool->requestsInFlight == 0))
+            {
+                destroyConnectionPool(pool);
+            }
+            (void)Unlock(connectionPoolLock);
+        }
+    }
+}
+
+static bool isIdempotent(HTTPAPI_REQUEST_TYPE requestType)
+{
+    return (requestType == HTTPAPI_REQUEST_GET) || (requestType == HTTPAPI_REQUEST_PUT) || (requestType == HTTPAPI_REQUEST_DELETE);
+}
+
 static int buildAllRequests(HTTPAPIEX_HANDLE_DATA* handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
     HTTP_HEADERS_HANDLE requestHttpHeadersHandle, BUFFER_HANDLE requestContent, unsigned int* statusCode,
     HTTP_HEADERS_HANDLE responseHttpHeadersHandle, BUFFER_HANDLE responseContent,
@@ -345,6 +697,9 @@ HTTPAPIEX_RESULT HTTPAPIEX_ExecuteRequest(HTTPAPIEX_HANDLE handle, HTTPAPI_REQUE
                 /*Codes_SRS_HTTPAPIEX_02_026: [A step shall be retried at most once.]*/
                 /*Codes_SRS_HTTPAPIEX_02_027: [If a step has been retried then all subsequent steps shall be retried too.]*/
                 bool st[3] = { false, false, false }; /*the three levels of possible failure in resilient send: HTTAPI_Init, HTTPAPI_CreateConnection, HTTPAPI_ExecuteRequest*/
+                bool canReuse = true; /*false once a request failed on a connection taken from the pool*/
+                /*Codes_SRS_HTTPAPIEX_99_014: [HTTPAPIEX_ExecuteRequest shall keep the connection pool it started with alive until it returns, even if HTTPAPIEX_DisableConnectionPool is called meanwhile.]*/
+                HTTPAPIEX_CONNECTION_POOL* pool = acquireConnectionPool();
                 if (handleData->k == -1)
                 {
                     handleData->k = 0;
@@ -382,7 +737,12 @@ HTTPAPIEX_RESULT HTTPAPIEX_ExecuteRequest(HTTPAPIEX_HANDLE handle, HTTPAPI_REQUE
                         }
                         case 1:
                         {
-                            if ((handleData->httpHandle = HTTPAPI_CreateConnection(STRING_c_str(handleData->hostName))) == NULL)
+                            /*Codes_SRS_HTTPAPIEX_99_001: [When the connection pool is enabled, HTTPAPIEX_ExecuteRequest shall use in step 2 the most recently idle connection of the pool that has the same host name and TLS options instead of creating one.]*/
+                            if ((pool != NULL) && takeIdleConnection(pool, handleData, canReuse))
+                            {
+                                goOn = true;
+                            }
+                            else if ((handleData->httpHandle = HTTPAPI_CreateConnection(STRING_c_str(handleData->hostName))) == NULL)
                             {
                                 goOn = false;
                             }
@@ -432,6 +792,12 @@ HTTPAPIEX_RESULT HTTPAPIEX_ExecuteRequest(HTTPAPIEX_HANDLE handle, HTTPAPI_REQUE
                         if (handleData->k == 2)
                         {
                             /*Codes_SRS_HTTPAPIEX_02_028: [HTTPAPIEX_ExecuteRequest shall return HTTPAPIEX_OK when a call to HTTPAPI_ExecuteRequest has been completed successfully.]*/
+                            if (pool != NULL)
+                            {
+                                /*Codes_SRS_HTTPAPIEX_99_002: [When the connection pool is enabled, HTTPAPIEX_ExecuteRequest shall give the connection back to the pool after a successful request, unless the response has the header Connection: close, the connection has options that cannot be compared or maxIdleConnectionsPerHost idle connections with the same host name and TLS options exist, in which case the connection shall be closed.]*/
+                                giveBackConnection(pool, handleData, toBeUsedResponseHttpHeadersHandle);
+                                handleData->k = 1;
+                            }
                             result = HTTPAPIEX_OK;
                             goto out;
                         }
@@ -457,6 +823,22 @@ HTTPAPIEX_RESULT HTTPAPIEX_ExecuteRequest(HTTPAPIEX_HANDLE handle, HTTPAPI_REQUE
                         {
                             HTTPAPI_CloseConnection(handleData->httpHandle);
                             handleData->httpHandle = NULL;
+                            if (handleData->isReusedConnection)
+                            {
+                                handleData->isReusedConnection = false;
+                                /*Codes_SRS_HTTPAPIEX_99_003: [If HTTPAPI_ExecuteRequest fails on a connection taken from the pool, HTTPAPIEX_ExecuteRequest shall close it and, for a GET, PUT or DELETE request, redo step 2 with a new connection without counting it as a retry.]*/
+                                /*Codes_SRS_HTTPAPIEX_99_015: [A POST or PATCH request shall not be sent again on a new connection, since the server might have received it.]*/
+                                if (isIdempotent(requestType))
+                                {
+                                    canReuse = false;
+                                    st[1] = false;
+                                }
+                                else
+                                {
+                                    /*no step is redone, the sequence fails*/
+                                    st[0] = true;
+                                }
+                            }
                             break;
                         }
                         case 2:
@@ -474,6 +856,7 @@ HTTPAPIEX_RESULT HTTPAPIEX_ExecuteRequest(HTTPAPIEX_HANDLE handle, HTTPAPI_REQUE
                 result = HTTPAPIEX_RECOVERYFAILED;
                 LogError("unable to recover sending to a working state");
             out:;
+                releaseConnectionPool(pool);
                 /*in all cases, unbuild the temporaries*/
                 if (isOriginalRequestContent == false)
                 {
@@ -512,6 +895,15 @@ void HTTPAPIEX_Destroy(HTTPAPIEX_HANDLE handle)
             HTTPAPI_CloseConnection(handleData->httpHandle);
             HTTPAPI_Deinit();
         }
+        else if (handleData->k == 1)
+        {
+            /*the connection has been given back to the pool*/
+            HTTPAPI_Deinit();
+        }
+        if (handleData->poolKey != NULL)
+        {
+            free(handleData->poolKey);
+        }
         STRING_delete(handleData->hostName);
 
         vectorSize = VECTOR_size(handleData->savedOptions);
@@ -655,3 +1047,160 @@ HTTPAPIEX_RESULT HTTPAPIEX_SetOption(HTTPAPIEX_HANDLE handle, const char* option
     }
     return result;
 }
+
+HTTPAPIEX_RESULT HTTPAPIEX_EnableConnectionPool(size_t maxIdleConnectionsPerHost, unsigned int idleTimeoutInMilliseconds)
+{
+    HTTPAPIEX_RESULT result;
+    /*Codes_SRS_HTTPAPIEX_99_004: [If maxIdleConnectionsPerHost is 0 then HTTPAPIEX_EnableConnectionPool shall return HTTPAPIEX_INVALID_ARG.]*/
+    if (maxIdleConnectionsPerHost == 0)
+    {
+        result = HTTPAPIEX_INVALID_ARG;
+        LOG_HTTAPIEX_ERROR();
+    }
+    /*Codes_SRS_HTTPAPIEX_99_016: [The first call to HTTPAPIEX_EnableConnectionPool shall create the lock that guards the pool, which is never destroyed.]*/
+    else if ((connectionPoolLock == NULL) &&
+        ((connectionPoolLock = Lock_Init()) == NULL))
+    {
+        result = HTTPAPIEX_ERROR;
+        LOG_HTTAPIEX_ERROR();
+    }
+    else if (Lock(connectionPoolLock) != LOCK_OK)
+    {
+        result = HTTPAPIEX_ERROR;
+        LOG_HTTAPIEX_ERROR();
+    }
+    else
+    {
+        if (connectionPool != NULL)
+        {
+            /*Codes_SRS_HTTPAPIEX_99_005: [If the connection pool is already enabled then HTTPAPIEX_EnableConnectionPool shall change its limits and return HTTPAPIEX_OK.]*/
+            connectionPool->maxIdleConnectionsPerHost = maxIdleConnectionsPerHost;
+            connectionPool->idleTimeoutInMilliseconds = idleTimeoutInMilliseconds;
+            result = HTTPAPIEX_OK;
+        }
+        else
+        {
+            /*Codes_SRS_HTTPAPIEX_99_006: [HTTPAPIEX_EnableConnectionPool shall create the tick counter and list of idle connections of the pool and shall call HTTPAPI_Init so that idle connections outlive the handles that created them.]*/
+            /*Codes_SRS_HTTPAPIEX_99_007: [If any of these fails then HTTPAPIEX_EnableConnectionPool shall return HTTPAPIEX_ERROR.]*/
+            HTTPAPIEX_CONNECTION_POOL* pool = (HTTPAPIEX_CONNECTION_POOL*)malloc(sizeof(HTTPAPIEX_CONNECTION_POOL));
+            if (pool == NULL)
+            {
+                result = HTTPAPIEX_ERROR;
+                LOG_HTTAPIEX_ERROR();
+            }
+            else
+            {
+                (void)memset(pool, 0, sizeof(HTTPAPIEX_CONNECTION_POOL));
+                pool->maxIdleConnectionsPerHost = maxIdleConnectionsPerHost;
+                pool->idleTimeoutInMilliseconds = idleTimeoutInMilliseconds;
+                if ((pool->tickCounter = tickcounter_create()) == NULL)
+                {
+                    free(pool);
+                    result = HTTPAPIEX_ERROR;
+                    LOG_HTTAPIEX_ERROR();
+                }
+                else if ((pool->idleConnections = VECTOR_create(sizeof(HTTPAPIEX_IDLE_CONNECTION))) == NULL)
+                {
+                    tickcounter_destroy(pool->tickCounter);
+                    free(pool);
+                    result = HTTPAPIEX_ERROR;
+                    LOG_HTTAPIEX_ERROR();
+                }
+                else if (HTTPAPI_Init() != HTTPAPI_OK)
+                {
+                    VECTOR_destroy(pool->idleConnections);
+                    tickcounter_destroy(pool->tickCounter);
+                    free(pool);
+                    result = HTTPAPIEX_ERROR;
+                    LOG_HTTAPIEX_ERROR();
+                }
+                else
+                {
+                    /*Codes_SRS_HTTPAPIEX_99_008: [Otherwise HTTPAPIEX_EnableConnectionPool shall return HTTPAPIEX_OK.]*/
+                    connectionPool = pool;
+                    result = HTTPAPIEX_OK;
+                }
+            }
+        }
+        (void)Unlock(connectionPoolLock);
+    }
+    return result;
+}
+
+void HTTPAPIEX_DisableConnectionPool(void)
+{
+    /*Codes_SRS_HTTPAPIEX_99_009: [If the connection pool is not enabled then HTTPAPIEX_DisableConnectionPool shall take no action.]*/
+    if (connectionPool != NULL)
+    {
+        if (Lock(connectionPoolLock) != LOCK_OK)
+        {
+            LogError("unable to Lock, the connection pool stays enabled");
+        }
+        else
+        {
+            HTTPAPIEX_CONNECTION_POOL* pool = connectionPool;
+            connectionPool = NULL;
+            if (pool == NULL)
+            {
+                /*disabled meanwhile by another thread*/
+            }
+            else if (pool->requestsInFlight == 0)
+            {
+                /*Codes_SRS_HTTPAPIEX_99_010: [HTTPAPIEX_DisableConnectionPool shall close all the idle connections, call HTTPAPI_Deinit and free all the resources of the pool.]*/
+                destroyConnectionPool(pool);
+            }
+            else
+            {
+                /*Codes_SRS_HTTPAPIEX_99_017: [If requests are using the pool then HTTPAPIEX_DisableConnectionPool shall only stop new requests from using it, and the last of those requests shall close its idle connections and its own connection, call HTTPAPI_Deinit and free the pool.]*/
+                pool->isDisabled = true;
+            }
+            (void)Unlock(connectionPoolLock);
+        }
+    }
+}
+
+HTTPAPIEX_RESULT HTTPAPIEX_GetConnectionPoolStatistics(HTTPAPIEX_CONNECTION_POOL_STATISTICS* statistics)
+{
+    HTTPAPIEX_RESULT result;
+    /*Codes_SRS_HTTPAPIEX_99_011: [If parameter statistics is NULL then HTTPAPIEX_GetConnectionPoolStatistics shall return HTTPAPIEX_INVALID_ARG.]*/
+    if (statistics == NULL)
+    {
+        result = HTTPAPIEX_INVALID_ARG;
+        LOG_HTTAPIEX_ERROR();
+    }
+    /*Codes_SRS_HTTPAPIEX_99_012: [If the connection pool is not enabled then HTTPAPIEX_GetConnectionPoolStatistics shall return HTTPAPIEX_ERROR.]*/
+    else if (connectionPool == NULL)
+    {
+        result = HTTPAPIEX_ERROR;
+        LOG_HTTAPIEX_ERROR();
+    }
+    else if (Lock(connectionPoolLock) != LOCK_OK)
+    {
+        result = HTTPAPIEX_ERROR;
+        LOG_HTTAPIEX_ERROR();
+    }
+    else if (connectionPool == NULL)
+    {
+        (void)Unlock(connectionPoolLock);
+        result = HTTPAPIEX_ERROR;
+        LOG_HTTAPIEX_ERROR();
+    }
+    else
+    {
+        /*Codes_SRS_HTTPAPIEX_99_013: [HTTPAPIEX_GetConnectionPoolStatistics shall copy the counters of the pool to statistics, estimating the handshake time saved as the number of requests on reused connections times the difference between the average request time on new and on reused connections, and shall return HTTPAPIEX_OK.]*/
+        *statistics = connectionPool->statistics;
+        statistics->estimatedHandshakeTimeSavedInMilliseconds = 0;
+        if ((statistics->requestsOnNewConnections > 0) && (statistics->requestsOnReusedConnections > 0))
+        {
+            uint64_t averageOnNew = statistics->newConnectionsRequestTimeInMilliseconds / statistics->requestsOnNewConnections;
+            uint64_t averageOnReused = statistics->reusedConnectionsRequestTimeInMilliseconds / statistics->requestsOnReusedConnections;
+            if (averageOnNew > averageOnReused)
+            {
+                statistics->estimatedHandshakeTimeSavedInMilliseconds = (averageOnNew - averageOnReused) * statistics->requestsOnReusedConnections;
+            }
+        }
+        (void)Unlock(connectionPoolLock);
+        result = HTTPAPIEX_OK;
+    }
+    return result;
+}
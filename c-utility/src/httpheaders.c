@@ -2,8 +2,8 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
+#include <ctype.h>
 #include "azure_c_shared_utility/gballoc.h"
-#include "azure_c_shared_utility/map.h"
 #include "azure_c_shared_utility/httpheaders.h"
 #include <string.h>
 #include "azure_c_shared_utility/crt_abstractions.h"
@@ -11,11 +11,194 @@
 
 DEFINE_ENUM_STRINGS(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT_VALUES);
 
+/*most headers (Host, Content-Type, Content-Length...) fit here, only long ones (Authorization) take a second allocation*/
+#define HTTP_HEADER_INLINE_SIZE 48
+#define HTTP_HEADERS_INITIAL_CAPACITY 8
+#define NAME_VALUE_SEPARATOR_LENGTH 2 /*": "*/
+
+typedef struct HTTP_HEADER_TAG
+{
+    char* heapLine; /*name + ": " + value when it does not fit in inlineLine, NULL otherwise*/
+    char inlineLine[HTTP_HEADER_INLINE_SIZE];
+    size_t nameLength;
+    size_t lineLength;
+    size_t hash;
+} HTTP_HEADER;
+
 typedef struct HTTP_HEADERS_HANDLE_DATA_TAG
 {
-    MAP_HANDLE headers;
+    HTTP_HEADER* headers; /*in the order they were first added*/
+    size_t count;
+    size_t capacity;
+    size_t* buckets; /*2 * capacity slots, each holding 1 + the index of a header or 0 when empty*/
 } HTTP_HEADERS_HANDLE_DATA;
 
+static const char* headerLine(const HTTP_HEADER* header)
+{
+    return (header->heapLine != NULL) ? header->heapLine : header->inlineLine;
+}
+
+/*FNV-1a over the lowercase name, so names that only differ in case land in the same bucket*/
+static size_t hashName(const char* name, size_t nameLength)
+{
+    size_t hash = 2166136261u;
+    size_t i;
+    for (i = 0; i < nameLength; i++)
+    {
+        hash ^= (size_t)tolower((unsigned char)name[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static bool isSameName(const HTTP_HEADER* header, const char* name, size_t nameLength, size_t hash)
+{
+    bool result;
+    if ((header->hash != hash) || (header->nameLength != nameLength))
+    {
+        result = false;
+    }
+    else
+    {
+        const char* headerName = headerLine(header);
+        size_t i;
+        for (i = 0; i < nameLength; i++)
+        {
+            if (tolower((unsigned char)headerName[i]) != tolower((unsigned char)name[i]))
+            {
+                break;
+            }
+        }
+        result = (i == nameLength);
+    }
+    return result;
+}
+
+/*returns the index of the header called name, or count when there is none. *bucket is where it is or where it would go*/
+static size_t findHeader(const HTTP_HEADERS_HANDLE_DATA* handleData, const char* name, size_t nameLength, size_t hash, size_t* bucket)
+{
+    size_t result = handleData->count;
+
+    if (handleData->capacity > 0)
+    {
+        size_t mask = (2 * handleData->capacity) - 1;
+        size_t slot = hash & mask;
+        while (handleData->buckets[slot] != 0)
+        {
+            if (isSameName(&handleData->headers[handleData->buckets[slot] - 1], name, nameLength, hash))
+            {
+                result = handleData->buckets[slot] - 1;
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+        *bucket = slot;
+    }
+
+    return result;
+}
+
+/*doubles the room for headers and rebuilds the buckets for it*/
+static int growHeaders(HTTP_HEADERS_HANDLE_DATA* handleData)
+{
+    int result;
+    size_t newCapacity = (handleData->capacity == 0) ? HTTP_HEADERS_INITIAL_CAPACITY : (2 * handleData->capacity);
+    HTTP_HEADER* newHeaders = (HTTP_HEADER*)realloc(handleData->headers, newCapacity * sizeof(HTTP_HEADER));
+    if (newHeaders == NULL)
+    {
+        LogError("unable to realloc the headers");
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t* newBuckets;
+        handleData->headers = newHeaders;
+        if ((newBuckets = (size_t*)malloc(2 * newCapacity * sizeof(size_t))) == NULL)
+        {
+            LogError("unable to malloc the header buckets");
+            result = __FAILURE__;
+        }
+        else
+        {
+            size_t i;
+            size_t mask = (2 * newCapacity) - 1;
+            (void)memset(newBuckets, 0, 2 * newCapacity * sizeof(size_t));
+            for (i = 0; i < handleData->count; i++)
+            {
+                size_t slot = handleData->headers[i].hash & mask;
+                while (newBuckets[slot] != 0)
+                {
+                    slot = (slot + 1) & mask;
+                }
+                newBuckets[slot] = i + 1;
+            }
+            if (handleData->buckets != NULL)
+            {
+                free(handleData->buckets);
+            }
+            handleData->buckets = newBuckets;
+            handleData->capacity = newCapacity;
+            result = 0;
+        }
+    }
+    return result;
+}
+
+/*stores name + ": " + existingValue + ", " + value in the header, or name + ": " + value when there is no existingValue.
+name and existingValue may point into the line the header has now*/
+static int setHeaderLine(HTTP_HEADER* header, const char* name, size_t nameLength, const char* existingValue, size_t existingValueLength, const char* value, size_t valueLength)
+{
+    int result;
+    char inlineLine[HTTP_HEADER_INLINE_SIZE];
+    size_t lineLength = nameLength + NAME_VALUE_SEPARATOR_LENGTH + valueLength +
+        ((existingValue != NULL) ? (existingValueLength + /*COMMA_AND_SPACE_LENGTH*/ 2) : 0);
+    char* line = (lineLength < HTTP_HEADER_INLINE_SIZE) ? inlineLine : (char*)malloc(lineLength + /*EOL*/ 1);
+
+    if (line == NULL)
+    {
+        LogError("unable to malloc a header of %lu bytes", (unsigned long)lineLength);
+        result = __FAILURE__;
+    }
+    else
+    {
+        char* runLine = line;
+        (void)memcpy(runLine, name, nameLength);
+        runLine += nameLength;
+        (*runLine++) = ':';
+        (*runLine++) = ' ';
+        if (existingValue != NULL)
+        {
+            (void)memcpy(runLine, existingValue, existingValueLength);
+            runLine += existingValueLength;
+            (*runLine++) = ',';
+            (*runLine++) = ' ';
+        }
+        (void)memcpy(runLine, value, valueLength);
+        runLine[valueLength] = '\0';
+
+        /*only now that name and existingValue have been copied the old line can go*/
+        if (header->heapLine != NULL)
+        {
+            free(header->heapLine);
+        }
+
+        if (line == inlineLine)
+        {
+            (void)memcpy(header->inlineLine, inlineLine, lineLength + /*EOL*/ 1);
+            header->heapLine = NULL;
+        }
+        else
+        {
+            header->heapLine = line;
+        }
+        header->nameLength = nameLength;
+        header->lineLength = lineLength;
+        result = 0;
+    }
+
+    return result;
+}
+
 HTTP_HEADERS_HANDLE HTTPHeaders_Alloc(void)
 {
     /*Codes_SRS_HTTP_HEADERS_99_002:[ This API shall produce a HTTP_HANDLE that can later be used in subsequent calls to the module.]*/
@@ -29,17 +212,11 @@ HTTP_HEADERS_HANDLE HTTPHeaders_Alloc(void)
     else
     {
         /*Codes_SRS_HTTP_HEADERS_99_004:[ After a successful init, HTTPHeaders_GetHeaderCount shall report 0 existing headers.]*/
-        result->headers = Map_Create(NULL);
-        if (result->headers == NULL)
-        {
-            LogError("Map_Create failed");
-            free(result);
-            result = NULL;
-        }
-        else
-        {
-            /*all is fine*/
-        }
+        /*Codes_SRS_HTTP_HEADERS_99_040: [ HTTPHeaders_Alloc shall not allocate room for headers until the first one is added. ]*/
+        result->headers = NULL;
+        result->count = 0;
+        result->capacity = 0;
+        result->buckets = NULL;
     }
 
     /*Codes_SRS_HTTP_HEADERS_99_003:[ The function shall return NULL when the function cannot execute properly]*/
@@ -58,8 +235,23 @@ void HTTPHeaders_Free(HTTP_HEADERS_HANDLE handle)
     {
         /*Codes_SRS_HTTP_HEADERS_99_005:[ Calling this API shall de-allocate the data structures allocated by previous API calls to the same handle.]*/
         HTTP_HEADERS_HANDLE_DATA* handleData = (HTTP_HEADERS_HANDLE_DATA*)handle;
+        size_t i;
 
-        Map_Destroy(handleData->headers);
+        for (i = 0; i < handleData->count; i++)
+        {
+            if (handleData->headers[i].heapLine != NULL)
+            {
+                free(handleData->headers[i].heapLine);
+            }
+        }
+        if (handleData->headers != NULL)
+        {
+            free(handleData->headers);
+        }
+        if (handleData->buckets != NULL)
+        {
+            free(handleData->buckets);
+        }
         free(handleData);
     }
 }
@@ -100,7 +292,11 @@ static HTTP_HEADERS_RESULT headers_ReplaceHeaderNameValuePair(HTTP_HEADERS_HANDL
         else
         {
             HTTP_HEADERS_HANDLE_DATA* handleData = (HTTP_HEADERS_HANDLE_DATA*)handle;
-            const char* existingValue = Map_GetValueFromKey(handleData->headers, name);
+            size_t hash = hashName(name, nameLen);
+            size_t bucket = 0;
+            /*Codes_SRS_HTTP_HEADERS_99_041: [ Header names shall be compared without regard to case. ]*/
+            size_t index = findHeader(handleData, name, nameLen, hash, &bucket);
+
             /*eat up the whitespaces from value, as per RFC 2616, chapter 4.2 "The field value MAY be preceded by any amount of LWS, though a single SP is preferred."*/
             /*Codes_SRS_HTTP_HEADERS_02_002: [The LWS from the beginning of the value shall not be stored.] */
             while ((value[0] == ' ') || (value[0] == '\t') || (value[0] == '\r') || (value[0] == '\n'))
@@ -108,53 +304,49 @@ static HTTP_HEADERS_RESULT headers_ReplaceHeaderNameValuePair(HTTP_HEADERS_HANDL
                 value++;
             }
 
-            if (!replace && (existingValue != NULL))
+            if (index < handleData->count)
             {
-                size_t existingValueLen = strlen(existingValue);
-                size_t valueLen = strlen(value);
-                char* newValue = (char*)malloc(sizeof(char) * (existingValueLen + /*COMMA_AND_SPACE_LENGTH*/ 2 + valueLen + /*EOL*/ 1));
-                if (newValue == NULL)
+                HTTP_HEADER* header = &handleData->headers[index];
+                const char* line = headerLine(header);
+                /*Codes_SRS_HTTP_HEADERS_99_042: [ An existing header shall keep the name it was first added with. ]*/
+                if (setHeaderLine(header, line, header->nameLength,
+                    /*Codes_SRS_HTTP_HEADERS_99_017:[ If the name already exists in the collection of headers, the function shall concatenate the new value after the existing value, separated by a comma and a space as in: old-value+", "+new-value.]*/
+                    replace ? NULL : (line + header->nameLength + NAME_VALUE_SEPARATOR_LENGTH),
+                    header->lineLength - header->nameLength - NAME_VALUE_SEPARATOR_LENGTH,
+                    value, strlen(value)) != 0)
                 {
                     /*Codes_SRS_HTTP_HEADERS_99_015:[ The function shall return HTTP_HEADERS_ALLOC_FAILED when an internal request to allocate memory fails.]*/
                     result = HTTP_HEADERS_ALLOC_FAILED;
-                    LogError("failed to malloc , result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
+                    LogError("failed to update the header, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
                 }
                 else
                 {
-                    char* runNewValue;
-                    /*Codes_SRS_HTTP_HEADERS_99_017:[ If the name already exists in the collection of headers, the function shall concatenate the new value after the existing value, separated by a comma and a space as in: old-value+", "+new-value.]*/
-                    (void)memcpy(newValue, existingValue, existingValueLen);
-                    runNewValue = newValue + existingValueLen;
-                    (*runNewValue++) = ',';
-                    (*runNewValue++) = ' ';
-                    (void)memcpy(runNewValue, value, valueLen + /*EOL*/ 1);
-
-                    /*Codes_SRS_HTTP_HEADERS_99_016:[ The function shall store the name:value pair in such a way that when later retrieved by a call to GetHeader it will return a string that shall strcmp equal to the name+": "+value.]*/
-                    if (Map_AddOrUpdate(handleData->headers, name, newValue) != MAP_OK)
-                    {
-                        /*Codes_SRS_HTTP_HEADERS_99_015:[ The function shall return HTTP_HEADERS_ALLOC_FAILED when an internal request to allocate memory fails.]*/
-                        result = HTTP_HEADERS_ERROR;
-                        LogError("failed to Map_AddOrUpdate, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
-                    }
-                    else
-                    {
-                        /*Codes_SRS_HTTP_HEADERS_99_013:[ The function shall return HTTP_HEADERS_OK when execution is successful.]*/
-                        result = HTTP_HEADERS_OK;
-                    }
-                    free(newValue);
+                    /*Codes_SRS_HTTP_HEADERS_99_013:[ The function shall return HTTP_HEADERS_OK when execution is successful.]*/
+                    result = HTTP_HEADERS_OK;
                 }
             }
+            else if ((handleData->count == handleData->capacity) &&
+                ((growHeaders(handleData) != 0) || (findHeader(handleData, name, nameLen, hash, &bucket) != handleData->count)))
+            {
+                /*Codes_SRS_HTTP_HEADERS_99_015:[ The function shall return HTTP_HEADERS_ALLOC_FAILED when an internal request to allocate memory fails.]*/
+                result = HTTP_HEADERS_ALLOC_FAILED;
+                LogError("failed to make room for the header, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
+            }
             else
             {
+                HTTP_HEADER* header = &handleData->headers[handleData->count];
+                header->heapLine = NULL;
                 /*Codes_SRS_HTTP_HEADERS_99_016:[ The function shall store the name:value pair in such a way that when later retrieved by a call to GetHeader it will return a string that shall strcmp equal to the name+": "+value.]*/
-                if (Map_AddOrUpdate(handleData->headers, name, value) != MAP_OK)
+                if (setHeaderLine(header, name, nameLen, NULL, 0, value, strlen(value)) != 0)
                 {
                     /*Codes_SRS_HTTP_HEADERS_99_015:[ The function shall return HTTP_HEADERS_ALLOC_FAILED when an internal request to allocate memory fails.]*/
                     result = HTTP_HEADERS_ALLOC_FAILED;
-                    LogError("failed to Map_AddOrUpdate, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
+                    LogError("failed to store the header, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
                 }
                 else
                 {
+                    header->hash = hash;
+                    handleData->buckets[bucket] = ++handleData->count;
                     result = HTTP_HEADERS_OK;
                 }
             }
@@ -192,8 +384,19 @@ const char* HTTPHeaders_FindHeaderValue(HTTP_HEADERS_HANDLE httpHeadersHandle, c
         /*Codes_SRS_HTTP_HEADERS_99_018:[ Calling this API shall retrieve the value for a previously stored name.]*/
         /*Codes_SRS_HTTP_HEADERS_99_020:[ The return value shall be different than NULL when the name matches the name of a previously stored name:value pair.] */
         /*Codes_SRS_HTTP_HEADERS_99_021:[ In this case the return value shall point to a string that shall strcmp equal to the original stored string.]*/
+        /*Codes_SRS_HTTP_HEADERS_99_041: [ Header names shall be compared without regard to case. ]*/
         HTTP_HEADERS_HANDLE_DATA* handleData = (HTTP_HEADERS_HANDLE_DATA*)httpHeadersHandle;
-        result = Map_GetValueFromKey(handleData->headers, name);
+        size_t nameLength = strlen(name);
+        size_t bucket;
+        size_t index = findHeader(handleData, name, nameLength, hashName(name, nameLength), &bucket);
+        if (index < handleData->count)
+        {
+            result = headerLine(&handleData->headers[index]) + handleData->headers[index].nameLength + NAME_VALUE_SEPARATOR_LENGTH;
+        }
+        else
+        {
+            result = NULL;
+        }
     }
     return result;
 
@@ -213,20 +416,10 @@ HTTP_HEADERS_RESULT HTTPHeaders_GetHeaderCount(HTTP_HEADERS_HANDLE handle, size_
     else
     {
         HTTP_HEADERS_HANDLE_DATA *handleData = (HTTP_HEADERS_HANDLE_DATA *)handle;
-        const char*const* keys;
-        const char*const* values;
         /*Codes_SRS_HTTP_HEADERS_99_023:[ Calling this API shall provide the number of stored headers.]*/
-        if (Map_GetInternals(handleData->headers, &keys, &values, headerCount) != MAP_OK)
-        {
-            /*Codes_SRS_HTTP_HEADERS_99_037:[ The function shall return HTTP_HEADERS_ERROR when an internal error occurs.]*/
-            result = HTTP_HEADERS_ERROR;
-            LogError("Map_GetInternals failed, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
-        }
-        else
-        {
-            /*Codes_SRS_HTTP_HEADERS_99_026:[ The function shall write in *headersCount the number of currently stored headers and shall return HTTP_HEADERS_OK]*/
-            result = HTTP_HEADERS_OK;
-        }
+        /*Codes_SRS_HTTP_HEADERS_99_026:[ The function shall write in *headersCount the number of currently stored headers and shall return HTTP_HEADERS_OK]*/
+        *headerCount = handleData->count;
+        result = HTTP_HEADERS_OK;
     }
 
     return result;
@@ -248,51 +441,75 @@ HTTP_HEADERS_RESULT HTTPHeaders_GetHeader(HTTP_HEADERS_HANDLE handle, size_t ind
         LogError("invalid arg (NULL), result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
     }
     /*Codes_SRS_HTTP_HEADERS_99_029:[ The function shall return HTTP_HEADERS_INVALID_ARG if index is not valid (for example, out of range) for the currently stored headers.]*/
+    else if (index >= ((HTTP_HEADERS_HANDLE_DATA*)handle)->count)
+    {
+        result = HTTP_HEADERS_INVALID_ARG;
+        LogError("index out of bounds, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
+    }
     else
     {
-        HTTP_HEADERS_HANDLE_DATA* handleData = (HTTP_HEADERS_HANDLE_DATA*)handle;
-        const char*const* keys;
-        const char*const* values;
-        size_t headerCount;
-        if (Map_GetInternals(handleData->headers, &keys, &values, &headerCount) != MAP_OK)
+        HTTP_HEADER* header = &((HTTP_HEADERS_HANDLE_DATA*)handle)->headers[index];
+        *destination = (char*)malloc(sizeof(char) * (header->lineLength + /*EOL*/ 1));
+        if (*destination == NULL)
         {
             /*Codes_SRS_HTTP_HEADERS_99_034:[ The function shall return HTTP_HEADERS_ERROR when an internal error occurs]*/
             result = HTTP_HEADERS_ERROR;
-            LogError("Map_GetInternals failed, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
+            LogError("unable to malloc, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
         }
         else
         {
-            /*Codes_SRS_HTTP_HEADERS_99_029:[ The function shall return HTTP_HEADERS_INVALID_ARG if index is not valid (for example, out of range) for the currently stored headers.]*/
-            if (index >= headerCount)
-            {
-                result = HTTP_HEADERS_INVALID_ARG;
-                LogError("index out of bounds, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
-            }
-            else
+            /*Codes_SRS_HTTP_HEADERS_99_016:[ The function shall store the name:value pair in such a way that when later retrieved by a call to GetHeader it will return a string that shall strcmp equal to the name+": "+value.]*/
+            /*Codes_SRS_HTTP_HEADERS_99_027:[ Calling this API shall produce the string value+": "+pair) for the index header in the *destination parameter.]*/
+            (void)memcpy(*destination, headerLine(header), header->lineLength + /*EOL*/ 1);
+            /*Codes_SRS_HTTP_HEADERS_99_035:[ The function shall return HTTP_HEADERS_OK when the function executed without error.]*/
+            result = HTTP_HEADERS_OK;
+        }
+    }
+
+    return result;
+}
+
+HTTP_HEADERS_RESULT HTTPHeaders_Serialize(HTTP_HEADERS_HANDLE handle, char* destination, size_t destinationSize, size_t* serializedSize)
+{
+    HTTP_HEADERS_RESULT result;
+
+    /*Codes_SRS_HTTP_HEADERS_99_043: [ If handle or serializedSize is NULL, or destination is NULL while destinationSize is not 0, HTTPHeaders_Serialize shall return HTTP_HEADERS_INVALID_ARG. ]*/
+    if ((handle == NULL) ||
+        (serializedSize == NULL) ||
+        ((destination == NULL) && (destinationSize > 0)))
+    {
+        result = HTTP_HEADERS_INVALID_ARG;
+        LogError("invalid arg, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
+    }
+    else
+    {
+        HTTP_HEADERS_HANDLE_DATA* handleData = (HTTP_HEADERS_HANDLE_DATA*)handle;
+        size_t i;
+
+        /*Codes_SRS_HTTP_HEADERS_99_044: [ HTTPHeaders_Serialize shall write in *serializedSize the number of bytes that all the headers take as name+": "+value+"\r\n" lines. ]*/
+        *serializedSize = 0;
+        for (i = 0; i < handleData->count; i++)
+        {
+            *serializedSize += handleData->headers[i].lineLength + /*CRLF*/ 2;
+        }
+
+        if (*serializedSize > destinationSize)
+        {
+            /*Codes_SRS_HTTP_HEADERS_99_045: [ If the lines do not fit in destinationSize, HTTPHeaders_Serialize shall write nothing and return HTTP_HEADERS_INSUFFICIENT_BUFFER. ]*/
+            result = HTTP_HEADERS_INSUFFICIENT_BUFFER;
+        }
+        else
+        {
+            /*Codes_SRS_HTTP_HEADERS_99_046: [ HTTPHeaders_Serialize shall write the lines into destination in the order the headers were added and return HTTP_HEADERS_OK. ]*/
+            char* runDestination = destination;
+            for (i = 0; i < handleData->count; i++)
             {
-                size_t keyLen = strlen(keys[index]);
-                size_t valueLen = strlen(values[index]);
-                *destination = (char*)malloc(sizeof(char) * (keyLen + /*COLON_AND_SPACE_LENGTH*/ 2 + valueLen + /*EOL*/ 1));
-                if (*destination == NULL)
-                {
-                    /*Codes_SRS_HTTP_HEADERS_99_034:[ The function shall return HTTP_HEADERS_ERROR when an internal error occurs]*/
-                    result = HTTP_HEADERS_ERROR;
-                    LogError("unable to malloc, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
-                }
-                else
-                {
-                    /*Codes_SRS_HTTP_HEADERS_99_016:[ The function shall store the name:value pair in such a way that when later retrieved by a call to GetHeader it will return a string that shall strcmp equal to the name+": "+value.]*/
-                    /*Codes_SRS_HTTP_HEADERS_99_027:[ Calling this API shall produce the string value+": "+pair) for the index header in the *destination parameter.]*/
-                    char* runDestination = (*destination);
-                    (void)memcpy(runDestination, keys[index], keyLen);
-                    runDestination += keyLen;
-                    (*runDestination++) = ':';
-                    (*runDestination++) = ' ';
-                    (void)memcpy(runDestination, values[index], valueLen + /*EOL*/ 1);
-                    /*Codes_SRS_HTTP_HEADERS_99_035:[ The function shall return HTTP_HEADERS_OK when the function executed without error.]*/
-                    result = HTTP_HEADERS_OK;
-                }
+                (void)memcpy(runDestination, headerLine(&handleData->headers[i]), handleData->headers[i].lineLength);
+                runDestination += handleData->headers[i].lineLength;
+                (*runDestination++) = '\r';
+                (*runDestination++) = '\n';
             }
+            result = HTTP_HEADERS_OK;
         }
     }
 
@@ -318,16 +535,47 @@ HTTP_HEADERS_HANDLE HTTPHeaders_Clone(HTTP_HEADERS_HANDLE handle)
         else
         {
             HTTP_HEADERS_HANDLE_DATA* handleData = handle;
-            result->headers = Map_Clone(handleData->headers);
-            if (result->headers == NULL)
-            {
-                /*Codes_SRS_HTTP_HEADERS_02_005: [If cloning fails for any reason, then HTTPHeaders_Clone shall return NULL.] */
-                free(result);
-                result = NULL;
-            }
-            else
+            result->headers = NULL;
+            result->count = 0;
+            result->capacity = 0;
+            result->buckets = NULL;
+
+            if (handleData->capacity > 0)
             {
-                /*all is fine*/
+                if (((result->headers = (HTTP_HEADER*)malloc(handleData->capacity * sizeof(HTTP_HEADER))) == NULL) ||
+                    ((result->buckets = (size_t*)malloc(2 * handleData->capacity * sizeof(size_t))) == NULL))
+                {
+                    /*Codes_SRS_HTTP_HEADERS_02_005: [If cloning fails for any reason, then HTTPHeaders_Clone shall return NULL.] */
+                    HTTPHeaders_Free(result);
+                    result = NULL;
+                }
+                else
+                {
+                    (void)memcpy(result->buckets, handleData->buckets, 2 * handleData->capacity * sizeof(size_t));
+                    result->capacity = handleData->capacity;
+                    while (result->count < handleData->count)
+                    {
+                        HTTP_HEADER* source = &handleData->headers[result->count];
+                        HTTP_HEADER* header = &result->headers[result->count];
+                        *header = *source;
+                        if (source->heapLine != NULL)
+                        {
+                            if ((header->heapLine = (char*)malloc(source->lineLength + /*EOL*/ 1)) == NULL)
+                            {
+                                break;
+                            }
+                            (void)memcpy(header->heapLine, source->heapLine, source->lineLength + /*EOL*/ 1);
+                        }
+                        result->count++;
+                    }
+
+                    if (result->count < handleData->count)
+                    {
+                        /*Codes_SRS_HTTP_HEADERS_02_005: [If cloning fails for any reason, then HTTPHeaders_Clone shall return NULL.] */
+                        HTTPHeaders_Free(result);
+                        result = NULL;
+                    }
+                }
             }
         }
     }
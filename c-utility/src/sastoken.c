@@ -344,3 +344,261 @@ STRING_HANDLE SASToken_CreateString(const char* key, const char* scope, const ch
     }
     return result;
 }
+
+#define SAS_TOKEN_SCOPE_FIELD "SharedAccessSignature sr="
+#define SAS_TOKEN_SIGNATURE_FIELD "&sig="
+#define SAS_TOKEN_EXPIRY_FIELD "&se="
+#define SAS_TOKEN_KEYNAME_FIELD "&skn="
+#define SAS_TOKEN_FIELD_LENGTH(field) (sizeof(field) - 1)
+
+/*base64 of the hash, where every character can become a 3 character url escape*/
+#define SAS_TOKEN_SIGNATURE_MAX_LENGTH ((((HMACSHA256_HASH_SIZE + 2) / 3) * 4) * 3)
+
+typedef struct SAS_TOKEN_GENERATOR_TAG
+{
+    HMACSHA256_KEY_HANDLE signingKey;
+    const char* head; /*"SharedAccessSignature sr=<scope>&sig="*/
+    size_t headLength;
+    const char* tail; /*"&skn=<keyName>", empty without a keyName*/
+    size_t tailLength;
+} SAS_TOKEN_GENERATOR;
+
+static const char base64Characters[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/*writes the url encoding of one base64 character, the same way URL_Encode does*/
+static size_t writeUrlEncodedBase64Character(char c, char* destination)
+{
+    size_t result;
+    switch (c)
+    {
+    case '+':
+        destination[0] = '%'; destination[1] = '2'; destination[2] = 'b';
+        result = 3;
+        break;
+    case '/':
+        destination[0] = '%'; destination[1] = '2'; destination[2] = 'f';
+        result = 3;
+        break;
+    case '=':
+        destination[0] = '%'; destination[1] = '3'; destination[2] = 'd';
+        result = 3;
+        break;
+    default:
+        destination[0] = c;
+        result = 1;
+        break;
+    }
+    return result;
+}
+
+/*base64 and url encodes the hash in one pass, destination has room for SAS_TOKEN_SIGNATURE_MAX_LENGTH characters*/
+static size_t encodeSignature(const unsigned char hash[HMACSHA256_HASH_SIZE], char* destination)
+{
+    size_t result = 0;
+    size_t i;
+    for (i = 0; i + 2 < HMACSHA256_HASH_SIZE; i += 3)
+    {
+        result += writeUrlEncodedBase64Character(base64Characters[hash[i] >> 2], destination + result);
+        result += writeUrlEncodedBase64Character(base64Characters[((hash[i] & 0x03) << 4) | (hash[i + 1] >> 4)], destination + result);
+        result += writeUrlEncodedBase64Character(base64Characters[((hash[i + 1] & 0x0F) << 2) | (hash[i + 2] >> 6)], destination + result);
+        result += writeUrlEncodedBase64Character(base64Characters[hash[i + 2] & 0x3F], destination + result);
+    }
+    if (i + 1 == HMACSHA256_HASH_SIZE)
+    {
+        result += writeUrlEncodedBase64Character(base64Characters[hash[i] >> 2], destination + result);
+        result += writeUrlEncodedBase64Character(base64Characters[(hash[i] & 0x03) << 4], destination + result);
+        result += writeUrlEncodedBase64Character('=', destination + result);
+        result += writeUrlEncodedBase64Character('=', destination + result);
+    }
+    else if (i + 2 == HMACSHA256_HASH_SIZE)
+    {
+        result += writeUrlEncodedBase64Character(base64Characters[hash[i] >> 2], destination + result);
+        result += writeUrlEncodedBase64Character(base64Characters[((hash[i] & 0x03) << 4) | (hash[i + 1] >> 4)], destination + result);
+        result += writeUrlEncodedBase64Character(base64Characters[(hash[i + 1] & 0x0F) << 2], destination + result);
+        result += writeUrlEncodedBase64Character('=', destination + result);
+    }
+    return result;
+}
+
+SAS_TOKEN_GENERATOR_HANDLE SASToken_CreateGenerator(const char* key, const char* scope, const char* keyName)
+{
+    SAS_TOKEN_GENERATOR* result;
+
+    /*Codes_SRS_SASTOKEN_99_001: [ If key or scope is NULL then SASToken_CreateGenerator shall fail and return NULL. ]*/
+    /*Codes_SRS_SASTOKEN_99_002: [ keyName is optional and can be NULL. ]*/
+    if ((key == NULL) ||
+        (scope == NULL))
+    {
+        LogError("Invalid Parameter to SASToken_CreateGenerator. key: %p, scope: %p, keyName: %p", key, scope, keyName);
+        result = NULL;
+    }
+    else
+    {
+        size_t scopeLength = strlen(scope);
+        size_t keyNameLength = (keyName == NULL) ? 0 : strlen(keyName);
+        size_t headLength = SAS_TOKEN_FIELD_LENGTH(SAS_TOKEN_SCOPE_FIELD) + scopeLength + SAS_TOKEN_FIELD_LENGTH(SAS_TOKEN_SIGNATURE_FIELD);
+        size_t tailLength = (keyName == NULL) ? 0 : SAS_TOKEN_FIELD_LENGTH(SAS_TOKEN_KEYNAME_FIELD) + keyNameLength;
+
+        /*Codes_SRS_SASTOKEN_99_003: [ SASToken_CreateGenerator shall allocate the generator and the fixed parts of the token in one block. ]*/
+        if ((result = (SAS_TOKEN_GENERATOR*)malloc(sizeof(SAS_TOKEN_GENERATOR) + headLength + tailLength)) == NULL)
+        {
+            /*Codes_SRS_SASTOKEN_99_004: [ If any of the operations of SASToken_CreateGenerator fails then it shall fail and return NULL. ]*/
+            LogError("Unable to allocate the SAS token generator.");
+        }
+        else
+        {
+            char* head = (char*)(result + 1);
+            char* tail = head + headLength;
+            char* toBeHashed;
+
+            /*Codes_SRS_SASTOKEN_99_005: [ SASToken_CreateGenerator shall allocate the string scope followed by "\n", the prefix of the string to sign. ]*/
+            if ((toBeHashed = (char*)malloc(scopeLength + 1)) == NULL)
+            {
+                /*Codes_SRS_SASTOKEN_99_004: [ If any of the operations of SASToken_CreateGenerator fails then it shall fail and return NULL. ]*/
+                LogError("Unable to allocate the string to sign.");
+                free(result);
+                result = NULL;
+            }
+            else
+            {
+                BUFFER_HANDLE decodedKey;
+
+                (void)memcpy(toBeHashed, scope, scopeLength);
+                toBeHashed[scopeLength] = '\n';
+
+                /*Codes_SRS_SASTOKEN_99_006: [ The key parameter is decoded from base64. ]*/
+                if ((decodedKey = Base64_Decoder(key)) == NULL)
+                {
+                    /*Codes_SRS_SASTOKEN_99_004: [ If any of the operations of SASToken_CreateGenerator fails then it shall fail and return NULL. ]*/
+                    LogError("Unable to decode the key for generating the SAS.");
+                    free(result);
+                    result = NULL;
+                }
+                else
+                {
+                    size_t decodedKeyLength = BUFFER_length(decodedKey);
+                    const unsigned char* decodedKeyBytes = BUFFER_u_char(decodedKey);
+
+                    /*Codes_SRS_SASTOKEN_99_007: [ SASToken_CreateGenerator shall create an HMAC-SHA256 key from the decoded key with the string to sign prefix by calling HMACSHA256_CreateKeyWithPrefix. ]*/
+                    if ((result->signingKey = HMACSHA256_CreateKeyWithPrefix(decodedKeyBytes, decodedKeyLength, (const unsigned char*)toBeHashed, scopeLength + 1)) == NULL)
+                    {
+                        /*Codes_SRS_SASTOKEN_99_004: [ If any of the operations of SASToken_CreateGenerator fails then it shall fail and return NULL. ]*/
+                        LogError("Unable to create the HMAC key for generating the SAS.");
+                        free(result);
+                        result = NULL;
+                    }
+                    else
+                    {
+                        /*Codes_SRS_SASTOKEN_99_008: [ SASToken_CreateGenerator shall keep "SharedAccessSignature sr=" scope "&sig=" as the head of the token and "&skn=" keyName as its tail when keyName is not NULL. ]*/
+                        (void)memcpy(head, SAS_TOKEN_SCOPE_FIELD, SAS_TOKEN_FIELD_LENGTH(SAS_TOKEN_SCOPE_FIELD));
+                        (void)memcpy(head + SAS_TOKEN_FIELD_LENGTH(SAS_TOKEN_SCOPE_FIELD), scope, scopeLength);
+                        (void)memcpy(head + SAS_TOKEN_FIELD_LENGTH(SAS_TOKEN_SCOPE_FIELD) + scopeLength, SAS_TOKEN_SIGNATURE_FIELD, SAS_TOKEN_FIELD_LENGTH(SAS_TOKEN_SIGNATURE_FIELD));
+                        if (keyName != NULL)
+                        {
+                            (void)memcpy(tail, SAS_TOKEN_KEYNAME_FIELD, SAS_TOKEN_FIELD_LENGTH(SAS_TOKEN_KEYNAME_FIELD));
+                            (void)memcpy(tail + SAS_TOKEN_FIELD_LENGTH(SAS_TOKEN_KEYNAME_FIELD), keyName, keyNameLength);
+                        }
+                        result->head = head;
+                        result->headLength = headLength;
+                        result->tail = tail;
+                        result->tailLength = tailLength;
+                    }
+                    BUFFER_delete(decodedKey);
+                }
+                free(toBeHashed);
+            }
+        }
+    }
+
+    return result;
+}
+
+int SASToken_Generate(SAS_TOKEN_GENERATOR_HANDLE generator, size_t expiry, char* destination, size_t destinationSize, size_t* tokenLength)
+{
+    int result;
+
+    /*Codes_SRS_SASTOKEN_99_009: [ If generator or destination is NULL then SASToken_Generate shall fail and return a non-zero value. ]*/
+    if ((generator == NULL) ||
+        (destination == NULL))
+    {
+        LogError("Invalid Parameter to SASToken_Generate. generator: %p, destination: %p", generator, destination);
+        result = __FAILURE__;
+    }
+    else
+    {
+        char tokenExpirationTime[32];
+
+        /*Codes_SRS_SASTOKEN_99_010: [ SASToken_Generate shall convert expiry to its decimal string form by calling size_tToString. ]*/
+        if (size_tToString(tokenExpirationTime, sizeof(tokenExpirationTime), expiry) != 0)
+        {
+            /*Codes_SRS_SASTOKEN_99_011: [ If any of the operations of SASToken_Generate fails then it shall fail and return a non-zero value. ]*/
+            LogError("For some reason converting seconds to a string failed.  No SAS can be generated.");
+            result = __FAILURE__;
+        }
+        else
+        {
+            size_t expiryLength = strlen(tokenExpirationTime);
+            unsigned char hash[HMACSHA256_HASH_SIZE];
+
+            /*Codes_SRS_SASTOKEN_99_012: [ SASToken_Generate shall sign the expiry string with the key of the generator by calling HMACSHA256_ComputeHashWithKey. ]*/
+            if (HMACSHA256_ComputeHashWithKey(generator->signingKey, (const unsigned char*)tokenExpirationTime, expiryLength, hash) != HMACSHA256_OK)
+            {
+                /*Codes_SRS_SASTOKEN_99_011: [ If any of the operations of SASToken_Generate fails then it shall fail and return a non-zero value. ]*/
+                LogError("Unable to sign the SAS token.");
+                result = __FAILURE__;
+            }
+            else
+            {
+                char signature[SAS_TOKEN_SIGNATURE_MAX_LENGTH];
+                /*Codes_SRS_SASTOKEN_99_013: [ The hash shall be base64 encoded and then url encoded. ]*/
+                size_t signatureLength = encodeSignature(hash, signature);
+                size_t length = generator->headLength + signatureLength + SAS_TOKEN_FIELD_LENGTH(SAS_TOKEN_EXPIRY_FIELD) + expiryLength + generator->tailLength;
+
+                /*Codes_SRS_SASTOKEN_99_014: [ If tokenLength is not NULL, SASToken_Generate shall set it to the length of the token, not counting the null terminator. ]*/
+                if (tokenLength != NULL)
+                {
+                    *tokenLength = length;
+                }
+
+                if (length >= destinationSize)
+                {
+                    /*Codes_SRS_SASTOKEN_99_015: [ If destinationSize cannot hold the token and its null terminator then SASToken_Generate shall fail and return a non-zero value. ]*/
+                    LogError("The SAS token needs %lu bytes, the destination only has %lu.", (unsigned long)(length + 1), (unsigned long)destinationSize);
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    /*Codes_SRS_SASTOKEN_99_016: [ SASToken_Generate shall write the head of the token, the signature, "&se=", the expiry and the tail of the token to destination, followed by a null terminator. ]*/
+                    char* position = destination;
+                    (void)memcpy(position, generator->head, generator->headLength);
+                    position += generator->headLength;
+                    (void)memcpy(position, signature, signatureLength);
+                    position += signatureLength;
+                    (void)memcpy(position, SAS_TOKEN_EXPIRY_FIELD, SAS_TOKEN_FIELD_LENGTH(SAS_TOKEN_EXPIRY_FIELD));
+                    position += SAS_TOKEN_FIELD_LENGTH(SAS_TOKEN_EXPIRY_FIELD);
+                    (void)memcpy(position, tokenExpirationTime, expiryLength);
+                    position += expiryLength;
+                    (void)memcpy(position, generator->tail, generator->tailLength);
+                    position += generator->tailLength;
+                    *position = '\0';
+
+                    /*Codes_SRS_SASTOKEN_99_017: [ On success SASToken_Generate shall return 0. ]*/
+                    result = 0;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+void SASToken_DestroyGenerator(SAS_TOKEN_GENERATOR_HANDLE generator)
+{
+    /*Codes_SRS_SASTOKEN_99_018: [ If generator is NULL then SASToken_DestroyGenerator shall return. ]*/
+    if (generator != NULL)
+    {
+        /*Codes_SRS_SASTOKEN_99_019: [ SASToken_DestroyGenerator shall destroy the HMAC key and free the generator. ]*/
+        HMACSHA256_DestroyKey(generator->signingKey);
+        free(generator);
+    }
+}
@@ -40,6 +40,7 @@
 */
 
 #include <stdlib.h>
+#include <string.h>
 #include "azure_c_shared_utility/gballoc.h"
 
 #include "azure_c_shared_utility/sha.h"
@@ -75,10 +76,38 @@ static void SHA224_256Finalize(SHA256Context *context,
 static void SHA224_256PadMessage(SHA256Context *context,
     uint8_t Pad_Byte);
 static void SHA224_256ProcessMessageBlock(SHA256Context *context);
+static void SHA256BlocksPortable(uint32_t Intermediate_Hash[8],
+    const uint8_t *data, size_t blockCount);
+static void SHA256BlocksSelect(uint32_t Intermediate_Hash[8],
+    const uint8_t *data, size_t blockCount);
 static int SHA224_256Reset(SHA256Context *context, uint32_t *H0);
 static int SHA224_256ResultN(SHA256Context *context,
     uint8_t Message_Digest[], int HashSize);
 
+/* Constants defined in FIPS-180-2, section 4.2.2 */
+const uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b,
+    0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01,
+    0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7,
+    0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152,
+    0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+    0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819,
+    0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08,
+    0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f,
+    0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/*
+* The block function in use. It starts as SHA256BlocksSelect, which
+* picks the fastest implementation on the first block it is given.
+*/
+static SHA256BlocksFunction SHA256Blocks = SHA256BlocksSelect;
+static SHA256Implementation SHA256CurrentImplementation = sha256ImplAuto;
+
 /* Initial Hash Values: FIPS-180-2 Change Notice 1 */
 static uint32_t SHA224_H0[SHA256HashSize / 4] = {
     0xC1059ED8, 0x367CD507, 0x3070DD17, 0xF70E5939,
@@ -241,15 +270,37 @@ int SHA256Input(SHA256Context *context, const uint8_t *message_array,
     if (context->Corrupted)
         return context->Corrupted;
 
-    while (length-- && !context->Corrupted) {
-        context->Message_Block[context->Message_Block_Index++] =
-            (*message_array & 0xFF);
-
-        if (!SHA224_256AddLength(context, 8) &&
-            (context->Message_Block_Index == SHA256_Message_Block_Size))
-            SHA224_256ProcessMessageBlock(context);
-
-        message_array++;
+    while (length && !context->Corrupted) {
+        if ((context->Message_Block_Index == 0) &&
+            (length >= SHA256_Message_Block_Size)) {
+            /* whole blocks are hashed straight from the caller's buffer */
+            unsigned int blockCount;
+            for (blockCount = 0;
+                (blockCount < length / SHA256_Message_Block_Size) &&
+                !SHA224_256AddLength(context, 8 * SHA256_Message_Block_Size);
+                blockCount++)
+                ;
+            SHA256Blocks(context->Intermediate_Hash, message_array,
+                blockCount);
+            message_array += blockCount * SHA256_Message_Block_Size;
+            length -= blockCount * SHA256_Message_Block_Size;
+        } else {
+            unsigned int chunk = SHA256_Message_Block_Size -
+                context->Message_Block_Index;
+            if (chunk > length)
+                chunk = length;
+
+            (void)memcpy(&context->Message_Block[context->Message_Block_Index],
+                message_array, chunk);
+            context->Message_Block_Index += (int_least16_t)chunk;
+
+            if (!SHA224_256AddLength(context, 8 * chunk) &&
+                (context->Message_Block_Index == SHA256_Message_Block_Size))
+                SHA224_256ProcessMessageBlock(context);
+
+            message_array += chunk;
+            length -= chunk;
+        }
     }
 
     return shaSuccess;
@@ -441,80 +492,305 @@ static void SHA224_256PadMessage(SHA256Context *context,
 *
 * Returns:
 *   Nothing.
+*/
+static void SHA224_256ProcessMessageBlock(SHA256Context *context)
+{
+    SHA256Blocks(context->Intermediate_Hash, context->Message_Block, 1);
+    context->Message_Block_Index = 0;
+}
+
+/*
+* SHA256BlocksPortable
+*
+* Description:
+*   The RFC 6234 reference block function, it will process
+*   blockCount 512 bit blocks of data.
+*
+* Parameters:
+*   Intermediate_Hash: [in/out]
+*     The hash to update
+*   data: [in]
+*     The message blocks
+*   blockCount: [in]
+*     The number of blocks in data
+*
+* Returns:
+*   Nothing.
 *
 * Comments:
 *   Many of the variable names in this code, especially the
 *   single character names, were used because those were the
 *   names used in the publication.
 */
-static void SHA224_256ProcessMessageBlock(SHA256Context *context)
+static void SHA256BlocksPortable(uint32_t Intermediate_Hash[8],
+    const uint8_t *data, size_t blockCount)
 {
-    /* Constants defined in FIPS-180-2, section 4.2.2 */
-    static const uint32_t K[64] = {
-        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b,
-        0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01,
-        0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7,
-        0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
-        0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152,
-        0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
-        0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
-        0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
-        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819,
-        0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08,
-        0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f,
-        0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
-        0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
-    };
     int        t, t4;                   /* Loop counter */
     uint32_t   temp1, temp2;            /* Temporary word value */
     uint32_t   W[64];                   /* Word sequence */
     uint32_t   A, B, C, D, E, F, G, H;  /* Word buffers */
 
-    /*
-    * Initialize the first 16 words in the array W
-    */
-    for (t = t4 = 0; t < 16; t++, t4 += 4)
-        W[t] = (((uint32_t)context->Message_Block[t4]) << 24) |
-        (((uint32_t)context->Message_Block[t4 + 1]) << 16) |
-        (((uint32_t)context->Message_Block[t4 + 2]) << 8) |
-        (((uint32_t)context->Message_Block[t4 + 3]));
-
-    for (t = 16; t < 64; t++)
-        W[t] = SHA256_sigma1(W[t - 2]) + W[t - 7] +
-        SHA256_sigma0(W[t - 15]) + W[t - 16];
-
-    A = context->Intermediate_Hash[0];
-    B = context->Intermediate_Hash[1];
-    C = context->Intermediate_Hash[2];
-    D = context->Intermediate_Hash[3];
-    E = context->Intermediate_Hash[4];
-    F = context->Intermediate_Hash[5];
-    G = context->Intermediate_Hash[6];
-    H = context->Intermediate_Hash[7];
-
-    for (t = 0; t < 64; t++) {
-        temp1 = H + SHA256_SIGMA1(E) + SHA_Ch(E, F, G) + K[t] + W[t];
-        temp2 = SHA256_SIGMA0(A) + SHA_Maj(A, B, C);
-        H = G;
-        G = F;
-        F = E;
-        E = D + temp1;
-        D = C;
-        C = B;
-        B = A;
-        A = temp1 + temp2;
+    for (; blockCount > 0; blockCount--, data += SHA256_Message_Block_Size) {
+        /*
+        * Initialize the first 16 words in the array W
+        */
+        for (t = t4 = 0; t < 16; t++, t4 += 4)
+            W[t] = (((uint32_t)data[t4]) << 24) |
+            (((uint32_t)data[t4 + 1]) << 16) |
+            (((uint32_t)data[t4 + 2]) << 8) |
+            (((uint32_t)data[t4 + 3]));
+
+        for (t = 16; t < 64; t++)
+            W[t] = SHA256_sigma1(W[t - 2]) + W[t - 7] +
+            SHA256_sigma0(W[t - 15]) + W[t - 16];
+
+        A = Intermediate_Hash[0];
+        B = Intermediate_Hash[1];
+        C = Intermediate_Hash[2];
+        D = Intermediate_Hash[3];
+        E = Intermediate_Hash[4];
+        F = Intermediate_Hash[5];
+        G = Intermediate_Hash[6];
+        H = Intermediate_Hash[7];
+
+        for (t = 0; t < 64; t++) {
+            temp1 = H + SHA256_SIGMA1(E) + SHA_Ch(E, F, G) + SHA256_K[t] + W[t];
+            temp2 = SHA256_SIGMA0(A) + SHA_Maj(A, B, C);
+            H = G;
+            G = F;
+            F = E;
+            E = D + temp1;
+            D = C;
+            C = B;
+            B = A;
+            A = temp1 + temp2;
+        }
+
+        Intermediate_Hash[0] += A;
+        Intermediate_Hash[1] += B;
+        Intermediate_Hash[2] += C;
+        Intermediate_Hash[3] += D;
+        Intermediate_Hash[4] += E;
+        Intermediate_Hash[5] += F;
+        Intermediate_Hash[6] += G;
+        Intermediate_Hash[7] += H;
     }
+}
 
-    context->Intermediate_Hash[0] += A;
-    context->Intermediate_Hash[1] += B;
-    context->Intermediate_Hash[2] += C;
-    context->Intermediate_Hash[3] += D;
-    context->Intermediate_Hash[4] += E;
-    context->Intermediate_Hash[5] += F;
-    context->Intermediate_Hash[6] += G;
-    context->Intermediate_Hash[7] += H;
+/*
+* SHA256BlocksSelect
+*
+* Description:
+*   The initial block function, it selects the fastest
+*   implementation and hands the blocks over to it.
+*/
+static void SHA256BlocksSelect(uint32_t Intermediate_Hash[8],
+    const uint8_t *data, size_t blockCount)
+{
+    (void)SHA256SetImplementation(sha256ImplAuto);
+    SHA256Blocks(Intermediate_Hash, data, blockCount);
+}
 
-    context->Message_Block_Index = 0;
+/*
+* SHA256SetImplementation
+*
+* Description:
+*   This function selects the block implementation used by all the
+*   SHA-224 and SHA-256 contexts. sha256ImplAuto picks the SHA
+*   instructions when the CPU has them, then AVX2, then the
+*   portable code.
+*
+* Parameters:
+*   implementation: [in]
+*     The implementation to use.
+*
+* Returns:
+*   sha Error Code.
+*/
+int SHA256SetImplementation(SHA256Implementation implementation)
+{
+    SHA256BlocksFunction blocks = NULL;
+
+    switch (implementation) {
+    case sha256ImplAuto:
+        if ((blocks = SHA256AccelBlocks(sha256ImplX86SHA)) != NULL)
+            implementation = sha256ImplX86SHA;
+        else if ((blocks = SHA256AccelBlocks(sha256ImplARMv8SHA2)) != NULL)
+            implementation = sha256ImplARMv8SHA2;
+        else if (SHA256AccelHasBlocks8())
+            implementation = sha256ImplX86AVX2;
+        else
+            implementation = sha256ImplPortable;
+        break;
+    case sha256ImplPortable:
+        break;
+    case sha256ImplX86SHA:
+    case sha256ImplARMv8SHA2:
+        if ((blocks = SHA256AccelBlocks(implementation)) == NULL)
+            return shaBadParam;
+        break;
+    case sha256ImplX86AVX2:
+        if (!SHA256AccelHasBlocks8())
+            return shaBadParam;
+        break;
+    default:
+        return shaBadParam;
+    }
+
+    /* AVX2 only hashes 8 messages at once, single messages use the
+    * portable code */
+    SHA256Blocks = (blocks != NULL) ? blocks : SHA256BlocksPortable;
+    SHA256CurrentImplementation = implementation;
+    return shaSuccess;
+}
+
+/*
+* SHA256GetImplementation
+*
+* Description:
+*   This function returns the block implementation in use,
+*   selecting it first if no block has been hashed yet.
+*/
+SHA256Implementation SHA256GetImplementation(void)
+{
+    if (SHA256CurrentImplementation == sha256ImplAuto)
+        (void)SHA256SetImplementation(sha256ImplAuto);
+    return SHA256CurrentImplementation;
+}
+
+/*
+* SHA256PadLane
+*
+* Description:
+*   This helper function writes the blocks that finish a message
+*   of length octets whose whole blocks are hashed in place: the
+*   trailing octets, the padding and the length.
+*
+* Returns:
+*   The number of blocks written to tail, 1 or 2.
+*/
+static size_t SHA256PadLane(const uint8_t *message, unsigned int length,
+    uint8_t tail[2 * SHA256_Message_Block_Size])
+{
+    size_t rest = length % SHA256_Message_Block_Size;
+    size_t tailSize = (rest < SHA256_Message_Block_Size - 8) ?
+        SHA256_Message_Block_Size : 2 * SHA256_Message_Block_Size;
+    uint64_t bits = (uint64_t)length * 8;
+    int i;
+
+    if (rest > 0)
+        (void)memcpy(tail, message + (length - rest), rest);
+    tail[rest] = 0x80;
+    (void)memset(tail + rest + 1, 0, tailSize - rest - 1);
+    for (i = 0; i < 8; i++)
+        tail[tailSize - 1 - i] = (uint8_t)(bits >> (8 * i));
+
+    return tailSize / SHA256_Message_Block_Size;
+}
+
+/*
+* SHA256HashMany
+*
+* Description:
+*   This function computes the digests of count independent
+*   messages, 8 at a time with sha256ImplX86AVX2.
+*
+* Parameters:
+*   messages: [in]
+*     The messages.
+*   lengths: [in]
+*     The length of each message in octets.
+*   count: [in]
+*     The number of messages.
+*   digests: [out]
+*     Where the digest of each message is returned.
+*
+* Returns:
+*   sha Error Code.
+*/
+int SHA256HashMany(const uint8_t *const messages[],
+    const unsigned int lengths[], unsigned int count,
+    uint8_t digests[][SHA256HashSize])
+{
+    static const uint8_t idleBlock[SHA256_Message_Block_Size] = { 0 };
+    unsigned int first;
+    unsigned int i;
+
+    if (count == 0)
+        return shaSuccess;
+
+    if (!messages || !lengths || !digests)
+        return shaNull;
+
+    for (i = 0; i < count; i++)
+        if (!messages[i] && lengths[i])
+            return shaNull;
+
+    if (SHA256GetImplementation() != sha256ImplX86AVX2) {
+        for (i = 0; i < count; i++) {
+            SHA256Context context;
+            int err = SHA256Reset(&context);
+            if (err == shaSuccess && lengths[i] > 0)
+                err = SHA256Input(&context, messages[i], lengths[i]);
+            if (err == shaSuccess)
+                err = SHA256Result(&context, digests[i]);
+            if (err != shaSuccess)
+                return err;
+        }
+        return shaSuccess;
+    }
+
+    for (first = 0; first < count; first += 8) {
+        uint32_t hash[8][8];
+        uint8_t tail[8][2 * SHA256_Message_Block_Size];
+        const uint8_t *blocks[8];
+        size_t wholeBlocks[8];
+        size_t totalBlocks[8];
+        size_t maxBlocks = 0;
+        size_t block;
+        unsigned int lanes = (count - first < 8) ? count - first : 8;
+        unsigned int lane;
+
+        for (lane = 0; lane < 8; lane++) {
+            (void)memcpy(hash[lane], SHA256_H0, sizeof(hash[lane]));
+            if (lane < lanes) {
+                wholeBlocks[lane] = lengths[first + lane] / SHA256_Message_Block_Size;
+                totalBlocks[lane] = wholeBlocks[lane] +
+                    SHA256PadLane(messages[first + lane], lengths[first + lane], tail[lane]);
+                if (totalBlocks[lane] > maxBlocks)
+                    maxBlocks = totalBlocks[lane];
+            } else {
+                wholeBlocks[lane] = 0;
+                totalBlocks[lane] = 0;
+            }
+        }
+
+        for (block = 0; block < maxBlocks; block++) {
+            for (lane = 0; lane < 8; lane++) {
+                if (block < wholeBlocks[lane])
+                    blocks[lane] = messages[first + lane] + block * SHA256_Message_Block_Size;
+                else if (block < totalBlocks[lane])
+                    blocks[lane] = tail[lane] + (block - wholeBlocks[lane]) * SHA256_Message_Block_Size;
+                else
+                    blocks[lane] = idleBlock;
+            }
+
+            SHA256AccelBlocks8(hash, blocks);
+
+            /* a lane is read out after its last block, later blocks
+            * only churn a hash nobody looks at */
+            for (lane = 0; lane < lanes; lane++) {
+                if (block + 1 == totalBlocks[lane]) {
+                    int j;
+                    for (j = 0; j < SHA256HashSize; ++j)
+                        digests[first + lane][j] = (uint8_t)
+                        (hash[lane][j >> 2] >> 8 * (3 - (j & 0x03)));
+                }
+            }
+        }
+    }
+
+    return shaSuccess;
 }
 
 /*
@@ -0,0 +1,417 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/*
+* Hardware SHA-256 block functions and their run time detection.
+*
+* The kernels are compiled with per function target attributes (or,
+* with MSVC, without any flag at all), so the library still runs on
+* CPUs without the instructions: SHA256AccelBlocks only hands out a
+* kernel after CPUID / HWCAP says the CPU has it.
+*
+* Define NO_SHA256_ACCELERATION to build the portable code only.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include "azure_c_shared_utility/sha.h"
+#include "azure_c_shared_utility/sha-private.h"
+
+#if !defined(NO_SHA256_ACCELERATION)
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)))))
+#define SHA256_ACCEL_X86
+#define SHA256_TARGET_SHA __attribute__((target("sha,sse4.1,ssse3")))
+#define SHA256_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#include <cpuid.h>
+#elif (defined(_M_X64) || defined(_M_IX86)) && defined(_MSC_VER) && (_MSC_VER >= 1900)
+#define SHA256_ACCEL_X86
+#define SHA256_TARGET_SHA
+#define SHA256_TARGET_AVX2
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+#if defined(__aarch64__) && (defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO))
+/* the whole build targets a CPU with the SHA2 instructions */
+#define SHA256_ACCEL_ARM
+#define SHA256_TARGET_ARM
+#include <arm_neon.h>
+#elif defined(__aarch64__) && defined(__linux__) && defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 8)
+#define SHA256_ACCEL_ARM
+#define SHA256_ACCEL_ARM_HWCAP
+#define SHA256_TARGET_ARM __attribute__((target("+crypto")))
+#include <arm_neon.h>
+#include <sys/auxv.h>
+#ifndef HWCAP_SHA2
+#define HWCAP_SHA2 (1 << 6)
+#endif
+#endif
+
+#endif /* NO_SHA256_ACCELERATION */
+
+#ifdef SHA256_ACCEL_X86
+
+/*
+* CPUID leaf 1 ECX: bit 19 SSE4.1, bit 27 OSXSAVE, bit 9 SSSE3.
+* CPUID leaf 7 EBX: bit 5 AVX2, bit 29 SHA.
+*/
+static void SHA256Cpuid(unsigned int leaf, unsigned int regs[4])
+{
+#ifdef _MSC_VER
+    int r[4];
+    __cpuidex(r, (int)leaf, 0);
+    regs[0] = (unsigned int)r[0];
+    regs[1] = (unsigned int)r[1];
+    regs[2] = (unsigned int)r[2];
+    regs[3] = (unsigned int)r[3];
+#else
+    if (__get_cpuid_max(0, NULL) < leaf) {
+        regs[0] = regs[1] = regs[2] = regs[3] = 0;
+    } else {
+        __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+    }
+#endif
+}
+
+/* whether the OS saves the YMM registers, which AVX2 needs */
+static int SHA256OSSavesYMM(unsigned int leaf1Ecx)
+{
+    uint64_t xcr0;
+    if (!(leaf1Ecx & (1u << 27)))
+        return 0;
+#ifdef _MSC_VER
+    xcr0 = _xgetbv(0);
+#else
+    {
+        uint32_t eax, edx;
+        __asm__ __volatile__(".byte 0x0f, 0x01, 0xd0" : "=a"(eax), "=d"(edx) : "c"(0));
+        xcr0 = ((uint64_t)edx << 32) | eax;
+    }
+#endif
+    return (xcr0 & 0x6) == 0x6;
+}
+
+static int SHA256HasX86SHA(void)
+{
+    unsigned int leaf1[4];
+    unsigned int leaf7[4];
+    SHA256Cpuid(1, leaf1);
+    SHA256Cpuid(7, leaf7);
+    return ((leaf1[2] & (1u << 19)) != 0) &&
+        ((leaf1[2] & (1u << 9)) != 0) &&
+        ((leaf7[1] & (1u << 29)) != 0);
+}
+
+static int SHA256HasX86AVX2(void)
+{
+    unsigned int leaf1[4];
+    unsigned int leaf7[4];
+    SHA256Cpuid(1, leaf1);
+    SHA256Cpuid(7, leaf7);
+    return ((leaf7[1] & (1u << 5)) != 0) && SHA256OSSavesYMM(leaf1[2]);
+}
+
+/*
+* SHA256BlocksX86SHA
+*
+* The SHA extensions keep the state as ABEF and CDGH and do two
+* rounds per sha256rnds2, the message schedule is done 4 words at a
+* time by sha256msg1 / sha256msg2. The rounds are unrolled by hand,
+* compilers do not unroll the loop form at -O2 and it runs at half
+* the speed.
+*/
+#define SHA256_X86_ROUNDS(g, msg)                                                       \
+    wk = _mm_add_epi32((msg), _mm_loadu_si128((const __m128i*)&SHA256_K[4 * (g)]));    \
+    state1 = _mm_sha256rnds2_epu32(state1, state0, wk);                                 \
+    state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(wk, 0x0E))
+
+/* next += sigma1 part of W[t-2] and W[t-7], needs sigma0 already in next */
+#define SHA256_X86_SCHEDULE2(msg, prev, next) \
+    next = _mm_sha256msg2_epu32(_mm_add_epi32((next), _mm_alignr_epi8((msg), (prev), 4)), (msg))
+
+/* prev += sigma0 part */
+#define SHA256_X86_SCHEDULE1(prev, msg) \
+    prev = _mm_sha256msg1_epu32((prev), (msg))
+
+#define SHA256_X86_QUAD(g)                                                              \
+    SHA256_X86_ROUNDS((g), msg0); SHA256_X86_SCHEDULE2(msg0, msg3, msg1); SHA256_X86_SCHEDULE1(msg3, msg0); \
+    SHA256_X86_ROUNDS((g) + 1, msg1); SHA256_X86_SCHEDULE2(msg1, msg0, msg2); SHA256_X86_SCHEDULE1(msg0, msg1); \
+    SHA256_X86_ROUNDS((g) + 2, msg2); SHA256_X86_SCHEDULE2(msg2, msg1, msg3); SHA256_X86_SCHEDULE1(msg1, msg2); \
+    SHA256_X86_ROUNDS((g) + 3, msg3); SHA256_X86_SCHEDULE2(msg3, msg2, msg0); SHA256_X86_SCHEDULE1(msg2, msg3)
+
+SHA256_TARGET_SHA
+static void SHA256BlocksX86SHA(uint32_t Intermediate_Hash[8],
+    const uint8_t *data, size_t blockCount)
+{
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bLL, 0x0405060700010203LL);
+    __m128i state0, state1, tmp, wk, abefSave, cdghSave;
+    __m128i msg0, msg1, msg2, msg3;
+
+    tmp = _mm_loadu_si128((const __m128i*)&Intermediate_Hash[0]);
+    state1 = _mm_loadu_si128((const __m128i*)&Intermediate_Hash[4]);
+    tmp = _mm_shuffle_epi32(tmp, 0xB1);             /* CDAB */
+    state1 = _mm_shuffle_epi32(state1, 0x1B);       /* EFGH */
+    state0 = _mm_alignr_epi8(tmp, state1, 8);       /* ABEF */
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);    /* CDGH */
+
+    for (; blockCount > 0; blockCount--, data += SHA256_Message_Block_Size) {
+        abefSave = state0;
+        cdghSave = state1;
+
+        msg0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 0)), byteSwap);
+        msg1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16)), byteSwap);
+        msg2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 32)), byteSwap);
+        msg3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 48)), byteSwap);
+
+        /* msgN holds the next 4 words of W[] whose index is N modulo 4 */
+        SHA256_X86_ROUNDS(0, msg0);
+        SHA256_X86_ROUNDS(1, msg1); SHA256_X86_SCHEDULE1(msg0, msg1);
+        SHA256_X86_ROUNDS(2, msg2); SHA256_X86_SCHEDULE1(msg1, msg2);
+        SHA256_X86_ROUNDS(3, msg3); SHA256_X86_SCHEDULE2(msg3, msg2, msg0); SHA256_X86_SCHEDULE1(msg2, msg3);
+        SHA256_X86_QUAD(4);
+        SHA256_X86_QUAD(8);
+        SHA256_X86_ROUNDS(12, msg0); SHA256_X86_SCHEDULE2(msg0, msg3, msg1); SHA256_X86_SCHEDULE1(msg3, msg0);
+        SHA256_X86_ROUNDS(13, msg1); SHA256_X86_SCHEDULE2(msg1, msg0, msg2);
+        SHA256_X86_ROUNDS(14, msg2); SHA256_X86_SCHEDULE2(msg2, msg1, msg3);
+        SHA256_X86_ROUNDS(15, msg3);
+
+        state0 = _mm_add_epi32(state0, abefSave);
+        state1 = _mm_add_epi32(state1, cdghSave);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);          /* FEBA */
+    state1 = _mm_shuffle_epi32(state1, 0xB1);       /* DCHG */
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);    /* DCBA */
+    state1 = _mm_alignr_epi8(state1, tmp, 8);       /* HGFE */
+
+    _mm_storeu_si128((__m128i*)&Intermediate_Hash[0], state0);
+    _mm_storeu_si128((__m128i*)&Intermediate_Hash[4], state1);
+}
+
+/*
+* AVX2 multi buffer: every 32 bit lane of a ymm register belongs to
+* a different message, so the scalar rounds are run on 8 hashes at
+* once. Rows are transposed in and out of that layout with 8x8
+* transposes.
+*/
+#define SHA256_AVX2_ROTR(x, n) _mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+
+SHA256_TARGET_AVX2
+static void SHA256Transpose8(__m256i r[8])
+{
+    __m256i t[8];
+    __m256i u[8];
+
+    t[0] = _mm256_unpacklo_epi32(r[0], r[1]);
+    t[1] = _mm256_unpackhi_epi32(r[0], r[1]);
+    t[2] = _mm256_unpacklo_epi32(r[2], r[3]);
+    t[3] = _mm256_unpackhi_epi32(r[2], r[3]);
+    t[4] = _mm256_unpacklo_epi32(r[4], r[5]);
+    t[5] = _mm256_unpackhi_epi32(r[4], r[5]);
+    t[6] = _mm256_unpacklo_epi32(r[6], r[7]);
+    t[7] = _mm256_unpackhi_epi32(r[6], r[7]);
+
+    u[0] = _mm256_unpacklo_epi64(t[0], t[2]);
+    u[1] = _mm256_unpackhi_epi64(t[0], t[2]);
+    u[2] = _mm256_unpacklo_epi64(t[1], t[3]);
+    u[3] = _mm256_unpackhi_epi64(t[1], t[3]);
+    u[4] = _mm256_unpacklo_epi64(t[4], t[6]);
+    u[5] = _mm256_unpackhi_epi64(t[4], t[6]);
+    u[6] = _mm256_unpacklo_epi64(t[5], t[7]);
+    u[7] = _mm256_unpackhi_epi64(t[5], t[7]);
+
+    r[0] = _mm256_permute2x128_si256(u[0], u[4], 0x20);
+    r[1] = _mm256_permute2x128_si256(u[1], u[5], 0x20);
+    r[2] = _mm256_permute2x128_si256(u[2], u[6], 0x20);
+    r[3] = _mm256_permute2x128_si256(u[3], u[7], 0x20);
+    r[4] = _mm256_permute2x128_si256(u[0], u[4], 0x31);
+    r[5] = _mm256_permute2x128_si256(u[1], u[5], 0x31);
+    r[6] = _mm256_permute2x128_si256(u[2], u[6], 0x31);
+    r[7] = _mm256_permute2x128_si256(u[3], u[7], 0x31);
+}
+
+SHA256_TARGET_AVX2
+static void SHA256BlocksX86AVX2x8(uint32_t Intermediate_Hash[8][8],
+    const uint8_t *const blocks[8])
+{
+    const __m256i byteSwap = _mm256_set_epi8(
+        12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+        12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+    __m256i W[64];
+    __m256i s[8];
+    __m256i A, B, C, D, E, F, G, H;
+    int t;
+
+    /* W[0..7] are the first 32 octets of each block, W[8..15] the rest */
+    for (t = 0; t < 8; t++) {
+        W[t] = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)blocks[t]), byteSwap);
+        W[8 + t] = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(blocks[t] + 32)), byteSwap);
+    }
+    SHA256Transpose8(&W[0]);
+    SHA256Transpose8(&W[8]);
+
+    for (t = 16; t < 64; t++) {
+        __m256i w15 = W[t - 15];
+        __m256i w2 = W[t - 2];
+        __m256i sigma0 = _mm256_xor_si256(_mm256_xor_si256(SHA256_AVX2_ROTR(w15, 7), SHA256_AVX2_ROTR(w15, 18)), _mm256_srli_epi32(w15, 3));
+        __m256i sigma1 = _mm256_xor_si256(_mm256_xor_si256(SHA256_AVX2_ROTR(w2, 17), SHA256_AVX2_ROTR(w2, 19)), _mm256_srli_epi32(w2, 10));
+        W[t] = _mm256_add_epi32(_mm256_add_epi32(sigma1, W[t - 7]), _mm256_add_epi32(sigma0, W[t - 16]));
+    }
+
+    for (t = 0; t < 8; t++)
+        s[t] = _mm256_loadu_si256((const __m256i*)Intermediate_Hash[t]);
+    SHA256Transpose8(s);
+
+    A = s[0]; B = s[1]; C = s[2]; D = s[3];
+    E = s[4]; F = s[5]; G = s[6]; H = s[7];
+
+    for (t = 0; t < 64; t++) {
+        __m256i SIGMA1 = _mm256_xor_si256(_mm256_xor_si256(SHA256_AVX2_ROTR(E, 6), SHA256_AVX2_ROTR(E, 11)), SHA256_AVX2_ROTR(E, 25));
+        __m256i ch = _mm256_xor_si256(_mm256_and_si256(E, F), _mm256_andnot_si256(E, G));
+        __m256i SIGMA0 = _mm256_xor_si256(_mm256_xor_si256(SHA256_AVX2_ROTR(A, 2), SHA256_AVX2_ROTR(A, 13)), SHA256_AVX2_ROTR(A, 22));
+        __m256i maj = _mm256_xor_si256(_mm256_and_si256(A, _mm256_xor_si256(B, C)), _mm256_and_si256(B, C));
+        __m256i temp1 = _mm256_add_epi32(_mm256_add_epi32(H, SIGMA1),
+            _mm256_add_epi32(_mm256_add_epi32(ch, _mm256_set1_epi32((int)SHA256_K[t])), W[t]));
+        __m256i temp2 = _mm256_add_epi32(SIGMA0, maj);
+        H = G;
+        G = F;
+        F = E;
+        E = _mm256_add_epi32(D, temp1);
+        D = C;
+        C = B;
+        B = A;
+        A = _mm256_add_epi32(temp1, temp2);
+    }
+
+    s[0] = _mm256_add_epi32(s[0], A);
+    s[1] = _mm256_add_epi32(s[1], B);
+    s[2] = _mm256_add_epi32(s[2], C);
+    s[3] = _mm256_add_epi32(s[3], D);
+    s[4] = _mm256_add_epi32(s[4], E);
+    s[5] = _mm256_add_epi32(s[5], F);
+    s[6] = _mm256_add_epi32(s[6], G);
+    s[7] = _mm256_add_epi32(s[7], H);
+
+    SHA256Transpose8(s);
+    for (t = 0; t < 8; t++)
+        _mm256_storeu_si256((__m256i*)Intermediate_Hash[t], s[t]);
+}
+
+#endif /* SHA256_ACCEL_X86 */
+
+#ifdef SHA256_ACCEL_ARM
+
+static int SHA256HasARMv8SHA2(void)
+{
+#ifdef SHA256_ACCEL_ARM_HWCAP
+    return (getauxval(AT_HWCAP) & HWCAP_SHA2) != 0;
+#else
+    return 1;
+#endif
+}
+
+/*
+* SHA256BlocksARMv8SHA2
+*
+* sha256h / sha256h2 do 4 rounds on the ABCD and EFGH halves,
+* sha256su0 / sha256su1 extend the message schedule 4 words at a
+* time. Unrolled by hand like the x86 one.
+*/
+#define SHA256_ARM_ROUNDS(g, msg)                                   \
+    wk = vaddq_u32((msg), vld1q_u32(&SHA256_K[4 * (g)]));          \
+    abcd = state0;                                                  \
+    state0 = vsha256hq_u32(state0, state1, wk);                     \
+    state1 = vsha256h2q_u32(state1, abcd, wk)
+
+#define SHA256_ARM_SCHEDULE(msg, next1, next2, next3) \
+    msg = vsha256su1q_u32(vsha256su0q_u32((msg), (next1)), (next2), (next3))
+
+#define SHA256_ARM_QUAD(g)                                                                   \
+    SHA256_ARM_ROUNDS((g), msg0); SHA256_ARM_SCHEDULE(msg0, msg1, msg2, msg3);              \
+    SHA256_ARM_ROUNDS((g) + 1, msg1); SHA256_ARM_SCHEDULE(msg1, msg2, msg3, msg0);          \
+    SHA256_ARM_ROUNDS((g) + 2, msg2); SHA256_ARM_SCHEDULE(msg2, msg3, msg0, msg1);          \
+    SHA256_ARM_ROUNDS((g) + 3, msg3); SHA256_ARM_SCHEDULE(msg3, msg0, msg1, msg2)
+
+SHA256_TARGET_ARM
+static void SHA256BlocksARMv8SHA2(uint32_t Intermediate_Hash[8],
+    const uint8_t *data, size_t blockCount)
+{
+    uint32x4_t state0 = vld1q_u32(&Intermediate_Hash[0]);
+    uint32x4_t state1 = vld1q_u32(&Intermediate_Hash[4]);
+    uint32x4_t abcdSave, efghSave, abcd, wk;
+    uint32x4_t msg0, msg1, msg2, msg3;
+
+    for (; blockCount > 0; blockCount--, data += SHA256_Message_Block_Size) {
+        abcdSave = state0;
+        efghSave = state1;
+
+        msg0 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 0)));
+        msg1 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 16)));
+        msg2 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 32)));
+        msg3 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 48)));
+
+        /* wk is taken before msgN moves on to the words 16 further */
+        SHA256_ARM_QUAD(0);
+        SHA256_ARM_QUAD(4);
+        SHA256_ARM_QUAD(8);
+        SHA256_ARM_ROUNDS(12, msg0);
+        SHA256_ARM_ROUNDS(13, msg1);
+        SHA256_ARM_ROUNDS(14, msg2);
+        SHA256_ARM_ROUNDS(15, msg3);
+
+        state0 = vaddq_u32(state0, abcdSave);
+        state1 = vaddq_u32(state1, efghSave);
+    }
+
+    vst1q_u32(&Intermediate_Hash[0], state0);
+    vst1q_u32(&Intermediate_Hash[4], state1);
+}
+
+#endif /* SHA256_ACCEL_ARM */
+
+SHA256BlocksFunction SHA256AccelBlocks(SHA256Implementation implementation)
+{
+    SHA256BlocksFunction result = NULL;
+
+    switch (implementation) {
+#ifdef SHA256_ACCEL_X86
+    case sha256ImplX86SHA:
+        if (SHA256HasX86SHA())
+            result = SHA256BlocksX86SHA;
+        break;
+#endif
+#ifdef SHA256_ACCEL_ARM
+    case sha256ImplARMv8SHA2:
+        if (SHA256HasARMv8SHA2())
+            result = SHA256BlocksARMv8SHA2;
+        break;
+#endif
+    default:
+        break;
+    }
+
+    return result;
+}
+
+int SHA256AccelHasBlocks8(void)
+{
+#ifdef SHA256_ACCEL_X86
+    return SHA256HasX86AVX2();
+#else
+    return 0;
+#endif
+}
+
+void SHA256AccelBlocks8(uint32_t Intermediate_Hash[8][8],
+    const uint8_t *const blocks[8])
+{
+#ifdef SHA256_ACCEL_X86
+    SHA256BlocksX86AVX2x8(Intermediate_Hash, blocks);
+#else
+    (void)Intermediate_Hash;
+    (void)blocks;
+#endif
+}
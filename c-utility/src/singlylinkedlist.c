@@ -7,29 +7,80 @@
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/xlogging.h"
 
-typedef struct LIST_ITEM_INSTANCE_TAG
-{
-    const void* item;
-    void* next;
-} LIST_ITEM_INSTANCE;
+typedef SINGLYLINKEDLIST_NODE LIST_ITEM_INSTANCE;
 
 typedef struct SINGLYLINKEDLIST_INSTANCE_TAG
 {
     LIST_ITEM_INSTANCE* head;
     LIST_ITEM_INSTANCE* tail;
+    /* nodes singlylinkedlist_add allocated that were removed, chained through next and reused before allocating */
+    LIST_ITEM_INSTANCE* free_nodes;
+    size_t free_node_count;
+    size_t max_free_nodes;
 } LIST_INSTANCE;
 
+static void release_node(LIST_INSTANCE* list_instance, LIST_ITEM_INSTANCE* node)
+{
+    if (!node->owned_by_list)
+    {
+        /* Codes_SRS_LIST_99_006: [Removing a node added with singlylinkedlist_add_node shall only unlink it.] */
+        node->next = NULL;
+    }
+    else if (list_instance->free_node_count < list_instance->max_free_nodes)
+    {
+        /* Codes_SRS_LIST_99_002: [When a node allocated by singlylinkedlist_add is removed and fewer than max_free_nodes nodes are kept, the list shall keep it instead of freeing it.] */
+        node->item = NULL;
+        node->next = list_instance->free_nodes;
+        list_instance->free_nodes = node;
+        list_instance->free_node_count++;
+    }
+    else
+    {
+        free(node);
+    }
+}
+
+static void link_tail(LIST_INSTANCE* list_instance, LIST_ITEM_INSTANCE* node, const void* item)
+{
+    node->next = NULL;
+    node->item = item;
+
+    if (list_instance->head == NULL)
+    {
+        list_instance->head = node;
+        list_instance->tail = node;
+    }
+    else
+    {
+        list_instance->tail->next = node;
+        list_instance->tail = node;
+    }
+}
+
 SINGLYLINKEDLIST_HANDLE singlylinkedlist_create(void)
+{
+    /* Codes_SRS_LIST_01_001: [singlylinkedlist_create shall create a new list and return a non-NULL handle on success.] */
+    /* Codes_SRS_LIST_01_002: [If any error occurs during the list creation, singlylinkedlist_create shall return NULL.] */
+    return singlylinkedlist_create_with_node_pool(0);
+}
+
+SINGLYLINKEDLIST_HANDLE singlylinkedlist_create_with_node_pool(size_t max_free_nodes)
 {
     LIST_INSTANCE* result;
 
-    /* Codes_SRS_LIST_01_001: [singlylinkedlist_create shall create a new list and return a non-NULL handle on success.] */
+    /* Codes_SRS_LIST_99_001: [singlylinkedlist_create_with_node_pool shall create a new list like singlylinkedlist_create that keeps up to max_free_nodes removed nodes for reuse.] */
     result = (LIST_INSTANCE*)malloc(sizeof(LIST_INSTANCE));
-    if (result != NULL)
+    if (result == NULL)
+    {
+        LogError("Failed allocating list");
+    }
+    else
     {
-        /* Codes_SRS_LIST_01_002: [If any error occurs during the list creation, singlylinkedlist_create shall return NULL.] */
         result->head = NULL;
         result->tail = NULL;
+        result->free_nodes = NULL;
+        result->free_node_count = 0;
+        result->max_free_nodes = max_free_nodes;
     }
 
     return result;
@@ -46,7 +97,23 @@ void singlylinkedlist_destroy(SINGLYLINKEDLIST_HANDLE list)
         {
             LIST_ITEM_INSTANCE* current_item = list_instance->head;
             list_instance->head = (LIST_ITEM_INSTANCE*)current_item->next;
-            free(current_item);
+            if (current_item->owned_by_list)
+            {
+                free(current_item);
+            }
+            else
+            {
+                /* Codes_SRS_LIST_99_006: [Removing a node added with singlylinkedlist_add_node shall only unlink it.] */
+                current_item->next = NULL;
+            }
+        }
+
+        /* Codes_SRS_LIST_99_003: [singlylinkedlist_destroy shall free the nodes kept for reuse.] */
+        while (list_instance->free_nodes != NULL)
+        {
+            LIST_ITEM_INSTANCE* free_node = list_instance->free_nodes;
+            list_instance->free_nodes = free_node->next;
+            free(free_node);
         }
 
         /* Codes_SRS_LIST_01_003: [singlylinkedlist_destroy shall free all resources associated with the list identified by the handle argument.] */
@@ -68,7 +135,18 @@ LIST_ITEM_HANDLE singlylinkedlist_add(SINGLYLINKEDLIST_HANDLE list, const void*
     else
     {
         LIST_INSTANCE* list_instance = (LIST_INSTANCE*)list;
-        result = (LIST_ITEM_INSTANCE*)malloc(sizeof(LIST_ITEM_INSTANCE));
+
+        if (list_instance->free_nodes != NULL)
+        {
+            /* Codes_SRS_LIST_99_004: [singlylinkedlist_add shall reuse a kept node, if any, instead of allocating one.] */
+            result = list_instance->free_nodes;
+            list_instance->free_nodes = result->next;
+            list_instance->free_node_count--;
+        }
+        else
+        {
+            result = (LIST_ITEM_INSTANCE*)malloc(sizeof(LIST_ITEM_INSTANCE));
+        }
 
         if (result == NULL)
         {
@@ -78,25 +156,37 @@ LIST_ITEM_HANDLE singlylinkedlist_add(SINGLYLINKEDLIST_HANDLE list, const void*
         else
         {
             /* Codes_SRS_LIST_01_005: [singlylinkedlist_add shall add one item to the tail of the list and on success it shall return a handle to the added item.] */
-            result->next = NULL;
-            result->item = item;
-
-            if (list_instance->head == NULL)
-            {
-                list_instance->head = result;
-                list_instance->tail = result;
-            }
-            else
-            {
-                list_instance->tail->next = result;
-                list_instance->tail = result;
-            }
+            result->owned_by_list = true;
+            link_tail(list_instance, result, item);
         }
     }
 
     return result;
 }
 
+LIST_ITEM_HANDLE singlylinkedlist_add_node(SINGLYLINKEDLIST_HANDLE list, SINGLYLINKEDLIST_NODE* node, const void* item)
+{
+    LIST_ITEM_INSTANCE* result;
+
+    /* Codes_SRS_LIST_99_005: [If any of the arguments is NULL, singlylinkedlist_add_node shall not add the item to the list and return NULL.] */
+    if ((list == NULL) ||
+        (node == NULL) ||
+        (item == NULL))
+    {
+        LogError("Invalid argument (list=%p, node=%p, item=%p)", list, node, item);
+        result = NULL;
+    }
+    else
+    {
+        /* Codes_SRS_LIST_99_007: [singlylinkedlist_add_node shall add item to the tail of the list using node as its list node, without allocating, and return node.] */
+        node->owned_by_list = false;
+        link_tail((LIST_INSTANCE*)list, node, item);
+        result = node;
+    }
+
+    return result;
+}
+
 int singlylinkedlist_remove(SINGLYLINKEDLIST_HANDLE list, LIST_ITEM_HANDLE item)
 {
     int result;
@@ -132,7 +222,7 @@ int singlylinkedlist_remove(SINGLYLINKEDLIST_HANDLE list, LIST_ITEM_HANDLE item)
                     list_instance->tail = previous_item;
                 }
 
-                free(current_item);
+                release_node(list_instance, current_item);
 
                 break;
             }
@@ -303,7 +393,7 @@ int singlylinkedlist_remove_if(SINGLYLINKEDLIST_HANDLE list, LIST_CONDITION_FUNC
                     list_instance->tail = previous_item;
                 }
 
-                free(current_item);
+                release_node(list_instance, current_item);
             }
             /* Codes_SRS_LIST_09_005: [ If the condition function returns false, singlylinkedlist_find shall consider that item as not to be removed. ] */
             else
@@ -0,0 +1,679 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#define _DEFAULT_SOURCE
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/threadpool.h"
+#include "azure_c_shared_utility/threadapi.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/condition.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+/*the workers share one lock: it guards the bounded ring of queued works and the min-heap of delayed
+works. A worker with nothing to do waits on work_available, for as long as the earliest delayed work
+is not due. Whoever adds work posts the condition only when a worker is idle.*/
+
+#if defined(_MSC_VER)
+#include "windows.h"
+
+static uint64_t get_monotonic_ms(void)
+{
+    return (uint64_t)GetTickCount64();
+}
+
+#else
+#include <unistd.h>
+
+static uint64_t get_monotonic_ms(void)
+{
+    uint64_t result;
+#if defined(_POSIX_MONOTONIC_CLOCK) && (_POSIX_MONOTONIC_CLOCK >= 0)
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+    {
+        result = ((uint64_t)ts.tv_sec * 1000) + ((uint64_t)ts.tv_nsec / 1000000);
+    }
+    else
+#endif
+    {
+        result = (uint64_t)time(NULL) * 1000;
+    }
+    return result;
+}
+
+#endif
+
+#define NANOSECONDS_IN_1_MS ((uint64_t)1000000)
+
+/*initial number of delayed works the heap has room for, it doubles when full*/
+#define DELAYED_WORK_INITIAL_CAPACITY 8
+
+DEFINE_ENUM_STRINGS(THREADPOOL_RESULT, THREADPOOL_RESULT_VALUES);
+DEFINE_ENUM_STRINGS(THREADPOOL_WORK_STATUS, THREADPOOL_WORK_STATUS_VALUES);
+
+typedef struct WORK_ITEM_TAG
+{
+    THREADPOOL_WORK_FUNCTION work;
+    void* work_context;
+    ON_THREADPOOL_WORK_COMPLETE on_complete;
+    void* complete_context;
+} WORK_ITEM;
+
+typedef struct DELAYED_WORK_ITEM_TAG
+{
+    uint64_t due_ms;
+    /*delayed works due at the same millisecond run in the order they were scheduled*/
+    uint64_t sequence;
+    WORK_ITEM item;
+} DELAYED_WORK_ITEM;
+
+typedef struct THREADPOOL_TAG
+{
+    LOCK_HANDLE lock;
+    COND_HANDLE work_available;
+    THREAD_HANDLE* workers;
+    size_t worker_count;
+    size_t idle_workers;
+    int stopping;
+
+    WORK_ITEM* queue;
+    size_t queue_capacity;
+    size_t queue_head;
+    size_t queue_count;
+
+    DELAYED_WORK_ITEM* delayed;
+    size_t delayed_capacity;
+    size_t delayed_count;
+    uint64_t delayed_sequence;
+} THREADPOOL;
+
+typedef struct THREADPOOL_FUTURE_TAG
+{
+    LOCK_HANDLE lock;
+    COND_HANDLE done_condition;
+    /*one reference for the caller, one for the pool until the work ran*/
+    int references;
+    int done;
+    int work_result;
+} THREADPOOL_FUTURE;
+
+static int delayed_work_is_before(const DELAYED_WORK_ITEM* left, const DELAYED_WORK_ITEM* right)
+{
+    return (left->due_ms < right->due_ms) || ((left->due_ms == right->due_ms) && (left->sequence < right->sequence));
+}
+
+static void swap_delayed_works(DELAYED_WORK_ITEM* left, DELAYED_WORK_ITEM* right)
+{
+    DELAYED_WORK_ITEM temp = *left;
+    *left = *right;
+    *right = temp;
+}
+
+static int push_delayed_work(THREADPOOL* pool, const DELAYED_WORK_ITEM* delayed_work)
+{
+    int result;
+
+    if (pool->delayed_count == pool->delayed_capacity)
+    {
+        size_t new_capacity = (pool->delayed_capacity == 0) ? DELAYED_WORK_INITIAL_CAPACITY : pool->delayed_capacity * 2;
+        DELAYED_WORK_ITEM* new_delayed = (new_capacity > SIZE_MAX / sizeof(DELAYED_WORK_ITEM)) ? NULL : (DELAYED_WORK_ITEM*)realloc(pool->delayed, new_capacity * sizeof(DELAYED_WORK_ITEM));
+        if (new_delayed == NULL)
+        {
+            LogError("Failed to grow the delayed works to %lu", (unsigned long)new_capacity);
+            result = __FAILURE__;
+        }
+        else
+        {
+            pool->delayed = new_delayed;
+            pool->delayed_capacity = new_capacity;
+            result = 0;
+        }
+    }
+    else
+    {
+        result = 0;
+    }
+
+    if (result == 0)
+    {
+        size_t index = pool->delayed_count++;
+        pool->delayed[index] = *delayed_work;
+
+        while (index > 0)
+        {
+            size_t parent = (index - 1) / 2;
+            if (!delayed_work_is_before(&pool->delayed[index], &pool->delayed[parent]))
+            {
+                break;
+            }
+            swap_delayed_works(&pool->delayed[index], &pool->delayed[parent]);
+            index = parent;
+        }
+    }
+
+    return result;
+}
+
+static void pop_delayed_work(THREADPOOL* pool, WORK_ITEM* item)
+{
+    size_t index = 0;
+
+    *item = pool->delayed[0].item;
+    pool->delayed_count--;
+    pool->delayed[0] = pool->delayed[pool->delayed_count];
+
+    while (1)
+    {
+        size_t smallest = index;
+        size_t left = (index * 2) + 1;
+        size_t right = left + 1;
+
+        if ((left < pool->delayed_count) && delayed_work_is_before(&pool->delayed[left], &pool->delayed[smallest]))
+        {
+            smallest = left;
+        }
+        if ((right < pool->delayed_count) && delayed_work_is_before(&pool->delayed[right], &pool->delayed[smallest]))
+        {
+            smallest = right;
+        }
+        if (smallest == index)
+        {
+            break;
+        }
+        swap_delayed_works(&pool->delayed[index], &pool->delayed[smallest]);
+        index = smallest;
+    }
+}
+
+/*takes the next work that can run, or tells how long to wait for the earliest delayed one (0 when there is none)*/
+static int take_work(THREADPOOL* pool, WORK_ITEM* item, uint64_t* wait_ms)
+{
+    int result = 0;
+
+    *wait_ms = 0;
+    if (pool->delayed_count > 0)
+    {
+        uint64_t now = get_monotonic_ms();
+        if (pool->delayed[0].due_ms <= now)
+        {
+            /*a due delayed work is already late, it goes before the queue*/
+            pop_delayed_work(pool, item);
+            result = 1;
+        }
+        else
+        {
+            *wait_ms = pool->delayed[0].due_ms - now;
+        }
+    }
+
+    if ((result == 0) && (pool->queue_count > 0))
+    {
+        *item = pool->queue[pool->queue_head];
+        pool->queue_head = (pool->queue_head + 1) % pool->queue_capacity;
+        pool->queue_count--;
+        result = 1;
+    }
+
+    return result;
+}
+
+static void run_work(const WORK_ITEM* item)
+{
+    int work_result = item->work(item->work_context);
+    if (item->on_complete != NULL)
+    {
+        item->on_complete(item->complete_context, THREADPOOL_WORK_COMPLETED, work_result);
+    }
+}
+
+static void wake_one_worker(THREADPOOL* pool)
+{
+    if ((pool->idle_workers > 0) && (Condition_Post(pool->work_available) != COND_OK))
+    {
+        LogError("Failed to wake a worker");
+    }
+}
+
+static int worker_thread(void* arg)
+{
+    THREADPOOL* pool = (THREADPOOL*)arg;
+    int result;
+
+    if (Lock(pool->lock) != LOCK_OK)
+    {
+        LogError("Failed to take the threadpool lock");
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+        while (1)
+        {
+            WORK_ITEM item;
+            uint64_t wait_ms;
+
+            if (take_work(pool, &item, &wait_ms))
+            {
+                /*Codes_SRS_THREADPOOL_99_008: [ A worker shall run the work without holding the threadpool lock and then call on_complete, when it is not NULL, with THREADPOOL_WORK_COMPLETED and the value the work returned. ]*/
+                (void)Unlock(pool->lock);
+                run_work(&item);
+                if (Lock(pool->lock) != LOCK_OK)
+                {
+                    LogError("Failed to take the threadpool lock");
+                    result = __FAILURE__;
+                    break;
+                }
+            }
+            else if (pool->stopping)
+            {
+                (void)Unlock(pool->lock);
+                break;
+            }
+            else
+            {
+                /*wait_ms is 0 without delayed works, Condition_WaitNanoseconds then waits until a post*/
+                pool->idle_workers++;
+                if (Condition_WaitNanoseconds(pool->work_available, pool->lock, wait_ms * NANOSECONDS_IN_1_MS) == COND_ERROR)
+                {
+                    LogError("Failed to wait for work");
+                }
+                pool->idle_workers--;
+            }
+        }
+    }
+
+    return result;
+}
+
+static void stop_workers(THREADPOOL* pool, size_t started_workers)
+{
+    size_t i;
+
+    if (Lock(pool->lock) != LOCK_OK)
+    {
+        LogError("Failed to take the threadpool lock, the workers are joined anyway");
+    }
+    pool->stopping = 1;
+    /*one post per worker: every post wakes one of the workers still waiting, a busy worker sees stopping before it waits again*/
+    for (i = 0; i < started_workers; i++)
+    {
+        (void)Condition_Post(pool->work_available);
+    }
+    (void)Unlock(pool->lock);
+
+    for (i = 0; i < started_workers; i++)
+    {
+        int thread_result;
+        if (ThreadAPI_Join(pool->workers[i], &thread_result) != THREADAPI_OK)
+        {
+            LogError("Failed to join worker %lu", (unsigned long)i);
+        }
+    }
+}
+
+static void free_pool(THREADPOOL* pool)
+{
+    if (pool->work_available != NULL)
+    {
+        Condition_Deinit(pool->work_available);
+    }
+    if (pool->lock != NULL)
+    {
+        (void)Lock_Deinit(pool->lock);
+    }
+    free(pool->delayed);
+    free(pool->queue);
+    free(pool->workers);
+    free(pool);
+}
+
+THREADPOOL_HANDLE threadpool_create(size_t worker_count, size_t queue_capacity)
+{
+    THREADPOOL* result;
+
+    /*Codes_SRS_THREADPOOL_99_001: [ If worker_count or queue_capacity is 0, threadpool_create shall fail and return NULL. ]*/
+    if ((worker_count == 0) || (queue_capacity == 0))
+    {
+        LogError("Invalid arguments: worker_count = %lu, queue_capacity = %lu", (unsigned long)worker_count, (unsigned long)queue_capacity);
+        result = NULL;
+    }
+    else if ((result = (THREADPOOL*)calloc(1, sizeof(THREADPOOL))) == NULL)
+    {
+        LogError("Failed to allocate the threadpool");
+    }
+    else
+    {
+        /*Codes_SRS_THREADPOOL_99_002: [ threadpool_create shall allocate the queue of queue_capacity works, create the lock and the condition and start worker_count threads with ThreadAPI_Create. ]*/
+        /*Codes_SRS_THREADPOOL_99_003: [ If any of that fails, threadpool_create shall stop the threads it started, free everything and return NULL. ]*/
+        result->worker_count = worker_count;
+        result->queue_capacity = queue_capacity;
+
+        if (((result->queue = (WORK_ITEM*)calloc(queue_capacity, sizeof(WORK_ITEM))) == NULL) ||
+            ((result->workers = (THREAD_HANDLE*)calloc(worker_count, sizeof(THREAD_HANDLE))) == NULL))
+        {
+            LogError("Failed to allocate the queue and the workers");
+            free_pool(result);
+            result = NULL;
+        }
+        else if ((result->lock = Lock_Init()) == NULL)
+        {
+            LogError("Failed to create the threadpool lock");
+            free_pool(result);
+            result = NULL;
+        }
+        else if ((result->work_available = Condition_Init()) == NULL)
+        {
+            LogError("Failed to create the threadpool condition");
+            free_pool(result);
+            result = NULL;
+        }
+        else
+        {
+            size_t i;
+            for (i = 0; i < worker_count; i++)
+            {
+                if (ThreadAPI_Create(&result->workers[i], worker_thread, result) != THREADAPI_OK)
+                {
+                    LogError("Failed to start worker %lu", (unsigned long)i);
+                    break;
+                }
+            }
+
+            if (i < worker_count)
+            {
+                stop_workers(result, i);
+                free_pool(result);
+                result = NULL;
+            }
+        }
+    }
+
+    return result;
+}
+
+void threadpool_destroy(THREADPOOL_HANDLE threadpool)
+{
+    /*Codes_SRS_THREADPOOL_99_004: [ If threadpool is NULL, threadpool_destroy shall do nothing. ]*/
+    if (threadpool != NULL)
+    {
+        size_t i;
+
+        /*Codes_SRS_THREADPOOL_99_005: [ threadpool_destroy shall stop accepting work, let the workers run every queued work and join them. ]*/
+        stop_workers(threadpool, threadpool->worker_count);
+
+        /*Codes_SRS_THREADPOOL_99_006: [ threadpool_destroy shall call on_complete with THREADPOOL_WORK_CANCELLED for every delayed work that is not due, then free the pool. ]*/
+        for (i = 0; i < threadpool->delayed_count; i++)
+        {
+            WORK_ITEM* item = &threadpool->delayed[i].item;
+            if (item->on_complete != NULL)
+            {
+                item->on_complete(item->complete_context, THREADPOOL_WORK_CANCELLED, 0);
+            }
+        }
+
+        free_pool(threadpool);
+    }
+}
+
+THREADPOOL_RESULT threadpool_schedule(THREADPOOL_HANDLE threadpool, THREADPOOL_WORK_FUNCTION work, void* work_context, ON_THREADPOOL_WORK_COMPLETE on_complete, void* complete_context)
+{
+    THREADPOOL_RESULT result;
+
+    /*Codes_SRS_THREADPOOL_99_007: [ If threadpool or work is NULL, threadpool_schedule shall fail and return THREADPOOL_INVALID_ARG. ]*/
+    if ((threadpool == NULL) || (work == NULL))
+    {
+        LogError("Invalid arguments: threadpool = %p, work = %p", threadpool, work);
+        result = THREADPOOL_INVALID_ARG;
+    }
+    else if (Lock(threadpool->lock) != LOCK_OK)
+    {
+        LogError("Failed to take the threadpool lock");
+        result = THREADPOOL_ERROR;
+    }
+    else
+    {
+        if (threadpool->stopping)
+        {
+            LogError("The threadpool is being destroyed");
+            result = THREADPOOL_ERROR;
+        }
+        /*Codes_SRS_THREADPOOL_99_009: [ If queue_capacity works are already waiting, threadpool_schedule shall return THREADPOOL_QUEUE_FULL without blocking. ]*/
+        else if (threadpool->queue_count == threadpool->queue_capacity)
+        {
+            result = THREADPOOL_QUEUE_FULL;
+        }
+        else
+        {
+            /*Codes_SRS_THREADPOOL_99_010: [ threadpool_schedule shall queue the work, wake an idle worker and return THREADPOOL_OK. ]*/
+            WORK_ITEM* item = &threadpool->queue[(threadpool->queue_head + threadpool->queue_count) % threadpool->queue_capacity];
+            item->work = work;
+            item->work_context = work_context;
+            item->on_complete = on_complete;
+            item->complete_context = complete_context;
+            threadpool->queue_count++;
+            wake_one_worker(threadpool);
+            result = THREADPOOL_OK;
+        }
+        (void)Unlock(threadpool->lock);
+    }
+
+    return result;
+}
+
+THREADPOOL_RESULT threadpool_schedule_delayed(THREADPOOL_HANDLE threadpool, uint32_t delay_ms, THREADPOOL_WORK_FUNCTION work, void* work_context, ON_THREADPOOL_WORK_COMPLETE on_complete, void* complete_context)
+{
+    THREADPOOL_RESULT result;
+
+    /*Codes_SRS_THREADPOOL_99_011: [ If threadpool or work is NULL, threadpool_schedule_delayed shall fail and return THREADPOOL_INVALID_ARG. ]*/
+    if ((threadpool == NULL) || (work == NULL))
+    {
+        LogError("Invalid arguments: threadpool = %p, work = %p", threadpool, work);
+        result = THREADPOOL_INVALID_ARG;
+    }
+    else if (Lock(threadpool->lock) != LOCK_OK)
+    {
+        LogError("Failed to take the threadpool lock");
+        result = THREADPOOL_ERROR;
+    }
+    else
+    {
+        if (threadpool->stopping)
+        {
+            LogError("The threadpool is being destroyed");
+            result = THREADPOOL_ERROR;
+        }
+        else
+        {
+            /*Codes_SRS_THREADPOOL_99_012: [ threadpool_schedule_delayed shall keep the work until delay_ms milliseconds have passed on a monotonic clock, and run it before the queued works once it is due. ]*/
+            DELAYED_WORK_ITEM delayed_work;
+            delayed_work.due_ms = get_monotonic_ms() + delay_ms;
+            delayed_work.sequence = threadpool->delayed_sequence++;
+            delayed_work.item.work = work;
+            delayed_work.item.work_context = work_context;
+            delayed_work.item.on_complete = on_complete;
+            delayed_work.item.complete_context = complete_context;
+
+            /*Codes_SRS_THREADPOOL_99_013: [ If the delayed work cannot be stored, threadpool_schedule_delayed shall return THREADPOOL_ERROR. ]*/
+            if (push_delayed_work(threadpool, &delayed_work) != 0)
+            {
+                result = THREADPOOL_ERROR;
+            }
+            else
+            {
+                /*an idle worker may be waiting for a later deadline than this one*/
+                if (threadpool->delayed[0].sequence == delayed_work.sequence)
+                {
+                    wake_one_worker(threadpool);
+                }
+                result = THREADPOOL_OK;
+            }
+        }
+        (void)Unlock(threadpool->lock);
+    }
+
+    return result;
+}
+
+static void release_future(THREADPOOL_FUTURE* future)
+{
+    int references;
+
+    (void)Lock(future->lock);
+    references = --future->references;
+    (void)Unlock(future->lock);
+
+    if (references == 0)
+    {
+        Condition_Deinit(future->done_condition);
+        (void)Lock_Deinit(future->lock);
+        free(future);
+    }
+}
+
+static void on_future_work_complete(void* complete_context, THREADPOOL_WORK_STATUS status, int work_result)
+{
+    THREADPOOL_FUTURE* future = (THREADPOOL_FUTURE*)complete_context;
+
+    (void)status;
+    (void)Lock(future->lock);
+    future->work_result = work_result;
+    future->done = 1;
+    (void)Condition_Post(future->done_condition);
+    (void)Unlock(future->lock);
+
+    release_future(future);
+}
+
+THREADPOOL_RESULT threadpool_submit(THREADPOOL_HANDLE threadpool, THREADPOOL_WORK_FUNCTION work, void* work_context, THREADPOOL_FUTURE_HANDLE* future)
+{
+    THREADPOOL_RESULT result;
+
+    /*Codes_SRS_THREADPOOL_99_014: [ If threadpool, work or future is NULL, threadpool_submit shall fail and return THREADPOOL_INVALID_ARG. ]*/
+    if ((threadpool == NULL) || (work == NULL) || (future == NULL))
+    {
+        LogError("Invalid arguments: threadpool = %p, work = %p, future = %p", threadpool, work, future);
+        result = THREADPOOL_INVALID_ARG;
+    }
+    else
+    {
+        THREADPOOL_FUTURE* new_future = (THREADPOOL_FUTURE*)malloc(sizeof(THREADPOOL_FUTURE));
+        if (new_future == NULL)
+        {
+            LogError("Failed to allocate the future");
+            result = THREADPOOL_ERROR;
+        }
+        else if ((new_future->lock = Lock_Init()) == NULL)
+        {
+            LogError("Failed to create the future lock");
+            free(new_future);
+            result = THREADPOOL_ERROR;
+        }
+        else if ((new_future->done_condition = Condition_Init()) == NULL)
+        {
+            LogError("Failed to create the future condition");
+            (void)Lock_Deinit(new_future->lock);
+            free(new_future);
+            result = THREADPOOL_ERROR;
+        }
+        else
+        {
+            new_future->references = 2;
+            new_future->done = 0;
+            new_future->work_result = 0;
+
+            /*Codes_SRS_THREADPOOL_99_015: [ threadpool_submit shall schedule the work like threadpool_schedule and, on success, return the future in future. Otherwise it shall free the future and return the threadpool_schedule result. ]*/
+            result = threadpool_schedule(threadpool, work, work_context, on_future_work_complete, new_future);
+            if (result != THREADPOOL_OK)
+            {
+                Condition_Deinit(new_future->done_condition);
+                (void)Lock_Deinit(new_future->lock);
+                free(new_future);
+            }
+            else
+            {
+                *future = new_future;
+            }
+        }
+    }
+
+    return result;
+}
+
+THREADPOOL_RESULT threadpool_future_wait(THREADPOOL_FUTURE_HANDLE future, unsigned int timeout_milliseconds, int* work_result)
+{
+    THREADPOOL_RESULT result;
+
+    /*Codes_SRS_THREADPOOL_99_016: [ If future is NULL, threadpool_future_wait shall fail and return THREADPOOL_INVALID_ARG. ]*/
+    if (future == NULL)
+    {
+        LogError("NULL future");
+        result = THREADPOOL_INVALID_ARG;
+    }
+    else if (Lock(future->lock) != LOCK_OK)
+    {
+        LogError("Failed to take the future lock");
+        result = THREADPOOL_ERROR;
+    }
+    else
+    {
+        uint64_t deadline_ms = get_monotonic_ms() + timeout_milliseconds;
+
+        result = THREADPOOL_OK;
+        while (!future->done)
+        {
+            uint64_t wait_ms = 0;
+
+            if (timeout_milliseconds != 0)
+            {
+                /*a wake up without the work being done does not restart the timeout*/
+                uint64_t now = get_monotonic_ms();
+                if (now >= deadline_ms)
+                {
+                    break;
+                }
+                wait_ms = deadline_ms - now;
+            }
+
+            if (Condition_WaitNanoseconds(future->done_condition, future->lock, wait_ms * NANOSECONDS_IN_1_MS) == COND_ERROR)
+            {
+                LogError("Failed to wait on the future");
+                result = THREADPOOL_ERROR;
+                break;
+            }
+        }
+
+        if (result == THREADPOOL_OK)
+        {
+            if (future->done)
+            {
+                /*Codes_SRS_THREADPOOL_99_017: [ Once the work ran, threadpool_future_wait shall store the value it returned in work_result, when it is not NULL, and return THREADPOOL_OK. ]*/
+                if (work_result != NULL)
+                {
+                    *work_result = future->work_result;
+                }
+            }
+            else
+            {
+                /*Codes_SRS_THREADPOOL_99_018: [ If the work did not run within timeout_milliseconds, threadpool_future_wait shall return THREADPOOL_TIMEOUT. A timeout_milliseconds of 0 waits for as long as it takes. ]*/
+                result = THREADPOOL_TIMEOUT;
+            }
+        }
+        (void)Unlock(future->lock);
+    }
+
+    return result;
+}
+
+void threadpool_future_destroy(THREADPOOL_FUTURE_HANDLE future)
+{
+    /*Codes_SRS_THREADPOOL_99_019: [ If future is NULL, threadpool_future_destroy shall do nothing. Otherwise it shall release the future, which is freed once its work ran too. ]*/
+    if (future != NULL)
+    {
+        release_future(future);
+    }
+}
@@ -11,87 +11,53 @@
 #include <stddef.h>
 #include <stdint.h>
 #endif
+#include <string.h>
 
 #include "azure_c_shared_utility/utf8_checker.h"
+#include "azure_c_shared_utility/utf8_checker_accel.h"
+#include "azure_c_shared_utility/optimize_size.h"
 
-bool utf8_checker_is_valid_utf8(const unsigned char* utf8_str, size_t length)
+#define ASCII_WORD_MASK 0x8080808080808080ULL
+
+static bool utf8_checker_validate_portable(const unsigned char* utf8_str, size_t length)
 {
-    bool result;
+    bool result = true;
+    size_t pos = 0;
 
-    if (utf8_str == NULL)
-    {
-        /* Codes_SRS_UTF8_CHECKER_01_002: [ If `utf8_checker_is_valid_utf8` is called with NULL `utf8_str` it shall return false. ]*/
-        result = false;
-    }
-    else
+    while ((result == true) &&
+           (pos < length))
     {
-        size_t pos = 0;
-
-        /* Codes_SRS_UTF8_CHECKER_01_003: [ If `length` is 0, `utf8_checker_is_valid_utf8` shall consider `utf8_str` to be valid UTF-8 and return true. ]*/
-        result = true;
-
-        while ((result == true) &&
-               (pos < length))
+        /* runs of ASCII are skipped a word at a time */
+        while ((length - pos >= sizeof(uint64_t)) &&
+               (utf8_str[pos] < 0x80))
         {
-            /* Codes_SRS_UTF8_CHECKER_01_001: [ `utf8_checker_is_valid_utf8` shall verify that the sequence of chars pointed to by `utf8_str` represent UTF-8 encoded codepoints. ]*/
-            if ((utf8_str[pos] >> 3) == 0x1E)
+            uint64_t word;
+            (void)memcpy(&word, utf8_str + pos, sizeof(word));
+            if ((word & ASCII_WORD_MASK) != 0)
             {
-                /* 4 bytes */
-                /* Codes_SRS_UTF8_CHECKER_01_009: [ 000uuuuu zzzzyyyy yyxxxxxx 11110uuu 10uuzzzz 10yyyyyy 10xxxxxx ]*/
-                uint32_t code_point = (utf8_str[pos] & 0x07);
+                break;
+            }
+            pos += sizeof(uint64_t);
+        }
 
-                pos++;
-                if ((pos < length) &&
-                    ((utf8_str[pos] >> 6) == 0x02))
-                {
-                    code_point <<= 6;
-                    code_point += utf8_str[pos] & 0x3F;
+        if (pos == length)
+        {
+            break;
+        }
 
-                    pos++;
-                    if ((pos < length) &&
-                        ((utf8_str[pos] >> 6) == 0x02))
-                    {
-                        code_point <<= 6;
-                        code_point += utf8_str[pos] & 0x3F;
+        /* Codes_SRS_UTF8_CHECKER_01_001: [ `utf8_checker_is_valid_utf8` shall verify that the sequence of chars pointed to by `utf8_str` represent UTF-8 encoded codepoints. ]*/
+        if ((utf8_str[pos] >> 3) == 0x1E)
+        {
+            /* 4 bytes */
+            /* Codes_SRS_UTF8_CHECKER_01_009: [ 000uuuuu zzzzyyyy yyxxxxxx 11110uuu 10uuzzzz 10yyyyyy 10xxxxxx ]*/
+            uint32_t code_point = (utf8_str[pos] & 0x07);
 
-                        pos++;
-                        if ((pos < length) &&
-                            ((utf8_str[pos] >> 6) == 0x02))
-                        {
-                            code_point <<= 6;
-                            code_point += utf8_str[pos] & 0x3F;
-
-                            if (code_point <= 0xFFFF)
-                            {
-                                result = false;
-                            }
-                            else
-                            {
-                                /* Codes_SRS_UTF8_CHECKER_01_005: [ On success it shall return true. ]*/
-                                result = true;
-                                pos++;
-                            }
-                        }
-                        else
-                        {
-                            result = false;
-                        }
-                    }
-                    else
-                    {
-                        result = false;
-                    }
-                }
-                else
-                {
-                    result = false;
-                }
-            }
-            else if ((utf8_str[pos] >> 4) == 0x0E)
+            pos++;
+            if ((pos < length) &&
+                ((utf8_str[pos] >> 6) == 0x02))
             {
-                /* 3 bytes */
-                /* Codes_SRS_UTF8_CHECKER_01_008: [ zzzzyyyy yyxxxxxx 1110zzzz 10yyyyyy 10xxxxxx ]*/
-                uint32_t code_point = (utf8_str[pos] & 0x0F);
+                code_point <<= 6;
+                code_point += utf8_str[pos] & 0x3F;
 
                 pos++;
                 if ((pos < length) &&
@@ -107,7 +73,7 @@ bool utf8_checker_is_valid_utf8(const unsigned char* utf8_str, size_t length)
                         code_point <<= 6;
                         code_point += utf8_str[pos] & 0x3F;
 
-                        if (code_point <= 0x7FF)
+                        if (code_point <= 0xFFFF)
                         {
                             result = false;
                         }
@@ -128,11 +94,23 @@ bool utf8_checker_is_valid_utf8(const unsigned char* utf8_str, size_t length)
                     result = false;
                 }
             }
-            else if ((utf8_str[pos] >> 5) == 0x06)
+            else
+            {
+                result = false;
+            }
+        }
+        else if ((utf8_str[pos] >> 4) == 0x0E)
+        {
+            /* 3 bytes */
+            /* Codes_SRS_UTF8_CHECKER_01_008: [ zzzzyyyy yyxxxxxx 1110zzzz 10yyyyyy 10xxxxxx ]*/
+            uint32_t code_point = (utf8_str[pos] & 0x0F);
+
+            pos++;
+            if ((pos < length) &&
+                ((utf8_str[pos] >> 6) == 0x02))
             {
-                /* 2 bytes */
-                /* Codes_SRS_UTF8_CHECKER_01_007: [ 00000yyy yyxxxxxx 110yyyyy 10xxxxxx ]*/
-                uint32_t code_point = (utf8_str[pos] & 0x1F);
+                code_point <<= 6;
+                code_point += utf8_str[pos] & 0x3F;
 
                 pos++;
                 if ((pos < length) &&
@@ -141,7 +119,7 @@ bool utf8_checker_is_valid_utf8(const unsigned char* utf8_str, size_t length)
                     code_point <<= 6;
                     code_point += utf8_str[pos] & 0x3F;
 
-                    if (code_point <= 0x7F)
+                    if (code_point <= 0x7FF)
                     {
                         result = false;
                     }
@@ -157,21 +135,260 @@ bool utf8_checker_is_valid_utf8(const unsigned char* utf8_str, size_t length)
                     result = false;
                 }
             }
-            else if ((utf8_str[pos] >> 7) == 0x00)
+            else
             {
-                /* 1 byte */
-                /* Codes_SRS_UTF8_CHECKER_01_006: [ 00000000 0xxxxxxx 0xxxxxxx ]*/
-                /* Codes_SRS_UTF8_CHECKER_01_005: [ On success it shall return true. ]*/
-                result = true;
-                pos++;
+                result = false;
+            }
+        }
+        else if ((utf8_str[pos] >> 5) == 0x06)
+        {
+            /* 2 bytes */
+            /* Codes_SRS_UTF8_CHECKER_01_007: [ 00000yyy yyxxxxxx 110yyyyy 10xxxxxx ]*/
+            uint32_t code_point = (utf8_str[pos] & 0x1F);
+
+            pos++;
+            if ((pos < length) &&
+                ((utf8_str[pos] >> 6) == 0x02))
+            {
+                code_point <<= 6;
+                code_point += utf8_str[pos] & 0x3F;
+
+                if (code_point <= 0x7F)
+                {
+                    result = false;
+                }
+                else
+                {
+                    /* Codes_SRS_UTF8_CHECKER_01_005: [ On success it shall return true. ]*/
+                    result = true;
+                    pos++;
+                }
             }
             else
             {
-                /* error */
                 result = false;
             }
         }
+        else if ((utf8_str[pos] >> 7) == 0x00)
+        {
+            /* 1 byte */
+            /* Codes_SRS_UTF8_CHECKER_01_006: [ 00000000 0xxxxxxx 0xxxxxxx ]*/
+            /* Codes_SRS_UTF8_CHECKER_01_005: [ On success it shall return true. ]*/
+            result = true;
+            pos++;
+        }
+        else
+        {
+            /* error */
+            result = false;
+        }
+    }
+
+    return result;
+}
+
+static bool utf8_checker_validate_select(const unsigned char* utf8_str, size_t length);
+
+/* the validator in use, it starts as utf8_checker_validate_select that picks the implementation on the first call */
+static UTF8_CHECKER_VALIDATE utf8_checker_validate = utf8_checker_validate_select;
+static UTF8_CHECKER_IMPLEMENTATION utf8_checker_current_implementation = UTF8_CHECKER_IMPLEMENTATION_AUTO;
+
+static bool utf8_checker_validate_select(const unsigned char* utf8_str, size_t length)
+{
+    (void)utf8_checker_set_implementation(UTF8_CHECKER_IMPLEMENTATION_AUTO);
+    return utf8_checker_validate(utf8_str, length);
+}
+
+bool utf8_checker_is_valid_utf8(const unsigned char* utf8_str, size_t length)
+{
+    bool result;
+
+    if (utf8_str == NULL)
+    {
+        /* Codes_SRS_UTF8_CHECKER_01_002: [ If `utf8_checker_is_valid_utf8` is called with NULL `utf8_str` it shall return false. ]*/
+        result = false;
+    }
+    else if (length == 0)
+    {
+        /* Codes_SRS_UTF8_CHECKER_01_003: [ If `length` is 0, `utf8_checker_is_valid_utf8` shall consider `utf8_str` to be valid UTF-8 and return true. ]*/
+        result = true;
+    }
+    else
+    {
+        /* Codes_SRS_UTF8_CHECKER_01_001: [ `utf8_checker_is_valid_utf8` shall verify that the sequence of chars pointed to by `utf8_str` represent UTF-8 encoded codepoints. ]*/
+        result = utf8_checker_validate(utf8_str, length);
+    }
+
+    return result;
+}
+
+/* the number of bytes at the end of utf8_str that start a sequence longer than them, 0 if the text does not end inside a sequence */
+static size_t incomplete_tail_length(const unsigned char* utf8_str, size_t length, unsigned char* sequence_length)
+{
+    size_t result = 0;
+    size_t back;
+
+    for (back = 1; (back <= 3) && (back <= length); back++)
+    {
+        unsigned char c = utf8_str[length - back];
+        if ((c & 0xC0) != 0x80)
+        {
+            /* a lead byte out of F8..FF or an ASCII byte ends the search, the validator judges them */
+            unsigned char needed = (c >= 0xF8) ? 1 : (c >= 0xF0) ? 4 : (c >= 0xE0) ? 3 : (c >= 0xC0) ? 2 : 1;
+            if (needed > back)
+            {
+                *sequence_length = needed;
+                result = back;
+            }
+            break;
+        }
+    }
+
+    return result;
+}
+
+void utf8_checker_stream_init(UTF8_CHECKER_STREAM* stream)
+{
+    /* Codes_SRS_UTF8_CHECKER_99_001: [ `utf8_checker_stream_init` shall start the validation of a new text in `stream`. ]*/
+    if (stream != NULL)
+    {
+        stream->pending_length = 0;
+        stream->sequence_length = 0;
+        stream->failed = false;
+    }
+}
+
+bool utf8_checker_stream_feed(UTF8_CHECKER_STREAM* stream, const unsigned char* utf8_str, size_t length)
+{
+    bool result;
+
+    if ((stream == NULL) ||
+        ((utf8_str == NULL) && (length > 0)))
+    {
+        /* Codes_SRS_UTF8_CHECKER_99_002: [ If `stream` is NULL, or `utf8_str` is NULL while `length` is not 0, `utf8_checker_stream_feed` shall return false. ]*/
+        result = false;
+    }
+    else
+    {
+        size_t pos = 0;
+
+        /* Codes_SRS_UTF8_CHECKER_99_003: [ `utf8_checker_stream_feed` shall validate the `length` bytes at `utf8_str` as the continuation of the text fed so far, a sequence can be split between two calls. ]*/
+        /* the sequence the previous piece ended in is completed byte by byte, then validated alone */
+        while ((!stream->failed) &&
+               (stream->pending_length > 0) &&
+               (pos < length))
+        {
+            unsigned char c = utf8_str[pos++];
+            stream->pending[stream->pending_length++] = c;
+            if ((c & 0xC0) != 0x80)
+            {
+                stream->failed = true;
+            }
+            else if (stream->pending_length == stream->sequence_length)
+            {
+                stream->failed = !utf8_checker_validate(stream->pending, stream->pending_length);
+                stream->pending_length = 0;
+            }
+        }
+
+        /* the rest, except a sequence cut by its end, is validated in one go and never looked at again */
+        if ((!stream->failed) &&
+            (pos < length))
+        {
+            unsigned char sequence_length = 0;
+            size_t tail_length = incomplete_tail_length(utf8_str + pos, length - pos, &sequence_length);
+            size_t complete_length = length - pos - tail_length;
+
+            if ((complete_length > 0) &&
+                (!utf8_checker_validate(utf8_str + pos, complete_length)))
+            {
+                stream->failed = true;
+            }
+            else if (tail_length > 0)
+            {
+                (void)memcpy(stream->pending, utf8_str + length - tail_length, tail_length);
+                stream->pending_length = (unsigned char)tail_length;
+                stream->sequence_length = sequence_length;
+            }
+        }
+
+        /* Codes_SRS_UTF8_CHECKER_99_004: [ Once an invalid byte has been fed `utf8_checker_stream_feed` shall return false, otherwise it shall return true. ]*/
+        result = !stream->failed;
+    }
+
+    return result;
+}
+
+bool utf8_checker_stream_end(UTF8_CHECKER_STREAM* stream)
+{
+    bool result;
+
+    /* Codes_SRS_UTF8_CHECKER_99_005: [ `utf8_checker_stream_end` shall return true if all the bytes fed into `stream` are valid UTF-8 and the text does not end inside a sequence, false otherwise or if `stream` is NULL. ]*/
+    if (stream == NULL)
+    {
+        result = false;
+    }
+    else
+    {
+        result = (!stream->failed) && (stream->pending_length == 0);
+    }
+
+    return result;
+}
+
+int utf8_checker_set_implementation(UTF8_CHECKER_IMPLEMENTATION implementation)
+{
+    int result;
+    UTF8_CHECKER_VALIDATE validate = NULL;
+
+    /* Codes_SRS_UTF8_CHECKER_99_006: [ `UTF8_CHECKER_IMPLEMENTATION_AUTO` shall select AVX2, then SSSE3, then NEON, then the portable code, whichever this CPU and build support first. ]*/
+    if (implementation == UTF8_CHECKER_IMPLEMENTATION_AUTO)
+    {
+        static const UTF8_CHECKER_IMPLEMENTATION preferred[] = { UTF8_CHECKER_IMPLEMENTATION_AVX2, UTF8_CHECKER_IMPLEMENTATION_SSSE3, UTF8_CHECKER_IMPLEMENTATION_NEON };
+        size_t i;
+        implementation = UTF8_CHECKER_IMPLEMENTATION_PORTABLE;
+        for (i = 0; i < sizeof(preferred) / sizeof(preferred[0]); i++)
+        {
+            if ((validate = utf8_checker_accel_get_validator(preferred[i])) != NULL)
+            {
+                implementation = preferred[i];
+                break;
+            }
+        }
+    }
+    else if (implementation != UTF8_CHECKER_IMPLEMENTATION_PORTABLE)
+    {
+        validate = utf8_checker_accel_get_validator(implementation);
+    }
+
+    if (implementation == UTF8_CHECKER_IMPLEMENTATION_PORTABLE)
+    {
+        validate = utf8_checker_validate_portable;
+    }
+
+    if (validate == NULL)
+    {
+        /* Codes_SRS_UTF8_CHECKER_99_007: [ If this CPU or build does not support `implementation` then `utf8_checker_set_implementation` shall fail, return a non-zero value and keep the implementation in use. ]*/
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Codes_SRS_UTF8_CHECKER_99_008: [ Otherwise `utf8_checker_set_implementation` shall make all the validations use `implementation` and return 0. ]*/
+        utf8_checker_validate = validate;
+        utf8_checker_current_implementation = implementation;
+        result = 0;
     }
 
     return result;
 }
+
+UTF8_CHECKER_IMPLEMENTATION utf8_checker_get_implementation(void)
+{
+    /* Codes_SRS_UTF8_CHECKER_99_009: [ `utf8_checker_get_implementation` shall return the implementation in use, selecting it as `UTF8_CHECKER_IMPLEMENTATION_AUTO` does if none was selected yet. ]*/
+    if (utf8_checker_current_implementation == UTF8_CHECKER_IMPLEMENTATION_AUTO)
+    {
+        (void)utf8_checker_set_implementation(UTF8_CHECKER_IMPLEMENTATION_AUTO);
+    }
+
+    return utf8_checker_current_implementation;
+}
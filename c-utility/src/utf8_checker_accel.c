@@ -0,0 +1,374 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/*
+* Vector UTF-8 validation and its run time detection.
+*
+* The validators classify every pair of consecutive bytes with three
+* 16 entry tables indexed by the high and low nibble of the first byte
+* and the high nibble of the second one (Keiser and Lemire, "Validating
+* UTF-8 In Less Than One Instruction Per Byte", the simdutf "lookup"
+* algorithm). Each table entry is a set of error bits, a pair is wrong
+* when a bit is set in all three. Blocks of ASCII only check that the
+* previous block did not end inside a sequence.
+*
+* The tables follow the rules of the portable code in utf8_checker.c
+* rather than the stricter ones of Unicode: overlong sequences are
+* errors, surrogates and lead bytes F4 to F7 (up to U+1FFFFF) are not.
+*
+* Like base64_accel.c the x86 validators use per function target
+* attributes and are only handed out after CPUID says the CPU has the
+* instructions. Define NO_UTF8_CHECKER_ACCELERATION to build the
+* portable code only.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "azure_c_shared_utility/utf8_checker.h"
+#include "azure_c_shared_utility/utf8_checker_accel.h"
+
+#if !defined(NO_UTF8_CHECKER_ACCELERATION)
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)))))
+#define UTF8_CHECKER_ACCEL_X86
+#define UTF8_CHECKER_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define UTF8_CHECKER_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#include <cpuid.h>
+#elif (defined(_M_X64) || defined(_M_IX86)) && defined(_MSC_VER) && (_MSC_VER >= 1900)
+#define UTF8_CHECKER_ACCEL_X86
+#define UTF8_CHECKER_TARGET_SSSE3
+#define UTF8_CHECKER_TARGET_AVX2
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define UTF8_CHECKER_ACCEL_NEON
+#include <arm_neon.h>
+#endif
+
+#endif /* NO_UTF8_CHECKER_ACCELERATION */
+
+/*error bits of a pair of bytes*/
+#define TOO_SHORT       0x01 /* 11______ 0_______ or 11______ 11______ */
+#define TOO_LONG        0x02 /* 0_______ 10______ */
+#define OVERLONG_3      0x04 /* 11100000 100_____ */
+#define TOO_LARGE       0x08 /* 11111___ 1001____ or 11111___ 101_____ */
+#define OVERLONG_2      0x20 /* 1100000_ 10______ */
+#define TOO_LARGE_1000  0x40 /* 11111___ 1000____ */
+#define OVERLONG_4      0x40 /* 11110000 1000____ */
+#define TWO_CONTS       0x80 /* 10______ 10______ */
+#define CARRY           (TOO_SHORT | TOO_LONG | TWO_CONTS)
+
+#define BYTE_1_HIGH_TABLE \
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, \
+    TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS, \
+    TOO_SHORT | OVERLONG_2, \
+    TOO_SHORT, \
+    TOO_SHORT | OVERLONG_3, \
+    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4
+
+#define BYTE_1_LOW_TABLE \
+    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4, \
+    CARRY | OVERLONG_2, \
+    CARRY, CARRY, CARRY, CARRY, CARRY, CARRY, \
+    CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000, \
+    CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000, \
+    CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000, \
+    CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000
+
+#define BYTE_2_HIGH_TABLE \
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, \
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4, \
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE, \
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | TOO_LARGE, \
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | TOO_LARGE, \
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT
+
+#ifdef UTF8_CHECKER_ACCEL_X86
+
+/*
+* CPUID leaf 1 ECX: bit 9 SSSE3, bit 27 OSXSAVE.
+* CPUID leaf 7 EBX: bit 5 AVX2.
+*/
+static void utf8_checker_cpuid(unsigned int leaf, unsigned int regs[4])
+{
+#ifdef _MSC_VER
+    int r[4];
+    __cpuidex(r, (int)leaf, 0);
+    regs[0] = (unsigned int)r[0];
+    regs[1] = (unsigned int)r[1];
+    regs[2] = (unsigned int)r[2];
+    regs[3] = (unsigned int)r[3];
+#else
+    if (__get_cpuid_max(0, NULL) < leaf)
+    {
+        regs[0] = regs[1] = regs[2] = regs[3] = 0;
+    }
+    else
+    {
+        __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+    }
+#endif
+}
+
+/*whether the OS saves the YMM registers, which AVX2 needs*/
+static int utf8_checker_os_saves_ymm(unsigned int leaf1_ecx)
+{
+    int result;
+    if ((leaf1_ecx & (1u << 27)) == 0)
+    {
+        result = 0;
+    }
+    else
+    {
+        uint64_t xcr0;
+#ifdef _MSC_VER
+        xcr0 = _xgetbv(0);
+#else
+        uint32_t eax, edx;
+        __asm__ __volatile__(".byte 0x0f, 0x01, 0xd0" : "=a"(eax), "=d"(edx) : "c"(0));
+        xcr0 = ((uint64_t)edx << 32) | eax;
+#endif
+        result = ((xcr0 & 0x6) == 0x6);
+    }
+    return result;
+}
+
+static int utf8_checker_has_ssse3(void)
+{
+    unsigned int leaf1[4];
+    utf8_checker_cpuid(1, leaf1);
+    return (leaf1[2] & (1u << 9)) != 0;
+}
+
+static int utf8_checker_has_avx2(void)
+{
+    unsigned int leaf1[4];
+    unsigned int leaf7[4];
+    utf8_checker_cpuid(1, leaf1);
+    utf8_checker_cpuid(7, leaf7);
+    return ((leaf7[1] & (1u << 5)) != 0) && utf8_checker_os_saves_ymm(leaf1[2]);
+}
+
+static UTF8_CHECKER_TARGET_SSSE3 __m128i utf8_checker_block_errors_ssse3(__m128i input, __m128i prev_input)
+{
+    const __m128i byte_1_high_table = _mm_setr_epi8(BYTE_1_HIGH_TABLE);
+    const __m128i byte_1_low_table = _mm_setr_epi8(BYTE_1_LOW_TABLE);
+    const __m128i byte_2_high_table = _mm_setr_epi8(BYTE_2_HIGH_TABLE);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    __m128i prev1 = _mm_alignr_epi8(input, prev_input, 15);
+    __m128i prev2 = _mm_alignr_epi8(input, prev_input, 14);
+    __m128i prev3 = _mm_alignr_epi8(input, prev_input, 13);
+    __m128i byte_1_high = _mm_shuffle_epi8(byte_1_high_table, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble));
+    __m128i byte_1_low = _mm_shuffle_epi8(byte_1_low_table, _mm_and_si128(prev1, nibble));
+    __m128i byte_2_high = _mm_shuffle_epi8(byte_2_high_table, _mm_and_si128(_mm_srli_epi16(input, 4), nibble));
+    __m128i special_cases = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+    /*the bytes 2 and 3 places after a 3 or 4 byte lead have to be continuations, for them TWO_CONTS is expected*/
+    __m128i is_third_byte = _mm_subs_epu8(prev2, _mm_set1_epi8((char)(0xE0 - 0x80)));
+    __m128i is_fourth_byte = _mm_subs_epu8(prev3, _mm_set1_epi8((char)(0xF0 - 0x80)));
+    __m128i must_be_continuation = _mm_and_si128(_mm_or_si128(is_third_byte, is_fourth_byte), _mm_set1_epi8((char)0x80));
+    return _mm_xor_si128(must_be_continuation, special_cases);
+}
+
+static UTF8_CHECKER_TARGET_SSSE3 bool utf8_checker_validate_ssse3(const unsigned char* utf8_str, size_t length)
+{
+    /*non zero in the last 3 bytes of a block that ends inside a sequence*/
+    const __m128i max_value = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, (char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+    __m128i error = _mm_setzero_si128();
+    __m128i prev_input = _mm_setzero_si128();
+    __m128i prev_incomplete = _mm_setzero_si128();
+    size_t pos = 0;
+
+    while (pos < length)
+    {
+        __m128i input;
+        if (length - pos >= 16)
+        {
+            input = _mm_loadu_si128((const __m128i*)(utf8_str + pos));
+        }
+        else
+        {
+            /*the last block is padded with ASCII NULs, they make a sequence cut by the end of the text TOO_SHORT*/
+            unsigned char block[16] = { 0 };
+            (void)memcpy(block, utf8_str + pos, length - pos);
+            input = _mm_loadu_si128((const __m128i*)block);
+        }
+
+        if (_mm_movemask_epi8(input) == 0)
+        {
+            error = _mm_or_si128(error, prev_incomplete);
+        }
+        else
+        {
+            error = _mm_or_si128(error, utf8_checker_block_errors_ssse3(input, prev_input));
+            prev_incomplete = _mm_subs_epu8(input, max_value);
+        }
+        prev_input = input;
+        pos += 16;
+    }
+
+    error = _mm_or_si128(error, prev_incomplete);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xFFFF;
+}
+
+static UTF8_CHECKER_TARGET_AVX2 __m256i utf8_checker_block_errors_avx2(__m256i input, __m256i prev_input)
+{
+    const __m256i byte_1_high_table = _mm256_setr_epi8(BYTE_1_HIGH_TABLE, BYTE_1_HIGH_TABLE);
+    const __m256i byte_1_low_table = _mm256_setr_epi8(BYTE_1_LOW_TABLE, BYTE_1_LOW_TABLE);
+    const __m256i byte_2_high_table = _mm256_setr_epi8(BYTE_2_HIGH_TABLE, BYTE_2_HIGH_TABLE);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    /*the high lane of prev_input and the low lane of input, for the bytes that cross the middle of input*/
+    __m256i shifted = _mm256_permute2x128_si256(prev_input, input, 0x21);
+    __m256i prev1 = _mm256_alignr_epi8(input, shifted, 15);
+    __m256i prev2 = _mm256_alignr_epi8(input, shifted, 14);
+    __m256i prev3 = _mm256_alignr_epi8(input, shifted, 13);
+    __m256i byte_1_high = _mm256_shuffle_epi8(byte_1_high_table, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble));
+    __m256i byte_1_low = _mm256_shuffle_epi8(byte_1_low_table, _mm256_and_si256(prev1, nibble));
+    __m256i byte_2_high = _mm256_shuffle_epi8(byte_2_high_table, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble));
+    __m256i special_cases = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+    __m256i is_third_byte = _mm256_subs_epu8(prev2, _mm256_set1_epi8((char)(0xE0 - 0x80)));
+    __m256i is_fourth_byte = _mm256_subs_epu8(prev3, _mm256_set1_epi8((char)(0xF0 - 0x80)));
+    __m256i must_be_continuation = _mm256_and_si256(_mm256_or_si256(is_third_byte, is_fourth_byte), _mm256_set1_epi8((char)0x80));
+    return _mm256_xor_si256(must_be_continuation, special_cases);
+}
+
+static UTF8_CHECKER_TARGET_AVX2 bool utf8_checker_validate_avx2(const unsigned char* utf8_str, size_t length)
+{
+    const __m256i max_value = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, (char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+    __m256i error = _mm256_setzero_si256();
+    __m256i prev_input = _mm256_setzero_si256();
+    __m256i prev_incomplete = _mm256_setzero_si256();
+    size_t pos = 0;
+
+    while (pos < length)
+    {
+        __m256i input;
+        if (length - pos >= 32)
+        {
+            input = _mm256_loadu_si256((const __m256i*)(utf8_str + pos));
+        }
+        else
+        {
+            unsigned char block[32] = { 0 };
+            (void)memcpy(block, utf8_str + pos, length - pos);
+            input = _mm256_loadu_si256((const __m256i*)block);
+        }
+
+        if (_mm256_movemask_epi8(input) == 0)
+        {
+            error = _mm256_or_si256(error, prev_incomplete);
+        }
+        else
+        {
+            error = _mm256_or_si256(error, utf8_checker_block_errors_avx2(input, prev_input));
+            prev_incomplete = _mm256_subs_epu8(input, max_value);
+        }
+        prev_input = input;
+        pos += 32;
+    }
+
+    error = _mm256_or_si256(error, prev_incomplete);
+    return _mm256_movemask_epi8(_mm256_cmpeq_epi8(error, _mm256_setzero_si256())) == -1;
+}
+
+#endif /* UTF8_CHECKER_ACCEL_X86 */
+
+#ifdef UTF8_CHECKER_ACCEL_NEON
+
+static uint8x16_t utf8_checker_block_errors_neon(uint8x16_t input, uint8x16_t prev_input)
+{
+    static const uint8_t byte_1_high_values[16] = { BYTE_1_HIGH_TABLE };
+    static const uint8_t byte_1_low_values[16] = { BYTE_1_LOW_TABLE };
+    static const uint8_t byte_2_high_values[16] = { BYTE_2_HIGH_TABLE };
+    uint8x16_t prev1 = vextq_u8(prev_input, input, 15);
+    uint8x16_t prev2 = vextq_u8(prev_input, input, 14);
+    uint8x16_t prev3 = vextq_u8(prev_input, input, 13);
+    uint8x16_t byte_1_high = vqtbl1q_u8(vld1q_u8(byte_1_high_values), vshrq_n_u8(prev1, 4));
+    uint8x16_t byte_1_low = vqtbl1q_u8(vld1q_u8(byte_1_low_values), vandq_u8(prev1, vdupq_n_u8(0x0F)));
+    uint8x16_t byte_2_high = vqtbl1q_u8(vld1q_u8(byte_2_high_values), vshrq_n_u8(input, 4));
+    uint8x16_t special_cases = vandq_u8(vandq_u8(byte_1_high, byte_1_low), byte_2_high);
+    uint8x16_t is_third_byte = vqsubq_u8(prev2, vdupq_n_u8(0xE0 - 0x80));
+    uint8x16_t is_fourth_byte = vqsubq_u8(prev3, vdupq_n_u8(0xF0 - 0x80));
+    uint8x16_t must_be_continuation = vandq_u8(vorrq_u8(is_third_byte, is_fourth_byte), vdupq_n_u8(0x80));
+    return veorq_u8(must_be_continuation, special_cases);
+}
+
+static bool utf8_checker_validate_neon(const unsigned char* utf8_str, size_t length)
+{
+    static const uint8_t max_values[16] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1 };
+    const uint8x16_t max_value = vld1q_u8(max_values);
+    uint8x16_t error = vdupq_n_u8(0);
+    uint8x16_t prev_input = vdupq_n_u8(0);
+    uint8x16_t prev_incomplete = vdupq_n_u8(0);
+    size_t pos = 0;
+
+    while (pos < length)
+    {
+        uint8x16_t input;
+        if (length - pos >= 16)
+        {
+            input = vld1q_u8(utf8_str + pos);
+        }
+        else
+        {
+            unsigned char block[16] = { 0 };
+            (void)memcpy(block, utf8_str + pos, length - pos);
+            input = vld1q_u8(block);
+        }
+
+        if (vmaxvq_u8(input) < 0x80)
+        {
+            error = vorrq_u8(error, prev_incomplete);
+        }
+        else
+        {
+            error = vorrq_u8(error, utf8_checker_block_errors_neon(input, prev_input));
+            prev_incomplete = vqsubq_u8(input, max_value);
+        }
+        prev_input = input;
+        pos += 16;
+    }
+
+    error = vorrq_u8(error, prev_incomplete);
+    return vmaxvq_u8(error) == 0;
+}
+
+#endif /* UTF8_CHECKER_ACCEL_NEON */
+
+UTF8_CHECKER_VALIDATE utf8_checker_accel_get_validator(UTF8_CHECKER_IMPLEMENTATION implementation)
+{
+    UTF8_CHECKER_VALIDATE result = NULL;
+
+    switch (implementation)
+    {
+#ifdef UTF8_CHECKER_ACCEL_X86
+    case UTF8_CHECKER_IMPLEMENTATION_SSSE3:
+        if (utf8_checker_has_ssse3())
+        {
+            result = utf8_checker_validate_ssse3;
+        }
+        break;
+    case UTF8_CHECKER_IMPLEMENTATION_AVX2:
+        if (utf8_checker_has_avx2())
+        {
+            result = utf8_checker_validate_avx2;
+        }
+        break;
+#endif
+#ifdef UTF8_CHECKER_ACCEL_NEON
+    case UTF8_CHECKER_IMPLEMENTATION_NEON:
+        result = utf8_checker_validate_neon;
+        break;
+#endif
+    default:
+        break;
+    }
+
+    return result;
+}
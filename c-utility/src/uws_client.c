@@ -26,6 +26,9 @@
 
 static const char* UWS_CLIENT_OPTIONS = "uWSClientOptions";
 
+/* send and receive buffers up to this size are kept for the next frames */
+#define UWS_CLIENT_BUFFER_KEEP_SIZE (64 * 1024)
+
 /* Requirements not needed as they are optional:
 Codes_SRS_UWS_CLIENT_01_254: [ If an endpoint receives a Ping frame and has not yet sent Pong frame(s) in response to previous Ping frame(s), the endpoint MAY elect to send a Pong frame for only the most recently processed Ping frame. ]
 Codes_SRS_UWS_CLIENT_01_255: [ A Pong frame MAY be sent unsolicited. ]
@@ -97,7 +100,14 @@ typedef struct UWS_CLIENT_INSTANCE_TAG
     void* on_ws_close_complete_context;
     unsigned char* received_bytes;
     size_t received_bytes_count;
+    size_t received_bytes_size;
     UWS_FRAME_DECODER_STATE frame_decoder_state;
+    UTF8_CHECKER_STREAM utf8_stream;
+    size_t utf8_checked_bytes;
+    bool text_message_in_progress;
+    UWS_FRAME_MASK_GENERATOR mask_generator;
+    unsigned char* send_buffer;
+    size_t send_buffer_size;
 } UWS_CLIENT_INSTANCE;
 
 /* Codes_SRS_UWS_CLIENT_01_360: [ Connection confidentiality and integrity is provided by running the WebSocket Protocol over TLS (wss URIs). ]*/
@@ -269,6 +279,13 @@ UWS_CLIENT_HANDLE uws_client_create(const char* hostname, unsigned int port, con
                                 result->on_ws_close_complete_context = NULL;
                                 result->received_bytes = NULL;
                                 result->received_bytes_count = 0;
+                                result->received_bytes_size = 0;
+                                result->frame_decoder_state = UWS_FRAME_DECODER_STATE_HEADER_AND_LENGTH;
+                                result->utf8_checked_bytes = 0;
+                                result->text_message_in_progress = false;
+                                (void)memset(&result->mask_generator, 0, sizeof(result->mask_generator));
+                                result->send_buffer = NULL;
+                                result->send_buffer_size = 0;
 
                                 result->protocol_count = protocol_count;
 
@@ -443,6 +460,13 @@ UWS_CLIENT_HANDLE uws_client_create_with_io(const IO_INTERFACE_DESCRIPTION* io_i
                                 result->on_ws_close_complete_context = NULL;
                                 result->received_bytes = NULL;
                                 result->received_bytes_count = 0;
+                                result->received_bytes_size = 0;
+                                result->frame_decoder_state = UWS_FRAME_DECODER_STATE_HEADER_AND_LENGTH;
+                                result->utf8_checked_bytes = 0;
+                                result->text_message_in_progress = false;
+                                (void)memset(&result->mask_generator, 0, sizeof(result->mask_generator));
+                                result->send_buffer = NULL;
+                                result->send_buffer_size = 0;
 
                                 result->protocol_count = protocol_count;
 
@@ -523,6 +547,11 @@ void uws_client_destroy(UWS_CLIENT_HANDLE uws_client)
     {
         free(uws_client->received_bytes);
 
+        if (uws_client->send_buffer != NULL)
+        {
+            free(uws_client->send_buffer);
+        }
+
         /* Codes_SRS_UWS_CLIENT_01_021: [ `uws_client_destroy` shall perform a close action if the uws instance has already been open. ]*/
         switch (uws_client->uws_state)
         {
@@ -787,16 +816,6 @@ static void on_underlying_io_open_complete(void* context, IO_OPEN_RESULT open_re
     }
 }
 
-static void consume_received_bytes(UWS_CLIENT_INSTANCE* uws_client, size_t consumed_bytes)
-{
-    if (consumed_bytes < uws_client->received_bytes_count)
-    {
-        (void)memmove(uws_client->received_bytes, uws_client->received_bytes + consumed_bytes, uws_client->received_bytes_count - consumed_bytes);
-    }
-
-    uws_client->received_bytes_count -= consumed_bytes;
-}
-
 static void on_underlying_io_close_complete(void* context)
 {
     if (context == NULL)
@@ -944,6 +963,562 @@ static int ParseHttpResponse(const char* src, int* dst)
     return result;
 }
 
+typedef enum FRAME_HEADER_RESULT_TAG
+{
+    FRAME_HEADER_INCOMPLETE,
+    FRAME_HEADER_COMPLETE,
+    FRAME_HEADER_BAD
+} FRAME_HEADER_RESULT;
+
+/* Decodes as much of the frame header as there is in bytes and leaves in frame_decoder_state how far it got.
+   When the header is incomplete header_length is the number of bytes needed to get further with it,
+   when it is complete the frame spans header_length + payload_length bytes. */
+static FRAME_HEADER_RESULT decode_frame_header(UWS_CLIENT_INSTANCE* uws_client, const unsigned char* bytes, size_t count, size_t* header_length, size_t* payload_length)
+{
+    FRAME_HEADER_RESULT result;
+    size_t length;
+
+    uws_client->frame_decoder_state = UWS_FRAME_DECODER_STATE_HEADER_AND_LENGTH;
+    *header_length = 2;
+
+    /* Codes_SRS_UWS_CLIENT_01_277: [ To receive WebSocket data, an endpoint listens on the underlying network connection. ]*/
+    /* Codes_SRS_UWS_CLIENT_01_278: [ Incoming data MUST be parsed as WebSocket frames as defined in Section 5.2. ]*/
+    if (count < *header_length)
+    {
+        result = FRAME_HEADER_INCOMPLETE;
+    }
+    /* Codes_SRS_UWS_CLIENT_01_160: [ Defines whether the "Payload data" is masked. ]*/
+    else if ((bytes[1] & 0x80) != 0)
+    {
+        /* Codes_SRS_UWS_CLIENT_01_144: [ A client MUST close a connection if it detects a masked frame. ]*/
+        /* Codes_SRS_UWS_CLIENT_01_145: [ In this case, it MAY use the status code 1002 (protocol error) as defined in Section 7.4.1. (These rules might be relaxed in a future specification.) ]*/
+        LogError("Masked frame detected by WebSocket client");
+        indicate_ws_error_and_close(uws_client, WS_ERROR_BAD_FRAME_RECEIVED, 1002);
+        result = FRAME_HEADER_BAD;
+    }
+    else
+    {
+        /* Codes_SRS_UWS_CLIENT_01_163: [ The length of the "Payload data", in bytes: ]*/
+        /* Codes_SRS_UWS_CLIENT_01_164: [ if 0-125, that is the payload length. ]*/
+        length = bytes[1];
+        result = FRAME_HEADER_COMPLETE;
+
+        if (length == 126)
+        {
+            /* Codes_SRS_UWS_CLIENT_01_165: [ If 126, the following 2 bytes interpreted as a 16-bit unsigned integer are the payload length. ]*/
+            uws_client->frame_decoder_state = UWS_FRAME_DECODER_STATE_EXTENDED_LENGTH_16;
+            *header_length += 2;
+            if (count < *header_length)
+            {
+                result = FRAME_HEADER_INCOMPLETE;
+            }
+            else
+            {
+                /* Codes_SRS_UWS_CLIENT_01_167: [ Multibyte length quantities are expressed in network byte order. ]*/
+                length = ((size_t)(bytes[2]) << 8) + (size_t)bytes[3];
+
+                if (length < 126)
+                {
+                    /* Codes_SRS_UWS_CLIENT_01_168: [ Note that in all cases, the minimal number of bytes MUST be used to encode the length, for example, the length of a 124-byte-long string can't be encoded as the sequence 126, 0, 124. ]*/
+                    LogError("Bad frame: received a %u length on the 16 bit length", (unsigned int)length);
+
+                    /* Codes_SRS_UWS_CLIENT_01_419: [ If there is an error decoding the WebSocket frame, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_BAD_FRAME_RECEIVED`. ]*/
+                    indicate_ws_error(uws_client, WS_ERROR_BAD_FRAME_RECEIVED);
+                    result = FRAME_HEADER_BAD;
+                }
+            }
+        }
+        else if (length == 127)
+        {
+            /* Codes_SRS_UWS_CLIENT_01_166: [ If 127, the following 8 bytes interpreted as a 64-bit unsigned integer (the most significant bit MUST be 0) are the payload length. ]*/
+            uws_client->frame_decoder_state = UWS_FRAME_DECODER_STATE_EXTENDED_LENGTH_64;
+            *header_length += 8;
+            if (count < *header_length)
+            {
+                result = FRAME_HEADER_INCOMPLETE;
+            }
+            else if ((bytes[2] & 0x80) != 0)
+            {
+                LogError("Bad frame: received a 64 bit length frame with the highest bit set");
+
+                /* Codes_SRS_UWS_CLIENT_01_419: [ If there is an error decoding the WebSocket frame, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_BAD_FRAME_RECEIVED`. ]*/
+                indicate_ws_error(uws_client, WS_ERROR_BAD_FRAME_RECEIVED);
+                result = FRAME_HEADER_BAD;
+            }
+            else
+            {
+                /* Codes_SRS_UWS_CLIENT_01_167: [ Multibyte length quantities are expressed in network byte order. ]*/
+                uint64_t length_64 = ((uint64_t)(bytes[2]) << 56) +
+                    (((uint64_t)bytes[3]) << 48) +
+                    (((uint64_t)bytes[4]) << 40) +
+                    (((uint64_t)bytes[5]) << 32) +
+                    (((uint64_t)bytes[6]) << 24) +
+                    (((uint64_t)bytes[7]) << 16) +
+                    (((uint64_t)bytes[8]) << 8) +
+                    (uint64_t)(bytes[9]);
+
+                if (length_64 < 65536)
+                {
+                    /* Codes_SRS_UWS_CLIENT_01_168: [ Note that in all cases, the minimal number of bytes MUST be used to encode the length, for example, the length of a 124-byte-long string can't be encoded as the sequence 126, 0, 124. ]*/
+                    LogError("Bad frame: received a %u length on the 64 bit length", (unsigned int)length_64);
+
+                    /* Codes_SRS_UWS_CLIENT_01_419: [ If there is an error decoding the WebSocket frame, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_BAD_FRAME_RECEIVED`. ]*/
+                    indicate_ws_error(uws_client, WS_ERROR_BAD_FRAME_RECEIVED);
+                    result = FRAME_HEADER_BAD;
+                }
+                else if (length_64 > (uint64_t)(SIZE_MAX - *header_length))
+                {
+                    LogError("Bad frame: the frame does not fit in memory");
+
+                    /* Codes_SRS_UWS_CLIENT_01_419: [ If there is an error decoding the WebSocket frame, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_BAD_FRAME_RECEIVED`. ]*/
+                    indicate_ws_error(uws_client, WS_ERROR_BAD_FRAME_RECEIVED);
+                    result = FRAME_HEADER_BAD;
+                }
+                else
+                {
+                    length = (size_t)length_64;
+                }
+            }
+        }
+
+        if (result == FRAME_HEADER_COMPLETE)
+        {
+            uws_client->frame_decoder_state = UWS_FRAME_DECODER_STATE_PAYLOAD_BYTES;
+            *payload_length = length;
+        }
+    }
+
+    return result;
+}
+
+/* Acts on one whole frame. The payload is only read, so it can be the bytes the underlying IO handed over. */
+static void decode_frame(UWS_CLIENT_INSTANCE* uws_client, const unsigned char* frame, size_t header_length, size_t length)
+{
+    const unsigned char* data_ptr = frame + header_length;
+    unsigned char opcode = frame[0] & 0xF;
+
+    switch (opcode)
+    {
+    default:
+        break;
+
+        /* Codes_SRS_UWS_CLIENT_01_153: [ *  %x1 denotes a text frame ]*/
+        /* Codes_SRS_UWS_CLIENT_01_258: [** Currently defined opcodes for data frames include 0x1 (Text), 0x2 (Binary). ]*/
+    case (unsigned char)WS_TEXT_FRAME:
+        /* Codes_SRS_UWS_CLIENT_01_386: [ When a WebSocket data frame is decoded succesfully it shall be indicated via the callback `on_ws_frame_received`. ]*/
+        /* Codes_SRS_UWS_CLIENT_01_169: [ The payload length is the length of the "Extension data" + the length of the "Application data". ]*/
+        /* Codes_SRS_UWS_CLIENT_01_173: [ The "Payload data" is defined as "Extension data" concatenated with "Application data". ]*/
+        /* Codes_SRS_UWS_CLIENT_01_280: [ Upon receiving a data frame (Section 5.6), the endpoint MUST note the /type/ of the data as defined by the opcode (frame-opcode) from Section 5.2. ]*/
+        /* Codes_SRS_UWS_CLIENT_01_281: [ The "Application data" from this frame is defined as the /data/ of the message. ]*/
+        /* Codes_SRS_UWS_CLIENT_01_282: [ If the frame comprises an unfragmented message (Section 5.4), it is said that _A WebSocket Message Has Been Received_ with type /type/ and data /data/. ]*/
+        uws_client->on_ws_frame_received(uws_client->on_ws_frame_received_context, WS_FRAME_TYPE_TEXT, data_ptr, length);
+        break;
+
+        /* Codes_SRS_UWS_CLIENT_01_154: [ *  %x2 denotes a binary frame ]*/
+    case (unsigned char)WS_BINARY_FRAME:
+        /* Codes_SRS_UWS_CLIENT_01_386: [ When a WebSocket data frame is decoded succesfully it shall be indicated via the callback `on_ws_frame_received`. ]*/
+        /* Codes_SRS_UWS_CLIENT_01_169: [ The payload length is the length of the "Extension data" + the length of the "Application data". ]*/
+        /* Codes_SRS_UWS_CLIENT_01_173: [ The "Payload data" is defined as "Extension data" concatenated with "Application data". ]*/
+        /* Codes_SRS_UWS_CLIENT_01_264: [ The "Payload data" is arbitrary binary data whose interpretation is solely up to the application layer. ]*/
+        /* Codes_SRS_UWS_CLIENT_01_280: [ Upon receiving a data frame (Section 5.6), the endpoint MUST note the /type/ of the data as defined by the opcode (frame-opcode) from Section 5.2. ]*/
+        /* Codes_SRS_UWS_CLIENT_01_281: [ The "Application data" from this frame is defined as the /data/ of the message. ]*/
+        /* Codes_SRS_UWS_CLIENT_01_282: [ If the frame comprises an unfragmented message (Section 5.4), it is said that _A WebSocket Message Has Been Received_ with type /type/ and data /data/. ]*/
+        uws_client->on_ws_frame_received(uws_client->on_ws_frame_received_context, WS_FRAME_TYPE_BINARY, data_ptr, length);
+        break;
+
+        /* Codes_SRS_UWS_CLIENT_01_156: [ *  %x8 denotes a connection close ]*/
+        /* Codes_SRS_UWS_CLIENT_01_234: [ The Close frame contains an opcode of 0x8. ]*/
+    case (unsigned char)WS_CLOSE_FRAME:
+    {
+        uint16_t close_code;
+        uint16_t* close_code_ptr;
+        const unsigned char* extra_data_ptr;
+        size_t extra_data_length;
+        unsigned char* close_frame_bytes;
+        size_t close_frame_length;
+        bool utf8_error = false;
+
+        /* Codes_SRS_UWS_CLIENT_01_235: [ The Close frame MAY contain a body (the "Application data" portion of the frame) that indicates a reason for closing, such as an endpoint shutting down, an endpoint having received a frame too large, or an endpoint having received a frame that does not conform to the format expected by the endpoint. ]*/
+        if (length >= 2)
+        {
+            /* Codes_SRS_UWS_CLIENT_01_236: [ If there is a body, the first two bytes of the body MUST be a 2-byte unsigned integer (in network byte order) representing a status code with value /code/ defined in Section 7.4. ]*/
+            close_code = (data_ptr[0] << 8) + data_ptr[1];
+
+            /* Codes_SRS_UWS_CLIENT_01_461: [ The argument `close_code` shall be set to point to the code extracted from the CLOSE frame. ]*/
+            close_code_ptr = &close_code;
+        }
+        else
+        {
+            /* Codes_SRS_UWS_CLIENT_01_462: [ If no code can be extracted then `close_code` shall be NULL. ]*/
+            close_code_ptr = NULL;
+        }
+
+        if (length > 2)
+        {
+            /* Codes_SRS_UWS_CLIENT_01_463: [ The extra bytes (besides the close code) shall be passed to the `on_ws_peer_closed` callback by using `extra_data` and `extra_data_length`. ]*/
+            extra_data_ptr = data_ptr + 2;
+            extra_data_length = length - 2;
+
+            /* Codes_SRS_UWS_CLIENT_01_238: [ As the data is not guaranteed to be human readable, clients MUST NOT show it to end users. ]*/
+            /* Codes_SRS_UWS_CLIENT_01_237: [ Following the 2-byte integer, the body MAY contain UTF-8-encoded data with value /reason/, the interpretation of which is not defined by this specification. ]*/
+            if (utf8_checker_is_valid_utf8(extra_data_ptr, extra_data_length) != true)
+            {
+                LogError("Reason in CLOSE frame is not UTF-8.");
+                extra_data_ptr = NULL;
+                extra_data_length = 0;
+                utf8_error = true;
+            }
+        }
+        else
+        {
+            extra_data_ptr = NULL;
+            extra_data_length = 0;
+        }
+
+        if (utf8_error)
+        {
+            uws_client->uws_state = UWS_STATE_CLOSING_UNDERLYING_IO;
+            if (xio_close(uws_client->underlying_io, on_underlying_io_close_complete, uws_client) != 0)
+            {
+                LogError("Could not close underlying IO");
+                indicate_ws_error(uws_client, WS_ERROR_CANNOT_CLOSE_UNDERLYING_IO);
+                uws_client->uws_state = UWS_STATE_CLOSED;
+            }
+        }
+        else
+        {
+            BUFFER_HANDLE close_frame_buffer;
+
+            if (uws_client->uws_state == UWS_STATE_CLOSING_WAITING_FOR_CLOSE)
+            {
+                uws_client->uws_state = UWS_STATE_CLOSING_UNDERLYING_IO;
+                if (xio_close(uws_client->underlying_io, on_underlying_io_close_complete, uws_client) != 0)
+                {
+                    indicate_ws_close_complete(uws_client);
+                    uws_client->uws_state = UWS_STATE_CLOSED;
+                }
+            }
+            else
+            {
+                /* Codes_SRS_UWS_CLIENT_01_296: [ Upon either sending or receiving a Close control frame, it is said that _The WebSocket Closing Handshake is Started_ and that the WebSocket connection is in the CLOSING state. ]*/
+                /* Codes_SRS_UWS_CLIENT_01_240: [ The application MUST NOT send any more data frames after sending a Close frame. ]*/
+                uws_client->uws_state = UWS_STATE_CLOSING_SENDING_CLOSE;
+            }
+
+            /* Codes_SRS_UWS_CLIENT_01_241: [ If an endpoint receives a Close frame and did not previously send a Close frame, the endpoint MUST send a Close frame in response. ]*/
+            /* Codes_SRS_UWS_CLIENT_01_242: [ It SHOULD do so as soon as practical. ]*/
+            /* Codes_SRS_UWS_CLIENT_01_239: [ Close frames sent from client to server must be masked as per Section 5.3. ]*/
+            /* Codes_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
+            close_frame_buffer = uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0);
+            if (close_frame_buffer == NULL)
+            {
+                LogError("Cannot encode the response CLOSE frame");
+
+                /* Codes_SRS_UWS_CLIENT_01_288: [ To _Close the WebSocket Connection_, an endpoint closes the underlying TCP connection. ]*/
+                /* Codes_SRS_UWS_CLIENT_01_290: [ An endpoint MAY close the connection via any means available when necessary, such as when under attack. ]*/
+                uws_client->uws_state = UWS_STATE_CLOSING_UNDERLYING_IO;
+                if (xio_close(uws_client->underlying_io, on_underlying_io_close_complete, uws_client) != 0)
+                {
+                    indicate_ws_error(uws_client, WS_ERROR_CANNOT_CLOSE_UNDERLYING_IO);
+                    uws_client->uws_state = UWS_STATE_CLOSED;
+                }
+            }
+            else
+            {
+                close_frame_bytes = BUFFER_u_char(close_frame_buffer);
+                close_frame_length = BUFFER_length(close_frame_buffer);
+                if (xio_send(uws_client->underlying_io, close_frame_bytes, close_frame_length, on_underlying_io_close_sent, uws_client) != 0)
+                {
+                    LogError("Cannot send the response CLOSE frame");
+
+                    /* Codes_SRS_UWS_CLIENT_01_288: [ To _Close the WebSocket Connection_, an endpoint closes the underlying TCP connection. ]*/
+                    /* Codes_SRS_UWS_CLIENT_01_290: [ An endpoint MAY close the connection via any means available when necessary, such as when under attack. ]*/
+                    uws_client->uws_state = UWS_STATE_CLOSING_UNDERLYING_IO;
+                    if (xio_close(uws_client->underlying_io, on_underlying_io_close_complete, uws_client) != 0)
+                    {
+                        indicate_ws_error(uws_client, WS_ERROR_CANNOT_CLOSE_UNDERLYING_IO);
+                        uws_client->uws_state = UWS_STATE_CLOSED;
+                    }
+                }
+
+                BUFFER_delete(close_frame_buffer);
+            }
+        }
+
+        /* Codes_SRS_UWS_CLIENT_01_460: [ When a CLOSE frame is received the callback `on_ws_peer_closed` passed to `uws_client_open_async` shall be called, while passing to it the argument `on_ws_peer_closed_context`. ]*/
+        uws_client->on_ws_peer_closed(uws_client->on_ws_peer_closed_context, close_code_ptr, extra_data_ptr, extra_data_length);
+
+        break;
+    }
+
+        /* Codes_SRS_UWS_CLIENT_01_157: [ *  %x9 denotes a ping ]*/
+        /* Codes_SRS_UWS_CLIENT_01_247: [ The Ping frame contains an opcode of 0x9. ]*/
+        /* Codes_SRS_UWS_CLIENT_01_251: [ An endpoint MAY send a Ping frame any time after the connection is established and before the connection is closed. ]*/
+    case (unsigned char)WS_PING_FRAME:
+    {
+        /* Codes_SRS_UWS_CLIENT_01_249: [ Upon receipt of a Ping frame, an endpoint MUST send a Pong frame in response ]*/
+        /* Codes_SRS_UWS_CLIENT_01_250: [ It SHOULD respond with Pong frame as soon as is practical. ]*/
+        unsigned char* pong_frame;
+        size_t pong_frame_length;
+        BUFFER_HANDLE pong_frame_buffer;
+
+        uws_client->uws_state = UWS_STATE_ERROR;
+
+        /* Codes_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
+        pong_frame_buffer = uws_frame_encoder_encode(WS_PONG_FRAME, data_ptr, length, true, true, 0);
+        if (pong_frame_buffer == NULL)
+        {
+            LogError("Encoding of PONG failed.");
+        }
+        else
+        {
+            /* Codes_SRS_UWS_CLIENT_01_248: [ A Ping frame MAY include "Application data". ]*/
+            pong_frame = BUFFER_u_char(pong_frame_buffer);
+            pong_frame_length = BUFFER_length(pong_frame_buffer);
+            if (xio_send(uws_client->underlying_io, pong_frame, pong_frame_length, unchecked_on_send_complete, NULL) != 0)
+            {
+                LogError("Sending CLOSE frame failed.");
+            }
+
+            BUFFER_delete(pong_frame_buffer);
+        }
+
+        break;
+    }
+    /* Codes_SRS_UWS_CLIENT_01_252: [ The Pong frame contains an opcode of 0xA. ]*/
+    case (unsigned char)WS_PONG_FRAME:
+        break;
+    }
+}
+
+/* The fragments of a text message are validated as one text, a fragment can end in the middle of a character. */
+static bool is_text_message_frame(UWS_CLIENT_INSTANCE* uws_client, unsigned char opcode)
+{
+    return (opcode == (unsigned char)WS_TEXT_FRAME) ||
+        ((opcode == (unsigned char)WS_CONTINUATION_FRAME) && uws_client->text_message_in_progress);
+}
+
+/* Validates the text in a whole frame, payload_fed is true when its payload has been fed to the stream as it arrived. Returns false if the text is not UTF-8. */
+static bool validate_frame_text(UWS_CLIENT_INSTANCE* uws_client, const unsigned char* frame, size_t header_length, size_t length, bool payload_fed)
+{
+    bool result;
+    unsigned char opcode = frame[0] & 0xF;
+    bool is_final = ((frame[0] & 0x80) != 0);
+    bool is_text = is_text_message_frame(uws_client, opcode);
+
+    if (!is_text)
+    {
+        result = true;
+    }
+    else if ((opcode == (unsigned char)WS_TEXT_FRAME) && is_final && !payload_fed)
+    {
+        /* Codes_SRS_UWS_CLIENT_99_006: [ The payload of a text frame with the FIN bit set that is received whole shall be validated with `utf8_checker_is_valid_utf8` before it is indicated. ]*/
+        result = (length == 0) || utf8_checker_is_valid_utf8(frame + header_length, length);
+    }
+    else
+    {
+        /* Codes_SRS_UWS_CLIENT_99_009: [ The payloads of the text frame and of the continuation frames of a fragmented text message shall be validated as one text with `utf8_checker_stream_feed`, `utf8_checker_stream_end` shall be called once the frame with the FIN bit set has arrived. ]*/
+        if ((opcode == (unsigned char)WS_TEXT_FRAME) && !payload_fed)
+        {
+            utf8_checker_stream_init(&uws_client->utf8_stream);
+        }
+
+        result = (payload_fed || utf8_checker_stream_feed(&uws_client->utf8_stream, frame + header_length, length)) &&
+            (!is_final || utf8_checker_stream_end(&uws_client->utf8_stream));
+    }
+
+    /* control frames can come between the fragments of a message */
+    if ((opcode & 0x8) == 0)
+    {
+        uws_client->text_message_in_progress = is_text && !is_final && result;
+    }
+
+    return result;
+}
+
+static void reset_received_frame(UWS_CLIENT_INSTANCE* uws_client)
+{
+    uws_client->received_bytes_count = 0;
+    uws_client->utf8_checked_bytes = 0;
+    uws_client->frame_decoder_state = UWS_FRAME_DECODER_STATE_HEADER_AND_LENGTH;
+
+    /* Codes_SRS_UWS_CLIENT_99_005: [ Once a frame has been decoded, a receive buffer larger than 64 KiB shall be freed, smaller ones shall be kept for the next frames. ]*/
+    if (uws_client->received_bytes_size > UWS_CLIENT_BUFFER_KEEP_SIZE)
+    {
+        free(uws_client->received_bytes);
+        uws_client->received_bytes = NULL;
+        uws_client->received_bytes_size = 0;
+    }
+}
+
+/* Adds bytes to the frame kept from earlier calls, text payload bytes are validated as they are added. */
+static int append_frame_bytes(UWS_CLIENT_INSTANCE* uws_client, const unsigned char* bytes, size_t size, size_t header_length, size_t needed_bytes)
+{
+    int result;
+
+    if (needed_bytes > uws_client->received_bytes_size)
+    {
+        /* Codes_SRS_UWS_CLIENT_99_004: [ A frame that is not complete in the received bytes shall be kept in a receive buffer that is grown to the size of the frame once its header is known, only the bytes the frame still needs shall be copied into it. ]*/
+        size_t new_size = (uws_client->frame_decoder_state == UWS_FRAME_DECODER_STATE_PAYLOAD_BYTES) ? needed_bytes : UWS_FRAME_ENCODER_MAX_HEADER_SIZE;
+        unsigned char* new_received_bytes = (unsigned char*)realloc(uws_client->received_bytes, new_size);
+        if (new_received_bytes == NULL)
+        {
+            /* Codes_SRS_UWS_CLIENT_01_418: [ If allocating memory for the bytes accumulated for decoding WebSocket frames fails, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_NOT_ENOUGH_MEMORY`. ]*/
+            LogError("Cannot allocate memory for received data");
+            indicate_ws_error(uws_client, WS_ERROR_NOT_ENOUGH_MEMORY);
+            result = __FAILURE__;
+        }
+        else
+        {
+            uws_client->received_bytes = new_received_bytes;
+            uws_client->received_bytes_size = new_size;
+            result = 0;
+        }
+    }
+    else
+    {
+        result = 0;
+    }
+
+    if (result == 0)
+    {
+        (void)memcpy(uws_client->received_bytes + uws_client->received_bytes_count, bytes, size);
+        uws_client->received_bytes_count += size;
+
+        if ((uws_client->frame_decoder_state == UWS_FRAME_DECODER_STATE_PAYLOAD_BYTES) &&
+            is_text_message_frame(uws_client, uws_client->received_bytes[0] & 0xF))
+        {
+            /* Codes_SRS_UWS_CLIENT_99_007: [ The payload of a text frame that arrives in pieces shall be validated with `utf8_checker_stream_feed` as each piece arrives. ]*/
+            if (uws_client->utf8_checked_bytes == 0)
+            {
+                /* a continuation frame goes on with the stream of its message */
+                if ((uws_client->received_bytes[0] & 0xF) == (unsigned char)WS_TEXT_FRAME)
+                {
+                    utf8_checker_stream_init(&uws_client->utf8_stream);
+                }
+                uws_client->utf8_checked_bytes = header_length;
+            }
+
+            if (utf8_checker_stream_feed(&uws_client->utf8_stream, uws_client->received_bytes + uws_client->utf8_checked_bytes, uws_client->received_bytes_count - uws_client->utf8_checked_bytes) != true)
+            {
+                /* Codes_SRS_UWS_CLIENT_99_008: [ If the payload of a text frame is not valid UTF-8, uws shall fail the WebSocket connection by calling `on_ws_error` with `WS_ERROR_BAD_FRAME_RECEIVED` and closing with status code 1007. ]*/
+                LogError("Text frame payload is not UTF-8");
+                indicate_ws_error_and_close(uws_client, WS_ERROR_BAD_FRAME_RECEIVED, 1007);
+                result = __FAILURE__;
+            }
+            else
+            {
+                uws_client->utf8_checked_bytes = uws_client->received_bytes_count;
+            }
+        }
+    }
+
+    return result;
+}
+
+/* Decodes the frames in bytes, in place when they are whole, and keeps the start of a frame that continues in the next bytes. */
+static void decode_frames(UWS_CLIENT_INSTANCE* uws_client, const unsigned char* bytes, size_t size)
+{
+    bool decode_stream = true;
+
+    while (decode_stream &&
+        (size > 0) &&
+        ((uws_client->uws_state == UWS_STATE_OPEN) || (uws_client->uws_state == UWS_STATE_CLOSING_WAITING_FOR_CLOSE)))
+    {
+        size_t header_length;
+        size_t length;
+        FRAME_HEADER_RESULT header_result;
+        bool decoded_in_place = false;
+
+        if (uws_client->received_bytes_count == 0)
+        {
+            header_result = decode_frame_header(uws_client, bytes, size, &header_length, &length);
+            if (header_result == FRAME_HEADER_BAD)
+            {
+                decode_stream = false;
+            }
+            else if ((header_result == FRAME_HEADER_COMPLETE) &&
+                (size - header_length >= length))
+            {
+                /* Codes_SRS_UWS_CLIENT_99_003: [ A frame that is whole in the bytes received from the underlying IO shall be decoded in place, without copying it. ]*/
+                const unsigned char* frame = bytes;
+
+                bytes += header_length + length;
+                size -= header_length + length;
+                uws_client->frame_decoder_state = UWS_FRAME_DECODER_STATE_HEADER_AND_LENGTH;
+                decoded_in_place = true;
+
+                if (!validate_frame_text(uws_client, frame, header_length, length, false))
+                {
+                    /* Codes_SRS_UWS_CLIENT_99_008: [ If the payload of a text frame is not valid UTF-8, uws shall fail the WebSocket connection by calling `on_ws_error` with `WS_ERROR_BAD_FRAME_RECEIVED` and closing with status code 1007. ]*/
+                    LogError("Text frame payload is not UTF-8");
+                    indicate_ws_error_and_close(uws_client, WS_ERROR_BAD_FRAME_RECEIVED, 1007);
+                    decode_stream = false;
+                }
+                else
+                {
+                    decode_frame(uws_client, frame, header_length, length);
+                }
+            }
+        }
+
+        if (decode_stream && !decoded_in_place)
+        {
+            /* Codes_SRS_UWS_CLIENT_99_004: [ A frame that is not complete in the received bytes shall be kept in a receive buffer that is grown to the size of the frame once its header is known, only the bytes the frame still needs shall be copied into it. ]*/
+            size_t needed_bytes;
+            size_t taken_bytes;
+
+            header_result = decode_frame_header(uws_client, uws_client->received_bytes, uws_client->received_bytes_count, &header_length, &length);
+            needed_bytes = (header_result == FRAME_HEADER_COMPLETE) ? header_length + length : header_length;
+            taken_bytes = needed_bytes - uws_client->received_bytes_count;
+            if (taken_bytes > size)
+            {
+                taken_bytes = size;
+            }
+
+            if (append_frame_bytes(uws_client, bytes, taken_bytes, header_length, needed_bytes) != 0)
+            {
+                reset_received_frame(uws_client);
+                decode_stream = false;
+            }
+            else
+            {
+                bytes += taken_bytes;
+                size -= taken_bytes;
+
+                /* the header may have been completed by the bytes just added */
+                header_result = decode_frame_header(uws_client, uws_client->received_bytes, uws_client->received_bytes_count, &header_length, &length);
+                if (header_result == FRAME_HEADER_BAD)
+                {
+                    reset_received_frame(uws_client);
+                    decode_stream = false;
+                }
+                else if ((header_result == FRAME_HEADER_COMPLETE) &&
+                    (uws_client->received_bytes_count == header_length + length))
+                {
+                    if (!validate_frame_text(uws_client, uws_client->received_bytes, header_length, length, uws_client->utf8_checked_bytes != 0))
+                    {
+                        /* Codes_SRS_UWS_CLIENT_99_008: [ If the payload of a text frame is not valid UTF-8, uws shall fail the WebSocket connection by calling `on_ws_error` with `WS_ERROR_BAD_FRAME_RECEIVED` and closing with status code 1007. ]*/
+                        LogError("Text frame payload is not UTF-8");
+                        reset_received_frame(uws_client);
+                        indicate_ws_error_and_close(uws_client, WS_ERROR_BAD_FRAME_RECEIVED, 1007);
+                        decode_stream = false;
+                    }
+                    else
+                    {
+                        decode_frame(uws_client, uws_client->received_bytes, header_length, length);
+                        reset_received_frame(uws_client);
+                    }
+                }
+                else
+                {
+                    /* wait for the rest of the frame */
+                }
+            }
+        }
+    }
+}
+
 static void on_underlying_io_bytes_received(void* context, const unsigned char* buffer, size_t size)
 {
     /* Codes_SRS_UWS_CLIENT_01_415: [ If called with a NULL `context` argument, `on_underlying_io_bytes_received` shall do nothing. ]*/
@@ -959,19 +1534,15 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
         }
         else
         {
-            unsigned char decode_stream = 1;
-
             switch (uws_client->uws_state)
             {
             default:
             case UWS_STATE_CLOSED:
-                decode_stream = 0;
                 break;
 
             case UWS_STATE_OPENING_UNDERLYING_IO:
                 /* Codes_SRS_UWS_CLIENT_01_417: [ When `on_underlying_io_bytes_received` is called while OPENING but before the `on_underlying_io_open_complete` has been called, uws shall report that the open failed by calling the `on_ws_open_complete` callback passed to `uws_client_open_async` with `WS_OPEN_ERROR_BYTES_RECEIVED_BEFORE_UNDERLYING_OPEN`. ]*/
                 indicate_ws_open_complete_error_and_close(uws_client, WS_OPEN_ERROR_BYTES_RECEIVED_BEFORE_UNDERLYING_OPEN);
-                decode_stream = 0;
                 break;
 
             case UWS_STATE_WAITING_FOR_UPGRADE_RESPONSE:
@@ -982,64 +1553,15 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                 {
                     /* Codes_SRS_UWS_CLIENT_01_379: [ If allocating memory for accumulating the bytes fails, uws shall report that the open failed by calling the `on_ws_open_complete` callback passed to `uws_client_open_async` with `WS_OPEN_ERROR_NOT_ENOUGH_MEMORY`. ]*/
                     indicate_ws_open_complete_error_and_close(uws_client, WS_OPEN_ERROR_NOT_ENOUGH_MEMORY);
-                    decode_stream = 0;
                 }
                 else
                 {
-                    uws_client->received_bytes = new_received_bytes;
-                    (void)memcpy(uws_client->received_bytes + uws_client->received_bytes_count, buffer, size);
-                    uws_client->received_bytes_count += size;
-
-                    decode_stream = 1;
-                }
-
-                break;
-            }
-
-            case UWS_STATE_OPEN:
-            case UWS_STATE_CLOSING_WAITING_FOR_CLOSE:
-            {
-                /* Codes_SRS_UWS_CLIENT_01_385: [ If the state of the uws instance is OPEN, the received bytes shall be used for decoding WebSocket frames. ]*/
-                unsigned char* new_received_bytes = (unsigned char*)realloc(uws_client->received_bytes, uws_client->received_bytes_count + size + 1);
-                if (new_received_bytes == NULL)
-                {
-                    /* Codes_SRS_UWS_CLIENT_01_418: [ If allocating memory for the bytes accumulated for decoding WebSocket frames fails, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_NOT_ENOUGH_MEMORY`. ]*/
-                    LogError("Cannot allocate memory for received data");
-                    indicate_ws_error(uws_client, WS_ERROR_NOT_ENOUGH_MEMORY);
+                    const char* request_end_ptr;
 
-                    decode_stream = 0;
-                }
-                else
-                {
                     uws_client->received_bytes = new_received_bytes;
+                    uws_client->received_bytes_size = uws_client->received_bytes_count + size + 1;
                     (void)memcpy(uws_client->received_bytes + uws_client->received_bytes_count, buffer, size);
                     uws_client->received_bytes_count += size;
-                
-                    decode_stream = 1;
-                }
-
-                break;
-            }
-            }
-
-            while (decode_stream)
-            {
-                decode_stream = 0;
-
-                switch (uws_client->uws_state)
-                {
-                default:
-                case UWS_STATE_CLOSED:
-                    break;
-
-                case UWS_STATE_OPENING_UNDERLYING_IO:
-                    /* Codes_SRS_UWS_CLIENT_01_417: [ When `on_underlying_io_bytes_received` is called while OPENING but before the `on_underlying_io_open_complete` has been called, uws shall report that the open failed by calling the `on_ws_open_complete` callback passed to `uws_client_open_async` with `WS_OPEN_ERROR_BYTES_RECEIVED_BEFORE_UNDERLYING_OPEN`. ]*/
-                    indicate_ws_open_complete_error_and_close(uws_client, WS_OPEN_ERROR_BYTES_RECEIVED_BEFORE_UNDERLYING_OPEN);
-                    break;
-
-                case UWS_STATE_WAITING_FOR_UPGRADE_RESPONSE:
-                {
-                    const char* request_end_ptr;
 
                     /* Make sure it is zero terminated */
                     uws_client->received_bytes[uws_client->received_bytes_count] = '\0';
@@ -1070,8 +1592,11 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                         }
                         else
                         {
-                            /* Codes_SRS_UWS_CLIENT_01_384: [ Any extra bytes that are left unconsumed after decoding a succesfull WebSocket upgrade response shall be used for decoding WebSocket frames ]*/
-                            consume_received_bytes(uws_client, request_end_ptr - (char*)uws_client->received_bytes + 4);
+                            size_t response_length = request_end_ptr - (char*)uws_client->received_bytes + 4;
+                            unsigned char* handshake_bytes = uws_client->received_bytes;
+                            size_t handshake_bytes_count = uws_client->received_bytes_count;
+
+                            uws_client->received_bytes_count = 0;
 
                             /* Codes_SRS_UWS_CLIENT_01_381: [ If the status is 101, uws shall be considered OPEN and this shall be indicated by calling the `on_ws_open_complete` callback passed to `uws_client_open_async` with `IO_OPEN_OK`. ]*/
                             uws_client->uws_state = UWS_STATE_OPEN;
@@ -1080,317 +1605,28 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                             /* Codes_SRS_UWS_CLIENT_01_115: [ If the server's response is validated as provided for above, it is said that _The WebSocket Connection is Established_ and that the WebSocket Connection is in the OPEN state. ]*/
                             uws_client->on_ws_open_complete(uws_client->on_ws_open_complete_context, WS_OPEN_OK);
 
-                            decode_stream = 1;
-                        }
-                    }
-
-                    break;
-                }
-
-                case UWS_STATE_OPEN:
-                case UWS_STATE_CLOSING_WAITING_FOR_CLOSE:
-                {
-                    size_t needed_bytes = 2;
-                    size_t length;
-
-                    /* Codes_SRS_UWS_CLIENT_01_277: [ To receive WebSocket data, an endpoint listens on the underlying network connection. ]*/
-                    /* Codes_SRS_UWS_CLIENT_01_278: [ Incoming data MUST be parsed as WebSocket frames as defined in Section 5.2. ]*/
-                    if (uws_client->received_bytes_count >= needed_bytes)
-                    {
-                        unsigned char has_error = 0;
-
-                        /* Codes_SRS_UWS_CLIENT_01_160: [ Defines whether the "Payload data" is masked. ]*/
-                        if ((uws_client->received_bytes[1] & 0x80) != 0)
-                        {
-                            /* Codes_SRS_UWS_CLIENT_01_144: [ A client MUST close a connection if it detects a masked frame. ]*/
-                            /* Codes_SRS_UWS_CLIENT_01_145: [ In this case, it MAY use the status code 1002 (protocol error) as defined in Section 7.4.1. (These rules might be relaxed in a future specification.) ]*/
-                            LogError("Masked frame detected by WebSocket client");
-                            indicate_ws_error_and_close(uws_client, WS_ERROR_BAD_FRAME_RECEIVED, 1002);
-                        }
-
-                        /* Codes_SRS_UWS_CLIENT_01_163: [ The length of the "Payload data", in bytes: ]*/
-                        /* Codes_SRS_UWS_CLIENT_01_164: [ if 0-125, that is the payload length. ]*/
-                        length = uws_client->received_bytes[1];
-
-                        if (length == 126)
-                        {
-                            /* Codes_SRS_UWS_CLIENT_01_165: [ If 126, the following 2 bytes interpreted as a 16-bit unsigned integer are the payload length. ]*/
-                            needed_bytes += 2;
-                            if (uws_client->received_bytes_count >= needed_bytes)
+                            if (handshake_bytes_count > response_length)
                             {
-                                /* Codes_SRS_UWS_CLIENT_01_167: [ Multibyte length quantities are expressed in network byte order. ]*/
-                                length = ((size_t)(uws_client->received_bytes[2]) << 8) + (size_t)uws_client->received_bytes[3];
-
-                                if (length < 126)
-                                {
-                                    /* Codes_SRS_UWS_CLIENT_01_168: [ Note that in all cases, the minimal number of bytes MUST be used to encode the length, for example, the length of a 124-byte-long string can't be encoded as the sequence 126, 0, 124. ]*/
-                                    LogError("Bad frame: received a %u length on the 16 bit length", (unsigned int)length);
+                                /* Codes_SRS_UWS_CLIENT_01_384: [ Any extra bytes that are left unconsumed after decoding a succesfull WebSocket upgrade response shall be used for decoding WebSocket frames ]*/
+                                /* the handshake buffer is handed over so that decoding can keep a frame in a buffer of its own */
+                                uws_client->received_bytes = NULL;
+                                uws_client->received_bytes_size = 0;
 
-                                    /* Codes_SRS_UWS_CLIENT_01_419: [ If there is an error decoding the WebSocket frame, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_BAD_FRAME_RECEIVED`. ]*/
-                                    indicate_ws_error(uws_client, WS_ERROR_BAD_FRAME_RECEIVED);
-                                    has_error = 1;
-                                }
-                                else
-                                {
-                                    needed_bytes += (size_t)length;
-                                }
+                                decode_frames(uws_client, handshake_bytes + response_length, handshake_bytes_count - response_length);
+                                free(handshake_bytes);
                             }
                         }
-                        else if (length == 127)
-                        {
-                            /* Codes_SRS_UWS_CLIENT_01_166: [ If 127, the following 8 bytes interpreted as a 64-bit unsigned integer (the most significant bit MUST be 0) are the payload length. ]*/
-                            needed_bytes += 8;
-                            if (uws_client->received_bytes_count >= needed_bytes)
-                            {
-                                if ((uws_client->received_bytes[2] & 0x80) != 0)
-                                {
-                                    LogError("Bad frame: received a 64 bit length frame with the highest bit set");
-
-                                    /* Codes_SRS_UWS_CLIENT_01_419: [ If there is an error decoding the WebSocket frame, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_BAD_FRAME_RECEIVED`. ]*/
-                                    indicate_ws_error(uws_client, WS_ERROR_BAD_FRAME_RECEIVED);
-                                    has_error = 1;
-                                }
-                                else
-                                {
-                                    /* Codes_SRS_UWS_CLIENT_01_167: [ Multibyte length quantities are expressed in network byte order. ]*/
-                                    length = (size_t)(((uint64_t)(uws_client->received_bytes[2]) << 56) +
-                                        (((uint64_t)uws_client->received_bytes[3]) << 48) +
-                                        (((uint64_t)uws_client->received_bytes[4]) << 40) +
-                                        (((uint64_t)uws_client->received_bytes[5]) << 32) +
-                                        (((uint64_t)uws_client->received_bytes[6]) << 24) +
-                                        (((uint64_t)uws_client->received_bytes[7]) << 16) +
-                                        (((uint64_t)uws_client->received_bytes[8]) << 8) +
-                                        (uint64_t)(uws_client->received_bytes[9]));
-
-                                    if (length < 65536)
-                                    {
-                                        /* Codes_SRS_UWS_CLIENT_01_168: [ Note that in all cases, the minimal number of bytes MUST be used to encode the length, for example, the length of a 124-byte-long string can't be encoded as the sequence 126, 0, 124. ]*/
-                                        LogError("Bad frame: received a %u length on the 64 bit length", (unsigned int)length);
-
-                                        /* Codes_SRS_UWS_CLIENT_01_419: [ If there is an error decoding the WebSocket frame, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_BAD_FRAME_RECEIVED`. ]*/
-                                        indicate_ws_error(uws_client, WS_ERROR_BAD_FRAME_RECEIVED);
-                                        has_error = 1;
-                                    }
-                                    else
-                                    {
-                                        needed_bytes += length;
-                                    }
-                                }
-                            }
-                        }
-                        else
-                        {
-                            needed_bytes += length;
-                        }
-
-                        if ((has_error == 0) &&
-                            (uws_client->received_bytes_count >= needed_bytes))
-                        {
-                            unsigned char opcode = uws_client->received_bytes[0] & 0xF;
-
-                            switch (opcode)
-                            {
-                            default:
-                                break;
-
-                                /* Codes_SRS_UWS_CLIENT_01_153: [ *  %x1 denotes a text frame ]*/
-                                /* Codes_SRS_UWS_CLIENT_01_258: [** Currently defined opcodes for data frames include 0x1 (Text), 0x2 (Binary). ]*/
-                            case (unsigned char)WS_TEXT_FRAME:
-                                /* Codes_SRS_UWS_CLIENT_01_386: [ When a WebSocket data frame is decoded succesfully it shall be indicated via the callback `on_ws_frame_received`. ]*/
-                                /* Codes_SRS_UWS_CLIENT_01_169: [ The payload length is the length of the "Extension data" + the length of the "Application data". ]*/
-                                /* Codes_SRS_UWS_CLIENT_01_173: [ The "Payload data" is defined as "Extension data" concatenated with "Application data". ]*/
-                                /* Codes_SRS_UWS_CLIENT_01_280: [ Upon receiving a data frame (Section 5.6), the endpoint MUST note the /type/ of the data as defined by the opcode (frame-opcode) from Section 5.2. ]*/
-                                /* Codes_SRS_UWS_CLIENT_01_281: [ The "Application data" from this frame is defined as the /data/ of the message. ]*/
-                                /* Codes_SRS_UWS_CLIENT_01_282: [ If the frame comprises an unfragmented message (Section 5.4), it is said that _A WebSocket Message Has Been Received_ with type /type/ and data /data/. ]*/
-                                uws_client->on_ws_frame_received(uws_client->on_ws_frame_received_context, WS_FRAME_TYPE_TEXT, uws_client->received_bytes + needed_bytes - length, length);
-                                decode_stream = 1;
-                                break;
-
-                                /* Codes_SRS_UWS_CLIENT_01_154: [ *  %x2 denotes a binary frame ]*/
-                            case (unsigned char)WS_BINARY_FRAME:
-                                /* Codes_SRS_UWS_CLIENT_01_386: [ When a WebSocket data frame is decoded succesfully it shall be indicated via the callback `on_ws_frame_received`. ]*/
-                                /* Codes_SRS_UWS_CLIENT_01_169: [ The payload length is the length of the "Extension data" + the length of the "Application data". ]*/
-                                /* Codes_SRS_UWS_CLIENT_01_173: [ The "Payload data" is defined as "Extension data" concatenated with "Application data". ]*/
-                                /* Codes_SRS_UWS_CLIENT_01_264: [ The "Payload data" is arbitrary binary data whose interpretation is solely up to the application layer. ]*/
-                                /* Codes_SRS_UWS_CLIENT_01_280: [ Upon receiving a data frame (Section 5.6), the endpoint MUST note the /type/ of the data as defined by the opcode (frame-opcode) from Section 5.2. ]*/
-                                /* Codes_SRS_UWS_CLIENT_01_281: [ The "Application data" from this frame is defined as the /data/ of the message. ]*/
-                                /* Codes_SRS_UWS_CLIENT_01_282: [ If the frame comprises an unfragmented message (Section 5.4), it is said that _A WebSocket Message Has Been Received_ with type /type/ and data /data/. ]*/
-                                uws_client->on_ws_frame_received(uws_client->on_ws_frame_received_context, WS_FRAME_TYPE_BINARY, uws_client->received_bytes + needed_bytes - length, length);
-                                decode_stream = 1;
-                                break;
-
-                                /* Codes_SRS_UWS_CLIENT_01_156: [ *  %x8 denotes a connection close ]*/
-                                /* Codes_SRS_UWS_CLIENT_01_234: [ The Close frame contains an opcode of 0x8. ]*/
-                            case (unsigned char)WS_CLOSE_FRAME:
-                            {
-                                uint16_t close_code;
-                                uint16_t* close_code_ptr;
-                                const unsigned char* data_ptr = uws_client->received_bytes + needed_bytes - length;
-                                const unsigned char* extra_data_ptr;
-                                size_t extra_data_length;
-                                unsigned char* close_frame_bytes;
-                                size_t close_frame_length;
-                                bool utf8_error = false;
-
-                                /* Codes_SRS_UWS_CLIENT_01_235: [ The Close frame MAY contain a body (the "Application data" portion of the frame) that indicates a reason for closing, such as an endpoint shutting down, an endpoint having received a frame too large, or an endpoint having received a frame that does not conform to the format expected by the endpoint. ]*/
-                                if (length >= 2)
-                                {
-                                    /* Codes_SRS_UWS_CLIENT_01_236: [ If there is a body, the first two bytes of the body MUST be a 2-byte unsigned integer (in network byte order) representing a status code with value /code/ defined in Section 7.4. ]*/
-                                    close_code = (data_ptr[0] << 8) + data_ptr[1];
-
-                                    /* Codes_SRS_UWS_CLIENT_01_461: [ The argument `close_code` shall be set to point to the code extracted from the CLOSE frame. ]*/
-                                    close_code_ptr = &close_code;
-                                }
-                                else
-                                {
-                                    /* Codes_SRS_UWS_CLIENT_01_462: [ If no code can be extracted then `close_code` shall be NULL. ]*/
-                                    close_code_ptr = NULL;
-                                }
-
-                                if (length > 2)
-                                {
-                                    /* Codes_SRS_UWS_CLIENT_01_463: [ The extra bytes (besides the close code) shall be passed to the `on_ws_peer_closed` callback by using `extra_data` and `extra_data_length`. ]*/
-                                    extra_data_ptr = data_ptr + 2;
-                                    extra_data_length = length - 2;
-
-                                    /* Codes_SRS_UWS_CLIENT_01_238: [ As the data is not guaranteed to be human readable, clients MUST NOT show it to end users. ]*/
-                                    /* Codes_SRS_UWS_CLIENT_01_237: [ Following the 2-byte integer, the body MAY contain UTF-8-encoded data with value /reason/, the interpretation of which is not defined by this specification. ]*/
-                                    if (utf8_checker_is_valid_utf8(extra_data_ptr, extra_data_length) != true)
-                                    {
-                                        LogError("Reason in CLOSE frame is not UTF-8.");
-                                        extra_data_ptr = NULL;
-                                        extra_data_length = 0;
-                                        utf8_error = true;
-                                    }
-                                }
-                                else
-                                {
-                                    extra_data_ptr = NULL;
-                                    extra_data_length = 0;
-                                }
-
-                                if (utf8_error)
-                                {
-                                    uws_client->uws_state = UWS_STATE_CLOSING_UNDERLYING_IO;
-                                    if (xio_close(uws_client->underlying_io, on_underlying_io_close_complete, uws_client) != 0)
-                                    {
-                                        LogError("Could not close underlying IO");
-                                        indicate_ws_error(uws_client, WS_ERROR_CANNOT_CLOSE_UNDERLYING_IO);
-                                        uws_client->uws_state = UWS_STATE_CLOSED;
-                                    }
-                                }
-                                else
-                                {
-                                    BUFFER_HANDLE close_frame_buffer;
-
-                                    if (uws_client->uws_state == UWS_STATE_CLOSING_WAITING_FOR_CLOSE)
-                                    {
-                                        uws_client->uws_state = UWS_STATE_CLOSING_UNDERLYING_IO;
-                                        if (xio_close(uws_client->underlying_io, on_underlying_io_close_complete, uws_client) != 0)
-                                        {
-                                            indicate_ws_close_complete(uws_client);
-                                            uws_client->uws_state = UWS_STATE_CLOSED;
-                                        }
-                                    }
-                                    else
-                                    {
-                                        /* Codes_SRS_UWS_CLIENT_01_296: [ Upon either sending or receiving a Close control frame, it is said that _The WebSocket Closing Handshake is Started_ and that the WebSocket connection is in the CLOSING state. ]*/
-                                        /* Codes_SRS_UWS_CLIENT_01_240: [ The application MUST NOT send any more data frames after sending a Close frame. ]*/
-                                        uws_client->uws_state = UWS_STATE_CLOSING_SENDING_CLOSE;
-                                    }
-
-                                    /* Codes_SRS_UWS_CLIENT_01_241: [ If an endpoint receives a Close frame and did not previously send a Close frame, the endpoint MUST send a Close frame in response. ]*/
-                                    /* Codes_SRS_UWS_CLIENT_01_242: [ It SHOULD do so as soon as practical. ]*/
-                                    /* Codes_SRS_UWS_CLIENT_01_239: [ Close frames sent from client to server must be masked as per Section 5.3. ]*/
-                                    /* Codes_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
-                                    close_frame_buffer = uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0);
-                                    if (close_frame_buffer == NULL)
-                                    {
-                                        LogError("Cannot encode the response CLOSE frame");
-
-                                        /* Codes_SRS_UWS_CLIENT_01_288: [ To _Close the WebSocket Connection_, an endpoint closes the underlying TCP connection. ]*/
-                                        /* Codes_SRS_UWS_CLIENT_01_290: [ An endpoint MAY close the connection via any means available when necessary, such as when under attack. ]*/
-                                        uws_client->uws_state = UWS_STATE_CLOSING_UNDERLYING_IO;
-                                        if (xio_close(uws_client->underlying_io, on_underlying_io_close_complete, uws_client) != 0)
-                                        {
-                                            indicate_ws_error(uws_client, WS_ERROR_CANNOT_CLOSE_UNDERLYING_IO);
-                                            uws_client->uws_state = UWS_STATE_CLOSED;
-                                        }
-                                    }
-                                    else
-                                    {
-                                        close_frame_bytes = BUFFER_u_char(close_frame_buffer);
-                                        close_frame_length = BUFFER_length(close_frame_buffer);
-                                        if (xio_send(uws_client->underlying_io, close_frame_bytes, close_frame_length, on_underlying_io_close_sent, uws_client) != 0)
-                                        {
-                                            LogError("Cannot send the response CLOSE frame");
-
-                                            /* Codes_SRS_UWS_CLIENT_01_288: [ To _Close the WebSocket Connection_, an endpoint closes the underlying TCP connection. ]*/
-                                            /* Codes_SRS_UWS_CLIENT_01_290: [ An endpoint MAY close the connection via any means available when necessary, such as when under attack. ]*/
-                                            uws_client->uws_state = UWS_STATE_CLOSING_UNDERLYING_IO;
-                                            if (xio_close(uws_client->underlying_io, on_underlying_io_close_complete, uws_client) != 0)
-                                            {
-                                                indicate_ws_error(uws_client, WS_ERROR_CANNOT_CLOSE_UNDERLYING_IO);
-                                                uws_client->uws_state = UWS_STATE_CLOSED;
-                                            }
-                                        }
-
-                                        BUFFER_delete(close_frame_buffer);
-                                    }
-                                }
-
-                                /* Codes_SRS_UWS_CLIENT_01_460: [ When a CLOSE frame is received the callback `on_ws_peer_closed` passed to `uws_client_open_async` shall be called, while passing to it the argument `on_ws_peer_closed_context`. ]*/
-                                uws_client->on_ws_peer_closed(uws_client->on_ws_peer_closed_context, close_code_ptr, extra_data_ptr, extra_data_length);
-
-                                break;
-                            }
-
-                                /* Codes_SRS_UWS_CLIENT_01_157: [ *  %x9 denotes a ping ]*/
-                                /* Codes_SRS_UWS_CLIENT_01_247: [ The Ping frame contains an opcode of 0x9. ]*/
-                                /* Codes_SRS_UWS_CLIENT_01_251: [ An endpoint MAY send a Ping frame any time after the connection is established and before the connection is closed. ]*/
-                            case (unsigned char)WS_PING_FRAME:
-                            {
-                                /* Codes_SRS_UWS_CLIENT_01_249: [ Upon receipt of a Ping frame, an endpoint MUST send a Pong frame in response ]*/
-                                /* Codes_SRS_UWS_CLIENT_01_250: [ It SHOULD respond with Pong frame as soon as is practical. ]*/
-                                unsigned char* pong_frame;
-                                size_t pong_frame_length;
-                                BUFFER_HANDLE pong_frame_buffer;
-
-                                uws_client->uws_state = UWS_STATE_ERROR;
-
-                                /* Codes_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
-                                pong_frame_buffer = uws_frame_encoder_encode(WS_PONG_FRAME, uws_client->received_bytes + needed_bytes - length, length, true, true, 0);
-                                if (pong_frame_buffer == NULL)
-                                {
-                                    LogError("Encoding of PONG failed.");
-                                }
-                                else
-                                {
-                                    /* Codes_SRS_UWS_CLIENT_01_248: [ A Ping frame MAY include "Application data". ]*/
-                                    pong_frame = BUFFER_u_char(pong_frame_buffer);
-                                    pong_frame_length = BUFFER_length(pong_frame_buffer);
-                                    if (xio_send(uws_client->underlying_io, pong_frame, pong_frame_length, unchecked_on_send_complete, NULL) != 0)
-                                    {
-                                        LogError("Sending CLOSE frame failed.");
-                                    }
-
-                                    BUFFER_delete(pong_frame_buffer);
-                                }
-
-                                break;
-                            }
-                            /* Codes_SRS_UWS_CLIENT_01_252: [ The Pong frame contains an opcode of 0xA. ]*/
-                            case (unsigned char)WS_PONG_FRAME:
-                                break;
-                            }
-
-                            consume_received_bytes(uws_client, needed_bytes);
-                        }
                     }
-
-                    break;
-                }
                 }
+
+                break;
+            }
+
+            case UWS_STATE_OPEN:
+            case UWS_STATE_CLOSING_WAITING_FOR_CLOSE:
+                /* Codes_SRS_UWS_CLIENT_01_385: [ If the state of the uws instance is OPEN, the received bytes shall be used for decoding WebSocket frames. ]*/
+                decode_frames(uws_client, buffer, size);
+                break;
             }
         }
     }
@@ -1462,6 +1698,9 @@ int uws_client_open_async(UWS_CLIENT_HANDLE uws_client, ON_WS_OPEN_COMPLETE on_w
             uws_client->uws_state = UWS_STATE_OPENING_UNDERLYING_IO;
 
             uws_client->received_bytes_count = 0;
+            uws_client->frame_decoder_state = UWS_FRAME_DECODER_STATE_HEADER_AND_LENGTH;
+            uws_client->utf8_checked_bytes = 0;
+            uws_client->text_message_in_progress = false;
 
             uws_client->on_ws_open_complete = on_ws_open_complete;
             uws_client->on_ws_open_complete_context = on_ws_open_complete_context;
@@ -1731,80 +1970,107 @@ int uws_client_send_frame_async(UWS_CLIENT_HANDLE uws_client, unsigned char fram
         }
         else
         {
-            BUFFER_HANDLE non_control_frame_buffer;
+            unsigned char header[UWS_FRAME_ENCODER_MAX_HEADER_SIZE];
+            size_t header_length;
 
-            /* Codes_SRS_UWS_CLIENT_01_425: [ Encoding shall be done by calling `uws_frame_encoder_encode` and passing to it the `buffer` and `size` argument for payload, the `is_final` flag and setting `is_masked` to true. ]*/
+            /* Codes_SRS_UWS_CLIENT_01_425: [ Encoding shall be done by calling `uws_frame_encoder_encode_header` with the `size` argument as payload length, the `is_final` flag and the mask generator of the uws instance, so that the frame is masked. ]*/
             /* Codes_SRS_UWS_CLIENT_01_270: [ An endpoint MUST encapsulate the /data/ in a WebSocket frame as defined in Section 5.2. ]*/
             /* Codes_SRS_UWS_CLIENT_01_272: [ The opcode (frame-opcode) of the first frame containing the data MUST be set to the appropriate value from Section 5.2 for data that is to be interpreted by the recipient as text or binary data. ]*/
             /* Codes_SRS_UWS_CLIENT_01_274: [ If the data is being sent by the client, the frame(s) MUST be masked as defined in Section 5.3. ]*/
-            non_control_frame_buffer = uws_frame_encoder_encode((WS_FRAME_TYPE)frame_type, buffer, size, true, is_final, 0);
-            if (non_control_frame_buffer == NULL)
+            if (uws_frame_encoder_encode_header(header, sizeof(header), (WS_FRAME_TYPE)frame_type, size, &uws_client->mask_generator, is_final, 0, &header_length) != 0)
             {
-                /* Codes_SRS_UWS_CLIENT_01_426: [ If `uws_frame_encoder_encode` fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
+                /* Codes_SRS_UWS_CLIENT_01_426: [ If `uws_frame_encoder_encode_header` fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
                 LogError("Failed encoding WebSocket frame");
                 free(ws_pending_send);
                 result = __FAILURE__;
             }
             else
             {
-                const unsigned char* encoded_frame;
-                size_t encoded_frame_length;
-                LIST_ITEM_HANDLE new_pending_send_list_item;
-
-                /* Codes_SRS_UWS_CLIENT_01_428: [ The encoded frame buffer memory shall be obtained by calling `BUFFER_u_char` on the encode buffer. ]*/
-                encoded_frame = BUFFER_u_char(non_control_frame_buffer);
-                /* Codes_SRS_UWS_CLIENT_01_429: [ The encoded frame size shall be obtained by calling `BUFFER_length` on the encode buffer. ]*/
-                encoded_frame_length = BUFFER_length(non_control_frame_buffer);
-
-                /* Codes_SRS_UWS_CLIENT_01_038: [ `uws_client_send_frame_async` shall create and queue a structure that contains: ]*/
-                /* Codes_SRS_UWS_CLIENT_01_050: [ The argument `on_ws_send_frame_complete` shall be optional, if NULL is passed by the caller then no send complete callback shall be triggered. ]*/
-                /* Codes_SRS_UWS_CLIENT_01_040: [ - the send complete callback `on_ws_send_frame_complete` ]*/
-                /* Codes_SRS_UWS_CLIENT_01_041: [ - the send complete callback context `on_ws_send_frame_complete_context` ]*/
-                ws_pending_send->on_ws_send_frame_complete = on_ws_send_frame_complete;
-                ws_pending_send->context = on_ws_send_frame_complete_context;
-                ws_pending_send->uws_client = uws_client;
-
-                /* Codes_SRS_UWS_CLIENT_01_048: [ Queueing shall be done by calling `singlylinkedlist_add`. ]*/
-                new_pending_send_list_item = singlylinkedlist_add(uws_client->pending_sends, ws_pending_send);
-                if (new_pending_send_list_item == NULL)
+                size_t encoded_frame_length = header_length + size;
+
+                if (encoded_frame_length > uws_client->send_buffer_size)
+                {
+                    /* Codes_SRS_UWS_CLIENT_01_428: [ The frame shall be encoded in a send buffer owned by the uws instance, which shall be grown with `realloc` when the frame does not fit in it. ]*/
+                    unsigned char* new_send_buffer = (unsigned char*)realloc(uws_client->send_buffer, encoded_frame_length);
+                    if (new_send_buffer != NULL)
+                    {
+                        uws_client->send_buffer = new_send_buffer;
+                        uws_client->send_buffer_size = encoded_frame_length;
+                    }
+                }
+
+                if (encoded_frame_length > uws_client->send_buffer_size)
                 {
-                    /* Codes_SRS_UWS_CLIENT_01_049: [ If `singlylinkedlist_add` fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
-                    LogError("Could not allocate memory for pending frames");
+                    /* Codes_SRS_UWS_CLIENT_01_429: [ If growing the send buffer fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
+                    LogError("Cannot allocate memory for encoded frame");
                     free(ws_pending_send);
                     result = __FAILURE__;
                 }
                 else
                 {
-                    /* Codes_SRS_UWS_CLIENT_01_431: [ Once encoded the frame shall be sent by using `xio_send` with the following arguments: ]*/
-                    /* Codes_SRS_UWS_CLIENT_01_053: [ - the io handle shall be the underlyiong IO handle created in `uws_client_create`. ]*/
-                    /* Codes_SRS_UWS_CLIENT_01_054: [ - the `buffer` argument shall point to the complete websocket frame to be sent. ]*/
-                    /* Codes_SRS_UWS_CLIENT_01_055: [ - the `size` argument shall indicate the websocket frame length. ]*/
-                    /* Codes_SRS_UWS_CLIENT_01_056: [ - the `send_complete` callback shall be the `on_underlying_io_send_complete` function. ]*/
-                    /* Codes_SRS_UWS_CLIENT_01_057: [ - the `send_complete_context` argument shall identify the pending send. ]*/
-                    /* Codes_SRS_UWS_CLIENT_01_276: [ The frame(s) that have been formed MUST be transmitted over the underlying network connection. ]*/
-                    if (xio_send(uws_client->underlying_io, encoded_frame, encoded_frame_length, on_underlying_io_send_complete, new_pending_send_list_item) != 0)
+                    LIST_ITEM_HANDLE new_pending_send_list_item;
+
+                    /* Codes_SRS_UWS_CLIENT_99_001: [ The payload shall be masked with the masking key that ends the header while it is copied after the header, by calling `uws_frame_encoder_mask`. ]*/
+                    (void)memcpy(uws_client->send_buffer, header, header_length);
+                    (void)uws_frame_encoder_mask(uws_client->send_buffer + header_length, buffer, size, header + header_length - 4);
+
+                    /* Codes_SRS_UWS_CLIENT_01_038: [ `uws_client_send_frame_async` shall create and queue a structure that contains: ]*/
+                    /* Codes_SRS_UWS_CLIENT_01_050: [ The argument `on_ws_send_frame_complete` shall be optional, if NULL is passed by the caller then no send complete callback shall be triggered. ]*/
+                    /* Codes_SRS_UWS_CLIENT_01_040: [ - the send complete callback `on_ws_send_frame_complete` ]*/
+                    /* Codes_SRS_UWS_CLIENT_01_041: [ - the send complete callback context `on_ws_send_frame_complete_context` ]*/
+                    ws_pending_send->on_ws_send_frame_complete = on_ws_send_frame_complete;
+                    ws_pending_send->context = on_ws_send_frame_complete_context;
+                    ws_pending_send->uws_client = uws_client;
+
+                    /* Codes_SRS_UWS_CLIENT_01_048: [ Queueing shall be done by calling `singlylinkedlist_add`. ]*/
+                    new_pending_send_list_item = singlylinkedlist_add(uws_client->pending_sends, ws_pending_send);
+                    if (new_pending_send_list_item == NULL)
                     {
-                        /* Codes_SRS_UWS_CLIENT_01_058: [ If `xio_send` fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
-                        LogError("Could not send bytes through the underlying IO");
-                        
-                        /* Codes_SRS_UWS_CLIENT_09_001: [ If `xio_send` fails and the message is still queued, it shall be de-queued and destroyed. ] */
-                        if (singlylinkedlist_find(uws_client->pending_sends, find_list_node, new_pending_send_list_item) != NULL)
-                        {    
-                            // Guards against double free in case the underlying I/O invoked 'on_underlying_io_send_complete' within xio_send.
-                            (void)singlylinkedlist_remove(uws_client->pending_sends, new_pending_send_list_item);
-                            free(ws_pending_send);
-                        }
-
+                        /* Codes_SRS_UWS_CLIENT_01_049: [ If `singlylinkedlist_add` fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
+                        LogError("Could not allocate memory for pending frames");
+                        free(ws_pending_send);
                         result = __FAILURE__;
                     }
                     else
                     {
-                        /* Codes_SRS_UWS_CLIENT_01_042: [ On success, `uws_client_send_frame_async` shall return 0. ]*/
-                        result = 0;
+                        /* Codes_SRS_UWS_CLIENT_01_431: [ Once encoded the frame shall be sent by using `xio_send` with the following arguments: ]*/
+                        /* Codes_SRS_UWS_CLIENT_01_053: [ - the io handle shall be the underlyiong IO handle created in `uws_client_create`. ]*/
+                        /* Codes_SRS_UWS_CLIENT_01_054: [ - the `buffer` argument shall point to the complete websocket frame to be sent. ]*/
+                        /* Codes_SRS_UWS_CLIENT_01_055: [ - the `size` argument shall indicate the websocket frame length. ]*/
+                        /* Codes_SRS_UWS_CLIENT_01_056: [ - the `send_complete` callback shall be the `on_underlying_io_send_complete` function. ]*/
+                        /* Codes_SRS_UWS_CLIENT_01_057: [ - the `send_complete_context` argument shall identify the pending send. ]*/
+                        /* Codes_SRS_UWS_CLIENT_01_276: [ The frame(s) that have been formed MUST be transmitted over the underlying network connection. ]*/
+                        if (xio_send(uws_client->underlying_io, uws_client->send_buffer, encoded_frame_length, on_underlying_io_send_complete, new_pending_send_list_item) != 0)
+                        {
+                            /* Codes_SRS_UWS_CLIENT_01_058: [ If `xio_send` fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
+                            LogError("Could not send bytes through the underlying IO");
+
+                            /* Codes_SRS_UWS_CLIENT_09_001: [ If `xio_send` fails and the message is still queued, it shall be de-queued and destroyed. ] */
+                            if (singlylinkedlist_find(uws_client->pending_sends, find_list_node, new_pending_send_list_item) != NULL)
+                            {
+                                // Guards against double free in case the underlying I/O invoked 'on_underlying_io_send_complete' within xio_send.
+                                (void)singlylinkedlist_remove(uws_client->pending_sends, new_pending_send_list_item);
+                                free(ws_pending_send);
+                            }
+
+                            result = __FAILURE__;
+                        }
+                        else
+                        {
+                            /* Codes_SRS_UWS_CLIENT_01_042: [ On success, `uws_client_send_frame_async` shall return 0. ]*/
+                            result = 0;
+                        }
                     }
                 }
 
-                BUFFER_delete(non_control_frame_buffer);
+                /* the underlying IO is done with the frame once xio_send returns, only a moderate send buffer is kept for the next frames */
+                if (uws_client->send_buffer_size > UWS_CLIENT_BUFFER_KEEP_SIZE)
+                {
+                    /* Codes_SRS_UWS_CLIENT_99_002: [ If the send buffer is larger than 64 KiB after the frame was sent, it shall be freed. ]*/
+                    free(uws_client->send_buffer);
+                    uws_client->send_buffer = NULL;
+                    uws_client->send_buffer_size = 0;
+                }
             }
         }
     }
@@ -5,6 +5,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include <string.h>
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/gb_rand.h"
 #include "azure_c_shared_utility/uws_frame_encoder.h"
@@ -12,6 +13,197 @@
 #include "azure_c_shared_utility/buffer_.h"
 #include "azure_c_shared_utility/uniqueid.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define UWS_FRAME_ENCODER_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define UWS_FRAME_ENCODER_NEON
+#endif
+
+static size_t get_header_size(size_t length, bool is_masked)
+{
+    size_t result = 2;
+
+    if (length > 65535)
+    {
+        result += 8;
+    }
+    else if (length > 125)
+    {
+        result += 2;
+    }
+
+    if (is_masked)
+    {
+        result += 4;
+    }
+
+    return result;
+}
+
+/* writes everything in the header except the masking key, which takes the last 4 bytes of a masked header */
+static void write_header(unsigned char* buffer, WS_FRAME_TYPE opcode, size_t length, bool is_masked, bool is_final, unsigned char reserved)
+{
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_007: [ *  %x0 denotes a continuation frame ]*/
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_008: [ *  %x1 denotes a text frame ]*/
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_009: [ *  %x2 denotes a binary frame ]*/
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_010: [ *  %x3-7 are reserved for further non-control frames ]*/
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_011: [ *  %x8 denotes a connection close ]*/
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_012: [ *  %x9 denotes a ping ]*/
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_013: [ *  %xA denotes a pong ]*/
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_014: [ *  %xB-F are reserved for further control frames ]*/
+    buffer[0] = (unsigned char)opcode;
+
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_002: [ Indicates that this is the final fragment in a message. ]*/
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_003: [ The first fragment MAY also be the final fragment. ]*/
+    if (is_final)
+    {
+        buffer[0] |= 0x80;
+    }
+
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_004: [ MUST be 0 unless an extension is negotiated that defines meanings for non-zero values. ]*/
+    buffer[0] |= reserved << 4;
+
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_022: [ Note that in all cases, the minimal number of bytes MUST be used to encode the length, for example, the length of a 124-byte-long string can't be encoded as the sequence 126, 0, 124. ]*/
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_018: [ The length of the "Payload data", in bytes: ]*/
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_023: [ The payload length is the length of the "Extension data" + the length of the "Application data". ]*/
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_042: [ The payload length, indicated in the framing as frame-payload-length, does NOT include the length of the masking key. ]*/
+    if (length > 65535)
+    {
+        /* Codes_SRS_UWS_FRAME_ENCODER_01_020: [ If 127, the following 8 bytes interpreted as a 64-bit unsigned integer (the most significant bit MUST be 0) are the payload length. ]*/
+        buffer[1] = 127;
+
+        /* Codes_SRS_UWS_FRAME_ENCODER_01_021: [ Multibyte length quantities are expressed in network byte order. ]*/
+        buffer[2] = (unsigned char)((uint64_t)length >> 56) & 0xFF;
+        buffer[3] = (unsigned char)((uint64_t)length >> 48) & 0xFF;
+        buffer[4] = (unsigned char)((uint64_t)length >> 40) & 0xFF;
+        buffer[5] = (unsigned char)((uint64_t)length >> 32) & 0xFF;
+        buffer[6] = (unsigned char)((uint64_t)length >> 24) & 0xFF;
+        buffer[7] = (unsigned char)((uint64_t)length >> 16) & 0xFF;
+        buffer[8] = (unsigned char)((uint64_t)length >> 8) & 0xFF;
+        buffer[9] = (unsigned char)(length & 0xFF);
+    }
+    else if (length > 125)
+    {
+        /* Codes_SRS_UWS_FRAME_ENCODER_01_019: [ If 126, the following 2 bytes interpreted as a 16-bit unsigned integer are the payload length. ]*/
+        buffer[1] = 126;
+
+        /* Codes_SRS_UWS_FRAME_ENCODER_01_021: [ Multibyte length quantities are expressed in network byte order. ]*/
+        buffer[2] = (unsigned char)(length >> 8);
+        buffer[3] = (unsigned char)(length & 0xFF);
+    }
+    else
+    {
+        /* Codes_SRS_UWS_FRAME_ENCODER_01_043: [ if 0-125, that is the payload length. ]*/
+        buffer[1] = (unsigned char)length;
+    }
+
+    if (is_masked)
+    {
+        /* Codes_SRS_UWS_FRAME_ENCODER_01_015: [ Defines whether the "Payload data" is masked. ]*/
+        /* Codes_SRS_UWS_FRAME_ENCODER_01_033: [ A masked frame MUST have the field frame-masked set to 1, as defined in Section 5.2. ]*/
+        buffer[1] |= 0x80;
+    }
+}
+
+static uint64_t splitmix64(uint64_t* state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static void next_mask_key(UWS_FRAME_MASK_GENERATOR* mask_generator, unsigned char* mask_key)
+{
+    uint64_t s1;
+    uint64_t s0;
+    uint32_t key;
+
+    if ((mask_generator->state[0] | mask_generator->state[1]) == 0)
+    {
+        /* Codes_SRS_UWS_FRAME_ENCODER_99_006: [ A zeroed `mask_generator` shall be seeded on its first use by mixing 4 values obtained from `gb_rand` with the address of `mask_generator`. ]*/
+        uint64_t seed = (uint64_t)(uintptr_t)mask_generator;
+        int i;
+        for (i = 0; i < 4; i++)
+        {
+            seed = (seed << 16) ^ (seed >> 48) ^ (uint64_t)(unsigned int)gb_rand();
+        }
+
+        mask_generator->state[0] = splitmix64(&seed);
+        mask_generator->state[1] = splitmix64(&seed);
+        if ((mask_generator->state[0] | mask_generator->state[1]) == 0)
+        {
+            mask_generator->state[1] = 1;
+        }
+    }
+
+    /* xorshift128+, a fresh key per frame without a call into the C runtime */
+    s1 = mask_generator->state[0];
+    s0 = mask_generator->state[1];
+    mask_generator->state[0] = s0;
+    s1 ^= s1 << 23;
+    mask_generator->state[1] = s1 ^ s0 ^ (s1 >> 17) ^ (s0 >> 26);
+    key = (uint32_t)((mask_generator->state[1] + s0) >> 32);
+
+    mask_key[0] = (unsigned char)(key >> 24);
+    mask_key[1] = (unsigned char)(key >> 16);
+    mask_key[2] = (unsigned char)(key >> 8);
+    mask_key[3] = (unsigned char)key;
+}
+
+/* masks length bytes from source into destination, which may be the same memory */
+static void apply_mask(unsigned char* destination, const unsigned char* source, size_t length, const unsigned char* mask_key)
+{
+    size_t i = 0;
+    unsigned char key_bytes[8];
+    uint64_t key_word;
+
+    /* the key repeated, so that word i of the payload is masked with it whatever the byte order of the CPU */
+    key_bytes[0] = key_bytes[4] = mask_key[0];
+    key_bytes[1] = key_bytes[5] = mask_key[1];
+    key_bytes[2] = key_bytes[6] = mask_key[2];
+    key_bytes[3] = key_bytes[7] = mask_key[3];
+    (void)memcpy(&key_word, key_bytes, sizeof(key_word));
+
+#if defined(UWS_FRAME_ENCODER_SSE2)
+    {
+        __m128i key_vector = _mm_set1_epi64x((long long)key_word);
+        for (; i + 32 <= length; i += 32)
+        {
+            __m128i a = _mm_loadu_si128((const __m128i*)(source + i));
+            __m128i b = _mm_loadu_si128((const __m128i*)(source + i + 16));
+            _mm_storeu_si128((__m128i*)(destination + i), _mm_xor_si128(a, key_vector));
+            _mm_storeu_si128((__m128i*)(destination + i + 16), _mm_xor_si128(b, key_vector));
+        }
+    }
+#elif defined(UWS_FRAME_ENCODER_NEON)
+    {
+        uint8x16_t key_vector = vreinterpretq_u8_u64(vdupq_n_u64(key_word));
+        for (; i + 16 <= length; i += 16)
+        {
+            vst1q_u8(destination + i, veorq_u8(vld1q_u8(source + i), key_vector));
+        }
+    }
+#endif
+
+    for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        (void)memcpy(&word, source + i, sizeof(word));
+        word ^= key_word;
+        (void)memcpy(destination + i, &word, sizeof(word));
+    }
+
+    /* every block above is a multiple of 4 bytes long, so the key lines up again for the tail */
+    for (; i < length; i++)
+    {
+        /* Codes_SRS_UWS_FRAME_ENCODER_01_041: [ Octet i of the transformed data ("transformed-octet-i") is the XOR of octet i of the original data ("original-octet-i") with octet at index i modulo 4 of the masking key ("masking-key-octet-j"): ]*/
+        destination[i] = source[i] ^ mask_key[i % 4];
+    }
+}
+
 BUFFER_HANDLE uws_frame_encoder_encode(WS_FRAME_TYPE opcode, const unsigned char* payload, size_t length, bool is_masked, bool is_final, unsigned char reserved)
 {
     BUFFER_HANDLE result;
@@ -37,7 +229,6 @@ BUFFER_HANDLE uws_frame_encoder_encode(WS_FRAME_TYPE opcode, const unsigned char
     }
     else
     {
-        size_t needed_bytes = 2;
         size_t header_bytes;
 
         /* Codes_SRS_UWS_FRAME_ENCODER_01_044: [ On success `uws_frame_encoder_encode` shall return a non-NULL handle to the result buffer. ]*/
@@ -51,25 +242,10 @@ BUFFER_HANDLE uws_frame_encoder_encode(WS_FRAME_TYPE opcode, const unsigned char
         else
         {
             /* Codes_SRS_UWS_FRAME_ENCODER_01_001: [ `uws_frame_encoder_encode` shall encode the information given in `opcode`, `payload`, `length`, `is_masked`, `is_final` and `reserved` according to the RFC6455 into a new buffer.]*/
-            if (length > 65535)
-            {
-                needed_bytes += 8;
-            }
-            else if (length > 125)
-            {
-                needed_bytes += 2;
-            }
-
-            if (is_masked)
-            {
-                needed_bytes += 4;
-            }
-
-            header_bytes = needed_bytes;
-            needed_bytes += length;
+            header_bytes = get_header_size(length, is_masked);
 
             /* Codes_SRS_UWS_FRAME_ENCODER_01_046: [ The result buffer shall be resized accordingly using `BUFFER_enlarge`. ]*/
-            if (BUFFER_enlarge(result, needed_bytes) != 0)
+            if (BUFFER_enlarge(result, header_bytes + length) != 0)
             {
                 /* Codes_SRS_UWS_FRAME_ENCODER_01_047: [ If `BUFFER_enlarge` fails then `uws_frame_encoder_encode` shall fail and return NULL. ]*/
                 LogError("Cannot allocate memory for encoded frame");
@@ -89,66 +265,10 @@ BUFFER_HANDLE uws_frame_encoder_encode(WS_FRAME_TYPE opcode, const unsigned char
                 }
                 else
                 {
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_007: [ *  %x0 denotes a continuation frame ]*/
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_008: [ *  %x1 denotes a text frame ]*/
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_009: [ *  %x2 denotes a binary frame ]*/
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_010: [ *  %x3-7 are reserved for further non-control frames ]*/
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_011: [ *  %x8 denotes a connection close ]*/
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_012: [ *  %x9 denotes a ping ]*/
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_013: [ *  %xA denotes a pong ]*/
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_014: [ *  %xB-F are reserved for further control frames ]*/
-                    buffer[0] = (unsigned char)opcode;
-
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_002: [ Indicates that this is the final fragment in a message. ]*/
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_003: [ The first fragment MAY also be the final fragment. ]*/
-                    if (is_final)
-                    {
-                        buffer[0] |= 0x80;
-                    }
-
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_004: [ MUST be 0 unless an extension is negotiated that defines meanings for non-zero values. ]*/
-                    buffer[0] |= reserved << 4;
-
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_022: [ Note that in all cases, the minimal number of bytes MUST be used to encode the length, for example, the length of a 124-byte-long string can't be encoded as the sequence 126, 0, 124. ]*/
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_018: [ The length of the "Payload data", in bytes: ]*/
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_023: [ The payload length is the length of the "Extension data" + the length of the "Application data". ]*/
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_042: [ The payload length, indicated in the framing as frame-payload-length, does NOT include the length of the masking key. ]*/
-                    if (length > 65535)
-                    {
-                        /* Codes_SRS_UWS_FRAME_ENCODER_01_020: [ If 127, the following 8 bytes interpreted as a 64-bit unsigned integer (the most significant bit MUST be 0) are the payload length. ]*/
-                        buffer[1] = 127;
-
-                        /* Codes_SRS_UWS_FRAME_ENCODER_01_021: [ Multibyte length quantities are expressed in network byte order. ]*/
-                        buffer[2] = (unsigned char)((uint64_t)length >> 56) & 0xFF;
-                        buffer[3] = (unsigned char)((uint64_t)length >> 48) & 0xFF;
-                        buffer[4] = (unsigned char)((uint64_t)length >> 40) & 0xFF;
-                        buffer[5] = (unsigned char)((uint64_t)length >> 32) & 0xFF;
-                        buffer[6] = (unsigned char)((uint64_t)length >> 24) & 0xFF;
-                        buffer[7] = (unsigned char)((uint64_t)length >> 16) & 0xFF;
-                        buffer[8] = (unsigned char)((uint64_t)length >> 8) & 0xFF;
-                        buffer[9] = (unsigned char)(length & 0xFF);
-                    }
-                    else if (length > 125)
-                    {
-                        /* Codes_SRS_UWS_FRAME_ENCODER_01_019: [ If 126, the following 2 bytes interpreted as a 16-bit unsigned integer are the payload length. ]*/
-                        buffer[1] = 126;
-
-                        /* Codes_SRS_UWS_FRAME_ENCODER_01_021: [ Multibyte length quantities are expressed in network byte order. ]*/
-                        buffer[2] = (unsigned char)(length >> 8);
-                        buffer[3] = (unsigned char)(length & 0xFF);
-                    }
-                    else
-                    {
-                        /* Codes_SRS_UWS_FRAME_ENCODER_01_043: [ if 0-125, that is the payload length. ]*/
-                        buffer[1] = (unsigned char)length;
-                    }
+                    write_header(buffer, opcode, length, is_masked, is_final, reserved);
 
                     if (is_masked)
                     {
-                        /* Codes_SRS_UWS_FRAME_ENCODER_01_015: [ Defines whether the "Payload data" is masked. ]*/
-                        /* Codes_SRS_UWS_FRAME_ENCODER_01_033: [ A masked frame MUST have the field frame-masked set to 1, as defined in Section 5.2. ]*/
-                        buffer[1] |= 0x80;
-
                         /* Codes_SRS_UWS_FRAME_ENCODER_01_053: [ In order to obtain a 32 bit value for masking, `gb_rand` shall be used 4 times (for each byte). ]*/
                         /* Codes_SRS_UWS_FRAME_ENCODER_01_016: [ If set to 1, a masking key is present in masking-key, and this is used to unmask the "Payload data" as per Section 5.3. ]*/
                         /* Codes_SRS_UWS_FRAME_ENCODER_01_026: [ This field is present if the mask bit is set to 1 and is absent if the mask bit is set to 0. ]*/
@@ -166,16 +286,10 @@ BUFFER_HANDLE uws_frame_encoder_encode(WS_FRAME_TYPE opcode, const unsigned char
                     {
                         if (is_masked)
                         {
-                            size_t i;
-
                             /* Codes_SRS_UWS_FRAME_ENCODER_01_035: [ It is used to mask the "Payload data" defined in the same section as frame-payload-data, which includes "Extension data" and "Application data". ]*/
                             /* Codes_SRS_UWS_FRAME_ENCODER_01_039: [ To convert masked data into unmasked data, or vice versa, the following algorithm is applied. ]*/
                             /* Codes_SRS_UWS_FRAME_ENCODER_01_040: [ The same algorithm applies regardless of the direction of the translation, e.g., the same steps are applied to mask the data as to unmask the data. ]*/
-                            for (i = 0; i < length; i++)
-                            {
-                                /* Codes_SRS_UWS_FRAME_ENCODER_01_041: [ Octet i of the transformed data ("transformed-octet-i") is the XOR of octet i of the original data ("original-octet-i") with octet at index i modulo 4 of the masking key ("masking-key-octet-j"): ]*/
-                                buffer[header_bytes + i] = ((unsigned char*)payload)[i] ^ buffer[header_bytes - 4 + (i % 4)];
-                            }
+                            apply_mask(buffer + header_bytes, payload, length, buffer + header_bytes - 4);
                         }
                         else
                         {
@@ -189,3 +303,76 @@ BUFFER_HANDLE uws_frame_encoder_encode(WS_FRAME_TYPE opcode, const unsigned char
 
     return result;
 }
+
+int uws_frame_encoder_encode_header(unsigned char* header, size_t header_size, WS_FRAME_TYPE opcode, size_t length, UWS_FRAME_MASK_GENERATOR* mask_generator, bool is_final, unsigned char reserved, size_t* header_length)
+{
+    int result;
+
+    if ((header == NULL) ||
+        (header_length == NULL))
+    {
+        /* Codes_SRS_UWS_FRAME_ENCODER_99_001: [ If `header` or `header_length` is NULL, `uws_frame_encoder_encode_header` shall fail and return a non-zero value. ]*/
+        LogError("Invalid arguments: header=%p, header_length=%p", header, header_length);
+        result = __FAILURE__;
+    }
+    else if (reserved > 7)
+    {
+        /* Codes_SRS_UWS_FRAME_ENCODER_99_002: [ If `reserved` has any bits set except the lowest 3 or `opcode` is greater than 0x0F, `uws_frame_encoder_encode_header` shall fail and return a non-zero value. ]*/
+        LogError("Bad reserved value: 0x%02x", reserved);
+        result = __FAILURE__;
+    }
+    else if (opcode > 0x0F)
+    {
+        /* Codes_SRS_UWS_FRAME_ENCODER_99_002: [ If `reserved` has any bits set except the lowest 3 or `opcode` is greater than 0x0F, `uws_frame_encoder_encode_header` shall fail and return a non-zero value. ]*/
+        LogError("Invalid opcode: 0x%02x", opcode);
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t needed_bytes = get_header_size(length, mask_generator != NULL);
+        if (needed_bytes > header_size)
+        {
+            /* Codes_SRS_UWS_FRAME_ENCODER_99_003: [ If the header does not fit in `header_size` bytes, `uws_frame_encoder_encode_header` shall fail and return a non-zero value. ]*/
+            LogError("Header needs %u bytes, only %u available", (unsigned int)needed_bytes, (unsigned int)header_size);
+            result = __FAILURE__;
+        }
+        else
+        {
+            /* Codes_SRS_UWS_FRAME_ENCODER_99_004: [ `uws_frame_encoder_encode_header` shall write into `header` the RFC6455 header of a frame with `opcode`, `is_final`, `reserved` and a payload of `length` bytes, masked when `mask_generator` is not NULL, store the number of bytes written in `header_length` and return 0. ]*/
+            write_header(header, opcode, length, mask_generator != NULL, is_final, reserved);
+
+            if (mask_generator != NULL)
+            {
+                /* Codes_SRS_UWS_FRAME_ENCODER_99_005: [ The masking key shall be the next value of `mask_generator` and take the last 4 bytes of the header. ]*/
+                next_mask_key(mask_generator, header + needed_bytes - 4);
+            }
+
+            *header_length = needed_bytes;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+int uws_frame_encoder_mask(unsigned char* destination, const unsigned char* source, size_t length, const unsigned char* mask_key)
+{
+    int result;
+
+    if (((length > 0) && ((destination == NULL) || (source == NULL))) ||
+        (mask_key == NULL))
+    {
+        /* Codes_SRS_UWS_FRAME_ENCODER_99_007: [ If `mask_key` is NULL, or `length` is greater than 0 and `destination` or `source` is NULL, `uws_frame_encoder_mask` shall fail and return a non-zero value. ]*/
+        LogError("Invalid arguments: destination=%p, source=%p, length=%u, mask_key=%p", destination, source, (unsigned int)length, mask_key);
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Codes_SRS_UWS_FRAME_ENCODER_99_008: [ `uws_frame_encoder_mask` shall write to `destination` the `length` bytes of `source` masked with the 4 bytes of `mask_key` as RFC6455 section 5.3 describes, and return 0. ]*/
+        /* Codes_SRS_UWS_FRAME_ENCODER_99_009: [ `destination` and `source` may be the same buffer, which is then masked in place. ]*/
+        apply_mask(destination, source, length, mask_key);
+        result = 0;
+    }
+
+    return result;
+}
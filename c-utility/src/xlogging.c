@@ -41,6 +41,7 @@ void consolelogger_log(LOG_CATEGORY log_category, const char* file, const char*
 #endif
 
 LOGGER_LOG global_log_function = consolelogger_log;
+LOG_CATEGORY global_log_level = AZ_LOG_TRACE;
 
 void xlogging_set_log_function(LOGGER_LOG log_function)
 {
@@ -52,6 +53,16 @@ LOGGER_LOG xlogging_get_log_function(void)
     return global_log_function;
 }
 
+void xlogging_set_log_level(LOG_CATEGORY log_level)
+{
+    global_log_level = log_level;
+}
+
+LOG_CATEGORY xlogging_get_log_level(void)
+{
+    return global_log_level;
+}
+
 #if (defined(_MSC_VER)) && (!(defined WINCE))
 
 LOGGER_LOG_GETLASTERROR global_log_function_GetLastError = consolelogger_log_with_GetLastError;
@@ -85,52 +96,56 @@ void LogBinary(const char* comment, const void* data, size_t size)
     const unsigned char* bufAsChar = (const unsigned char*)data;
     const unsigned char* startPos = bufAsChar;
 
-    LOG(AZ_LOG_TRACE, LOG_LINE, "%s     %zu bytes", comment, size);
-
-    /* Print the whole buffer. */
-    for (i = 0; i < size; i++)
+    /*do not build the hex dump if nothing would print it*/
+    if (XLOGGING_IS_ENABLED(AZ_LOG_TRACE))
     {
-        /* Store the printable value of the char in the charBuf to print. */
-        charBuf[countbuf] = PRINTABLE(*bufAsChar);
+        LOG(AZ_LOG_TRACE, LOG_LINE, "%s     %zu bytes", comment, size);
+
+        /* Print the whole buffer. */
+        for (i = 0; i < size; i++)
+        {
+            /* Store the printable value of the char in the charBuf to print. */
+            charBuf[countbuf] = PRINTABLE(*bufAsChar);
 
-        /* Convert the high nibble to a printable hexadecimal value. */
-        hexBuf[countbuf * 3] = HEX_STR(*bufAsChar >> 4);
+            /* Convert the high nibble to a printable hexadecimal value. */
+            hexBuf[countbuf * 3] = HEX_STR(*bufAsChar >> 4);
 
-        /* Convert the low nibble to a printable hexadecimal value. */
-        hexBuf[countbuf * 3 + 1] = HEX_STR(*bufAsChar);
+            /* Convert the low nibble to a printable hexadecimal value. */
+            hexBuf[countbuf * 3 + 1] = HEX_STR(*bufAsChar);
+
+            hexBuf[countbuf * 3 + 2] = ' ';
 
-        hexBuf[countbuf * 3 + 2] = ' ';
+            countbuf++;
+            bufAsChar++;
+            /* If the line is full, print it to start another one. */
+            if (countbuf == LINE_SIZE)
+            {
+                charBuf[countbuf] = '\0';
+                hexBuf[countbuf * 3] = '\0';
+                LOG(AZ_LOG_TRACE, LOG_LINE, "%p: %s    %s", startPos, hexBuf, charBuf);
+                countbuf = 0;
+                startPos = bufAsChar;
+            }
+        }
 
-        countbuf++;
-        bufAsChar++;
-        /* If the line is full, print it to start another one. */
-        if (countbuf == LINE_SIZE)
+        /* If the last line does not fit the line size. */
+        if (countbuf > 0)
         {
+            /* Close the charBuf string. */
             charBuf[countbuf] = '\0';
-            hexBuf[countbuf * 3] = '\0';
-            LOG(AZ_LOG_TRACE, LOG_LINE, "%p: %s    %s", startPos, hexBuf, charBuf);
-            countbuf = 0;
-            startPos = bufAsChar;
-        }
-    }
 
-    /* If the last line does not fit the line size. */
-    if (countbuf > 0)
-    {
-        /* Close the charBuf string. */
-        charBuf[countbuf] = '\0';
+            /* Fill the hexBuf with spaces to keep the charBuf alignment. */
+            while ((countbuf++) < LINE_SIZE - 1)
+            {
+                hexBuf[countbuf * 3] = ' ';
+                hexBuf[countbuf * 3 + 1] = ' ';
+                hexBuf[countbuf * 3 + 2] = ' ';
+            }
+            hexBuf[countbuf * 3] = '\0';
 
-        /* Fill the hexBuf with spaces to keep the charBuf alignment. */
-        while ((countbuf++) < LINE_SIZE - 1)
-        {
-            hexBuf[countbuf * 3] = ' ';
-            hexBuf[countbuf * 3 + 1] = ' ';
-            hexBuf[countbuf * 3 + 2] = ' ';
+            /* Print the last line. */
+            LOG(AZ_LOG_TRACE, LOG_LINE, "%p: %s    %s", startPos, hexBuf, charBuf);
         }
-        hexBuf[countbuf * 3] = '\0';
-
-        /* Print the last line. */
-        LOG(AZ_LOG_TRACE, LOG_LINE, "%p: %s    %s", startPos, hexBuf, charBuf);
     }
 }
 
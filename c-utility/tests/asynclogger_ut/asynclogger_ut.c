@@ -0,0 +1,401 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#define ENABLE_MOCKS
+
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/threadapi.h"
+
+#undef ENABLE_MOCKS
+
+#include "azure_c_shared_utility/asynclogger.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+#define TEST_THREAD_HANDLE (THREAD_HANDLE)0x4242
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+/*the log thread is not started by the mock, ThreadAPI_Join runs it to the end instead*/
+static THREAD_START_FUNC captured_thread_func;
+static void* captured_thread_arg;
+
+static THREADAPI_RESULT my_ThreadAPI_Create(THREAD_HANDLE* threadHandle, THREAD_START_FUNC func, void* arg)
+{
+    captured_thread_func = func;
+    captured_thread_arg = arg;
+    *threadHandle = TEST_THREAD_HANDLE;
+    return THREADAPI_OK;
+}
+
+static THREADAPI_RESULT my_ThreadAPI_Join(THREAD_HANDLE threadHandle, int* res)
+{
+    (void)threadHandle;
+    *res = captured_thread_func(captured_thread_arg);
+    return THREADAPI_OK;
+}
+
+static size_t test_log_calls;
+
+static void test_log(LOG_CATEGORY log_category, const char* file, const char* func, int line, unsigned int options, const char* format, ...)
+{
+    (void)log_category;
+    (void)file;
+    (void)func;
+    (void)line;
+    (void)options;
+    (void)format;
+    test_log_calls++;
+}
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+static void start_with_records(size_t record_count)
+{
+    ASSERT_ARE_EQUAL(int, 0, asynclogger_start(record_count));
+    umock_c_reset_all_calls();
+}
+
+BEGIN_TEST_SUITE(asynclogger_ut)
+
+TEST_SUITE_INITIALIZE(suite_init)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    umock_c_init(on_umock_c_error);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+    REGISTER_GLOBAL_MOCK_HOOK(ThreadAPI_Create, my_ThreadAPI_Create);
+    REGISTER_GLOBAL_MOCK_HOOK(ThreadAPI_Join, my_ThreadAPI_Join);
+
+    REGISTER_UMOCK_ALIAS_TYPE(THREAD_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(THREAD_START_FUNC, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(THREADAPI_RESULT, int);
+}
+
+TEST_SUITE_CLEANUP(suite_cleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("Could not acquire test serialization mutex.");
+    }
+
+    xlogging_set_log_function(test_log);
+    test_log_calls = 0;
+    umock_c_reset_all_calls();
+}
+
+TEST_FUNCTION_CLEANUP(method_cleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* asynclogger_start */
+
+/* Tests_SRS_ASYNCLOGGER_99_001: [ If record_count is 0 or larger than 2^30, asynclogger_start shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(asynclogger_start_with_0_records_fails)
+{
+    // arrange
+    int result;
+
+    // act
+    result = asynclogger_start(0);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_TRUE(xlogging_get_log_function() == test_log);
+}
+
+/* Tests_SRS_ASYNCLOGGER_99_001: [ If record_count is 0 or larger than 2^30, asynclogger_start shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(asynclogger_start_with_too_many_records_fails)
+{
+    // arrange
+    int result;
+
+    // act
+    result = asynclogger_start((((size_t)1) << 30) + 1);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_ASYNCLOGGER_99_003: [ asynclogger_start shall allocate a ring of record_count records, rounded up to a power of two. If that fails, it shall return a non-zero value. ]*/
+/* Tests_SRS_ASYNCLOGGER_99_004: [ asynclogger_start shall start the background thread with ThreadAPI_Create. If that fails, it shall free the ring and return a non-zero value. ]*/
+/* Tests_SRS_ASYNCLOGGER_99_005: [ On success, asynclogger_start shall remember the current log function, install asynclogger_log with xlogging_set_log_function and return 0. ]*/
+TEST_FUNCTION(asynclogger_start_succeeds)
+{
+    // arrange
+    int result;
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL))
+        .IgnoreArgument_threadHandle()
+        .IgnoreArgument_func();
+
+    // act
+    result = asynclogger_start(4);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_TRUE(xlogging_get_log_function() == asynclogger_log);
+
+    // cleanup
+    asynclogger_stop();
+}
+
+/* Tests_SRS_ASYNCLOGGER_99_002: [ If the logger is already started, asynclogger_start shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(asynclogger_start_when_already_started_fails)
+{
+    // arrange
+    int result;
+    start_with_records(4);
+
+    // act
+    result = asynclogger_start(4);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    asynclogger_stop();
+}
+
+/* Tests_SRS_ASYNCLOGGER_99_003: [ asynclogger_start shall allocate a ring of record_count records, rounded up to a power of two. If that fails, it shall return a non-zero value. ]*/
+TEST_FUNCTION(when_allocating_the_ring_fails_asynclogger_start_fails)
+{
+    // arrange
+    int result;
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+
+    // act
+    result = asynclogger_start(4);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_TRUE(xlogging_get_log_function() == test_log);
+}
+
+/* Tests_SRS_ASYNCLOGGER_99_004: [ asynclogger_start shall start the background thread with ThreadAPI_Create. If that fails, it shall free the ring and return a non-zero value. ]*/
+TEST_FUNCTION(when_creating_the_thread_fails_asynclogger_start_fails)
+{
+    // arrange
+    int result;
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL))
+        .IgnoreArgument_threadHandle()
+        .IgnoreArgument_func()
+        .SetReturn(THREADAPI_ERROR);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    result = asynclogger_start(4);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_TRUE(xlogging_get_log_function() == test_log);
+}
+
+/* asynclogger_log */
+
+/* Tests_SRS_ASYNCLOGGER_99_006: [ asynclogger_log shall format the message into a free record of the ring, with a monotonic timestamp, and return without waiting for it to be written. ]*/
+/* Tests_SRS_ASYNCLOGGER_99_010: [ The background thread shall write the records out in the order they were taken, the way consolelogger_log prints them. ]*/
+TEST_FUNCTION(asynclogger_log_queues_the_message_without_calling_anything)
+{
+    // arrange
+    ASYNC_LOGGER_STATISTICS statistics;
+    start_with_records(4);
+
+    // act
+    LogInfo("info %d", 1);
+    LogError("error %s", "2");
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    asynclogger_stop();
+    ASSERT_ARE_EQUAL(int, 0, asynclogger_get_statistics(&statistics));
+    ASSERT_ARE_EQUAL(size_t, 2, statistics.written);
+    ASSERT_ARE_EQUAL(size_t, 0, statistics.dropped);
+    ASSERT_ARE_EQUAL(size_t, 0, test_log_calls);
+}
+
+/* Tests_SRS_ASYNCLOGGER_99_007: [ If the ring is full, asynclogger_log shall drop the message and count it as dropped. ]*/
+/* Tests_SRS_ASYNCLOGGER_99_003: [ asynclogger_start shall allocate a ring of record_count records, rounded up to a power of two. If that fails, it shall return a non-zero value. ]*/
+TEST_FUNCTION(asynclogger_log_when_the_ring_is_full_drops_the_message)
+{
+    // arrange
+    ASYNC_LOGGER_STATISTICS statistics;
+    size_t i;
+    start_with_records(3);
+
+    // act
+    for (i = 0; i < 6; i++)
+    {
+        LogInfo("message %lu", (unsigned long)i);
+    }
+
+    // assert
+    asynclogger_stop();
+    ASSERT_ARE_EQUAL(int, 0, asynclogger_get_statistics(&statistics));
+    ASSERT_ARE_EQUAL(size_t, 4, statistics.written);
+    ASSERT_ARE_EQUAL(size_t, 2, statistics.dropped);
+}
+
+/* Tests_SRS_ASYNCLOGGER_99_008: [ A message that does not fit in ASYNC_LOGGER_MESSAGE_SIZE bytes shall be cut and end in "...". ]*/
+TEST_FUNCTION(asynclogger_log_with_a_long_message_succeeds)
+{
+    // arrange
+    ASYNC_LOGGER_STATISTICS statistics;
+    char long_message[ASYNC_LOGGER_MESSAGE_SIZE * 2];
+    (void)memset(long_message, 'a', sizeof(long_message) - 1);
+    long_message[sizeof(long_message) - 1] = '\0';
+    start_with_records(1);
+
+    // act
+    LogInfo("%s", long_message);
+
+    // assert
+    asynclogger_stop();
+    ASSERT_ARE_EQUAL(int, 0, asynclogger_get_statistics(&statistics));
+    ASSERT_ARE_EQUAL(size_t, 1, statistics.written);
+}
+
+/* Tests_SRS_ASYNCLOGGER_99_009: [ If the logger is not started, asynclogger_log shall do nothing. ]*/
+TEST_FUNCTION(asynclogger_log_when_not_started_does_nothing)
+{
+    // arrange
+    ASYNC_LOGGER_STATISTICS before;
+    ASYNC_LOGGER_STATISTICS after;
+    ASSERT_ARE_EQUAL(int, 0, asynclogger_get_statistics(&before));
+
+    // act
+    asynclogger_log(AZ_LOG_ERROR, __FILE__, FUNC_NAME, __LINE__, LOG_LINE, "not started");
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, asynclogger_get_statistics(&after));
+    ASSERT_ARE_EQUAL(size_t, before.written, after.written);
+    ASSERT_ARE_EQUAL(size_t, before.dropped, after.dropped);
+}
+
+/* asynclogger_stop */
+
+/* Tests_SRS_ASYNCLOGGER_99_011: [ asynclogger_stop shall put back the previous log function, wait for the threads still in asynclogger_log, let the background thread write out every remaining record, join it and free the ring. ]*/
+TEST_FUNCTION(asynclogger_stop_puts_back_the_previous_log_function)
+{
+    // arrange
+    start_with_records(4);
+    LogInfo("before stop");
+
+    STRICT_EXPECTED_CALL(ThreadAPI_Join(TEST_THREAD_HANDLE, IGNORED_PTR_ARG))
+        .IgnoreArgument_res();
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    asynclogger_stop();
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_TRUE(xlogging_get_log_function() == test_log);
+    LogInfo("after stop");
+    ASSERT_ARE_EQUAL(size_t, 1, test_log_calls);
+}
+
+/* Tests_SRS_ASYNCLOGGER_99_012: [ If the logger is not started, asynclogger_stop shall do nothing. ]*/
+TEST_FUNCTION(asynclogger_stop_when_not_started_does_nothing)
+{
+    // arrange
+
+    // act
+    asynclogger_stop();
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_TRUE(xlogging_get_log_function() == test_log);
+}
+
+/* Tests_SRS_ASYNCLOGGER_99_011: [ asynclogger_stop shall put back the previous log function, wait for the threads still in asynclogger_log, let the background thread write out every remaining record, join it and free the ring. ]*/
+TEST_FUNCTION(asynclogger_can_be_started_again_after_stop)
+{
+    // arrange
+    ASYNC_LOGGER_STATISTICS statistics;
+    start_with_records(2);
+    LogInfo("first run");
+    asynclogger_stop();
+    start_with_records(2);
+
+    // act
+    LogInfo("second run");
+    LogInfo("second run");
+
+    // assert
+    asynclogger_stop();
+    ASSERT_ARE_EQUAL(int, 0, asynclogger_get_statistics(&statistics));
+    ASSERT_ARE_EQUAL(size_t, 2, statistics.written);
+    ASSERT_ARE_EQUAL(size_t, 0, statistics.dropped);
+}
+
+/* asynclogger_get_statistics */
+
+/* Tests_SRS_ASYNCLOGGER_99_013: [ If statistics is NULL, asynclogger_get_statistics shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(asynclogger_get_statistics_with_NULL_statistics_fails)
+{
+    // arrange
+    int result;
+
+    // act
+    result = asynclogger_get_statistics(NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+END_TEST_SUITE(asynclogger_ut)
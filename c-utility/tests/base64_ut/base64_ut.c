@@ -10,6 +10,7 @@
 #include <stddef.h>
 #include <string.h>
 #endif
+#include <stdint.h>
 
 #include "testrunnerswitcher.h"
 #include "umock_c.h"
@@ -36,6 +37,7 @@ static void my_gballoc_free(void* ptr)
 #include "azure_c_shared_utility/base64.h"
 #include "azure_c_shared_utility/strings.h"
 #include "azure_c_shared_utility/buffer_.h"
+#include "azure_c_shared_utility/xlogging.h"
 
 static const struct
 {
@@ -1481,6 +1483,25 @@ static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
     ASSERT_FAIL(temp_str);
 }
 
+#define CROSS_CHECK_MAX_SIZE 300
+
+static const BASE64_IMPLEMENTATION vectorImplementations[] =
+{
+    BASE64_IMPLEMENTATION_SSSE3,
+    BASE64_IMPLEMENTATION_AVX2,
+    BASE64_IMPLEMENTATION_NEON
+};
+
+static void fillPseudoRandom(unsigned char* destination, size_t size, uint32_t seed)
+{
+    size_t i;
+    for (i = 0; i < size; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        destination[i] = (unsigned char)(seed >> 16);
+    }
+}
+
 BEGIN_TEST_SUITE(base64_unittests)
 
 TEST_SUITE_INITIALIZE(TestSuiteInitialize)
@@ -1807,4 +1828,339 @@ TEST_FUNCTION(Base64_Decoder_invalid_length_fails_6)
 }
 
 
+/*Tests_SRS_BASE64_99_003: [ Base64_EncodeInto shall write the base64 encoding of the size bytes at source, "=" padded, followed by a null terminator. ]*/
+/*Tests_SRS_BASE64_99_004: [ If encodedLength is not NULL, Base64_EncodeInto shall set it to the number of characters written, not counting the null terminator. ]*/
+/*Tests_SRS_BASE64_99_005: [ Otherwise Base64_EncodeInto shall succeed and return 0. ]*/
+TEST_FUNCTION(Base64_EncodeInto_exhaustive_succeeds)
+{
+    size_t i;
+    for (i = 0; i < sizeof(testVector_BINARY_with_equal_signs) / sizeof(testVector_BINARY_with_equal_signs[0]); i++)
+    {
+        ///arrange
+        char destination[BASE64_ENCODED_LENGTH(10) + 1];
+        size_t encodedLength = 0;
+        int result;
+
+        ///act
+        result = Base64_EncodeInto(destination, BASE64_ENCODED_LENGTH(testVector_BINARY_with_equal_signs[i].inputLength) + 1, testVector_BINARY_with_equal_signs[i].inputData, testVector_BINARY_with_equal_signs[i].inputLength, &encodedLength);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, testVector_BINARY_with_equal_signs[i].expectedOutput, destination);
+        ASSERT_ARE_EQUAL(size_t, strlen(testVector_BINARY_with_equal_signs[i].expectedOutput), encodedLength);
+    }
+}
+
+/*Tests_SRS_BASE64_99_005: [ Otherwise Base64_EncodeInto shall succeed and return 0. ]*/
+TEST_FUNCTION(Base64_EncodeInto_with_NULL_source_and_zero_size_writes_an_empty_string)
+{
+    ///arrange
+    char destination[1] = { 'x' };
+    size_t encodedLength = 1;
+
+    ///act
+    int result = Base64_EncodeInto(destination, sizeof(destination), NULL, 0, &encodedLength);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, "", destination);
+    ASSERT_ARE_EQUAL(size_t, 0, encodedLength);
+}
+
+/*Tests_SRS_BASE64_99_001: [ If destination is NULL, or source is NULL while size is not zero, then Base64_EncodeInto shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(Base64_EncodeInto_with_NULL_arguments_fails)
+{
+    ///arrange
+    char destination[8];
+
+    ///act
+    int result1 = Base64_EncodeInto(NULL, sizeof(destination), (const unsigned char*)"a", 1, NULL);
+    int result2 = Base64_EncodeInto(destination, sizeof(destination), NULL, 1, NULL);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result1);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result2);
+}
+
+/*Tests_SRS_BASE64_99_002: [ If destinationSize is smaller than BASE64_ENCODED_LENGTH(size) + 1 then Base64_EncodeInto shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(Base64_EncodeInto_without_room_for_the_null_terminator_fails)
+{
+    ///arrange
+    char destination[5] = { 'x', 'x', 'x', 'x', 'x' };
+
+    ///act
+    int result = Base64_EncodeInto(destination, 4, (const unsigned char*)"abc", 3, NULL);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, 'x', destination[4]);
+}
+
+/*Tests_SRS_BASE64_99_007: [ Base64_DecodeInto shall accept the encoding with or without its "=" padding. ]*/
+/*Tests_SRS_BASE64_99_012: [ Base64_DecodeInto shall write the decoded bytes to destination. ]*/
+/*Tests_SRS_BASE64_99_013: [ If decodedSize is not NULL, Base64_DecodeInto shall set it to the number of bytes written. ]*/
+/*Tests_SRS_BASE64_99_014: [ Otherwise Base64_DecodeInto shall succeed and return 0. ]*/
+TEST_FUNCTION(Base64_DecodeInto_exhaustive_succeeds_with_and_without_padding)
+{
+    size_t i;
+    for (i = 0; i < sizeof(testVector_BINARY_with_equal_signs) / sizeof(testVector_BINARY_with_equal_signs[0]); i++)
+    {
+        ///arrange
+        const char* encoded = testVector_BINARY_with_equal_signs[i].expectedOutput;
+        size_t paddedLength = strlen(encoded);
+        size_t unpaddedLength = paddedLength;
+        unsigned char padded[10];
+        unsigned char unpadded[10];
+        size_t paddedSize = 0;
+        size_t unpaddedSize = 0;
+        int result1;
+        int result2;
+        while ((unpaddedLength > 0) && (encoded[unpaddedLength - 1] == '='))
+        {
+            unpaddedLength--;
+        }
+
+        ///act
+        result1 = Base64_DecodeInto(padded, testVector_BINARY_with_equal_signs[i].inputLength, encoded, paddedLength, &paddedSize);
+        result2 = Base64_DecodeInto(unpadded, testVector_BINARY_with_equal_signs[i].inputLength, encoded, unpaddedLength, &unpaddedSize);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, result1);
+        ASSERT_ARE_EQUAL(int, 0, result2);
+        ASSERT_ARE_EQUAL(size_t, testVector_BINARY_with_equal_signs[i].inputLength, paddedSize);
+        ASSERT_ARE_EQUAL(size_t, testVector_BINARY_with_equal_signs[i].inputLength, unpaddedSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(padded, testVector_BINARY_with_equal_signs[i].inputData, paddedSize));
+        ASSERT_ARE_EQUAL(int, 0, memcmp(unpadded, testVector_BINARY_with_equal_signs[i].inputData, unpaddedSize));
+    }
+}
+
+/*Tests_SRS_BASE64_99_006: [ If destination is NULL, or source is NULL while length is not zero, then Base64_DecodeInto shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(Base64_DecodeInto_with_NULL_arguments_fails)
+{
+    ///arrange
+    unsigned char destination[3];
+
+    ///act
+    int result1 = Base64_DecodeInto(NULL, sizeof(destination), "AAAA", 4, NULL);
+    int result2 = Base64_DecodeInto(destination, sizeof(destination), NULL, 4, NULL);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result1);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result2);
+}
+
+/*Tests_SRS_BASE64_99_008: [ If length, without the padding, is one more than a multiple of 4 then Base64_DecodeInto shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(Base64_DecodeInto_with_an_impossible_length_fails)
+{
+    ///arrange
+    unsigned char destination[6];
+
+    ///act
+    int result1 = Base64_DecodeInto(destination, sizeof(destination), "AAAAA", 5, NULL);
+    int result2 = Base64_DecodeInto(destination, sizeof(destination), "A===", 4, NULL);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result1);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result2);
+}
+
+/*Tests_SRS_BASE64_99_009: [ If destinationSize is smaller than the number of decoded bytes then Base64_DecodeInto shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(Base64_DecodeInto_with_a_small_destination_fails)
+{
+    ///arrange
+    unsigned char destination[2];
+
+    ///act
+    int result = Base64_DecodeInto(destination, sizeof(destination), "AAAA", 4, NULL);
+    int exactResult = Base64_DecodeInto(destination, sizeof(destination), "AAA=", 4, NULL);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, 0, exactResult);
+}
+
+/*Tests_SRS_BASE64_99_010: [ If a character is outside the alphabet then Base64_DecodeInto shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(Base64_DecodeInto_with_a_character_outside_the_alphabet_fails)
+{
+    ///arrange
+    unsigned char destination[6];
+
+    ///act
+    int result1 = Base64_DecodeInto(destination, sizeof(destination), "AA.AAAAA", 8, NULL);
+    int result2 = Base64_DecodeInto(destination, sizeof(destination), "AAAAA=AA", 8, NULL);
+    int result3 = Base64_DecodeInto(destination, sizeof(destination), "AAAAAA-A", 8, NULL);
+    int result4 = Base64_DecodeInto(destination, sizeof(destination), "AAAA\xc1" "A", 6, NULL);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result1);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result2);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result3);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result4);
+}
+
+/*Tests_SRS_BASE64_99_011: [ If the last character has bits set that do not belong to a decoded byte then Base64_DecodeInto shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(Base64_DecodeInto_with_leftover_bits_fails)
+{
+    ///arrange
+    unsigned char destination[2];
+
+    ///act
+    int result1 = Base64_DecodeInto(destination, sizeof(destination), "AB==", 4, NULL);
+    int result2 = Base64_DecodeInto(destination, sizeof(destination), "AAB=", 4, NULL);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result1);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result2);
+}
+
+/*Tests_SRS_BASE64_99_015: [ Base64Url_EncodeInto and Base64Url_DecodeInto shall behave as Base64_EncodeInto and Base64_DecodeInto with "-" and "_" in place of "+" and "/". ]*/
+TEST_FUNCTION(Base64Url_EncodeInto_and_Base64Url_DecodeInto_use_the_url_alphabet)
+{
+    ///arrange
+    const unsigned char source[] = { 0xFB, 0xEF, 0xFF, 0xFB };
+    char standard[BASE64_ENCODED_LENGTH(sizeof(source)) + 1];
+    char url[BASE64_ENCODED_LENGTH(sizeof(source)) + 1];
+    unsigned char decoded[sizeof(source)];
+    size_t decodedSize;
+
+    ///act
+    ASSERT_ARE_EQUAL(int, 0, Base64_EncodeInto(standard, sizeof(standard), source, sizeof(source), NULL));
+    ASSERT_ARE_EQUAL(int, 0, Base64Url_EncodeInto(url, sizeof(url), source, sizeof(source), NULL));
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, "++//+w==", standard);
+    ASSERT_ARE_EQUAL(char_ptr, "--__-w==", url);
+    ASSERT_ARE_EQUAL(int, 0, Base64Url_DecodeInto(decoded, sizeof(decoded), url, strlen(url), &decodedSize));
+    ASSERT_ARE_EQUAL(size_t, sizeof(source), decodedSize);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(source, decoded, sizeof(source)));
+    ASSERT_ARE_NOT_EQUAL(int, 0, Base64Url_DecodeInto(decoded, sizeof(decoded), standard, strlen(standard), NULL));
+    ASSERT_ARE_NOT_EQUAL(int, 0, Base64_DecodeInto(decoded, sizeof(decoded), url, strlen(url), NULL));
+}
+
+/*Tests_SRS_BASE64_99_017: [ If this CPU or build does not support implementation then Base64_SetImplementation shall fail, return a non-zero value and keep the implementation in use. ]*/
+/*Tests_SRS_BASE64_99_018: [ Otherwise Base64_SetImplementation shall make all the encoding and decoding functions use implementation and return 0. ]*/
+/*Tests_SRS_BASE64_99_019: [ Base64_GetImplementation shall return the implementation in use, selecting it as BASE64_IMPLEMENTATION_AUTO does if none was selected yet. ]*/
+TEST_FUNCTION(Base64_SetImplementation_with_an_unknown_implementation_keeps_the_implementation_in_use)
+{
+    ///arrange
+    ASSERT_ARE_EQUAL(int, 0, Base64_SetImplementation(BASE64_IMPLEMENTATION_PORTABLE));
+
+    ///act
+    int result = Base64_SetImplementation((BASE64_IMPLEMENTATION)0x42);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, (int)BASE64_IMPLEMENTATION_PORTABLE, (int)Base64_GetImplementation());
+
+    ///cleanup
+    (void)Base64_SetImplementation(BASE64_IMPLEMENTATION_AUTO);
+}
+
+/*Tests_SRS_BASE64_99_016: [ BASE64_IMPLEMENTATION_AUTO shall select AVX2, then SSSE3, then NEON, then the portable code, whichever this CPU and build support first. ]*/
+TEST_FUNCTION(Base64_SetImplementation_AUTO_resolves_to_a_supported_implementation)
+{
+    ///arrange
+    BASE64_IMPLEMENTATION implementation;
+
+    ///act
+    int result = Base64_SetImplementation(BASE64_IMPLEMENTATION_AUTO);
+    implementation = Base64_GetImplementation();
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_NOT_EQUAL(int, (int)BASE64_IMPLEMENTATION_AUTO, (int)implementation);
+    ASSERT_ARE_EQUAL(int, 0, Base64_SetImplementation(implementation));
+    LogInfo("base64 implementation: %s", ENUM_TO_STRING(BASE64_IMPLEMENTATION, implementation));
+}
+
+/*the vector kernels only run on long inputs, every length up to a few of their blocks is checked against the portable code*/
+TEST_FUNCTION(Base64_every_implementation_matches_the_portable_one)
+{
+    ///arrange
+    unsigned char source[CROSS_CHECK_MAX_SIZE];
+    char expected[BASE64_ENCODED_LENGTH(CROSS_CHECK_MAX_SIZE) + 1];
+    char encoded[BASE64_ENCODED_LENGTH(CROSS_CHECK_MAX_SIZE) + 1];
+    unsigned char decoded[CROSS_CHECK_MAX_SIZE];
+    size_t i;
+    fillPseudoRandom(source, sizeof(source), 42);
+
+    for (i = 0; i < sizeof(vectorImplementations) / sizeof(vectorImplementations[0]); i++)
+    {
+        size_t size;
+        if (Base64_SetImplementation(vectorImplementations[i]) != 0)
+        {
+            LogInfo("base64 implementation %s not supported here, skipped", ENUM_TO_STRING(BASE64_IMPLEMENTATION, vectorImplementations[i]));
+            continue;
+        }
+
+        for (size = 0; size <= CROSS_CHECK_MAX_SIZE; size++)
+        {
+            size_t encodedLength;
+            size_t decodedSize;
+
+            ///act
+            ASSERT_ARE_EQUAL(int, 0, Base64_SetImplementation(BASE64_IMPLEMENTATION_PORTABLE));
+            ASSERT_ARE_EQUAL(int, 0, Base64Url_EncodeInto(expected, sizeof(expected), source, size, NULL));
+            ASSERT_ARE_EQUAL(int, 0, Base64_SetImplementation(vectorImplementations[i]));
+            ASSERT_ARE_EQUAL(int, 0, Base64Url_EncodeInto(encoded, sizeof(encoded), source, size, &encodedLength));
+            ASSERT_ARE_EQUAL(int, 0, Base64Url_DecodeInto(decoded, sizeof(decoded), encoded, encodedLength, &decodedSize));
+
+            ///assert
+            ASSERT_ARE_EQUAL(char_ptr, expected, encoded);
+            ASSERT_ARE_EQUAL(size_t, size, decodedSize);
+            ASSERT_ARE_EQUAL(int, 0, memcmp(source, decoded, size));
+
+            ASSERT_ARE_EQUAL(int, 0, Base64_EncodeInto(encoded, sizeof(encoded), source, size, &encodedLength));
+            ASSERT_ARE_EQUAL(int, 0, Base64_DecodeInto(decoded, sizeof(decoded), encoded, encodedLength, &decodedSize));
+            ASSERT_ARE_EQUAL(size_t, size, decodedSize);
+            ASSERT_ARE_EQUAL(int, 0, memcmp(source, decoded, size));
+        }
+    }
+
+    ///cleanup
+    (void)Base64_SetImplementation(BASE64_IMPLEMENTATION_AUTO);
+}
+
+/*Tests_SRS_BASE64_99_010: [ If a character is outside the alphabet then Base64_DecodeInto shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(Base64_every_implementation_rejects_a_character_outside_the_alphabet_anywhere)
+{
+    ///arrange
+    unsigned char source[CROSS_CHECK_MAX_SIZE];
+    char encoded[BASE64_ENCODED_LENGTH(CROSS_CHECK_MAX_SIZE) + 1];
+    unsigned char decoded[CROSS_CHECK_MAX_SIZE];
+    static const char invalid[] = { '.', '\0', '\x80', '\xff', '-', '_' };
+    size_t encodedLength;
+    size_t i;
+    fillPseudoRandom(source, sizeof(source), 7);
+    ASSERT_ARE_EQUAL(int, 0, Base64_EncodeInto(encoded, sizeof(encoded), source, sizeof(source), &encodedLength));
+
+    for (i = 0; i < sizeof(vectorImplementations) / sizeof(vectorImplementations[0]) + 1; i++)
+    {
+        BASE64_IMPLEMENTATION implementation = (i == 0) ? BASE64_IMPLEMENTATION_PORTABLE : vectorImplementations[i - 1];
+        size_t position;
+        if (Base64_SetImplementation(implementation) != 0)
+        {
+            continue;
+        }
+
+        for (position = 0; position < encodedLength; position++)
+        {
+            char saved = encoded[position];
+            int result;
+            encoded[position] = invalid[position % sizeof(invalid)];
+
+            ///act
+            result = Base64_DecodeInto(decoded, sizeof(decoded), encoded, encodedLength, NULL);
+
+            ///assert
+            ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+            encoded[position] = saved;
+        }
+    }
+
+    ///cleanup
+    (void)Base64_SetImplementation(BASE64_IMPLEMENTATION_AUTO);
+}
+
 END_TEST_SUITE(base64_unittests);
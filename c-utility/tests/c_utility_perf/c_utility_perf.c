@@ -0,0 +1,280 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "testrunnerswitcher.h"
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/base64.h"
+#include "azure_c_shared_utility/buffer_.h"
+#include "azure_c_shared_utility/hmacsha256.h"
+#include "azure_c_shared_utility/map.h"
+#include "azure_c_shared_utility/strings.h"
+#include "azure_c_shared_utility/vector.h"
+#include "perf_report.h"
+
+/*iterations of one timed repetition, raise it locally to get stable timings on a noisy machine*/
+#ifndef C_UTILITY_PERF_ITERATIONS
+#define C_UTILITY_PERF_ITERATIONS 20000
+#endif
+
+#define SUITE_NAME "c_utility_perf"
+
+#define STRING_SEGMENT_COUNT 8
+#define MAP_KEY_COUNT 16
+#define VECTOR_ELEMENT_COUNT 64
+#define PAYLOAD_SIZE 256
+#define KEY_SIZE 32
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+static const char* stringSegments[STRING_SEGMENT_COUNT] =
+{
+    "{\"deviceId\":", "\"cellular-device-000042\"", ",\"windSpeed\":", "12",
+    ",\"temperature\":", "21.5", ",\"humidity\":", "64.25}"
+};
+
+static char mapKeys[MAP_KEY_COUNT][16];
+static unsigned char payload[PAYLOAD_SIZE];
+static unsigned char key[KEY_SIZE];
+
+/*builds a telemetry message out of pieces, the way the serializer grows its output*/
+static int STRING_concat_operation(void* context)
+{
+    STRING_HANDLE destination = (STRING_HANDLE)context;
+    int result = STRING_empty(destination);
+    size_t i;
+    for (i = 0; (result == 0) && (i < STRING_SEGMENT_COUNT); i++)
+    {
+        result = STRING_concat(destination, stringSegments[i]);
+    }
+    return result;
+}
+
+static int Map_Add_operation(void* context)
+{
+    int result = 0;
+    MAP_HANDLE map = Map_Create(NULL);
+    size_t i;
+    (void)context;
+    if (map == NULL)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        for (i = 0; i < MAP_KEY_COUNT; i++)
+        {
+            if (Map_Add(map, mapKeys[i], "value") != MAP_OK)
+            {
+                result = __LINE__;
+                break;
+            }
+        }
+        Map_Destroy(map);
+    }
+    return result;
+}
+
+static int VECTOR_push_back_operation(void* context)
+{
+    VECTOR_HANDLE vector = (VECTOR_HANDLE)context;
+    int result = 0;
+    int i;
+    for (i = 0; i < VECTOR_ELEMENT_COUNT; i++)
+    {
+        if (VECTOR_push_back(vector, &i, 1) != 0)
+        {
+            result = __LINE__;
+            break;
+        }
+    }
+    VECTOR_clear(vector);
+    return result;
+}
+
+static int Base64_Encoder_operation(void* context)
+{
+    int result;
+    STRING_HANDLE encoded = Base64_Encoder((BUFFER_HANDLE)context);
+    if (encoded == NULL)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        STRING_delete(encoded);
+        result = 0;
+    }
+    return result;
+}
+
+static int Base64_EncodeInto_operation(void* context)
+{
+    size_t encodedLength;
+    return Base64_EncodeInto((char*)context, BASE64_ENCODED_LENGTH(PAYLOAD_SIZE) + 1, payload, PAYLOAD_SIZE, &encodedLength);
+}
+
+static int HMACSHA256_ComputeHash_operation(void* context)
+{
+    return (HMACSHA256_ComputeHash(key, KEY_SIZE, payload, PAYLOAD_SIZE, (BUFFER_HANDLE)context) == HMACSHA256_OK) ? 0 : __LINE__;
+}
+
+static int HMACSHA256_ComputeHashWithKey_operation(void* context)
+{
+    unsigned char hash[32];
+    return (HMACSHA256_ComputeHashWithKey((HMACSHA256_KEY_HANDLE)context, payload, PAYLOAD_SIZE, hash) == HMACSHA256_OK) ? 0 : __LINE__;
+}
+
+static void RunBenchmark(const char* benchmarkName, PERF_OPERATION operation, void* context)
+{
+    PERF_RESULT result;
+    ASSERT_ARE_EQUAL(int, 0, perf_run(SUITE_NAME, benchmarkName, C_UTILITY_PERF_ITERATIONS, operation, context, &result));
+    ASSERT_IS_TRUE(result.ns_per_op > 0);
+}
+
+BEGIN_TEST_SUITE(c_utility_perf)
+
+    TEST_SUITE_INITIALIZE(TestClassInitialize)
+    {
+        size_t i;
+
+        TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+        g_testByTest = TEST_MUTEX_CREATE();
+        ASSERT_IS_NOT_NULL(g_testByTest);
+        ASSERT_ARE_EQUAL(int, 0, gballoc_init());
+
+        for (i = 0; i < MAP_KEY_COUNT; i++)
+        {
+            (void)sprintf(mapKeys[i], "property%02u", (unsigned int)i);
+        }
+        for (i = 0; i < PAYLOAD_SIZE; i++)
+        {
+            payload[i] = (unsigned char)(i * 31 + 7);
+        }
+        for (i = 0; i < KEY_SIZE; i++)
+        {
+            key[i] = (unsigned char)(i * 17 + 3);
+        }
+    }
+
+    TEST_SUITE_CLEANUP(TestClassCleanup)
+    {
+        gballoc_deinit();
+        TEST_MUTEX_DESTROY(g_testByTest);
+        TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    }
+
+    TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+    {
+        if (TEST_MUTEX_ACQUIRE(g_testByTest))
+        {
+            ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+        }
+    }
+
+    TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+    {
+        TEST_MUTEX_RELEASE(g_testByTest);
+    }
+
+    TEST_FUNCTION(STRING_concat_of_a_telemetry_message)
+    {
+        ///arrange
+        STRING_HANDLE destination = STRING_new();
+        ASSERT_IS_NOT_NULL(destination);
+        ASSERT_ARE_EQUAL(int, 0, STRING_concat_operation(destination));
+        ASSERT_ARE_EQUAL(char_ptr, "{\"deviceId\":\"cellular-device-000042\",\"windSpeed\":12,\"temperature\":21.5,\"humidity\":64.25}", STRING_c_str(destination));
+
+        ///act
+        ///assert
+        RunBenchmark("STRING_concat", STRING_concat_operation, destination);
+
+        ///cleanup
+        STRING_delete(destination);
+    }
+
+    TEST_FUNCTION(Map_Add_of_16_keys)
+    {
+        ///arrange
+        ///act
+        ///assert
+        RunBenchmark("Map_Add", Map_Add_operation, NULL);
+    }
+
+    TEST_FUNCTION(VECTOR_push_back_of_64_elements)
+    {
+        ///arrange
+        VECTOR_HANDLE vector = VECTOR_create(sizeof(int));
+        ASSERT_IS_NOT_NULL(vector);
+
+        ///act
+        ///assert
+        RunBenchmark("VECTOR_push_back", VECTOR_push_back_operation, vector);
+
+        ///cleanup
+        VECTOR_destroy(vector);
+    }
+
+    TEST_FUNCTION(Base64_Encoder_of_256_bytes)
+    {
+        ///arrange
+        BUFFER_HANDLE source = BUFFER_create(payload, PAYLOAD_SIZE);
+        STRING_HANDLE encoded;
+        ASSERT_IS_NOT_NULL(source);
+        encoded = Base64_Encoder(source);
+        ASSERT_IS_NOT_NULL(encoded);
+        ASSERT_ARE_EQUAL(size_t, (size_t)BASE64_ENCODED_LENGTH(PAYLOAD_SIZE), STRING_length(encoded));
+        STRING_delete(encoded);
+
+        ///act
+        ///assert
+        RunBenchmark("Base64_Encoder", Base64_Encoder_operation, source);
+
+        ///cleanup
+        BUFFER_delete(source);
+    }
+
+    TEST_FUNCTION(Base64_EncodeInto_of_256_bytes)
+    {
+        ///arrange
+        char destination[BASE64_ENCODED_LENGTH(PAYLOAD_SIZE) + 1];
+
+        ///act
+        ///assert
+        RunBenchmark("Base64_EncodeInto", Base64_EncodeInto_operation, destination);
+    }
+
+    TEST_FUNCTION(HMACSHA256_ComputeHash_of_256_bytes)
+    {
+        ///arrange
+        BUFFER_HANDLE hash = BUFFER_new();
+        ASSERT_IS_NOT_NULL(hash);
+        ASSERT_ARE_EQUAL(int, 0, HMACSHA256_ComputeHash_operation(hash));
+        ASSERT_ARE_EQUAL(size_t, (size_t)32, BUFFER_length(hash));
+
+        ///act
+        ///assert
+        RunBenchmark("HMACSHA256_ComputeHash", HMACSHA256_ComputeHash_operation, hash);
+
+        ///cleanup
+        BUFFER_delete(hash);
+    }
+
+    TEST_FUNCTION(HMACSHA256_ComputeHashWithKey_of_256_bytes)
+    {
+        ///arrange
+        HMACSHA256_KEY_HANDLE keyHandle = HMACSHA256_CreateKey(key, KEY_SIZE);
+        ASSERT_IS_NOT_NULL(keyHandle);
+
+        ///act
+        ///assert
+        RunBenchmark("HMACSHA256_ComputeHashWithKey", HMACSHA256_ComputeHashWithKey_operation, keyHandle);
+
+        ///cleanup
+        HMACSHA256_DestroyKey(keyHandle);
+    }
+
+END_TEST_SUITE(c_utility_perf)
@@ -0,0 +1,190 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include "azure_c_shared_utility/gballoc.h"
+#include "perf_report.h"
+
+/*this file is the allocator of the perf suites, it calls the CRT directly*/
+#undef malloc
+#undef calloc
+#undef realloc
+#undef free
+
+/*perf suites link this counting allocator instead of gballoc.c: gballoc.c keeps a list of the live blocks
+  under a lock, which would be timed together with the code under measurement. Benchmarks are single threaded,
+  so a plain counter is enough.*/
+static size_t g_allocations = 0;
+
+int gballoc_init(void)
+{
+    g_allocations = 0;
+    return 0;
+}
+
+void gballoc_deinit(void)
+{
+}
+
+void* gballoc_malloc(size_t size)
+{
+    g_allocations++;
+    return malloc(size);
+}
+
+void* gballoc_calloc(size_t nmemb, size_t size)
+{
+    g_allocations++;
+    return calloc(nmemb, size);
+}
+
+void* gballoc_realloc(void* ptr, size_t size)
+{
+    g_allocations++;
+    return realloc(ptr, size);
+}
+
+void gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+/*sizes are not tracked, these answer like a build without GB_DEBUG_ALLOC*/
+size_t gballoc_getMaximumMemoryUsed(void)
+{
+    return SIZE_MAX;
+}
+
+size_t gballoc_getCurrentMemoryUsed(void)
+{
+    return SIZE_MAX;
+}
+
+size_t gballoc_getAllocationCount(void)
+{
+    return g_allocations;
+}
+
+void gballoc_resetMetrics(void)
+{
+    g_allocations = 0;
+}
+
+static double get_monotonic_ns(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    (void)QueryPerformanceFrequency(&frequency);
+    (void)QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1e9 / (double)frequency.QuadPart;
+#else
+    struct timespec now;
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec * 1e9 + (double)now.tv_nsec;
+#endif
+}
+
+static int run_iterations(size_t iterations, PERF_OPERATION operation, void* context)
+{
+    int result = 0;
+    size_t i;
+    for (i = 0; i < iterations; i++)
+    {
+        if (operation(context) != 0)
+        {
+            result = __LINE__;
+            break;
+        }
+    }
+    return result;
+}
+
+static void write_result(FILE* destination, const char* suite_name, const char* benchmark_name, const PERF_RESULT* result)
+{
+    (void)fprintf(destination, "{\"suite\":\"%s\",\"benchmark\":\"%s\",\"iterations\":%lu,\"ns_per_op\":%.1f,\"median_ns_per_op\":%.1f,\"allocs_per_op\":%.2f}\n",
+        suite_name, benchmark_name, (unsigned long)result->iterations, result->ns_per_op, result->median_ns_per_op, result->allocs_per_op);
+}
+
+int perf_run(const char* suite_name, const char* benchmark_name, size_t iterations, PERF_OPERATION operation, void* context, PERF_RESULT* result)
+{
+    int run_result;
+    double samples[PERF_REPETITIONS];
+    size_t allocations;
+    size_t i;
+
+    if ((suite_name == NULL) || (benchmark_name == NULL) || (iterations == 0) || (operation == NULL) || (result == NULL))
+    {
+        run_result = __LINE__;
+    }
+    /*the warm up fills caches and lets the allocator reach its steady state, it is not reported*/
+    else if (run_iterations(iterations, operation, context) != 0)
+    {
+        run_result = __LINE__;
+    }
+    else
+    {
+        run_result = 0;
+        allocations = g_allocations;
+        for (i = 0; i < PERF_REPETITIONS; i++)
+        {
+            double start = get_monotonic_ns();
+            if (run_iterations(iterations, operation, context) != 0)
+            {
+                run_result = __LINE__;
+                break;
+            }
+            samples[i] = (get_monotonic_ns() - start) / (double)iterations;
+        }
+
+        if (run_result == 0)
+        {
+            const char* results_file_name;
+            size_t j;
+
+            allocations = g_allocations - allocations;
+
+            /*insertion sort, PERF_REPETITIONS is small*/
+            for (i = 1; i < PERF_REPETITIONS; i++)
+            {
+                double sample = samples[i];
+                for (j = i; (j > 0) && (samples[j - 1] > sample); j--)
+                {
+                    samples[j] = samples[j - 1];
+                }
+                samples[j] = sample;
+            }
+
+            result->iterations = iterations;
+            result->ns_per_op = samples[0];
+            result->median_ns_per_op = samples[PERF_REPETITIONS / 2];
+            result->allocs_per_op = (double)allocations / ((double)iterations * PERF_REPETITIONS);
+
+            write_result(stdout, suite_name, benchmark_name, result);
+            (void)fflush(stdout);
+
+            results_file_name = getenv("PERF_RESULTS_FILE");
+            if (results_file_name != NULL)
+            {
+                FILE* results_file = fopen(results_file_name, "a");
+                if (results_file == NULL)
+                {
+                    run_result = __LINE__;
+                }
+                else
+                {
+                    write_result(results_file, suite_name, benchmark_name, result);
+                    (void)fclose(results_file);
+                }
+            }
+        }
+    }
+
+    return run_result;
+}
@@ -0,0 +1,40 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef PERF_REPORT_H
+#define PERF_REPORT_H
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#endif
+
+/*number of timed repetitions of every benchmark, the fastest one is reported as ns_per_op*/
+#ifndef PERF_REPETITIONS
+#define PERF_REPETITIONS 5
+#endif
+
+/*one operation of a benchmark, it returns 0 when the operation succeeded*/
+typedef int(*PERF_OPERATION)(void* context);
+
+typedef struct PERF_RESULT_TAG
+{
+    size_t iterations;
+    double ns_per_op;
+    double median_ns_per_op;
+    double allocs_per_op;
+} PERF_RESULT;
+
+/*runs operation iterations times per repetition after one untimed warm up repetition, and writes one JSON line
+  {"suite":...,"benchmark":...,"iterations":...,"ns_per_op":...,"median_ns_per_op":...,"allocs_per_op":...}
+  to stdout and, when the PERF_RESULTS_FILE environment variable is set, appends it to that file.
+  Returns 0 when every operation succeeded.*/
+extern int perf_run(const char* suite_name, const char* benchmark_name, size_t iterations, PERF_OPERATION operation, void* context, PERF_RESULT* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PERF_REPORT_H */
@@ -388,6 +388,123 @@ TEST_FUNCTION(Condition_Wait_ok_on_trigger_with_timeout)
     umock_c_reset_all_calls();
 }
 
+// Tests_SRS_CONDITION_99_001: [ Condition_WaitNanoseconds shall return COND_INVALID_ARG if handle or lock is NULL ]
+TEST_FUNCTION(Condition_WaitNanoseconds_Handle_NULL_Fail)
+{
+    // arrange
+    COND_RESULT result;
+
+    // act
+    result = Condition_WaitNanoseconds(NULL, TEST_LOCK_HANDLE, 1000000);
+
+    // assert
+    ASSERT_ARE_EQUAL(COND_RESULT, COND_INVALID_ARG, result);
+}
+
+// Tests_SRS_CONDITION_99_001: [ Condition_WaitNanoseconds shall return COND_INVALID_ARG if handle or lock is NULL ]
+TEST_FUNCTION(Condition_WaitNanoseconds_LOCK_NULL_Fail)
+{
+    // arrange
+    COND_HANDLE handle = Condition_Init();
+    COND_RESULT result;
+
+    // act
+    result = Condition_WaitNanoseconds(handle, NULL, 1000000);
+
+    // assert
+    ASSERT_ARE_EQUAL(COND_RESULT, COND_INVALID_ARG, result);
+    Condition_Deinit(handle);
+}
+
+// Tests_SRS_CONDITION_99_004: [ Condition_WaitNanoseconds shall return COND_TIMEOUT if the condition is NOT triggered and timeout_nanoseconds is not 0 ]
+TEST_FUNCTION(Condition_WaitNanoseconds_timeout_when_not_triggered)
+{
+    // arrange
+    LockAndCondition m;
+    COND_RESULT result;
+    m.condition = Condition_Init();
+    m.lock = Lock_Init();
+
+    // act
+    Lock(m.lock);
+    result = Condition_WaitNanoseconds(m.condition, m.lock, 150 * 1000000ULL);
+    Unlock(m.lock);
+
+    // assert
+    ASSERT_ARE_EQUAL(COND_RESULT, COND_TIMEOUT, result);
+    Lock_Deinit(m.lock);
+    Condition_Deinit(m.condition);
+}
+
+// Tests_SRS_CONDITION_99_004: [ Condition_WaitNanoseconds shall return COND_TIMEOUT if the condition is NOT triggered and timeout_nanoseconds is not 0 ]
+TEST_FUNCTION(Condition_WaitNanoseconds_times_out_below_one_millisecond)
+{
+    // arrange
+    LockAndCondition m;
+    COND_RESULT result;
+    m.condition = Condition_Init();
+    m.lock = Lock_Init();
+
+    // act
+    Lock(m.lock);
+    result = Condition_WaitNanoseconds(m.condition, m.lock, 1000);
+    Unlock(m.lock);
+
+    // assert
+    ASSERT_ARE_EQUAL(COND_RESULT, COND_TIMEOUT, result);
+    Lock_Deinit(m.lock);
+    Condition_Deinit(m.condition);
+}
+
+// Tests_SRS_CONDITION_99_002: [ Condition_WaitNanoseconds shall measure timeout_nanoseconds on a monotonic clock when the platform has one ]
+// Tests_SRS_CONDITION_99_003: [ Condition_WaitNanoseconds shall return COND_OK if the condition is triggered ]
+TEST_FUNCTION(Condition_WaitNanoseconds_ok_on_trigger_with_timeout)
+{
+    // arrange
+    LockAndCondition m;
+    COND_RESULT result;
+    THREAD_HANDLE th;
+    m.condition = Condition_Init();
+    m.lock = Lock_Init();
+
+    // act
+    th = trigger_after_50_ms(&m);
+    Lock(m.lock);
+    result = Condition_WaitNanoseconds(m.condition, m.lock, 1000 * 1000000ULL);
+    Unlock(m.lock);
+    ThreadAPI_Join(th, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(COND_RESULT, COND_OK, result);
+    Lock_Deinit(m.lock);
+    Condition_Deinit(m.condition);
+    umock_c_reset_all_calls();
+}
+
+// Tests_SRS_CONDITION_99_003: [ Condition_WaitNanoseconds shall return COND_OK if the condition is triggered ]
+TEST_FUNCTION(Condition_WaitNanoseconds_ok_on_trigger_with_a_timeout_past_the_end_of_time)
+{
+    // arrange
+    LockAndCondition m;
+    COND_RESULT result;
+    THREAD_HANDLE th;
+    m.condition = Condition_Init();
+    m.lock = Lock_Init();
+
+    // act
+    th = trigger_after_50_ms(&m);
+    Lock(m.lock);
+    result = Condition_WaitNanoseconds(m.condition, m.lock, UINT64_MAX);
+    Unlock(m.lock);
+    ThreadAPI_Join(th, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(COND_RESULT, COND_OK, result);
+    Lock_Deinit(m.lock);
+    Condition_Deinit(m.condition);
+    umock_c_reset_all_calls();
+}
+
 END_TEST_SUITE(Condition_UnitTests);
 
 /*if malloc is defined as gballoc_malloc at this moment, there'd be serious trouble*/
@@ -3,8 +3,10 @@
 
 #ifdef __cplusplus
 #include <cstddef>
+#include <cstring>
 #else
 #include <stddef.h>
+#include <string.h>
 #endif
 
 #include "testrunnerswitcher.h"
@@ -170,4 +172,117 @@ TEST_FUNCTION(HMACSHA256_ComputeHash_Succeeds)
     ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(hash), expectedHash, 8));
 }
 
+/* HMACSHA256_CreateKey */
+
+TEST_FUNCTION(HMACSHA256_CreateKey_With_NULL_Key_Fails)
+{
+    // act
+    HMACSHA256_KEY_HANDLE key = HMACSHA256_CreateKey(NULL, 3);
+
+    // assert
+    ASSERT_IS_NULL(key);
+}
+
+TEST_FUNCTION(HMACSHA256_CreateKey_With_Zero_Key_Buffer_Size_Fails)
+{
+    // arrange
+    static const unsigned char keyBytes[] = "key";
+
+    // act
+    HMACSHA256_KEY_HANDLE key = HMACSHA256_CreateKey(keyBytes, 0);
+
+    // assert
+    ASSERT_IS_NULL(key);
+}
+
+/* HMACSHA256_ComputeHashWithKey */
+
+TEST_FUNCTION(HMACSHA256_ComputeHashWithKey_With_NULL_Key_Fails)
+{
+    // arrange
+    static const unsigned char buffer[] = "testPayload";
+    unsigned char keyedHash[HMACSHA256_HASH_SIZE];
+
+    // act
+    HMACSHA256_RESULT result = HMACSHA256_ComputeHashWithKey(NULL, buffer, sizeof(buffer) - 1, keyedHash);
+
+    // assert
+    ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_INVALID_ARG, result);
+}
+
+TEST_FUNCTION(HMACSHA256_ComputeHashWithKey_Can_Be_Reused_And_Matches_ComputeHash)
+{
+    // arrange
+    static const unsigned char keyBytes[] = "key";
+    static const unsigned char buffer[] = "testPayload";
+    static const unsigned char otherBuffer[] = "otherPayload";
+    unsigned char keyedHash[HMACSHA256_HASH_SIZE];
+    HMACSHA256_KEY_HANDLE key = HMACSHA256_CreateKey(keyBytes, sizeof(keyBytes) - 1);
+    ASSERT_IS_NOT_NULL(key);
+
+    // act
+    // assert
+    ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_OK, HMACSHA256_ComputeHashWithKey(key, buffer, sizeof(buffer) - 1, keyedHash));
+    ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_OK, HMACSHA256_ComputeHash(keyBytes, sizeof(keyBytes) - 1, buffer, sizeof(buffer) - 1, hash));
+    ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(hash), keyedHash, HMACSHA256_HASH_SIZE));
+
+    ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_OK, HMACSHA256_ComputeHashWithKey(key, otherBuffer, sizeof(otherBuffer) - 1, keyedHash));
+    ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_OK, HMACSHA256_ComputeHash(keyBytes, sizeof(keyBytes) - 1, otherBuffer, sizeof(otherBuffer) - 1, hash));
+    ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(hash), keyedHash, HMACSHA256_HASH_SIZE));
+
+    // cleanup
+    HMACSHA256_DestroyKey(key);
+}
+
+TEST_FUNCTION(HMACSHA256_ComputeHashWithKey_With_A_Key_Longer_Than_A_Block_Succeeds)
+{
+    // arrange
+    /* RFC 4231, test case 6 */
+    static const unsigned char buffer[] = "Test Using Larger Than Block-Size Key - Hash Key First";
+    unsigned char keyBytes[131];
+    unsigned char expectedHash[HMACSHA256_HASH_SIZE] = { 0x60, 0xe4, 0x31, 0x59, 0x1e, 0xe0, 0xb6, 0x7f, 0x0d, 0x8a, 0x26, 0xaa, 0xcb, 0xf5, 0xb7, 0x7f, 0x8e, 0x0b, 0xc6, 0x21, 0x37, 0x28, 0xc5, 0x14, 0x05, 0x46, 0x04, 0x0f, 0x0e, 0xe3, 0x7f, 0x54 };
+    unsigned char keyedHash[HMACSHA256_HASH_SIZE];
+    HMACSHA256_KEY_HANDLE key;
+    HMACSHA256_RESULT result;
+    memset(keyBytes, 0xaa, sizeof(keyBytes));
+    key = HMACSHA256_CreateKey(keyBytes, sizeof(keyBytes));
+    ASSERT_IS_NOT_NULL(key);
+
+    // act
+    result = HMACSHA256_ComputeHashWithKey(key, buffer, sizeof(buffer) - 1, keyedHash);
+
+    // assert
+    ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_OK, result);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(expectedHash, keyedHash, HMACSHA256_HASH_SIZE));
+
+    // cleanup
+    HMACSHA256_DestroyKey(key);
+}
+
+/* HMACSHA256_CreateKeyWithPrefix */
+
+TEST_FUNCTION(HMACSHA256_CreateKeyWithPrefix_Hashes_The_Prefix_Before_The_Payload)
+{
+    // arrange
+    static const unsigned char keyBytes[] = "key";
+    static const unsigned char prefix[] = "myhub.azure-devices.net/devices/dev1\n";
+    static const unsigned char buffer[] = "1500000000";
+    static const unsigned char prefixAndBuffer[] = "myhub.azure-devices.net/devices/dev1\n1500000000";
+    unsigned char keyedHash[HMACSHA256_HASH_SIZE];
+    HMACSHA256_KEY_HANDLE key = HMACSHA256_CreateKeyWithPrefix(keyBytes, sizeof(keyBytes) - 1, prefix, sizeof(prefix) - 1);
+    HMACSHA256_RESULT result;
+    ASSERT_IS_NOT_NULL(key);
+
+    // act
+    result = HMACSHA256_ComputeHashWithKey(key, buffer, sizeof(buffer) - 1, keyedHash);
+
+    // assert
+    ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_OK, result);
+    ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_OK, HMACSHA256_ComputeHash(keyBytes, sizeof(keyBytes) - 1, prefixAndBuffer, sizeof(prefixAndBuffer) - 1, hash));
+    ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(hash), keyedHash, HMACSHA256_HASH_SIZE));
+
+    // cleanup
+    HMACSHA256_DestroyKey(key);
+}
+
 END_TEST_SUITE(HMACSHA256_UnitTests)
@@ -0,0 +1,646 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/buffer_.h"
+#include "azure_c_shared_utility/httpheaders.h"
+#include "azure_c_shared_utility/httpapi.h"
+#undef ENABLE_MOCKS
+
+#include "httpapi_streaming.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    extern BUFFER_HANDLE real_BUFFER_new(void);
+    extern void real_BUFFER_delete(BUFFER_HANDLE handle);
+    extern int real_BUFFER_build(BUFFER_HANDLE handle, const unsigned char* source, size_t size);
+    extern int real_BUFFER_append_build(BUFFER_HANDLE handle, const unsigned char* source, size_t size);
+    extern unsigned char* real_BUFFER_u_char(BUFFER_HANDLE handle);
+    extern size_t real_BUFFER_length(BUFFER_HANDLE handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+DEFINE_ENUM_STRINGS(HTTPAPI_RESULT, HTTPAPI_RESULT_VALUES);
+TEST_DEFINE_ENUM_TYPE(HTTPAPI_RESULT, HTTPAPI_RESULT_VALUES);
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+#define TEST_HTTP_HANDLE (HTTP_HANDLE)0x4242
+#define TEST_RELATIVE_PATH "/blobs/firmware.bin"
+#define TEST_MAX_HEADERS 8
+#define TEST_MAX_HEADERS_HANDLES 8
+#define TEST_MAX_ATTEMPTS 5
+
+/*just enough of httpheaders to see what the resumed requests ask for*/
+typedef struct TEST_HEADERS_TAG
+{
+    bool isUsed;
+    size_t count;
+    char names[TEST_MAX_HEADERS][32];
+    char values[TEST_MAX_HEADERS][64];
+} TEST_HEADERS;
+
+static TEST_HEADERS testHeaders[TEST_MAX_HEADERS_HANDLES];
+
+static HTTP_HEADERS_HANDLE my_HTTPHeaders_Alloc(void)
+{
+    HTTP_HEADERS_HANDLE result = NULL;
+    size_t i;
+    for (i = 0; (i < TEST_MAX_HEADERS_HANDLES) && (result == NULL); i++)
+    {
+        if (!testHeaders[i].isUsed)
+        {
+            (void)memset(&testHeaders[i], 0, sizeof(testHeaders[i]));
+            testHeaders[i].isUsed = true;
+            result = (HTTP_HEADERS_HANDLE)&testHeaders[i];
+        }
+    }
+    return result;
+}
+
+static void my_HTTPHeaders_Free(HTTP_HEADERS_HANDLE httpHeadersHandle)
+{
+    ((TEST_HEADERS*)httpHeadersHandle)->isUsed = false;
+}
+
+static HTTP_HEADERS_HANDLE my_HTTPHeaders_Clone(HTTP_HEADERS_HANDLE handle)
+{
+    HTTP_HEADERS_HANDLE result = my_HTTPHeaders_Alloc();
+    if (result != NULL)
+    {
+        (void)memcpy(result, handle, sizeof(TEST_HEADERS));
+    }
+    return result;
+}
+
+static const char* my_HTTPHeaders_FindHeaderValue(HTTP_HEADERS_HANDLE httpHeadersHandle, const char* name)
+{
+    TEST_HEADERS* headers = (TEST_HEADERS*)httpHeadersHandle;
+    const char* result = NULL;
+    size_t i;
+    for (i = 0; (i < headers->count) && (result == NULL); i++)
+    {
+        if (strcmp(headers->names[i], name) == 0)
+        {
+            result = headers->values[i];
+        }
+    }
+    return result;
+}
+
+static HTTP_HEADERS_RESULT my_HTTPHeaders_ReplaceHeaderNameValuePair(HTTP_HEADERS_HANDLE httpHeadersHandle, const char* name, const char* value)
+{
+    TEST_HEADERS* headers = (TEST_HEADERS*)httpHeadersHandle;
+    size_t i;
+    for (i = 0; i < headers->count; i++)
+    {
+        if (strcmp(headers->names[i], name) == 0)
+        {
+            break;
+        }
+    }
+    ASSERT_IS_TRUE(i < TEST_MAX_HEADERS);
+    (void)strcpy(headers->names[i], name);
+    (void)strcpy(headers->values[i], value);
+    if (i == headers->count)
+    {
+        headers->count++;
+    }
+    return HTTP_HEADERS_OK;
+}
+
+/*what each call to testExecute answers, and what it was asked*/
+typedef struct TEST_ATTEMPT_TAG
+{
+    unsigned int statusCode;
+    const char* headers[TEST_MAX_HEADERS * 2]; /*name, value, ..., NULL*/
+    const char* body;
+    HTTPAPI_RESULT result;
+    HTTPAPI_REQUEST_TYPE requestType;
+    char range[64];
+    char ifRange[64];
+} TEST_ATTEMPT;
+
+static TEST_ATTEMPT testAttempts[TEST_MAX_ATTEMPTS];
+static size_t testAttemptCount;
+
+static HTTPAPI_RESULT testExecute(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
+    HTTP_HEADERS_HANDLE httpHeadersHandle, ON_HTTPAPI_REQUEST_BODY_READ onRequestBodyRead, void* requestBodyContext,
+    unsigned int* statusCode, HTTP_HEADERS_HANDLE responseHeadersHandle,
+    ON_HTTPAPI_RESPONSE_BODY_RECEIVED onResponseBodyReceived, void* responseBodyContext)
+{
+    TEST_ATTEMPT* attempt;
+    const char* value;
+    HTTPAPI_RESULT result;
+    size_t i;
+
+    (void)onRequestBodyRead;
+    (void)requestBodyContext;
+    ASSERT_IS_TRUE(testAttemptCount < TEST_MAX_ATTEMPTS);
+    ASSERT_ARE_EQUAL(void_ptr, TEST_HTTP_HANDLE, handle);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_RELATIVE_PATH, relativePath);
+
+    attempt = &testAttempts[testAttemptCount++];
+    attempt->requestType = requestType;
+    value = my_HTTPHeaders_FindHeaderValue(httpHeadersHandle, "Range");
+    (void)strcpy(attempt->range, (value == NULL) ? "" : value);
+    value = my_HTTPHeaders_FindHeaderValue(httpHeadersHandle, "If-Range");
+    (void)strcpy(attempt->ifRange, (value == NULL) ? "" : value);
+
+    *statusCode = attempt->statusCode;
+    for (i = 0; attempt->headers[i] != NULL; i += 2)
+    {
+        (void)my_HTTPHeaders_ReplaceHeaderNameValuePair(responseHeadersHandle, attempt->headers[i], attempt->headers[i + 1]);
+    }
+
+    result = attempt->result;
+    if ((attempt->body != NULL) &&
+        (onResponseBodyReceived != NULL) &&
+        (onResponseBodyReceived(responseBodyContext, (const unsigned char*)attempt->body, strlen(attempt->body)) != 0))
+    {
+        result = HTTPAPI_READ_DATA_FAILED;
+    }
+    return result;
+}
+
+typedef struct TEST_BODY_TAG
+{
+    char received[64];
+    size_t receivedSize;
+    int receivedCalls;
+    int receiveFailsAt;
+    const char* requestBody;
+} TEST_BODY;
+
+static TEST_BODY testBody;
+
+static int onTestResponseBodyReceived(void* context, const unsigned char* buffer, size_t size)
+{
+    TEST_BODY* body = (TEST_BODY*)context;
+    int result;
+
+    body->receivedCalls++;
+    if (body->receivedCalls == body->receiveFailsAt)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        ASSERT_IS_TRUE(body->receivedSize + size < sizeof(body->received));
+        (void)memcpy(body->received + body->receivedSize, buffer, size);
+        body->receivedSize += size;
+        result = 0;
+    }
+    return result;
+}
+
+/*hands the request body out 3 bytes at a time*/
+static int onTestRequestBodyRead(void* context, unsigned char* buffer, size_t bufferSize, size_t* bytesWritten)
+{
+    TEST_BODY* body = (TEST_BODY*)context;
+    size_t left = strlen(body->requestBody);
+    *bytesWritten = (left < 3) ? left : 3;
+    ASSERT_IS_TRUE(*bytesWritten <= bufferSize);
+    (void)memcpy(buffer, body->requestBody, *bytesWritten);
+    body->requestBody += *bytesWritten;
+    return 0;
+}
+
+static const char* testResponseContent;
+
+static HTTPAPI_RESULT my_HTTPAPI_ExecuteRequest(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
+    HTTP_HEADERS_HANDLE httpHeadersHandle, const unsigned char* content, size_t contentLength, unsigned int* statusCode,
+    HTTP_HEADERS_HANDLE responseHeadersHandle, BUFFER_HANDLE responseContent)
+{
+    (void)handle;
+    (void)requestType;
+    (void)relativePath;
+    (void)httpHeadersHandle;
+    (void)responseHeadersHandle;
+    ASSERT_ARE_EQUAL(size_t, strlen("0123456789"), contentLength);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(content, "0123456789", contentLength));
+    *statusCode = 200;
+    ASSERT_ARE_EQUAL(int, 0, real_BUFFER_build(responseContent, (const unsigned char*)testResponseContent, strlen(testResponseContent)));
+    return HTTPAPI_OK;
+}
+
+static HTTPAPI_RESULT executeWithResume(HTTPAPI_REQUEST_TYPE requestType, unsigned int* statusCode)
+{
+    HTTPAPI_RESULT result;
+    HTTP_HEADERS_HANDLE requestHeaders = my_HTTPHeaders_Alloc();
+    HTTP_HEADERS_HANDLE responseHeaders = my_HTTPHeaders_Alloc();
+
+    result = HTTPAPIStreaming_ExecuteWithResume(testExecute, TEST_HTTP_HANDLE, requestType, TEST_RELATIVE_PATH, requestHeaders, NULL, NULL,
+        statusCode, responseHeaders, onTestResponseBodyReceived, &testBody);
+
+    /*the caller's request headers are left as they were*/
+    ASSERT_IS_NULL(my_HTTPHeaders_FindHeaderValue(requestHeaders, "Range"));
+    my_HTTPHeaders_Free(requestHeaders);
+    my_HTTPHeaders_Free(responseHeaders);
+    return result;
+}
+
+static void setAttempt(size_t index, unsigned int statusCode, const char* body, HTTPAPI_RESULT result)
+{
+    testAttempts[index].statusCode = statusCode;
+    testAttempts[index].body = body;
+    testAttempts[index].result = result;
+}
+
+static void assertNoHeadersHandleLeaked(void)
+{
+    size_t i;
+    for (i = 0; i < TEST_MAX_HEADERS_HANDLES; i++)
+    {
+        ASSERT_IS_FALSE(testHeaders[i].isUsed);
+    }
+}
+
+BEGIN_TEST_SUITE(httpapi_streaming_ut)
+
+TEST_SUITE_INITIALIZE(suite_init)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    umock_c_init(on_umock_c_error);
+    ASSERT_ARE_EQUAL(int, 0, umocktypes_charptr_register_types());
+
+    REGISTER_UMOCK_ALIAS_TYPE(HTTP_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(HTTP_HEADERS_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(HTTP_HEADERS_RESULT, int);
+    REGISTER_UMOCK_ALIAS_TYPE(HTTPAPI_REQUEST_TYPE, int);
+    REGISTER_UMOCK_ALIAS_TYPE(HTTPAPI_RESULT, int);
+    REGISTER_UMOCK_ALIAS_TYPE(const unsigned char*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(unsigned char*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(unsigned int*, void*);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_Alloc, my_HTTPHeaders_Alloc);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_Free, my_HTTPHeaders_Free);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_Clone, my_HTTPHeaders_Clone);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_FindHeaderValue, my_HTTPHeaders_FindHeaderValue);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_ReplaceHeaderNameValuePair, my_HTTPHeaders_ReplaceHeaderNameValuePair);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPI_ExecuteRequest, my_HTTPAPI_ExecuteRequest);
+    REGISTER_GLOBAL_MOCK_HOOK(BUFFER_new, real_BUFFER_new);
+    REGISTER_GLOBAL_MOCK_HOOK(BUFFER_delete, real_BUFFER_delete);
+    REGISTER_GLOBAL_MOCK_HOOK(BUFFER_append_build, real_BUFFER_append_build);
+    REGISTER_GLOBAL_MOCK_HOOK(BUFFER_u_char, real_BUFFER_u_char);
+    REGISTER_GLOBAL_MOCK_HOOK(BUFFER_length, real_BUFFER_length);
+}
+
+TEST_SUITE_CLEANUP(suite_cleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("Could not acquire test serialization mutex.");
+    }
+
+    (void)memset(testHeaders, 0, sizeof(testHeaders));
+    (void)memset(testAttempts, 0, sizeof(testAttempts));
+    testAttemptCount = 0;
+    (void)memset(&testBody, 0, sizeof(testBody));
+    umock_c_reset_all_calls();
+}
+
+TEST_FUNCTION_CLEANUP(method_cleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* HTTPAPIStreaming_ExecuteWithResume */
+
+TEST_FUNCTION(HTTPAPIStreaming_ExecuteWithResume_resumes_a_cut_200_with_Range_and_If_Range)
+{
+    // arrange
+    unsigned int statusCode = 0;
+    HTTPAPI_RESULT result;
+    setAttempt(0, 200, "01234", HTTPAPI_READ_DATA_FAILED);
+    testAttempts[0].headers[0] = "ETag";
+    testAttempts[0].headers[1] = "\"v1\"";
+    setAttempt(1, 206, "56789", HTTPAPI_OK);
+    testAttempts[1].headers[0] = "Content-Range";
+    testAttempts[1].headers[1] = "bytes 5-9/10";
+
+    // act
+    result = executeWithResume(HTTPAPI_REQUEST_GET, &statusCode);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, result);
+    ASSERT_ARE_EQUAL(int, 200, statusCode);
+    ASSERT_ARE_EQUAL(size_t, 2, testAttemptCount);
+    ASSERT_ARE_EQUAL(char_ptr, "", testAttempts[0].range);
+    ASSERT_ARE_EQUAL(char_ptr, "bytes=5-", testAttempts[1].range);
+    ASSERT_ARE_EQUAL(char_ptr, "\"v1\"", testAttempts[1].ifRange);
+    ASSERT_ARE_EQUAL(size_t, 10, testBody.receivedSize);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(testBody.received, "0123456789", 10));
+    assertNoHeadersHandleLeaked();
+}
+
+TEST_FUNCTION(HTTPAPIStreaming_ExecuteWithResume_resumes_a_cut_206_up_to_its_last_byte)
+{
+    // arrange
+    unsigned int statusCode = 0;
+    HTTPAPI_RESULT result;
+    setAttempt(0, 206, "abcd", HTTPAPI_READ_DATA_FAILED);
+    testAttempts[0].headers[0] = "Content-Range";
+    testAttempts[0].headers[1] = "bytes 10-19/100";
+    testAttempts[0].headers[2] = "Last-Modified";
+    testAttempts[0].headers[3] = "Wed, 21 Oct 2015 07:28:00 GMT";
+    setAttempt(1, 206, "efghij", HTTPAPI_OK);
+    testAttempts[1].headers[0] = "Content-Range";
+    testAttempts[1].headers[1] = "bytes 14-19/100";
+
+    // act
+    result = executeWithResume(HTTPAPI_REQUEST_GET, &statusCode);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, result);
+    ASSERT_ARE_EQUAL(int, 206, statusCode);
+    ASSERT_ARE_EQUAL(char_ptr, "bytes=14-19", testAttempts[1].range);
+    ASSERT_ARE_EQUAL(char_ptr, "Wed, 21 Oct 2015 07:28:00 GMT", testAttempts[1].ifRange);
+    ASSERT_ARE_EQUAL(size_t, 10, testBody.receivedSize);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(testBody.received, "abcdefghij", 10));
+    assertNoHeadersHandleLeaked();
+}
+
+TEST_FUNCTION(HTTPAPIStreaming_ExecuteWithResume_finds_lower_case_headers_with_leading_spaces)
+{
+    // arrange
+    unsigned int statusCode = 0;
+    HTTPAPI_RESULT result;
+    setAttempt(0, 200, "012", HTTPAPI_OPEN_REQUEST_FAILED);
+    testAttempts[0].headers[0] = "etag";
+    testAttempts[0].headers[1] = " \"v2\"";
+    setAttempt(1, 206, "345", HTTPAPI_OK);
+    testAttempts[1].headers[0] = "content-range";
+    testAttempts[1].headers[1] = " bytes 3-5/6";
+
+    // act
+    result = executeWithResume(HTTPAPI_REQUEST_GET, &statusCode);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, "bytes=3-", testAttempts[1].range);
+    ASSERT_ARE_EQUAL(char_ptr, "\"v2\"", testAttempts[1].ifRange);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(testBody.received, "012345", 6));
+}
+
+TEST_FUNCTION(HTTPAPIStreaming_ExecuteWithResume_prefers_Last_Modified_to_a_weak_ETag)
+{
+    // arrange
+    unsigned int statusCode = 0;
+    HTTPAPI_RESULT result;
+    setAttempt(0, 200, "0", HTTPAPI_READ_DATA_FAILED);
+    testAttempts[0].headers[0] = "ETag";
+    testAttempts[0].headers[1] = "W/\"v1\"";
+    testAttempts[0].headers[2] = "Last-Modified";
+    testAttempts[0].headers[3] = "Wed, 21 Oct 2015 07:28:00 GMT";
+    setAttempt(1, 206, "1", HTTPAPI_OK);
+    testAttempts[1].headers[0] = "Content-Range";
+    testAttempts[1].headers[1] = "bytes 1-1/2";
+
+    // act
+    result = executeWithResume(HTTPAPI_REQUEST_GET, &statusCode);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, "Wed, 21 Oct 2015 07:28:00 GMT", testAttempts[1].ifRange);
+}
+
+TEST_FUNCTION(HTTPAPIStreaming_ExecuteWithResume_does_not_resume_without_a_validator)
+{
+    // arrange
+    unsigned int statusCode = 0;
+    HTTPAPI_RESULT result;
+    setAttempt(0, 200, "01234", HTTPAPI_READ_DATA_FAILED);
+    testAttempts[0].headers[0] = "ETag";
+    testAttempts[0].headers[1] = "W/\"v1\"";
+
+    // act
+    result = executeWithResume(HTTPAPI_REQUEST_GET, &statusCode);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_READ_DATA_FAILED, result);
+    ASSERT_ARE_EQUAL(size_t, 1, testAttemptCount);
+    ASSERT_ARE_EQUAL(size_t, 5, testBody.receivedSize);
+}
+
+TEST_FUNCTION(HTTPAPIStreaming_ExecuteWithResume_does_not_resume_a_POST)
+{
+    // arrange
+    unsigned int statusCode = 0;
+    HTTPAPI_RESULT result;
+    setAttempt(0, 200, "01234", HTTPAPI_READ_DATA_FAILED);
+    testAttempts[0].headers[0] = "ETag";
+    testAttempts[0].headers[1] = "\"v1\"";
+
+    // act
+    result = executeWithResume(HTTPAPI_REQUEST_POST, &statusCode);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_READ_DATA_FAILED, result);
+    ASSERT_ARE_EQUAL(size_t, 1, testAttemptCount);
+    ASSERT_ARE_EQUAL(int, 200, statusCode);
+}
+
+TEST_FUNCTION(HTTPAPIStreaming_ExecuteWithResume_does_not_resume_when_the_consumer_fails)
+{
+    // arrange
+    unsigned int statusCode = 0;
+    HTTPAPI_RESULT result;
+    setAttempt(0, 200, "01234", HTTPAPI_OK);
+    testAttempts[0].headers[0] = "ETag";
+    testAttempts[0].headers[1] = "\"v1\"";
+    testBody.receiveFailsAt = 1;
+
+    // act
+    result = executeWithResume(HTTPAPI_REQUEST_GET, &statusCode);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_READ_DATA_FAILED, result);
+    ASSERT_ARE_EQUAL(size_t, 1, testAttemptCount);
+}
+
+TEST_FUNCTION(HTTPAPIStreaming_ExecuteWithResume_does_not_resume_before_the_body)
+{
+    // arrange
+    unsigned int statusCode = 0;
+    HTTPAPI_RESULT result;
+    setAttempt(0, 200, NULL, HTTPAPI_READ_DATA_FAILED);
+    testAttempts[0].headers[0] = "ETag";
+    testAttempts[0].headers[1] = "\"v1\"";
+
+    // act
+    result = executeWithResume(HTTPAPI_REQUEST_GET, &statusCode);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_READ_DATA_FAILED, result);
+    ASSERT_ARE_EQUAL(size_t, 1, testAttemptCount);
+}
+
+TEST_FUNCTION(HTTPAPIStreaming_ExecuteWithResume_rejects_a_whole_body_sent_to_a_resume)
+{
+    // arrange
+    unsigned int statusCode = 0;
+    HTTPAPI_RESULT result;
+    setAttempt(0, 200, "01234", HTTPAPI_READ_DATA_FAILED);
+    testAttempts[0].headers[0] = "ETag";
+    testAttempts[0].headers[1] = "\"v1\"";
+    /*the resource changed, so If-Range makes the server send all of the new one*/
+    setAttempt(1, 200, "ABCDEFGHIJ", HTTPAPI_OK);
+    testAttempts[1].headers[0] = "ETag";
+    testAttempts[1].headers[1] = "\"v2\"";
+
+    // act
+    result = executeWithResume(HTTPAPI_REQUEST_GET, &statusCode);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_READ_DATA_FAILED, result);
+    ASSERT_ARE_EQUAL(size_t, 2, testAttemptCount);
+    ASSERT_ARE_EQUAL(size_t, 5, testBody.receivedSize);
+    ASSERT_ARE_EQUAL(int, 1, testBody.receivedCalls);
+    assertNoHeadersHandleLeaked();
+}
+
+TEST_FUNCTION(HTTPAPIStreaming_ExecuteWithResume_rejects_a_range_that_does_not_start_at_the_cut)
+{
+    // arrange
+    unsigned int statusCode = 0;
+    HTTPAPI_RESULT result;
+    setAttempt(0, 200, "01234", HTTPAPI_READ_DATA_FAILED);
+    testAttempts[0].headers[0] = "ETag";
+    testAttempts[0].headers[1] = "\"v1\"";
+    setAttempt(1, 206, "456789", HTTPAPI_OK);
+    testAttempts[1].headers[0] = "Content-Range";
+    testAttempts[1].headers[1] = "bytes 4-9/10";
+
+    // act
+    result = executeWithResume(HTTPAPI_REQUEST_GET, &statusCode);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_READ_DATA_FAILED, result);
+    ASSERT_ARE_EQUAL(size_t, 2, testAttemptCount);
+    ASSERT_ARE_EQUAL(size_t, 5, testBody.receivedSize);
+}
+
+TEST_FUNCTION(HTTPAPIStreaming_ExecuteWithResume_gives_up_after_3_resumes)
+{
+    // arrange
+    unsigned int statusCode = 0;
+    HTTPAPI_RESULT result;
+    size_t i;
+    setAttempt(0, 200, "0", HTTPAPI_READ_DATA_FAILED);
+    testAttempts[0].headers[0] = "ETag";
+    testAttempts[0].headers[1] = "\"v1\"";
+    for (i = 1; i < TEST_MAX_ATTEMPTS; i++)
+    {
+        setAttempt(i, 206, "1", HTTPAPI_READ_DATA_FAILED);
+        testAttempts[i].headers[0] = "Content-Range";
+    }
+    testAttempts[1].headers[1] = "bytes 1-9/10";
+    testAttempts[2].headers[1] = "bytes 2-9/10";
+    testAttempts[3].headers[1] = "bytes 3-9/10";
+    testAttempts[4].headers[1] = "bytes 4-9/10";
+
+    // act
+    result = executeWithResume(HTTPAPI_REQUEST_GET, &statusCode);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_READ_DATA_FAILED, result);
+    ASSERT_ARE_EQUAL(size_t, 1 + HTTPAPI_STREAMING_MAX_RESUMES, testAttemptCount);
+    ASSERT_ARE_EQUAL(char_ptr, "bytes=3-", testAttempts[3].range);
+    ASSERT_ARE_EQUAL(size_t, 4, testBody.receivedSize);
+    assertNoHeadersHandleLeaked();
+}
+
+/* HTTPAPIStreaming_ExecuteBuffered */
+
+TEST_FUNCTION(HTTPAPIStreaming_ExecuteBuffered_sends_the_whole_request_body_and_hands_the_response_body_once)
+{
+    // arrange
+    unsigned int statusCode = 0;
+    HTTPAPI_RESULT result;
+    testBody.requestBody = "0123456789";
+    testResponseContent = "response";
+
+    // act
+    result = HTTPAPIStreaming_ExecuteBuffered(TEST_HTTP_HANDLE, HTTPAPI_REQUEST_POST, TEST_RELATIVE_PATH, (HTTP_HEADERS_HANDLE)&testHeaders[0],
+        onTestRequestBodyRead, &testBody, &statusCode, (HTTP_HEADERS_HANDLE)&testHeaders[1], onTestResponseBodyReceived, &testBody);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, result);
+    ASSERT_ARE_EQUAL(int, 200, statusCode);
+    ASSERT_ARE_EQUAL(int, 1, testBody.receivedCalls);
+    ASSERT_ARE_EQUAL(size_t, strlen("response"), testBody.receivedSize);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(testBody.received, "response", testBody.receivedSize));
+}
+
+TEST_FUNCTION(HTTPAPIStreaming_ExecuteBuffered_fails_when_the_consumer_fails)
+{
+    // arrange
+    unsigned int statusCode = 0;
+    HTTPAPI_RESULT result;
+    testBody.requestBody = "0123456789";
+    testBody.receiveFailsAt = 1;
+    testResponseContent = "response";
+
+    // act
+    result = HTTPAPIStreaming_ExecuteBuffered(TEST_HTTP_HANDLE, HTTPAPI_REQUEST_POST, TEST_RELATIVE_PATH, (HTTP_HEADERS_HANDLE)&testHeaders[0],
+        onTestRequestBodyRead, &testBody, &statusCode, (HTTP_HEADERS_HANDLE)&testHeaders[1], onTestResponseBodyReceived, &testBody);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_READ_DATA_FAILED, result);
+}
+
+END_TEST_SUITE(httpapi_streaming_ut)
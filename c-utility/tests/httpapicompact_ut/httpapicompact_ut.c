@@ -75,6 +75,7 @@ void my_gballoc_free(void* ptr)
 #define TEST_SETOPTIONS_X509CLIENTCERT	(const unsigned char*)"ADMITONE"
 #define TEST_SETOPTIONS_X509PRIVATEKEY	(const unsigned char*)"SPEAKFRIENDANDENTER"
 #define TEST_GET_HEADER_HEAD_COUNT (size_t)2
+#define TEST_SERIALIZED_HEADER "0123456789\r\n"
 
 
 #define ENABLE_MOCKS
@@ -152,7 +153,7 @@ static const int xio_send_e[4] = { 123, 123, 123, 123 };
 static const int xio_send_0_e[4] = { 0, 123, 0, 0 };
 static const int xio_send_00_e[4] = { 0, 0, 123, 0 };
 static const int xio_send_7x0[7] = { 0, 0, 0, 0, 0, 0, 0 };
-static const int xio_send_6x0_e[7] = { 0, 0, 0, 0, 0, 0, 123 };
+static const int xio_send_12x0[12] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
 static const xio_dowork_job doworkjob_end[1] = { XIO_DOWORK_JOB_END };
 static const xio_dowork_job doworkjob_oe[2] = { XIO_DOWORK_JOB_OPEN, XIO_DOWORK_JOB_END };
 static const xio_dowork_job doworkjob_4none_oe[6] = { XIO_DOWORK_JOB_NONE, XIO_DOWORK_JOB_NONE, XIO_DOWORK_JOB_NONE, XIO_DOWORK_JOB_NONE, XIO_DOWORK_JOB_OPEN, XIO_DOWORK_JOB_END };
@@ -165,10 +166,13 @@ static const xio_dowork_job doworkjob_o_re[3] = { XIO_DOWORK_JOB_OPEN, XIO_DOWOR
 static const xio_dowork_job doworkjob_o_rce[8] = { XIO_DOWORK_JOB_OPEN, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_CLOSE, XIO_DOWORK_JOB_END };
 static const xio_dowork_job doworkjob_o_rc_error[9] = { XIO_DOWORK_JOB_OPEN, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_CLOSE, XIO_DOWORK_JOB_ERROR, XIO_DOWORK_JOB_END };
 static const xio_dowork_job doworkjob_o_rre[4] = { XIO_DOWORK_JOB_OPEN, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_END };
-static const xio_dowork_job doworkjob_o_sre[15] = { XIO_DOWORK_JOB_OPEN, 
-    XIO_DOWORK_JOB_SEND, XIO_DOWORK_JOB_SEND, XIO_DOWORK_JOB_SEND, XIO_DOWORK_JOB_SEND, XIO_DOWORK_JOB_SEND, XIO_DOWORK_JOB_SEND, XIO_DOWORK_JOB_SEND,
+static const xio_dowork_job doworkjob_o_sre[10] = { XIO_DOWORK_JOB_OPEN, 
+    XIO_DOWORK_JOB_SEND, XIO_DOWORK_JOB_SEND,
     XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_CLOSE, XIO_DOWORK_JOB_END };
 
+static const xio_dowork_job doworkjob_o_r2n2re[7] = { XIO_DOWORK_JOB_OPEN, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_NONE, XIO_DOWORK_JOB_NONE, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_END };
+static const xio_dowork_job doworkjob_o_r4nrnre[10] = { XIO_DOWORK_JOB_OPEN, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_NONE, XIO_DOWORK_JOB_NONE, XIO_DOWORK_JOB_NONE, XIO_DOWORK_JOB_NONE, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_NONE, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_END };
+
 static const IO_OPEN_RESULT openresult_ok[1] = { IO_OPEN_OK };
 static const IO_OPEN_RESULT openresult_error[1] = { IO_OPEN_ERROR };
 
@@ -183,15 +187,6 @@ static const IO_SEND_RESULT sendresult_7ok[7] = {
         IO_SEND_OK,
         IO_SEND_OK
 };
-static const IO_SEND_RESULT sendresult_6ok_error[7] = {
-    IO_SEND_OK,
-    IO_SEND_OK,
-    IO_SEND_OK,
-    IO_SEND_OK,
-    IO_SEND_OK,
-    IO_SEND_OK,
-    IO_SEND_ERROR
-};
 
 
 static const xio_dowork_job* DoworkJobs = (const xio_dowork_job*)doworkjob_end;
@@ -422,20 +417,31 @@ HTTP_HEADERS_RESULT my_HTTPHeaders_GetHeaderCount(HTTP_HEADERS_HANDLE handle, si
     return result;
 }
 
-static HTTP_HEADERS_RESULT HTTPHeaders_GetHeader_shallReturn;
-HTTP_HEADERS_RESULT my_HTTPHeaders_GetHeader(HTTP_HEADERS_HANDLE handle, size_t index, char** destination)
+static HTTP_HEADERS_RESULT HTTPHeaders_Serialize_shallReturn;
+HTTP_HEADERS_RESULT my_HTTPHeaders_Serialize(HTTP_HEADERS_HANDLE handle, char* destination, size_t destinationSize, size_t* serializedSize)
 {
     HTTP_HEADERS_RESULT result;
 
-    if ((handle == NULL) || (destination == NULL) || (index > TEST_GET_HEADER_HEAD_COUNT))
+    if ((handle == NULL) || (serializedSize == NULL))
     {
         result = HTTP_HEADERS_INVALID_ARG;
     }
     else
     {
-        *destination = (char*)malloc(11 * sizeof(char));
-        strcpy(*destination, "0123456789");
-        result = HTTPHeaders_GetHeaderCount_shallReturn;
+        size_t i;
+        *serializedSize = TEST_GET_HEADER_HEAD_COUNT * (sizeof(TEST_SERIALIZED_HEADER) - 1);
+        if (*serializedSize > destinationSize)
+        {
+            result = HTTP_HEADERS_INSUFFICIENT_BUFFER;
+        }
+        else
+        {
+            for (i = 0; i < TEST_GET_HEADER_HEAD_COUNT; i++)
+            {
+                (void)memcpy(destination + (i * (sizeof(TEST_SERIALIZED_HEADER) - 1)), TEST_SERIALIZED_HEADER, sizeof(TEST_SERIALIZED_HEADER) - 1);
+            }
+            result = HTTPHeaders_Serialize_shallReturn;
+        }
     }
 
     return result;
@@ -544,6 +550,32 @@ static void setHttpx509ClientCertificateAndKey(HTTP_HANDLE httpHandle)
     HTTPAPI_SetOption(httpHandle, SU_OPTION_X509_PRIVATE_KEY, TEST_SETOPTIONS_X509PRIVATEKEY);				/* currentmalloc_call += 1 */
 }
 
+#define TEST_OPEN_TIMEOUT_IN_MILLISECONDS     10000
+#define TEST_CLOSE_TIMEOUT_IN_MILLISECONDS    10000
+#define TEST_SEND_TIMEOUT_IN_MILLISECONDS     20000
+#define TEST_RECEIVE_TIMEOUT_IN_MILLISECONDS  20000
+
+/* the n-th sleep of a wait without progress: 1, 2, 4, 8, then 10 milliseconds */
+static unsigned int retryInterval(int retry)
+{
+    return (retry < 4) ? (1U << retry) : 10U;
+}
+
+/* number of sleeps a wait does before it gives up */
+static int retriesBeforeTimeout(unsigned int timeout)
+{
+    int retry = 0;
+    unsigned int waited = 0;
+
+    while (waited < timeout)
+    {
+        waited += retryInterval(retry);
+        retry++;
+    }
+
+    return retry;
+}
+
 static void setupAllCallBeforeOpenHTTPsequence(HTTP_HEADERS_HANDLE requestHttpHeaders, int numberOfDoWork, bool useClientCert)
 {
 	int i;
@@ -566,12 +598,12 @@ static void setupAllCallBeforeOpenHTTPsequence(HTTP_HEADERS_HANDLE requestHttpHe
         .IgnoreAllArguments();
     for (i = 0; i < numberOfDoWork; i++)
     {
-        STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
-        if (i > 0)
+        if (i > 1)
         {
-            STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
+            STRICT_EXPECTED_CALL(ThreadAPI_Sleep(retryInterval(i - 2)));
         }
+        STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
+            .IgnoreArgument(1);
     }
 }
 
@@ -605,26 +637,8 @@ static void setupAllCallBeforeReceiveHTTPsequenceWithSuccess()
 
 static void setupAllCallBeforeSendHTTPsequenceWithSuccess(HTTP_HEADERS_HANDLE requestHttpHeaders)
 {
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPHeaders_Serialize(requestHttpHeaders, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(2).IgnoreArgument(3).IgnoreArgument(4);
     STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments();
 
@@ -647,9 +661,10 @@ static void PrepareReceiveHead(HTTP_HEADERS_HANDLE requestHttpHeaders, size_t bu
     for (countBuffer = 0; countBuffer < countSizes; countBuffer++)
     {
 		int countChar;
-        if (countBuffer > 0)
+        /* only a buffer that brought no bytes makes the next read wait */
+        if ((countBuffer > 0) && (bufferSize[countBuffer - 1] == 0))
         {
-            STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
+            STRICT_EXPECTED_CALL(ThreadAPI_Sleep(retryInterval(0)));
         }
         STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
             .IgnoreArgument(1);
@@ -663,7 +678,7 @@ static void PrepareReceiveHead(HTTP_HEADERS_HANDLE requestHttpHeaders, size_t bu
             .IgnoreArgument(1);
     }
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
 }
 
 
@@ -729,7 +744,7 @@ TEST_SUITE_INITIALIZE(setsBufferTempSize)
     REGISTER_GLOBAL_MOCK_HOOK(BUFFER_new, my_BUFFER_new);
     REGISTER_GLOBAL_MOCK_HOOK(BUFFER_delete, my_BUFFER_delete);
     REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_GetHeaderCount, my_HTTPHeaders_GetHeaderCount);
-    REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_GetHeader, my_HTTPHeaders_GetHeader);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_Serialize, my_HTTPHeaders_Serialize);
 
     REGISTER_GLOBAL_MOCK_HOOK(platform_get_default_tlsio, my_platform_get_default_tlsio);
 }
@@ -766,6 +781,7 @@ TEST_FUNCTION_INITIALIZE(f)
     xio_close_shallReturn = 0;
     DoworkJobsCloseSuccess = true;
     call_on_io_close_complete_in_xio_close = true;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
 }
 
 TEST_FUNCTION_CLEANUP(cleans)
@@ -1070,7 +1086,7 @@ TEST_FUNCTION(HTTPAPI_CloseConnection__return_LINE_failed)
 }
 
 /*Tests_SRS_HTTPAPI_COMPACT_21_084: [ The HTTPAPI_CloseConnection shall wait, at least, 10 seconds for the SSL close process. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_086: [ The HTTPAPI_CloseConnection shall wait, at least, 100 milliseconds between retries. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_21_086: [ The HTTPAPI_CloseConnection shall wait between retries starting with 1 millisecond and doubling up to 10 milliseconds. ]*/
 TEST_FUNCTION(HTTPAPI_CloseConnection__close_on_dowork_succeed)
 {
     /// arrange
@@ -1093,7 +1109,7 @@ TEST_FUNCTION(HTTPAPI_CloseConnection__close_on_dowork_succeed)
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
     setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
 
     xio_close_shallReturn = 0;
     DoworkJobsCloseSuccess = true;
@@ -1161,7 +1177,7 @@ TEST_FUNCTION(HTTPAPI_CloseConnection__close_on_dowork_retry_n_succeed)
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
     setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
 
     xio_close_shallReturn = 0;
     DoworkJobsCloseSuccess = true;
@@ -1174,7 +1190,7 @@ TEST_FUNCTION(HTTPAPI_CloseConnection__close_on_dowork_retry_n_succeed)
     {
         STRICT_EXPECTED_CALL(xio_dowork(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
+        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(retryInterval(i)));
     }
     STRICT_EXPECTED_CALL(xio_dowork(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
@@ -1235,7 +1251,7 @@ TEST_FUNCTION(HTTPAPI_CloseConnection__close_on_dowork_retry_n_failed)
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
     setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
 
     xio_close_shallReturn = 0;
     DoworkJobsCloseSuccess = false;
@@ -1248,7 +1264,7 @@ TEST_FUNCTION(HTTPAPI_CloseConnection__close_on_dowork_retry_n_failed)
     {
         STRICT_EXPECTED_CALL(xio_dowork(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
+        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(retryInterval(i)));
     }
     STRICT_EXPECTED_CALL(xio_dowork(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
@@ -1309,20 +1325,20 @@ TEST_FUNCTION(HTTPAPI_CloseConnection__close_timeout_failed)
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
     setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
 
     xio_close_shallReturn = 0;
     DoworkJobsCloseSuccess = true;
-    SkipDoworkJobsCloseResult = 101;
+    SkipDoworkJobsCloseResult = retriesBeforeTimeout(TEST_CLOSE_TIMEOUT_IN_MILLISECONDS) + 1;
     call_on_io_close_complete_in_xio_close = false;
 
     STRICT_EXPECTED_CALL(xio_close(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments();
-    for (i = 0; i < SkipDoworkJobsCloseResult; i++)
+    for (i = 0; i < SkipDoworkJobsCloseResult - 1; i++)
     {
         STRICT_EXPECTED_CALL(xio_dowork(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
+        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(retryInterval(i)));
     }
     STRICT_EXPECTED_CALL(xio_dowork(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
@@ -2131,10 +2147,8 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_io_open_complete_with_timeout_failed)
     DoworkJobs = (const xio_dowork_job*)doworkjob_4none_oe;
     DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_ok;
 
-    SkipDoworkJobsOpenResult = 98;
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, SkipDoworkJobsOpenResult + 4, false);
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
+    SkipDoworkJobsOpenResult = retriesBeforeTimeout(TEST_OPEN_TIMEOUT_IN_MILLISECONDS);
+    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, SkipDoworkJobsOpenResult + 2, false);
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -2308,6 +2322,8 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__io_send_header_return_error_failed)
     setHttpx509ClientCertificateAndKey(httpHandle);
     setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, true);
     xio_send_shallReturn = (const int*)xio_send_e;
+    STRICT_EXPECTED_CALL(HTTPHeaders_Serialize(requestHttpHeaders, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(2).IgnoreArgument(3).IgnoreArgument(4);
     STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments();
 
@@ -2334,8 +2350,8 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__io_send_header_return_error_failed)
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_028: [ If the HTTPAPI_ExecuteRequest cannot send the request header, it shall return HTTPAPI_SEND_REQUEST_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_with_success_before_error_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_027: [ If the HTTPAPI_ExecuteRequest cannot create a buffer to send the request, it shall not send any request and return HTTPAPI_STRING_PROCESSING_ERROR. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__serialize_headers_failed)
 {
     /// arrange
     unsigned int statusCode;
@@ -2348,21 +2364,12 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_with_success_befor
 
     DoworkJobs = (const xio_dowork_job*)doworkjob_oe;
     DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_ok;
-    DoworkJobsSendResult = (const IO_SEND_RESULT*)sendresult_o_3error;
-    xio_send_shallReturn = (const int*)xio_send_0_e;
 
     setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPHeaders_Serialize(requestHttpHeaders, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(2).IgnoreArgument(3).IgnoreArgument(4);
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_ERROR;
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -2377,7 +2384,7 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_with_success_befor
         TestBufferHandle);
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_SEND_REQUEST_FAILED, result);
+    ASSERT_ARE_EQUAL(int, HTTPAPI_STRING_PROCESSING_ERROR, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
     ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
 
@@ -2387,43 +2394,54 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_with_success_befor
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_028: [ If the HTTPAPI_ExecuteRequest cannot send the request header, it shall return HTTPAPI_SEND_REQUEST_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_with_2_success_before_error_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_99_009: [ The HTTPAPI_ExecuteRequest shall put the request line, all the headers and the empty line that ends them in a single buffer, using HTTPHeaders_Serialize, and send it at once. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_99_010: [ If the head does not fit in the stack buffer, the HTTPAPI_ExecuteRequest shall allocate one of the exact size. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__head_bigger_than_stack_buffer_succeed)
 {
     /// arrange
     unsigned int statusCode;
     HTTPAPI_RESULT result;
     HTTP_HEADERS_HANDLE requestHttpHeaders;
     HTTP_HEADERS_HANDLE responseHttpHeaders;
+    char relativePath[991];
+    /*"GET " + relativePath + " HTTP/1.1\r\n" + headers + "\r\n"*/
+    size_t headSize = 4 + (sizeof(relativePath) - 1) + 11 + (TEST_GET_HEADER_HEAD_COUNT * (sizeof(TEST_SERIALIZED_HEADER) - 1)) + 2;
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
     setHttpCertificate(httpHandle);
 
-    DoworkJobs = (const xio_dowork_job*)doworkjob_oe;
-    DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_ok;
-    DoworkJobsSendResult = (const IO_SEND_RESULT*)sendresult_o_3error;
-    xio_send_shallReturn = (const int*)xio_send_00_e;
+    (void)memset(relativePath, 'a', sizeof(relativePath) - 1);
+    relativePath[0] = '/';
+    relativePath[sizeof(relativePath) - 1] = '\0';
+
+    DoworkJobsReceivedBuffer = TEST_RECEIVED_ANSWER;
+    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
+    DoworkJobsReceivedBuffer_counter = 0;
+    DoworkJobs = (const xio_dowork_job*)doworkjob_o_rce;
+    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
+    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
 
     setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
+    STRICT_EXPECTED_CALL(HTTPHeaders_Serialize(requestHttpHeaders, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(2).IgnoreArgument(3).IgnoreArgument(4);
+    STRICT_EXPECTED_CALL(gballoc_malloc(headSize));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Serialize(requestHttpHeaders, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(2).IgnoreArgument(3).IgnoreArgument(4);
+    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, headSize, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(1).IgnoreArgument(2).IgnoreArgument(4).IgnoreArgument(5);
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreAllArguments();
+    setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
 
     /// act
     result = HTTPAPI_ExecuteRequest(
         httpHandle,
         HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
+        relativePath,
         requestHttpHeaders,
         TEST_EXECUTE_REQUEST_CONTENT,
         TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
@@ -2432,7 +2450,8 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_with_2_success_bef
         TestBufferHandle);
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_SEND_REQUEST_FAILED, result);
+    ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
+    ASSERT_ARE_EQUAL(int, 433, statusCode);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
     ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
 
@@ -2463,19 +2482,21 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_timeout_failed)
     call_on_send_complete_in_xio_send = false;
 
     setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
+    STRICT_EXPECTED_CALL(HTTPHeaders_Serialize(requestHttpHeaders, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(2).IgnoreArgument(3).IgnoreArgument(4);
     STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments();
-    SkipDoworkJobsSendResult = 200;
-    for (i = 0; i < SkipDoworkJobsSendResult; i++)
+    SkipDoworkJobsSendResult = retriesBeforeTimeout(TEST_SEND_TIMEOUT_IN_MILLISECONDS) + 1;
+    for (i = 0; i < SkipDoworkJobsSendResult - 1; i++)
     {
         STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
+        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(retryInterval(i)));
     }
     STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
         .IgnoreArgument(1);
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -2521,6 +2542,8 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_retry_n_and_failed
     call_on_send_complete_in_xio_send = false;
 
     setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
+    STRICT_EXPECTED_CALL(HTTPHeaders_Serialize(requestHttpHeaders, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(2).IgnoreArgument(3).IgnoreArgument(4);
     STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments();
     SkipDoworkJobsSendResult = 10;
@@ -2528,12 +2551,12 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_retry_n_and_failed
     {
         STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
+        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(retryInterval(i)));
     }
     STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
         .IgnoreArgument(1);
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -2572,38 +2595,20 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_buffer_complete_with_error_failed)
 
     DoworkJobs = (const xio_dowork_job*)doworkjob_oe;
     DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_ok;
-    DoworkJobsSendResult = (const IO_SEND_RESULT*)sendresult_6ok_error;
-    xio_send_shallReturn = (const int*)xio_send_6x0_e;
+    DoworkJobsSendResult = (const IO_SEND_RESULT*)sendresult_o_3error;
+    xio_send_shallReturn = (const int*)xio_send_0_e;
 
     setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
 
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPHeaders_Serialize(requestHttpHeaders, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(2).IgnoreArgument(3).IgnoreArgument(4);
     STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments();
 
     STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments();
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -2651,7 +2656,7 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_read_header_failed_failed)
     STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
         .IgnoreArgument(1);
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -2701,7 +2706,7 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_read_NULL_header_failed)
     STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
         .IgnoreArgument(1);
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -2754,7 +2759,7 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_read_not_HTTP_header_failed)
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -3078,7 +3083,7 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_succeed)
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
     setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -3129,7 +3134,7 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_retry_open_succeed)
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
     setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -3178,60 +3183,28 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_retry_send_succeed)
 
     setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
 
+    STRICT_EXPECTED_CALL(HTTPHeaders_Serialize(requestHttpHeaders, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(2).IgnoreArgument(3).IgnoreArgument(4);
     STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments();
     SkipDoworkJobsSendResult = 199;
-    for (i = 0; i < SkipDoworkJobsSendResult+1; i++)
+    for (i = 0; i < SkipDoworkJobsSendResult; i++)
     {
         STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
+        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(retryInterval(i)));
     }
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
     STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
         .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
 
     STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments();
     STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
         .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
 
     setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -3281,7 +3254,7 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_get_succeed)
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
     setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
     xio_send_transmited_buffer_target = 1;
 
     /// act
@@ -3333,7 +3306,7 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_post_succeed)
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
     setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
     xio_send_transmited_buffer_target = 1;
 
     /// act
@@ -3385,7 +3358,7 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_put_succeed)
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
     setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
     xio_send_transmited_buffer_target = 1;
 
     /// act
@@ -3437,7 +3410,7 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_delete_succeed)
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
     setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
     xio_send_transmited_buffer_target = 1;
 
     /// act
@@ -3489,7 +3462,7 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_patch_succeed)
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
     setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
     xio_send_transmited_buffer_target = 1;
 
     /// act
@@ -3541,7 +3514,7 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_relative_path_succeed)
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
     setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
     xio_send_transmited_buffer_target = 1;
 
     /// act
@@ -3595,8 +3568,8 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_with_content_succeed)
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
     setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
-    xio_send_transmited_buffer_target = 7;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
+    xio_send_transmited_buffer_target = 2;
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -3643,32 +3616,14 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_NULL_content_succeed)
     DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
 
     setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPHeaders_Serialize(requestHttpHeaders, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(2).IgnoreArgument(3).IgnoreArgument(4);
     STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments();
     setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
-    xio_send_transmited_buffer_target = 7;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
+    xio_send_transmited_buffer_target = 2;
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -3716,32 +3671,14 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_content_size_0_succeed)
 
     setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
 
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPHeaders_Serialize(requestHttpHeaders, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(2).IgnoreArgument(3).IgnoreArgument(4);
     STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments();
     setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
-    xio_send_transmited_buffer_target = 7;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
+    xio_send_transmited_buffer_target = 2;
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -3790,7 +3727,7 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_no_statusCode_succeed)
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
     setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -3836,26 +3773,8 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_no_responseHeadersHandle_s
 
     setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
 
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPHeaders_Serialize(requestHttpHeaders, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(2).IgnoreArgument(3).IgnoreArgument(4);
     STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments();
     STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
@@ -3876,7 +3795,7 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_no_responseHeadersHandle_s
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -3925,7 +3844,7 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_responseContent_NULL_succe
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
     setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -3953,7 +3872,7 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_responseContent_NULL_succe
 
 /*Tests_SRS_HTTPAPI_COMPACT_21_081: [ The HTTPAPI_ExecuteRequest shall try to read the message with the response up to 20 seconds. ]*/
 /*Tests_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall wait, at least, 100 milliseconds between retries. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall retry without waiting while the transport delivers bytes, otherwise it shall wait between retries starting with 1 millisecond and doubling up to 10 milliseconds. ]*/
 TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_with_truncated_content_failed)
 {
     /// arrange
@@ -3993,9 +3912,9 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_with_truncated_content_fai
     STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
         .IgnoreArgument(1);
 
-    for (i = 0; i < 200; i++)
+    for (i = 0; i < retriesBeforeTimeout(TEST_RECEIVE_TIMEOUT_IN_MILLISECONDS); i++)
     {
-        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
+        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(retryInterval(i)));
         STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
             .IgnoreArgument(1);
     }
@@ -4003,7 +3922,7 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_with_truncated_content_fai
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -4030,7 +3949,7 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_with_truncated_content_fai
 
 /*Tests_SRS_HTTPAPI_COMPACT_21_081: [ The HTTPAPI_ExecuteRequest shall try to read the message with the response up to 20 seconds. ]*/
 /*Tests_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall wait, at least, 100 milliseconds between retries. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall retry without waiting while the transport delivers bytes, otherwise it shall wait between retries starting with 1 millisecond and doubling up to 10 milliseconds. ]*/
 TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_with_truncated_parameter_failed)
 {
     /// arrange
@@ -4066,15 +3985,15 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_with_truncated_parameter_f
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
 
-    for (i = 0; i < 200; i++)
+    for (i = 0; i < retriesBeforeTimeout(TEST_RECEIVE_TIMEOUT_IN_MILLISECONDS); i++)
     {
-        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
+        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(retryInterval(i)));
         STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
             .IgnoreArgument(1);
     }
 
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -4101,7 +4020,7 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_with_truncated_parameter_f
 
 /*Tests_SRS_HTTPAPI_COMPACT_21_081: [ The HTTPAPI_ExecuteRequest shall try to read the message with the response up to 20 seconds. ]*/
 /*Tests_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall wait, at least, 100 milliseconds between retries. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall retry without waiting while the transport delivers bytes, otherwise it shall wait between retries starting with 1 millisecond and doubling up to 10 milliseconds. ]*/
 TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_with_truncated_header_failed)
 {
     /// arrange
@@ -4131,15 +4050,18 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_with_truncated_header_fail
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
 
-    for (i = 0; i < 200; i++)
+    /* bytes arrived, so the next dowork runs without waiting */
+    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
+        .IgnoreArgument(1);
+    for (i = 0; i < retriesBeforeTimeout(TEST_RECEIVE_TIMEOUT_IN_MILLISECONDS); i++)
     {
-        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
+        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(retryInterval(i)));
         STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
             .IgnoreArgument(1);
     }
 
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -4164,4 +4086,332 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_with_truncated_header_fail
     HTTPAPI_Deinit();
 }
 
+#define TEST_RECEIVED_ANSWER_WITH_PART_OF_THE_CONTENT (const unsigned char*)"HTTP/111.222 433 555\r\ncontent-length:10\r\n\r\n0123"
+
+/*Tests_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall retry without waiting while the transport delivers bytes, otherwise it shall wait between retries starting with 1 millisecond and doubling up to 10 milliseconds. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_content_in_pieces_does_not_wait_succeed)
+{
+    /// arrange
+    unsigned int statusCode;
+    HTTPAPI_RESULT result;
+    HTTP_HEADERS_HANDLE requestHttpHeaders;
+    HTTP_HEADERS_HANDLE responseHttpHeaders;
+    HTTP_HANDLE httpHandle = createHttpConnection();
+    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    setHttpCertificate(httpHandle);
+
+    DoworkJobsReceivedBuffer = TEST_RECEIVED_ANSWER_WITH_PART_OF_THE_CONTENT;
+    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
+    DoworkJobsReceivedBuffer_size[1] = 3;
+    DoworkJobsReceivedBuffer_size[2] = 3;
+    DoworkJobsReceivedBuffer_counter = 0;
+    DoworkJobs = (const xio_dowork_job*)doworkjob_o_r2n2re;
+    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
+    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
+
+    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
+    setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
+
+    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_NUM_ARG, DoworkJobsReceivedBuffer_size[0])).IgnoreArgument(1);
+
+    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, "content-length", "10")).IgnoreArgument(1);
+
+    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
+        .IgnoreArgument(1);
+
+    /* the 4 bytes of content left in the buffer are moved to the front only when more bytes arrive */
+    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_NUM_ARG, 7)).IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_NUM_ARG, 3)).IgnoreArgument(1);
+
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
+
+    /// act
+    result = HTTPAPI_ExecuteRequest(
+        httpHandle,
+        HTTPAPI_REQUEST_GET,
+        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
+        requestHttpHeaders,
+        TEST_EXECUTE_REQUEST_CONTENT,
+        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
+        &statusCode,
+        responseHttpHeaders,
+        TestBufferHandle);
+
+    /// assert
+    ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
+    ASSERT_ARE_EQUAL(int, 433, statusCode);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+
+    /// cleanup
+    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_Deinit();
+}
+
+/*Tests_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall retry without waiting while the transport delivers bytes, otherwise it shall wait between retries starting with 1 millisecond and doubling up to 10 milliseconds. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_wait_restarts_when_bytes_arrive_succeed)
+{
+    /// arrange
+    unsigned int statusCode;
+    HTTPAPI_RESULT result;
+    HTTP_HEADERS_HANDLE requestHttpHeaders;
+    HTTP_HEADERS_HANDLE responseHttpHeaders;
+    HTTP_HANDLE httpHandle = createHttpConnection();
+    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    setHttpCertificate(httpHandle);
+
+    DoworkJobsReceivedBuffer = TEST_RECEIVED_ANSWER_WITH_PART_OF_THE_CONTENT;
+    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
+    DoworkJobsReceivedBuffer_size[1] = 3;
+    DoworkJobsReceivedBuffer_size[2] = 3;
+    DoworkJobsReceivedBuffer_counter = 0;
+    DoworkJobs = (const xio_dowork_job*)doworkjob_o_r4nrnre;
+    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
+    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
+
+    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
+    setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
+
+    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_NUM_ARG, DoworkJobsReceivedBuffer_size[0])).IgnoreArgument(1);
+
+    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, "content-length", "10")).IgnoreArgument(1);
+
+    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
+        .IgnoreArgument(1);
+
+    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(retryInterval(0)));
+    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(retryInterval(1)));
+    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_NUM_ARG, 3)).IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
+        .IgnoreArgument(1);
+    /* bytes arrived since the last sleep, so the wait starts over from the shortest interval */
+    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(retryInterval(0)));
+    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_NUM_ARG, 3)).IgnoreArgument(1);
+
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
+
+    /// act
+    result = HTTPAPI_ExecuteRequest(
+        httpHandle,
+        HTTPAPI_REQUEST_GET,
+        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
+        requestHttpHeaders,
+        TEST_EXECUTE_REQUEST_CONTENT,
+        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
+        &statusCode,
+        responseHttpHeaders,
+        TestBufferHandle);
+
+    /// assert
+    ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
+    ASSERT_ARE_EQUAL(int, 433, statusCode);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+
+    /// cleanup
+    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_Deinit();
+}
+
+#define TEST_REQUEST_BODY_PIECE "abcdefghij"
+#define TEST_RECEIVED_CHUNKED_ANSWER (const unsigned char*)"HTTP/1.1 200 OK\r\ntransfer-encoding:chunked\r\n\r\n4\r\n0123\r\n6\r\n456789\r\n0\r\n\r\n"
+
+typedef struct STREAMING_TEST_CONTEXT_TAG
+{
+    int readCalls;
+    int readFailsAt;
+    unsigned char received[64];
+    size_t receivedSize;
+    int receivedCalls;
+    int receiveFailsAt;
+} STREAMING_TEST_CONTEXT;
+
+static int onStreamingTestRequestBodyRead(void* context, unsigned char* buffer, size_t bufferSize, size_t* bytesWritten)
+{
+    STREAMING_TEST_CONTEXT* streamingContext = (STREAMING_TEST_CONTEXT*)context;
+    int result;
+
+    streamingContext->readCalls++;
+    if (streamingContext->readCalls == streamingContext->readFailsAt)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* one piece of body, then the end of it */
+        *bytesWritten = (streamingContext->readCalls == 1) ? strlen(TEST_REQUEST_BODY_PIECE) : 0;
+        ASSERT_IS_TRUE(bufferSize >= *bytesWritten);
+        (void)memcpy(buffer, TEST_REQUEST_BODY_PIECE, *bytesWritten);
+        result = 0;
+    }
+    return result;
+}
+
+static int onStreamingTestResponseBodyReceived(void* context, const unsigned char* buffer, size_t size)
+{
+    STREAMING_TEST_CONTEXT* streamingContext = (STREAMING_TEST_CONTEXT*)context;
+    int result;
+
+    streamingContext->receivedCalls++;
+    if (streamingContext->receivedCalls == streamingContext->receiveFailsAt)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        ASSERT_IS_TRUE(streamingContext->receivedSize + size <= sizeof(streamingContext->received));
+        (void)memcpy(streamingContext->received + streamingContext->receivedSize, buffer, size);
+        streamingContext->receivedSize += size;
+        result = 0;
+    }
+    return result;
+}
+
+static HTTPAPI_RESULT executeStreamingRequest(STREAMING_TEST_CONTEXT* streamingContext, unsigned int* statusCode)
+{
+    HTTPAPI_RESULT result;
+    HTTP_HEADERS_HANDLE requestHttpHeaders;
+    HTTP_HEADERS_HANDLE responseHttpHeaders;
+    HTTP_HANDLE httpHandle = createHttpConnection();
+    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    setHttpCertificate(httpHandle);
+    xio_send_shallReturn = (const int*)xio_send_12x0;
+
+    DoworkJobsReceivedBuffer = TEST_RECEIVED_CHUNKED_ANSWER;
+    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
+    DoworkJobsReceivedBuffer_counter = 0;
+    DoworkJobs = (const xio_dowork_job*)doworkjob_o_re;
+    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
+    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
+    HTTPHeaders_Serialize_shallReturn = HTTP_HEADERS_OK;
+
+    result = HTTPAPI_ExecuteRequestStreaming(
+        httpHandle,
+        HTTPAPI_REQUEST_POST,
+        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
+        requestHttpHeaders,
+        onStreamingTestRequestBodyRead,
+        streamingContext,
+        statusCode,
+        responseHttpHeaders,
+        onStreamingTestResponseBodyReceived,
+        streamingContext);
+
+    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    HTTPAPI_CloseConnection(httpHandle);
+    HTTPAPI_Deinit();
+
+    return result;
+}
+
+/*Tests_SRS_HTTPAPI_COMPACT_99_008: [ If handle, relativePath or httpHeadersHandle is NULL, or the requestType is unknown, the HTTPAPI_ExecuteRequestStreaming shall return HTTPAPI_INVALID_ARG. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequestStreaming__NULL_handle_failed)
+{
+    /// arrange
+    unsigned int statusCode;
+    HTTPAPI_RESULT result;
+
+    /// act
+    result = HTTPAPI_ExecuteRequestStreaming(NULL, HTTPAPI_REQUEST_GET, TEST_EXECUTE_REQUEST_RELATIVE_PATH, (HTTP_HEADERS_HANDLE)0x42, NULL, NULL, &statusCode, NULL, NULL, NULL);
+
+    /// assert
+    ASSERT_ARE_EQUAL(int, HTTPAPI_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_HTTPAPI_COMPACT_99_001: [ If there is a onRequestBodyRead, the HTTPAPI_ExecuteRequestStreaming shall add the header `Transfer-Encoding: chunked` to the request. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_99_002: [ The HTTPAPI_ExecuteRequestStreaming shall send each piece of the body returned by onRequestBodyRead as one chunk, and the empty chunk when onRequestBodyRead returns 0 bytes. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_99_004: [ The HTTPAPI_ExecuteRequestStreaming shall call onResponseBodyReceived with the body of the response as it is received, in pieces of at most 1024 bytes, without holding the whole body in memory. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_99_007: [ The HTTPAPI_ExecuteRequestStreaming shall execute the http communication like HTTPAPI_ExecuteRequest, reading the request body from onRequestBodyRead and handing the response body to onResponseBodyReceived. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequestStreaming__chunked_request_and_response_succeed)
+{
+    /// arrange
+    unsigned int statusCode;
+    HTTPAPI_RESULT result;
+    STREAMING_TEST_CONTEXT streamingContext;
+    (void)memset(&streamingContext, 0, sizeof(streamingContext));
+    /* request line, 2 headers with their line ends, the Transfer-Encoding header, the empty line, and then the first chunk */
+    xio_send_transmited_buffer_target = 2;
+
+    /// act
+    result = executeStreamingRequest(&streamingContext, &statusCode);
+
+    /// assert
+    ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
+    ASSERT_ARE_EQUAL(int, 200, statusCode);
+    ASSERT_ARE_EQUAL(int, 2, streamingContext.readCalls);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(xio_send_transmited_buffer, "a\r\n" TEST_REQUEST_BODY_PIECE "\r\n", 15));
+    ASSERT_ARE_EQUAL(int, 2, streamingContext.receivedCalls);
+    ASSERT_ARE_EQUAL(size_t, 10, streamingContext.receivedSize);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(streamingContext.received, "0123456789", 10));
+    ASSERT_ARE_EQUAL(int, 0, currentmalloc_call);
+}
+
+/*Tests_SRS_HTTPAPI_COMPACT_99_003: [ If onRequestBodyRead fails, the HTTPAPI_ExecuteRequestStreaming shall return HTTPAPI_SEND_REQUEST_FAILED. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequestStreaming__request_body_read_failed)
+{
+    /// arrange
+    unsigned int statusCode;
+    HTTPAPI_RESULT result;
+    STREAMING_TEST_CONTEXT streamingContext;
+    (void)memset(&streamingContext, 0, sizeof(streamingContext));
+    streamingContext.readFailsAt = 2;
+
+    /// act
+    result = executeStreamingRequest(&streamingContext, &statusCode);
+
+    /// assert
+    ASSERT_ARE_EQUAL(int, HTTPAPI_SEND_REQUEST_FAILED, result);
+    ASSERT_ARE_EQUAL(int, 0, streamingContext.receivedCalls);
+    ASSERT_ARE_EQUAL(int, 0, currentmalloc_call);
+}
+
+/*Tests_SRS_HTTPAPI_COMPACT_99_005: [ If onResponseBodyReceived fails, the HTTPAPI_ExecuteRequestStreaming shall return HTTPAPI_READ_DATA_FAILED. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequestStreaming__response_body_received_failed)
+{
+    /// arrange
+    unsigned int statusCode;
+    HTTPAPI_RESULT result;
+    STREAMING_TEST_CONTEXT streamingContext;
+    (void)memset(&streamingContext, 0, sizeof(streamingContext));
+    streamingContext.receiveFailsAt = 1;
+
+    /// act
+    result = executeStreamingRequest(&streamingContext, &statusCode);
+
+    /// assert
+    ASSERT_ARE_EQUAL(int, HTTPAPI_READ_DATA_FAILED, result);
+    ASSERT_ARE_EQUAL(int, 1, streamingContext.receivedCalls);
+    ASSERT_ARE_EQUAL(size_t, 0, streamingContext.receivedSize);
+    ASSERT_ARE_EQUAL(int, 0, currentmalloc_call);
+}
+
 END_TEST_SUITE(httpapicompact_ut)
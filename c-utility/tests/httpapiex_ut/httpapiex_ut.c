@@ -77,6 +77,8 @@ void my_gballoc_free(void* ptr)
 #include "azure_c_shared_utility/buffer_.h"
 #include "azure_c_shared_utility/httpheaders.h"
 #include "azure_c_shared_utility/httpapi.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/tickcounter.h"
 
 static size_t currentHTTPAPI_SaveOption_call;
 static size_t whenShallHTTPAPI_SaveOption_fail;
@@ -225,6 +227,13 @@ HTTPAPI_RESULT my_HTTPAPI_CloneOption(const char* optionName, const void* value,
             strcpy(temp, (const char*)value);
             *savedValue = temp;
         }
+        else if (strcmp("TrustedCerts", optionName) == 0)
+        {
+            char* temp;
+            temp = (char *)malloc(strlen((const char*)value) + 1);
+            strcpy(temp, (const char*)value);
+            *savedValue = temp;
+        }
         else
         {
             result2 = HTTPAPI_INVALID_ARG;
@@ -292,6 +301,76 @@ IMPLEMENT_UMOCK_C_ENUM_TYPE(HTTPAPI_REQUEST_TYPE, HTTPAPI_REQUEST_TYPE_VALUES);
 unsigned char* TEST_BUFFER = (unsigned char*)"333333";
 #define TEST_BUFFER_SIZE 6
 
+#define TEST_LOCK_HANDLE (LOCK_HANDLE)0x4A
+#define TEST_TICK_COUNTER_HANDLE (TICK_COUNTER_HANDLE)0x4B
+
+/*times returned by consecutive calls to tickcounter_get_current_ms, the last one is repeated*/
+static tickcounter_ms_t tickcounterTimes[8];
+static size_t tickcounterTimesCount;
+static size_t currentTickcounter_call;
+
+static int my_tickcounter_get_current_ms(TICK_COUNTER_HANDLE tick_counter, tickcounter_ms_t* current_ms)
+{
+    (void)tick_counter;
+    if (currentTickcounter_call < tickcounterTimesCount)
+    {
+        *current_ms = tickcounterTimes[currentTickcounter_call];
+        currentTickcounter_call++;
+    }
+    else
+    {
+        *current_ms = (tickcounterTimesCount == 0) ? 0 : tickcounterTimes[tickcounterTimesCount - 1];
+    }
+    return 0;
+}
+
+/*executed by the first HTTPAPI_ExecuteRequest, as if another thread ran a request meanwhile*/
+static HTTPAPIEX_HANDLE nestedRequestHandle;
+static HTTPAPIEX_HANDLE runningNestedRequestHandle;
+static size_t failingHTTPAPI_ExecuteRequest_calls;
+static bool disableConnectionPoolDuringRequest;
+static size_t HTTPAPI_Init_calls_after_disable;
+static const char* responseConnectionHeaderValue;
+
+static HTTPAPI_RESULT my_HTTPAPI_ExecuteRequest(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath, HTTP_HEADERS_HANDLE httpHeadersHandle, const unsigned char* content, size_t contentLength, unsigned int* statusCode, HTTP_HEADERS_HANDLE responseHeadersHandle, BUFFER_HANDLE responseContent)
+{
+    (void)handle;
+    (void)content;
+    (void)contentLength;
+    if ((nestedRequestHandle != NULL) && (runningNestedRequestHandle == NULL))
+    {
+        runningNestedRequestHandle = nestedRequestHandle;
+        (void)HTTPAPIEX_ExecuteRequest(runningNestedRequestHandle, requestType, relativePath, httpHeadersHandle, NULL, statusCode, responseHeadersHandle, responseContent);
+    }
+
+    if (disableConnectionPoolDuringRequest)
+    {
+        disableConnectionPoolDuringRequest = false;
+        HTTPAPIEX_DisableConnectionPool();
+        HTTPAPI_Init_calls_after_disable = HTTPAPI_Init_calls;
+    }
+
+    if (failingHTTPAPI_ExecuteRequest_calls > 0)
+    {
+        failingHTTPAPI_ExecuteRequest_calls--;
+        return HTTPAPI_ERROR;
+    }
+    else
+    {
+        return HTTPAPI_OK;
+    }
+}
+
+/*the value of the Connection header of the next response only*/
+static const char* my_HTTPHeaders_FindHeaderValue(HTTP_HEADERS_HANDLE httpHeadersHandle, const char* name)
+{
+    const char* result2 = responseConnectionHeaderValue;
+    (void)httpHeadersHandle;
+    (void)name;
+    responseConnectionHeaderValue = NULL;
+    return result2;
+}
+
 static TEST_MUTEX_HANDLE g_testByTest;
 static TEST_MUTEX_HANDLE g_dllByDll;
 
@@ -444,6 +523,9 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_UMOCK_ALIAS_TYPE(HTTP_HEADERS_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(HTTP_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(const unsigned char*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_RESULT, int);
+    REGISTER_UMOCK_ALIAS_TYPE(TICK_COUNTER_HANDLE, void*);
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
@@ -478,6 +560,15 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_GLOBAL_MOCK_HOOK(VECTOR_size, real_VECTOR_size);
     REGISTER_GLOBAL_MOCK_HOOK(mallocAndStrcpy_s, real_mallocAndStrcpy_s);
     REGISTER_GLOBAL_MOCK_HOOK(size_tToString, real_size_tToString);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock_Init, TEST_LOCK_HANDLE);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(Unlock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(tickcounter_create, TEST_TICK_COUNTER_HANDLE);
+    REGISTER_GLOBAL_MOCK_HOOK(tickcounter_get_current_ms, my_tickcounter_get_current_ms);
+
+    /*the lock of the connection pool lives as long as the process, so it is created here once for all the tests*/
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, HTTPAPIEX_EnableConnectionPool(1, 0));
+    HTTPAPIEX_DisableConnectionPool();
 }
 
 TEST_SUITE_CLEANUP(TestClassCleanup)
@@ -520,6 +611,15 @@ TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
     currentHTTPAPI_Init_call = 0;
     for (i = 0; i<N_MAX_FAILS; i++) whenShallHTTPAPI_Init_fail[i] = 0;
 
+    tickcounterTimesCount = 0;
+    currentTickcounter_call = 0;
+    nestedRequestHandle = NULL;
+    runningNestedRequestHandle = NULL;
+    failingHTTPAPI_ExecuteRequest_calls = 0;
+    disableConnectionPoolDuringRequest = false;
+    HTTPAPI_Init_calls_after_disable = 0;
+    responseConnectionHeaderValue = NULL;
+
     umock_c_reset_all_calls();
 }
 
@@ -3339,4 +3439,354 @@ TEST_FUNCTION(HTTPAPIEX_Destroy_with_NULL_argument_does_nothing)
     ///destroy
 }
 
+/*Tests_SRS_HTTPAPIEX_99_004: [If maxIdleConnectionsPerHost is 0 then HTTPAPIEX_EnableConnectionPool shall return HTTPAPIEX_INVALID_ARG.]*/
+TEST_FUNCTION(HTTPAPIEX_EnableConnectionPool_with_0_maxIdleConnectionsPerHost_fails)
+{
+    /// arrange
+    HTTPAPIEX_RESULT result;
+
+    /// act
+    result = HTTPAPIEX_EnableConnectionPool(0, 1000);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_HTTPAPIEX_99_006: [HTTPAPIEX_EnableConnectionPool shall create the tick counter and list of idle connections of the pool and shall call HTTPAPI_Init so that idle connections outlive the handles that created them.]*/
+/*Tests_SRS_HTTPAPIEX_99_008: [Otherwise HTTPAPIEX_EnableConnectionPool shall return HTTPAPIEX_OK.]*/
+/*Tests_SRS_HTTPAPIEX_99_010: [HTTPAPIEX_DisableConnectionPool shall close all the idle connections, call HTTPAPI_Deinit and free all the resources of the pool.]*/
+/*Tests_SRS_HTTPAPIEX_99_016: [The first call to HTTPAPIEX_EnableConnectionPool shall create the lock that guards the pool, which is never destroyed.]*/
+TEST_FUNCTION(HTTPAPIEX_EnableConnectionPool_succeeds)
+{
+    /// arrange
+    HTTPAPIEX_RESULT result;
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(tickcounter_create());
+    STRICT_EXPECTED_CALL(VECTOR_create(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPI_Init());
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    /// act
+    result = HTTPAPIEX_EnableConnectionPool(2, 1000);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///destroy
+    HTTPAPIEX_DisableConnectionPool();
+    ASSERT_ARE_EQUAL(size_t, 0, HTTPAPI_Init_calls);
+}
+
+/*Tests_SRS_HTTPAPIEX_99_007: [If any of these fails then HTTPAPIEX_EnableConnectionPool shall return HTTPAPIEX_ERROR.]*/
+TEST_FUNCTION(HTTPAPIEX_EnableConnectionPool_fails_when_tickcounter_create_fails)
+{
+    /// arrange
+    HTTPAPIEX_RESULT result;
+    HTTPAPIEX_CONNECTION_POOL_STATISTICS statistics;
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(tickcounter_create())
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    /// act
+    result = HTTPAPIEX_EnableConnectionPool(2, 1000);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_ERROR, HTTPAPIEX_GetConnectionPoolStatistics(&statistics));
+}
+
+/*Tests_SRS_HTTPAPIEX_99_011: [If parameter statistics is NULL then HTTPAPIEX_GetConnectionPoolStatistics shall return HTTPAPIEX_INVALID_ARG.]*/
+TEST_FUNCTION(HTTPAPIEX_GetConnectionPoolStatistics_with_NULL_statistics_fails)
+{
+    /// arrange
+    HTTPAPIEX_RESULT result;
+
+    /// act
+    result = HTTPAPIEX_GetConnectionPoolStatistics(NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_INVALID_ARG, result);
+}
+
+/*Tests_SRS_HTTPAPIEX_99_001: [When the connection pool is enabled, HTTPAPIEX_ExecuteRequest shall use in step 2 the most recently idle connection of the pool that has the same host name and TLS options instead of creating one.]*/
+/*Tests_SRS_HTTPAPIEX_99_002: [When the connection pool is enabled, HTTPAPIEX_ExecuteRequest shall give the connection back to the pool after a successful request, unless the response has the header Connection: close, the connection has options that cannot be compared or maxIdleConnectionsPerHost idle connections with the same host name and TLS options exist, in which case the connection shall be closed.]*/
+/*Tests_SRS_HTTPAPIEX_99_013: [HTTPAPIEX_GetConnectionPoolStatistics shall copy the counters of the pool to statistics, estimating the handshake time saved as the number of requests on reused connections times the difference between the average request time on new and on reused connections, and shall return HTTPAPIEX_OK.]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequest_with_connection_pool_reuses_the_connection_of_another_handle)
+{
+    /// arrange
+    HTTPAPIEX_HANDLE first;
+    HTTPAPIEX_HANDLE second;
+    HTTPAPIEX_CONNECTION_POOL_STATISTICS statistics;
+    unsigned int statusCode;
+    (void)HTTPAPIEX_EnableConnectionPool(2, 1000);
+    first = HTTPAPIEX_Create(TEST_HOSTNAME);
+    second = HTTPAPIEX_Create(TEST_HOSTNAME);
+    (void)HTTPAPIEX_SetOption(first, "TrustedCerts", "certs");
+    (void)HTTPAPIEX_SetOption(second, "TrustedCerts", "certs");
+    tickcounterTimes[0] = 0; tickcounterTimes[1] = 100; tickcounterTimes[2] = 200; tickcounterTimes[3] = 220;
+    tickcounterTimesCount = 4;
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, HTTPAPIEX_ExecuteRequest(first, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, TEST_REQUEST_HTTP_HEADERS, TEST_REQUEST_BODY, &statusCode, TEST_RESPONSE_HTTP_HEADERS, TEST_RESPONSE_BODY));
+
+    /// act
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, HTTPAPIEX_ExecuteRequest(second, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, TEST_REQUEST_HTTP_HEADERS, TEST_REQUEST_BODY, &statusCode, TEST_RESPONSE_HTTP_HEADERS, TEST_RESPONSE_BODY));
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 1, currentHTTPAPI_CreateConnection_call);
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, HTTPAPIEX_GetConnectionPoolStatistics(&statistics));
+    ASSERT_ARE_EQUAL(int, 1, (int)statistics.requestsOnNewConnections);
+    ASSERT_ARE_EQUAL(int, 1, (int)statistics.requestsOnReusedConnections);
+    ASSERT_ARE_EQUAL(int, 100, (int)statistics.newConnectionsRequestTimeInMilliseconds);
+    ASSERT_ARE_EQUAL(int, 20, (int)statistics.reusedConnectionsRequestTimeInMilliseconds);
+    ASSERT_ARE_EQUAL(int, 80, (int)statistics.estimatedHandshakeTimeSavedInMilliseconds);
+    ASSERT_ARE_EQUAL(int, 0, (int)statistics.connectionsDiscarded);
+
+    ///destroy
+    HTTPAPIEX_Destroy(first);
+    HTTPAPIEX_Destroy(second);
+    HTTPAPIEX_DisableConnectionPool();
+    ASSERT_ARE_EQUAL(size_t, 0, HTTPAPI_Init_calls);
+}
+
+/*Tests_SRS_HTTPAPIEX_99_001: [When the connection pool is enabled, HTTPAPIEX_ExecuteRequest shall use in step 2 the most recently idle connection of the pool that has the same host name and TLS options instead of creating one.]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequest_with_connection_pool_does_not_share_connections_with_different_TLS_options)
+{
+    /// arrange
+    HTTPAPIEX_HANDLE first;
+    HTTPAPIEX_HANDLE second;
+    unsigned int statusCode;
+    (void)HTTPAPIEX_EnableConnectionPool(2, 1000);
+    first = HTTPAPIEX_Create(TEST_HOSTNAME);
+    second = HTTPAPIEX_Create(TEST_HOSTNAME);
+    (void)HTTPAPIEX_SetOption(first, "TrustedCerts", "certs");
+    (void)HTTPAPIEX_SetOption(second, "TrustedCerts", "other certs");
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, HTTPAPIEX_ExecuteRequest(first, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, TEST_REQUEST_HTTP_HEADERS, TEST_REQUEST_BODY, &statusCode, TEST_RESPONSE_HTTP_HEADERS, TEST_RESPONSE_BODY));
+
+    /// act
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, HTTPAPIEX_ExecuteRequest(second, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, TEST_REQUEST_HTTP_HEADERS, TEST_REQUEST_BODY, &statusCode, TEST_RESPONSE_HTTP_HEADERS, TEST_RESPONSE_BODY));
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, HTTPAPIEX_ExecuteRequest(first, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, TEST_REQUEST_HTTP_HEADERS, TEST_REQUEST_BODY, &statusCode, TEST_RESPONSE_HTTP_HEADERS, TEST_RESPONSE_BODY));
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 2, currentHTTPAPI_CreateConnection_call);
+
+    ///destroy
+    HTTPAPIEX_Destroy(first);
+    HTTPAPIEX_Destroy(second);
+    HTTPAPIEX_DisableConnectionPool();
+    ASSERT_ARE_EQUAL(size_t, 0, HTTPAPI_Init_calls);
+}
+
+/*Tests_SRS_HTTPAPIEX_99_002: [When the connection pool is enabled, HTTPAPIEX_ExecuteRequest shall give the connection back to the pool after a successful request, unless the response has the header Connection: close, the connection has options that cannot be compared or maxIdleConnectionsPerHost idle connections with the same host name and TLS options exist, in which case the connection shall be closed.]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequest_with_connection_pool_closes_the_connection_on_Connection_close)
+{
+    /// arrange
+    HTTPAPIEX_HANDLE handle;
+    HTTPAPIEX_CONNECTION_POOL_STATISTICS statistics;
+    unsigned int statusCode;
+    (void)HTTPAPIEX_EnableConnectionPool(2, 1000);
+    handle = HTTPAPIEX_Create(TEST_HOSTNAME);
+    responseConnectionHeaderValue = "Close";
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_FindHeaderValue, my_HTTPHeaders_FindHeaderValue);
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, HTTPAPIEX_ExecuteRequest(handle, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, TEST_REQUEST_HTTP_HEADERS, TEST_REQUEST_BODY, &statusCode, TEST_RESPONSE_HTTP_HEADERS, TEST_RESPONSE_BODY));
+
+    /// act
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, HTTPAPIEX_ExecuteRequest(handle, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, TEST_REQUEST_HTTP_HEADERS, TEST_REQUEST_BODY, &statusCode, TEST_RESPONSE_HTTP_HEADERS, TEST_RESPONSE_BODY));
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 2, currentHTTPAPI_CreateConnection_call);
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, HTTPAPIEX_GetConnectionPoolStatistics(&statistics));
+    ASSERT_ARE_EQUAL(int, 2, (int)statistics.requestsOnNewConnections);
+    ASSERT_ARE_EQUAL(int, 1, (int)statistics.connectionsDiscarded);
+
+    ///destroy
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_FindHeaderValue, NULL);
+    HTTPAPIEX_Destroy(handle);
+    HTTPAPIEX_DisableConnectionPool();
+    ASSERT_ARE_EQUAL(size_t, 0, HTTPAPI_Init_calls);
+}
+
+/*Tests_SRS_HTTPAPIEX_99_002: [When the connection pool is enabled, HTTPAPIEX_ExecuteRequest shall give the connection back to the pool after a successful request, unless the response has the header Connection: close, the connection has options that cannot be compared or maxIdleConnectionsPerHost idle connections with the same host name and TLS options exist, in which case the connection shall be closed.]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequest_with_connection_pool_does_not_pool_connections_with_other_options)
+{
+    /// arrange
+    HTTPAPIEX_HANDLE first;
+    HTTPAPIEX_HANDLE second;
+    unsigned int statusCode;
+    (void)HTTPAPIEX_EnableConnectionPool(2, 1000);
+    first = HTTPAPIEX_Create(TEST_HOSTNAME);
+    second = HTTPAPIEX_Create(TEST_HOSTNAME);
+    (void)HTTPAPIEX_SetOption(first, "someOption", "3");
+    (void)HTTPAPIEX_SetOption(second, "someOption", "3");
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, HTTPAPIEX_ExecuteRequest(first, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, TEST_REQUEST_HTTP_HEADERS, TEST_REQUEST_BODY, &statusCode, TEST_RESPONSE_HTTP_HEADERS, TEST_RESPONSE_BODY));
+
+    /// act
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, HTTPAPIEX_ExecuteRequest(second, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, TEST_REQUEST_HTTP_HEADERS, TEST_REQUEST_BODY, &statusCode, TEST_RESPONSE_HTTP_HEADERS, TEST_RESPONSE_BODY));
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 2, currentHTTPAPI_CreateConnection_call);
+
+    ///destroy
+    HTTPAPIEX_Destroy(first);
+    HTTPAPIEX_Destroy(second);
+    HTTPAPIEX_DisableConnectionPool();
+    ASSERT_ARE_EQUAL(size_t, 0, HTTPAPI_Init_calls);
+}
+
+/*Tests_SRS_HTTPAPIEX_99_002: [When the connection pool is enabled, HTTPAPIEX_ExecuteRequest shall give the connection back to the pool after a successful request, unless the response has the header Connection: close, the connection has options that cannot be compared or maxIdleConnectionsPerHost idle connections with the same host name and TLS options exist, in which case the connection shall be closed.]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequest_with_connection_pool_keeps_at_most_maxIdleConnectionsPerHost)
+{
+    /// arrange
+    HTTPAPIEX_HANDLE first;
+    HTTPAPIEX_CONNECTION_POOL_STATISTICS statistics;
+    unsigned int statusCode;
+    (void)HTTPAPIEX_EnableConnectionPool(1, 1000);
+    first = HTTPAPIEX_Create(TEST_HOSTNAME);
+    nestedRequestHandle = HTTPAPIEX_Create(TEST_HOSTNAME);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPI_ExecuteRequest, my_HTTPAPI_ExecuteRequest);
+
+    /// act
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, HTTPAPIEX_ExecuteRequest(first, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, TEST_REQUEST_HTTP_HEADERS, TEST_REQUEST_BODY, &statusCode, TEST_RESPONSE_HTTP_HEADERS, TEST_RESPONSE_BODY));
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 2, currentHTTPAPI_CreateConnection_call);
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, HTTPAPIEX_GetConnectionPoolStatistics(&statistics));
+    ASSERT_ARE_EQUAL(int, 2, (int)statistics.requestsOnNewConnections);
+    ASSERT_ARE_EQUAL(int, 1, (int)statistics.connectionsDiscarded);
+
+    ///destroy
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPI_ExecuteRequest, NULL);
+    HTTPAPIEX_Destroy(first);
+    HTTPAPIEX_Destroy(nestedRequestHandle);
+    nestedRequestHandle = NULL;
+    runningNestedRequestHandle = NULL;
+    HTTPAPIEX_DisableConnectionPool();
+    ASSERT_ARE_EQUAL(size_t, 0, HTTPAPI_Init_calls);
+}
+
+/*Tests_SRS_HTTPAPIEX_99_001: [When the connection pool is enabled, HTTPAPIEX_ExecuteRequest shall use in step 2 the most recently idle connection of the pool that has the same host name and TLS options instead of creating one.]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequest_with_connection_pool_closes_expired_connections)
+{
+    /// arrange
+    HTTPAPIEX_HANDLE handle;
+    HTTPAPIEX_CONNECTION_POOL_STATISTICS statistics;
+    unsigned int statusCode;
+    (void)HTTPAPIEX_EnableConnectionPool(2, 1000);
+    handle = HTTPAPIEX_Create(TEST_HOSTNAME);
+    tickcounterTimes[0] = 0; tickcounterTimes[1] = 100; tickcounterTimes[2] = 1100;
+    tickcounterTimesCount = 3;
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, HTTPAPIEX_ExecuteRequest(handle, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, TEST_REQUEST_HTTP_HEADERS, TEST_REQUEST_BODY, &statusCode, TEST_RESPONSE_HTTP_HEADERS, TEST_RESPONSE_BODY));
+
+    /// act
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, HTTPAPIEX_ExecuteRequest(handle, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, TEST_REQUEST_HTTP_HEADERS, TEST_REQUEST_BODY, &statusCode, TEST_RESPONSE_HTTP_HEADERS, TEST_RESPONSE_BODY));
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 2, currentHTTPAPI_CreateConnection_call);
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, HTTPAPIEX_GetConnectionPoolStatistics(&statistics));
+    ASSERT_ARE_EQUAL(int, 1, (int)statistics.connectionsExpired);
+    ASSERT_ARE_EQUAL(int, 0, (int)statistics.requestsOnReusedConnections);
+
+    ///destroy
+    HTTPAPIEX_Destroy(handle);
+    HTTPAPIEX_DisableConnectionPool();
+    ASSERT_ARE_EQUAL(size_t, 0, HTTPAPI_Init_calls);
+}
+
+/*Tests_SRS_HTTPAPIEX_99_003: [If HTTPAPI_ExecuteRequest fails on a connection taken from the pool, HTTPAPIEX_ExecuteRequest shall close it and, for a GET, PUT or DELETE request, redo step 2 with a new connection without counting it as a retry.]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequest_with_connection_pool_retries_a_failed_reused_connection_on_a_new_one)
+{
+    /// arrange
+    HTTPAPIEX_HANDLE handle;
+    HTTPAPIEX_CONNECTION_POOL_STATISTICS statistics;
+    unsigned int statusCode;
+    (void)HTTPAPIEX_EnableConnectionPool(2, 1000);
+    handle = HTTPAPIEX_Create(TEST_HOSTNAME);
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, HTTPAPIEX_ExecuteRequest(handle, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, TEST_REQUEST_HTTP_HEADERS, TEST_REQUEST_BODY, &statusCode, TEST_RESPONSE_HTTP_HEADERS, TEST_RESPONSE_BODY));
+    umock_c_reset_all_calls();
+
+    /*the reused connection and then the new connection fail, the new connection is retried once*/
+    failingHTTPAPI_ExecuteRequest_calls = 2;
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPI_ExecuteRequest, my_HTTPAPI_ExecuteRequest);
+
+    /// act
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, HTTPAPIEX_ExecuteRequest(handle, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, TEST_REQUEST_HTTP_HEADERS, TEST_REQUEST_BODY, &statusCode, TEST_RESPONSE_HTTP_HEADERS, TEST_RESPONSE_BODY));
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 3, currentHTTPAPI_CreateConnection_call);
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, HTTPAPIEX_GetConnectionPoolStatistics(&statistics));
+    ASSERT_ARE_EQUAL(int, 2, (int)statistics.requestsOnNewConnections);
+    ASSERT_ARE_EQUAL(int, 0, (int)statistics.requestsOnReusedConnections);
+
+    ///destroy
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPI_ExecuteRequest, NULL);
+    HTTPAPIEX_Destroy(handle);
+    HTTPAPIEX_DisableConnectionPool();
+    ASSERT_ARE_EQUAL(size_t, 0, HTTPAPI_Init_calls);
+}
+
+/*Tests_SRS_HTTPAPIEX_99_015: [A POST or PATCH request shall not be sent again on a new connection, since the server might have received it.]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequest_with_connection_pool_does_not_send_a_POST_again_after_a_failed_reused_connection)
+{
+    /// arrange
+    HTTPAPIEX_HANDLE handle;
+    unsigned int statusCode;
+    (void)HTTPAPIEX_EnableConnectionPool(2, 1000);
+    handle = HTTPAPIEX_Create(TEST_HOSTNAME);
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, HTTPAPIEX_ExecuteRequest(handle, HTTPAPI_REQUEST_POST, TEST_RELATIVE_PATH, TEST_REQUEST_HTTP_HEADERS, TEST_REQUEST_BODY, &statusCode, TEST_RESPONSE_HTTP_HEADERS, TEST_RESPONSE_BODY));
+    umock_c_reset_all_calls();
+
+    failingHTTPAPI_ExecuteRequest_calls = 1;
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPI_ExecuteRequest, my_HTTPAPI_ExecuteRequest);
+
+    /// act
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_RECOVERYFAILED, HTTPAPIEX_ExecuteRequest(handle, HTTPAPI_REQUEST_POST, TEST_RELATIVE_PATH, TEST_REQUEST_HTTP_HEADERS, TEST_REQUEST_BODY, &statusCode, TEST_RESPONSE_HTTP_HEADERS, TEST_RESPONSE_BODY));
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 1, currentHTTPAPI_CreateConnection_call);
+
+    ///destroy
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPI_ExecuteRequest, NULL);
+    HTTPAPIEX_Destroy(handle);
+    HTTPAPIEX_DisableConnectionPool();
+    ASSERT_ARE_EQUAL(size_t, 0, HTTPAPI_Init_calls);
+}
+
+/*Tests_SRS_HTTPAPIEX_99_014: [HTTPAPIEX_ExecuteRequest shall keep the connection pool it started with alive until it returns, even if HTTPAPIEX_DisableConnectionPool is called meanwhile.]*/
+/*Tests_SRS_HTTPAPIEX_99_017: [If requests are using the pool then HTTPAPIEX_DisableConnectionPool shall only stop new requests from using it, and the last of those requests shall close its idle connections and its own connection, call HTTPAPI_Deinit and free the pool.]*/
+TEST_FUNCTION(HTTPAPIEX_DisableConnectionPool_during_a_request_frees_the_pool_when_the_request_ends)
+{
+    /// arrange
+    HTTPAPIEX_HANDLE first;
+    HTTPAPIEX_HANDLE second;
+    HTTPAPIEX_CONNECTION_POOL_STATISTICS statistics;
+    unsigned int statusCode;
+    (void)HTTPAPIEX_EnableConnectionPool(2, 1000);
+    first = HTTPAPIEX_Create(TEST_HOSTNAME);
+    second = HTTPAPIEX_Create(TEST_HOSTNAME);
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, HTTPAPIEX_ExecuteRequest(first, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, TEST_REQUEST_HTTP_HEADERS, TEST_REQUEST_BODY, &statusCode, TEST_RESPONSE_HTTP_HEADERS, TEST_RESPONSE_BODY));
+    disableConnectionPoolDuringRequest = true;
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPI_ExecuteRequest, my_HTTPAPI_ExecuteRequest);
+
+    /// act
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, HTTPAPIEX_ExecuteRequest(second, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, TEST_REQUEST_HTTP_HEADERS, TEST_REQUEST_BODY, &statusCode, TEST_RESPONSE_HTTP_HEADERS, TEST_RESPONSE_BODY));
+
+    ///assert
+    /*the handles and the pool while the request runs, then only the handles*/
+    ASSERT_ARE_EQUAL(size_t, 3, HTTPAPI_Init_calls_after_disable);
+    ASSERT_ARE_EQUAL(size_t, 2, HTTPAPI_Init_calls);
+    ASSERT_ARE_EQUAL(size_t, 1, currentHTTPAPI_CreateConnection_call);
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_ERROR, HTTPAPIEX_GetConnectionPoolStatistics(&statistics));
+
+    ///destroy
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPI_ExecuteRequest, NULL);
+    HTTPAPIEX_Destroy(first);
+    HTTPAPIEX_Destroy(second);
+    ASSERT_ARE_EQUAL(size_t, 0, HTTPAPI_Init_calls);
+}
+
 END_TEST_SUITE(httpapiex_unittests)
@@ -65,31 +65,13 @@ void my_gballoc_free(void* ptr)
     free(ptr);
 }
 
+#include "testrunnerswitcher.h"
 #include "testrunnerswitcher.h"
 #include "umock_c.h"
 #include "umocktypes_charptr.h"
 
 #define ENABLE_MOCKS
 
-#include "azure_c_shared_utility/map.h"
-
-MAP_HANDLE my_Map_Create(MAP_FILTER_CALLBACK mapFilterFunc)
-{
-    (void)mapFilterFunc;
-    return (MAP_HANDLE)malloc(1);
-}
-
-MAP_HANDLE my_Map_Clone(MAP_HANDLE handle)
-{
-    (void)handle;
-    return (MAP_HANDLE)malloc(1);
-}
-
-void my_Map_Destroy(MAP_HANDLE handle)
-{
-    free(handle);
-}
-
 #include "azure_c_shared_utility/gballoc.h"
 
 #undef ENABLE_MOCKS
@@ -104,9 +86,6 @@ static TEST_MUTEX_HANDLE g_testByTest;
 TEST_DEFINE_ENUM_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT_VALUES);
 IMPLEMENT_UMOCK_C_ENUM_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT_VALUES);
 
-TEST_DEFINE_ENUM_TYPE(MAP_RESULT, MAP_RESULT_VALUES);
-IMPLEMENT_UMOCK_C_ENUM_TYPE(MAP_RESULT, MAP_RESULT_VALUES);
-
 /*test assets*/
 #define NAME1 "name1"
 #define VALUE1 "value1"
@@ -119,11 +98,15 @@ static const char *NAME1_TRICK3 = "name1: value1";
 #define VALUE2 "value2"
 #define HEADER2 NAME2 ": " VALUE2
 
+/*too long to be kept inline with the name*/
+#define LONG_VALUE "0123456789012345678901234567890123456789012345678901234567890123456789"
+
+/*headers are first given room for 8*/
+#define MORE_THAN_INITIAL_CAPACITY 20
+
 #define TEMP_BUFFER_SIZE 1024
 static char tempBuffer[TEMP_BUFFER_SIZE];
 
-#define MAX_NAME_VALUE_PAIR 100
-
 static TEST_MUTEX_HANDLE g_dllByDll;
 
 DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
@@ -151,17 +134,6 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
             result = umocktypes_charptr_register_types();
             ASSERT_ARE_EQUAL(int, 0, result);
 
-            REGISTER_TYPE(MAP_RESULT, MAP_RESULT);
-            REGISTER_UMOCK_ALIAS_TYPE(MAP_FILTER_CALLBACK, void*);
-            REGISTER_UMOCK_ALIAS_TYPE(MAP_HANDLE, void*);
-
-            REGISTER_GLOBAL_MOCK_HOOK(Map_Create, my_Map_Create);
-            REGISTER_GLOBAL_MOCK_HOOK(Map_Clone, my_Map_Clone);
-            REGISTER_GLOBAL_MOCK_HOOK(Map_Destroy, my_Map_Destroy);
-            REGISTER_GLOBAL_MOCK_RETURN(Map_AddOrUpdate, MAP_OK);
-            REGISTER_GLOBAL_MOCK_RETURN(Map_GetValueFromKey, VALUE1);
-            REGISTER_GLOBAL_MOCK_RETURN(Map_GetInternals, MAP_OK);
-
             REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
             REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
             REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
@@ -198,15 +170,14 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
 
 
         /*Tests_SRS_HTTP_HEADERS_99_002:[ This API shall produce a HTTP_HANDLE that can later be used in subsequent calls to the module.]*/
+        /*Tests_SRS_HTTP_HEADERS_99_040: [ HTTPHeaders_Alloc shall not allocate room for headers until the first one is added. ]*/
         TEST_FUNCTION(HTTPHeaders_Alloc_happy_path_succeeds)
         {
             ///arrange
-			HTTP_HEADERS_HANDLE handle;
+            HTTP_HEADERS_HANDLE handle;
             STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
                 .IgnoreArgument(1);
 
-            STRICT_EXPECTED_CALL(Map_Create(IGNORED_PTR_ARG));
-
             ///act
             handle = HTTPHeaders_Alloc();
 
@@ -223,7 +194,7 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_Alloc_fails_when_malloc_fails)
         {
             ///arrange
-			HTTP_HEADERS_HANDLE httpHandle;
+            HTTP_HEADERS_HANDLE httpHandle;
             whenShallmalloc_fail = currentmalloc_call + 1;
             STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
                 .IgnoreArgument(1);
@@ -256,8 +227,6 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
             HTTP_HEADERS_HANDLE handle = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_Destroy(IGNORED_PTR_ARG))
-                .IgnoreArgument(1);
             STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
                 .IgnoreArgument(1);
 
@@ -268,25 +237,28 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
         }
 
-
-        /*Tests_SRS_HTTP_HEADERS_99_003:[ The function shall return NULL when the function cannot execute properly]*/
-        TEST_FUNCTION(HTTPHeaders_Alloc_fails_when_Map_Create_fails)
+        /*Tests_SRS_HTTP_HEADERS_99_005:[ Calling this API shall de-allocate the data structures allocated by previous API calls to the same handle.]*/
+        TEST_FUNCTION(HTTPHeaders_Free_with_headers_frees_them)
         {
             ///arrange
-			HTTP_HEADERS_HANDLE httpHandle;
-            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-                .IgnoreArgument(1);
-            STRICT_EXPECTED_CALL(Map_Create(IGNORED_PTR_ARG))
-                .SetReturn(NULL);
+            HTTP_HEADERS_HANDLE handle = HTTPHeaders_Alloc();
+            (void)HTTPHeaders_AddHeaderNameValuePair(handle, NAME1, VALUE1);
+            (void)HTTPHeaders_AddHeaderNameValuePair(handle, NAME2, LONG_VALUE);
+            umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*the long header*/
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*the headers*/
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*the buckets*/
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*the handle*/
                 .IgnoreArgument(1);
 
             ///act
-            httpHandle = HTTPHeaders_Alloc();
+            HTTPHeaders_Free(handle);
 
             ///assert
-            ASSERT_IS_NULL(httpHandle);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
         }
 
@@ -294,16 +266,11 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_Alloc_succeeds_and_GetHeaderCount_returns_0)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             size_t nHeaders;
-            size_t zero = 0;
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                .IgnoreAllArguments()
-                .CopyOutArgumentBuffer(4, &zero, sizeof(zero));
-
             ///act
             res = HTTPHeaders_GetHeaderCount(httpHandle, &nHeaders);
 
@@ -321,15 +288,13 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_happy_path_succeeds)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist*/
-
-            STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, NAME1, VALUE1))
+            STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG)) /*the headers*/
+                .IgnoreArgument(2);
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*the buckets*/
                 .IgnoreArgument(1);
 
             ///act
@@ -339,28 +304,50 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
             ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
-            //checking content
-
             ///cleanup
             HTTPHeaders_Free(httpHandle);
         }
 
-        /*Codes_SRS_HTTP_HEADERS_99_015:[ The function shall return HTTP_HEADERS_ALLOC_FAILED when an internal request to allocate memory fails.]*/
-        TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_fails_when_Map_AddOrUpdate_fails)
+        /*Tests_SRS_HTTP_HEADERS_99_015:[ The function shall return HTTP_HEADERS_ALLOC_FAILED when an internal request to allocate memory fails.]*/
+        TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_fails_when_realloc_fails)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
+            size_t nHeaders;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist*/
+            whenShallrealloc_fail = currentrealloc_call + 1;
+            STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG))
+                .IgnoreArgument(2);
 
+            ///act
+            res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
 
-            STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, NAME1, VALUE1))
-                .IgnoreArgument(1)
-                .SetReturn(MAP_ERROR);
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_ALLOC_FAILED, res);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            (void)HTTPHeaders_GetHeaderCount(httpHandle, &nHeaders);
+            ASSERT_ARE_EQUAL(size_t, 0, nHeaders);
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_99_015:[ The function shall return HTTP_HEADERS_ALLOC_FAILED when an internal request to allocate memory fails.]*/
+        TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_fails_when_malloc_of_buckets_fails)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
+            size_t nHeaders;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            umock_c_reset_all_calls();
+
+            whenShallmalloc_fail = currentmalloc_call + 1;
+            STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG))
+                .IgnoreArgument(2);
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+                .IgnoreArgument(1);
 
             ///act
             res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
@@ -368,8 +355,36 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
             ///assert
             ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_ALLOC_FAILED, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            (void)HTTPHeaders_GetHeaderCount(httpHandle, &nHeaders);
+            ASSERT_ARE_EQUAL(size_t, 0, nHeaders);
 
-            //checking content
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_99_015:[ The function shall return HTTP_HEADERS_ALLOC_FAILED when an internal request to allocate memory fails.]*/
+        TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_with_long_value_fails_when_malloc_fails)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
+            size_t nHeaders;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
+            umock_c_reset_all_calls();
+
+            whenShallmalloc_fail = currentmalloc_call + 1;
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+                .IgnoreArgument(1);
+
+            ///act
+            res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME2, LONG_VALUE);
+
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_ALLOC_FAILED, res);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            (void)HTTPHeaders_GetHeaderCount(httpHandle, &nHeaders);
+            ASSERT_ARE_EQUAL(size_t, 1, nHeaders);
+            ASSERT_IS_NULL(HTTPHeaders_FindHeaderValue(httpHandle, NAME2));
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
@@ -379,32 +394,51 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_succeeds)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
+            char* headerValue;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist*/
+            ///act
+            res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
+
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
+            (void)HTTPHeaders_GetHeader(httpHandle, 0, &headerValue);
+            ASSERT_ARE_EQUAL(char_ptr, HEADER1, headerValue);
 
-            STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, NAME1, VALUE1))
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+            free(headerValue);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_99_016:[ The function shall store the name:value pair in such a way that when later retrieved by a call to GetHeader it will return a string that shall strcmp equal to the name+": "+value.]*/
+        TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_with_long_value_succeeds)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
+            char* headerValue;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
+            umock_c_reset_all_calls();
+
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
                 .IgnoreArgument(1);
 
             ///act
-            res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
+            res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME2, LONG_VALUE);
 
             ///assert
             ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-
-            //checking content
+            (void)HTTPHeaders_GetHeader(httpHandle, 1, &headerValue);
+            ASSERT_ARE_EQUAL(char_ptr, NAME2 ": " LONG_VALUE, headerValue);
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
+            free(headerValue);
         }
 
-        
-
         /*Tests_SRS_HTTP_HEADERS_99_014:[ The function shall return when the handle is not valid or when name parameter is NULL or when value parameter is NULL.]*/
         TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_with_NULL_handle_fails)
         {
@@ -422,7 +456,7 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_with_NULL_name_fails)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
@@ -441,7 +475,7 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_with_NULL_value_fails)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
@@ -460,70 +494,47 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_with_same_Name_appends_to_existing_value_succeeds)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
+            size_t nHeaders;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn(VALUE1);
-
-            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-                .IgnoreArgument(1);
-
-            STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, NAME1, VALUE1 ", " VALUE1))
-                .IgnoreArgument(1);
-
-            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-                .IgnoreArgument(1);
-
             ///act
-            res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
+            res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE2);
 
             ///assert
             ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            ASSERT_ARE_EQUAL(char_ptr, VALUE1 ", " VALUE2, HTTPHeaders_FindHeaderValue(httpHandle, NAME1));
+            (void)HTTPHeaders_GetHeaderCount(httpHandle, &nHeaders);
+            ASSERT_ARE_EQUAL(size_t, 1, nHeaders);
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
         }
 
-        /*Tests_SRS_HTTP_HEADERS_99_015:[ The function shall return HTTP_HEADERS_ALLOC_FAILED when an internal request to allocate memory fails.]*/
-        TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_with_same_Name_appends_fails_when_Map_AddOrUpdate_fails)
+        /*Tests_SRS_HTTP_HEADERS_99_017:[ If the name already exists in the collection of headers, the function shall concatenate the new value after the existing value, separated by a comma and a space as in: old-value+", "+new-value.]*/
+        TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_with_same_Name_appends_to_existing_long_value_succeeds)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
-            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, LONG_VALUE);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn(VALUE1);
-
-            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*the new line*/
                 .IgnoreArgument(1);
-
-            STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, NAME1, VALUE1 ", " VALUE1))
-                .IgnoreArgument(1)
-                .SetReturn(MAP_ERROR);
-
-            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*the old line*/
                 .IgnoreArgument(1);
 
             ///act
-            res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
+            res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE2);
 
             ///assert
-            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_ERROR, res);
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            ASSERT_ARE_EQUAL(char_ptr, LONG_VALUE ", " VALUE2, HTTPHeaders_FindHeaderValue(httpHandle, NAME1));
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
@@ -533,28 +544,22 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_with_same_Name_fails_when_gballoc_fails)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn(VALUE1);
-
             whenShallmalloc_fail = currentmalloc_call + 1;
             STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
                 .IgnoreArgument(1);
 
             ///act
-            res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
+            res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, LONG_VALUE);
 
             ///assert
             ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_ALLOC_FAILED, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            ASSERT_ARE_EQUAL(char_ptr, VALUE1, HTTPHeaders_FindHeaderValue(httpHandle, NAME1));
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
@@ -564,27 +569,94 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_add_two_headers_produces_two_headers)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
+            size_t nHeaders;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME2))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
-
-            STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, NAME2, VALUE2))
-                .IgnoreArgument(1);
-
             ///act
             res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME2, VALUE2);
 
             ///assert
             ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            (void)HTTPHeaders_GetHeaderCount(httpHandle, &nHeaders);
+            ASSERT_ARE_EQUAL(size_t, 2, nHeaders);
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_99_012:[ Calling this API shall record a header from name and value parameters.]*/
+        TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_past_initial_capacity_keeps_all_headers)
+        {
+            ///arrange
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            size_t nHeaders;
+            size_t i;
+            char name[16];
+            char value[16];
+
+            ///act
+            for (i = 0; i < MORE_THAN_INITIAL_CAPACITY; i++)
+            {
+                HTTP_HEADERS_RESULT res;
+                (void)sprintf(name, "name%d", (int)i);
+                (void)sprintf(value, "value%d", (int)i);
+                res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, name, value);
+                ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
+            }
+
+            ///assert
+            (void)HTTPHeaders_GetHeaderCount(httpHandle, &nHeaders);
+            ASSERT_ARE_EQUAL(size_t, MORE_THAN_INITIAL_CAPACITY, nHeaders);
+            for (i = 0; i < MORE_THAN_INITIAL_CAPACITY; i++)
+            {
+                char* headerValue;
+                (void)sprintf(name, "NAME%d", (int)i);
+                (void)sprintf(value, "value%d", (int)i);
+                ASSERT_ARE_EQUAL(char_ptr, value, HTTPHeaders_FindHeaderValue(httpHandle, name));
+
+                (void)sprintf(tempBuffer, "name%d: value%d", (int)i, (int)i);
+                (void)HTTPHeaders_GetHeader(httpHandle, i, &headerValue);
+                ASSERT_ARE_EQUAL(char_ptr, tempBuffer, headerValue);
+                free(headerValue);
+            }
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_99_015:[ The function shall return HTTP_HEADERS_ALLOC_FAILED when an internal request to allocate memory fails.]*/
+        TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_past_initial_capacity_fails_when_realloc_fails)
+        {
+            ///arrange
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            HTTP_HEADERS_RESULT res;
+            size_t nHeaders;
+            size_t i;
+
+            for (i = 0; i < 8; i++)
+            {
+                (void)sprintf(tempBuffer, "name%d", (int)i);
+                (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, tempBuffer, VALUE1);
+            }
+            umock_c_reset_all_calls();
+
+            whenShallrealloc_fail = currentrealloc_call + 1;
+            STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+                .IgnoreAllArguments();
+
+            ///act
+            res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, "name8", VALUE2);
+
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_ALLOC_FAILED, res);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            (void)HTTPHeaders_GetHeaderCount(httpHandle, &nHeaders);
+            ASSERT_ARE_EQUAL(size_t, 8, nHeaders);
+            ASSERT_ARE_EQUAL(char_ptr, VALUE1, HTTPHeaders_FindHeaderValue(httpHandle, "name7"));
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
@@ -594,20 +666,11 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_When_Second_Added_Header_Is_A_Substring_Of_An_Existing_Header_2_Headers_Are_Added)
         {
             ///arrange
-			HTTP_HEADERS_RESULT result;
+            HTTP_HEADERS_RESULT result;
+            size_t nHeaders;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, "ab"))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, "ab", VALUE1);
             umock_c_reset_all_calls();
-            
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, "a"))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
-
-            STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, "a", VALUE1))
-                .IgnoreArgument(1);
 
             ///act
             result = HTTPHeaders_AddHeaderNameValuePair(httpHandle, "a", VALUE1);
@@ -615,11 +678,41 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
             ///assert
             ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, result);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            (void)HTTPHeaders_GetHeaderCount(httpHandle, &nHeaders);
+            ASSERT_ARE_EQUAL(size_t, 2, nHeaders);
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
         }
 
+        /*Tests_SRS_HTTP_HEADERS_99_041: [ Header names shall be compared without regard to case. ]*/
+        /*Tests_SRS_HTTP_HEADERS_99_042: [ An existing header shall keep the name it was first added with. ]*/
+        TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_with_same_Name_in_other_case_appends_to_existing_value)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
+            size_t nHeaders;
+            char* headerValue;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, "Content-Type", VALUE1);
+            umock_c_reset_all_calls();
+
+            ///act
+            res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, "content-TYPE", VALUE2);
+
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            (void)HTTPHeaders_GetHeaderCount(httpHandle, &nHeaders);
+            ASSERT_ARE_EQUAL(size_t, 1, nHeaders);
+            (void)HTTPHeaders_GetHeader(httpHandle, 0, &headerValue);
+            ASSERT_ARE_EQUAL(char_ptr, "Content-Type: " VALUE1 ", " VALUE2, headerValue);
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+            free(headerValue);
+        }
+
         /*Tests_SRS_HTTP_HEADERS_99_022:[ The return value shall be NULL if name parameter is NULL or if httpHeadersHandle is NULL]*/
         TEST_FUNCTION(HTTPHeaders_FindHeaderValue_with_NULL_handle_returns_NULL)
         {
@@ -637,7 +730,7 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_FindHeaderValue_with_NULL_name_returns_NULL)
         {
             ///arrange
-			const char* res;
+            const char* res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
@@ -657,22 +750,16 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_FindHeaderValue_retrieves_previously_stored_value_succeeds)
         {
             ///arrange
-			const char* res1;
+            const char* res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1);
-
             ///act
-            res1 = HTTPHeaders_FindHeaderValue(httpHandle, NAME1);
+            res = HTTPHeaders_FindHeaderValue(httpHandle, NAME1);
 
             ///assert
-            ASSERT_ARE_EQUAL(char_ptr, VALUE1, res1);
+            ASSERT_ARE_EQUAL(char_ptr, VALUE1, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
             ///cleanup
@@ -684,26 +771,13 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_FindHeaderValue_retrieves_previously_stored_value_for_two_headers_succeeds)
         {
             ///arrange
-			const char* res1;
-			const char* res2;
+            const char* res1;
+            const char* res2;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME2))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME2, VALUE2);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn(VALUE1);
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME2))
-                .IgnoreArgument(1)
-                .SetReturn(VALUE2);
-
             ///act
             res1 = HTTPHeaders_FindHeaderValue(httpHandle, NAME1);
             res2 = HTTPHeaders_FindHeaderValue(httpHandle, NAME2);
@@ -721,27 +795,18 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         /*Tests_SRS_HTTP_HEADERS_99_021:[ In this case the return value shall point to a string that shall strcmp equal to the original stored string.]*/
         TEST_FUNCTION(HTTPHeaders_FindHeaderValue_retrieves_concatenation_of_previously_stored_values_for_header_name_succeeds)
         {
-			const char* res;
+            ///arrange
+            const char* res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn(VALUE1); /*this key exists, was added above*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE2);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn(VALUE1 ", " VALUE2);
-
             ///act
             res = HTTPHeaders_FindHeaderValue(httpHandle, NAME1);
 
             ///assert
-            ASSERT_ARE_EQUAL(char_ptr,VALUE1 ", " VALUE2, res);
+            ASSERT_ARE_EQUAL(char_ptr, VALUE1 ", " VALUE2, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
             ///cleanup
@@ -749,58 +814,56 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         }
 
         /*Tests_SRS_HTTP_HEADERS_99_020:[ The return value shall be different than NULL when the name matches the name of a previously stored name:value pair.]*/
-        /*actually we are trying to see that finding a nonexisting value produces NULL*/
+        /*the following test is trying to retrieve a value that was not stored*/
         TEST_FUNCTION(HTTPHeaders_FindHeaderValue_returns_NULL_for_nonexistent_value)
         {
             ///arrange
-			const char* res2;
+            const char* res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME2))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL);
+            ///act
+            res = HTTPHeaders_FindHeaderValue(httpHandle, NAME2);
+
+            ///assert
+            ASSERT_IS_NULL(res);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_99_020:[ The return value shall be different than NULL when the name matches the name of a previously stored name:value pair.]*/
+        TEST_FUNCTION(HTTPHeaders_FindHeaderValue_on_empty_headers_returns_NULL)
+        {
+            ///arrange
+            const char* res;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            umock_c_reset_all_calls();
 
             ///act
-            res2 = HTTPHeaders_FindHeaderValue(httpHandle, NAME2);
+            res = HTTPHeaders_FindHeaderValue(httpHandle, NAME1);
 
             ///assert
-            ASSERT_IS_NULL(res2);
+            ASSERT_IS_NULL(res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
         }
 
-        /*trying to catch some errors here*/
         /*Tests_SRS_HTTP_HEADERS_99_020:[ The return value shall be different than NULL when the name matches the name of a previously stored name:value pair.]*/
         TEST_FUNCTION(HTTPHeaders_FindHeaderValue_with_nonexistent_header_succeeds)
         {
             ///arrange
-			const char* res1;
-			const char* res2;
-			const char* res3;
+            const char* res1;
+            const char* res2;
+            const char* res3;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1_TRICK1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL);
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1_TRICK2))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL);
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1_TRICK3))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL);
-
             ///act
             res1 = HTTPHeaders_FindHeaderValue(httpHandle, NAME1_TRICK1);
             res2 = HTTPHeaders_FindHeaderValue(httpHandle, NAME1_TRICK2);
@@ -816,57 +879,95 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
             HTTPHeaders_Free(httpHandle);
         }
 
+        /*Tests_SRS_HTTP_HEADERS_99_041: [ Header names shall be compared without regard to case. ]*/
+        TEST_FUNCTION(HTTPHeaders_FindHeaderValue_ignores_the_case_of_the_name)
+        {
+            ///arrange
+            const char* res1;
+            const char* res2;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, "Content-Length", "12");
+            umock_c_reset_all_calls();
+
+            ///act
+            res1 = HTTPHeaders_FindHeaderValue(httpHandle, "content-length");
+            res2 = HTTPHeaders_FindHeaderValue(httpHandle, "CONTENT-LENGTH");
+
+            ///assert
+            ASSERT_ARE_EQUAL(char_ptr, "12", res1);
+            ASSERT_ARE_EQUAL(char_ptr, "12", res2);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
+
         /* Tests_SRS_HTTP_HEADERS_06_001: [This API will perform exactly as HTTPHeaders_AddHeaderNameValuePair except that if the header name already exists the already existing value will be replaced as opposed to concatenated to.] */
         TEST_FUNCTION(HTTPHeaders_ReplaceHeaderNameValuePair_succeeds)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
+            size_t nHeaders;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME2, VALUE2);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn(VALUE1); /*this key does not exist, the line below is adding it*/
-
-            STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, NAME1, VALUE2))
-                .IgnoreArgument(1);
-
             ///act
             res = HTTPHeaders_ReplaceHeaderNameValuePair(httpHandle, NAME1, VALUE2);
 
             ///assert
             ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            ASSERT_ARE_EQUAL(char_ptr, VALUE2, HTTPHeaders_FindHeaderValue(httpHandle, NAME1));
+            (void)HTTPHeaders_GetHeaderCount(httpHandle, &nHeaders);
+            ASSERT_ARE_EQUAL(size_t, 2, nHeaders);
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
         }
 
         /* Tests_SRS_HTTP_HEADERS_06_001: [This API will perform exactly as HTTPHeaders_AddHeaderNameValuePair except that if the header name already exists the already existing value will be replaced as opposed to concatenated to.] */
-        TEST_FUNCTION(HTTPHeaders_ReplaceHeaderNameValuePair_for_none_existing_header_succeeds)
+        TEST_FUNCTION(HTTPHeaders_ReplaceHeaderNameValuePair_of_long_value_with_short_value_succeeds)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
+            char* headerValue;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, LONG_VALUE);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL);
-
-            STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, NAME1, VALUE2))
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*the long line*/
                 .IgnoreArgument(1);
 
             ///act
-            res = HTTPHeaders_ReplaceHeaderNameValuePair(httpHandle, NAME1, VALUE2);
+            res = HTTPHeaders_ReplaceHeaderNameValuePair(httpHandle, "NAME1", VALUE2); /*the name keeps the case it was added with*/
 
             ///assert
             ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            (void)HTTPHeaders_GetHeader(httpHandle, 0, &headerValue);
+            ASSERT_ARE_EQUAL(char_ptr, NAME1 ": " VALUE2, headerValue);
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+            free(headerValue);
+        }
+
+        /* Tests_SRS_HTTP_HEADERS_06_001: [This API will perform exactly as HTTPHeaders_AddHeaderNameValuePair except that if the header name already exists the already existing value will be replaced as opposed to concatenated to.] */
+        TEST_FUNCTION(HTTPHeaders_ReplaceHeaderNameValuePair_for_none_existing_header_succeeds)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            umock_c_reset_all_calls();
+
+            ///act
+            res = HTTPHeaders_ReplaceHeaderNameValuePair(httpHandle, NAME1, VALUE1);
+
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
+            ASSERT_ARE_EQUAL(char_ptr, VALUE1, HTTPHeaders_FindHeaderValue(httpHandle, NAME1));
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
@@ -876,14 +977,13 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_GetHeaderCount_with_NULL_handle_fails)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res1;
             size_t nHeaders;
 
             ///act
-            res1 = HTTPHeaders_GetHeaderCount(NULL, &nHeaders);
+            HTTP_HEADERS_RESULT res = HTTPHeaders_GetHeaderCount(NULL, &nHeaders);
 
             ///assert
-            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res1);
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
         }
 
@@ -891,15 +991,15 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_GetHeaderCount_with_NULL_headersCount_fails)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res1;
+            HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
             ///act
-            res1 = HTTPHeaders_GetHeaderCount(httpHandle, NULL);
+            res = HTTPHeaders_GetHeaderCount(httpHandle, NULL);
 
             ///assert
-            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res1);
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
             ///cleanup
@@ -912,60 +1012,20 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_GetHeaderCount_with_1_header_produces_1)
         {
             ///arrange
-            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            HTTP_HEADERS_RESULT res;
             size_t nHeaders;
-            const char* keys[] = { "NAME1" }; 
-            const char* values[] = { "VALUE1" }; 
-            const char* const ** pKeys = (const char* const **)&keys; 
-            const char* const ** pValues = (const char* const **)&values;
-            const size_t one = 1;
-			HTTP_HEADERS_RESULT res;
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
-            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
-            umock_c_reset_all_calls();
-
-            STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                .IgnoreArgument(1)
-                .CopyOutArgumentBuffer(2, &pKeys, sizeof(pKeys))
-                .CopyOutArgumentBuffer(3, &pValues, sizeof(pValues))
-                .CopyOutArgumentBuffer(4, &one, sizeof(one));
-
-
-            ///act
-            res = HTTPHeaders_GetHeaderCount(httpHandle, &nHeaders);
-            
-            ///assert
-            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
-            ASSERT_ARE_EQUAL(size_t, (size_t)1, nHeaders);
-            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-
-            ///cleanup
-            HTTPHeaders_Free(httpHandle);
-        }
-
-        /*Tests_SRS_HTTP_HEADERS_99_037:[ The function shall return HTTP_HEADERS_ERROR when an internal error occurs.]*/
-        TEST_FUNCTION(HTTPHeaders_GetHeaderCount_fails_when_Map_GetInternals_fails)
-        {
-            ///arrange
-			HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            size_t nHeaders;
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                .IgnoreAllArguments()
-                .SetReturn(MAP_ERROR);
-
             ///act
             res = HTTPHeaders_GetHeaderCount(httpHandle, &nHeaders);
 
             ///assert
-            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_ERROR, res);
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
+            ASSERT_ARE_EQUAL(size_t, 1, nHeaders);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
-
             ///cleanup
             HTTPHeaders_Free(httpHandle);
         }
@@ -975,39 +1035,20 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_GetHeaderCount_with_2_header_produces_2)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
-            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            HTTP_HEADERS_RESULT res;
             size_t nHeaders;
-            const char* keys[2] = { "NAME1", "NAME2" };
-            const char* values[2] = { "VALUE1", "VALUE2" };
-            const char* const ** pKeys = (const char* const **)&keys;
-            const char* const ** pValues = (const char* const **)&values;
-
-            const size_t two = 2;
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME2))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME2, VALUE2);
             umock_c_reset_all_calls();
 
-
-            STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                .IgnoreArgument(1)
-                .CopyOutArgumentBuffer(2, &pKeys, sizeof(pKeys))
-                .CopyOutArgumentBuffer(3, &pValues, sizeof(pValues))
-                .CopyOutArgumentBuffer(4, &two, sizeof(two));
-
             ///act
             res = HTTPHeaders_GetHeaderCount(httpHandle, &nHeaders);
 
             ///assert
             ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
             ASSERT_ARE_EQUAL(size_t, 2, nHeaders);
-            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls()); 
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
@@ -1031,11 +1072,8 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_GetHeader_with_NULL_buffer_fails)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
             umock_c_reset_all_calls();
 
@@ -1051,28 +1089,20 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         }
 
         /*Tests_SRS_HTTP_HEADERS_99_029:[ The function shall return HTTP_HEADERS_INVALID_ARG if index is not valid (for example, out of range) for the currently stored headers.]*/
-        /*Tests that not adding something to the collection fails tso retrieve for index 0*/
+        /*trying to access a header that does not exist*/
         TEST_FUNCTION(HTTPHeaders_GetHeader_with_index_too_big_fails_1)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res1;
-            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            HTTP_HEADERS_RESULT res;
             char* headerValue;
-            const char* thisIsNULL = NULL;
-            const char* zero = 0;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                .IgnoreArgument(1)
-                .CopyOutArgumentBuffer(2, &thisIsNULL, sizeof(thisIsNULL))
-                .CopyOutArgumentBuffer(3, &thisIsNULL, sizeof(thisIsNULL))
-                .CopyOutArgumentBuffer(4, &zero, sizeof(zero));
-
             ///act
-            res1 = HTTPHeaders_GetHeader(httpHandle, 0, &headerValue);
+            res = HTTPHeaders_GetHeader(httpHandle, 0, &headerValue);
 
             ///assert
-            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res1);
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
             ///cleanup
@@ -1080,35 +1110,21 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         }
 
         /*Tests_SRS_HTTP_HEADERS_99_029:[ The function shall return HTTP_HEADERS_INVALID_ARG if index is not valid (for example, out of range) for the currently stored headers.]*/
-        /*Tests that not adding something to the collection fails tso retrieve for index 0*/
+        /*trying to access a header that does not exist*/
         TEST_FUNCTION(HTTPHeaders_GetHeader_with_index_too_big_fails_2)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res1;
-            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            const char* keys[1] = { "NAME1" };
-            const char* values[1] = { "VALUE1" };
-            const char* const ** pKeys = (const char* const **)&keys;
-            const char* const ** pValues = (const char* const **)&values;
-            const size_t one = 1;
+            HTTP_HEADERS_RESULT res;
             char* headerValue;
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                .IgnoreArgument(1)
-                .CopyOutArgumentBuffer(2, pKeys, sizeof(pKeys))
-                .CopyOutArgumentBuffer(3, pValues, sizeof(pValues))
-                .CopyOutArgumentBuffer(4, &one, sizeof(one));
-
             ///act
-            res1 = HTTPHeaders_GetHeader(httpHandle, 1, &headerValue);
+            res = HTTPHeaders_GetHeader(httpHandle, 1, &headerValue);
 
             ///assert
-            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res1);
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
             ///cleanup
@@ -1120,123 +1136,194 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_GetHeader_succeeds_1)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res1;
+            HTTP_HEADERS_RESULT res1;
+            HTTP_HEADERS_RESULT res2;
+            char* headerValue1;
+            char* headerValue2;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            char* headerValue;
-            const char* keys[1] = { "a" };
-            const char** pKeys = &keys[0];
-            const char* values[1] = { "b" };
-            const char** pValues = &values[0];
-            const size_t one = 1;
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, "a"))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
-            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, "a", "b");
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME2, VALUE2);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                .IgnoreArgument(1)
-                .CopyOutArgumentBuffer(2, &pKeys, sizeof(pKeys))
-                .CopyOutArgumentBuffer(3, &pValues, sizeof(pValues))
-                .CopyOutArgumentBuffer(4, &one, sizeof(one));
-
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+                .IgnoreArgument(1);
             STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
                 .IgnoreArgument(1);
 
             ///act
-            res1 = HTTPHeaders_GetHeader(httpHandle, 0, &headerValue);
+            res1 = HTTPHeaders_GetHeader(httpHandle, 0, &headerValue1);
+            res2 = HTTPHeaders_GetHeader(httpHandle, 1, &headerValue2);
 
             ///assert
             ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res1);
-            ASSERT_ARE_EQUAL(char_ptr, "a: b", headerValue);
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res2);
+            ASSERT_ARE_EQUAL(char_ptr, HEADER1, headerValue1);
+            ASSERT_ARE_EQUAL(char_ptr, HEADER2, headerValue2);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
-            free(headerValue);
+            free(headerValue1);
+            free(headerValue2);
         }
 
         /*Tests_SRS_HTTP_HEADERS_99_034:[ The function shall return HTTP_HEADERS_ERROR when an internal error occurs]*/
-        TEST_FUNCTION(HTTPHeaders_GetHeader_fails_when_Map_GetInternals_fails)
+        TEST_FUNCTION(HTTPHeaders_GetHeader_succeeds_fails_when_malloc_fails)
         {
             ///arrange
-            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            HTTP_HEADERS_RESULT res;
             char* headerValue;
-            const char* keys[1] = { "a" };
-            const char** pKeys = &keys[0];
-            const char* values[1] = { "b" };
-            const char** pValues = &values[0];
-            const size_t one = 1;
-			HTTP_HEADERS_RESULT res1;
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, "a"))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
-            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, "a", "b");
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                .IgnoreArgument(1)
-                .CopyOutArgumentBuffer(2, &pKeys, sizeof(pKeys))
-                .CopyOutArgumentBuffer(3, &pValues, sizeof(pValues))
-                .CopyOutArgumentBuffer(4, &one, sizeof(one))
-                .SetReturn(MAP_ERROR);
+            whenShallmalloc_fail = currentmalloc_call + 1;
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+                .IgnoreArgument(1);
 
             ///act
-            res1 = HTTPHeaders_GetHeader(httpHandle, 0, &headerValue);
+            res = HTTPHeaders_GetHeader(httpHandle, 0, &headerValue);
 
             ///assert
-            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_ERROR, res1);
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_ERROR, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
         }
 
-        /*Tests_SRS_HTTP_HEADERS_99_034:[ The function shall return HTTP_HEADERS_ERROR when an internal error occurs]*/
-        TEST_FUNCTION(HTTPHeaders_GetHeader_succeeds_fails_when_malloc_fails)
+        /*Tests_SRS_HTTP_HEADERS_99_043: [ If handle or serializedSize is NULL, or destination is NULL while destinationSize is not 0, HTTPHeaders_Serialize shall return HTTP_HEADERS_INVALID_ARG. ]*/
+        TEST_FUNCTION(HTTPHeaders_Serialize_with_NULL_handle_fails)
         {
             ///arrange
+            size_t serializedSize;
+
+            ///act
+            HTTP_HEADERS_RESULT res = HTTPHeaders_Serialize(NULL, tempBuffer, TEMP_BUFFER_SIZE, &serializedSize);
+
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_99_043: [ If handle or serializedSize is NULL, or destination is NULL while destinationSize is not 0, HTTPHeaders_Serialize shall return HTTP_HEADERS_INVALID_ARG. ]*/
+        TEST_FUNCTION(HTTPHeaders_Serialize_with_NULL_serializedSize_fails)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            char* headerValue;
-            const char* keys[1] = { "a" };
-            const char** pKeys = &keys[0];
-            const char* values[1] = { "b" };
-            const char** pValues = &values[0];
-            const size_t one = 1;
-			HTTP_HEADERS_RESULT res1;
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, "a"))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
-            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, "a", "b");
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                .IgnoreArgument(1)
-                .CopyOutArgumentBuffer(2, &pKeys, sizeof(pKeys))
-                .CopyOutArgumentBuffer(3, &pValues, sizeof(pValues))
-                .CopyOutArgumentBuffer(4, &one, sizeof(one));
+            ///act
+            res = HTTPHeaders_Serialize(httpHandle, tempBuffer, TEMP_BUFFER_SIZE, NULL);
 
-            whenShallmalloc_fail = currentmalloc_call + 1;
-            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-                .IgnoreArgument(1);
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_99_043: [ If handle or serializedSize is NULL, or destination is NULL while destinationSize is not 0, HTTPHeaders_Serialize shall return HTTP_HEADERS_INVALID_ARG. ]*/
+        TEST_FUNCTION(HTTPHeaders_Serialize_with_NULL_destination_and_size_fails)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
+            size_t serializedSize;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            umock_c_reset_all_calls();
 
             ///act
-            res1 = HTTPHeaders_GetHeader(httpHandle, 0, &headerValue);
+            res = HTTPHeaders_Serialize(httpHandle, NULL, TEMP_BUFFER_SIZE, &serializedSize);
 
             ///assert
-            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_ERROR, res1);
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_99_044: [ HTTPHeaders_Serialize shall write in *serializedSize the number of bytes that all the headers take as name+": "+value+"\r\n" lines. ]*/
+        /*Tests_SRS_HTTP_HEADERS_99_046: [ HTTPHeaders_Serialize shall write the lines into destination in the order the headers were added and return HTTP_HEADERS_OK. ]*/
+        TEST_FUNCTION(HTTPHeaders_Serialize_succeeds)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
+            size_t serializedSize;
+            const char* expected = HEADER2 "\r\n" HEADER1 "\r\n" NAME1 "x: " LONG_VALUE "\r\n";
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME2, VALUE2);
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1 "x", LONG_VALUE);
+            (void)memset(tempBuffer, '#', TEMP_BUFFER_SIZE);
+            umock_c_reset_all_calls();
+
+            ///act
+            res = HTTPHeaders_Serialize(httpHandle, tempBuffer, TEMP_BUFFER_SIZE, &serializedSize);
+
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
+            ASSERT_ARE_EQUAL(size_t, strlen(expected), serializedSize);
+            ASSERT_ARE_EQUAL(int, 0, memcmp(expected, tempBuffer, serializedSize));
+            ASSERT_ARE_EQUAL(int, '#', tempBuffer[serializedSize]);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_99_044: [ HTTPHeaders_Serialize shall write in *serializedSize the number of bytes that all the headers take as name+": "+value+"\r\n" lines. ]*/
+        TEST_FUNCTION(HTTPHeaders_Serialize_with_no_headers_succeeds)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
+            size_t serializedSize;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            umock_c_reset_all_calls();
+
+            ///act
+            res = HTTPHeaders_Serialize(httpHandle, NULL, 0, &serializedSize);
+
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
+            ASSERT_ARE_EQUAL(size_t, 0, serializedSize);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_99_045: [ If the lines do not fit in destinationSize, HTTPHeaders_Serialize shall write nothing and return HTTP_HEADERS_INSUFFICIENT_BUFFER. ]*/
+        TEST_FUNCTION(HTTPHeaders_Serialize_with_small_buffer_returns_INSUFFICIENT_BUFFER)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
+            size_t serializedSize;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
+            (void)memset(tempBuffer, '#', TEMP_BUFFER_SIZE);
+            umock_c_reset_all_calls();
+
+            ///act
+            res = HTTPHeaders_Serialize(httpHandle, tempBuffer, strlen(HEADER1 "\r\n") - 1, &serializedSize);
+
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INSUFFICIENT_BUFFER, res);
+            ASSERT_ARE_EQUAL(size_t, strlen(HEADER1 "\r\n"), serializedSize);
+            ASSERT_ARE_EQUAL(int, '#', tempBuffer[0]);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
-            free(headerValue);
         }
 
         /*Tests_SRS_HTTP_HEADERS_99_031:[ If name contains the character ":" then the return value shall be HTTP_HEADERS_INVALID_ARG.]*/
         TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_with_colon_in_name_fails)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
@@ -1255,26 +1342,12 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_with_colon_in_value_succeeds_1)
         {
             ///arrange
-            const char* keys[1] = { "a" };
-            const char** pKeys = &keys[0];
-            const char* values[1] = { ":" };
-            const char** pValues = &values[0];
-            const size_t one = 1;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             char* headerValue;
-			HTTP_HEADERS_RESULT res1;
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, "a"))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
+            HTTP_HEADERS_RESULT res1;
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, "a", ":");
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                .IgnoreArgument(1)
-                .CopyOutArgumentBuffer(2, &pKeys, sizeof(pKeys))
-                .CopyOutArgumentBuffer(3, &pValues, sizeof(pValues))
-                .CopyOutArgumentBuffer(4, &one, sizeof(one));
-
             STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
                 .IgnoreArgument(1);
 
@@ -1298,15 +1371,15 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
             ///arrange
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             char unacceptableString[2]={'\0', '\0'};
-			int c;
-            
+            int c;
+
             for(c=SCHAR_MIN;c <=SCHAR_MAX; c++)
             {
                 if(c=='\0') continue;
 
                 if((c<33) ||( 126<c)|| (c==':'))
                 {
-					HTTP_HEADERS_RESULT res;
+                    HTTP_HEADERS_RESULT res;
 
                     /*so it is an unacceptable character*/
                     unacceptableString[0]=(char)c;
@@ -1327,25 +1400,18 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_with_LWS_value_stores_without_LWS_characters_succeeds)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist*/
-
-            STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, NAME1, VALUE1))
-                .IgnoreArgument(1);
-
             ///act
             res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, " \r\t\n" VALUE1); /*notice how there are some LWS characters in the value*/
 
             ///assert
             ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
-            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
             //checking content
+            ASSERT_ARE_EQUAL(char_ptr, VALUE1, HTTPHeaders_FindHeaderValue(httpHandle, NAME1));
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
@@ -1368,14 +1434,12 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHEADERS_Clone_happy_path)
         {
             ///arrange
-			HTTP_HEADERS_HANDLE result;
+            HTTP_HEADERS_HANDLE result;
             HTTP_HEADERS_HANDLE source = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
             STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
                 .IgnoreArgument(1);
-            STRICT_EXPECTED_CALL(Map_Clone(IGNORED_PTR_ARG))
-                .IgnoreArgument(1);
 
             ///act
             result = HTTPHeaders_Clone(source);
@@ -1389,20 +1453,101 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
             HTTPHeaders_Free(result);
         }
 
+        /*Tests_SRS_HTTP_HEADERS_02_004: [Otherwise HTTPHeaders_Clone shall clone the content of handle to a new handle.*/
+        TEST_FUNCTION(HTTPHEADERS_Clone_with_headers_copies_them)
+        {
+            ///arrange
+            HTTP_HEADERS_HANDLE result;
+            char* headerValue;
+            size_t nHeaders;
+            HTTP_HEADERS_HANDLE source = HTTPHeaders_Alloc();
+            (void)HTTPHeaders_AddHeaderNameValuePair(source, NAME1, VALUE1);
+            (void)HTTPHeaders_AddHeaderNameValuePair(source, NAME2, LONG_VALUE);
+            umock_c_reset_all_calls();
+
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*the handle*/
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*the headers*/
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*the buckets*/
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*the long header*/
+                .IgnoreArgument(1);
+
+            ///act
+            result = HTTPHeaders_Clone(source);
+
+            ///assert
+            ASSERT_IS_NOT_NULL(result);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            HTTPHeaders_Free(source);
+            (void)HTTPHeaders_GetHeaderCount(result, &nHeaders);
+            ASSERT_ARE_EQUAL(size_t, 2, nHeaders);
+            ASSERT_ARE_EQUAL(char_ptr, VALUE1, HTTPHeaders_FindHeaderValue(result, NAME1));
+            (void)HTTPHeaders_GetHeader(result, 1, &headerValue);
+            ASSERT_ARE_EQUAL(char_ptr, NAME2 ": " LONG_VALUE, headerValue);
+
+            ///cleanup
+            HTTPHeaders_Free(result);
+            free(headerValue);
+        }
+
         /*Tests_SRS_HTTP_HEADERS_02_005: [If cloning fails for any reason, then HTTPHeaders_Clone shall return NULL.] */
-        TEST_FUNCTION(HTTPHEADERS_Clone_fails_when_map_clone_fails)
+        TEST_FUNCTION(HTTPHEADERS_Clone_fails_when_malloc_of_long_header_fails)
         {
             ///arrange
-			HTTP_HEADERS_HANDLE result;
+            HTTP_HEADERS_HANDLE result;
             HTTP_HEADERS_HANDLE source = HTTPHeaders_Alloc();
+            (void)HTTPHeaders_AddHeaderNameValuePair(source, NAME1, LONG_VALUE);
+            (void)HTTPHeaders_AddHeaderNameValuePair(source, NAME2, LONG_VALUE);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+            whenShallmalloc_fail = currentmalloc_call + 5;
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*the handle*/
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*the headers*/
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*the buckets*/
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*the first long header*/
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*the second long header*/
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*the first long header*/
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*the headers*/
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*the buckets*/
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*the handle*/
                 .IgnoreArgument(1);
-            STRICT_EXPECTED_CALL(Map_Clone(IGNORED_PTR_ARG))
-                .IgnoreArgument(1).SetReturn(NULL);
 
-            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            ///act
+            result = HTTPHeaders_Clone(source);
+
+            ///assert
+            ASSERT_IS_NULL(result);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+            ///cleanup
+            HTTPHeaders_Free(source);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_02_005: [If cloning fails for any reason, then HTTPHeaders_Clone shall return NULL.] */
+        TEST_FUNCTION(HTTPHEADERS_Clone_fails_when_malloc_of_headers_fails)
+        {
+            ///arrange
+            HTTP_HEADERS_HANDLE result;
+            HTTP_HEADERS_HANDLE source = HTTPHeaders_Alloc();
+            (void)HTTPHeaders_AddHeaderNameValuePair(source, NAME1, VALUE1);
+            umock_c_reset_all_calls();
+
+            whenShallmalloc_fail = currentmalloc_call + 2;
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*the handle*/
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*the headers*/
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*the handle*/
                 .IgnoreArgument(1);
 
             ///act
@@ -1414,19 +1559,19 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
 
             ///cleanup
             HTTPHeaders_Free(source);
-            HTTPHeaders_Free(result);
         }
 
         /*Tests_SRS_HTTP_HEADERS_02_005: [If cloning fails for any reason, then HTTPHeaders_Clone shall return NULL.] */
         TEST_FUNCTION(HTTPHEADERS_Clone_fails_when_gballoc_fails)
         {
             ///arrange
-			HTTP_HEADERS_HANDLE result;
+            HTTP_HEADERS_HANDLE result;
             HTTP_HEADERS_HANDLE source = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
+            whenShallmalloc_fail = currentmalloc_call + 1;
             STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-                .IgnoreArgument(1).SetReturn(NULL);
+                .IgnoreArgument(1);
 
             ///act
             result = HTTPHeaders_Clone(source);
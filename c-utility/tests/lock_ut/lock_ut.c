@@ -11,11 +11,85 @@
 #include "testrunnerswitcher.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/threadapi.h"
 
 TEST_DEFINE_ENUM_TYPE(LOCK_RESULT, LOCK_RESULT_VALUES);
 
 static TEST_MUTEX_HANDLE g_dllByDll;
 
+#define CONTENDING_THREAD_COUNT 4
+#define INCREMENTS_PER_THREAD 20000
+
+typedef struct CONTENDED_COUNTER_TAG
+{
+    LOCK_HANDLE lock;
+    volatile size_t value;
+} CONTENDED_COUNTER;
+
+/* a writer moves both halves together, a reader that sees them differ saw a partial write */
+typedef struct SHARED_PAIR_TAG
+{
+    RWLOCK_HANDLE rwlock;
+    volatile size_t first;
+    volatile size_t second;
+    volatile int torn_read_seen;
+} SHARED_PAIR;
+
+static int increment_under_lock(void* arg)
+{
+    CONTENDED_COUNTER* counter = (CONTENDED_COUNTER*)arg;
+    size_t i;
+    for (i = 0; i < INCREMENTS_PER_THREAD; i++)
+    {
+        (void)Lock(counter->lock);
+        counter->value = counter->value + 1;
+        (void)Unlock(counter->lock);
+    }
+    return 0;
+}
+
+static int read_and_write_under_rwlock(void* arg)
+{
+    SHARED_PAIR* pair = (SHARED_PAIR*)arg;
+    size_t i;
+    for (i = 0; i < INCREMENTS_PER_THREAD; i++)
+    {
+        if ((i % 2) == 0)
+        {
+            (void)RWLock_WriteLock(pair->rwlock);
+            pair->first = pair->first + 1;
+            pair->second = pair->second + 1;
+            (void)RWLock_WriteUnlock(pair->rwlock);
+        }
+        else
+        {
+            (void)RWLock_ReadLock(pair->rwlock);
+            if (pair->first != pair->second)
+            {
+                pair->torn_read_seen = 1;
+            }
+            (void)RWLock_ReadUnlock(pair->rwlock);
+        }
+    }
+    return 0;
+}
+
+static void run_contending_threads(THREAD_START_FUNC func, void* arg)
+{
+    THREAD_HANDLE threads[CONTENDING_THREAD_COUNT];
+    size_t i;
+    for (i = 0; i < CONTENDING_THREAD_COUNT; i++)
+    {
+        ASSERT_ARE_EQUAL(int, (int)THREADAPI_OK, (int)ThreadAPI_Create(&threads[i], func, arg));
+    }
+    for (i = 0; i < CONTENDING_THREAD_COUNT; i++)
+    {
+        int thread_result;
+        ASSERT_ARE_EQUAL(int, (int)THREADAPI_OK, (int)ThreadAPI_Join(threads[i], &thread_result));
+        ASSERT_ARE_EQUAL(int, 0, thread_result);
+    }
+}
+
 BEGIN_TEST_SUITE(LOCK_UnitTests)
 
 TEST_SUITE_INITIALIZE(a)
@@ -124,6 +198,166 @@ TEST_FUNCTION(LOCK_DeInit_NULL_fails)
     ASSERT_ARE_EQUAL(LOCK_RESULT, LOCK_ERROR, result);
 }
 
+/* Tests_SRS_LOCK_99_001: [Lock_TryLock shall return LOCK_OK when it acquired the lock and LOCK_BUSY when the lock is held, without blocking] */
+TEST_FUNCTION(LOCK_TryLock_on_a_free_lock_succeeds)
+{
+    //arrange
+    LOCK_RESULT result;
+    LOCK_HANDLE handle = Lock_Init();
+
+    //act
+    result = Lock_TryLock(handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(LOCK_RESULT, LOCK_OK, result);
+
+    //cleanup
+    (void)Unlock(handle);
+    (void)Lock_Deinit(handle);
+}
+
+/* Tests_SRS_LOCK_99_001: [Lock_TryLock shall return LOCK_OK when it acquired the lock and LOCK_BUSY when the lock is held, without blocking] */
+TEST_FUNCTION(LOCK_TryLock_on_a_held_lock_returns_LOCK_BUSY)
+{
+    //arrange
+    LOCK_RESULT result;
+    LOCK_HANDLE handle = Lock_Init();
+    (void)Lock(handle);
+
+    //act
+    result = Lock_TryLock(handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(LOCK_RESULT, LOCK_BUSY, result);
+
+    //cleanup
+    (void)Unlock(handle);
+    (void)Lock_Deinit(handle);
+}
+
+/* Tests_SRS_LOCK_99_002: [Lock_TryLock on NULL handle passed returns LOCK_ERROR] */
+TEST_FUNCTION(LOCK_TryLock_NULL_fails)
+{
+    //arrange
+
+    //act
+    LOCK_RESULT result = Lock_TryLock(NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(LOCK_RESULT, LOCK_ERROR, result);
+}
+
+/* Tests_SRS_LOCK_10_005: [Lock on success shall return LOCK_OK] */
+TEST_FUNCTION(LOCK_Lock_keeps_a_counter_consistent_across_threads)
+{
+    //arrange
+    CONTENDED_COUNTER counter;
+    counter.lock = Lock_Init();
+    counter.value = 0;
+    ASSERT_IS_NOT_NULL(counter.lock);
+
+    //act
+    run_contending_threads(increment_under_lock, &counter);
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, (size_t)(CONTENDING_THREAD_COUNT * INCREMENTS_PER_THREAD), counter.value);
+
+    //cleanup
+    (void)Lock_Deinit(counter.lock);
+}
+
+/* Tests_SRS_LOCK_99_003: [RWLock_Init on success shall return a valid handle, NULL otherwise] */
+TEST_FUNCTION(LOCK_RWLock_Init_Deinit_succeeds)
+{
+    //arrange
+    LOCK_RESULT result;
+    RWLOCK_HANDLE handle = RWLock_Init();
+    ASSERT_IS_NOT_NULL(handle);
+
+    //act
+    result = RWLock_Deinit(handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(LOCK_RESULT, LOCK_OK, result);
+}
+
+/* Tests_SRS_LOCK_99_004: [RWLock_ReadLock shall let any number of readers hold the lock while no writer holds it] */
+TEST_FUNCTION(LOCK_RWLock_ReadLock_ReadUnlock_succeeds)
+{
+    //arrange
+    LOCK_RESULT lock_result;
+    LOCK_RESULT unlock_result;
+    RWLOCK_HANDLE handle = RWLock_Init();
+
+    //act
+    lock_result = RWLock_ReadLock(handle);
+    unlock_result = RWLock_ReadUnlock(handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(LOCK_RESULT, LOCK_OK, lock_result);
+    ASSERT_ARE_EQUAL(LOCK_RESULT, LOCK_OK, unlock_result);
+
+    //cleanup
+    (void)RWLock_Deinit(handle);
+}
+
+/* Tests_SRS_LOCK_99_006: [RWLock_WriteLock shall give the lock to one writer while no reader holds it] */
+TEST_FUNCTION(LOCK_RWLock_WriteLock_WriteUnlock_succeeds)
+{
+    //arrange
+    LOCK_RESULT lock_result;
+    LOCK_RESULT unlock_result;
+    RWLOCK_HANDLE handle = RWLock_Init();
+
+    //act
+    lock_result = RWLock_WriteLock(handle);
+    unlock_result = RWLock_WriteUnlock(handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(LOCK_RESULT, LOCK_OK, lock_result);
+    ASSERT_ARE_EQUAL(LOCK_RESULT, LOCK_OK, unlock_result);
+
+    //cleanup
+    (void)RWLock_Deinit(handle);
+}
+
+/* Tests_SRS_LOCK_99_005: [The RWLock functions return LOCK_ERROR on a NULL handle] */
+TEST_FUNCTION(LOCK_RWLock_NULL_fails)
+{
+    //arrange
+
+    //act
+    //assert
+    ASSERT_ARE_EQUAL(LOCK_RESULT, LOCK_ERROR, RWLock_ReadLock(NULL));
+    ASSERT_ARE_EQUAL(LOCK_RESULT, LOCK_ERROR, RWLock_ReadUnlock(NULL));
+    ASSERT_ARE_EQUAL(LOCK_RESULT, LOCK_ERROR, RWLock_WriteLock(NULL));
+    ASSERT_ARE_EQUAL(LOCK_RESULT, LOCK_ERROR, RWLock_WriteUnlock(NULL));
+    ASSERT_ARE_EQUAL(LOCK_RESULT, LOCK_ERROR, RWLock_Deinit(NULL));
+}
+
+/* Tests_SRS_LOCK_99_004: [RWLock_ReadLock shall let any number of readers hold the lock while no writer holds it] */
+/* Tests_SRS_LOCK_99_006: [RWLock_WriteLock shall give the lock to one writer while no reader holds it] */
+TEST_FUNCTION(LOCK_RWLock_readers_never_see_a_partial_write)
+{
+    //arrange
+    SHARED_PAIR pair;
+    pair.rwlock = RWLock_Init();
+    pair.first = 0;
+    pair.second = 0;
+    pair.torn_read_seen = 0;
+    ASSERT_IS_NOT_NULL(pair.rwlock);
+
+    //act
+    run_contending_threads(read_and_write_under_rwlock, &pair);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, pair.torn_read_seen);
+    ASSERT_ARE_EQUAL(size_t, (size_t)(CONTENDING_THREAD_COUNT * INCREMENTS_PER_THREAD / 2), pair.first);
+
+    //cleanup
+    (void)RWLock_Deinit(pair.rwlock);
+}
+
 /* Extra negative tests - only supported on Win32 since the behavior on other platforms is undefined. */
 #ifdef WIN32
 TEST_FUNCTION(LOCK_Init_Unlock_fails)
@@ -19,9 +19,11 @@ static void my_gballoc_free(void* ptr)
 
 #ifdef __cplusplus
 #include <cstdio>
+#include <cstring>
 #include <ctime>
 #else
 #include <stdio.h>
+#include <string.h>
 #include <time.h>
 #endif
 
@@ -80,6 +82,16 @@ STRING_HANDLE my_URL_Encode(STRING_HANDLE input)
     return (STRING_HANDLE)malloc(1);
 }
 
+/*0xFB bytes encode to "+/v7", which exercises every character the signature has to url encode*/
+HMACSHA256_RESULT my_HMACSHA256_ComputeHashWithKey(HMACSHA256_KEY_HANDLE key, const unsigned char* payload, size_t payloadLen, unsigned char* hash)
+{
+    (void)key;
+    (void)payload;
+    (void)payloadLen;
+    memset(hash, 0xFB, HMACSHA256_HASH_SIZE);
+    return HMACSHA256_OK;
+}
+
 #include "azure_c_shared_utility/sastoken.h"
 
 #define TEST_STRING_HANDLE (STRING_HANDLE)0x46
@@ -95,6 +107,7 @@ STRING_HANDLE my_URL_Encode(STRING_HANDLE input)
 #define TEST_BASE64SIGNATURE_HANDLE (STRING_HANDLE)0x54
 #define TEST_URLENCODEDSIGNATURE_HANDLE (STRING_HANDLE)0x55
 #define TEST_DECODEDKEY_HANDLE (BUFFER_HANDLE)0x56
+#define TEST_HMACSHA256_KEY_HANDLE (HMACSHA256_KEY_HANDLE)0x57
 #define TEST_TIME_T ((time_t)3600)
 #define TEST_PTR_DECODEDKEY (unsigned char*)0x123
 #define TEST_LENGTH_DECODEDKEY (size_t)32
@@ -109,6 +122,12 @@ static const char* TEST_NULL_STRING_VALUE = 0x00;
 static char TEST_CHAR_ARRAY[10] = "ABCD";
 static unsigned char TEST_UNSIGNED_CHAR_ARRAY[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09 };
 static char TEST_TOKEN_EXPIRATION_TIME[32] = "7200";
+static const char* TEST_GENERATOR_SCOPE = "myhub.azure-devices.net/devices/dev1";
+static const char* TEST_GENERATOR_SCOPE_TO_SIGN = "myhub.azure-devices.net/devices/dev1\n";
+static const char* TEST_GENERATOR_KEYNAME = "iothubowner";
+static const char* TEST_GENERATOR_TOKEN = "SharedAccessSignature sr=myhub.azure-devices.net/devices/dev1"
+    "&sig=%2b%2fv7%2b%2fv7%2b%2fv7%2b%2fv7%2b%2fv7%2b%2fv7%2b%2fv7%2b%2fv7%2b%2fv7%2b%2fv7%2b%2fs%3d"
+    "&se=7200&skn=iothubowner";
 
 static TEST_MUTEX_HANDLE g_testByTest;
 static TEST_MUTEX_HANDLE g_dllByDll;
@@ -147,6 +166,7 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_UMOCK_ALIAS_TYPE(size_t, unsigned int);
     REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(HMACSHA256_KEY_HANDLE, void*);
 
     result = umocktypes_charptr_register_types();
     ASSERT_ARE_EQUAL(int, 0, result);
@@ -171,6 +191,8 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_GLOBAL_MOCK_HOOK(Base64_Decoder, my_Base64_Decoder);
     REGISTER_GLOBAL_MOCK_HOOK(URL_Encode, my_URL_Encode);
     REGISTER_GLOBAL_MOCK_RETURN(HMACSHA256_ComputeHash, HMACSHA256_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(HMACSHA256_CreateKeyWithPrefix, TEST_HMACSHA256_KEY_HANDLE);
+    REGISTER_GLOBAL_MOCK_HOOK(HMACSHA256_ComputeHashWithKey, my_HMACSHA256_ComputeHashWithKey);
     REGISTER_GLOBAL_MOCK_RETURN(size_tToString, 0);
 
     REGISTER_GLOBAL_MOCK_RETURN(get_time, TEST_TIME_T);
@@ -1800,4 +1822,220 @@ TEST_FUNCTION(SASToken_CreateString_succeeds)
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 }
 
+/*Tests_SRS_SASTOKEN_99_001: [ If key or scope is NULL then SASToken_CreateGenerator shall fail and return NULL. ]*/
+TEST_FUNCTION(SASToken_CreateGenerator_with_NULL_key_fails)
+{
+    // arrange
+    SAS_TOKEN_GENERATOR_HANDLE generator;
+
+    // act
+    generator = SASToken_CreateGenerator(NULL, TEST_GENERATOR_SCOPE, TEST_GENERATOR_KEYNAME);
+
+    // assert
+    ASSERT_IS_NULL(generator);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_SASTOKEN_99_001: [ If key or scope is NULL then SASToken_CreateGenerator shall fail and return NULL. ]*/
+TEST_FUNCTION(SASToken_CreateGenerator_with_NULL_scope_fails)
+{
+    // arrange
+    SAS_TOKEN_GENERATOR_HANDLE generator;
+
+    // act
+    generator = SASToken_CreateGenerator(TEST_CHAR_ARRAY, NULL, TEST_GENERATOR_KEYNAME);
+
+    // assert
+    ASSERT_IS_NULL(generator);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_SASTOKEN_99_003: [ SASToken_CreateGenerator shall allocate the generator and the fixed parts of the token in one block. ]*/
+/*Tests_SRS_SASTOKEN_99_005: [ SASToken_CreateGenerator shall allocate the string scope followed by "\n", the prefix of the string to sign. ]*/
+/*Tests_SRS_SASTOKEN_99_006: [ The key parameter is decoded from base64. ]*/
+/*Tests_SRS_SASTOKEN_99_007: [ SASToken_CreateGenerator shall create an HMAC-SHA256 key from the decoded key with the string to sign prefix by calling HMACSHA256_CreateKeyWithPrefix. ]*/
+TEST_FUNCTION(SASToken_CreateGenerator_succeeds)
+{
+    // arrange
+    SAS_TOKEN_GENERATOR_HANDLE generator;
+    size_t scopeToSignLength = strlen(TEST_GENERATOR_SCOPE_TO_SIGN);
+
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(scopeToSignLength));
+    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_DECODEDKEY_HANDLE);
+    STRICT_EXPECTED_CALL(BUFFER_length(TEST_DECODEDKEY_HANDLE)).SetReturn(TEST_LENGTH_DECODEDKEY);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_DECODEDKEY_HANDLE)).SetReturn(TEST_PTR_DECODEDKEY);
+    STRICT_EXPECTED_CALL(HMACSHA256_CreateKeyWithPrefix(TEST_PTR_DECODEDKEY, TEST_LENGTH_DECODEDKEY, IGNORED_PTR_ARG, scopeToSignLength))
+        .ValidateArgumentBuffer(3, TEST_GENERATOR_SCOPE_TO_SIGN, scopeToSignLength);
+    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    generator = SASToken_CreateGenerator(TEST_CHAR_ARRAY, TEST_GENERATOR_SCOPE, TEST_GENERATOR_KEYNAME);
+
+    // assert
+    ASSERT_IS_NOT_NULL(generator);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    SASToken_DestroyGenerator(generator);
+}
+
+/*Tests_SRS_SASTOKEN_99_004: [ If any of the operations of SASToken_CreateGenerator fails then it shall fail and return NULL. ]*/
+TEST_FUNCTION(SASToken_CreateGenerator_fails_when_decoding_the_key_fails)
+{
+    // arrange
+    SAS_TOKEN_GENERATOR_HANDLE generator;
+
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_NULL_BUFFER_HANDLE);
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    generator = SASToken_CreateGenerator(TEST_CHAR_ARRAY, TEST_GENERATOR_SCOPE, TEST_GENERATOR_KEYNAME);
+
+    // assert
+    ASSERT_IS_NULL(generator);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_SASTOKEN_99_004: [ If any of the operations of SASToken_CreateGenerator fails then it shall fail and return NULL. ]*/
+TEST_FUNCTION(SASToken_CreateGenerator_fails_when_creating_the_HMAC_key_fails)
+{
+    // arrange
+    SAS_TOKEN_GENERATOR_HANDLE generator;
+
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_DECODEDKEY_HANDLE);
+    STRICT_EXPECTED_CALL(BUFFER_length(TEST_DECODEDKEY_HANDLE));
+    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_DECODEDKEY_HANDLE));
+    EXPECTED_CALL(HMACSHA256_CreateKeyWithPrefix(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG)).SetReturn(NULL);
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    generator = SASToken_CreateGenerator(TEST_CHAR_ARRAY, TEST_GENERATOR_SCOPE, TEST_GENERATOR_KEYNAME);
+
+    // assert
+    ASSERT_IS_NULL(generator);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_SASTOKEN_99_010: [ SASToken_Generate shall convert expiry to its decimal string form by calling size_tToString. ]*/
+/*Tests_SRS_SASTOKEN_99_012: [ SASToken_Generate shall sign the expiry string with the key of the generator by calling HMACSHA256_ComputeHashWithKey. ]*/
+/*Tests_SRS_SASTOKEN_99_013: [ The hash shall be base64 encoded and then url encoded. ]*/
+/*Tests_SRS_SASTOKEN_99_014: [ If tokenLength is not NULL, SASToken_Generate shall set it to the length of the token, not counting the null terminator. ]*/
+/*Tests_SRS_SASTOKEN_99_016: [ SASToken_Generate shall write the head of the token, the signature, "&se=", the expiry and the tail of the token to destination, followed by a null terminator. ]*/
+/*Tests_SRS_SASTOKEN_99_017: [ On success SASToken_Generate shall return 0. ]*/
+TEST_FUNCTION(SASToken_Generate_writes_the_token_to_destination)
+{
+    // arrange
+    SAS_TOKEN_GENERATOR_HANDLE generator = SASToken_CreateGenerator(TEST_CHAR_ARRAY, TEST_GENERATOR_SCOPE, TEST_GENERATOR_KEYNAME);
+    char destination[256];
+    size_t tokenLength;
+    int result;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).CopyOutArgumentBuffer(1, TEST_TOKEN_EXPIRATION_TIME, sizeof(TEST_TOKEN_EXPIRATION_TIME));
+    STRICT_EXPECTED_CALL(HMACSHA256_ComputeHashWithKey(TEST_HMACSHA256_KEY_HANDLE, IGNORED_PTR_ARG, 4, IGNORED_PTR_ARG))
+        .ValidateArgumentBuffer(2, TEST_TOKEN_EXPIRATION_TIME, 4);
+
+    // act
+    result = SASToken_Generate(generator, TEST_EXPIRY, destination, sizeof(destination), &tokenLength);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_GENERATOR_TOKEN, destination);
+    ASSERT_ARE_EQUAL(size_t, strlen(TEST_GENERATOR_TOKEN), tokenLength);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    SASToken_DestroyGenerator(generator);
+}
+
+/*Tests_SRS_SASTOKEN_99_014: [ If tokenLength is not NULL, SASToken_Generate shall set it to the length of the token, not counting the null terminator. ]*/
+/*Tests_SRS_SASTOKEN_99_015: [ If destinationSize cannot hold the token and its null terminator then SASToken_Generate shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(SASToken_Generate_with_a_too_small_destination_fails_and_reports_the_token_length)
+{
+    // arrange
+    SAS_TOKEN_GENERATOR_HANDLE generator = SASToken_CreateGenerator(TEST_CHAR_ARRAY, TEST_GENERATOR_SCOPE, TEST_GENERATOR_KEYNAME);
+    char destination[256];
+    size_t tokenLength;
+    int result;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).CopyOutArgumentBuffer(1, TEST_TOKEN_EXPIRATION_TIME, sizeof(TEST_TOKEN_EXPIRATION_TIME));
+    EXPECTED_CALL(HMACSHA256_ComputeHashWithKey(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG));
+
+    // act
+    result = SASToken_Generate(generator, TEST_EXPIRY, destination, strlen(TEST_GENERATOR_TOKEN), &tokenLength);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, strlen(TEST_GENERATOR_TOKEN), tokenLength);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    SASToken_DestroyGenerator(generator);
+}
+
+/*Tests_SRS_SASTOKEN_99_011: [ If any of the operations of SASToken_Generate fails then it shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(SASToken_Generate_fails_when_signing_fails)
+{
+    // arrange
+    SAS_TOKEN_GENERATOR_HANDLE generator = SASToken_CreateGenerator(TEST_CHAR_ARRAY, TEST_GENERATOR_SCOPE, NULL);
+    char destination[256];
+    int result;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).CopyOutArgumentBuffer(1, TEST_TOKEN_EXPIRATION_TIME, sizeof(TEST_TOKEN_EXPIRATION_TIME));
+    EXPECTED_CALL(HMACSHA256_ComputeHashWithKey(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG)).SetReturn(HMACSHA256_ERROR);
+
+    // act
+    result = SASToken_Generate(generator, TEST_EXPIRY, destination, sizeof(destination), NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    SASToken_DestroyGenerator(generator);
+}
+
+/*Tests_SRS_SASTOKEN_99_009: [ If generator or destination is NULL then SASToken_Generate shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(SASToken_Generate_with_NULL_generator_fails)
+{
+    // arrange
+    char destination[256];
+    int result;
+
+    // act
+    result = SASToken_Generate(NULL, TEST_EXPIRY, destination, sizeof(destination), NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_SASTOKEN_99_019: [ SASToken_DestroyGenerator shall destroy the HMAC key and free the generator. ]*/
+TEST_FUNCTION(SASToken_DestroyGenerator_destroys_the_key_and_frees_the_generator)
+{
+    // arrange
+    SAS_TOKEN_GENERATOR_HANDLE generator = SASToken_CreateGenerator(TEST_CHAR_ARRAY, TEST_GENERATOR_SCOPE, TEST_GENERATOR_KEYNAME);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(HMACSHA256_DestroyKey(TEST_HMACSHA256_KEY_HANDLE));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    SASToken_DestroyGenerator(generator);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
 END_TEST_SUITE(sastoken_unittests)
@@ -0,0 +1,388 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#else
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#endif
+
+#include "testrunnerswitcher.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/sha.h"
+
+/*kept small so the suite stays fast as a gate, raise it locally to get stable numbers*/
+#ifndef SHA_UT_THROUGHPUT_MEGABYTES
+#define SHA_UT_THROUGHPUT_MEGABYTES 16
+#endif
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+static const SHA256Implementation allImplementations[] =
+{
+    sha256ImplPortable,
+    sha256ImplX86SHA,
+    sha256ImplARMv8SHA2,
+    sha256ImplX86AVX2
+};
+
+static const char* implementationNames[] =
+{
+    "auto",
+    "portable",
+    "x86 SHA",
+    "ARMv8 SHA2",
+    "x86 AVX2"
+};
+
+typedef struct KNOWN_ANSWER_TAG
+{
+    const char* message;
+    unsigned int repeat;
+    const char* sha256;
+} KNOWN_ANSWER;
+
+/*FIPS 180-2 appendix B and RFC 6234 section 8.5 test vectors*/
+static const KNOWN_ANSWER knownAnswers[] =
+{
+    { "", 1, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+    { "abc", 1, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+    { "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1, "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" },
+    { "a", 1000000, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" },
+    { "0123456701234567012345670123456701234567012345670123456701234567", 10, "594847328451bdfa85056225462cc1d867d877fb388df0ce35f25ab5562bfbb5" }
+};
+
+static void DigestToHex(const uint8_t* digest, size_t size, char* hex)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+    size_t i;
+    for (i = 0; i < size; i++)
+    {
+        hex[2 * i] = hexDigits[digest[i] >> 4];
+        hex[2 * i + 1] = hexDigits[digest[i] & 0x0F];
+    }
+    hex[2 * size] = '\0';
+}
+
+static void Sha256OfRepeatedMessage(const char* message, unsigned int repeat, uint8_t digest[SHA256HashSize])
+{
+    SHA256Context context;
+    unsigned int i;
+    ASSERT_ARE_EQUAL(int, shaSuccess, SHA256Reset(&context));
+    for (i = 0; i < repeat; i++)
+    {
+        ASSERT_ARE_EQUAL(int, shaSuccess, SHA256Input(&context, (const uint8_t*)message, (unsigned int)strlen(message)));
+    }
+    ASSERT_ARE_EQUAL(int, shaSuccess, SHA256Result(&context, digest));
+}
+
+static void Sha256InChunks(const uint8_t* message, unsigned int length, unsigned int chunk, uint8_t digest[SHA256HashSize])
+{
+    SHA256Context context;
+    unsigned int offset;
+    ASSERT_ARE_EQUAL(int, shaSuccess, SHA256Reset(&context));
+    for (offset = 0; offset < length; offset += chunk)
+    {
+        unsigned int size = (length - offset < chunk) ? length - offset : chunk;
+        ASSERT_ARE_EQUAL(int, shaSuccess, SHA256Input(&context, message + offset, size));
+    }
+    ASSERT_ARE_EQUAL(int, shaSuccess, SHA256Result(&context, digest));
+}
+
+static void FillPseudoRandom(uint8_t* buffer, size_t size, uint32_t seed)
+{
+    size_t i;
+    for (i = 0; i < size; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        buffer[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+BEGIN_TEST_SUITE(sha_ut)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    (void)SHA256SetImplementation(sha256ImplAuto);
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+TEST_FUNCTION(SHA256GetImplementation_never_returns_auto)
+{
+    ///arrange
+    ASSERT_ARE_EQUAL(int, shaSuccess, SHA256SetImplementation(sha256ImplAuto));
+
+    ///act
+    SHA256Implementation implementation = SHA256GetImplementation();
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, (int)sha256ImplAuto, (int)implementation);
+    LogInfo("SHA-256 implementation: %s", implementationNames[implementation]);
+}
+
+TEST_FUNCTION(SHA256SetImplementation_with_an_unknown_implementation_fails)
+{
+    ///arrange
+    SHA256Implementation before = SHA256GetImplementation();
+
+    ///act
+    int result = SHA256SetImplementation((SHA256Implementation)42);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, shaBadParam, result);
+    ASSERT_ARE_EQUAL(int, (int)before, (int)SHA256GetImplementation());
+}
+
+TEST_FUNCTION(SHA256SetImplementation_portable_always_succeeds)
+{
+    ///arrange
+
+    ///act
+    int result = SHA256SetImplementation(sha256ImplPortable);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, shaSuccess, result);
+    ASSERT_ARE_EQUAL(int, (int)sha256ImplPortable, (int)SHA256GetImplementation());
+}
+
+TEST_FUNCTION(SHA256_known_answers_with_every_supported_implementation)
+{
+    size_t i;
+    for (i = 0; i < sizeof(allImplementations) / sizeof(allImplementations[0]); i++)
+    {
+        size_t j;
+        if (SHA256SetImplementation(allImplementations[i]) != shaSuccess)
+        {
+            continue;
+        }
+
+        for (j = 0; j < sizeof(knownAnswers) / sizeof(knownAnswers[0]); j++)
+        {
+            ///arrange
+            uint8_t digest[SHA256HashSize];
+            char hex[2 * SHA256HashSize + 1];
+
+            ///act
+            Sha256OfRepeatedMessage(knownAnswers[j].message, knownAnswers[j].repeat, digest);
+
+            ///assert
+            DigestToHex(digest, sizeof(digest), hex);
+            ASSERT_ARE_EQUAL(char_ptr, knownAnswers[j].sha256, hex);
+        }
+    }
+}
+
+TEST_FUNCTION(SHA224_known_answer_with_every_supported_implementation)
+{
+    size_t i;
+    for (i = 0; i < sizeof(allImplementations) / sizeof(allImplementations[0]); i++)
+    {
+        ///arrange
+        SHA224Context context;
+        uint8_t digest[SHA224HashSize];
+        char hex[2 * SHA224HashSize + 1];
+        if (SHA256SetImplementation(allImplementations[i]) != shaSuccess)
+        {
+            continue;
+        }
+
+        ///act
+        ASSERT_ARE_EQUAL(int, shaSuccess, SHA224Reset(&context));
+        ASSERT_ARE_EQUAL(int, shaSuccess, SHA224Input(&context, (const uint8_t*)"abc", 3));
+        ASSERT_ARE_EQUAL(int, shaSuccess, SHA224Result(&context, digest));
+
+        ///assert
+        DigestToHex(digest, sizeof(digest), hex);
+        ASSERT_ARE_EQUAL(char_ptr, "23097d223405d8228642a477bda255b32aadbce4bda0b3f7e36c9da7", hex);
+    }
+}
+
+TEST_FUNCTION(SHA256_every_implementation_matches_the_portable_one_for_any_length_and_chunking)
+{
+    ///arrange
+    static const unsigned int chunks[] = { 1, 7, 63, 64, 65, 200, 1024 };
+    uint8_t message[1100];
+    unsigned int length;
+    FillPseudoRandom(message, sizeof(message), 42);
+
+    for (length = 0; length <= sizeof(message); length += 13)
+    {
+        uint8_t expected[SHA256HashSize];
+        size_t i;
+        ASSERT_ARE_EQUAL(int, shaSuccess, SHA256SetImplementation(sha256ImplPortable));
+        Sha256InChunks(message, length, 1, expected);
+
+        for (i = 0; i < sizeof(allImplementations) / sizeof(allImplementations[0]); i++)
+        {
+            size_t j;
+            if (SHA256SetImplementation(allImplementations[i]) != shaSuccess)
+            {
+                continue;
+            }
+
+            for (j = 0; j < sizeof(chunks) / sizeof(chunks[0]); j++)
+            {
+                ///act
+                uint8_t actual[SHA256HashSize];
+                Sha256InChunks(message, length, chunks[j], actual);
+
+                ///assert
+                ASSERT_ARE_EQUAL(int, 0, memcmp(expected, actual, sizeof(expected)));
+            }
+        }
+    }
+}
+
+TEST_FUNCTION(SHA256HashMany_matches_SHA256_for_messages_of_different_lengths)
+{
+    ///arrange
+    uint8_t buffer[2048];
+    const uint8_t* messages[19];
+    unsigned int lengths[19];
+    uint8_t digests[19][SHA256HashSize];
+    size_t i;
+    FillPseudoRandom(buffer, sizeof(buffer), 7);
+    for (i = 0; i < 19; i++)
+    {
+        messages[i] = buffer + 3 * i;
+        lengths[i] = (unsigned int)((i * 97) % 300);
+    }
+    lengths[5] = 55;
+    lengths[6] = 56;
+    lengths[7] = 64;
+
+    for (i = 0; i < sizeof(allImplementations) / sizeof(allImplementations[0]); i++)
+    {
+        size_t j;
+        if (SHA256SetImplementation(allImplementations[i]) != shaSuccess)
+        {
+            continue;
+        }
+
+        ///act
+        ASSERT_ARE_EQUAL(int, shaSuccess, SHA256HashMany(messages, lengths, 19, digests));
+
+        ///assert
+        for (j = 0; j < 19; j++)
+        {
+            uint8_t expected[SHA256HashSize];
+            Sha256InChunks(messages[j], lengths[j], 64, expected);
+            ASSERT_ARE_EQUAL(int, 0, memcmp(expected, digests[j], sizeof(expected)));
+        }
+    }
+}
+
+TEST_FUNCTION(SHA256HashMany_with_NULL_messages_fails)
+{
+    ///arrange
+    unsigned int lengths[1] = { 3 };
+    uint8_t digests[1][SHA256HashSize];
+
+    ///act
+    int result = SHA256HashMany(NULL, lengths, 1, digests);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, shaNull, result);
+}
+
+TEST_FUNCTION(SHA256HashMany_with_a_NULL_non_empty_message_fails)
+{
+    ///arrange
+    const uint8_t* messages[2] = { (const uint8_t*)"abc", NULL };
+    unsigned int lengths[2] = { 3, 1 };
+    uint8_t digests[2][SHA256HashSize];
+
+    ///act
+    int result = SHA256HashMany(messages, lengths, 2, digests);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, shaNull, result);
+}
+
+TEST_FUNCTION(SHA256_throughput_of_every_supported_implementation)
+{
+    ///arrange
+    const unsigned int messageSize = 1024 * 1024;
+    const unsigned int smallSize = 128;
+    uint8_t* message = (uint8_t*)malloc(messageSize);
+    size_t i;
+    ASSERT_IS_NOT_NULL(message);
+    FillPseudoRandom(message, messageSize, 1);
+
+    for (i = 0; i < sizeof(allImplementations) / sizeof(allImplementations[0]); i++)
+    {
+        const uint8_t* messages[64];
+        unsigned int lengths[64];
+        uint8_t digests[64][SHA256HashSize];
+        clock_t start;
+        double bulkSeconds;
+        double manySeconds;
+        unsigned int round;
+        size_t j;
+        if (SHA256SetImplementation(allImplementations[i]) != shaSuccess)
+        {
+            continue;
+        }
+
+        ///act
+        start = clock();
+        for (round = 0; round < SHA_UT_THROUGHPUT_MEGABYTES; round++)
+        {
+            uint8_t digest[SHA256HashSize];
+            Sha256InChunks(message, messageSize, messageSize, digest);
+        }
+        bulkSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        /*the same amount of data as many small independent messages, the HMAC / SAS token case*/
+        for (j = 0; j < 64; j++)
+        {
+            messages[j] = message + j * smallSize;
+            lengths[j] = smallSize;
+        }
+        start = clock();
+        for (round = 0; round < SHA_UT_THROUGHPUT_MEGABYTES * (messageSize / (64 * smallSize)); round++)
+        {
+            ASSERT_ARE_EQUAL(int, shaSuccess, SHA256HashMany(messages, lengths, 64, digests));
+        }
+        manySeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        ///assert
+        /*numbers are reported, not asserted, they depend on the machine running the gate*/
+        LogInfo("SHA-256 %s: %.0f MB/s bulk, %.0f MB/s as %u byte messages",
+            implementationNames[allImplementations[i]],
+            bulkSeconds > 0 ? SHA_UT_THROUGHPUT_MEGABYTES / bulkSeconds : 0.0,
+            manySeconds > 0 ? SHA_UT_THROUGHPUT_MEGABYTES / manySeconds : 0.0,
+            smallSize);
+    }
+
+    ///cleanup
+    free(message);
+}
+
+END_TEST_SUITE(sha_ut)
@@ -1228,4 +1228,166 @@ TEST_FUNCTION(singlylinkedlist_remove_if_removes_the_only_item_in_the_list)
     singlylinkedlist_destroy(list);
 }
 
+/* singlylinkedlist_create_with_node_pool */
+
+/* Tests_SRS_LIST_99_001: [singlylinkedlist_create_with_node_pool shall create a new list like singlylinkedlist_create that keeps up to max_free_nodes removed nodes for reuse.] */
+TEST_FUNCTION(when_underlying_malloc_fails_singlylinkedlist_create_with_node_pool_fails)
+{
+    // arrange
+    SINGLYLINKEDLIST_HANDLE result;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .SetReturn((void*)NULL);
+
+    // act
+    result = singlylinkedlist_create_with_node_pool(4);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_LIST_99_002: [When a node allocated by singlylinkedlist_add is removed and fewer than max_free_nodes nodes are kept, the list shall keep it instead of freeing it.] */
+/* Tests_SRS_LIST_99_004: [singlylinkedlist_add shall reuse a kept node, if any, instead of allocating one.] */
+TEST_FUNCTION(singlylinkedlist_add_after_remove_reuses_the_kept_node)
+{
+    // arrange
+    SINGLYLINKEDLIST_HANDLE list = singlylinkedlist_create_with_node_pool(1);
+    int x1 = 42;
+    int x2 = 43;
+    LIST_ITEM_HANDLE item1 = singlylinkedlist_add(list, &x1);
+    LIST_ITEM_HANDLE item2;
+    int remove_result;
+    umock_c_reset_all_calls();
+
+    // act
+    remove_result = singlylinkedlist_remove(list, item1);
+    item2 = singlylinkedlist_add(list, &x2);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, remove_result);
+    ASSERT_ARE_EQUAL(void_ptr, (void*)item1, (void*)item2);
+    ASSERT_ARE_EQUAL(int, x2, *(const int*)singlylinkedlist_item_get_value(singlylinkedlist_get_head_item(list)));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    singlylinkedlist_destroy(list);
+}
+
+/* Tests_SRS_LIST_99_002: [When a node allocated by singlylinkedlist_add is removed and fewer than max_free_nodes nodes are kept, the list shall keep it instead of freeing it.] */
+TEST_FUNCTION(singlylinkedlist_remove_frees_nodes_beyond_max_free_nodes)
+{
+    // arrange
+    SINGLYLINKEDLIST_HANDLE list = singlylinkedlist_create_with_node_pool(1);
+    int x1 = 42;
+    int x2 = 43;
+    LIST_ITEM_HANDLE item1 = singlylinkedlist_add(list, &x1);
+    LIST_ITEM_HANDLE item2 = singlylinkedlist_add(list, &x2);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_free(item2));
+
+    // act
+    (void)singlylinkedlist_remove(list, item1);
+    (void)singlylinkedlist_remove(list, item2);
+
+    // assert
+    ASSERT_IS_NULL(singlylinkedlist_get_head_item(list));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    singlylinkedlist_destroy(list);
+}
+
+/* Tests_SRS_LIST_99_003: [singlylinkedlist_destroy shall free the nodes kept for reuse.] */
+TEST_FUNCTION(singlylinkedlist_destroy_frees_the_kept_nodes)
+{
+    // arrange
+    SINGLYLINKEDLIST_HANDLE list = singlylinkedlist_create_with_node_pool(2);
+    int x = 42;
+    LIST_ITEM_HANDLE item = singlylinkedlist_add(list, &x);
+    (void)singlylinkedlist_remove(list, item);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_free(item));
+    STRICT_EXPECTED_CALL(gballoc_free(list));
+
+    // act
+    singlylinkedlist_destroy(list);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* singlylinkedlist_add_node */
+
+/* Tests_SRS_LIST_99_005: [If any of the arguments is NULL, singlylinkedlist_add_node shall not add the item to the list and return NULL.] */
+TEST_FUNCTION(singlylinkedlist_add_node_with_NULL_node_fails)
+{
+    // arrange
+    SINGLYLINKEDLIST_HANDLE list = singlylinkedlist_create();
+    int x = 42;
+    LIST_ITEM_HANDLE result;
+    umock_c_reset_all_calls();
+
+    // act
+    result = singlylinkedlist_add_node(list, NULL, &x);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_IS_NULL(singlylinkedlist_get_head_item(list));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    singlylinkedlist_destroy(list);
+}
+
+/* Tests_SRS_LIST_99_007: [singlylinkedlist_add_node shall add item to the tail of the list using node as its list node, without allocating, and return node.] */
+TEST_FUNCTION(singlylinkedlist_add_node_links_the_node_without_allocating)
+{
+    // arrange
+    SINGLYLINKEDLIST_HANDLE list = singlylinkedlist_create();
+    SINGLYLINKEDLIST_NODE node;
+    int x1 = 42;
+    int x2 = 43;
+    LIST_ITEM_HANDLE result;
+    (void)singlylinkedlist_add(list, &x1);
+    umock_c_reset_all_calls();
+
+    // act
+    result = singlylinkedlist_add_node(list, &node, &x2);
+
+    // assert
+    ASSERT_ARE_EQUAL(void_ptr, (void*)&node, (void*)result);
+    ASSERT_ARE_EQUAL(void_ptr, (void*)result, (void*)singlylinkedlist_get_next_item(singlylinkedlist_get_head_item(list)));
+    ASSERT_ARE_EQUAL(int, x2, *(const int*)singlylinkedlist_item_get_value(result));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    singlylinkedlist_destroy(list);
+}
+
+/* Tests_SRS_LIST_99_006: [Removing a node added with singlylinkedlist_add_node shall only unlink it.] */
+TEST_FUNCTION(singlylinkedlist_remove_and_destroy_do_not_free_nodes_added_with_add_node)
+{
+    // arrange
+    SINGLYLINKEDLIST_HANDLE list = singlylinkedlist_create_with_node_pool(2);
+    SINGLYLINKEDLIST_NODE nodes[2];
+    int x1 = 42;
+    int x2 = 43;
+    int remove_result;
+    (void)singlylinkedlist_add_node(list, &nodes[0], &x1);
+    (void)singlylinkedlist_add_node(list, &nodes[1], &x2);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_free(list));
+
+    // act
+    remove_result = singlylinkedlist_remove(list, &nodes[0]);
+    singlylinkedlist_destroy(list);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, remove_result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
 END_TEST_SUITE(singlylinkedlist_unittests)
@@ -0,0 +1,467 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#endif
+
+#include "testrunnerswitcher.h"
+#include "azure_c_shared_utility/threadpool.h"
+#include "azure_c_shared_utility/threadapi.h"
+#include "azure_c_shared_utility/lock.h"
+
+TEST_DEFINE_ENUM_TYPE(THREADPOOL_RESULT, THREADPOOL_RESULT_VALUES);
+TEST_DEFINE_ENUM_TYPE(THREADPOOL_WORK_STATUS, THREADPOOL_WORK_STATUS_VALUES);
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+/*how long a test waits for the workers before it gives up*/
+#define TEST_WAIT_LIMIT_MS 5000
+
+/*state shared with the works, every access goes through the lock*/
+typedef struct TEST_STATE_TAG
+{
+    LOCK_HANDLE lock;
+    size_t runs;
+    size_t completions;
+    int gate_open;
+    int last_result;
+    THREADPOOL_WORK_STATUS last_status;
+    size_t order[4];
+    size_t order_count;
+} TEST_STATE;
+
+typedef struct ORDERED_WORK_TAG
+{
+    TEST_STATE* state;
+    size_t id;
+} ORDERED_WORK;
+
+static TEST_STATE test_state;
+
+static size_t read_count(const size_t* counter)
+{
+    size_t result;
+    (void)Lock(test_state.lock);
+    result = *counter;
+    (void)Unlock(test_state.lock);
+    return result;
+}
+
+static int wait_for_count(const size_t* counter, size_t expected)
+{
+    unsigned int waited_ms = 0;
+    while ((read_count(counter) < expected) && (waited_ms < TEST_WAIT_LIMIT_MS))
+    {
+        ThreadAPI_Sleep(1);
+        waited_ms++;
+    }
+    return (read_count(counter) >= expected) ? 0 : __LINE__;
+}
+
+static int count_run(void* work_context)
+{
+    TEST_STATE* state = (TEST_STATE*)work_context;
+    (void)Lock(state->lock);
+    state->runs++;
+    (void)Unlock(state->lock);
+    return 42;
+}
+
+/*holds its worker until the test opens the gate*/
+static int wait_for_gate(void* work_context)
+{
+    TEST_STATE* state = (TEST_STATE*)work_context;
+    int open;
+
+    (void)Lock(state->lock);
+    state->runs++;
+    (void)Unlock(state->lock);
+
+    do
+    {
+        ThreadAPI_Sleep(1);
+        (void)Lock(state->lock);
+        open = state->gate_open;
+        (void)Unlock(state->lock);
+    } while (!open);
+
+    return 7;
+}
+
+static int record_order(void* work_context)
+{
+    ORDERED_WORK* ordered_work = (ORDERED_WORK*)work_context;
+    (void)Lock(ordered_work->state->lock);
+    ordered_work->state->order[ordered_work->state->order_count++] = ordered_work->id;
+    ordered_work->state->runs++;
+    (void)Unlock(ordered_work->state->lock);
+    return 0;
+}
+
+static void on_work_complete(void* complete_context, THREADPOOL_WORK_STATUS status, int work_result)
+{
+    TEST_STATE* state = (TEST_STATE*)complete_context;
+    (void)Lock(state->lock);
+    state->last_status = status;
+    state->last_result = work_result;
+    state->completions++;
+    (void)Unlock(state->lock);
+}
+
+static void open_gate(void)
+{
+    (void)Lock(test_state.lock);
+    test_state.gate_open = 1;
+    (void)Unlock(test_state.lock);
+}
+
+BEGIN_TEST_SUITE(threadpool_ut)
+
+TEST_SUITE_INITIALIZE(suite_init)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+}
+
+TEST_SUITE_CLEANUP(suite_cleanup)
+{
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("Could not acquire test serialization mutex.");
+    }
+
+    test_state.lock = Lock_Init();
+    ASSERT_IS_NOT_NULL(test_state.lock);
+    test_state.runs = 0;
+    test_state.completions = 0;
+    test_state.gate_open = 0;
+    test_state.last_result = 0;
+    test_state.last_status = THREADPOOL_WORK_CANCELLED;
+    test_state.order_count = 0;
+}
+
+TEST_FUNCTION_CLEANUP(method_cleanup)
+{
+    (void)Lock_Deinit(test_state.lock);
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* Tests_SRS_THREADPOOL_99_001: [ If worker_count or queue_capacity is 0, threadpool_create shall fail and return NULL. ] */
+TEST_FUNCTION(threadpool_create_with_0_workers_fails)
+{
+    ///arrange
+
+    ///act
+    THREADPOOL_HANDLE threadpool = threadpool_create(0, 4);
+
+    ///assert
+    ASSERT_IS_NULL(threadpool);
+}
+
+/* Tests_SRS_THREADPOOL_99_001: [ If worker_count or queue_capacity is 0, threadpool_create shall fail and return NULL. ] */
+TEST_FUNCTION(threadpool_create_with_0_queue_capacity_fails)
+{
+    ///arrange
+
+    ///act
+    THREADPOOL_HANDLE threadpool = threadpool_create(2, 0);
+
+    ///assert
+    ASSERT_IS_NULL(threadpool);
+}
+
+/* Tests_SRS_THREADPOOL_99_002: [ threadpool_create shall allocate the queue of queue_capacity works, create the lock and the condition and start worker_count threads with ThreadAPI_Create. ] */
+/* Tests_SRS_THREADPOOL_99_005: [ threadpool_destroy shall stop accepting work, let the workers run every queued work and join them. ] */
+TEST_FUNCTION(threadpool_create_and_destroy_succeed)
+{
+    ///arrange
+
+    ///act
+    THREADPOOL_HANDLE threadpool = threadpool_create(4, 16);
+
+    ///assert
+    ASSERT_IS_NOT_NULL(threadpool);
+
+    ///cleanup
+    threadpool_destroy(threadpool);
+}
+
+/* Tests_SRS_THREADPOOL_99_004: [ If threadpool is NULL, threadpool_destroy shall do nothing. ] */
+TEST_FUNCTION(threadpool_destroy_with_NULL_does_nothing)
+{
+    ///arrange
+
+    ///act
+    threadpool_destroy(NULL);
+
+    ///assert
+}
+
+/* Tests_SRS_THREADPOOL_99_007: [ If threadpool or work is NULL, threadpool_schedule shall fail and return THREADPOOL_INVALID_ARG. ] */
+/* Tests_SRS_THREADPOOL_99_011: [ If threadpool or work is NULL, threadpool_schedule_delayed shall fail and return THREADPOOL_INVALID_ARG. ] */
+/* Tests_SRS_THREADPOOL_99_014: [ If threadpool, work or future is NULL, threadpool_submit shall fail and return THREADPOOL_INVALID_ARG. ] */
+TEST_FUNCTION(threadpool_schedule_with_NULL_arguments_fails)
+{
+    ///arrange
+    THREADPOOL_FUTURE_HANDLE future;
+    THREADPOOL_HANDLE threadpool = threadpool_create(1, 1);
+    ASSERT_IS_NOT_NULL(threadpool);
+
+    ///act
+    ///assert
+    ASSERT_ARE_EQUAL(THREADPOOL_RESULT, THREADPOOL_INVALID_ARG, threadpool_schedule(NULL, count_run, &test_state, NULL, NULL));
+    ASSERT_ARE_EQUAL(THREADPOOL_RESULT, THREADPOOL_INVALID_ARG, threadpool_schedule(threadpool, NULL, &test_state, NULL, NULL));
+    ASSERT_ARE_EQUAL(THREADPOOL_RESULT, THREADPOOL_INVALID_ARG, threadpool_schedule_delayed(NULL, 1, count_run, &test_state, NULL, NULL));
+    ASSERT_ARE_EQUAL(THREADPOOL_RESULT, THREADPOOL_INVALID_ARG, threadpool_schedule_delayed(threadpool, 1, NULL, &test_state, NULL, NULL));
+    ASSERT_ARE_EQUAL(THREADPOOL_RESULT, THREADPOOL_INVALID_ARG, threadpool_submit(NULL, count_run, &test_state, &future));
+    ASSERT_ARE_EQUAL(THREADPOOL_RESULT, THREADPOOL_INVALID_ARG, threadpool_submit(threadpool, NULL, &test_state, &future));
+    ASSERT_ARE_EQUAL(THREADPOOL_RESULT, THREADPOOL_INVALID_ARG, threadpool_submit(threadpool, count_run, &test_state, NULL));
+    ASSERT_ARE_EQUAL(size_t, 0, read_count(&test_state.runs));
+
+    ///cleanup
+    threadpool_destroy(threadpool);
+}
+
+/* Tests_SRS_THREADPOOL_99_008: [ A worker shall run the work without holding the threadpool lock and then call on_complete, when it is not NULL, with THREADPOOL_WORK_COMPLETED and the value the work returned. ] */
+/* Tests_SRS_THREADPOOL_99_010: [ threadpool_schedule shall queue the work, wake an idle worker and return THREADPOOL_OK. ] */
+TEST_FUNCTION(threadpool_schedule_runs_the_work_and_calls_on_complete)
+{
+    ///arrange
+    THREADPOOL_RESULT result;
+    THREADPOOL_HANDLE threadpool = threadpool_create(2, 4);
+    ASSERT_IS_NOT_NULL(threadpool);
+
+    ///act
+    result = threadpool_schedule(threadpool, count_run, &test_state, on_work_complete, &test_state);
+
+    ///assert
+    ASSERT_ARE_EQUAL(THREADPOOL_RESULT, THREADPOOL_OK, result);
+    ASSERT_ARE_EQUAL(int, 0, wait_for_count(&test_state.completions, 1));
+    ASSERT_ARE_EQUAL(size_t, 1, read_count(&test_state.runs));
+    ASSERT_ARE_EQUAL(THREADPOOL_WORK_STATUS, THREADPOOL_WORK_COMPLETED, test_state.last_status);
+    ASSERT_ARE_EQUAL(int, 42, test_state.last_result);
+
+    ///cleanup
+    threadpool_destroy(threadpool);
+}
+
+/* Tests_SRS_THREADPOOL_99_005: [ threadpool_destroy shall stop accepting work, let the workers run every queued work and join them. ] */
+TEST_FUNCTION(threadpool_runs_every_queued_work_before_destroy_returns)
+{
+    ///arrange
+    const size_t work_count = 2000;
+    size_t scheduled = 0;
+    THREADPOOL_HANDLE threadpool = threadpool_create(4, 8);
+    ASSERT_IS_NOT_NULL(threadpool);
+
+    ///act
+    while (scheduled < work_count)
+    {
+        THREADPOOL_RESULT result = threadpool_schedule(threadpool, count_run, &test_state, NULL, NULL);
+        if (result == THREADPOOL_OK)
+        {
+            scheduled++;
+        }
+        else
+        {
+            ASSERT_ARE_EQUAL(THREADPOOL_RESULT, THREADPOOL_QUEUE_FULL, result);
+        }
+    }
+    threadpool_destroy(threadpool);
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, work_count, read_count(&test_state.runs));
+}
+
+/* Tests_SRS_THREADPOOL_99_009: [ If queue_capacity works are already waiting, threadpool_schedule shall return THREADPOOL_QUEUE_FULL without blocking. ] */
+TEST_FUNCTION(threadpool_schedule_on_a_full_queue_returns_THREADPOOL_QUEUE_FULL)
+{
+    ///arrange
+    THREADPOOL_RESULT result;
+    THREADPOOL_HANDLE threadpool = threadpool_create(1, 2);
+    ASSERT_IS_NOT_NULL(threadpool);
+    ASSERT_ARE_EQUAL(THREADPOOL_RESULT, THREADPOOL_OK, threadpool_schedule(threadpool, wait_for_gate, &test_state, NULL, NULL));
+    ASSERT_ARE_EQUAL(int, 0, wait_for_count(&test_state.runs, 1));
+    ASSERT_ARE_EQUAL(THREADPOOL_RESULT, THREADPOOL_OK, threadpool_schedule(threadpool, count_run, &test_state, NULL, NULL));
+    ASSERT_ARE_EQUAL(THREADPOOL_RESULT, THREADPOOL_OK, threadpool_schedule(threadpool, count_run, &test_state, NULL, NULL));
+
+    ///act
+    result = threadpool_schedule(threadpool, count_run, &test_state, NULL, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(THREADPOOL_RESULT, THREADPOOL_QUEUE_FULL, result);
+
+    ///cleanup
+    open_gate();
+    threadpool_destroy(threadpool);
+    ASSERT_ARE_EQUAL(size_t, 3, read_count(&test_state.runs));
+}
+
+/* Tests_SRS_THREADPOOL_99_015: [ threadpool_submit shall schedule the work like threadpool_schedule and, on success, return the future in future. Otherwise it shall free the future and return the threadpool_schedule result. ] */
+/* Tests_SRS_THREADPOOL_99_017: [ Once the work ran, threadpool_future_wait shall store the value it returned in work_result, when it is not NULL, and return THREADPOOL_OK. ] */
+TEST_FUNCTION(threadpool_future_wait_returns_the_result_of_the_work)
+{
+    ///arrange
+    THREADPOOL_FUTURE_HANDLE future;
+    int work_result = 0;
+    THREADPOOL_RESULT result;
+    THREADPOOL_HANDLE threadpool = threadpool_create(2, 4);
+    ASSERT_IS_NOT_NULL(threadpool);
+    ASSERT_ARE_EQUAL(THREADPOOL_RESULT, THREADPOOL_OK, threadpool_submit(threadpool, count_run, &test_state, &future));
+
+    ///act
+    result = threadpool_future_wait(future, 0, &work_result);
+
+    ///assert
+    ASSERT_ARE_EQUAL(THREADPOOL_RESULT, THREADPOOL_OK, result);
+    ASSERT_ARE_EQUAL(int, 42, work_result);
+    ASSERT_ARE_EQUAL(size_t, 1, read_count(&test_state.runs));
+
+    ///cleanup
+    threadpool_future_destroy(future);
+    threadpool_destroy(threadpool);
+}
+
+/* Tests_SRS_THREADPOOL_99_018: [ If the work did not run within timeout_milliseconds, threadpool_future_wait shall return THREADPOOL_TIMEOUT. A timeout_milliseconds of 0 waits for as long as it takes. ] */
+TEST_FUNCTION(threadpool_future_wait_times_out_while_the_work_runs)
+{
+    ///arrange
+    THREADPOOL_FUTURE_HANDLE future;
+    int work_result = 0;
+    THREADPOOL_RESULT timed_out_result;
+    THREADPOOL_RESULT result;
+    THREADPOOL_HANDLE threadpool = threadpool_create(1, 4);
+    ASSERT_IS_NOT_NULL(threadpool);
+    ASSERT_ARE_EQUAL(THREADPOOL_RESULT, THREADPOOL_OK, threadpool_submit(threadpool, wait_for_gate, &test_state, &future));
+
+    ///act
+    timed_out_result = threadpool_future_wait(future, 20, &work_result);
+    open_gate();
+    result = threadpool_future_wait(future, 0, &work_result);
+
+    ///assert
+    ASSERT_ARE_EQUAL(THREADPOOL_RESULT, THREADPOOL_TIMEOUT, timed_out_result);
+    ASSERT_ARE_EQUAL(THREADPOOL_RESULT, THREADPOOL_OK, result);
+    ASSERT_ARE_EQUAL(int, 7, work_result);
+
+    ///cleanup
+    threadpool_future_destroy(future);
+    threadpool_destroy(threadpool);
+}
+
+/* Tests_SRS_THREADPOOL_99_019: [ If future is NULL, threadpool_future_destroy shall do nothing. Otherwise it shall release the future, which is freed once its work ran too. ] */
+TEST_FUNCTION(threadpool_future_destroy_before_the_work_ran_lets_it_run)
+{
+    ///arrange
+    THREADPOOL_FUTURE_HANDLE future;
+    THREADPOOL_HANDLE threadpool = threadpool_create(1, 4);
+    ASSERT_IS_NOT_NULL(threadpool);
+    ASSERT_ARE_EQUAL(THREADPOOL_RESULT, THREADPOOL_OK, threadpool_schedule(threadpool, wait_for_gate, &test_state, NULL, NULL));
+    ASSERT_ARE_EQUAL(THREADPOOL_RESULT, THREADPOOL_OK, threadpool_submit(threadpool, count_run, &test_state, &future));
+
+    ///act
+    threadpool_future_destroy(future);
+    threadpool_future_destroy(NULL);
+    open_gate();
+    threadpool_destroy(threadpool);
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 2, read_count(&test_state.runs));
+}
+
+/* Tests_SRS_THREADPOOL_99_016: [ If future is NULL, threadpool_future_wait shall fail and return THREADPOOL_INVALID_ARG. ] */
+TEST_FUNCTION(threadpool_future_wait_with_NULL_future_fails)
+{
+    ///arrange
+
+    ///act
+    THREADPOOL_RESULT result = threadpool_future_wait(NULL, 0, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(THREADPOOL_RESULT, THREADPOOL_INVALID_ARG, result);
+}
+
+/* Tests_SRS_THREADPOOL_99_012: [ threadpool_schedule_delayed shall keep the work until delay_ms milliseconds have passed on a monotonic clock, and run it before the queued works once it is due. ] */
+TEST_FUNCTION(threadpool_schedule_delayed_runs_the_work_after_the_delay)
+{
+    ///arrange
+    THREADPOOL_RESULT result;
+    THREADPOOL_HANDLE threadpool = threadpool_create(2, 4);
+    ASSERT_IS_NOT_NULL(threadpool);
+
+    ///act
+    result = threadpool_schedule_delayed(threadpool, 200, count_run, &test_state, on_work_complete, &test_state);
+
+    ///assert
+    ASSERT_ARE_EQUAL(THREADPOOL_RESULT, THREADPOOL_OK, result);
+    ThreadAPI_Sleep(50);
+    ASSERT_ARE_EQUAL(size_t, 0, read_count(&test_state.runs));
+    ASSERT_ARE_EQUAL(int, 0, wait_for_count(&test_state.completions, 1));
+    ASSERT_ARE_EQUAL(THREADPOOL_WORK_STATUS, THREADPOOL_WORK_COMPLETED, test_state.last_status);
+
+    ///cleanup
+    threadpool_destroy(threadpool);
+}
+
+/* Tests_SRS_THREADPOOL_99_012: [ threadpool_schedule_delayed shall keep the work until delay_ms milliseconds have passed on a monotonic clock, and run it before the queued works once it is due. ] */
+TEST_FUNCTION(threadpool_schedule_delayed_runs_the_works_in_deadline_order)
+{
+    ///arrange
+    ORDERED_WORK late;
+    ORDERED_WORK early;
+    ORDERED_WORK earliest;
+    THREADPOOL_HANDLE threadpool = threadpool_create(1, 4);
+    ASSERT_IS_NOT_NULL(threadpool);
+    late.state = &test_state;
+    late.id = 3;
+    early.state = &test_state;
+    early.id = 2;
+    earliest.state = &test_state;
+    earliest.id = 1;
+
+    ///act
+    ASSERT_ARE_EQUAL(THREADPOOL_RESULT, THREADPOOL_OK, threadpool_schedule_delayed(threadpool, 150, record_order, &late, NULL, NULL));
+    ASSERT_ARE_EQUAL(THREADPOOL_RESULT, THREADPOOL_OK, threadpool_schedule_delayed(threadpool, 100, record_order, &early, NULL, NULL));
+    ASSERT_ARE_EQUAL(THREADPOOL_RESULT, THREADPOOL_OK, threadpool_schedule_delayed(threadpool, 20, record_order, &earliest, NULL, NULL));
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, wait_for_count(&test_state.runs, 3));
+    ASSERT_ARE_EQUAL(size_t, 1, test_state.order[0]);
+    ASSERT_ARE_EQUAL(size_t, 2, test_state.order[1]);
+    ASSERT_ARE_EQUAL(size_t, 3, test_state.order[2]);
+
+    ///cleanup
+    threadpool_destroy(threadpool);
+}
+
+/* Tests_SRS_THREADPOOL_99_006: [ threadpool_destroy shall call on_complete with THREADPOOL_WORK_CANCELLED for every delayed work that is not due, then free the pool. ] */
+TEST_FUNCTION(threadpool_destroy_cancels_the_delayed_works_that_are_not_due)
+{
+    ///arrange
+    THREADPOOL_HANDLE threadpool = threadpool_create(2, 4);
+    ASSERT_IS_NOT_NULL(threadpool);
+    ASSERT_ARE_EQUAL(THREADPOOL_RESULT, THREADPOOL_OK, threadpool_schedule_delayed(threadpool, 60000, count_run, &test_state, on_work_complete, &test_state));
+
+    ///act
+    threadpool_destroy(threadpool);
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 0, read_count(&test_state.runs));
+    ASSERT_ARE_EQUAL(size_t, 1, read_count(&test_state.completions));
+    ASSERT_ARE_EQUAL(THREADPOOL_WORK_STATUS, THREADPOOL_WORK_CANCELLED, test_state.last_status);
+}
+
+END_TEST_SUITE(threadpool_ut)
@@ -17,6 +17,7 @@
 #include <stddef.h>
 #include <stdbool.h>
 #endif
+#include <string.h>
 
 #include "testrunnerswitcher.h"
 #include "azure_c_shared_utility/utf8_checker.h"
@@ -24,6 +25,51 @@
 static TEST_MUTEX_HANDLE g_testByTest;
 static TEST_MUTEX_HANDLE g_dllByDll;
 
+static const UTF8_CHECKER_IMPLEMENTATION vector_implementations[] = { UTF8_CHECKER_IMPLEMENTATION_SSSE3, UTF8_CHECKER_IMPLEMENTATION_AVX2, UTF8_CHECKER_IMPLEMENTATION_NEON };
+
+/* well formed sequences of every length, including a surrogate and codepoints above U+10FFFF that the checker accepts */
+static const unsigned char* const valid_sequences[] =
+{
+    (const unsigned char*)"a",
+    (const unsigned char*)"\x7F",
+    (const unsigned char*)"\xC2\x80",
+    (const unsigned char*)"\xDF\xBF",
+    (const unsigned char*)"\xE0\xA0\x80",
+    (const unsigned char*)"\xED\xA0\x80",
+    (const unsigned char*)"\xEF\xBF\xBF",
+    (const unsigned char*)"\xF0\x90\x80\x80",
+    (const unsigned char*)"\xF4\x90\x80\x80",
+    (const unsigned char*)"\xF7\xBF\xBF\xBF"
+};
+
+/* xorshift, so that every run checks the same texts */
+static unsigned int next_random(unsigned int* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static size_t make_valid_text(unsigned char* text, size_t capacity, unsigned int* random_state)
+{
+    size_t length = 0;
+
+    while (1)
+    {
+        const unsigned char* sequence = valid_sequences[next_random(random_state) % (sizeof(valid_sequences) / sizeof(valid_sequences[0]))];
+        size_t sequence_length = strlen((const char*)sequence);
+        if (length + sequence_length > capacity)
+        {
+            break;
+        }
+        (void)memcpy(text + length, sequence, sequence_length);
+        length += sequence_length;
+    }
+
+    return length;
+}
+
 BEGIN_TEST_SUITE(utf8_checker_ut)
 
 TEST_SUITE_INITIALIZE(suite_init)
@@ -561,4 +607,248 @@ TEST_FUNCTION(utf8_checker_with_4th_char_bad_fails)
     ASSERT_IS_FALSE(result);
 }
 
-END_TEST_SUITE(utf8_checker_ut)
+
+/* Tests_SRS_UTF8_CHECKER_99_006: [ `UTF8_CHECKER_IMPLEMENTATION_AUTO` shall select AVX2, then SSSE3, then NEON, then the portable code, whichever this CPU and build support first. ]*/
+/* Tests_SRS_UTF8_CHECKER_99_009: [ `utf8_checker_get_implementation` shall return the implementation in use, selecting it as `UTF8_CHECKER_IMPLEMENTATION_AUTO` does if none was selected yet. ]*/
+TEST_FUNCTION(utf8_checker_set_implementation_AUTO_resolves_to_a_supported_implementation)
+{
+    // arrange
+    UTF8_CHECKER_IMPLEMENTATION implementation;
+
+    // act
+    int result = utf8_checker_set_implementation(UTF8_CHECKER_IMPLEMENTATION_AUTO);
+    implementation = utf8_checker_get_implementation();
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_NOT_EQUAL(int, (int)UTF8_CHECKER_IMPLEMENTATION_AUTO, (int)implementation);
+    ASSERT_ARE_EQUAL(int, 0, utf8_checker_set_implementation(implementation));
+}
+
+/* Tests_SRS_UTF8_CHECKER_99_007: [ If this CPU or build does not support `implementation` then `utf8_checker_set_implementation` shall fail, return a non-zero value and keep the implementation in use. ]*/
+/* Tests_SRS_UTF8_CHECKER_99_008: [ Otherwise `utf8_checker_set_implementation` shall make all the validations use `implementation` and return 0. ]*/
+TEST_FUNCTION(utf8_checker_set_implementation_with_an_unknown_implementation_keeps_the_implementation_in_use)
+{
+    // arrange
+    int result;
+    ASSERT_ARE_EQUAL(int, 0, utf8_checker_set_implementation(UTF8_CHECKER_IMPLEMENTATION_PORTABLE));
+
+    // act
+    result = utf8_checker_set_implementation((UTF8_CHECKER_IMPLEMENTATION)0x42);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, (int)UTF8_CHECKER_IMPLEMENTATION_PORTABLE, (int)utf8_checker_get_implementation());
+
+    // cleanup
+    (void)utf8_checker_set_implementation(UTF8_CHECKER_IMPLEMENTATION_AUTO);
+}
+
+/* Tests_SRS_UTF8_CHECKER_99_008: [ Otherwise `utf8_checker_set_implementation` shall make all the validations use `implementation` and return 0. ]*/
+TEST_FUNCTION(utf8_checker_every_implementation_matches_the_portable_one)
+{
+    // arrange
+    static const unsigned char corruptions[] = { 0x80, 0xBF, 0xC0, 0xC1, 0xC2, 0xE0, 0xED, 0xF0, 0xF7, 0xF8, 0xFF, 0x00, 'x' };
+    unsigned char text[160];
+    size_t i;
+
+    for (i = 0; i < sizeof(vector_implementations) / sizeof(vector_implementations[0]); i++)
+    {
+        unsigned int random_state = 0x2545F491;
+        size_t round;
+
+        if (utf8_checker_set_implementation(vector_implementations[i]) != 0)
+        {
+            /* not supported on this CPU or build */
+            continue;
+        }
+
+        for (round = 0; round < 3000; round++)
+        {
+            size_t capacity = 1 + (next_random(&random_state) % sizeof(text));
+            size_t length = make_valid_text(text, capacity, &random_state);
+            bool expected;
+            bool result;
+
+            if (length == 0)
+            {
+                continue;
+            }
+
+            /* most rounds damage the text somewhere, truncations included */
+            switch (round % 4)
+            {
+            default:
+                break;
+            case 1:
+            case 2:
+                text[next_random(&random_state) % length] = corruptions[next_random(&random_state) % sizeof(corruptions)];
+                break;
+            case 3:
+                length -= next_random(&random_state) % ((length < 4) ? length : 4);
+                break;
+            }
+
+            if (length == 0)
+            {
+                continue;
+            }
+
+            // act
+            ASSERT_ARE_EQUAL(int, 0, utf8_checker_set_implementation(UTF8_CHECKER_IMPLEMENTATION_PORTABLE));
+            expected = utf8_checker_is_valid_utf8(text, length);
+            ASSERT_ARE_EQUAL(int, 0, utf8_checker_set_implementation(vector_implementations[i]));
+            result = utf8_checker_is_valid_utf8(text, length);
+
+            // assert
+            ASSERT_ARE_EQUAL(int, (int)expected, (int)result);
+            if (round % 4 == 0)
+            {
+                ASSERT_IS_TRUE(result);
+            }
+        }
+    }
+
+    // cleanup
+    (void)utf8_checker_set_implementation(UTF8_CHECKER_IMPLEMENTATION_AUTO);
+}
+
+/* Tests_SRS_UTF8_CHECKER_01_001: [ `utf8_checker_is_valid_utf8` shall verify that the sequence of chars pointed to by `utf8_str` represent UTF-8 encoded codepoints. ]*/
+TEST_FUNCTION(utf8_checker_every_implementation_finds_a_bad_sequence_anywhere_in_ascii_text)
+{
+    // arrange
+    static const unsigned char* const invalid_sequences[] =
+    {
+        (const unsigned char*)"\x80",
+        (const unsigned char*)"\xC1\xBF",
+        (const unsigned char*)"\xE0\x9F\xBF",
+        (const unsigned char*)"\xF0\x8F\xBF\xBF",
+        (const unsigned char*)"\xF8\x88\x80\x80\x80",
+        (const unsigned char*)"\xFF",
+        (const unsigned char*)"\xC2",
+        (const unsigned char*)"\xE1\x80",
+        (const unsigned char*)"\xF1\x80\x80",
+        (const unsigned char*)"\xC2\x80\x80"
+    };
+    unsigned char text[100];
+    size_t i;
+
+    for (i = 0; i < sizeof(vector_implementations) / sizeof(vector_implementations[0]) + 1; i++)
+    {
+        UTF8_CHECKER_IMPLEMENTATION implementation = (i == 0) ? UTF8_CHECKER_IMPLEMENTATION_PORTABLE : vector_implementations[i - 1];
+        size_t j;
+
+        if (utf8_checker_set_implementation(implementation) != 0)
+        {
+            continue;
+        }
+
+        for (j = 0; j < sizeof(invalid_sequences) / sizeof(invalid_sequences[0]); j++)
+        {
+            size_t sequence_length = strlen((const char*)invalid_sequences[j]);
+            size_t position;
+
+            for (position = 0; position + sequence_length <= sizeof(text); position++)
+            {
+                (void)memset(text, 'a', sizeof(text));
+                (void)memcpy(text + position, invalid_sequences[j], sequence_length);
+
+                // act
+                bool result = utf8_checker_is_valid_utf8(text, sizeof(text));
+
+                // assert
+                ASSERT_IS_FALSE(result);
+            }
+        }
+    }
+
+    // cleanup
+    (void)utf8_checker_set_implementation(UTF8_CHECKER_IMPLEMENTATION_AUTO);
+}
+
+/* utf8_checker_stream_feed */
+
+/* Tests_SRS_UTF8_CHECKER_99_002: [ If `stream` is NULL, or `utf8_str` is NULL while `length` is not 0, `utf8_checker_stream_feed` shall return false. ]*/
+TEST_FUNCTION(utf8_checker_stream_feed_with_NULL_arguments_fails)
+{
+    // arrange
+    UTF8_CHECKER_STREAM stream;
+    unsigned char test_str[] = { 'a' };
+    utf8_checker_stream_init(&stream);
+
+    // act
+    // assert
+    ASSERT_IS_FALSE(utf8_checker_stream_feed(NULL, test_str, sizeof(test_str)));
+    ASSERT_IS_FALSE(utf8_checker_stream_feed(&stream, NULL, 1));
+    ASSERT_IS_TRUE(utf8_checker_stream_feed(&stream, NULL, 0));
+    ASSERT_IS_FALSE(utf8_checker_stream_end(NULL));
+}
+
+/* Tests_SRS_UTF8_CHECKER_99_001: [ `utf8_checker_stream_init` shall start the validation of a new text in `stream`. ]*/
+/* Tests_SRS_UTF8_CHECKER_99_003: [ `utf8_checker_stream_feed` shall validate the `length` bytes at `utf8_str` as the continuation of the text fed so far, a sequence can be split between two calls. ]*/
+/* Tests_SRS_UTF8_CHECKER_99_004: [ Once an invalid byte has been fed `utf8_checker_stream_feed` shall return false, otherwise it shall return true. ]*/
+/* Tests_SRS_UTF8_CHECKER_99_005: [ `utf8_checker_stream_end` shall return true if all the bytes fed into `stream` are valid UTF-8 and the text does not end inside a sequence, false otherwise or if `stream` is NULL. ]*/
+TEST_FUNCTION(utf8_checker_stream_split_anywhere_agrees_with_utf8_checker_is_valid_utf8)
+{
+    // arrange
+    static const unsigned char* const texts[] =
+    {
+        (const unsigned char*)"plain ascii text that is longer than one vector of the validator",
+        (const unsigned char*)"a\xC2\x80" "b\xE0\xA0\x80" "c\xF0\x90\x80\x80" "d\xF7\xBF\xBF\xBF\xED\xA0\x80",
+        (const unsigned char*)"\xF0\x90\x80\x80\xF0\x90\x80\x80\xF0\x90\x80\x80",
+        (const unsigned char*)"ab\xE0\xA0",
+        (const unsigned char*)"ab\xC0\x80",
+        (const unsigned char*)"\xF0\x90\x80\x80\x80",
+        (const unsigned char*)"\xE1\x80" "a",
+        (const unsigned char*)"\xF8\x88\x80\x80\x80",
+        (const unsigned char*)"abc\xFF"
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(texts) / sizeof(texts[0]); i++)
+    {
+        size_t length = strlen((const char*)texts[i]);
+        bool expected = utf8_checker_is_valid_utf8(texts[i], length);
+        size_t first_split;
+
+        for (first_split = 0; first_split <= length; first_split++)
+        {
+            size_t second_split;
+            for (second_split = first_split; second_split <= length; second_split++)
+            {
+                UTF8_CHECKER_STREAM stream;
+                bool result;
+                utf8_checker_stream_init(&stream);
+
+                // act
+                (void)utf8_checker_stream_feed(&stream, texts[i], first_split);
+                (void)utf8_checker_stream_feed(&stream, texts[i] + first_split, second_split - first_split);
+                (void)utf8_checker_stream_feed(&stream, texts[i] + second_split, length - second_split);
+                result = utf8_checker_stream_end(&stream);
+
+                // assert
+                ASSERT_ARE_EQUAL(int, (int)expected, (int)result);
+            }
+        }
+    }
+}
+
+/* Tests_SRS_UTF8_CHECKER_99_004: [ Once an invalid byte has been fed `utf8_checker_stream_feed` shall return false, otherwise it shall return true. ]*/
+TEST_FUNCTION(utf8_checker_stream_feed_reports_a_bad_continuation_in_the_piece_that_holds_it)
+{
+    // arrange
+    UTF8_CHECKER_STREAM stream;
+    unsigned char first_piece[] = { 'a', 0xE2, 0x82 };
+    unsigned char second_piece[] = { 'x', 'y' };
+    utf8_checker_stream_init(&stream);
+
+    // act
+    // assert
+    ASSERT_IS_TRUE(utf8_checker_stream_feed(&stream, first_piece, sizeof(first_piece)));
+    ASSERT_IS_FALSE(utf8_checker_stream_end(&stream));
+    ASSERT_IS_FALSE(utf8_checker_stream_feed(&stream, second_piece, sizeof(second_piece)));
+    ASSERT_IS_FALSE(utf8_checker_stream_feed(&stream, second_piece, sizeof(second_piece)));
+    ASSERT_IS_FALSE(utf8_checker_stream_end(&stream));
+}
+
+END_TEST_SUITE(utf8_checker_ut)
\ No newline at end of file
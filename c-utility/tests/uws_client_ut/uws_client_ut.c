@@ -420,6 +420,31 @@ extern "C" {
         return real_BUFFER_new();
     }
 
+    /* a masked header with a zero masking key, enough for the small payloads of the tests */
+    int my_uws_frame_encoder_encode_header(unsigned char* header, size_t header_size, WS_FRAME_TYPE opcode, size_t length, UWS_FRAME_MASK_GENERATOR* mask_generator, bool is_final, unsigned char reserved, size_t* header_length)
+    {
+        (void)header_size;
+        (void)mask_generator;
+        header[0] = (unsigned char)((is_final ? 0x80 : 0x00) | (reserved << 4) | opcode);
+        header[1] = (unsigned char)(0x80 | length);
+        header[2] = 0x00;
+        header[3] = 0x00;
+        header[4] = 0x00;
+        header[5] = 0x00;
+        *header_length = 6;
+        return 0;
+    }
+
+    int my_uws_frame_encoder_mask(unsigned char* destination, const unsigned char* source, size_t length, const unsigned char* mask_key)
+    {
+        size_t i;
+        for (i = 0; i < length; i++)
+        {
+            destination[i] = source[i] ^ mask_key[i % 4];
+        }
+        return 0;
+    }
+
 #ifdef __cplusplus
 }
 #endif
@@ -468,6 +493,8 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_RETURN(xio_create, TEST_IO_HANDLE);
     REGISTER_GLOBAL_MOCK_RETURN(xio_retrieveoptions, TEST_IO_OPTIONHANDLER_HANDLE);
     REGISTER_GLOBAL_MOCK_RETURN(utf8_checker_is_valid_utf8, true);
+    REGISTER_GLOBAL_MOCK_RETURN(utf8_checker_stream_feed, true);
+    REGISTER_GLOBAL_MOCK_RETURN(utf8_checker_stream_end, true);
     REGISTER_GLOBAL_MOCK_RETURN(Base64_Encode_Bytes, BASE64_ENCODED_STRING);
     REGISTER_GLOBAL_MOCK_RETURN(OptionHandler_FeedOptions, OPTIONHANDLER_OK);
     REGISTER_GLOBAL_MOCK_RETURN(OptionHandler_AddOption, OPTIONHANDLER_OK);
@@ -477,6 +504,8 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_HOOK(BUFFER_u_char, real_BUFFER_u_char);
     REGISTER_GLOBAL_MOCK_HOOK(BUFFER_length, real_BUFFER_length);
     REGISTER_GLOBAL_MOCK_HOOK(uws_frame_encoder_encode, my_uws_frame_encoder_encode);
+    REGISTER_GLOBAL_MOCK_HOOK(uws_frame_encoder_encode_header, my_uws_frame_encoder_encode_header);
+    REGISTER_GLOBAL_MOCK_HOOK(uws_frame_encoder_mask, my_uws_frame_encoder_mask);
     REGISTER_GLOBAL_MOCK_RETURN(STRING_c_str, "test_str");
     REGISTER_TYPE(IO_OPEN_RESULT, IO_OPEN_RESULT);
     REGISTER_TYPE(IO_SEND_RESULT, IO_SEND_RESULT);
@@ -500,6 +529,7 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_UMOCK_ALIAS_TYPE(UWS_FRAME_DECODER_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(ON_WS_FRAME_DECODED, void*);
     REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(UWS_FRAME_MASK_GENERATOR*, void*);
     REGISTER_UMOCK_ALIAS_TYPE(OPTIONHANDLER_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(pfCloneOption, void*);
@@ -2268,7 +2298,7 @@ TEST_FUNCTION(uws_client_close_async_with_2_pending_send_frames_indicates_the_fr
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
-    (void)uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_frame_1, sizeof(test_frame_2), true, test_on_ws_send_frame_complete, (void*)0x4248);
+    (void)uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_frame_1, sizeof(test_frame_1), true, test_on_ws_send_frame_complete, (void*)0x4248);
     (void)uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_TEXT, test_frame_2, sizeof(test_frame_2), true, test_on_ws_send_frame_complete, (void*)0x4249);
     umock_c_reset_all_calls();
 
@@ -3770,6 +3800,7 @@ TEST_FUNCTION(when_1_extra_byte_is_received_the_open_complete_is_properly_indica
 
     EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(test_on_ws_open_complete((void*)0x4242, WS_OPEN_OK));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
@@ -3813,7 +3844,6 @@ TEST_FUNCTION(when_a_1_byte_binary_frame_is_received_it_shall_be_indicated_to_th
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 1))
         .ValidateArgumentBuffer(3, expected_payload, sizeof(expected_payload));
 
@@ -3850,7 +3880,8 @@ TEST_FUNCTION(when_a_1_byte_text_frame_is_received_it_shall_be_indicated_to_the_
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(utf8_checker_is_valid_utf8(IGNORED_PTR_ARG, 1))
+        .ValidateArgumentBuffer(1, "a", 1);
     STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_TEXT, IGNORED_PTR_ARG, 1))
         .ValidateArgumentBuffer(3, expected_payload, sizeof(expected_payload));
 
@@ -3884,7 +3915,6 @@ TEST_FUNCTION(when_a_0_bytes_binary_frame_is_received_it_shall_be_indicated_to_t
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 0))
         .IgnoreArgument_buffer();
 
@@ -3918,7 +3948,6 @@ TEST_FUNCTION(when_a_0_bytes_text_frame_is_received_it_shall_be_indicated_to_the
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_TEXT, IGNORED_PTR_ARG, 0))
         .IgnoreArgument_buffer();
 
@@ -3959,7 +3988,6 @@ TEST_FUNCTION(when_a_125_bytes_binary_frame_is_received_it_shall_be_indicated_to
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 125))
         .ValidateArgumentBuffer(3, &test_frame[2], 125);
 
@@ -3998,7 +4026,6 @@ TEST_FUNCTION(when_a_126_bytes_binary_frame_is_received_it_shall_be_indicated_to
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 126))
         .ValidateArgumentBuffer(3, &test_frame[4], 126);
 
@@ -4037,7 +4064,6 @@ TEST_FUNCTION(when_a_127_bytes_binary_frame_is_received_it_shall_be_indicated_to
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 127))
         .ValidateArgumentBuffer(3, &test_frame[4], 127);
 
@@ -4080,7 +4106,6 @@ TEST_FUNCTION(when_a_65535_bytes_binary_frame_is_received_it_shall_be_indicated_
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 65535))
         .ValidateArgumentBuffer(3, &test_frame[4], 65535);
 
@@ -4130,7 +4155,6 @@ TEST_FUNCTION(when_a_65536_bytes_binary_frame_is_received_it_shall_be_indicated_
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 65536))
         .ValidateArgumentBuffer(3, &test_frame[10], 65536);
 
@@ -4180,7 +4204,6 @@ TEST_FUNCTION(when_a_65537_bytes_binary_frame_is_received_it_shall_be_indicated_
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 65537))
         .ValidateArgumentBuffer(3, &test_frame[10], 65537);
 
@@ -4214,7 +4237,6 @@ TEST_FUNCTION(when_a_0_byte_binary_frame_is_received_with_16_bit_length_an_error
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
 
     // act
@@ -4252,7 +4274,6 @@ TEST_FUNCTION(when_a_125_byte_binary_frame_is_received_with_16_bit_length_an_err
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
 
     // act
@@ -4284,7 +4305,6 @@ TEST_FUNCTION(when_a_0_byte_binary_frame_is_received_with_64_bit_length_an_error
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
 
     // act
@@ -4332,7 +4352,6 @@ TEST_FUNCTION(when_a_65535_byte_binary_frame_is_received_with_64_bit_length_an_e
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
 
     // act
@@ -4365,7 +4384,6 @@ TEST_FUNCTION(check_for_16_bit_length_too_low_is_done_as_soon_as_length_is_recei
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
 
     // act
@@ -4397,7 +4415,6 @@ TEST_FUNCTION(check_for_64_bit_length_too_low_is_done_as_soon_as_length_is_recei
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
 
     // act
@@ -4445,7 +4462,6 @@ TEST_FUNCTION(when_the_highest_bit_is_set_in_a_64_bit_length_frame_an_error_is_i
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
 
     // act
@@ -4466,7 +4482,7 @@ TEST_FUNCTION(when_allocating_memory_for_the_received_frame_bytes_fails_an_error
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char test_frame[] = { 0x82, 0x00 };
+    unsigned char test_frame[] = { 0x82, 0x7D, 0x42 };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -4477,7 +4493,7 @@ TEST_FUNCTION(when_allocating_memory_for_the_received_frame_bytes_fails_an_error
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 127))
         .SetReturn(NULL);
     STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_NOT_ENOUGH_MEMORY));
 
@@ -4513,7 +4529,6 @@ TEST_FUNCTION(when_1_byte_is_received_together_with_the_upgrade_request_and_one_
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)upgrade_response_frame, sizeof(test_upgrade_response));
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 0))
         .IgnoreArgument_buffer();
 
@@ -4554,6 +4569,7 @@ TEST_FUNCTION(when_a_complete_frame_is_received_together_with_the_upgrade_reques
     STRICT_EXPECTED_CALL(test_on_ws_open_complete((void*)0x4242, WS_OPEN_OK));
     STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 0))
         .IgnoreArgument_buffer();
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)received_data, received_data_length);
@@ -4594,6 +4610,7 @@ TEST_FUNCTION(when_a_1_byte_complete_frame_is_received_together_with_the_upgrade
     STRICT_EXPECTED_CALL(test_on_ws_open_complete((void*)0x4242, WS_OPEN_OK));
     STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, expected_frame_payload, sizeof(expected_frame_payload)))
         .ValidateArgumentBuffer(3, expected_frame_payload, sizeof(expected_frame_payload));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)received_data, received_data_length);
@@ -4633,10 +4650,13 @@ TEST_FUNCTION(when_2_complete_frames_are_received_together_with_the_upgrade_requ
 
     EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(test_on_ws_open_complete((void*)0x4242, WS_OPEN_OK));
+    STRICT_EXPECTED_CALL(utf8_checker_is_valid_utf8(IGNORED_PTR_ARG, 1))
+        .ValidateArgumentBuffer(1, "a", 1);
     STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_TEXT, IGNORED_PTR_ARG, 1))
         .ValidateArgumentBuffer(3, "a", 1);
     STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 0))
         .IgnoreArgument_buffer();
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)received_data, received_data_length);
@@ -4649,6 +4669,313 @@ TEST_FUNCTION(when_2_complete_frames_are_received_together_with_the_upgrade_requ
     free(received_data);
 }
 
+/* Tests_SRS_UWS_CLIENT_99_003: [ A frame that is whole in the bytes received from the underlying IO shall be decoded in place, without copying it. ]*/
+TEST_FUNCTION(when_3_complete_frames_are_received_in_one_call_they_are_indicated_from_the_received_bytes)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    unsigned char test_frames[] = { 0x82, 0x01, 0x42, 0x82, 0x00, 0x82, 0x02, 0x43, 0x44 };
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, &test_frames[2], 1));
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, &test_frames[5], 0));
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, &test_frames[7], 2));
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, test_frames, sizeof(test_frames));
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_99_004: [ A frame that is not complete in the received bytes shall be kept in a receive buffer that is grown to the size of the frame once its header is known, only the bytes the frame still needs shall be copied into it. ]*/
+TEST_FUNCTION(a_frame_split_over_3_calls_is_indicated_once_whole_and_the_frame_after_it_is_decoded_in_place)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    unsigned char test_frame[4 + 200 + 3];
+    size_t i;
+
+    test_frame[0] = 0x82;
+    test_frame[1] = 0x7E;
+    test_frame[2] = 0x00;
+    test_frame[3] = 200;
+    for (i = 0; i < 200; i++)
+    {
+        test_frame[4 + i] = (unsigned char)i;
+    }
+    test_frame[204] = 0x82;
+    test_frame[205] = 0x01;
+    test_frame[206] = 0x42;
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 204));
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 200))
+        .ValidateArgumentBuffer(3, &test_frame[4], 200);
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, &test_frame[206], 1));
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, test_frame, 3);
+    g_on_bytes_received(g_on_bytes_received_context, test_frame + 3, 100);
+    g_on_bytes_received(g_on_bytes_received_context, test_frame + 103, sizeof(test_frame) - 103);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_99_005: [ Once a frame has been decoded, a receive buffer larger than 64 KiB shall be freed, smaller ones shall be kept for the next frames. ]*/
+TEST_FUNCTION(a_receive_buffer_larger_than_64KiB_is_freed_once_the_frame_is_indicated)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    unsigned char* test_frame = (unsigned char*)malloc(65537 + 10);
+    size_t i;
+    test_frame[0] = 0x82;
+    test_frame[1] = 0x7F;
+    test_frame[2] = 0x00;
+    test_frame[3] = 0x00;
+    test_frame[4] = 0x00;
+    test_frame[5] = 0x00;
+    test_frame[6] = 0x00;
+    test_frame[7] = 0x01;
+    test_frame[8] = 0x00;
+    test_frame[9] = 0x01;
+
+    for (i = 0; i < 65537; i++)
+    {
+        test_frame[10 + i] = (unsigned char)i;
+    }
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 65537 + 10));
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 65537))
+        .ValidateArgumentBuffer(3, &test_frame[10], 65537);
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, test_frame, 1000);
+    g_on_bytes_received(g_on_bytes_received_context, test_frame + 1000, 65537 + 10 - 1000);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    free(test_frame);
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_99_007: [ The payload of a text frame that arrives in pieces shall be validated with `utf8_checker_stream_feed` as each piece arrives. ]*/
+TEST_FUNCTION(the_payload_of_a_split_text_frame_is_validated_as_each_piece_arrives)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    unsigned char test_frame[] = { 0x81, 0x04, 'a', 'b', 'c', 'd' };
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(utf8_checker_stream_init(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(utf8_checker_stream_feed(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1))
+        .ValidateArgumentBuffer(2, "a", 1);
+    STRICT_EXPECTED_CALL(utf8_checker_stream_feed(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 3))
+        .ValidateArgumentBuffer(2, "bcd", 3);
+    STRICT_EXPECTED_CALL(utf8_checker_stream_end(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_TEXT, IGNORED_PTR_ARG, 4))
+        .ValidateArgumentBuffer(3, "abcd", 4);
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, test_frame, 3);
+    g_on_bytes_received(g_on_bytes_received_context, test_frame + 3, sizeof(test_frame) - 3);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_99_009: [ The payloads of the text frame and of the continuation frames of a fragmented text message shall be validated as one text with `utf8_checker_stream_feed`, `utf8_checker_stream_end` shall be called once the frame with the FIN bit set has arrived. ]*/
+TEST_FUNCTION(a_character_split_between_a_text_frame_and_a_continuation_frame_is_validated_as_one_text)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    /* U+20AC is E2 82 AC, the first 2 bytes end the text frame, the last one is the continuation frame */
+    unsigned char test_frames[] = { 0x01, 0x03, 'a', 0xE2, 0x82, 0x80, 0x01, 0xAC };
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(utf8_checker_stream_init(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(utf8_checker_stream_feed(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 3))
+        .ValidateArgumentBuffer(2, &test_frames[2], 3);
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_TEXT, IGNORED_PTR_ARG, 3))
+        .ValidateArgumentBuffer(3, &test_frames[2], 3);
+    STRICT_EXPECTED_CALL(utf8_checker_stream_feed(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1))
+        .ValidateArgumentBuffer(2, &test_frames[7], 1);
+    STRICT_EXPECTED_CALL(utf8_checker_stream_end(IGNORED_PTR_ARG));
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, test_frames, sizeof(test_frames));
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_99_006: [ The payload of a text frame with the FIN bit set that is received whole shall be validated with `utf8_checker_is_valid_utf8` before it is indicated. ]*/
+/* Tests_SRS_UWS_CLIENT_99_008: [ If the payload of a text frame is not valid UTF-8, uws shall fail the WebSocket connection by calling `on_ws_error` with `WS_ERROR_BAD_FRAME_RECEIVED` and closing with status code 1007. ]*/
+TEST_FUNCTION(when_a_text_frame_is_not_valid_UTF8_the_connection_is_failed_with_1007)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    unsigned char test_frame[] = { 0x81, 0x01, 0xDF };
+    unsigned char close_frame_payload[] = { 0x03, 0xEF };
+    unsigned char close_frame[] = { 0x88, 0x82, 0x00, 0x00, 0x00, 0x00, 0x03, 0xEF };
+    BUFFER_HANDLE buffer_handle;
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(utf8_checker_is_valid_utf8(IGNORED_PTR_ARG, 1))
+        .ValidateArgumentBuffer(1, &test_frame[2], 1)
+        .SetReturn(false);
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, IGNORED_PTR_ARG, sizeof(close_frame_payload), true, true, 0))
+        .ValidateArgumentBuffer(2, close_frame_payload, sizeof(close_frame_payload))
+        .CaptureReturn(&buffer_handle);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(close_frame);
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(sizeof(close_frame));
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, close_frame, sizeof(close_frame), IGNORED_PTR_ARG, NULL))
+        .ValidateArgumentBuffer(2, close_frame, sizeof(close_frame));
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle);
+    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_99_008: [ If the payload of a text frame is not valid UTF-8, uws shall fail the WebSocket connection by calling `on_ws_error` with `WS_ERROR_BAD_FRAME_RECEIVED` and closing with status code 1007. ]*/
+TEST_FUNCTION(when_a_piece_of_a_split_text_frame_is_not_valid_UTF8_the_connection_is_failed_without_waiting_for_the_rest)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    unsigned char test_frame[] = { 0x81, 0x04, 0xFF, 'b', 'c', 'd' };
+    unsigned char close_frame_payload[] = { 0x03, 0xEF };
+    unsigned char close_frame[] = { 0x88, 0x82, 0x00, 0x00, 0x00, 0x00, 0x03, 0xEF };
+    BUFFER_HANDLE buffer_handle;
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(utf8_checker_stream_init(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(utf8_checker_stream_feed(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1))
+        .SetReturn(false);
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, IGNORED_PTR_ARG, sizeof(close_frame_payload), true, true, 0))
+        .ValidateArgumentBuffer(2, close_frame_payload, sizeof(close_frame_payload))
+        .CaptureReturn(&buffer_handle);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(close_frame);
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(sizeof(close_frame));
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, close_frame, sizeof(close_frame), IGNORED_PTR_ARG, NULL))
+        .ValidateArgumentBuffer(2, close_frame, sizeof(close_frame));
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle);
+    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, test_frame, 3);
+    g_on_bytes_received(g_on_bytes_received_context, test_frame + 3, sizeof(test_frame) - 3);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
 /* Tests_SRS_UWS_CLIENT_01_144: [ A client MUST close a connection if it detects a masked frame. ]*/
 /* Tests_SRS_UWS_CLIENT_01_145: [ In this case, it MAY use the status code 1002 (protocol error) as defined in Section 7.4.1. (These rules might be relaxed in a future specification.) ]*/
 /* Tests_SRS_UWS_CLIENT_01_160: [ Defines whether the "Payload data" is masked. ]*/
@@ -4673,7 +5000,6 @@ TEST_FUNCTION(when_a_masked_frame_is_received_an_error_is_indicated_and_connecti
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, IGNORED_PTR_ARG, sizeof(close_frame_payload), true, true, 0))
         .ValidateArgumentBuffer(2, close_frame_payload, sizeof(close_frame_payload))
         .CaptureReturn(&buffer_handle);
@@ -4725,7 +5051,6 @@ TEST_FUNCTION(when_a_masked_frame_is_received_and_encoding_the_close_frame_fails
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, IGNORED_PTR_ARG, sizeof(close_frame_payload), true, true, 0))
         .ValidateArgumentBuffer(2, close_frame_payload, sizeof(close_frame_payload))
         .SetReturn(NULL);
@@ -4765,7 +5090,6 @@ TEST_FUNCTION(when_a_masked_frame_is_received_and_sending_the_encoded_CLOSE_fram
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, IGNORED_PTR_ARG, sizeof(close_frame_payload), true, true, 0))
         .ValidateArgumentBuffer(2, close_frame_payload, sizeof(close_frame_payload))
         .CaptureReturn(&buffer_handle);
@@ -4823,7 +5147,6 @@ TEST_FUNCTION(when_a_CLOSE_frame_is_received_while_in_open_the_code_is_reported_
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0))
         .CaptureReturn(&buffer_handle);
     STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
@@ -4876,7 +5199,6 @@ TEST_FUNCTION(when_a_CLOSE_frame_is_received_without_a_close_code_while_in_open_
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0))
         .CaptureReturn(&buffer_handle);
     STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
@@ -4927,7 +5249,6 @@ TEST_FUNCTION(when_a_CLOSE_frame_is_received_with_extra_bytes_the_bytes_are_pass
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(utf8_checker_is_valid_utf8(IGNORED_PTR_ARG, 2))
         .ValidateArgumentBuffer(1, &close_frame[4], 2);
     STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0))
@@ -4977,7 +5298,6 @@ TEST_FUNCTION(when_a_CLOSE_frame_is_received_with_a_malformed_UTF8_text_the_conn
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(utf8_checker_is_valid_utf8(IGNORED_PTR_ARG, 1))
         .ValidateArgumentBuffer(1, &close_frame[4], 1)
         .SetReturn(false);
@@ -5018,7 +5338,6 @@ TEST_FUNCTION(when_a_CLOSE_frame_is_received_while_in_open_and_encoding_the_outg
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0))
         .SetReturn(NULL);
     STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
@@ -5060,7 +5379,6 @@ TEST_FUNCTION(when_a_CLOSE_frame_is_received_while_in_open_and_sending_the_outgo
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0))
         .CaptureReturn(&buffer_handle);
     STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
@@ -5260,9 +5578,9 @@ TEST_FUNCTION(uws_client_send_frame_async_when_waiting_for_upgrade_response_fail
 /* Tests_SRS_UWS_CLIENT_01_040: [ - the send complete callback `on_ws_send_frame_complete` ]*/
 /* Tests_SRS_UWS_CLIENT_01_056: [ - the `send_complete` callback shall be the `on_underlying_io_send_complete` function. ]*/
 /* Tests_SRS_UWS_CLIENT_01_042: [ On success, `uws_client_send_frame_async` shall return 0. ]*/
-/* Tests_SRS_UWS_CLIENT_01_425: [ Encoding shall be done by calling `uws_frame_encoder_encode` and passing to it the `buffer` and `size` argument for payload, the `is_final` flag and setting `is_masked` to true. ]*/
-/* Tests_SRS_UWS_CLIENT_01_428: [ The encoded frame buffer memory shall be obtained by calling `BUFFER_u_char` on the encode buffer. ]*/
-/* Tests_SRS_UWS_CLIENT_01_429: [ The encoded frame size shall be obtained by calling `BUFFER_length` on the encode buffer. ]*/
+/* Tests_SRS_UWS_CLIENT_01_425: [ Encoding shall be done by calling `uws_frame_encoder_encode_header` with the `size` argument as payload length, the `is_final` flag and the mask generator of the uws instance, so that the frame is masked. ]*/
+/* Tests_SRS_UWS_CLIENT_01_428: [ The frame shall be encoded in a send buffer owned by the uws instance, which shall be grown with `realloc` when the frame does not fit in it. ]*/
+/* Tests_SRS_UWS_CLIENT_99_001: [ The payload shall be masked with the masking key that ends the header while it is copied after the header, by calling `uws_frame_encoder_mask`. ]*/
 /* Tests_SRS_UWS_CLIENT_01_048: [ Queueing shall be done by calling `singlylinkedlist_add`. ]*/
 /* Tests_SRS_UWS_CLIENT_01_038: [ `uws_client_send_frame_async` shall create and queue a structure that contains: ]*/
 /* Tests_SRS_UWS_CLIENT_01_040: [ - the send complete callback `on_ws_send_frame_complete` ]*/
@@ -5279,9 +5597,8 @@ TEST_FUNCTION(uws_client_send_frame_async_succeeds)
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
     unsigned char test_payload[] = { 0x42 };
-    unsigned char encoded_frame[] = { 0x82, 0x01, 0x00, 0x00, 0x00, 0x00, 0x42 };
+    unsigned char encoded_frame[] = { 0x82, 0x81, 0x00, 0x00, 0x00, 0x00, 0x42 };
     int result;
-    BUFFER_HANDLE buffer_handle;
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -5293,22 +5610,15 @@ TEST_FUNCTION(uws_client_send_frame_async_succeeds)
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_BINARY_FRAME, test_payload, sizeof(test_payload), true, true, 0))
-        .CaptureReturn(&buffer_handle);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(encoded_frame);
-    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sizeof(encoded_frame));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode_header(IGNORED_PTR_ARG, UWS_FRAME_ENCODER_MAX_HEADER_SIZE, WS_BINARY_FRAME, sizeof(test_payload), IGNORED_PTR_ARG, true, 0, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_realloc(NULL, sizeof(encoded_frame)));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_mask(IGNORED_PTR_ARG, test_payload, sizeof(test_payload), IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
         .IgnoreArgument_item();
     STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, IGNORED_PTR_ARG, sizeof(encoded_frame), IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreArgument_on_send_complete()
         .IgnoreArgument_callback_context()
         .ValidateArgumentBuffer(2, encoded_frame, sizeof(encoded_frame));
-    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle);
 
     // act
     result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
@@ -5329,9 +5639,8 @@ TEST_FUNCTION(uws_send_text_frame_succeeds)
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
     unsigned char test_payload[] = { 'a' };
-    unsigned char encoded_frame[] = { 0x82, 0x01, 0x00, 0x00, 0x00, 0x00, 'a' };
+    unsigned char encoded_frame[] = { 0x81, 0x81, 0x00, 0x00, 0x00, 0x00, 'a' };
     int result;
-    BUFFER_HANDLE buffer_handle;
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -5343,22 +5652,15 @@ TEST_FUNCTION(uws_send_text_frame_succeeds)
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_TEXT_FRAME, test_payload, sizeof(test_payload), true, true, 0))
-        .CaptureReturn(&buffer_handle);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(encoded_frame);
-    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sizeof(encoded_frame));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode_header(IGNORED_PTR_ARG, UWS_FRAME_ENCODER_MAX_HEADER_SIZE, WS_TEXT_FRAME, sizeof(test_payload), IGNORED_PTR_ARG, true, 0, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_realloc(NULL, sizeof(encoded_frame)));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_mask(IGNORED_PTR_ARG, test_payload, sizeof(test_payload), IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
         .IgnoreArgument_item();
     STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, IGNORED_PTR_ARG, sizeof(encoded_frame), IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreArgument_on_send_complete()
         .IgnoreArgument_callback_context()
         .ValidateArgumentBuffer(2, encoded_frame, sizeof(encoded_frame));
-    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle);
 
     // act
     result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_TEXT, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
@@ -5404,7 +5706,7 @@ TEST_FUNCTION(when_allocating_memory_for_the_new_sent_item_fails_uws_client_send
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_426: [ If `uws_frame_encoder_encode` fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
+/* Tests_SRS_UWS_CLIENT_01_426: [ If `uws_frame_encoder_encode_header` fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
 TEST_FUNCTION(when_encoding_the_frame_fails_uws_client_send_frame_async_fails)
 {
     // arrange
@@ -5424,8 +5726,8 @@ TEST_FUNCTION(when_encoding_the_frame_fails_uws_client_send_frame_async_fails)
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_BINARY_FRAME, test_payload, sizeof(test_payload), true, true, 0))
-        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode_header(IGNORED_PTR_ARG, UWS_FRAME_ENCODER_MAX_HEADER_SIZE, WS_BINARY_FRAME, sizeof(test_payload), IGNORED_PTR_ARG, true, 0, IGNORED_PTR_ARG))
+        .SetReturn(1);
     EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
@@ -5448,7 +5750,7 @@ TEST_FUNCTION(when_xio_send_fails_uws_client_send_frame_async_fails)
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
     unsigned char test_payload[] = { 0x42 };
-    unsigned char encoded_frame[] = { 0x82, 0x01, 0x00, 0x00, 0x00, 0x00, 0x42 };
+    unsigned char encoded_frame[] = { 0x82, 0x81, 0x00, 0x00, 0x00, 0x00, 0x42 };
     int result;
     BUFFER_HANDLE buffer_handle;
     LIST_ITEM_HANDLE new_item_handle;
@@ -5467,14 +5769,9 @@ TEST_FUNCTION(when_xio_send_fails_uws_client_send_frame_async_fails)
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_BINARY_FRAME, test_payload, sizeof(test_payload), true, true, 0))
-        .CaptureReturn(&buffer_handle);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(encoded_frame);
-    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sizeof(encoded_frame));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode_header(IGNORED_PTR_ARG, UWS_FRAME_ENCODER_MAX_HEADER_SIZE, WS_BINARY_FRAME, sizeof(test_payload), IGNORED_PTR_ARG, true, 0, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_realloc(NULL, sizeof(encoded_frame)));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_mask(IGNORED_PTR_ARG, test_payload, sizeof(test_payload), IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
         .IgnoreArgument_item()
         .CaptureReturn(&new_item_handle);
@@ -5488,8 +5785,6 @@ TEST_FUNCTION(when_xio_send_fails_uws_client_send_frame_async_fails)
     STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
         .ValidateArgumentValue_item_handle(&new_item_handle);
     EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle);
 
     // act
     result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
@@ -5510,7 +5805,7 @@ TEST_FUNCTION(when_xio_send_fails_uws_client_send_frame_async_fails_message_remo
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
     unsigned char test_payload[] = { 0x42 };
-    unsigned char encoded_frame[] = { 0x82, 0x01, 0x00, 0x00, 0x00, 0x00, 0x42 };
+    unsigned char encoded_frame[] = { 0x82, 0x81, 0x00, 0x00, 0x00, 0x00, 0x42 };
     int result;
     BUFFER_HANDLE buffer_handle;
     LIST_ITEM_HANDLE new_item_handle;
@@ -5529,14 +5824,9 @@ TEST_FUNCTION(when_xio_send_fails_uws_client_send_frame_async_fails_message_remo
     umock_c_reset_all_calls();
 
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_BINARY_FRAME, test_payload, sizeof(test_payload), true, true, 0))
-        .CaptureReturn(&buffer_handle);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(encoded_frame);
-    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sizeof(encoded_frame));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode_header(IGNORED_PTR_ARG, UWS_FRAME_ENCODER_MAX_HEADER_SIZE, WS_BINARY_FRAME, sizeof(test_payload), IGNORED_PTR_ARG, true, 0, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_realloc(NULL, sizeof(encoded_frame)));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_mask(IGNORED_PTR_ARG, test_payload, sizeof(test_payload), IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
         .IgnoreArgument_item()
         .CaptureReturn(&new_item_handle);
@@ -5546,8 +5836,6 @@ TEST_FUNCTION(when_xio_send_fails_uws_client_send_frame_async_fails_message_remo
         .ValidateArgumentBuffer(2, encoded_frame, sizeof(encoded_frame));
     STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .SetReturn(NULL);
-    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle);
 
     // section for on_io_send_complete()
     g_xio_send_result = 1;
@@ -5576,9 +5864,8 @@ TEST_FUNCTION(when_adding_the_item_to_the_list_fails_uws_client_send_frame_async
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
     unsigned char test_payload[] = { 0x42 };
-    unsigned char encoded_frame[] = { 0x82, 0x01, 0x00, 0x00, 0x00, 0x00, 0x42 };
+    unsigned char encoded_frame[] = { 0x82, 0x81, 0x00, 0x00, 0x00, 0x00, 0x42 };
     int result;
-    BUFFER_HANDLE buffer_handle;
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -5590,20 +5877,13 @@ TEST_FUNCTION(when_adding_the_item_to_the_list_fails_uws_client_send_frame_async
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_BINARY_FRAME, test_payload, sizeof(test_payload), true, true, 0))
-        .CaptureReturn(&buffer_handle);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(encoded_frame);
-    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sizeof(encoded_frame));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode_header(IGNORED_PTR_ARG, UWS_FRAME_ENCODER_MAX_HEADER_SIZE, WS_BINARY_FRAME, sizeof(test_payload), IGNORED_PTR_ARG, true, 0, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_realloc(NULL, sizeof(encoded_frame)));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_mask(IGNORED_PTR_ARG, test_payload, sizeof(test_payload), IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
         .IgnoreArgument_item()
         .SetReturn(NULL);
     EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle);
 
     // act
     result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
@@ -5624,9 +5904,8 @@ TEST_FUNCTION(uws_client_send_frame_async_with_NULL_complete_callback_succeeds)
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
     unsigned char test_payload[] = { 0x42 };
-    unsigned char encoded_frame[] = { 0x82, 0x01, 0x00, 0x00, 0x00, 0x00, 0x42 };
+    unsigned char encoded_frame[] = { 0x82, 0x81, 0x00, 0x00, 0x00, 0x00, 0x42 };
     int result;
-    BUFFER_HANDLE buffer_handle;
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -5638,22 +5917,15 @@ TEST_FUNCTION(uws_client_send_frame_async_with_NULL_complete_callback_succeeds)
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_BINARY_FRAME, test_payload, sizeof(test_payload), true, true, 0))
-        .CaptureReturn(&buffer_handle);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(encoded_frame);
-    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sizeof(encoded_frame));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode_header(IGNORED_PTR_ARG, UWS_FRAME_ENCODER_MAX_HEADER_SIZE, WS_BINARY_FRAME, sizeof(test_payload), IGNORED_PTR_ARG, true, 0, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_realloc(NULL, sizeof(encoded_frame)));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_mask(IGNORED_PTR_ARG, test_payload, sizeof(test_payload), IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
         .IgnoreArgument_item();
     STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, IGNORED_PTR_ARG, sizeof(encoded_frame), IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreArgument_on_send_complete()
         .IgnoreArgument_callback_context()
         .ValidateArgumentBuffer(2, encoded_frame, sizeof(encoded_frame));
-    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle);
 
     // act
     result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, NULL, NULL);
@@ -5666,6 +5938,109 @@ TEST_FUNCTION(uws_client_send_frame_async_with_NULL_complete_callback_succeeds)
     uws_client_destroy(uws_client);
 }
 
+/* Tests_SRS_UWS_CLIENT_01_429: [ If growing the send buffer fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(when_growing_the_send_buffer_fails_uws_client_send_frame_async_fails)
+{
+    // arrange
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    unsigned char test_payload[] = { 0x42 };
+    int result;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode_header(IGNORED_PTR_ARG, UWS_FRAME_ENCODER_MAX_HEADER_SIZE, WS_BINARY_FRAME, sizeof(test_payload), IGNORED_PTR_ARG, true, 0, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_realloc(NULL, 7))
+        .SetReturn(NULL);
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_428: [ The frame shall be encoded in a send buffer owned by the uws instance, which shall be grown with `realloc` when the frame does not fit in it. ]*/
+TEST_FUNCTION(uws_client_send_frame_async_reuses_the_send_buffer_for_a_frame_that_fits)
+{
+    // arrange
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    unsigned char test_payload[] = { 0x42, 0x43 };
+    unsigned char encoded_frame[] = { 0x82, 0x81, 0x00, 0x00, 0x00, 0x00, 0x43 };
+    int result;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
+    (void)uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode_header(IGNORED_PTR_ARG, UWS_FRAME_ENCODER_MAX_HEADER_SIZE, WS_BINARY_FRAME, 1, IGNORED_PTR_ARG, true, 0, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_mask(IGNORED_PTR_ARG, test_payload + 1, 1, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, IGNORED_PTR_ARG, sizeof(encoded_frame), IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .ValidateArgumentBuffer(2, encoded_frame, sizeof(encoded_frame));
+
+    // act
+    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload + 1, 1, true, test_on_ws_send_frame_complete, (void*)0x4248);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_99_002: [ If the send buffer is larger than 64 KiB after the frame was sent, it shall be freed. ]*/
+TEST_FUNCTION(uws_client_send_frame_async_frees_a_send_buffer_larger_than_64_KiB)
+{
+    // arrange
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    unsigned char* test_payload = (unsigned char*)my_gballoc_malloc(64 * 1024);
+    int result;
+
+    (void)memset(test_payload, 0x42, 64 * 1024);
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode_header(IGNORED_PTR_ARG, UWS_FRAME_ENCODER_MAX_HEADER_SIZE, WS_BINARY_FRAME, 64 * 1024, IGNORED_PTR_ARG, true, 0, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_realloc(NULL, 6 + 64 * 1024));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_mask(IGNORED_PTR_ARG, test_payload, 64 * 1024, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, IGNORED_PTR_ARG, 6 + 64 * 1024, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, 64 * 1024, true, test_on_ws_send_frame_complete, (void*)0x4248);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+    my_gballoc_free(test_payload);
+}
+
 /* on_underlying_io_send_complete */
 
 /* Tests_SRS_UWS_CLIENT_01_389: [ When `on_underlying_io_send_complete` is called with `IO_SEND_OK` as a result of sending a WebSocket frame to the underlying IO, the send shall be indicated to the uws user by calling `on_ws_send_frame_complete` with `WS_SEND_FRAME_OK`. ]*/
@@ -6380,7 +6755,6 @@ TEST_FUNCTION(when_a_PING_frame_was_received_a_PONG_frame_is_sent)
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_PONG_FRAME, IGNORED_PTR_ARG, 0, true, true, 0))
         .IgnoreArgument_payload()
         .CaptureReturn(&buffer_handle);
@@ -6431,7 +6805,6 @@ TEST_FUNCTION(when_a_PING_frame_was_received_with_some_payload_a_PONG_frame_is_s
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_PONG_FRAME, pong_frame_payload, sizeof(pong_frame_payload), true, true, 0))
         .ValidateArgumentBuffer(2, pong_frame_payload, sizeof(pong_frame_payload))
         .CaptureReturn(&buffer_handle);
@@ -6477,7 +6850,6 @@ TEST_FUNCTION(when_a_PING_frame_is_received_after_a_close_frame_no_pong_is_sent)
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0))
         .CaptureReturn(&buffer_handle);
     STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
@@ -7006,7 +7378,6 @@ TEST_FUNCTION(underlying_io_close_after_a_send_close_frame_failed_puts_the_uws_i
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0))
         .SetReturn(NULL);
     STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
@@ -7058,7 +7429,6 @@ TEST_FUNCTION(underlying_io_close_due_to_CLOSE_frame_being_received_doe_not_trig
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0))
         .SetReturn(NULL);
     STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
@@ -7101,7 +7471,6 @@ TEST_FUNCTION(underlying_io_close_complete_with_NULL_context_does_nothing)
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0))
         .SetReturn(NULL);
     STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
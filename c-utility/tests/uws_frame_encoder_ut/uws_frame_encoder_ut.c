@@ -10,6 +10,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #endif
 
 #include "testrunnerswitcher.h"
@@ -1420,4 +1421,215 @@ TEST_FUNCTION(uws_frame_encoder_encode_masks_a_8_byte_frame_with_different_mask_
     real_BUFFER_delete(result);
 }
 
-END_TEST_SUITE(uws_frame_encoder_ut)
+
+/* Tests_SRS_UWS_FRAME_ENCODER_01_041: [ Octet i of the transformed data ("transformed-octet-i") is the XOR of octet i of the original data ("original-octet-i") with octet at index i modulo 4 of the masking key ("masking-key-octet-j"): ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_masks_a_frame_longer_than_the_word_and_vector_blocks)
+{
+    // arrange
+    BUFFER_HANDLE result;
+    unsigned char payload[101];
+    const unsigned char* encoded;
+    size_t i;
+
+    for (i = 0; i < sizeof(payload); i++)
+    {
+        payload[i] = (unsigned char)(i * 7);
+    }
+
+    STRICT_EXPECTED_CALL(BUFFER_new());
+    STRICT_EXPECTED_CALL(BUFFER_enlarge(IGNORED_PTR_ARG, 6 + sizeof(payload)));
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gb_rand())
+        .SetReturn(0x12);
+    STRICT_EXPECTED_CALL(gb_rand())
+        .SetReturn(0x34);
+    STRICT_EXPECTED_CALL(gb_rand())
+        .SetReturn(0x56);
+    STRICT_EXPECTED_CALL(gb_rand())
+        .SetReturn(0x78);
+
+    // act
+    result = uws_frame_encoder_encode(WS_BINARY_FRAME, payload, sizeof(payload), true, true, 0);
+
+    // assert
+    ASSERT_IS_NOT_NULL(result);
+    encoded = real_BUFFER_u_char(result);
+    ASSERT_ARE_EQUAL(size_t, 6 + sizeof(payload), real_BUFFER_length(result));
+    for (i = 0; i < sizeof(payload); i++)
+    {
+        ASSERT_ARE_EQUAL(int, (int)(payload[i] ^ encoded[2 + (i % 4)]), (int)encoded[6 + i]);
+    }
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    real_BUFFER_delete(result);
+}
+
+/* uws_frame_encoder_encode_header */
+
+/* Tests_SRS_UWS_FRAME_ENCODER_99_001: [ If `header` or `header_length` is NULL, `uws_frame_encoder_encode_header` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_header_with_NULL_arguments_fails)
+{
+    // arrange
+    unsigned char header[UWS_FRAME_ENCODER_MAX_HEADER_SIZE];
+    size_t header_length;
+
+    // act
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, uws_frame_encoder_encode_header(NULL, sizeof(header), WS_BINARY_FRAME, 1, NULL, true, 0, &header_length));
+    ASSERT_ARE_NOT_EQUAL(int, 0, uws_frame_encoder_encode_header(header, sizeof(header), WS_BINARY_FRAME, 1, NULL, true, 0, NULL));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_UWS_FRAME_ENCODER_99_002: [ If `reserved` has any bits set except the lowest 3 or `opcode` is greater than 0x0F, `uws_frame_encoder_encode_header` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_header_with_bad_reserved_or_opcode_fails)
+{
+    // arrange
+    unsigned char header[UWS_FRAME_ENCODER_MAX_HEADER_SIZE];
+    size_t header_length;
+
+    // act
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, uws_frame_encoder_encode_header(header, sizeof(header), WS_BINARY_FRAME, 1, NULL, true, 8, &header_length));
+    ASSERT_ARE_NOT_EQUAL(int, 0, uws_frame_encoder_encode_header(header, sizeof(header), (WS_FRAME_TYPE)0x10, 1, NULL, true, 0, &header_length));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_UWS_FRAME_ENCODER_99_003: [ If the header does not fit in `header_size` bytes, `uws_frame_encoder_encode_header` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_header_with_a_too_small_header_fails)
+{
+    // arrange
+    unsigned char header[UWS_FRAME_ENCODER_MAX_HEADER_SIZE];
+    UWS_FRAME_MASK_GENERATOR mask_generator;
+    size_t header_length;
+    (void)memset(&mask_generator, 0, sizeof(mask_generator));
+
+    // act
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, uws_frame_encoder_encode_header(header, 1, WS_BINARY_FRAME, 0, NULL, true, 0, &header_length));
+    ASSERT_ARE_NOT_EQUAL(int, 0, uws_frame_encoder_encode_header(header, 3, WS_BINARY_FRAME, 126, NULL, true, 0, &header_length));
+    ASSERT_ARE_NOT_EQUAL(int, 0, uws_frame_encoder_encode_header(header, 13, WS_BINARY_FRAME, 65536, &mask_generator, true, 0, &header_length));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_UWS_FRAME_ENCODER_99_004: [ `uws_frame_encoder_encode_header` shall write into `header` the RFC6455 header of a frame with `opcode`, `is_final`, `reserved` and a payload of `length` bytes, masked when `mask_generator` is not NULL, store the number of bytes written in `header_length` and return 0. ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_header_writes_the_unmasked_headers_of_every_length_class)
+{
+    // arrange
+    unsigned char header[UWS_FRAME_ENCODER_MAX_HEADER_SIZE];
+    size_t header_length;
+    unsigned char expected_short[] = { 0x81, 0x7D };
+    unsigned char expected_medium[] = { 0x02, 0x7E, 0xFF, 0xFF };
+    unsigned char expected_long[] = { 0xF8, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00 };
+
+    // act
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, uws_frame_encoder_encode_header(header, sizeof(header), WS_TEXT_FRAME, 125, NULL, true, 0, &header_length));
+    ASSERT_ARE_EQUAL(size_t, sizeof(expected_short), header_length);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(expected_short, header, header_length));
+
+    ASSERT_ARE_EQUAL(int, 0, uws_frame_encoder_encode_header(header, sizeof(header), WS_BINARY_FRAME, 65535, NULL, false, 0, &header_length));
+    ASSERT_ARE_EQUAL(size_t, sizeof(expected_medium), header_length);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(expected_medium, header, header_length));
+
+    ASSERT_ARE_EQUAL(int, 0, uws_frame_encoder_encode_header(header, sizeof(header), WS_CLOSE_FRAME, 65536, NULL, true, 7, &header_length));
+    ASSERT_ARE_EQUAL(size_t, sizeof(expected_long), header_length);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(expected_long, header, header_length));
+
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_UWS_FRAME_ENCODER_99_005: [ The masking key shall be the next value of `mask_generator` and take the last 4 bytes of the header. ]*/
+/* Tests_SRS_UWS_FRAME_ENCODER_99_006: [ A zeroed `mask_generator` shall be seeded on its first use by mixing 4 values obtained from `gb_rand` with the address of `mask_generator`. ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_header_with_a_mask_generator_writes_a_fresh_masking_key_per_frame)
+{
+    // arrange
+    unsigned char header[UWS_FRAME_ENCODER_MAX_HEADER_SIZE];
+    unsigned char previous_key[4];
+    UWS_FRAME_MASK_GENERATOR mask_generator;
+    size_t header_length;
+    size_t same_keys = 0;
+    int i;
+    (void)memset(&mask_generator, 0, sizeof(mask_generator));
+
+    STRICT_EXPECTED_CALL(gb_rand());
+    STRICT_EXPECTED_CALL(gb_rand());
+    STRICT_EXPECTED_CALL(gb_rand());
+    STRICT_EXPECTED_CALL(gb_rand());
+
+    // act
+    ASSERT_ARE_EQUAL(int, 0, uws_frame_encoder_encode_header(header, sizeof(header), WS_BINARY_FRAME, 200, &mask_generator, true, 0, &header_length));
+    (void)memcpy(previous_key, header + 4, sizeof(previous_key));
+    for (i = 0; i < 100; i++)
+    {
+        ASSERT_ARE_EQUAL(int, 0, uws_frame_encoder_encode_header(header, sizeof(header), WS_BINARY_FRAME, 200, &mask_generator, true, 0, &header_length));
+        if (memcmp(previous_key, header + 4, sizeof(previous_key)) == 0)
+        {
+            same_keys++;
+        }
+        (void)memcpy(previous_key, header + 4, sizeof(previous_key));
+    }
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 8, header_length);
+    ASSERT_ARE_EQUAL(int, 0x82, (int)header[0]);
+    ASSERT_ARE_EQUAL(int, 0xFE, (int)header[1]);
+    ASSERT_ARE_EQUAL(int, 0x00, (int)header[2]);
+    ASSERT_ARE_EQUAL(int, 200, (int)header[3]);
+    ASSERT_ARE_EQUAL(size_t, 0, same_keys);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* uws_frame_encoder_mask */
+
+/* Tests_SRS_UWS_FRAME_ENCODER_99_007: [ If `mask_key` is NULL, or `length` is greater than 0 and `destination` or `source` is NULL, `uws_frame_encoder_mask` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_frame_encoder_mask_with_NULL_arguments_fails)
+{
+    // arrange
+    unsigned char data[4] = { 0 };
+    unsigned char mask_key[4] = { 1, 2, 3, 4 };
+
+    // act
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, uws_frame_encoder_mask(NULL, data, sizeof(data), mask_key));
+    ASSERT_ARE_NOT_EQUAL(int, 0, uws_frame_encoder_mask(data, NULL, sizeof(data), mask_key));
+    ASSERT_ARE_NOT_EQUAL(int, 0, uws_frame_encoder_mask(data, data, sizeof(data), NULL));
+    ASSERT_ARE_EQUAL(int, 0, uws_frame_encoder_mask(NULL, NULL, 0, mask_key));
+}
+
+/* Tests_SRS_UWS_FRAME_ENCODER_99_008: [ `uws_frame_encoder_mask` shall write to `destination` the `length` bytes of `source` masked with the 4 bytes of `mask_key` as RFC6455 section 5.3 describes, and return 0. ]*/
+/* Tests_SRS_UWS_FRAME_ENCODER_99_009: [ `destination` and `source` may be the same buffer, which is then masked in place. ]*/
+TEST_FUNCTION(uws_frame_encoder_mask_copies_and_masks_in_place_any_length)
+{
+    // arrange
+    unsigned char source[100];
+    unsigned char copied[100];
+    unsigned char in_place[100];
+    unsigned char mask_key[4] = { 0xA5, 0x00, 0x3C, 0xFF };
+    size_t length;
+    size_t i;
+
+    for (i = 0; i < sizeof(source); i++)
+    {
+        source[i] = (unsigned char)(i * 13 + 1);
+    }
+
+    for (length = 0; length <= sizeof(source); length++)
+    {
+        (void)memset(copied, 0x77, sizeof(copied));
+        (void)memcpy(in_place, source, sizeof(in_place));
+
+        // act
+        ASSERT_ARE_EQUAL(int, 0, uws_frame_encoder_mask(copied, source, length, mask_key));
+        ASSERT_ARE_EQUAL(int, 0, uws_frame_encoder_mask(in_place, in_place, length, mask_key));
+
+        // assert
+        for (i = 0; i < sizeof(source); i++)
+        {
+            ASSERT_ARE_EQUAL(int, (i < length) ? (int)(source[i] ^ mask_key[i % 4]) : 0x77, (int)copied[i]);
+            ASSERT_ARE_EQUAL(int, (i < length) ? (int)(source[i] ^ mask_key[i % 4]) : (int)source[i], (int)in_place[i]);
+        }
+    }
+}
+
+END_TEST_SUITE(uws_frame_encoder_ut)
\ No newline at end of file
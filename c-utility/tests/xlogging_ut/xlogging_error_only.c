@@ -0,0 +1,15 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/*this file is built as if the cache variable compiled_log_level was AZ_LOG_ERROR*/
+#undef XLOGGING_COMPILED_LEVEL
+#define XLOGGING_COMPILED_LEVEL AZ_LOG_ERROR
+
+#include "azure_c_shared_utility/xlogging.h"
+
+void log_every_category_with_error_only(int(*count_evaluation)(void))
+{
+    LogError("error %d", count_evaluation());
+    LogInfo("info %d", count_evaluation());
+    LOG(AZ_LOG_TRACE, LOG_LINE, "trace %d", count_evaluation());
+}
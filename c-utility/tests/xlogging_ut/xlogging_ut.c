@@ -0,0 +1,233 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+#include "testrunnerswitcher.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/consolelogger.h"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+#define TEST_CATEGORY_COUNT (AZ_LOG_TRACE + 1)
+
+static LOG_CATEGORY initial_log_level;
+static size_t test_log_calls[TEST_CATEGORY_COUNT];
+static int test_evaluations;
+
+static void test_log(LOG_CATEGORY log_category, const char* file, const char* func, int line, unsigned int options, const char* format, ...)
+{
+    (void)file;
+    (void)func;
+    (void)line;
+    (void)options;
+    (void)format;
+    test_log_calls[log_category]++;
+}
+
+/*stands for an argument that costs something to compute*/
+static int count_evaluation(void)
+{
+    return ++test_evaluations;
+}
+
+static size_t all_log_calls(void)
+{
+    size_t result = 0;
+    size_t i;
+    for (i = 0; i < TEST_CATEGORY_COUNT; i++)
+    {
+        result += test_log_calls[i];
+    }
+    return result;
+}
+
+/*in xlogging_error_only.c, built with XLOGGING_COMPILED_LEVEL set to AZ_LOG_ERROR*/
+extern void log_every_category_with_error_only(int(*count_evaluation)(void));
+
+BEGIN_TEST_SUITE(xlogging_ut)
+
+TEST_SUITE_INITIALIZE(suite_init)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    initial_log_level = xlogging_get_log_level();
+}
+
+TEST_SUITE_CLEANUP(suite_cleanup)
+{
+    xlogging_set_log_function(consolelogger_log);
+    xlogging_set_log_level(AZ_LOG_TRACE);
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("Could not acquire test serialization mutex.");
+    }
+
+    (void)memset(test_log_calls, 0, sizeof(test_log_calls));
+    test_evaluations = 0;
+    xlogging_set_log_function(test_log);
+    xlogging_set_log_level(AZ_LOG_TRACE);
+}
+
+TEST_FUNCTION_CLEANUP(method_cleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+TEST_FUNCTION(xlogging_get_log_level_is_AZ_LOG_TRACE_by_default)
+{
+    // arrange
+
+    // act
+
+    // assert
+    ASSERT_ARE_EQUAL(int, AZ_LOG_TRACE, initial_log_level);
+}
+
+TEST_FUNCTION(xlogging_get_log_level_returns_what_xlogging_set_log_level_set)
+{
+    // arrange
+    LOG_CATEGORY result;
+
+    // act
+    xlogging_set_log_level(AZ_LOG_INFO);
+    result = xlogging_get_log_level();
+
+    // assert
+    ASSERT_ARE_EQUAL(int, AZ_LOG_INFO, result);
+}
+
+TEST_FUNCTION(XLOGGING_IS_ENABLED_follows_the_log_level)
+{
+    // arrange
+
+    // act
+    xlogging_set_log_level(AZ_LOG_ERROR);
+
+    // assert
+    ASSERT_IS_TRUE(XLOGGING_IS_ENABLED(AZ_LOG_ERROR));
+    ASSERT_IS_FALSE(XLOGGING_IS_ENABLED(AZ_LOG_INFO));
+    ASSERT_IS_FALSE(XLOGGING_IS_ENABLED(AZ_LOG_TRACE));
+}
+
+TEST_FUNCTION(LogInfo_below_the_log_level_does_not_reach_the_logger_nor_evaluate_its_arguments)
+{
+    // arrange
+    xlogging_set_log_level(AZ_LOG_ERROR);
+
+    // act
+    LogInfo("info %d", count_evaluation());
+    LOG(AZ_LOG_TRACE, LOG_LINE, "trace %d", count_evaluation());
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 0, all_log_calls());
+    ASSERT_ARE_EQUAL(int, 0, test_evaluations);
+}
+
+TEST_FUNCTION(LogError_at_the_log_level_reaches_the_logger)
+{
+    // arrange
+    xlogging_set_log_level(AZ_LOG_ERROR);
+
+    // act
+    LogError("error %d", count_evaluation());
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 1, test_log_calls[AZ_LOG_ERROR]);
+    ASSERT_ARE_EQUAL(int, 1, test_evaluations);
+}
+
+TEST_FUNCTION(every_category_at_or_above_the_log_level_reaches_the_logger)
+{
+    // arrange
+    xlogging_set_log_level(AZ_LOG_INFO);
+
+    // act
+    LogError("error");
+    LogInfo("info");
+    LOG(AZ_LOG_TRACE, LOG_LINE, "trace");
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 1, test_log_calls[AZ_LOG_ERROR]);
+    ASSERT_ARE_EQUAL(size_t, 1, test_log_calls[AZ_LOG_INFO]);
+    ASSERT_ARE_EQUAL(size_t, 0, test_log_calls[AZ_LOG_TRACE]);
+}
+
+TEST_FUNCTION(LogBinary_does_not_reach_the_logger_when_trace_is_below_the_log_level)
+{
+    // arrange
+    unsigned char data[20] = { 0 };
+    xlogging_set_log_level(AZ_LOG_INFO);
+
+    // act
+    LogBinary("data", data, sizeof(data));
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 0, all_log_calls());
+}
+
+TEST_FUNCTION(LogBinary_logs_a_header_and_a_line_per_16_bytes_when_trace_is_enabled)
+{
+    // arrange
+    unsigned char data[20] = { 0 };
+    size_t expected_log_calls = (AZ_LOG_TRACE <= TEST_COMPILED_LOG_LEVEL) ? 3 : 0;
+
+    // act
+    LogBinary("data", data, sizeof(data));
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, expected_log_calls, test_log_calls[AZ_LOG_TRACE]);
+    ASSERT_ARE_EQUAL(size_t, expected_log_calls, all_log_calls());
+}
+
+TEST_FUNCTION(XLOGGING_COMPILED_LEVEL_removes_the_categories_after_it_whatever_the_log_level)
+{
+    // arrange
+
+    // act
+    log_every_category_with_error_only(count_evaluation);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 1, test_log_calls[AZ_LOG_ERROR]);
+    ASSERT_ARE_EQUAL(size_t, 1, all_log_calls());
+    ASSERT_ARE_EQUAL(int, 1, test_evaluations);
+}
+
+TEST_FUNCTION(XLOGGING_COMPILED_LEVEL_is_the_compiled_log_level_cache_variable)
+{
+    // arrange
+    int category;
+
+    // act
+    for (category = AZ_LOG_ERROR; category <= AZ_LOG_TRACE; category++)
+    {
+        LOG((LOG_CATEGORY)category, LOG_LINE, "category %d", category);
+    }
+
+    // assert
+    ASSERT_ARE_EQUAL(int, TEST_COMPILED_LOG_LEVEL, XLOGGING_COMPILED_LEVEL);
+    for (category = AZ_LOG_ERROR; category <= AZ_LOG_TRACE; category++)
+    {
+        ASSERT_ARE_EQUAL(size_t, (category <= TEST_COMPILED_LOG_LEVEL) ? 1 : 0, test_log_calls[category]);
+    }
+}
+
+END_TEST_SUITE(xlogging_ut)
@@ -74,6 +74,58 @@ typedef struct _IOTCORE_MQTT_PAYLOAD
     size_t length;
 } IOTCORE_MQTT_PAYLOAD;
 
+// latencies are kept in log-linear buckets: the values 0..3 ms have a bucket each, then every
+// power of two range [2^k, 2^(k+1)) is split into 4 equal buckets, up to UINT32_MAX ms
+#define IOTCORE_MQTT_HISTOGRAM_BUCKET_COUNT 124
+
+typedef struct IOTCORE_MQTT_HISTOGRAM_TAG
+{
+    uint32_t count;
+    uint32_t min_ms;
+    uint32_t max_ms;
+    uint64_t sum_ms;
+    uint32_t buckets[IOTCORE_MQTT_HISTOGRAM_BUCKET_COUNT];
+} IOTCORE_MQTT_HISTOGRAM;
+
+typedef struct IOTCORE_MQTT_GAUGE_TAG
+{
+    uint32_t current;
+    uint32_t max;
+} IOTCORE_MQTT_GAUGE;
+
+typedef struct IOTCORE_MQTT_STATISTICS_TAG
+{
+    // publish_mqtt_message calls, and the ones mqtt_client_publish refused
+    uint32_t publish_count;
+    uint32_t publish_failed_count;
+    // qos 1 publishes acked by the broker, and the ones failed because the connection dropped first
+    uint32_t puback_count;
+    uint32_t puback_failed_count;
+    // messages delivered to the RECV_MSG_CALLBACK
+    uint32_t receive_count;
+
+    // CONNECT packets sent, attempts that failed before or at CONNACK, accepted connections and lost ones
+    uint32_t connect_attempt_count;
+    uint32_t connect_failed_count;
+    uint32_t connection_count;
+    uint32_t connection_lost_count;
+
+    // entries waiting for a PUBACK / SUBACK
+    IOTCORE_MQTT_GAUGE pub_ack_waiting;
+    IOTCORE_MQTT_GAUGE sub_ack_waiting;
+
+    // messages publish_mqtt_message_async queued for iotcore_mqtt_dowork, and the ones refused because the queue was full
+    IOTCORE_MQTT_GAUGE publish_queued;
+    uint32_t publish_queue_full_count;
+
+    // from publish_mqtt_message to the PUBACK, for qos 1 publishes with a PUB_CALLBACK
+    IOTCORE_MQTT_HISTOGRAM publish_latency;
+    // from opening the transport (TCP and TLS handshake included) to an accepted CONNACK
+    IOTCORE_MQTT_HISTOGRAM connect_latency;
+    // successful iotcore_mqtt_doconnect calls
+    IOTCORE_MQTT_HISTOGRAM doconnect_duration;
+} IOTCORE_MQTT_STATISTICS;
+
 typedef int(*PUB_CALLBACK)(MQTT_PUB_STATUS_TYPE status, void *context);
 
 typedef int(*SUB_CALLBACK)(IOTCORE_MQTT_QOS* qosReturn, size_t qosCount, void *context);
@@ -91,9 +143,19 @@ IOTCORE_MQTT_CLIENT_HANDLE initialize_mqtt_client_handle(const IOTCORE_INFO* inf
 
 int iotcore_mqtt_doconnect(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client, size_t timeout);
 
+// handle, when not NULL, is called with MQTT_PUB_FAILED on every failure, on top of the error returned.
 int publish_mqtt_message(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client, const char* pub_topic_name,
                          IOTCORE_MQTT_QOS qos_value, const uint8_t* pub_msg, size_t pub_msg_length, PUB_CALLBACK handle, void* context);
 
+// Thread-safe publish for applications that publish from several threads. The topic and payload
+// are copied into a bounded lock-free queue that iotcore_mqtt_dowork drains with publish_mqtt_message
+// once the client is connected, so the caller never waits on the network or on other publishers.
+// handle is called from iotcore_mqtt_dowork, or with MQTT_PUB_FAILED from iotcore_mqtt_destroy for
+// messages still queued. Returns IOTCORE_ERR_QUEUE_FULL when the queue is full: the caller decides
+// whether to drop the message, retry later or slow down. It must not race iotcore_mqtt_destroy.
+int publish_mqtt_message_async(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client, const char* pub_topic_name,
+                               IOTCORE_MQTT_QOS qos_value, const uint8_t* pub_msg, size_t pub_msg_length, PUB_CALLBACK handle, void* context);
+
 int subscribe_mqtt_topic(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client, const char* sub_topic, IOTCORE_MQTT_QOS ret_qos, SUB_CALLBACK sub_callback, void* context);
 
 int unsubscribe_mqtt_topics(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client, const char* unsubscribe);
@@ -106,8 +168,30 @@ void iotcore_mqtt_destroy(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client);
 
 void set_client_cert(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client, const char* client_cert, const char* client_key);
 
+// Replaces the CA certificates the TLS connections trust, the Baidu IoT Core ones by default.
+// The string is not copied and has to outlive the client; NULL restores the default.
+void set_trusted_certs(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client, const char* trusted_certs);
+
+// Replaces the port the next connections are opened on, 1883 for TCP and 1884 for TLS by
+// default; 0 restores the default.
+void set_server_port(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client, uint16_t port);
+
 IOTCORE_MQTT_STATUS iotcore_get_mqtt_status(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client);
 
+// Copies the counters of the client into statistics. It can be called from any thread while the
+// client works; every field is read atomically but the fields are not a consistent snapshot together.
+int iotcore_mqtt_get_statistics(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client, IOTCORE_MQTT_STATISTICS* statistics);
+
+// Returns the upper bound in ms of the histogram bucket the given percentile (0 to 100) falls into, or max_ms
+// if it is smaller, so the result is never below the real percentile; 0 if the histogram is empty.
+uint32_t iotcore_mqtt_histogram_percentile(const IOTCORE_MQTT_HISTOGRAM* histogram, double percentile);
+
+// Returns the smallest latency in ms that is counted in the given bucket.
+uint32_t iotcore_mqtt_histogram_bucket_lower_bound(size_t bucket);
+
+// Returns the largest latency in ms that is counted in the given bucket.
+uint32_t iotcore_mqtt_histogram_bucket_upper_bound(size_t bucket);
+
 #ifdef __cplusplus
 }
 #endif
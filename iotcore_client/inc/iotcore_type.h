@@ -41,6 +41,8 @@ static const int IOTCORE_ERR_OUT_OF_MEMORY = 3;
 static const int IOTCORE_ERR_NOT_SUPPORT = 4;
 // iotcore not connected
 static const int IOTCORE_ERR_NOT_CONNECT = 5;
+// publish queue full, try again once iotcore_mqtt_dowork drained it
+static const int IOTCORE_ERR_QUEUE_FULL = 6;
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,421 @@
+/*
+* Copyright (c) 2017 Baidu, Inc. All Rights Reserved.
+*
+* Licensed to the Apache Software Foundation (ASF) under one or more
+* contributor license agreements.  See the NOTICE file distributed with
+* this work for additional information regarding copyright ownership.
+* The ASF licenses this file to You under the Apache License, Version 2.0
+* (the "License"); you may not use this file except in compliance with
+* the License.  You may obtain a copy of the License at
+*
+*    http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+/**
+ * Throughput and latency benchmark of iotcore_client against the in-tree loopback broker.
+ *
+ * It starts loopback_broker on 127.0.0.1, on --port or on a free port by default, connects an iotcore client to it over TCP (or TLS
+ * with --tls), publishes --messages messages of --size bytes with publish_mqtt_message, keeping
+ * at most --window qos 1 publishes waiting for their PUBACK, and reports the publish rate and
+ * the publish to PUBACK latency percentiles. With --subscribe the client also subscribes to the
+ * topic it publishes on and the delivery latency of the messages coming back is reported too.
+ *
+ * The process exits with a non-zero status when the connection fails or not every message is
+ * acked (and delivered, with --subscribe) before --timeout seconds, so it can gate CI runs.
+ */
+
+#include "loopback_broker.h"
+#include "iotcore_mqtt_client.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "azure_c_shared_utility/platform.h"
+#include "azure_c_shared_utility/threadapi.h"
+
+#define BENCHMARK_TOPIC         "$iot/benchmark/user/throughput"
+#define SEQUENCE_SIZE           4
+
+typedef struct BENCHMARK_OPTIONS_TAG
+{
+    size_t message_count;
+    size_t message_size;
+    IOTCORE_MQTT_QOS qos;
+    size_t window;
+    int use_tls;
+    int subscribe;
+    size_t timeout_in_sec;
+    // 0 lets the broker pick a free port
+    uint16_t port;
+} BENCHMARK_OPTIONS;
+
+// on_subscribe_complete results
+#define SUBSCRIBE_PENDING       0
+#define SUBSCRIBE_GRANTED       1
+#define SUBSCRIBE_REFUSED       2
+
+typedef struct BENCHMARK_TAG
+{
+    size_t message_count;
+    uint64_t* sent_ns;
+    uint64_t* ack_latency_ns;
+    uint64_t* delivery_latency_ns;
+    size_t acked;
+    size_t failed;
+    size_t delivered;
+    size_t subscribe_result;
+} BENCHMARK;
+
+// RECV_MSG_CALLBACK has no context argument
+static BENCHMARK* g_benchmark;
+
+static uint64_t get_time_ns(void)
+{
+    struct timespec now;
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000) + (uint64_t)now.tv_nsec;
+}
+
+static int compare_uint64(const void* left, const void* right)
+{
+    uint64_t left_value = *(const uint64_t*)left;
+    uint64_t right_value = *(const uint64_t*)right;
+    return (left_value > right_value) - (left_value < right_value);
+}
+
+// nearest rank percentile of a sorted array, in microseconds
+static double get_percentile_us(const uint64_t* sorted, size_t count, double percentile)
+{
+    double result = 0.0;
+    if (count > 0)
+    {
+        size_t rank = (size_t)((percentile * count) / 100.0 + 0.999999);
+        if (rank == 0)
+        {
+            rank = 1;
+        }
+        else if (rank > count)
+        {
+            rank = count;
+        }
+        result = (double)sorted[rank - 1] / 1000.0;
+    }
+    return result;
+}
+
+static void print_latency(const char* name, uint64_t* latency_ns, size_t count)
+{
+    if (count == 0)
+    {
+        (void)printf("%-18s n/a\n", name);
+    }
+    else
+    {
+        qsort(latency_ns, count, sizeof(uint64_t), compare_uint64);
+        (void)printf("%-18s p50 %.1f us, p99 %.1f us, max %.1f us\n", name,
+            get_percentile_us(latency_ns, count, 50), get_percentile_us(latency_ns, count, 99),
+            (double)latency_ns[count - 1] / 1000.0);
+    }
+}
+
+static int on_publish_complete(MQTT_PUB_STATUS_TYPE status, void* context)
+{
+    size_t sequence = (size_t)context;
+    if (status == MQTT_PUB_SUCCESS)
+    {
+        g_benchmark->ack_latency_ns[g_benchmark->acked++] = get_time_ns() - g_benchmark->sent_ns[sequence];
+    }
+    else
+    {
+        g_benchmark->failed++;
+    }
+    return 0;
+}
+
+static int on_subscribe_complete(IOTCORE_MQTT_QOS* qos_return, size_t qos_count, void* context)
+{
+    (void)context;
+    g_benchmark->subscribe_result = (qos_return != NULL && qos_count == 1 && qos_return[0] != QOS_FAILURE) ? SUBSCRIBE_GRANTED : SUBSCRIBE_REFUSED;
+    return 0;
+}
+
+static void on_message_received(uint16_t packet_id, IOTCORE_MQTT_QOS qos, const char* topic, const IOTCORE_MQTT_PAYLOAD* msg, int is_retained)
+{
+    (void)packet_id;
+    (void)qos;
+    (void)topic;
+    (void)is_retained;
+    if (msg->length >= SEQUENCE_SIZE)
+    {
+        uint32_t sequence = ((uint32_t)msg->message[0] << 24) | ((uint32_t)msg->message[1] << 16) | ((uint32_t)msg->message[2] << 8) | (uint32_t)msg->message[3];
+        if (sequence < g_benchmark->message_count && g_benchmark->delivered < g_benchmark->message_count && g_benchmark->delivery_latency_ns != NULL)
+        {
+            g_benchmark->delivery_latency_ns[g_benchmark->delivered++] = get_time_ns() - g_benchmark->sent_ns[sequence];
+        }
+    }
+}
+
+static void print_usage(const char* program)
+{
+    (void)printf("usage: %s [--messages N] [--size BYTES] [--qos 0|1] [--window N] [--tls] [--subscribe] [--timeout SECONDS] [--port PORT]\n", program);
+}
+
+static int parse_options(int argc, char** argv, BENCHMARK_OPTIONS* options)
+{
+    int result = 0;
+    int index;
+
+    options->message_count = 10000;
+    options->message_size = 64;
+    options->qos = QOS_1_AT_LEAST_ONCE;
+    options->window = 100;
+    options->use_tls = 0;
+    options->subscribe = 0;
+    options->timeout_in_sec = 60;
+    options->port = 0;
+
+    for (index = 1; index < argc && result == 0; index++)
+    {
+        const char* value = (index + 1 < argc) ? argv[index + 1] : NULL;
+        if (strcmp(argv[index], "--tls") == 0)
+        {
+            options->use_tls = 1;
+        }
+        else if (strcmp(argv[index], "--subscribe") == 0)
+        {
+            options->subscribe = 1;
+        }
+        else if (value == NULL)
+        {
+            result = __LINE__;
+        }
+        else if (strcmp(argv[index], "--messages") == 0)
+        {
+            options->message_count = (size_t)strtoul(value, NULL, 10);
+            index++;
+        }
+        else if (strcmp(argv[index], "--size") == 0)
+        {
+            options->message_size = (size_t)strtoul(value, NULL, 10);
+            index++;
+        }
+        else if (strcmp(argv[index], "--qos") == 0)
+        {
+            options->qos = (strcmp(value, "0") == 0) ? QOS_0_AT_MOST_ONCE : QOS_1_AT_LEAST_ONCE;
+            index++;
+        }
+        else if (strcmp(argv[index], "--window") == 0)
+        {
+            options->window = (size_t)strtoul(value, NULL, 10);
+            index++;
+        }
+        else if (strcmp(argv[index], "--timeout") == 0)
+        {
+            options->timeout_in_sec = (size_t)strtoul(value, NULL, 10);
+            index++;
+        }
+        else if (strcmp(argv[index], "--port") == 0)
+        {
+            unsigned long port = strtoul(value, NULL, 10);
+            if (port > UINT16_MAX)
+            {
+                result = __LINE__;
+            }
+            options->port = (uint16_t)port;
+            index++;
+        }
+        else
+        {
+            result = __LINE__;
+        }
+    }
+
+    if (result == 0 && (options->message_count == 0 || options->message_count >= UINT32_MAX || options->window == 0 || options->message_size < SEQUENCE_SIZE))
+    {
+        (void)printf("--messages and --window must be positive and --size at least %d\n", SEQUENCE_SIZE);
+        result = __LINE__;
+    }
+    return result;
+}
+
+static int wait_until(IOTCORE_MQTT_CLIENT_HANDLE client, const size_t* counter, size_t target, uint64_t deadline_ns)
+{
+    while (*counter < target && get_time_ns() < deadline_ns)
+    {
+        iotcore_mqtt_dowork(client);
+    }
+    return (*counter < target) ? __LINE__ : 0;
+}
+
+static int run_benchmark(const BENCHMARK_OPTIONS* options, LOOPBACK_BROKER_HANDLE broker)
+{
+    int result = 0;
+    BENCHMARK benchmark;
+    IOTCORE_INFO info = { "benchmark", "benchmark_device", "benchmark_secret", "127.0.0.1" };
+    IOTCORE_MQTT_CLIENT_HANDLE client;
+    unsigned char* payload = (unsigned char*)malloc(options->message_size);
+
+    (void)memset(&benchmark, 0, sizeof(benchmark));
+    benchmark.message_count = options->message_count;
+    benchmark.sent_ns = (uint64_t*)calloc(options->message_count, sizeof(uint64_t));
+    benchmark.ack_latency_ns = (uint64_t*)calloc(options->message_count, sizeof(uint64_t));
+    benchmark.delivery_latency_ns = options->subscribe ? (uint64_t*)calloc(options->message_count, sizeof(uint64_t)) : NULL;
+    g_benchmark = &benchmark;
+
+    if (payload == NULL || benchmark.sent_ns == NULL || benchmark.ack_latency_ns == NULL || (options->subscribe && benchmark.delivery_latency_ns == NULL))
+    {
+        (void)printf("failure allocating the benchmark buffers\n");
+        result = __LINE__;
+    }
+    else if ((client = initialize_mqtt_client_handle(&info, NULL, NULL, options->use_tls ? MQTT_CONNECTION_TLS : MQTT_CONNECTION_TCP,
+        on_message_received, IOTCORE_RETRY_EXPONENTIAL_BACKOFF, options->timeout_in_sec)) == NULL)
+    {
+        (void)printf("failure creating the iotcore client\n");
+        result = __LINE__;
+    }
+    else
+    {
+        uint64_t deadline_ns = get_time_ns() + ((uint64_t)options->timeout_in_sec * 1000000000);
+
+        if (options->use_tls)
+        {
+            set_trusted_certs(client, loopback_broker_get_certificate(broker));
+            set_server_port(client, loopback_broker_get_tls_port(broker));
+        }
+        else
+        {
+            set_server_port(client, loopback_broker_get_tcp_port(broker));
+        }
+
+        (void)memset(payload, 'x', options->message_size);
+        if (iotcore_mqtt_doconnect(client, options->timeout_in_sec) != IOTCORE_ERR_OK)
+        {
+            (void)printf("failure connecting to the loopback broker\n");
+            result = __LINE__;
+        }
+        else if (options->subscribe &&
+            (subscribe_mqtt_topic(client, BENCHMARK_TOPIC, options->qos, on_subscribe_complete, NULL) != 0 ||
+            (wait_until(client, &benchmark.subscribe_result, SUBSCRIBE_GRANTED, deadline_ns), benchmark.subscribe_result != SUBSCRIBE_GRANTED)))
+        {
+            (void)printf("failure subscribing to %s\n", BENCHMARK_TOPIC);
+            result = __LINE__;
+        }
+        else
+        {
+            IOTCORE_MQTT_STATISTICS statistics;
+            LOOPBACK_BROKER_STATISTICS broker_statistics;
+            size_t sent = 0;
+            uint64_t start_ns = get_time_ns();
+            uint64_t elapsed_ns;
+
+            while (sent < options->message_count && get_time_ns() < deadline_ns && benchmark.failed == 0)
+            {
+                // qos 0 completes in publish_mqtt_message, only qos 1 publishes wait in the window
+                while (sent < options->message_count && (sent - benchmark.acked - benchmark.failed) < options->window)
+                {
+                    payload[0] = (unsigned char)(sent >> 24);
+                    payload[1] = (unsigned char)(sent >> 16);
+                    payload[2] = (unsigned char)(sent >> 8);
+                    payload[3] = (unsigned char)sent;
+                    benchmark.sent_ns[sent] = get_time_ns();
+                    if (publish_mqtt_message(client, BENCHMARK_TOPIC, options->qos, payload, options->message_size, on_publish_complete, (void*)sent) != 0)
+                    {
+                        break;
+                    }
+                    sent++;
+                }
+                iotcore_mqtt_dowork(client);
+            }
+
+            if (wait_until(client, &benchmark.acked, options->message_count, deadline_ns) != 0)
+            {
+                (void)printf("only %zu of %zu publishes completed (%zu failed)\n", benchmark.acked, options->message_count, benchmark.failed);
+                result = __LINE__;
+            }
+            elapsed_ns = get_time_ns() - start_ns;
+
+            if (options->subscribe && wait_until(client, &benchmark.delivered, options->message_count, deadline_ns) != 0)
+            {
+                (void)printf("only %zu of %zu messages came back\n", benchmark.delivered, options->message_count);
+                result = __LINE__;
+            }
+
+            (void)printf("transport          %s on port %u, qos %d, %zu bytes, window %zu\n", options->use_tls ? "tls" : "tcp",
+                (unsigned int)(options->use_tls ? loopback_broker_get_tls_port(broker) : loopback_broker_get_tcp_port(broker)), (int)options->qos, options->message_size, options->window);
+            (void)printf("messages           %zu acked of %zu in %.3f s\n", benchmark.acked, options->message_count, (double)elapsed_ns / 1e9);
+            (void)printf("throughput         %.0f msgs/sec\n", (elapsed_ns == 0) ? 0.0 : ((double)benchmark.acked * 1e9) / (double)elapsed_ns);
+            // a qos 0 publish has no ack, its latency is only the time spent in publish_mqtt_message
+            print_latency((options->qos == QOS_0_AT_MOST_ONCE) ? "publish latency" : "ack latency", benchmark.ack_latency_ns, benchmark.acked);
+            if (options->subscribe)
+            {
+                print_latency("delivery latency", benchmark.delivery_latency_ns, benchmark.delivered);
+            }
+            if (iotcore_mqtt_get_statistics(client, &statistics) == 0)
+            {
+                (void)printf("connect latency    %u ms\n", statistics.connect_latency.max_ms);
+                (void)printf("pub ack queue max  %u\n", statistics.pub_ack_waiting.max);
+            }
+            loopback_broker_get_statistics(broker, &broker_statistics);
+            (void)printf("broker             %zu publishes received, %zu delivered\n", broker_statistics.publishes_received, broker_statistics.publishes_delivered);
+        }
+
+        (void)iotcore_mqtt_disconnect(client);
+        iotcore_mqtt_dowork(client);
+        iotcore_mqtt_destroy(client);
+    }
+
+    g_benchmark = NULL;
+    free(benchmark.delivery_latency_ns);
+    free(benchmark.ack_latency_ns);
+    free(benchmark.sent_ns);
+    free(payload);
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    int result;
+    BENCHMARK_OPTIONS options;
+
+    if (parse_options(argc, argv, &options) != 0)
+    {
+        print_usage(argv[0]);
+        result = 2;
+    }
+    else if (platform_init() != 0)
+    {
+        (void)printf("platform_init failed\n");
+        result = 1;
+    }
+    else
+    {
+        LOOPBACK_BROKER_CONFIG config;
+        LOOPBACK_BROKER_HANDLE broker;
+
+        config.use_tcp = !options.use_tls;
+        config.tcp_port = options.port;
+        config.use_tls = options.use_tls;
+        config.tls_port = options.port;
+        broker = loopback_broker_start(&config);
+        if (broker == NULL)
+        {
+            (void)printf("failure starting the loopback broker\n");
+            result = 1;
+        }
+        else
+        {
+            result = (run_benchmark(&options, broker) == 0) ? 0 : 1;
+            loopback_broker_stop(broker);
+        }
+        platform_deinit();
+    }
+    return result;
+}
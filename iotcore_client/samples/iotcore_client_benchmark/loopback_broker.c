@@ -0,0 +1,1165 @@
+/*
+* Copyright (c) 2017 Baidu, Inc. All Rights Reserved.
+*
+* Licensed to the Apache Software Foundation (ASF) under one or more
+* contributor license agreements.  See the NOTICE file distributed with
+* this work for additional information regarding copyright ownership.
+* The ASF licenses this file to You under the Apache License, Version 2.0
+* (the "License"); you may not use this file except in compliance with
+* the License.  You may obtain a copy of the License at
+*
+*    http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "loopback_broker.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "azure_c_shared_utility/threadapi.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+#ifdef USE_OPENSSL
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+#endif
+
+#define PACKET_CONNECT      1
+#define PACKET_CONNACK      2
+#define PACKET_PUBLISH      3
+#define PACKET_PUBACK       4
+#define PACKET_SUBSCRIBE    8
+#define PACKET_SUBACK       9
+#define PACKET_UNSUBSCRIBE  10
+#define PACKET_UNSUBACK     11
+#define PACKET_PINGREQ      12
+#define PACKET_PINGRESP     13
+#define PACKET_DISCONNECT   14
+
+// larger packets close the connection instead of growing the receive buffer without bound
+#define MAX_PACKET_SIZE     (16 * 1024 * 1024)
+#define READ_CHUNK_SIZE     16384
+// how long poll waits before the thread looks at the stop flag again
+#define POLL_TIMEOUT_MS     20
+
+typedef struct SUBSCRIPTION_TAG
+{
+    char* filter;
+    uint8_t qos;
+} SUBSCRIPTION;
+
+typedef struct BUFFER_TAG
+{
+    unsigned char* data;
+    size_t size;
+    size_t capacity;
+} BUFFER;
+
+typedef struct CONNECTION_TAG
+{
+    int socket;
+#ifdef USE_OPENSSL
+    SSL* ssl;
+    bool wants_write;
+#endif
+    bool connected;
+    bool closing;
+    uint16_t next_packet_id;
+    BUFFER input;
+    BUFFER output;
+    SUBSCRIPTION* subscriptions;
+    size_t subscription_count;
+} CONNECTION;
+
+typedef struct LOOPBACK_BROKER_TAG
+{
+    int tcp_socket;
+    int tls_socket;
+    uint16_t tcp_port;
+    uint16_t tls_port;
+#ifdef USE_OPENSSL
+    SSL_CTX* ssl_context;
+#endif
+    char* certificate;
+    CONNECTION** connections;
+    size_t connection_count;
+    struct pollfd* poll_fds;
+    size_t poll_fds_capacity;
+    THREAD_HANDLE thread;
+    int stop;
+    LOOPBACK_BROKER_STATISTICS statistics;
+} LOOPBACK_BROKER;
+
+static int buffer_reserve(BUFFER* buffer, size_t extra)
+{
+    int result;
+    if (buffer->size + extra <= buffer->capacity)
+    {
+        result = 0;
+    }
+    else
+    {
+        size_t new_capacity = (buffer->capacity == 0) ? 256 : buffer->capacity;
+        unsigned char* new_data;
+        while (new_capacity < buffer->size + extra)
+        {
+            new_capacity *= 2;
+        }
+        new_data = (unsigned char*)realloc(buffer->data, new_capacity);
+        if (new_data == NULL)
+        {
+            LogError("failure growing a connection buffer to %zu bytes", new_capacity);
+            result = __LINE__;
+        }
+        else
+        {
+            buffer->data = new_data;
+            buffer->capacity = new_capacity;
+            result = 0;
+        }
+    }
+    return result;
+}
+
+static void buffer_consume(BUFFER* buffer, size_t count)
+{
+    if (count < buffer->size)
+    {
+        (void)memmove(buffer->data, buffer->data + count, buffer->size - count);
+    }
+    buffer->size -= count;
+}
+
+static int write_fixed_header(CONNECTION* connection, unsigned char first_byte, size_t remaining_length)
+{
+    int result;
+    if (buffer_reserve(&connection->output, 5 + remaining_length) != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        BUFFER* output = &connection->output;
+        output->data[output->size++] = first_byte;
+        do
+        {
+            unsigned char encoded = (unsigned char)(remaining_length & 0x7F);
+            remaining_length >>= 7;
+            if (remaining_length > 0)
+            {
+                encoded |= 0x80;
+            }
+            output->data[output->size++] = encoded;
+        } while (remaining_length > 0);
+        result = 0;
+    }
+    return result;
+}
+
+static void write_bytes(CONNECTION* connection, const unsigned char* bytes, size_t length)
+{
+    // write_fixed_header reserved room for the whole packet
+    (void)memcpy(connection->output.data + connection->output.size, bytes, length);
+    connection->output.size += length;
+}
+
+static void write_uint16(CONNECTION* connection, uint16_t value)
+{
+    unsigned char bytes[2];
+    bytes[0] = (unsigned char)(value >> 8);
+    bytes[1] = (unsigned char)(value & 0xFF);
+    write_bytes(connection, bytes, 2);
+}
+
+static int send_ack(CONNECTION* connection, unsigned char first_byte, uint16_t packet_id)
+{
+    int result;
+    if (write_fixed_header(connection, first_byte, 2) != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        write_uint16(connection, packet_id);
+        result = 0;
+    }
+    return result;
+}
+
+static uint16_t read_uint16(const unsigned char* bytes)
+{
+    return (uint16_t)((bytes[0] << 8) | bytes[1]);
+}
+
+/*filters are matched level by level: '+' matches one level, a trailing '#' matches the
+parent level and everything below it, and neither matches a topic starting with '$'*/
+static bool topic_matches(const char* filter, const unsigned char* topic, size_t topic_length)
+{
+    const unsigned char* topic_end = topic + topic_length;
+    bool result;
+
+    if (topic_length > 0 && topic[0] == '$' && (filter[0] == '+' || filter[0] == '#'))
+    {
+        result = false;
+    }
+    else
+    {
+        result = true;
+        while (*filter != '\0')
+        {
+            if (*filter == '#')
+            {
+                break;
+            }
+            else if (*filter == '+')
+            {
+                while (topic < topic_end && *topic != '/')
+                {
+                    topic++;
+                }
+                filter++;
+            }
+            else
+            {
+                while (*filter != '\0' && *filter != '/' && topic < topic_end && *topic == (unsigned char)*filter)
+                {
+                    topic++;
+                    filter++;
+                }
+                if (*filter != '\0' && *filter != '/')
+                {
+                    result = false;
+                    break;
+                }
+            }
+
+            if (*filter == '/')
+            {
+                if (topic == topic_end)
+                {
+                    result = (strcmp(filter, "/#") == 0);
+                    break;
+                }
+                else if (*topic != '/')
+                {
+                    result = false;
+                    break;
+                }
+                filter++;
+                topic++;
+            }
+            else if (topic != topic_end)
+            {
+                // the filter ended inside the topic
+                result = false;
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+static void deliver_publish(LOOPBACK_BROKER* broker, uint8_t qos, const unsigned char* topic, size_t topic_length, const unsigned char* payload, size_t payload_length)
+{
+    size_t connection_index;
+    for (connection_index = 0; connection_index < broker->connection_count; connection_index++)
+    {
+        CONNECTION* subscriber = broker->connections[connection_index];
+        size_t subscription_index;
+        bool matched = false;
+        uint8_t delivery_qos = 0;
+
+        if (!subscriber->connected || subscriber->closing)
+        {
+            continue;
+        }
+
+        // a client subscribed with overlapping filters still gets the message once, at the highest qos
+        for (subscription_index = 0; subscription_index < subscriber->subscription_count; subscription_index++)
+        {
+            const SUBSCRIPTION* subscription = &subscriber->subscriptions[subscription_index];
+            if (topic_matches(subscription->filter, topic, topic_length))
+            {
+                uint8_t granted = (subscription->qos < qos) ? subscription->qos : qos;
+                matched = true;
+                if (granted > delivery_qos)
+                {
+                    delivery_qos = granted;
+                }
+            }
+        }
+
+        if (matched)
+        {
+            size_t remaining_length = 2 + topic_length + ((delivery_qos > 0) ? 2 : 0) + payload_length;
+            if (write_fixed_header(subscriber, (unsigned char)((PACKET_PUBLISH << 4) | (delivery_qos << 1)), remaining_length) != 0)
+            {
+                subscriber->closing = true;
+            }
+            else
+            {
+                write_uint16(subscriber, (uint16_t)topic_length);
+                write_bytes(subscriber, topic, topic_length);
+                if (delivery_qos > 0)
+                {
+                    subscriber->next_packet_id = (subscriber->next_packet_id == UINT16_MAX) ? 1 : (uint16_t)(subscriber->next_packet_id + 1);
+                    write_uint16(subscriber, subscriber->next_packet_id);
+                }
+                write_bytes(subscriber, payload, payload_length);
+                broker->statistics.publishes_delivered++;
+            }
+        }
+    }
+}
+
+static int on_connect(CONNECTION* connection, const unsigned char* body, size_t length)
+{
+    int result;
+    // "MQTT" level 4, or "MQIsdp" level 3 from 3.1 clients
+    bool is_mqtt_311 = (length >= 7) && (read_uint16(body) == 4) && (memcmp(body + 2, "MQTT", 4) == 0) && (body[6] == 4);
+    bool is_mqtt_31 = (length >= 9) && (read_uint16(body) == 6) && (memcmp(body + 2, "MQIsdp", 6) == 0) && (body[8] == 3);
+
+    if (connection->connected)
+    {
+        LogError("second CONNECT on a connection");
+        result = __LINE__;
+    }
+    else if (write_fixed_header(connection, PACKET_CONNACK << 4, 2) != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        unsigned char connack[2];
+        connack[0] = 0;
+        // 1 is "unacceptable protocol version"
+        connack[1] = (is_mqtt_311 || is_mqtt_31) ? 0 : 1;
+        write_bytes(connection, connack, 2);
+        if (connack[1] != 0)
+        {
+            connection->closing = true;
+        }
+        else
+        {
+            connection->connected = true;
+        }
+        result = 0;
+    }
+    return result;
+}
+
+static int on_publish(LOOPBACK_BROKER* broker, CONNECTION* connection, unsigned char flags, const unsigned char* body, size_t length)
+{
+    int result;
+    uint8_t qos = (uint8_t)((flags >> 1) & 0x03);
+    size_t topic_length;
+    size_t header_length;
+
+    if (length < 2 || (topic_length = read_uint16(body), header_length = 2 + topic_length + ((qos > 0) ? 2 : 0), header_length > length))
+    {
+        LogError("malformed PUBLISH");
+        result = __LINE__;
+    }
+    else if (qos > 1)
+    {
+        LogError("PUBLISH with qos %u is not supported", (unsigned int)qos);
+        result = __LINE__;
+    }
+    else
+    {
+        broker->statistics.publishes_received++;
+        if (qos == 1 && send_ack(connection, PACKET_PUBACK << 4, read_uint16(body + 2 + topic_length)) != 0)
+        {
+            result = __LINE__;
+        }
+        else
+        {
+            deliver_publish(broker, qos, body + 2, topic_length, body + header_length, length - header_length);
+            result = 0;
+        }
+    }
+    return result;
+}
+
+static int on_subscribe(CONNECTION* connection, const unsigned char* body, size_t length)
+{
+    int result;
+    size_t position = 2;
+    size_t filter_count = 0;
+
+    if (length < 5)
+    {
+        LogError("malformed SUBSCRIBE");
+        result = __LINE__;
+    }
+    else
+    {
+        result = 0;
+        // count the filters first, to size the SUBACK
+        while (position < length)
+        {
+            size_t filter_length;
+            if (position + 2 > length || (filter_length = read_uint16(body + position), position + 2 + filter_length + 1 > length))
+            {
+                LogError("malformed SUBSCRIBE");
+                result = __LINE__;
+                break;
+            }
+            position += 2 + filter_length + 1;
+            filter_count++;
+        }
+
+        if (result == 0)
+        {
+            SUBSCRIPTION* new_subscriptions = (SUBSCRIPTION*)realloc(connection->subscriptions, (connection->subscription_count + filter_count) * sizeof(SUBSCRIPTION));
+            if (new_subscriptions == NULL)
+            {
+                LogError("failure allocating %zu subscriptions", connection->subscription_count + filter_count);
+                result = __LINE__;
+            }
+            else if ((connection->subscriptions = new_subscriptions, write_fixed_header(connection, (PACKET_SUBACK << 4), 2 + filter_count)) != 0)
+            {
+                result = __LINE__;
+            }
+            else
+            {
+                write_uint16(connection, read_uint16(body));
+                position = 2;
+                while (position < length)
+                {
+                    size_t filter_length = read_uint16(body + position);
+                    SUBSCRIPTION* subscription = &connection->subscriptions[connection->subscription_count];
+                    unsigned char granted = (body[position + 2 + filter_length] > 0) ? 1 : 0;
+
+                    subscription->filter = (char*)malloc(filter_length + 1);
+                    if (subscription->filter == NULL)
+                    {
+                        granted = 0x80;
+                    }
+                    else
+                    {
+                        (void)memcpy(subscription->filter, body + position + 2, filter_length);
+                        subscription->filter[filter_length] = '\0';
+                        subscription->qos = granted;
+                        connection->subscription_count++;
+                    }
+                    write_bytes(connection, &granted, 1);
+                    position += 2 + filter_length + 1;
+                }
+            }
+        }
+    }
+    return result;
+}
+
+static int on_unsubscribe(CONNECTION* connection, const unsigned char* body, size_t length)
+{
+    int result;
+    size_t position = 2;
+
+    if (length < 4)
+    {
+        LogError("malformed UNSUBSCRIBE");
+        result = __LINE__;
+    }
+    else
+    {
+        result = 0;
+        while (position < length)
+        {
+            size_t filter_length;
+            size_t index = 0;
+            if (position + 2 > length || (filter_length = read_uint16(body + position), position + 2 + filter_length > length))
+            {
+                LogError("malformed UNSUBSCRIBE");
+                result = __LINE__;
+                break;
+            }
+            while (index < connection->subscription_count)
+            {
+                SUBSCRIPTION* subscription = &connection->subscriptions[index];
+                if (strlen(subscription->filter) == filter_length && memcmp(subscription->filter, body + position + 2, filter_length) == 0)
+                {
+                    free(subscription->filter);
+                    *subscription = connection->subscriptions[--connection->subscription_count];
+                }
+                else
+                {
+                    index++;
+                }
+            }
+            position += 2 + filter_length;
+        }
+
+        if (result == 0 && send_ack(connection, PACKET_UNSUBACK << 4, read_uint16(body)) != 0)
+        {
+            result = __LINE__;
+        }
+    }
+    return result;
+}
+
+static int on_packet(LOOPBACK_BROKER* broker, CONNECTION* connection, unsigned char first_byte, const unsigned char* body, size_t length)
+{
+    int result;
+    unsigned char type = (unsigned char)(first_byte >> 4);
+
+    if (!connection->connected && type != PACKET_CONNECT)
+    {
+        LogError("packet type %u before CONNECT", (unsigned int)type);
+        result = __LINE__;
+    }
+    else
+    {
+        switch (type)
+        {
+        case PACKET_CONNECT:
+            result = on_connect(connection, body, length);
+            break;
+        case PACKET_PUBLISH:
+            result = on_publish(broker, connection, (unsigned char)(first_byte & 0x0F), body, length);
+            break;
+        case PACKET_PUBACK:
+            // deliveries are never resent, so there is nothing to release
+            result = 0;
+            break;
+        case PACKET_SUBSCRIBE:
+            result = on_subscribe(connection, body, length);
+            break;
+        case PACKET_UNSUBSCRIBE:
+            result = on_unsubscribe(connection, body, length);
+            break;
+        case PACKET_PINGREQ:
+            result = write_fixed_header(connection, PACKET_PINGRESP << 4, 0);
+            break;
+        case PACKET_DISCONNECT:
+            connection->closing = true;
+            result = 0;
+            break;
+        default:
+            LogError("unsupported packet type %u", (unsigned int)type);
+            result = __LINE__;
+            break;
+        }
+    }
+    return result;
+}
+
+/*handles every complete packet in the input buffer and leaves a partial one in place*/
+static void process_input(LOOPBACK_BROKER* broker, CONNECTION* connection)
+{
+    size_t position = 0;
+    while (!connection->closing && connection->input.size - position >= 2)
+    {
+        const unsigned char* packet = connection->input.data + position;
+        size_t available = connection->input.size - position;
+        size_t remaining_length = 0;
+        size_t header_length = 1;
+        size_t shift = 0;
+        bool complete_header = false;
+
+        while (header_length < available && header_length <= 4)
+        {
+            unsigned char encoded = packet[header_length++];
+            remaining_length |= (size_t)(encoded & 0x7F) << shift;
+            shift += 7;
+            if ((encoded & 0x80) == 0)
+            {
+                complete_header = true;
+                break;
+            }
+        }
+
+        if (!complete_header)
+        {
+            if (header_length > 4)
+            {
+                LogError("malformed remaining length");
+                connection->closing = true;
+            }
+            break;
+        }
+        else if (remaining_length > MAX_PACKET_SIZE)
+        {
+            LogError("packet of %zu bytes is too large", remaining_length);
+            connection->closing = true;
+            break;
+        }
+        else if (header_length + remaining_length > available)
+        {
+            break;
+        }
+        else
+        {
+            if (on_packet(broker, connection, packet[0], packet + header_length, remaining_length) != 0)
+            {
+                connection->closing = true;
+            }
+            position += header_length + remaining_length;
+        }
+    }
+    buffer_consume(&connection->input, position);
+}
+
+/*returns false when the peer closed the connection or the socket failed*/
+static bool read_input(CONNECTION* connection)
+{
+    bool result = true;
+    for (;;)
+    {
+        ssize_t received;
+        if (buffer_reserve(&connection->input, READ_CHUNK_SIZE) != 0)
+        {
+            result = false;
+            break;
+        }
+#ifdef USE_OPENSSL
+        if (connection->ssl != NULL)
+        {
+            int ssl_received = SSL_read(connection->ssl, connection->input.data + connection->input.size, READ_CHUNK_SIZE);
+            connection->wants_write = false;
+            if (ssl_received <= 0)
+            {
+                int error = SSL_get_error(connection->ssl, ssl_received);
+                if (error == SSL_ERROR_WANT_WRITE)
+                {
+                    connection->wants_write = true;
+                }
+                else if (error != SSL_ERROR_WANT_READ)
+                {
+                    result = false;
+                }
+                break;
+            }
+            received = ssl_received;
+        }
+        else
+#endif
+        {
+            received = recv(connection->socket, connection->input.data + connection->input.size, READ_CHUNK_SIZE, 0);
+            if (received <= 0)
+            {
+                if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+                {
+                    result = false;
+                }
+                break;
+            }
+        }
+        connection->input.size += (size_t)received;
+    }
+    return result;
+}
+
+/*returns false when the socket failed; what could not be sent stays in the output buffer*/
+static bool flush_output(CONNECTION* connection)
+{
+    bool result = true;
+    size_t sent_total = 0;
+    while (sent_total < connection->output.size)
+    {
+        const unsigned char* data = connection->output.data + sent_total;
+        size_t length = connection->output.size - sent_total;
+        ssize_t sent;
+#ifdef USE_OPENSSL
+        if (connection->ssl != NULL)
+        {
+            int ssl_sent = SSL_write(connection->ssl, data, (length > INT32_MAX) ? INT32_MAX : (int)length);
+            if (ssl_sent <= 0)
+            {
+                int error = SSL_get_error(connection->ssl, ssl_sent);
+                if (error != SSL_ERROR_WANT_READ && error != SSL_ERROR_WANT_WRITE)
+                {
+                    result = false;
+                }
+                break;
+            }
+            sent = ssl_sent;
+        }
+        else
+#endif
+        {
+            sent = send(connection->socket, data, length, MSG_NOSIGNAL);
+            if (sent < 0)
+            {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                {
+                    result = false;
+                }
+                break;
+            }
+        }
+        sent_total += (size_t)sent;
+    }
+    buffer_consume(&connection->output, sent_total);
+    return result;
+}
+
+static void destroy_connection(CONNECTION* connection)
+{
+    size_t index;
+#ifdef USE_OPENSSL
+    if (connection->ssl != NULL)
+    {
+        (void)SSL_shutdown(connection->ssl);
+        SSL_free(connection->ssl);
+    }
+#endif
+    (void)close(connection->socket);
+    for (index = 0; index < connection->subscription_count; index++)
+    {
+        free(connection->subscriptions[index].filter);
+    }
+    free(connection->subscriptions);
+    free(connection->input.data);
+    free(connection->output.data);
+    free(connection);
+}
+
+static int set_non_blocking(int socket_fd)
+{
+    int flags = fcntl(socket_fd, F_GETFL, 0);
+    return (flags == -1 || fcntl(socket_fd, F_SETFL, flags | O_NONBLOCK) == -1) ? __LINE__ : 0;
+}
+
+static void accept_connection(LOOPBACK_BROKER* broker, int listen_socket, bool use_tls)
+{
+    int accepted_socket = accept(listen_socket, NULL, NULL);
+    if (accepted_socket == -1)
+    {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+        {
+            LogError("accept failed with errno %d", errno);
+        }
+    }
+    else
+    {
+        int no_delay = 1;
+        CONNECTION** new_connections;
+        CONNECTION* connection = (CONNECTION*)calloc(1, sizeof(CONNECTION));
+        if (connection == NULL)
+        {
+            LogError("failure allocating a connection");
+            (void)close(accepted_socket);
+        }
+        else if ((connection->socket = accepted_socket, set_non_blocking(accepted_socket)) != 0)
+        {
+            LogError("failure making the connection non blocking");
+            destroy_connection(connection);
+        }
+        else if ((new_connections = (CONNECTION**)realloc(broker->connections, (broker->connection_count + 1) * sizeof(CONNECTION*))) == NULL)
+        {
+            LogError("failure growing the connection list");
+            destroy_connection(connection);
+        }
+        else
+        {
+            bool created = true;
+            broker->connections = new_connections;
+            (void)setsockopt(accepted_socket, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+#ifdef USE_OPENSSL
+            if (use_tls)
+            {
+                connection->ssl = SSL_new(broker->ssl_context);
+                if (connection->ssl == NULL || SSL_set_fd(connection->ssl, accepted_socket) != 1)
+                {
+                    LogError("failure creating the TLS session");
+                    created = false;
+                }
+                else
+                {
+                    SSL_set_mode(connection->ssl, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+                    SSL_set_accept_state(connection->ssl);
+                }
+            }
+#else
+            (void)use_tls;
+#endif
+            if (!created)
+            {
+                destroy_connection(connection);
+            }
+            else
+            {
+                broker->connections[broker->connection_count++] = connection;
+                broker->statistics.connections++;
+            }
+        }
+    }
+}
+
+static int broker_thread(void* context)
+{
+    LOOPBACK_BROKER* broker = (LOOPBACK_BROKER*)context;
+
+    while (!__atomic_load_n(&broker->stop, __ATOMIC_ACQUIRE))
+    {
+        size_t fd_count = 0;
+        size_t index;
+
+        if (broker->poll_fds_capacity < broker->connection_count + 2)
+        {
+            size_t new_capacity = (broker->connection_count + 2) * 2;
+            struct pollfd* new_poll_fds = (struct pollfd*)realloc(broker->poll_fds, new_capacity * sizeof(struct pollfd));
+            if (new_poll_fds == NULL)
+            {
+                LogError("failure growing the poll list");
+                ThreadAPI_Sleep(POLL_TIMEOUT_MS);
+                continue;
+            }
+            broker->poll_fds = new_poll_fds;
+            broker->poll_fds_capacity = new_capacity;
+        }
+
+        broker->poll_fds[0].fd = broker->tcp_socket;
+        broker->poll_fds[0].events = POLLIN;
+        broker->poll_fds[1].fd = broker->tls_socket;
+        broker->poll_fds[1].events = POLLIN;
+        fd_count = 2;
+        for (index = 0; index < broker->connection_count; index++)
+        {
+            CONNECTION* connection = broker->connections[index];
+            broker->poll_fds[fd_count].fd = connection->socket;
+            broker->poll_fds[fd_count].events = POLLIN;
+#ifdef USE_OPENSSL
+            if (connection->wants_write)
+            {
+                broker->poll_fds[fd_count].events |= POLLOUT;
+            }
+#endif
+            if (connection->output.size > 0)
+            {
+                broker->poll_fds[fd_count].events |= POLLOUT;
+            }
+            broker->poll_fds[fd_count].revents = 0;
+            fd_count++;
+        }
+        broker->poll_fds[0].revents = 0;
+        broker->poll_fds[1].revents = 0;
+
+        // a negative fd is skipped by poll, so a port that is not listened on costs nothing
+        if (poll(broker->poll_fds, (nfds_t)fd_count, POLL_TIMEOUT_MS) <= 0)
+        {
+            continue;
+        }
+
+        // read everything first so a publish reaches subscribers that are later in the list
+        for (index = 0; index < broker->connection_count; index++)
+        {
+            CONNECTION* connection = broker->connections[index];
+            short revents = broker->poll_fds[index + 2].revents;
+            if ((revents & (POLLIN | POLLHUP | POLLERR)) != 0
+#ifdef USE_OPENSSL
+                || (connection->wants_write && (revents & POLLOUT) != 0)
+#endif
+                )
+            {
+                // what arrived before the peer closed, a DISCONNECT for one, is still handled
+                bool is_open = read_input(connection);
+                process_input(broker, connection);
+                if (!is_open)
+                {
+                    connection->closing = true;
+                    // nothing more can be sent to a peer that is gone
+                    connection->output.size = 0;
+                }
+            }
+        }
+
+        index = 0;
+        while (index < broker->connection_count)
+        {
+            CONNECTION* connection = broker->connections[index];
+            if (!flush_output(connection) || (connection->closing && connection->output.size == 0))
+            {
+                destroy_connection(connection);
+                broker->connections[index] = broker->connections[--broker->connection_count];
+            }
+            else
+            {
+                index++;
+            }
+        }
+
+        // new connections go last, the poll list above no longer matches the connection list
+        if ((broker->poll_fds[0].revents & POLLIN) != 0)
+        {
+            accept_connection(broker, broker->tcp_socket, false);
+        }
+        if ((broker->poll_fds[1].revents & POLLIN) != 0)
+        {
+            accept_connection(broker, broker->tls_socket, true);
+        }
+    }
+    return 0;
+}
+
+// binds port, or a free port when it is 0, and returns the port it is bound to in bound_port
+static int create_listen_socket(uint16_t port, uint16_t* bound_port)
+{
+    int result = socket(AF_INET, SOCK_STREAM, 0);
+    if (result == -1)
+    {
+        LogError("socket failed with errno %d", errno);
+    }
+    else
+    {
+        int reuse = 1;
+        struct sockaddr_in address;
+        (void)memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        (void)setsockopt(result, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        if (bind(result, (struct sockaddr*)&address, sizeof(address)) != 0)
+        {
+            LogError("cannot bind 127.0.0.1:%u, errno %d", (unsigned int)port, errno);
+            (void)close(result);
+            result = -1;
+        }
+        else if (listen(result, SOMAXCONN) != 0 || set_non_blocking(result) != 0)
+        {
+            LogError("cannot listen on 127.0.0.1:%u, errno %d", (unsigned int)port, errno);
+            (void)close(result);
+            result = -1;
+        }
+        else
+        {
+            socklen_t address_length = sizeof(address);
+            if (getsockname(result, (struct sockaddr*)&address, &address_length) != 0)
+            {
+                LogError("cannot read the port bound on 127.0.0.1:%u, errno %d", (unsigned int)port, errno);
+                (void)close(result);
+                result = -1;
+            }
+            else
+            {
+                *bound_port = ntohs(address.sin_port);
+            }
+        }
+    }
+    return result;
+}
+
+#ifdef USE_OPENSSL
+/*generates an RSA key and a self-signed certificate for 127.0.0.1 that is valid for a day,
+installs them in the TLS context and keeps the PEM form for the clients to trust*/
+static int create_tls_context(LOOPBACK_BROKER* broker)
+{
+    int result = __LINE__;
+    EVP_PKEY* key = NULL;
+    EVP_PKEY_CTX* key_context = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, NULL);
+    X509* certificate = X509_new();
+    BIO* pem = BIO_new(BIO_s_mem());
+
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+    SSL_library_init();
+    SSL_load_error_strings();
+    broker->ssl_context = SSL_CTX_new(SSLv23_server_method());
+#else
+    broker->ssl_context = SSL_CTX_new(TLS_server_method());
+#endif
+
+    if (broker->ssl_context == NULL || key_context == NULL || certificate == NULL || pem == NULL)
+    {
+        LogError("failure allocating the OpenSSL objects");
+    }
+    else if (EVP_PKEY_keygen_init(key_context) <= 0 ||
+        EVP_PKEY_CTX_set_rsa_keygen_bits(key_context, 2048) <= 0 ||
+        EVP_PKEY_keygen(key_context, &key) <= 0)
+    {
+        LogError("failure generating the broker key");
+    }
+    else
+    {
+        X509_NAME* name = X509_get_subject_name(certificate);
+        X509_EXTENSION* basic_constraints = X509V3_EXT_conf_nid(NULL, NULL, NID_basic_constraints, (char*)"critical,CA:TRUE");
+
+        (void)X509_set_version(certificate, 2);
+        (void)ASN1_INTEGER_set(X509_get_serialNumber(certificate), 1);
+        (void)X509_gmtime_adj(X509_get_notBefore(certificate), -60);
+        (void)X509_gmtime_adj(X509_get_notAfter(certificate), 24 * 60 * 60);
+        (void)X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char*)"127.0.0.1", -1, -1, 0);
+        (void)X509_set_issuer_name(certificate, name);
+
+        if (basic_constraints == NULL || X509_add_ext(certificate, basic_constraints, -1) != 1 ||
+            X509_set_pubkey(certificate, key) != 1 ||
+            X509_sign(certificate, key, EVP_sha256()) == 0)
+        {
+            LogError("failure signing the broker certificate");
+        }
+        else if (SSL_CTX_use_certificate(broker->ssl_context, certificate) != 1 ||
+            SSL_CTX_use_PrivateKey(broker->ssl_context, key) != 1)
+        {
+            LogError("failure installing the broker certificate");
+        }
+        else if (PEM_write_bio_X509(pem, certificate) != 1)
+        {
+            LogError("failure writing the broker certificate");
+        }
+        else
+        {
+            char* pem_data;
+            long pem_length = BIO_get_mem_data(pem, &pem_data);
+            broker->certificate = (char*)malloc((size_t)pem_length + 1);
+            if (broker->certificate == NULL)
+            {
+                LogError("failure allocating the certificate");
+            }
+            else
+            {
+                (void)memcpy(broker->certificate, pem_data, (size_t)pem_length);
+                broker->certificate[pem_length] = '\0';
+                result = 0;
+            }
+        }
+        X509_EXTENSION_free(basic_constraints);
+    }
+
+    BIO_free(pem);
+    X509_free(certificate);
+    EVP_PKEY_free(key);
+    EVP_PKEY_CTX_free(key_context);
+    return result;
+}
+#endif
+
+static void destroy_broker(LOOPBACK_BROKER* broker)
+{
+    size_t index;
+    for (index = 0; index < broker->connection_count; index++)
+    {
+        destroy_connection(broker->connections[index]);
+    }
+    if (broker->tcp_socket != -1)
+    {
+        (void)close(broker->tcp_socket);
+    }
+    if (broker->tls_socket != -1)
+    {
+        (void)close(broker->tls_socket);
+    }
+#ifdef USE_OPENSSL
+    if (broker->ssl_context != NULL)
+    {
+        SSL_CTX_free(broker->ssl_context);
+    }
+#endif
+    free(broker->certificate);
+    free(broker->connections);
+    free(broker->poll_fds);
+    free(broker);
+}
+
+LOOPBACK_BROKER_HANDLE loopback_broker_start(const LOOPBACK_BROKER_CONFIG* config)
+{
+    LOOPBACK_BROKER* result;
+
+    if (config == NULL || (!config->use_tcp && !config->use_tls))
+    {
+        LogError("invalid arguments: config = %p", config);
+        result = NULL;
+    }
+#ifndef USE_OPENSSL
+    else if (config->use_tls)
+    {
+        LogError("the loopback broker was built without OpenSSL and cannot listen on TLS");
+        result = NULL;
+    }
+#endif
+    else if ((result = (LOOPBACK_BROKER*)calloc(1, sizeof(LOOPBACK_BROKER))) == NULL)
+    {
+        LogError("failure allocating the broker");
+    }
+    else
+    {
+        bool started = false;
+        result->tcp_socket = -1;
+        result->tls_socket = -1;
+
+        if (config->use_tcp && (result->tcp_socket = create_listen_socket(config->tcp_port, &result->tcp_port)) == -1)
+        {
+            LogError("failure listening on the TCP port");
+        }
+#ifdef USE_OPENSSL
+        else if (config->use_tls && create_tls_context(result) != 0)
+        {
+            LogError("failure creating the TLS context");
+        }
+#endif
+        else if (config->use_tls && (result->tls_socket = create_listen_socket(config->tls_port, &result->tls_port)) == -1)
+        {
+            LogError("failure listening on the TLS port");
+        }
+        else if (ThreadAPI_Create(&result->thread, broker_thread, result) != THREADAPI_OK)
+        {
+            LogError("failure starting the broker thread");
+        }
+        else
+        {
+            started = true;
+        }
+
+        if (!started)
+        {
+            destroy_broker(result);
+            result = NULL;
+        }
+    }
+    return result;
+}
+
+uint16_t loopback_broker_get_tcp_port(LOOPBACK_BROKER_HANDLE broker)
+{
+    return (broker == NULL) ? 0 : broker->tcp_port;
+}
+
+uint16_t loopback_broker_get_tls_port(LOOPBACK_BROKER_HANDLE broker)
+{
+    return (broker == NULL) ? 0 : broker->tls_port;
+}
+
+const char* loopback_broker_get_certificate(LOOPBACK_BROKER_HANDLE broker)
+{
+    return (broker == NULL) ? NULL : broker->certificate;
+}
+
+void loopback_broker_get_statistics(LOOPBACK_BROKER_HANDLE broker, LOOPBACK_BROKER_STATISTICS* statistics)
+{
+    if (broker != NULL && statistics != NULL)
+    {
+        *statistics = broker->statistics;
+    }
+}
+
+void loopback_broker_stop(LOOPBACK_BROKER_HANDLE broker)
+{
+    if (broker != NULL)
+    {
+        int thread_result;
+        __atomic_store_n(&broker->stop, 1, __ATOMIC_RELEASE);
+        (void)ThreadAPI_Join(broker->thread, &thread_result);
+        destroy_broker(broker);
+    }
+}
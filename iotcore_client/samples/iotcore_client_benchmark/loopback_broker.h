@@ -0,0 +1,82 @@
+/*
+* Copyright (c) 2017 Baidu, Inc. All Rights Reserved.
+*
+* Licensed to the Apache Software Foundation (ASF) under one or more
+* contributor license agreements.  See the NOTICE file distributed with
+* this work for additional information regarding copyright ownership.
+* The ASF licenses this file to You under the Apache License, Version 2.0
+* (the "License"); you may not use this file except in compliance with
+* the License.  You may obtain a copy of the License at
+*
+*    http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef LOOPBACK_BROKER_H
+#define LOOPBACK_BROKER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A minimal MQTT 3.1.1 broker that listens on 127.0.0.1, for benchmarks and local runs of
+ * iotcore_client without an IoT Core endpoint. It runs on its own thread and handles
+ * CONNECT, PUBLISH with qos 0 and 1, SUBSCRIBE, UNSUBSCRIBE, PINGREQ and DISCONNECT.
+ * Every CONNECT is accepted, there are no retained messages, no sessions and no qos 2;
+ * a qos 1 message is delivered once to each matching subscription and never resent.
+ */
+
+typedef struct LOOPBACK_BROKER_CONFIG_TAG
+{
+    // listen on plain TCP
+    int use_tcp;
+    // plain TCP port, 0 binds a free port that loopback_broker_get_tcp_port returns
+    uint16_t tcp_port;
+    // listen on TLS. TLS needs the benchmark built with OpenSSL; the broker then
+    // generates a self-signed certificate for 127.0.0.1 when it starts
+    int use_tls;
+    // TLS port, 0 binds a free port that loopback_broker_get_tls_port returns
+    uint16_t tls_port;
+} LOOPBACK_BROKER_CONFIG;
+
+typedef struct LOOPBACK_BROKER_STATISTICS_TAG
+{
+    size_t connections;
+    size_t publishes_received;
+    size_t publishes_delivered;
+} LOOPBACK_BROKER_STATISTICS;
+
+typedef struct LOOPBACK_BROKER_TAG* LOOPBACK_BROKER_HANDLE;
+
+// Binds the ports and starts the broker thread, NULL on failure.
+LOOPBACK_BROKER_HANDLE loopback_broker_start(const LOOPBACK_BROKER_CONFIG* config);
+
+// The port the broker listens on for plain TCP, 0 without TCP.
+uint16_t loopback_broker_get_tcp_port(LOOPBACK_BROKER_HANDLE broker);
+
+// The port the broker listens on for TLS, 0 without TLS.
+uint16_t loopback_broker_get_tls_port(LOOPBACK_BROKER_HANDLE broker);
+
+// The PEM certificate clients have to trust to connect on the TLS port, NULL without TLS.
+const char* loopback_broker_get_certificate(LOOPBACK_BROKER_HANDLE broker);
+
+// Counters of the broker thread; they are read without locking, call it after the run is done.
+void loopback_broker_get_statistics(LOOPBACK_BROKER_HANDLE broker, LOOPBACK_BROKER_STATISTICS* statistics);
+
+// Closes every connection, stops the thread and frees the broker.
+void loopback_broker_stop(LOOPBACK_BROKER_HANDLE broker);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LOOPBACK_BROKER_H
@@ -244,6 +244,16 @@ int iotcore_mqtt_client_run(void)
             free(_test_sub_topic);
             _test_sub_topic = NULL;
         }
+
+        IOTCORE_MQTT_STATISTICS _statistics;
+        if (iotcore_mqtt_get_statistics(_client_handle, &_statistics) == 0)
+        {
+            printf("published %u messages, %u acked, publish latency p50 %u ms, p99 %u ms, max %u ms.\n",
+                   _statistics.publish_count, _statistics.puback_count,
+                   iotcore_mqtt_histogram_percentile(&_statistics.publish_latency, 50),
+                   iotcore_mqtt_histogram_percentile(&_statistics.publish_latency, 99),
+                   _statistics.publish_latency.max_ms);
+        }
         iotcore_mqtt_destroy(_client_handle);
         return 0;
     }
@@ -0,0 +1,82 @@
+/*
+* Copyright (c) 2017 Baidu, Inc. All Rights Reserved.
+*
+* Licensed to the Apache Software Foundation (ASF) under one or more
+* contributor license agreements.  See the NOTICE file distributed with
+* this work for additional information regarding copyright ownership.
+* The ASF licenses this file to You under the Apache License, Version 2.0
+* (the "License"); you may not use this file except in compliance with
+* the License.  You may obtain a copy of the License at
+*
+*    http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef IOTCORE_ATOMIC_H
+#define IOTCORE_ATOMIC_H
+
+#include <stdint.h>
+
+// Atomic operations on uint32_t and uint64_t fields for the client's private modules.
+// ATOMIC_LOAD, ATOMIC_STORE and the read-modify-write macros are relaxed, ATOMIC_LOAD_ACQUIRE
+// and ATOMIC_STORE_RELEASE order the accesses around them. ATOMIC_CAS updates expected with
+// the current value when it fails. IOTCORE_ATOMIC_NOT_AVAILABLE is defined when the compiler
+// has no known atomics: the macros are then plain accesses, and fields shared between
+// threads need a lock.
+
+#if defined(_MSC_VER)
+#include <windows.h>
+
+// the Interlocked functions are full barriers
+#define ATOMIC_LOAD(var) (uint32_t)InterlockedCompareExchange((volatile LONG*)&(var), 0, 0)
+#define ATOMIC_LOAD_ACQUIRE(var) ATOMIC_LOAD(var)
+#define ATOMIC_LOAD64(var) (uint64_t)InterlockedCompareExchange64((volatile LONGLONG*)&(var), 0, 0)
+#define ATOMIC_STORE(var, value) (void)InterlockedExchange((volatile LONG*)&(var), (LONG)(value))
+#define ATOMIC_STORE_RELEASE(var, value) ATOMIC_STORE(var, value)
+#define ATOMIC_INC(var) (void)InterlockedIncrement((volatile LONG*)&(var))
+#define ATOMIC_DEC(var) (uint32_t)InterlockedDecrement((volatile LONG*)&(var))
+#define ATOMIC_ADD64(var, value) (void)InterlockedExchangeAdd64((volatile LONGLONG*)&(var), (LONGLONG)(value))
+#define ATOMIC_CAS(var, expected, desired) iotcore_atomic_compare_and_swap((volatile LONG*)&(var), &(expected), (desired))
+
+static __inline int iotcore_atomic_compare_and_swap(volatile LONG* var, uint32_t* expected, uint32_t desired)
+{
+    LONG previous = InterlockedCompareExchange(var, (LONG)desired, (LONG)*expected);
+    int result = ((uint32_t)previous == *expected);
+    *expected = (uint32_t)previous;
+    return result;
+}
+
+#elif defined(__GNUC__)
+
+#define ATOMIC_LOAD(var) __atomic_load_n(&(var), __ATOMIC_RELAXED)
+#define ATOMIC_LOAD_ACQUIRE(var) __atomic_load_n(&(var), __ATOMIC_ACQUIRE)
+#define ATOMIC_LOAD64(var) __atomic_load_n(&(var), __ATOMIC_RELAXED)
+#define ATOMIC_STORE(var, value) __atomic_store_n(&(var), (value), __ATOMIC_RELAXED)
+#define ATOMIC_STORE_RELEASE(var, value) __atomic_store_n(&(var), (value), __ATOMIC_RELEASE)
+#define ATOMIC_INC(var) (void)__atomic_add_fetch(&(var), 1, __ATOMIC_RELAXED)
+#define ATOMIC_DEC(var) __atomic_sub_fetch(&(var), 1, __ATOMIC_RELAXED)
+#define ATOMIC_ADD64(var, value) (void)__atomic_add_fetch(&(var), (value), __ATOMIC_RELAXED)
+#define ATOMIC_CAS(var, expected, desired) __atomic_compare_exchange_n(&(var), &(expected), (desired), 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+
+#else
+
+#define IOTCORE_ATOMIC_NOT_AVAILABLE
+
+#define ATOMIC_LOAD(var) (var)
+#define ATOMIC_LOAD_ACQUIRE(var) (var)
+#define ATOMIC_LOAD64(var) (var)
+#define ATOMIC_STORE(var, value) (void)((var) = (value))
+#define ATOMIC_STORE_RELEASE(var, value) (void)((var) = (value))
+#define ATOMIC_INC(var) (void)(++(var))
+#define ATOMIC_DEC(var) (--(var))
+#define ATOMIC_ADD64(var, value) (void)((var) += (value))
+#define ATOMIC_CAS(var, expected, desired) (((var) == (expected)) ? ((var) = (desired), 1) : ((expected) = (var), 0))
+
+#endif
+
+#endif // IOTCORE_ATOMIC_H
@@ -0,0 +1,226 @@
+/*
+* Copyright (c) 2017 Baidu, Inc. All Rights Reserved.
+*
+* Licensed to the Apache Software Foundation (ASF) under one or more
+* contributor license agreements.  See the NOTICE file distributed with
+* this work for additional information regarding copyright ownership.
+* The ASF licenses this file to You under the Apache License, Version 2.0
+* (the "License"); you may not use this file except in compliance with
+* the License.  You may obtain a copy of the License at
+*
+*    http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "iotcore_metrics.h"
+
+#include <limits.h>
+#include <string.h>
+#include "iotcore_atomic.h"
+
+// the counters are not locked when IOTCORE_ATOMIC_NOT_AVAILABLE is defined, they are still
+// right when they are only read from the thread that drives the client
+
+// 2 bits of the value below its highest set bit pick one of 4 buckets in each power of two
+#define HISTOGRAM_SUB_BUCKET_BITS 2
+#define HISTOGRAM_SUB_BUCKET_COUNT (1 << HISTOGRAM_SUB_BUCKET_BITS)
+
+static size_t get_highest_bit(uint32_t value)
+{
+    size_t result = 0;
+    while (value >>= 1)
+    {
+        result++;
+    }
+    return result;
+}
+
+static size_t get_bucket_index(uint32_t value)
+{
+    size_t result;
+    if (value < HISTOGRAM_SUB_BUCKET_COUNT)
+    {
+        result = value;
+    }
+    else
+    {
+        size_t highest_bit = get_highest_bit(value);
+        size_t sub_bucket = (value >> (highest_bit - HISTOGRAM_SUB_BUCKET_BITS)) & (HISTOGRAM_SUB_BUCKET_COUNT - 1);
+        result = ((highest_bit - HISTOGRAM_SUB_BUCKET_BITS + 1) * HISTOGRAM_SUB_BUCKET_COUNT) + sub_bucket;
+    }
+    return result;
+}
+
+uint32_t iotcore_mqtt_histogram_bucket_lower_bound(size_t bucket)
+{
+    uint32_t result;
+    if (bucket < HISTOGRAM_SUB_BUCKET_COUNT)
+    {
+        result = (uint32_t)bucket;
+    }
+    else if (bucket >= IOTCORE_MQTT_HISTOGRAM_BUCKET_COUNT)
+    {
+        result = UINT32_MAX;
+    }
+    else
+    {
+        size_t highest_bit = (bucket / HISTOGRAM_SUB_BUCKET_COUNT) + HISTOGRAM_SUB_BUCKET_BITS - 1;
+        uint32_t sub_bucket = (uint32_t)(bucket % HISTOGRAM_SUB_BUCKET_COUNT);
+        result = ((uint32_t)HISTOGRAM_SUB_BUCKET_COUNT + sub_bucket) << (highest_bit - HISTOGRAM_SUB_BUCKET_BITS);
+    }
+    return result;
+}
+
+uint32_t iotcore_mqtt_histogram_bucket_upper_bound(size_t bucket)
+{
+    // the last bucket goes up to UINT32_MAX, the others end right before the next one starts
+    return (bucket + 1 >= IOTCORE_MQTT_HISTOGRAM_BUCKET_COUNT) ? UINT32_MAX : iotcore_mqtt_histogram_bucket_lower_bound(bucket + 1) - 1;
+}
+
+uint32_t iotcore_mqtt_histogram_percentile(const IOTCORE_MQTT_HISTOGRAM* histogram, double percentile)
+{
+    uint32_t result = 0;
+    if (histogram != NULL && histogram->count > 0)
+    {
+        uint64_t seen = 0;
+        uint64_t rank;
+        size_t index;
+
+        if (percentile <= 0.0)
+        {
+            rank = 1;
+        }
+        else if (percentile >= 100.0)
+        {
+            rank = histogram->count;
+        }
+        else
+        {
+            // the smallest rank that has at least percentile % of the values at or below it
+            double exact_rank = (percentile * histogram->count) / 100.0;
+            rank = (uint64_t)exact_rank;
+            if ((double)rank < exact_rank || rank == 0)
+            {
+                rank++;
+            }
+        }
+
+        for (index = 0; index < IOTCORE_MQTT_HISTOGRAM_BUCKET_COUNT; index++)
+        {
+            seen += histogram->buckets[index];
+            if (seen >= rank)
+            {
+                // the upper bound never reports less than the values really were, and no value is above max_ms
+                result = iotcore_mqtt_histogram_bucket_upper_bound(index);
+                if (result > histogram->max_ms && histogram->max_ms >= iotcore_mqtt_histogram_bucket_lower_bound(index))
+                {
+                    result = histogram->max_ms;
+                }
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+void iotcore_metrics_init(IOTCORE_MQTT_STATISTICS* metrics)
+{
+    memset(metrics, 0, sizeof(IOTCORE_MQTT_STATISTICS));
+    metrics->publish_latency.min_ms = UINT32_MAX;
+    metrics->connect_latency.min_ms = UINT32_MAX;
+    metrics->doconnect_duration.min_ms = UINT32_MAX;
+}
+
+void iotcore_metrics_increment(uint32_t* counter)
+{
+    ATOMIC_INC(*counter);
+}
+
+void iotcore_metrics_gauge_increment(IOTCORE_MQTT_GAUGE* gauge)
+{
+    uint32_t current;
+    uint32_t max;
+
+    ATOMIC_INC(gauge->current);
+    current = ATOMIC_LOAD(gauge->current);
+    max = ATOMIC_LOAD(gauge->max);
+    while (current > max && !ATOMIC_CAS(gauge->max, max, current))
+    {
+    }
+}
+
+void iotcore_metrics_gauge_decrement(IOTCORE_MQTT_GAUGE* gauge)
+{
+    // an entry is only removed after it was counted in, but never let a mismatch wrap around
+    if (ATOMIC_DEC(gauge->current) == UINT32_MAX)
+    {
+        ATOMIC_STORE(gauge->current, 0);
+    }
+}
+
+void iotcore_metrics_histogram_record(IOTCORE_MQTT_HISTOGRAM* histogram, uint64_t value_ms)
+{
+    uint32_t value = (value_ms > UINT32_MAX) ? UINT32_MAX : (uint32_t)value_ms;
+    uint32_t min;
+    uint32_t max;
+
+    ATOMIC_INC(histogram->buckets[get_bucket_index(value)]);
+    ATOMIC_ADD64(histogram->sum_ms, value);
+
+    min = ATOMIC_LOAD(histogram->min_ms);
+    while (value < min && !ATOMIC_CAS(histogram->min_ms, min, value))
+    {
+    }
+    max = ATOMIC_LOAD(histogram->max_ms);
+    while (value > max && !ATOMIC_CAS(histogram->max_ms, max, value))
+    {
+    }
+
+    // the count goes last so a reader never sees more values than the buckets hold
+    ATOMIC_INC(histogram->count);
+}
+
+static void snapshot_gauge(const IOTCORE_MQTT_GAUGE* gauge, IOTCORE_MQTT_GAUGE* snapshot)
+{
+    snapshot->current = ATOMIC_LOAD(gauge->current);
+    snapshot->max = ATOMIC_LOAD(gauge->max);
+}
+
+static void snapshot_histogram(const IOTCORE_MQTT_HISTOGRAM* histogram, IOTCORE_MQTT_HISTOGRAM* snapshot)
+{
+    size_t index;
+
+    snapshot->count = ATOMIC_LOAD(histogram->count);
+    snapshot->sum_ms = ATOMIC_LOAD64(histogram->sum_ms);
+    snapshot->min_ms = (snapshot->count == 0) ? 0 : ATOMIC_LOAD(histogram->min_ms);
+    snapshot->max_ms = ATOMIC_LOAD(histogram->max_ms);
+    for (index = 0; index < IOTCORE_MQTT_HISTOGRAM_BUCKET_COUNT; index++)
+    {
+        snapshot->buckets[index] = ATOMIC_LOAD(histogram->buckets[index]);
+    }
+}
+
+void iotcore_metrics_snapshot(const IOTCORE_MQTT_STATISTICS* metrics, IOTCORE_MQTT_STATISTICS* snapshot)
+{
+    snapshot->publish_count = ATOMIC_LOAD(metrics->publish_count);
+    snapshot->publish_failed_count = ATOMIC_LOAD(metrics->publish_failed_count);
+    snapshot->puback_count = ATOMIC_LOAD(metrics->puback_count);
+    snapshot->puback_failed_count = ATOMIC_LOAD(metrics->puback_failed_count);
+    snapshot->receive_count = ATOMIC_LOAD(metrics->receive_count);
+    snapshot->connect_attempt_count = ATOMIC_LOAD(metrics->connect_attempt_count);
+    snapshot->connect_failed_count = ATOMIC_LOAD(metrics->connect_failed_count);
+    snapshot->connection_count = ATOMIC_LOAD(metrics->connection_count);
+    snapshot->connection_lost_count = ATOMIC_LOAD(metrics->connection_lost_count);
+    snapshot_gauge(&metrics->pub_ack_waiting, &snapshot->pub_ack_waiting);
+    snapshot_gauge(&metrics->sub_ack_waiting, &snapshot->sub_ack_waiting);
+    snapshot_gauge(&metrics->publish_queued, &snapshot->publish_queued);
+    snapshot->publish_queue_full_count = ATOMIC_LOAD(metrics->publish_queue_full_count);
+    snapshot_histogram(&metrics->publish_latency, &snapshot->publish_latency);
+    snapshot_histogram(&metrics->connect_latency, &snapshot->connect_latency);
+    snapshot_histogram(&metrics->doconnect_duration, &snapshot->doconnect_duration);
+}
@@ -0,0 +1,52 @@
+/*
+* Copyright (c) 2017 Baidu, Inc. All Rights Reserved.
+*
+* Licensed to the Apache Software Foundation (ASF) under one or more
+* contributor license agreements.  See the NOTICE file distributed with
+* this work for additional information regarding copyright ownership.
+* The ASF licenses this file to You under the Apache License, Version 2.0
+* (the "License"); you may not use this file except in compliance with
+* the License.  You may obtain a copy of the License at
+*
+*    http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef IOTCORE_METRICS_H
+#define IOTCORE_METRICS_H
+
+#include "iotcore_mqtt_client.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// The metrics are updated by the thread that drives the client and read by
+// iotcore_mqtt_get_statistics from any thread, so every update is a single atomic
+// operation on one field and nothing is locked.
+
+void iotcore_metrics_init(IOTCORE_MQTT_STATISTICS* metrics);
+
+void iotcore_metrics_increment(uint32_t* counter);
+
+void iotcore_metrics_gauge_increment(IOTCORE_MQTT_GAUGE* gauge);
+
+void iotcore_metrics_gauge_decrement(IOTCORE_MQTT_GAUGE* gauge);
+
+void iotcore_metrics_histogram_record(IOTCORE_MQTT_HISTOGRAM* histogram, uint64_t value_ms);
+
+void iotcore_metrics_snapshot(const IOTCORE_MQTT_STATISTICS* metrics, IOTCORE_MQTT_STATISTICS* snapshot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTCORE_METRICS_H
@@ -0,0 +1,202 @@
+/*
+* Copyright (c) 2017 Baidu, Inc. All Rights Reserved.
+*
+* Licensed to the Apache Software Foundation (ASF) under one or more
+* contributor license agreements.  See the NOTICE file distributed with
+* this work for additional information regarding copyright ownership.
+* The ASF licenses this file to You under the Apache License, Version 2.0
+* (the "License"); you may not use this file except in compliance with
+* the License.  You may obtain a copy of the License at
+*
+*    http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "iotcore_mpsc_queue.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "azure_c_shared_utility/xlogging.h"
+#include "iotcore_atomic.h"
+
+#ifdef IOTCORE_ATOMIC_NOT_AVAILABLE
+// push and pop take a lock instead
+#include "azure_c_shared_utility/lock.h"
+#define IOTCORE_MPSC_QUEUE_USE_LOCK
+#endif
+
+typedef struct MPSC_QUEUE_SLOT_TAG
+{
+    // position + 1 once the item at position is readable, position + capacity once the slot is free again
+    volatile uint32_t sequence;
+    void* item;
+} MPSC_QUEUE_SLOT;
+
+typedef struct IOTCORE_MPSC_QUEUE_TAG
+{
+    MPSC_QUEUE_SLOT* slots;
+    uint32_t mask;
+    volatile uint32_t push_position;
+    // only the consumer moves it
+    uint32_t pop_position;
+#ifdef IOTCORE_MPSC_QUEUE_USE_LOCK
+    LOCK_HANDLE lock;
+#endif
+} IOTCORE_MPSC_QUEUE;
+
+IOTCORE_MPSC_QUEUE_HANDLE iotcore_mpsc_queue_create(size_t capacity)
+{
+    IOTCORE_MPSC_QUEUE* result;
+    uint32_t slot_count = 1;
+
+    while (slot_count < capacity && slot_count <= (UINT32_MAX >> 2))
+    {
+        slot_count <<= 1;
+    }
+
+    if (capacity == 0 || slot_count < capacity)
+    {
+        LogError("invalid queue capacity %lu", (unsigned long)capacity);
+        result = NULL;
+    }
+    else if ((result = (IOTCORE_MPSC_QUEUE*)malloc(sizeof(IOTCORE_MPSC_QUEUE))) == NULL)
+    {
+        LogError("failed allocating the queue");
+    }
+    else if ((result->slots = (MPSC_QUEUE_SLOT*)malloc(slot_count * sizeof(MPSC_QUEUE_SLOT))) == NULL)
+    {
+        LogError("failed allocating %lu queue slots", (unsigned long)slot_count);
+        free(result);
+        result = NULL;
+    }
+#ifdef IOTCORE_MPSC_QUEUE_USE_LOCK
+    else if ((result->lock = Lock_Init()) == NULL)
+    {
+        LogError("failed creating the queue lock");
+        free(result->slots);
+        free(result);
+        result = NULL;
+    }
+#endif
+    else
+    {
+        uint32_t index;
+        for (index = 0; index < slot_count; index++)
+        {
+            result->slots[index].sequence = index;
+            result->slots[index].item = NULL;
+        }
+        result->mask = slot_count - 1;
+        result->push_position = 0;
+        result->pop_position = 0;
+    }
+
+    return result;
+}
+
+void iotcore_mpsc_queue_destroy(IOTCORE_MPSC_QUEUE_HANDLE queue)
+{
+    if (queue != NULL)
+    {
+#ifdef IOTCORE_MPSC_QUEUE_USE_LOCK
+        Lock_Deinit(queue->lock);
+#endif
+        free(queue->slots);
+        free(queue);
+    }
+}
+
+int iotcore_mpsc_queue_push(IOTCORE_MPSC_QUEUE_HANDLE queue, void* item)
+{
+    int result;
+    MPSC_QUEUE_SLOT* slot = NULL;
+    uint32_t position;
+
+#ifdef IOTCORE_MPSC_QUEUE_USE_LOCK
+    (void)Lock(queue->lock);
+#endif
+    position = ATOMIC_LOAD_ACQUIRE(queue->push_position);
+    for (;;)
+    {
+        uint32_t sequence;
+        int32_t difference;
+
+        slot = &queue->slots[position & queue->mask];
+        sequence = ATOMIC_LOAD_ACQUIRE(slot->sequence);
+        difference = (int32_t)(sequence - position);
+        if (difference == 0)
+        {
+            // the slot is free for this position, claim it unless another producer did first
+            if (ATOMIC_CAS(queue->push_position, position, position + 1))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            // the consumer has not freed the slot a lap ago: full
+            slot = NULL;
+            break;
+        }
+        else
+        {
+            // another producer took this position meanwhile
+            position = ATOMIC_LOAD_ACQUIRE(queue->push_position);
+        }
+    }
+
+    if (slot == NULL)
+    {
+        result = 1;
+    }
+    else
+    {
+        slot->item = item;
+        ATOMIC_STORE_RELEASE(slot->sequence, position + 1);
+        result = 0;
+    }
+#ifdef IOTCORE_MPSC_QUEUE_USE_LOCK
+    (void)Unlock(queue->lock);
+#endif
+
+    return result;
+}
+
+void* iotcore_mpsc_queue_pop(IOTCORE_MPSC_QUEUE_HANDLE queue)
+{
+    void* result;
+    uint32_t position;
+    MPSC_QUEUE_SLOT* slot;
+
+#ifdef IOTCORE_MPSC_QUEUE_USE_LOCK
+    (void)Lock(queue->lock);
+#endif
+    position = queue->pop_position;
+    slot = &queue->slots[position & queue->mask];
+    if (ATOMIC_LOAD_ACQUIRE(slot->sequence) != position + 1)
+    {
+        // empty, or the producer that claimed this position has not stored its item yet
+        result = NULL;
+    }
+    else
+    {
+        result = slot->item;
+        queue->pop_position = position + 1;
+        ATOMIC_STORE_RELEASE(slot->sequence, position + queue->mask + 1);
+    }
+#ifdef IOTCORE_MPSC_QUEUE_USE_LOCK
+    (void)Unlock(queue->lock);
+#endif
+
+    return result;
+}
+
+size_t iotcore_mpsc_queue_capacity(IOTCORE_MPSC_QUEUE_HANDLE queue)
+{
+    return (size_t)queue->mask + 1;
+}
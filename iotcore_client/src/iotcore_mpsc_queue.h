@@ -0,0 +1,55 @@
+/*
+* Copyright (c) 2017 Baidu, Inc. All Rights Reserved.
+*
+* Licensed to the Apache Software Foundation (ASF) under one or more
+* contributor license agreements.  See the NOTICE file distributed with
+* this work for additional information regarding copyright ownership.
+* The ASF licenses this file to You under the Apache License, Version 2.0
+* (the "License"); you may not use this file except in compliance with
+* the License.  You may obtain a copy of the License at
+*
+*    http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef IOTCORE_MPSC_QUEUE_H
+#define IOTCORE_MPSC_QUEUE_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// A bounded queue of pointers that any number of threads push to and one thread pops from.
+// Each slot carries a sequence number: a producer claims a position with one compare and swap
+// and publishes the slot by moving its sequence, so producers never wait on each other nor on
+// the consumer. A push to a full queue fails right away instead of blocking.
+
+typedef struct IOTCORE_MPSC_QUEUE_TAG* IOTCORE_MPSC_QUEUE_HANDLE;
+
+// capacity is rounded up to a power of two
+IOTCORE_MPSC_QUEUE_HANDLE iotcore_mpsc_queue_create(size_t capacity);
+
+// the queue must be empty or its items owned elsewhere, they are not freed
+void iotcore_mpsc_queue_destroy(IOTCORE_MPSC_QUEUE_HANDLE queue);
+
+// Safe from any thread. Returns 0 when item is queued, non-zero when the queue is full.
+int iotcore_mpsc_queue_push(IOTCORE_MPSC_QUEUE_HANDLE queue, void* item);
+
+// Only from the consumer thread. Returns the oldest item, or NULL when no item is ready.
+void* iotcore_mpsc_queue_pop(IOTCORE_MPSC_QUEUE_HANDLE queue);
+
+size_t iotcore_mpsc_queue_capacity(IOTCORE_MPSC_QUEUE_HANDLE queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTCORE_MPSC_QUEUE_H
@@ -20,6 +20,8 @@
 #include "iotcore_mqtt_client.h"
 #include "iotcore_param_util.h"
 #include "iotcore_retry_logic.h"
+#include "iotcore_metrics.h"
+#include "iotcore_mpsc_queue.h"
 
 #include <limits.h>
 
@@ -33,17 +35,32 @@
 #include "azure_umqtt_c/mqtt_client.h"
 #include "certs.h"
 
+#ifndef MQTT_CONNECTION_TCP_PORT
 #define MQTT_CONNECTION_TCP_PORT 1883
+#endif
+#ifndef MQTT_CONNECTION_TLS_PORT
 #define MQTT_CONNECTION_TLS_PORT 1884
+#endif
 
 #define MQTT_KEEP_ALIVE_INTERVAL    20
 
+// MQTT_PUB_CALLBACK_INFO records kept for reuse once their PUBACK arrived, so QoS 1 publishing does not allocate one per message
+#ifndef MQTT_PUB_CALLBACK_POOL_SIZE
+#define MQTT_PUB_CALLBACK_POOL_SIZE 64
+#endif
+
+// messages publish_mqtt_message_async can queue before it returns IOTCORE_ERR_QUEUE_FULL, rounded up to a power of two
+#ifndef IOTCORE_MQTT_PUBLISH_QUEUE_SIZE
+#define IOTCORE_MQTT_PUBLISH_QUEUE_SIZE 256
+#endif
+
 typedef struct MQTT_PUB_CALLBACK_INFO_TAG
 {
     uint16_t packet_id;
     PUB_CALLBACK pub_callback;
     MQTT_MESSAGE_HANDLE msg_handle;
     void *context;
+    tickcounter_ms_t publish_time;
     DLIST_ENTRY entry;
 } MQTT_PUB_CALLBACK_INFO,* PMQTT_PUB_CALLBACK_INFO;
 
@@ -55,12 +72,26 @@ typedef struct MQTT_SUB_CALLBACK_INFO_TAG
     DLIST_ENTRY entry;
 } MQTT_SUB_CALLBACK_INFO,* PMQTT_SUB_CALLBACK_INFO;
 
+// one allocation per queued message: the topic and the payload follow the structure
+typedef struct MQTT_QUEUED_PUBLISH_TAG
+{
+    IOTCORE_MQTT_QOS qos;
+    PUB_CALLBACK pub_callback;
+    void *context;
+    const char* topic;
+    const uint8_t* payload;
+    size_t payload_length;
+} MQTT_QUEUED_PUBLISH;
+
 typedef struct IOTCORE_MQTT_CLIENT_TAG
 {
     MQTT_CONNECTION_TYPE conn_type;
     char* endpoint;
     char* client_cert;
     char* client_key;
+    const char* trusted_certs;
+    // 0 connects to MQTT_CONNECTION_TCP_PORT or MQTT_CONNECTION_TLS_PORT
+    uint16_t port;
     MQTT_CLIENT_OPTIONS* options;
 
     // Protocol
@@ -87,11 +118,21 @@ typedef struct IOTCORE_MQTT_CLIENT_TAG
     // pub ack wait queue
     DLIST_ENTRY pub_ack_waiting_queue;
 
+    // released pub callback records, linked through the same entry as the wait queue
+    DLIST_ENTRY pub_callback_free_list;
+    size_t pub_callback_free_count;
+
     // sub ack wait queue
     DLIST_ENTRY sub_ack_waiting_queue;
 
+    // MQTT_QUEUED_PUBLISH pushed by publish_mqtt_message_async from any thread, popped by iotcore_mqtt_dowork
+    IOTCORE_MPSC_QUEUE_HANDLE publish_queue;
+
     // subscribe message callback handle
     RECV_MSG_CALLBACK recv_callback;
+
+    // counters returned by iotcore_mqtt_get_statistics
+    IOTCORE_MQTT_STATISTICS metrics;
 } IOTCORE_MQTT_CLIENT;
 
 
@@ -108,6 +149,36 @@ static uint16_t get_next_packet_id(IOTCORE_MQTT_CLIENT_HANDLE transport_data)
     return transport_data->packet_id;
 }
 
+static PMQTT_PUB_CALLBACK_INFO acquire_pub_callback_info(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client)
+{
+    PMQTT_PUB_CALLBACK_INFO _result;
+    PDLIST_ENTRY _free_entry = DList_RemoveHeadList(&iotcore_client->pub_callback_free_list);
+    if (_free_entry != &iotcore_client->pub_callback_free_list)
+    {
+        iotcore_client->pub_callback_free_count--;
+        _result = containingRecord(_free_entry, MQTT_PUB_CALLBACK_INFO, entry);
+    }
+    else
+    {
+        _result = (PMQTT_PUB_CALLBACK_INFO)malloc(sizeof(MQTT_PUB_CALLBACK_INFO));
+    }
+    return _result;
+}
+
+// the record must already be off the wait queue
+static void release_pub_callback_info(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client, PMQTT_PUB_CALLBACK_INFO pub_callback_info)
+{
+    if (iotcore_client->pub_callback_free_count < MQTT_PUB_CALLBACK_POOL_SIZE)
+    {
+        DList_InsertHeadList(&iotcore_client->pub_callback_free_list, &pub_callback_info->entry);
+        iotcore_client->pub_callback_free_count++;
+    }
+    else
+    {
+        free(pub_callback_info);
+    }
+}
+
 static const char* retrieve_mqtt_return_codes(CONNECT_RETURN_CODE rtn_code)
 {
     switch (rtn_code)
@@ -148,6 +219,13 @@ static void on_mqtt_operation_complete(MQTT_CLIENT_HANDLE handle, MQTT_CLIENT_EV
                     _iotcore_client->mqtt_client_status.is_connection_lost = false;
                     _iotcore_client->mqtt_client_status.connect_status = MQTT_CLIENT_CONNECT_STATUS_CONNECTED;
                     stop_retry_timer(_iotcore_client->retry_logic);
+
+                    tickcounter_ms_t _current_time;
+                    if (tickcounter_get_current_ms(_iotcore_client->msg_tick_counter, &_current_time) == 0)
+                    {
+                        iotcore_metrics_histogram_record(&_iotcore_client->metrics.connect_latency, _current_time - _iotcore_client->connect_tick);
+                    }
+                    iotcore_metrics_increment(&_iotcore_client->metrics.connection_count);
                 }
                 else
                 {
@@ -165,6 +243,7 @@ static void on_mqtt_operation_complete(MQTT_CLIENT_HANDLE handle, MQTT_CLIENT_EV
                         _iotcore_client->mqtt_client_status.is_recoverable_error = false;
                     }
                     LogError("Connection Not Accepted: 0x%x: %s", connack->returnCode, retrieve_mqtt_return_codes(connack->returnCode));
+                    iotcore_metrics_increment(&_iotcore_client->metrics.connect_failed_count);
                     (void)mqtt_client_disconnect(_iotcore_client->mqtt_client, NULL, NULL);
                     _iotcore_client->mqtt_client_status.connect_status = MQTT_CLIENT_CONNECT_STATUS_NOT_CONNECTED;
                 }
@@ -200,6 +279,7 @@ static void on_mqtt_operation_complete(MQTT_CLIENT_HANDLE handle, MQTT_CLIENT_EV
                     if (suback->packetId == _sub_handle_entry->packet_id)
                     {
                         (void)DList_RemoveEntryList(_current_list_entry); //First remove the item from Waiting for Ack List.
+                        iotcore_metrics_gauge_decrement(&_iotcore_client->metrics.sub_ack_waiting);
                         _sub_handle_entry->sub_callback((IOTCORE_MQTT_QOS*)(suback->qosReturn), suback->qosCount, _sub_handle_entry->context);
                         free(_sub_handle_entry);
                         break;
@@ -229,10 +309,18 @@ static void on_mqtt_operation_complete(MQTT_CLIENT_HANDLE handle, MQTT_CLIENT_EV
                     if (puback->packetId == _mqtt_msg_entry->packet_id)
                     {
                         (void)DList_RemoveEntryList(_current_list_entry); //First remove the item from Waiting for Ack List.
+                        iotcore_metrics_gauge_decrement(&_iotcore_client->metrics.pub_ack_waiting);
+                        iotcore_metrics_increment(&_iotcore_client->metrics.puback_count);
+
+                        tickcounter_ms_t _current_time;
+                        if (tickcounter_get_current_ms(_iotcore_client->msg_tick_counter, &_current_time) == 0)
+                        {
+                            iotcore_metrics_histogram_record(&_iotcore_client->metrics.publish_latency, _current_time - _mqtt_msg_entry->publish_time);
+                        }
                         _mqtt_msg_entry->pub_callback(MQTT_PUB_SUCCESS, _mqtt_msg_entry->context);
                         // release mqtt message memory
                         mqttmessage_destroy(_mqtt_msg_entry->msg_handle);
-                        free(_mqtt_msg_entry);
+                        release_pub_callback_info(_iotcore_client, _mqtt_msg_entry);
                         break;
                     }
                     _current_list_entry = _save_list_entry.Flink;
@@ -293,6 +381,23 @@ IOTCORE_MQTT_STATUS iotcore_get_mqtt_status(IOTCORE_MQTT_CLIENT_HANDLE iotcore_c
     return iotcore_client->mqtt_client_status;
 }
 
+int iotcore_mqtt_get_statistics(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client, IOTCORE_MQTT_STATISTICS* statistics)
+{
+    int _result = 0;
+
+    if (iotcore_client == NULL || statistics == NULL)
+    {
+        LogError("Failure: iotcore_client or statistics is NULL.");
+        _result = IOTCORE_ERR_INVALID_PARAMETER;
+    }
+    else
+    {
+        iotcore_metrics_snapshot(&iotcore_client->metrics, statistics);
+    }
+
+    return _result;
+}
+
 int publish_mqtt_message(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client, const char* pub_topic_name,
                          IOTCORE_MQTT_QOS qos_value, const uint8_t* pub_msg, size_t pub_msg_length, PUB_CALLBACK pub_callback, void* context)
 {
@@ -301,16 +406,26 @@ int publish_mqtt_message(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client, const char*
     if ( qos_value == DELIVER_EXACTLY_ONCE)
     {
         LogError("Does not support qos = DELIVER_EXACTLY_ONCE");
+        if (pub_callback != NULL)
+        {
+            pub_callback(MQTT_PUB_FAILED, context);
+        }
         _result = IOTCORE_ERR_NOT_SUPPORT;
         return _result;
     }
 
     uint16_t packet_id = get_next_packet_id(iotcore_client);
+    iotcore_metrics_increment(&iotcore_client->metrics.publish_count);
 
     MQTT_MESSAGE_HANDLE mqtt_get_msg = mqttmessage_create(packet_id, pub_topic_name, (QOS_VALUE)qos_value, pub_msg, pub_msg_length);
     if (mqtt_get_msg == NULL)
     {
         LogError("Failed constructing mqtt message.");
+        if (pub_callback != NULL)
+        {
+            pub_callback(MQTT_PUB_FAILED, context);
+        }
+        iotcore_metrics_increment(&iotcore_client->metrics.publish_failed_count);
         _result = IOTCORE_ERR_ERROR;
     }
     else
@@ -318,11 +433,13 @@ int publish_mqtt_message(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client, const char*
         PMQTT_PUB_CALLBACK_INFO _pub_callback_handle = NULL;
         if (qos_value == DELIVER_AT_LEAST_ONCE && pub_callback != NULL)
         {
-            _pub_callback_handle = (PMQTT_PUB_CALLBACK_INFO)malloc(sizeof(MQTT_PUB_CALLBACK_INFO));
+            _pub_callback_handle = acquire_pub_callback_info(iotcore_client);
             if (_pub_callback_handle == NULL)
             {
                 LogError("Fail to allocate memory for MQTT_PUB_CALLBACK_INFO");
                 mqttmessage_destroy(mqtt_get_msg);
+                pub_callback(MQTT_PUB_FAILED, context);
+                iotcore_metrics_increment(&iotcore_client->metrics.publish_failed_count);
                 _result = IOTCORE_ERR_OUT_OF_MEMORY;
                 return _result;
             }
@@ -332,8 +449,13 @@ int publish_mqtt_message(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client, const char*
             _pub_callback_handle->context = context;
             _pub_callback_handle->entry.Flink = NULL;
             _pub_callback_handle->entry.Blink = NULL;
+            if (tickcounter_get_current_ms(iotcore_client->msg_tick_counter, &_pub_callback_handle->publish_time) != 0)
+            {
+                _pub_callback_handle->publish_time = 0;
+            }
 
             DList_InsertTailList(&iotcore_client->pub_ack_waiting_queue, &_pub_callback_handle->entry);
+            iotcore_metrics_gauge_increment(&iotcore_client->metrics.pub_ack_waiting);
         }
 
         if (mqtt_client_publish(iotcore_client->mqtt_client, mqtt_get_msg) != 0)
@@ -342,7 +464,8 @@ int publish_mqtt_message(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client, const char*
             if (_pub_callback_handle != NULL)
             {
                 DList_RemoveEntryList(&_pub_callback_handle->entry);
-                free(_pub_callback_handle);
+                iotcore_metrics_gauge_decrement(&iotcore_client->metrics.pub_ack_waiting);
+                release_pub_callback_info(iotcore_client, _pub_callback_handle);
                 _pub_callback_handle = NULL;
             }
             // Call callback handle directly
@@ -351,6 +474,7 @@ int publish_mqtt_message(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client, const char*
                 pub_callback(MQTT_PUB_FAILED, context);
             }
             LogError("Failed publishing to mqtt client.");
+            iotcore_metrics_increment(&iotcore_client->metrics.publish_failed_count);
             _result = IOTCORE_ERR_ERROR;
         }
         else
@@ -371,6 +495,95 @@ int publish_mqtt_message(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client, const char*
 }
 
 
+int publish_mqtt_message_async(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client, const char* pub_topic_name,
+                               IOTCORE_MQTT_QOS qos_value, const uint8_t* pub_msg, size_t pub_msg_length, PUB_CALLBACK pub_callback, void* context)
+{
+    int _result;
+
+    if (iotcore_client == NULL || pub_topic_name == NULL || (pub_msg == NULL && pub_msg_length > 0))
+    {
+        LogError("invalid parameter to publish_mqtt_message_async");
+        _result = IOTCORE_ERR_INVALID_PARAMETER;
+    }
+    else if (qos_value == DELIVER_EXACTLY_ONCE)
+    {
+        LogError("Does not support qos = DELIVER_EXACTLY_ONCE");
+        _result = IOTCORE_ERR_NOT_SUPPORT;
+    }
+    else
+    {
+        size_t _topic_size = strlen(pub_topic_name) + 1;
+        MQTT_QUEUED_PUBLISH* _queued = (MQTT_QUEUED_PUBLISH*)malloc(sizeof(MQTT_QUEUED_PUBLISH) + _topic_size + pub_msg_length);
+        if (_queued == NULL)
+        {
+            LogError("Fail to allocate memory for MQTT_QUEUED_PUBLISH");
+            _result = IOTCORE_ERR_OUT_OF_MEMORY;
+        }
+        else
+        {
+            char* _topic = (char*)(_queued + 1);
+            uint8_t* _payload = (uint8_t*)_topic + _topic_size;
+            (void)memcpy(_topic, pub_topic_name, _topic_size);
+            if (pub_msg_length > 0)
+            {
+                (void)memcpy(_payload, pub_msg, pub_msg_length);
+            }
+            _queued->qos = qos_value;
+            _queued->pub_callback = pub_callback;
+            _queued->context = context;
+            _queued->topic = _topic;
+            _queued->payload = _payload;
+            _queued->payload_length = pub_msg_length;
+
+            // count it before it becomes visible, the consumer may pop it right away
+            iotcore_metrics_gauge_increment(&iotcore_client->metrics.publish_queued);
+            if (iotcore_mpsc_queue_push(iotcore_client->publish_queue, _queued) != 0)
+            {
+                iotcore_metrics_gauge_decrement(&iotcore_client->metrics.publish_queued);
+                iotcore_metrics_increment(&iotcore_client->metrics.publish_queue_full_count);
+                free(_queued);
+                _result = IOTCORE_ERR_QUEUE_FULL;
+            }
+            else
+            {
+                _result = 0;
+            }
+        }
+    }
+
+    return _result;
+}
+
+// runs on the thread calling iotcore_mqtt_dowork, at most one queue length per call so busy producers cannot keep it here
+static void drain_publish_queue(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client)
+{
+    size_t _count = iotcore_mpsc_queue_capacity(iotcore_client->publish_queue);
+    MQTT_QUEUED_PUBLISH* _queued;
+
+    while (_count-- > 0 && (_queued = (MQTT_QUEUED_PUBLISH*)iotcore_mpsc_queue_pop(iotcore_client->publish_queue)) != NULL)
+    {
+        iotcore_metrics_gauge_decrement(&iotcore_client->metrics.publish_queued);
+        // publish_mqtt_message calls the callback on every failure, the producer hears of it there
+        (void)publish_mqtt_message(iotcore_client, _queued->topic, _queued->qos, _queued->payload, _queued->payload_length, _queued->pub_callback, _queued->context);
+        free(_queued);
+    }
+}
+
+static void fail_publish_queue(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client)
+{
+    MQTT_QUEUED_PUBLISH* _queued;
+
+    while ((_queued = (MQTT_QUEUED_PUBLISH*)iotcore_mpsc_queue_pop(iotcore_client->publish_queue)) != NULL)
+    {
+        iotcore_metrics_gauge_decrement(&iotcore_client->metrics.publish_queued);
+        if (_queued->pub_callback != NULL)
+        {
+            _queued->pub_callback(MQTT_PUB_FAILED, _queued->context);
+        }
+        free(_queued);
+    }
+}
+
 int subscribe_mqtt_topic(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client, const char* sub_topic, 
     IOTCORE_MQTT_QOS ret_qos, SUB_CALLBACK sub_callback, void* context)
 {
@@ -399,6 +612,7 @@ int subscribe_mqtt_topic(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client, const char*
             _sub_callback_handle->entry.Blink = NULL;
 
             DList_InsertTailList(&iotcore_client->sub_ack_waiting_queue, &_sub_callback_handle->entry);
+            iotcore_metrics_gauge_increment(&iotcore_client->metrics.sub_ack_waiting);
         }
 
         SUBSCRIBE_PAYLOAD _sub_payload = { 0 };
@@ -454,6 +668,7 @@ static void notify_subscribe_ack_failure(IOTCORE_MQTT_CLIENT_HANDLE iotcore_clie
         _sub_ack_handle_entry->sub_callback(NULL, 0, _sub_ack_handle_entry->context);
         free(_sub_ack_handle_entry);
         (void)DList_RemoveEntryList(_current_list_entry); //First remove the item from Waiting for Ack List.
+        iotcore_metrics_gauge_decrement(&iotcore_client->metrics.sub_ack_waiting);
         _current_list_entry = _save_list_entry.Flink;
     }
 }
@@ -470,9 +685,11 @@ static void notify_publish_ack_failure(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client
         _save_list_entry.Flink = _current_list_entry->Flink;
 
         (void)DList_RemoveEntryList(_current_list_entry); //First remove the item from Waiting for Ack List.
+        iotcore_metrics_gauge_decrement(&iotcore_client->metrics.pub_ack_waiting);
+        iotcore_metrics_increment(&iotcore_client->metrics.puback_failed_count);
         _mqtt_msg_entry->pub_callback(MQTT_PUB_FAILED, _mqtt_msg_entry->context);
         mqttmessage_destroy(_mqtt_msg_entry->msg_handle);
-        free(_mqtt_msg_entry);
+        release_pub_callback_info(iotcore_client, _mqtt_msg_entry);
         _current_list_entry = _save_list_entry.Flink;
     }
 }
@@ -502,6 +719,14 @@ static void on_mqtt_error_complete(MQTT_CLIENT_HANDLE handle, MQTT_CLIENT_EVENT_
             LogError("receive mqtt client unknown error");
             break;
     }
+    if (iotcore_client->mqtt_client_status.connect_status == MQTT_CLIENT_CONNECT_STATUS_CONNECTED)
+    {
+        iotcore_metrics_increment(&iotcore_client->metrics.connection_lost_count);
+    }
+    else if (iotcore_client->mqtt_client_status.connect_status == MQTT_CLIENT_CONNECT_STATUS_CONNECTING)
+    {
+        iotcore_metrics_increment(&iotcore_client->metrics.connect_failed_count);
+    }
     // mark connection as not connected
     iotcore_client->mqtt_client_status.connect_status = MQTT_CLIENT_CONNECT_STATUS_NOT_CONNECTED;
     iotcore_client->mqtt_client_status.is_connection_lost = true;
@@ -628,24 +853,24 @@ static MQTT_CLIENT_OPTIONS* _construct_mqtt_options(
     return _options;
 }
 
-static XIO_HANDLE create_tcp_connection(const char *endpoint)
+static XIO_HANDLE create_tcp_connection(const char *endpoint, uint16_t port)
 {
-    SOCKETIO_CONFIG config = {endpoint, MQTT_CONNECTION_TCP_PORT, NULL};
+    SOCKETIO_CONFIG config = {endpoint, (port != 0) ? port : MQTT_CONNECTION_TCP_PORT, NULL};
 
     XIO_HANDLE xio = xio_create(socketio_get_interface_description(), &config);
 
     return xio;
 }
 
-static XIO_HANDLE create_tls_connection(const char *endpoint)
+static XIO_HANDLE create_tls_connection(const char *endpoint, uint16_t port, const char *trusted_certs)
 {
-    TLSIO_CONFIG tlsio_config = { endpoint, MQTT_CONNECTION_TLS_PORT };
+    TLSIO_CONFIG tlsio_config = { endpoint, (port != 0) ? port : MQTT_CONNECTION_TLS_PORT };
     // enable wolfssl by set certificates
     // tlsio_config.certificate = certificates;
 
     XIO_HANDLE xio = xio_create(platform_get_default_tlsio(), &tlsio_config);
 
-    if (xio_setoption(xio, "TrustedCerts", certificates) != 0)
+    if (xio_setoption(xio, "TrustedCerts", trusted_certs) != 0)
     {
         LOG(AZ_LOG_ERROR, LOG_LINE, "Fail to assign trusted cert chain");
     }
@@ -653,15 +878,15 @@ static XIO_HANDLE create_tls_connection(const char *endpoint)
 }
 
 static XIO_HANDLE create_mutual_tls_connection(
-    const char *endpoint, const char *client_cert_in_option, const char *client_key_in_option)
+    const char *endpoint, uint16_t port, const char *trusted_certs, const char *client_cert_in_option, const char *client_key_in_option)
 {
-    TLSIO_CONFIG tlsio_config = { endpoint, MQTT_CONNECTION_TLS_PORT };
+    TLSIO_CONFIG tlsio_config = { endpoint, (port != 0) ? port : MQTT_CONNECTION_TLS_PORT };
     // enable wolfssl by set certificates
     // tlsio_config.certificate = certificates;
 
     XIO_HANDLE xio = xio_create(platform_get_default_tlsio(), &tlsio_config);
 
-    if (xio_setoption(xio, "TrustedCerts", certificates) != 0)
+    if (xio_setoption(xio, "TrustedCerts", trusted_certs) != 0)
     {
         LOG(AZ_LOG_ERROR, LOG_LINE, "Fail to assign trusted cert chain");
     }
@@ -694,13 +919,15 @@ static int send_mqtt_connect_message(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client)
 		switch (iotcore_client->conn_type)
 		{
 			case MQTT_CONNECTION_TCP:
-				iotcore_client->xio_transport = create_tcp_connection(iotcore_client->endpoint);
+				iotcore_client->xio_transport = create_tcp_connection(iotcore_client->endpoint, iotcore_client->port);
 				break;
 			case MQTT_CONNECTION_TLS:
-				iotcore_client->xio_transport = create_tls_connection(iotcore_client->endpoint);
+				iotcore_client->xio_transport = create_tls_connection(iotcore_client->endpoint, iotcore_client->port, iotcore_client->trusted_certs);
 				break;
 			case MQTT_CONNECTION_MUTUAL_TLS:
 				iotcore_client->xio_transport = create_mutual_tls_connection(iotcore_client->endpoint,
+																	   iotcore_client->port,
+																	   iotcore_client->trusted_certs,
 																	   iotcore_client->client_cert,
 																	   iotcore_client->client_key);
 		}
@@ -754,6 +981,7 @@ static void on_recv_callback(MQTT_MESSAGE_HANDLE msg_handle, void* context)
         LOG(AZ_LOG_ERROR, LOG_LINE, "get recv callback failed");
         return;
     }
+    iotcore_metrics_increment(&_client_handle->metrics.receive_count);
     _client_handle->recv_callback(
         mqttmessage_getPacketId(msg_handle), 
         (IOTCORE_MQTT_QOS)mqttmessage_getQosType(msg_handle), 
@@ -832,13 +1060,29 @@ IOTCORE_MQTT_CLIENT_HANDLE initialize_mqtt_client_handle(
         return NULL;
     }
 
+    _iotcore_client->publish_queue = iotcore_mpsc_queue_create(IOTCORE_MQTT_PUBLISH_QUEUE_SIZE);
+    if (_iotcore_client->publish_queue == NULL)
+    {
+        LogError("failure creating the publish queue.");
+        mqtt_client_deinit(_iotcore_client->mqtt_client);
+        tickcounter_destroy(_iotcore_client->msg_tick_counter);
+        _clear_mqtt_options(_iotcore_client->options);
+        free(_iotcore_client->endpoint);
+        free(_iotcore_client);
+        return NULL;
+    }
+
     DList_InitializeListHead(&_iotcore_client->pub_ack_waiting_queue);
+    DList_InitializeListHead(&_iotcore_client->pub_callback_free_list);
+    _iotcore_client->pub_callback_free_count = 0;
     DList_InitializeListHead(&_iotcore_client->sub_ack_waiting_queue);
     _iotcore_client->mqtt_client_status.connect_status = MQTT_CLIENT_CONNECT_STATUS_NOT_CONNECTED;
     _iotcore_client->mqtt_client_status.is_recoverable_error = true;
     _iotcore_client->retry_logic = create_retry_logic(retry_policy, retry_timeout_limit_in_sec);
     _iotcore_client->packet_id = 0;
     _iotcore_client->xio_transport = NULL;
+    _iotcore_client->trusted_certs = certificates;
+    iotcore_metrics_init(&_iotcore_client->metrics);
 
     return _iotcore_client;
 }
@@ -848,6 +1092,14 @@ void set_client_cert(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client, const char* clie
     iotcore_client->client_key = (char *) client_key;
 }
 
+void set_trusted_certs(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client, const char* trusted_certs) {
+    iotcore_client->trusted_certs = (trusted_certs != NULL) ? trusted_certs : certificates;
+}
+
+void set_server_port(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client, uint16_t port) {
+    iotcore_client->port = port;
+}
+
 int initialize_mqtt_connection(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client)
 {
     int _result = 0;
@@ -877,9 +1129,11 @@ int initialize_mqtt_connection(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client)
                                                                 iotcore_client, on_mqtt_error_complete, iotcore_client);
                 }
 
+                iotcore_metrics_increment(&iotcore_client->metrics.connect_attempt_count);
                 if (send_mqtt_connect_message(iotcore_client) != 0)
                 {
                     iotcore_client->connect_fail_count++;
+                    iotcore_metrics_increment(&iotcore_client->metrics.connect_failed_count);
 
                     _result = IOTCORE_ERR_ERROR;
                 }
@@ -903,6 +1157,7 @@ int initialize_mqtt_connection(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client)
             else if ((current_time - iotcore_client->mqtt_connect_time) / 1000 > iotcore_client->options->keepAliveInterval)
             {
                 LogError("mqtt_client timed out waiting for CONNACK");
+                iotcore_metrics_increment(&iotcore_client->metrics.connect_failed_count);
                 disconnect_from_client(iotcore_client);
                 _result = IOTCORE_ERR_ERROR;
             }
@@ -946,6 +1201,7 @@ int iotcore_mqtt_doconnect(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client, size_t tim
 
     if (iotcore_client->mqtt_client_status.connect_status == MQTT_CLIENT_CONNECT_STATUS_CONNECTED)
     {
+        iotcore_metrics_histogram_record(&iotcore_client->metrics.doconnect_duration, currentTime - lastSendTime);
         _result = 0;
     }
     else
@@ -964,6 +1220,10 @@ void iotcore_mqtt_dowork(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client)
     }
     else
     {
+        if (iotcore_client->mqtt_client_status.connect_status == MQTT_CLIENT_CONNECT_STATUS_CONNECTED)
+        {
+            drain_publish_queue(iotcore_client);
+        }
         mqtt_client_dowork(iotcore_client->mqtt_client);
     }
 }
@@ -984,6 +1244,9 @@ void iotcore_mqtt_destroy(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client)
 
         disconnect_from_client(iotcore_client);
 
+        fail_publish_queue(iotcore_client);
+        iotcore_mpsc_queue_destroy(iotcore_client->publish_queue);
+
         free(iotcore_client->endpoint);
         // don't set iotcore_client->endpoint, free iotcore_client at end of this function
         // iotcore_client->endpoint = NULL;
@@ -994,6 +1257,12 @@ void iotcore_mqtt_destroy(IOTCORE_MQTT_CLIENT_HANDLE iotcore_client)
         tickcounter_destroy(iotcore_client->msg_tick_counter);
         destroy_retry_logic(iotcore_client->retry_logic);
 
+        while (!DList_IsListEmpty(&iotcore_client->pub_callback_free_list))
+        {
+            PDLIST_ENTRY _free_entry = DList_RemoveHeadList(&iotcore_client->pub_callback_free_list);
+            free(containingRecord(_free_entry, MQTT_PUB_CALLBACK_INFO, entry));
+        }
+
         free(iotcore_client);
     }
 }
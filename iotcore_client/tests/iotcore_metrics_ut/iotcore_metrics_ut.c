@@ -0,0 +1,223 @@
+/*
+* Copyright (c) 2017 Baidu, Inc. All Rights Reserved.
+*
+* Licensed to the Apache Software Foundation (ASF) under one or more
+* contributor license agreements.  See the NOTICE file distributed with
+* this work for additional information regarding copyright ownership.
+* The ASF licenses this file to You under the Apache License, Version 2.0
+* (the "License"); you may not use this file except in compliance with
+* the License.  You may obtain a copy of the License at
+*
+*    http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "testrunnerswitcher.h"
+#include "iotcore_metrics.h"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+static IOTCORE_MQTT_HISTOGRAM histogram;
+
+static void record_many(uint64_t value_ms, size_t times)
+{
+    size_t i;
+    for (i = 0; i < times; i++)
+    {
+        iotcore_metrics_histogram_record(&histogram, value_ms);
+    }
+}
+
+static size_t bucket_of(uint64_t value_ms)
+{
+    IOTCORE_MQTT_HISTOGRAM single;
+    size_t result = IOTCORE_MQTT_HISTOGRAM_BUCKET_COUNT;
+    size_t index;
+
+    memset(&single, 0, sizeof(single));
+    iotcore_metrics_histogram_record(&single, value_ms);
+    for (index = 0; index < IOTCORE_MQTT_HISTOGRAM_BUCKET_COUNT; index++)
+    {
+        if (single.buckets[index] != 0)
+        {
+            result = index;
+        }
+    }
+    return result;
+}
+
+BEGIN_TEST_SUITE(iotcore_metrics_ut)
+
+TEST_SUITE_INITIALIZE(suite_init)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+}
+
+TEST_SUITE_CLEANUP(suite_cleanup)
+{
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("Could not acquire test serialization mutex.");
+    }
+
+    memset(&histogram, 0, sizeof(histogram));
+    histogram.min_ms = UINT32_MAX;
+}
+
+TEST_FUNCTION_CLEANUP(method_cleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+TEST_FUNCTION(histogram_values_below_4_have_a_bucket_each)
+{
+    // arrange
+    uint32_t value;
+
+    // act
+
+    // assert
+    for (value = 0; value < 4; value++)
+    {
+        ASSERT_ARE_EQUAL(size_t, (size_t)value, bucket_of(value));
+        ASSERT_ARE_EQUAL(uint32_t, value, iotcore_mqtt_histogram_bucket_lower_bound(value));
+        ASSERT_ARE_EQUAL(uint32_t, value, iotcore_mqtt_histogram_bucket_upper_bound(value));
+    }
+}
+
+TEST_FUNCTION(histogram_splits_every_power_of_two_in_4_buckets)
+{
+    // arrange
+
+    // act
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 4, bucket_of(4));
+    ASSERT_ARE_EQUAL(size_t, 7, bucket_of(7));
+    ASSERT_ARE_EQUAL(size_t, 8, bucket_of(8));
+    ASSERT_ARE_EQUAL(size_t, 8, bucket_of(9));
+    ASSERT_ARE_EQUAL(size_t, 9, bucket_of(10));
+    ASSERT_ARE_EQUAL(size_t, bucket_of(96), bucket_of(100));
+    ASSERT_ARE_EQUAL(size_t, bucket_of(96), bucket_of(111));
+    ASSERT_ARE_EQUAL(size_t, bucket_of(96) + 1, bucket_of(112));
+    ASSERT_ARE_EQUAL(uint32_t, 96, iotcore_mqtt_histogram_bucket_lower_bound(bucket_of(100)));
+    ASSERT_ARE_EQUAL(uint32_t, 111, iotcore_mqtt_histogram_bucket_upper_bound(bucket_of(100)));
+}
+
+TEST_FUNCTION(histogram_bounds_of_a_bucket_hold_its_values)
+{
+    // arrange
+    size_t bucket;
+
+    // act
+
+    // assert
+    for (bucket = 0; bucket < IOTCORE_MQTT_HISTOGRAM_BUCKET_COUNT; bucket++)
+    {
+        uint32_t lower_bound = iotcore_mqtt_histogram_bucket_lower_bound(bucket);
+        uint32_t upper_bound = iotcore_mqtt_histogram_bucket_upper_bound(bucket);
+        ASSERT_IS_TRUE(lower_bound <= upper_bound);
+        ASSERT_ARE_EQUAL(size_t, bucket, bucket_of(lower_bound));
+        ASSERT_ARE_EQUAL(size_t, bucket, bucket_of(upper_bound));
+        if (bucket > 0)
+        {
+            ASSERT_ARE_EQUAL(uint32_t, iotcore_mqtt_histogram_bucket_upper_bound(bucket - 1) + 1, lower_bound);
+        }
+    }
+}
+
+TEST_FUNCTION(histogram_last_bucket_goes_up_to_UINT32_MAX)
+{
+    // arrange
+
+    // act
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, IOTCORE_MQTT_HISTOGRAM_BUCKET_COUNT - 1, bucket_of(UINT32_MAX));
+    ASSERT_ARE_EQUAL(size_t, IOTCORE_MQTT_HISTOGRAM_BUCKET_COUNT - 1, bucket_of((uint64_t)UINT32_MAX + 1000));
+    ASSERT_ARE_EQUAL(uint32_t, UINT32_MAX, iotcore_mqtt_histogram_bucket_upper_bound(IOTCORE_MQTT_HISTOGRAM_BUCKET_COUNT - 1));
+    ASSERT_ARE_EQUAL(uint32_t, UINT32_MAX, iotcore_mqtt_histogram_bucket_lower_bound(IOTCORE_MQTT_HISTOGRAM_BUCKET_COUNT));
+}
+
+TEST_FUNCTION(histogram_percentile_of_an_empty_histogram_is_0)
+{
+    // arrange
+
+    // act
+    uint32_t result = iotcore_mqtt_histogram_percentile(&histogram, 50);
+
+    // assert
+    ASSERT_ARE_EQUAL(uint32_t, 0, result);
+    ASSERT_ARE_EQUAL(uint32_t, 0, iotcore_mqtt_histogram_percentile(NULL, 50));
+}
+
+TEST_FUNCTION(histogram_percentile_of_equal_values_is_that_value)
+{
+    // arrange
+    record_many(100, 100);
+
+    // act
+    uint32_t p50 = iotcore_mqtt_histogram_percentile(&histogram, 50);
+    uint32_t p99 = iotcore_mqtt_histogram_percentile(&histogram, 99);
+
+    // assert
+    ASSERT_ARE_EQUAL(uint32_t, 100, p50);
+    ASSERT_ARE_EQUAL(uint32_t, 100, p99);
+}
+
+TEST_FUNCTION(histogram_percentile_is_the_upper_bound_of_the_bucket_of_its_rank)
+{
+    // arrange
+    record_many(10, 90);
+    record_many(100, 9);
+    record_many(1000, 1);
+
+    // act
+    uint32_t p50 = iotcore_mqtt_histogram_percentile(&histogram, 50);
+    uint32_t p90 = iotcore_mqtt_histogram_percentile(&histogram, 90);
+    uint32_t p95 = iotcore_mqtt_histogram_percentile(&histogram, 95);
+    uint32_t p99 = iotcore_mqtt_histogram_percentile(&histogram, 99);
+
+    // assert
+    ASSERT_ARE_EQUAL(uint32_t, 11, p50);
+    ASSERT_ARE_EQUAL(uint32_t, 11, p90);
+    ASSERT_ARE_EQUAL(uint32_t, 111, p95);
+    ASSERT_ARE_EQUAL(uint32_t, 111, p99);
+}
+
+TEST_FUNCTION(histogram_percentile_0_and_100_are_in_the_buckets_of_min_and_max)
+{
+    // arrange
+    record_many(5, 1);
+    record_many(50, 10);
+    record_many(500, 1);
+
+    // act
+    uint32_t p0 = iotcore_mqtt_histogram_percentile(&histogram, 0);
+    uint32_t p100 = iotcore_mqtt_histogram_percentile(&histogram, 100);
+
+    // assert
+    ASSERT_ARE_EQUAL(uint32_t, 5, p0);
+    ASSERT_ARE_EQUAL(uint32_t, 500, p100);
+}
+
+END_TEST_SUITE(iotcore_metrics_ut)
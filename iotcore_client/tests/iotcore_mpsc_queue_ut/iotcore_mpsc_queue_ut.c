@@ -0,0 +1,253 @@
+/*
+* Copyright (c) 2017 Baidu, Inc. All Rights Reserved.
+*
+* Licensed to the Apache Software Foundation (ASF) under one or more
+* contributor license agreements.  See the NOTICE file distributed with
+* this work for additional information regarding copyright ownership.
+* The ASF licenses this file to You under the Apache License, Version 2.0
+* (the "License"); you may not use this file except in compliance with
+* the License.  You may obtain a copy of the License at
+*
+*    http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stddef.h>
+
+#include "testrunnerswitcher.h"
+#include "azure_c_shared_utility/threadapi.h"
+#include "iotcore_mpsc_queue.h"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+#define PRODUCER_COUNT 4
+#define ITEMS_PER_PRODUCER 20000
+// small enough that the producers run into a full queue all the time
+#define CONTENDED_QUEUE_CAPACITY 8
+
+// an item is the producer in the high bits and its sequence number in the low ones, + 1 so it is never NULL
+#define MAKE_ITEM(producer, sequence) ((void*)(uintptr_t)((((uintptr_t)(producer)) << 24) + (sequence) + 1))
+#define ITEM_PRODUCER(item) ((size_t)(((uintptr_t)(item) - 1) >> 24))
+#define ITEM_SEQUENCE(item) ((size_t)(((uintptr_t)(item) - 1) & 0xFFFFFF))
+
+typedef struct PRODUCER_TAG
+{
+    IOTCORE_MPSC_QUEUE_HANDLE queue;
+    size_t id;
+} PRODUCER;
+
+static int produce(void* arg)
+{
+    PRODUCER* producer = (PRODUCER*)arg;
+    size_t sequence;
+
+    for (sequence = 0; sequence < ITEMS_PER_PRODUCER; sequence++)
+    {
+        // back-pressure: a full queue refuses the push, the producer retries
+        while (iotcore_mpsc_queue_push(producer->queue, MAKE_ITEM(producer->id, sequence)) != 0)
+        {
+            ThreadAPI_Sleep(0);
+        }
+    }
+
+    return 0;
+}
+
+BEGIN_TEST_SUITE(iotcore_mpsc_queue_ut)
+
+TEST_SUITE_INITIALIZE(suite_init)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+}
+
+TEST_SUITE_CLEANUP(suite_cleanup)
+{
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("Could not acquire test serialization mutex.");
+    }
+}
+
+TEST_FUNCTION_CLEANUP(method_cleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+TEST_FUNCTION(iotcore_mpsc_queue_create_with_0_capacity_fails)
+{
+    ///act
+    IOTCORE_MPSC_QUEUE_HANDLE queue = iotcore_mpsc_queue_create(0);
+
+    ///assert
+    ASSERT_IS_NULL(queue);
+}
+
+TEST_FUNCTION(iotcore_mpsc_queue_create_rounds_the_capacity_up_to_a_power_of_two)
+{
+    ///act
+    IOTCORE_MPSC_QUEUE_HANDLE queue = iotcore_mpsc_queue_create(5);
+
+    ///assert
+    ASSERT_IS_NOT_NULL(queue);
+    ASSERT_ARE_EQUAL(size_t, 8, iotcore_mpsc_queue_capacity(queue));
+
+    ///cleanup
+    iotcore_mpsc_queue_destroy(queue);
+}
+
+TEST_FUNCTION(iotcore_mpsc_queue_pop_of_an_empty_queue_returns_NULL)
+{
+    ///arrange
+    IOTCORE_MPSC_QUEUE_HANDLE queue = iotcore_mpsc_queue_create(4);
+    ASSERT_IS_NOT_NULL(queue);
+
+    ///act
+    void* item = iotcore_mpsc_queue_pop(queue);
+
+    ///assert
+    ASSERT_IS_NULL(item);
+
+    ///cleanup
+    iotcore_mpsc_queue_destroy(queue);
+}
+
+TEST_FUNCTION(iotcore_mpsc_queue_pop_returns_the_items_in_push_order)
+{
+    ///arrange
+    IOTCORE_MPSC_QUEUE_HANDLE queue = iotcore_mpsc_queue_create(4);
+    size_t lap;
+    size_t i;
+    ASSERT_IS_NOT_NULL(queue);
+
+    ///act
+    ///assert
+    // a few laps so the positions wrap around the slots
+    for (lap = 0; lap < 3; lap++)
+    {
+        for (i = 0; i < 3; i++)
+        {
+            ASSERT_ARE_EQUAL(int, 0, iotcore_mpsc_queue_push(queue, MAKE_ITEM(0, lap * 3 + i)));
+        }
+        for (i = 0; i < 3; i++)
+        {
+            ASSERT_ARE_EQUAL(void_ptr, MAKE_ITEM(0, lap * 3 + i), iotcore_mpsc_queue_pop(queue));
+        }
+        ASSERT_IS_NULL(iotcore_mpsc_queue_pop(queue));
+    }
+
+    ///cleanup
+    iotcore_mpsc_queue_destroy(queue);
+}
+
+TEST_FUNCTION(iotcore_mpsc_queue_push_to_a_full_queue_fails_until_an_item_is_popped)
+{
+    ///arrange
+    IOTCORE_MPSC_QUEUE_HANDLE queue = iotcore_mpsc_queue_create(4);
+    size_t i;
+    ASSERT_IS_NOT_NULL(queue);
+    for (i = 0; i < 4; i++)
+    {
+        ASSERT_ARE_EQUAL(int, 0, iotcore_mpsc_queue_push(queue, MAKE_ITEM(0, i)));
+    }
+
+    ///act
+    int full_result = iotcore_mpsc_queue_push(queue, MAKE_ITEM(0, 4));
+    void* oldest = iotcore_mpsc_queue_pop(queue);
+    int after_pop_result = iotcore_mpsc_queue_push(queue, MAKE_ITEM(0, 4));
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, full_result);
+    ASSERT_ARE_EQUAL(void_ptr, MAKE_ITEM(0, 0), oldest);
+    ASSERT_ARE_EQUAL(int, 0, after_pop_result);
+    // the refused push left nothing behind
+    for (i = 1; i <= 4; i++)
+    {
+        ASSERT_ARE_EQUAL(void_ptr, MAKE_ITEM(0, i), iotcore_mpsc_queue_pop(queue));
+    }
+    ASSERT_IS_NULL(iotcore_mpsc_queue_pop(queue));
+
+    ///cleanup
+    iotcore_mpsc_queue_destroy(queue);
+}
+
+TEST_FUNCTION(iotcore_mpsc_queue_keeps_the_order_of_each_producer_and_loses_nothing)
+{
+    ///arrange
+    IOTCORE_MPSC_QUEUE_HANDLE queue = iotcore_mpsc_queue_create(CONTENDED_QUEUE_CAPACITY);
+    PRODUCER producers[PRODUCER_COUNT];
+    THREAD_HANDLE threads[PRODUCER_COUNT];
+    size_t next_sequence[PRODUCER_COUNT];
+    size_t received = 0;
+    size_t out_of_order = 0;
+    size_t i;
+    ASSERT_IS_NOT_NULL(queue);
+
+    for (i = 0; i < PRODUCER_COUNT; i++)
+    {
+        producers[i].queue = queue;
+        producers[i].id = i;
+        next_sequence[i] = 0;
+    }
+
+    ///act
+    for (i = 0; i < PRODUCER_COUNT; i++)
+    {
+        ASSERT_ARE_EQUAL(int, (int)THREADAPI_OK, (int)ThreadAPI_Create(&threads[i], produce, &producers[i]));
+    }
+
+    while (received < PRODUCER_COUNT * ITEMS_PER_PRODUCER)
+    {
+        void* item = iotcore_mpsc_queue_pop(queue);
+        if (item == NULL)
+        {
+            ThreadAPI_Sleep(0);
+        }
+        else
+        {
+            size_t producer = ITEM_PRODUCER(item);
+            ASSERT_IS_TRUE(producer < PRODUCER_COUNT);
+            if (ITEM_SEQUENCE(item) != next_sequence[producer])
+            {
+                out_of_order++;
+            }
+            next_sequence[producer] = ITEM_SEQUENCE(item) + 1;
+            received++;
+        }
+    }
+
+    for (i = 0; i < PRODUCER_COUNT; i++)
+    {
+        int thread_result;
+        ASSERT_ARE_EQUAL(int, (int)THREADAPI_OK, (int)ThreadAPI_Join(threads[i], &thread_result));
+        ASSERT_ARE_EQUAL(int, 0, thread_result);
+    }
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 0, out_of_order);
+    for (i = 0; i < PRODUCER_COUNT; i++)
+    {
+        ASSERT_ARE_EQUAL(size_t, ITEMS_PER_PRODUCER, next_sequence[i]);
+    }
+    ASSERT_IS_NULL(iotcore_mpsc_queue_pop(queue));
+
+    ///cleanup
+    iotcore_mpsc_queue_destroy(queue);
+}
+
+END_TEST_SUITE(iotcore_mpsc_queue_ut)
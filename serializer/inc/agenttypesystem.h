@@ -556,6 +556,9 @@ typedef struct EDM_COMPLEX_TYPE_TAG
 
 DEFINE_ENUM(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_RESULT_VALUES);
 
+/*"-1.2345678901234567e-308" and its terminating '\0' fit, with room for a longer decimal point*/
+#define AGENT_DATA_TYPES_FLOATING_POINT_STRING_SIZE 32
+
 #define AGENT_DATA_TYPE_TYPE_VALUES\
     EDM_NO_TYPE,                                                                   \
     EDM_BINARY_TYPE,                                                               \
@@ -646,6 +649,9 @@ struct AGENT_DATA_TYPE_TAG
 
 MOCKABLE_FUNCTION(, AGENT_DATA_TYPES_RESULT, AgentDataTypes_ToString, STRING_HANDLE, destination, const AGENT_DATA_TYPE*, value);
 
+/*prints a finite value as the shortest text that reads back as the same float (isSinglePrecision != 0) or double. The decimal point is always '.', whatever the locale. destinationSize has to be at least AGENT_DATA_TYPES_FLOATING_POINT_STRING_SIZE*/
+MOCKABLE_FUNCTION(, AGENT_DATA_TYPES_RESULT, AgentDataTypes_FloatingPointToString, char*, destination, size_t, destinationSize, double, value, int, isSinglePrecision);
+
 /*Create/Destroy work in pairs. For some data type not calling Uncreate might be ok. For some, it will lead to memory leaks*/
 
 /*creates an AGENT_DATA_TYPE containing a EDM_BOOLEAN from a int*/
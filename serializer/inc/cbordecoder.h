@@ -0,0 +1,39 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef CBORDECODER_H
+#define CBORDECODER_H
+
+#include "azure_c_shared_utility/macro_utils.h"
+#include "multitree.h"
+#include "schema.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#endif
+
+#define CBOR_DECODER_RESULT_VALUES    \
+CBOR_DECODER_OK,                      \
+CBOR_DECODER_INVALID_ARG,             \
+CBOR_DECODER_PARSE_ERROR,             \
+CBOR_DECODER_UNKNOWN_KEY_ID,          \
+CBOR_DECODER_MULTITREE_FAILED,        \
+CBOR_DECODER_ERROR
+
+DEFINE_ENUM(CBOR_DECODER_RESULT, CBOR_DECODER_RESULT_VALUES);
+
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+/*builds the same multi tree JSONDecoder_JSON_To_MultiTree builds for the equivalent JSON: maps and arrays become nodes, every other value becomes a leaf*/
+/*holding the JSON text of the value. Integer map keys are resolved to property paths with Schema_GetModelPathById on modelHandle (which can be NULL*/
+/*when no key ids are expected). The tree owns its values and MultiTree_Destroy frees them.*/
+MOCKABLE_FUNCTION(, CBOR_DECODER_RESULT, CBORDecoder_CBOR_To_MultiTree, const unsigned char*, cbor, size_t, size, SCHEMA_MODEL_TYPE_HANDLE, modelHandle, MULTITREE_HANDLE*, multiTreeHandle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CBORDECODER_H */
@@ -0,0 +1,49 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef CBORENCODER_H
+#define CBORENCODER_H
+
+#include "azure_c_shared_utility/macro_utils.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#endif
+
+#include "multitree.h"
+#include "agenttypesystem.h"
+
+#define CBOR_ENCODER_RESULT_VALUES           \
+CBOR_ENCODER_OK,                             \
+CBOR_ENCODER_INVALID_ARG,                    \
+CBOR_ENCODER_MULTITREE_ERROR,                \
+CBOR_ENCODER_AGENT_DATA_TYPES_ERROR,         \
+CBOR_ENCODER_ERROR
+
+DEFINE_ENUM(CBOR_ENCODER_RESULT, CBOR_ENCODER_RESULT_VALUES);
+
+/*when a value has this key id, its keyName is written instead*/
+#define CBOR_ENCODER_NO_KEY_ID ((size_t)-1)
+
+typedef struct CBOR_ENCODER_KEYED_VALUE_TAG
+{
+    size_t keyId;
+    const char* keyName;
+    const AGENT_DATA_TYPE* value;
+} CBOR_ENCODER_KEYED_VALUE;
+
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+/*encodes a tree whose leaves are AGENT_DATA_TYPE* as nested CBOR maps keyed by the node names, the same shape JSONEncoder_EncodeTree produces*/
+MOCKABLE_FUNCTION(, CBOR_ENCODER_RESULT, CBOREncoder_EncodeTree, MULTITREE_HANDLE, treeHandle, unsigned char**, destination, size_t*, destinationSize);
+/*encodes one flat CBOR map, each value keyed by its keyId (an unsigned integer) or by its keyName when keyId is CBOR_ENCODER_NO_KEY_ID*/
+MOCKABLE_FUNCTION(, CBOR_ENCODER_RESULT, CBOREncoder_EncodeKeyedValues, size_t, valueCount, const CBOR_ENCODER_KEYED_VALUE*, values, unsigned char**, destination, size_t*, destinationSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CBORENCODER_H */
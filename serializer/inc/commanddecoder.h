@@ -49,6 +49,11 @@ MOCKABLE_FUNCTION(,void, CommandDecoder_Destroy, COMMAND_DECODER_HANDLE, command
 
 MOCKABLE_FUNCTION(, EXECUTE_COMMAND_RESULT, CommandDecoder_IngestDesiredProperties, void*, startAddress, COMMAND_DECODER_HANDLE, handle, const char*, jsonPayload, bool, parseDesiredNode);
 
+/*same as the functions above, for payloads encoded as CBOR (see payloadencoding.h)*/
+MOCKABLE_FUNCTION(, EXECUTE_COMMAND_RESULT, CommandDecoder_ExecuteCommandCBOR, COMMAND_DECODER_HANDLE, handle, const unsigned char*, command, size_t, size);
+MOCKABLE_FUNCTION(, METHODRETURN_HANDLE, CommandDecoder_ExecuteMethodCBOR, COMMAND_DECODER_HANDLE, handle, const char*, fullMethodName, const unsigned char*, methodPayload, size_t, size);
+MOCKABLE_FUNCTION(, EXECUTE_COMMAND_RESULT, CommandDecoder_IngestDesiredPropertiesCBOR, void*, startAddress, COMMAND_DECODER_HANDLE, handle, const unsigned char*, cborPayload, size_t, size, bool, parseDesiredNode);
+
 #ifdef __cplusplus
 }
 #endif
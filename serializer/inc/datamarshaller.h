@@ -7,6 +7,7 @@
 #include <stdbool.h>
 #include "agenttypesystem.h"
 #include "schema.h"
+#include "payloadencoding.h"
 #include "azure_c_shared_utility/macro_utils.h"
 #include "azure_c_shared_utility/vector.h"
 #ifdef __cplusplus
@@ -25,7 +26,8 @@ DATA_MARSHALLER_JSON_ENCODER_ERROR,             \
 DATA_MARSHALLER_ERROR,                          \
 DATA_MARSHALLER_AGENT_DATA_TYPES_ERROR,         \
 DATA_MARSHALLER_MULTITREE_ERROR,                \
-DATA_MARSHALLER_ONLY_ONE_VALUE_ALLOWED          \
+DATA_MARSHALLER_ONLY_ONE_VALUE_ALLOWED,         \
+DATA_MARSHALLER_CBOR_ENCODER_ERROR              \
 
 DEFINE_ENUM(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_RESULT_VALUES);
 
@@ -42,6 +44,9 @@ MOCKABLE_FUNCTION(,DATA_MARSHALLER_HANDLE, DataMarshaller_Create, SCHEMA_MODEL_T
 MOCKABLE_FUNCTION(,void, DataMarshaller_Destroy, DATA_MARSHALLER_HANDLE, dataMarshallerHandle);
 MOCKABLE_FUNCTION(,DATA_MARSHALLER_RESULT, DataMarshaller_SendData, DATA_MARSHALLER_HANDLE, dataMarshallerHandle, size_t, valueCount, const DATA_MARSHALLER_VALUE*, values, unsigned char**, destination, size_t*, destinationSize);
 
+/*the encoding of the instances created after this call, PAYLOAD_ENCODING_JSON unless changed*/
+MOCKABLE_FUNCTION(, void, DataMarshaller_SetDefaultEncoding, PAYLOAD_ENCODING, encoding);
+MOCKABLE_FUNCTION(, PAYLOAD_ENCODING, DataMarshaller_GetDefaultEncoding);
 MOCKABLE_FUNCTION(, DATA_MARSHALLER_RESULT, DataMarshaller_SendData_ReportedProperties, DATA_MARSHALLER_HANDLE, dataMarshallerHandle, VECTOR_HANDLE, values, unsigned char**, destination, size_t*, destinationSize);
 
 #ifdef __cplusplus
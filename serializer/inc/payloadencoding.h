@@ -0,0 +1,27 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef PAYLOADENCODING_H
+#define PAYLOADENCODING_H
+
+#include "azure_c_shared_utility/macro_utils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*how the serializer writes the data it sends and reads the commands, methods and desired properties it receives*/
+/*PAYLOAD_ENCODING_CBOR writes the same maps as JSON (RFC 7049), keyed by name*/
+/*PAYLOAD_ENCODING_CBOR_WITH_KEY_IDS writes one flat map keyed by the schema id of each property path (see Schema_GetModelPathId)*/
+#define PAYLOAD_ENCODING_VALUES       \
+    PAYLOAD_ENCODING_JSON,            \
+    PAYLOAD_ENCODING_CBOR,            \
+    PAYLOAD_ENCODING_CBOR_WITH_KEY_IDS
+
+DEFINE_ENUM(PAYLOAD_ENCODING, PAYLOAD_ENCODING_VALUES);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PAYLOADENCODING_H */
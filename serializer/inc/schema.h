@@ -72,6 +72,22 @@ typedef struct SCHEMA_MODEL_ELEMENT_TAG
     } elementHandle;
 }SCHEMA_MODEL_ELEMENT;
 
+/*what a path of a model resolves to, see Schema_GetModelPathDescriptor. The handles of the kinds of element the path does not name are NULL*/
+typedef struct SCHEMA_PATH_DESCRIPTOR_TAG
+{
+    size_t id; /*same as Schema_GetModelPathId*/
+    const char* path; /*same as Schema_GetModelPathById*/
+    SCHEMA_PROPERTY_HANDLE propertyHandle;
+    SCHEMA_REPORTED_PROPERTY_HANDLE reportedPropertyHandle;
+    SCHEMA_DESIRED_PROPERTY_HANDLE desiredPropertyHandle;
+    SCHEMA_ACTION_HANDLE actionHandle;
+    SCHEMA_MODEL_TYPE_HANDLE modelHandle; /*the model in model at the end of the path*/
+    const char* type; /*type of the property, else of the reported property, else of the desired property*/
+    size_t offset; /*of the desired property, else of the model in model, from the start of the data of the model the path was looked up in*/
+    pfDesiredPropertyFromAGENT_DATA_TYPE desiredPropertyFromAGENT_DATA_TYPE;
+    pfOnDesiredProperty onDesiredProperty; /*of the desired property, else of the model in model*/
+} SCHEMA_PATH_DESCRIPTOR;
+
 MOCKABLE_FUNCTION(, SCHEMA_HANDLE, Schema_Create, const char*, schemaNamespace, void*, metadata);
 MOCKABLE_FUNCTION(, void*, Schema_GetMetadata, SCHEMA_HANDLE, schemaHandle);
 MOCKABLE_FUNCTION(, size_t, Schema_GetSchemaCount);
@@ -141,6 +157,13 @@ MOCKABLE_FUNCTION(, bool, Schema_ModelPropertyByPathExists, SCHEMA_MODEL_TYPE_HA
 MOCKABLE_FUNCTION(, bool, Schema_ModelReportedPropertyByPathExists, SCHEMA_MODEL_TYPE_HANDLE, modelTypeHandle, const char*, reportedPropertyPath);
 MOCKABLE_FUNCTION(, bool, Schema_ModelDesiredPropertyByPathExists, SCHEMA_MODEL_TYPE_HANDLE, modelTypeHandle, const char*, desiredPropertyPath);
 
+/*every path reachable from a model has a small integer id, stable for a given model declaration*/
+MOCKABLE_FUNCTION(, SCHEMA_RESULT, Schema_GetModelPathId, SCHEMA_MODEL_TYPE_HANDLE, modelTypeHandle, const char*, path, size_t*, id);
+/*the returned path belongs to the model. It stays valid until the model, or any model in model it contains, gets a new element or is destroyed*/
+MOCKABLE_FUNCTION(, const char*, Schema_GetModelPathById, SCHEMA_MODEL_TYPE_HANDLE, modelTypeHandle, size_t, id);
+/*one lookup for everything known about a path (the strings in the descriptor live as long as the one returned by Schema_GetModelPathById)*/
+MOCKABLE_FUNCTION(, SCHEMA_RESULT, Schema_GetModelPathDescriptor, SCHEMA_MODEL_TYPE_HANDLE, modelTypeHandle, const char*, path, SCHEMA_PATH_DESCRIPTOR*, descriptor);
+
 MOCKABLE_FUNCTION(, SCHEMA_RESULT, Schema_GetModelActionCount, SCHEMA_MODEL_TYPE_HANDLE, modelTypeHandle, size_t*, actionCount);
 MOCKABLE_FUNCTION(, SCHEMA_ACTION_HANDLE, Schema_GetModelActionByName, SCHEMA_MODEL_TYPE_HANDLE, modelTypeHandle, const char*, actionName);
 MOCKABLE_FUNCTION(, SCHEMA_METHOD_HANDLE, Schema_GetModelMethodByName, SCHEMA_MODEL_TYPE_HANDLE, modelTypeHandle, const char*, methodName);
@@ -12,6 +12,7 @@
 #include "azure_c_shared_utility/macro_utils.h"
 #include "azure_c_shared_utility/strings.h"
 #include "iotdevice.h"
+#include "payloadencoding.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -39,10 +40,14 @@ DEFINE_ENUM(SERIALIZER_RESULT, SERIALIZER_RESULT_VALUES);
 
 #define SERIALIZER_CONFIG_VALUES  \
     CommandPollingInterval,     \
-    SerializeDelayedBufferMaxSize
+    SerializeDelayedBufferMaxSize, \
+    SerializePayloadEncoding
 
 /** @brief Enumeration specifying the option to set on the serializer when  
  * calling ::serializer_setconfig.
+ *
+ * SerializePayloadEncoding takes a PAYLOAD_ENCODING and applies to the
+ * devices created after the call.
  */
 DEFINE_ENUM(SERIALIZER_CONFIG, SERIALIZER_CONFIG_VALUES);
 
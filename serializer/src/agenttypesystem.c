@@ -17,6 +17,7 @@
 #include <math.h>
 #include <limits.h>
 #include <errno.h>
+#include <locale.h>
 
 /*if ULLONG_MAX is defined by limits.h for whatever reasons... */
 #ifndef ULLONG_MAX
@@ -24,6 +25,7 @@
 #endif
 
 #include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/base64.h"
 
 #include "jsonencoder.h"
 #include "multitree.h"
@@ -83,54 +85,6 @@ static void NoFreeFunction(void* value)
 
 
 #define IS_DIGIT(a) (('0'<=(a)) &&((a)<='9'))
-#define splitInt(intVal, bytePos)   (char)((intVal >> (bytePos << 3)) & 0xFF)
-#define joinChars(a, b, c, d) (uint32_t)( (uint32_t)a + ((uint32_t)b << 8) + ((uint32_t)c << 16) + ((uint32_t)d << 24))
-
-static char base64char(unsigned char val)
-{
-    char result;
-
-    if (val < 26)
-    {
-        result = 'A' + (char)val;
-    }
-    else if (val < 52)
-    {
-        result = 'a' + ((char)val - 26);
-    }
-    else if (val < 62)
-    {
-        result = '0' + ((char)val - 52);
-    }
-    else if (val == 62)
-    {
-        result = '-';
-    }
-    else
-    {
-        result = '_';
-    }
-
-    return result;
-}
-
-static char base64b16(unsigned char val)
-{
-    const uint32_t base64b16values[4] = {
-        joinChars('A', 'E', 'I', 'M'),
-        joinChars('Q', 'U', 'Y', 'c'),
-        joinChars('g', 'k', 'o', 's'),
-        joinChars('w', '0', '4', '8')
-    };
-    return splitInt(base64b16values[val >> 2], (val & 0x03));
-}
-
-static char base64b8(unsigned char val)
-{
-    const uint32_t base64b8values = joinChars('A', 'Q', 'g', 'w');
-    return splitInt(base64b8values, val);
-};
-
 /*creates an AGENT_DATA_TYPE containing a EDM_BOOLEAN from a int*/
 AGENT_DATA_TYPES_RESULT Create_EDM_BOOLEAN_from_int(AGENT_DATA_TYPE* agentData, int v)
 {
@@ -509,167 +463,6 @@ static int ValidateDecimal(const char* v, size_t vlen)
     return result;
 }
 
-/*return 0 if everything went ok*/
-/*takes 1 base64char and returns its value*/
-static int base64toValue(char base64charSource, unsigned char* value)
-{
-    int result;
-    if (('A' <= base64charSource) && (base64charSource <= 'Z'))
-    {
-        *value = base64charSource - 'A';
-        result = 0;
-    }
-    else if (('a' <= base64charSource) && (base64charSource <= 'z'))
-    {
-        *value = ('Z' - 'A') +1+ (base64charSource - 'a');
-        result = 0;
-    }
-    else if (('0' <= base64charSource) && (base64charSource <= '9'))
-    {
-        *value = ('Z' - 'A') +1+('z'-'a')+1 +(base64charSource - '0');
-        result = 0;
-    }
-    else if ('-' == base64charSource)
-    {
-        *value = 62;
-        result = 0;
-    }
-    else if ('_' == base64charSource)
-    {
-        *value = 63;
-        result = 0;
-    }
-    else
-    {
-        result = 1;
-    }
-    return result;
-}
-
-/*returns 0 if everything went ok*/
-/*scans 4 base64 characters and returns 3 usual bytes*/
-static int scan4base64char(const char* source, size_t sourceSize, unsigned char *destination0, unsigned char* destination1, unsigned char* destination2)
-{
-    int result;
-    if (sourceSize < 4)
-    {
-        result = 1;
-    }
-    else
-    {
-        unsigned char b0, b1, b2, b3;
-        if (
-            (base64toValue(source[0], &b0) == 0) &&
-            (base64toValue(source[1], &b1) == 0) &&
-            (base64toValue(source[2], &b2) == 0) &&
-            (base64toValue(source[3], &b3) == 0)
-            )
-        {
-            *destination0 = (b0 << 2) | ((b1 & 0x30) >> 4);
-            *destination1 = ((b1 & 0x0F)<<4) | ((b2 & 0x3C) >>2 );
-            *destination2 = ((b2 & 0x03) << 6) | (b3);
-            result = 0;
-        }
-        else
-        {
-            result = 2;
-        }
-    }
-    return result;
-}
-
-/*return 0 if the character is one of ( 'A' / 'E' / 'I' / 'M' / 'Q' / 'U' / 'Y' / 'c' / 'g' / 'k' / 'o' / 's' / 'w' / '0' / '4' / '8' )*/
-static int base64b16toValue(unsigned char source, unsigned char* destination)
-{
-    unsigned char i;
-    for (i = 0; i <= 15; i++)
-    {
-        if (base64b16(i) == source)
-        {
-            *destination = i;
-            return 0;
-        }
-    }
-    return 1;
-}
-
-/*return 0 if the character is one of ( 'A' / 'Q' / 'g' / 'w' )*/
-static int base64b8toValue(unsigned char source, unsigned char* destination)
-{
-    unsigned char i;
-    for (i = 0; i <= 3; i++)
-    {
-        if (base64b8(i) == source)
-        {
-            *destination = i;
-            return 0;
-        }
-    }
-    return 1;
-}
-
-
-/*returns 0 if everything went ok*/
-/*scans 2 base64 characters + 1 special + 1 optional = and returns 2 usual bytes*/
-int scanbase64b16(const char* source, size_t sourceSize, size_t *consumed, unsigned char* destination0, unsigned char* destination1)
-{
-    int result;
-    if (sourceSize < 3)
-    {
-        result = 1;
-    }
-    else
-    {
-        unsigned char c0, c1, c2;
-        *consumed = 0;
-        if (
-            (base64toValue(source[0], &c0) == 0) &&
-            (base64toValue(source[1], &c1) == 0) &&
-            (base64b16toValue(source[2], &c2) == 0)
-            )
-        {
-            *consumed = 3 + ((sourceSize>=3)&&(source[3] == '=')); /*== produce 1 or 0 ( in C )*/
-            *destination0 = (c0 << 2) | ((c1 & 0x30) >> 4);
-            *destination1 = ((c1 &0x0F) <<4) | c2;
-            result = 0;
-        }
-        else
-        {
-            result = 2;
-        }
-    }
-    return result;
-}
-
-/*return 0 if everything is ok*/
-/*Reads base64b8    = base64char ( 'A' / 'Q' / 'g' / 'w' ) [ "==" ]*/
-int scanbase64b8(const char* source, size_t sourceSize, size_t *consumed, unsigned char* destination0)
-{
-    int result;
-    if (sourceSize < 2)
-    {
-        result = 1;
-    }
-    else
-    {
-        unsigned char c0, c1;
-        if (
-            (base64toValue(source[0], &c0) == 0) &&
-            (base64b8toValue(source[1], &c1) == 0)
-            )
-        {
-            *consumed = 2 + (((sourceSize>=4) && (source[2] == '=') && (source[3] == '='))?2:0); /*== produce 1 or 0 ( in C )*/
-            *destination0 = (c0 << 2) | (c1 & 3);
-            result = 0;
-        }
-        else
-        {
-            result = 2;
-        }
-    }
-    return result;
-}
-
 /*Codes_SRS_AGENT_TYPE_SYSTEM_99_039:[ Creates an AGENT_DATA_TYPE containing an EDM_DECIMAL from a null-terminated string.]*/
 AGENT_DATA_TYPES_RESULT Create_EDM_DECIMAL_from_charz(AGENT_DATA_TYPE* agentData, const char* v)
 {
@@ -1283,6 +1076,71 @@ static char hexDigitToChar(uint8_t hexDigit)
     else return ('A' - 10) + hexDigit;
 }
 
+/*sprintf honours the decimal point of the current locale, the text produced here always uses '.'*/
+/*this function replaces the locale's decimal point in text (which has length characters) with '.' and returns the new length*/
+static size_t delocalizeDecimalPoint(char* text, size_t length)
+{
+    const char* localeDecimalPoint = localeconv()->decimal_point;
+    if ((localeDecimalPoint != NULL) &&
+        (localeDecimalPoint[0] != '\0') &&
+        (strcmp(localeDecimalPoint, ".") != 0))
+    {
+        char* decimalPoint = strstr(text, localeDecimalPoint);
+        if (decimalPoint != NULL)
+        {
+            size_t decimalPointLength = strlen(localeDecimalPoint);
+            *decimalPoint = '.';
+            (void)memmove(decimalPoint + 1, decimalPoint + decimalPointLength, length - (decimalPoint - text) - decimalPointLength + 1);
+            length -= decimalPointLength - 1;
+        }
+    }
+    return length;
+}
+
+AGENT_DATA_TYPES_RESULT AgentDataTypes_FloatingPointToString(char* destination, size_t destinationSize, double value, int isSinglePrecision)
+{
+    AGENT_DATA_TYPES_RESULT result;
+
+    if ((destination == NULL) ||
+        (destinationSize < AGENT_DATA_TYPES_FLOATING_POINT_STRING_SIZE) ||
+        ISNAN(value) ||
+        ISNEGATIVEINFINITY(value) ||
+        ISPOSITIVEINFINITY(value))
+    {
+        result = AGENT_DATA_TYPES_INVALID_ARG;
+        LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+    }
+    else
+    {
+        int precision;
+        int length = 0;
+
+        /*the shortest text that reads back as the same value*/
+        for (precision = isSinglePrecision ? FLT_DIG : DBL_DIG; precision <= (isSinglePrecision ? FLT_DIG + 3 : DBL_DIG + 2); precision++)
+        {
+            length = sprintf_s(destination, destinationSize, "%.*g", precision, value);
+            if ((length < 0) ||
+                (isSinglePrecision ? (strtof(destination, NULL) == (float)value) : (strtod(destination, NULL) == value)))
+            {
+                break;
+            }
+        }
+
+        if (length < 0)
+        {
+            result = AGENT_DATA_TYPES_ERROR;
+            LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+        }
+        else
+        {
+            (void)delocalizeDecimalPoint(destination, (size_t)length);
+            result = AGENT_DATA_TYPES_OK;
+        }
+    }
+
+    return result;
+}
+
 AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const AGENT_DATA_TYPE* value)
 {
     AGENT_DATA_TYPES_RESULT result;
@@ -2004,19 +1862,24 @@ AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const
                     }
                     else
                     {
-                        if (sprintf_s(tempBuffer, tempBufferSize, "%.*f", FLT_DIG, (double)(value->value.edmSingle.value)) < 0)
-                        {
-                            result = AGENT_DATA_TYPES_ERROR;
-                            LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else if (STRING_concat(destination, tempBuffer) != 0)
+                        int length;
+                        if ((length = sprintf_s(tempBuffer, tempBufferSize, "%.*f", FLT_DIG, (double)(value->value.edmSingle.value))) < 0)
                         {
                             result = AGENT_DATA_TYPES_ERROR;
                             LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
                         }
                         else
                         {
-                            result = AGENT_DATA_TYPES_OK;
+                            (void)delocalizeDecimalPoint(tempBuffer, (size_t)length);
+                            if (STRING_concat(destination, tempBuffer) != 0)
+                            {
+                                result = AGENT_DATA_TYPES_ERROR;
+                                LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+                            }
+                            else
+                            {
+                                result = AGENT_DATA_TYPES_OK;
+                            }
                         }
 
                         free(tempBuffer);
@@ -2082,19 +1945,24 @@ AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const
                     }
                     else
                     {
-                        if (sprintf_s(tempBuffer, tempBufferSize, "%.*f", DBL_DIG, value->value.edmDouble.value) < 0)
-                        {
-                            result = AGENT_DATA_TYPES_ERROR;
-                            LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else if (STRING_concat(destination, tempBuffer) != 0)
+                        int length;
+                        if ((length = sprintf_s(tempBuffer, tempBufferSize, "%.*f", DBL_DIG, value->value.edmDouble.value)) < 0)
                         {
                             result = AGENT_DATA_TYPES_ERROR;
                             LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
                         }
                         else
                         {
-                            result = AGENT_DATA_TYPES_OK;
+                            (void)delocalizeDecimalPoint(tempBuffer, (size_t)length);
+                            if (STRING_concat(destination, tempBuffer) != 0)
+                            {
+                                result = AGENT_DATA_TYPES_ERROR;
+                                LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+                            }
+                            else
+                            {
+                                result = AGENT_DATA_TYPES_OK;
+                            }
                         }
 
                         free(tempBuffer);
@@ -2217,18 +2085,13 @@ AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const
             }
             case EDM_BINARY_TYPE:
             {
-                size_t currentPosition = 0;
                 char* temp;
+                size_t encodedLength;
                 /*binary types */
                 /*Codes_SRS_AGENT_TYPE_SYSTEM_99_099:[EDM_BINARY:= *(4base64char)[base64b16 / base64b8]]*/
-                /*the following will happen*/
-                /*1. the "data" of the binary shall be "eaten" 3 characters at a time and produce 4 base64 encoded characters for as long as there are more than 3 characters still to process*/
-                /*2. the remaining characters (1 or 2) shall be encoded.*/
-                /*there's a level of assumption that 'a' corresponds to 0b000000 and that '_' corresponds to 0b111111*/
-                /*the encoding will use the optional [=] or [==] at the end of the encoded string, so that other less standard aware libraries can do their work*/
-                /*these are the bits of the 3 normal bytes to be encoded*/
+                /*the encoding uses the base64url alphabet and the optional [=] or [==] at the end of the encoded string, so that other less standard aware libraries can do their work*/
                 size_t neededSize = 2; /*2 because starting and ending quotes */
-                neededSize += (value->value.edmBinary.size == 0) ? (0) : ((((value->value.edmBinary.size-1) / 3) + 1) * 4);
+                neededSize += BASE64_ENCODED_LENGTH(value->value.edmBinary.size);
                 neededSize += 1; /*+1 because \0 at the end of the string*/
                 if ((temp = (char*)malloc(neededSize))==NULL)
                 {
@@ -2236,70 +2099,28 @@ AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const
                 }
                 else
                 {
-                    /*b0            b1(+1)          b2(+2)
-                      7 6 5 4 3 2 1 0 7 6 5 4 3 2 1 0 7 6 5 4 3 2 1 0
-                      |----c1---| |----c2---| |----c3---| |----c4---|
-                    */
-
-                    size_t destinationPointer = 0;
-                    temp[destinationPointer++] = '"';
-                    while (value->value.edmBinary.size - currentPosition >= 3)
-                    {
-                        char c1 = base64char(value->value.edmBinary.data[currentPosition] >> 2);
-                        char c2 = base64char(
-                            ((value->value.edmBinary.data[currentPosition] & 3) << 4) |
-                                (value->value.edmBinary.data[currentPosition + 1] >> 4)
-                        );
-                        char c3 = base64char(
-                            ((value->value.edmBinary.data[currentPosition + 1] & 0x0F) << 2) |
-                                ((value->value.edmBinary.data[currentPosition + 2] >> 6) & 3)
-                        );
-                        char c4 = base64char(
-                            value->value.edmBinary.data[currentPosition + 2] & 0x3F
-                        );
-                        currentPosition += 3;
-                        temp[destinationPointer++] = c1;
-                        temp[destinationPointer++] = c2;
-                        temp[destinationPointer++] = c3;
-                        temp[destinationPointer++] = c4;
-
-                    }
-                    if (value->value.edmBinary.size - currentPosition == 2)
-                    {
-                        char c1 = base64char(value->value.edmBinary.data[currentPosition] >> 2);
-                        char c2 = base64char(
-                            ((value->value.edmBinary.data[currentPosition] & 0x03) << 4) |
-                                (value->value.edmBinary.data[currentPosition + 1] >> 4)
-                        );
-                        char c3 = base64b16(value->value.edmBinary.data[currentPosition + 1] & 0x0F);
-                        temp[destinationPointer++] = c1;
-                        temp[destinationPointer++] = c2;
-                        temp[destinationPointer++] = c3;
-                        temp[destinationPointer++] = '=';
-                    }
-                    else if (value->value.edmBinary.size - currentPosition == 1)
-                    {
-                        char c1 = base64char(value->value.edmBinary.data[currentPosition] >> 2);
-                        char c2 = base64b8(value->value.edmBinary.data[currentPosition] & 0x03);
-                        temp[destinationPointer++] = c1;
-                        temp[destinationPointer++] = c2;
-                        temp[destinationPointer++] = '=';
-                        temp[destinationPointer++] = '=';
-                    }
-                    
-                    /*closing quote*/
-                    temp[destinationPointer++] = '"';
-                    /*null terminating the string*/
-                    temp[destinationPointer] = '\0';
-
-                    if (STRING_concat(destination, temp) != 0)
+                    temp[0] = '"';
+                    if (Base64Url_EncodeInto(temp + 1, neededSize - 2, value->value.edmBinary.data, value->value.edmBinary.size, &encodedLength) != 0)
                     {
                         result = AGENT_DATA_TYPES_ERROR;
                         LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
                     }
                     else
                     {
-                        result = AGENT_DATA_TYPES_OK;
+                        /*closing quote*/
+                        temp[1 + encodedLength] = '"';
+                        /*null terminating the string*/
+                        temp[2 + encodedLength] = '\0';
+
+                        if (STRING_concat(destination, temp) != 0)
+                        {
+                            result = AGENT_DATA_TYPES_ERROR;
+                            LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+                        }
+                        else
+                        {
+                            result = AGENT_DATA_TYPES_OK;
+                        }
                     }
                     free(temp);
                 }
@@ -2987,28 +2808,6 @@ static void fill_tm_yday_and_tm_wday(struct tm* source)
     /*the function shall count days */
 }
 
-/*the following function does the same as  sscanf(pos2, ":%02d", &sec)*/
-/*this function only exists because of optimizing valgrind time, otherwise sscanf would be just as good*/
-static int sscanf2d(const char *pos2, int* sec)
-{
-    int result;
-    size_t position = 1;
-    if (
-        (pos2[0] == ':') &&
-        (scanAndReadNDigitsInt(pos2, &position, sec, 2) == 0)
-        )
-    {
-        result = 1;
-    }
-    else
-    {
-        result = EOF;
-    }
-
-    return result;
-    
-}
-
 /*the following function does the same as  sscanf(pos2, "%d", &sec)*/
 /*this function only exists because of optimizing valgrind time, otherwise sscanf would be just as good*/
 static int sscanfd(const char *src, int* dst)
@@ -3042,65 +2841,282 @@ static int sscanfllu(const char** src, unsigned long long* dst)
     return result;
 }
 
-/*the following function does the same as  sscanf(src, ".%llu", &dst)*/
-static int sscanfdotllu(const char*src, unsigned long long* dst)
+/*the following function does the same as  sscanf(src, "%u", &dst)*/
+static int sscanfu(const char* src, unsigned int* dst)
 {
     int result;
-
-    if ((*src) != '.')
+    char* next;
+    unsigned long int temp = strtoul(src, &next, 10);
+    if ((src == next) || ((temp == ULONG_MAX) && (errno != 0)))
     {
-        /*doesn't start with '.' error out*/
         result = EOF;
     }
     else
     {
-        src++;
-        result = sscanfllu(&src, dst);
+        result = 1;
+        (*dst) = temp;
+    }
+    return result;
+}
+
+/*powers of 10 that are exactly representable in a double (10^22 is the last one)*/
+static const double exactDoublePowersOf10[] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/*powers of 10 that are exactly representable in a float (10^10 is the last one)*/
+static const float exactFloatPowersOf10[] =
+{
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+#define MAX_EXACT_DOUBLE_MANTISSA (1ULL << 53)
+#define MAX_EXACT_FLOAT_MANTISSA (1ULL << 24)
+#define MAX_FAST_PATH_MANTISSA_DIGITS 19
+
+/*scans a number having the JSON grammar -?digits[.digits][(e|E)[+|-]digits] that spans the whole of src*/
+/*the number is returned as mantissa * 10^exponent10 (with a sign), no locale is involved*/
+/*returns 0 if the number has been read and it can be represented exactly by the mantissa (at most 19 significant digits)*/
+/*returns 1 when the string is not such a number or it has too many digits, in which case the caller needs to fallback to the C runtime*/
+static int scanFastPathNumber(const char* src, unsigned long long* mantissa, int* exponent10, int* isNegative)
+{
+    int result;
+    const char* pos = src;
+    unsigned long long value = 0;
+    size_t significantDigits = 0;
+    int exponent = 0;
+
+    *isNegative = 0;
+    if (*pos == '-')
+    {
+        *isNegative = 1;
+        pos++;
+    }
+
+    if (!IS_DIGIT(*pos))
+    {
+        result = 1;
+    }
+    else
+    {
+        result = 0;
+
+        /*integral part, leading zeroes are not significant*/
+        while (IS_DIGIT(*pos))
+        {
+            if ((value != 0) || (*pos != '0'))
+            {
+                value = value * 10 + (*pos - '0');
+                significantDigits++;
+            }
+            pos++;
+        }
+
+        /*fractional part, every digit moves the exponent one step to the right*/
+        if (*pos == '.')
+        {
+            pos++;
+            if (!IS_DIGIT(*pos))
+            {
+                result = 1;
+            }
+            else
+            {
+                while (IS_DIGIT(*pos))
+                {
+                    if ((value != 0) || (*pos != '0'))
+                    {
+                        value = value * 10 + (*pos - '0');
+                        significantDigits++;
+                    }
+                    exponent--;
+                    pos++;
+                }
+            }
+        }
+
+        if ((result == 0) &&
+            ((*pos == 'e') || (*pos == 'E')))
+        {
+            int exponentSign = 1;
+            int explicitExponent = 0;
+            pos++;
+            if (*pos == '-')
+            {
+                exponentSign = -1;
+                pos++;
+            }
+            else if (*pos == '+')
+            {
+                pos++;
+            }
+
+            if (!IS_DIGIT(*pos))
+            {
+                result = 1;
+            }
+            else
+            {
+                while (IS_DIGIT(*pos))
+                {
+                    /*anything this big is way out of the fast path anyway*/
+                    if (explicitExponent < 10000)
+                    {
+                        explicitExponent = explicitExponent * 10 + (*pos - '0');
+                    }
+                    pos++;
+                }
+                exponent += exponentSign * explicitExponent;
+            }
+        }
+
+        /*the whole of the string has to be consumed and the mantissa cannot have overflown*/
+        if ((result == 0) &&
+            ((*pos != '\0') || (significantDigits > MAX_FAST_PATH_MANTISSA_DIGITS)))
+        {
+            result = 1;
+        }
     }
 
+    *mantissa = value;
+    *exponent10 = exponent;
     return result;
 }
 
-/*the following function does the same as  sscanf(src, "%u", &dst)*/
-static int sscanfu(const char* src, unsigned int* dst)
+/*strtod/strtof honour the decimal point of the current locale, JSON numbers always use '.'*/
+/*the slow path parses numbers up to this length when the locale's decimal point is not '.', longer ones are rejected*/
+#define LOCALIZED_NUMBER_BUFFER_SIZE 128
+
+/*this function sets *toParse to src when src can be given to strtod/strtof as it is, or to a copy of src in buffer that has the '.' replaced by the locale's decimal point*/
+/*returns 0 on success, or a non-zero value when the copy is needed, but src does not fit in buffer*/
+static int localizeDecimalPoint(const char* src, char* buffer, size_t bufferSize, const char** toParse)
 {
     int result;
-    char* next;
-    unsigned long int temp = strtoul(src, &next, 10);
-    if ((src == next) || ((temp == ULONG_MAX) && (errno != 0)))
+    const char* localeDecimalPoint = localeconv()->decimal_point;
+    const char* dot = strchr(src, '.');
+    if ((dot == NULL) ||
+        (localeDecimalPoint == NULL) ||
+        (strcmp(localeDecimalPoint, ".") == 0))
     {
-        result = EOF;
+        *toParse = src;
+        result = 0;
     }
     else
     {
-        result = 1;
-        (*dst) = temp;
+        size_t length = strlen(src);
+        size_t decimalPointLength = strlen(localeDecimalPoint);
+        size_t dotOffset = dot - src;
+        if ((decimalPointLength == 0) ||
+            (length - 1 + decimalPointLength >= bufferSize))
+        {
+            result = 1;
+        }
+        else
+        {
+            (void)memcpy(buffer, src, dotOffset);
+            (void)memcpy(buffer + dotOffset, localeDecimalPoint, decimalPointLength);
+            (void)memcpy(buffer + dotOffset + decimalPointLength, dot + 1, length - dotOffset);
+            *toParse = buffer;
+            result = 0;
+        }
     }
     return result;
 }
 
-/*the following function does the same as  sscanf(src, "%f", &dst)*/
+/*the following function does the same as  sscanf(src, "%f", &dst), but it does not depend on the locale*/
+/*numbers that have at most 24 bits of mantissa and a power of 10 up to 10 are computed exactly with one multiplication/division*/
+/*everything else falls back to strtof which is exact, but slow*/
 static int sscanff(const char*src, float* dst)
 {
     int result = 1;
-    char* next;
-    (*dst) = strtof(src, &next);
-    if ((src == next) || (((*dst) == HUGE_VALF) && (errno != 0)))
+    unsigned long long mantissa;
+    int exponent10;
+    int isNegative;
+
+    if ((scanFastPathNumber(src, &mantissa, &exponent10, &isNegative) == 0) &&
+        (mantissa <= MAX_EXACT_FLOAT_MANTISSA) &&
+        (exponent10 >= -10) &&
+        (exponent10 <= 10))
     {
-        result = EOF;
+        float value = (float)mantissa;
+        if (exponent10 < 0)
+        {
+            value /= exactFloatPowersOf10[-exponent10];
+        }
+        else
+        {
+            value *= exactFloatPowersOf10[exponent10];
+        }
+        (*dst) = isNegative ? -value : value;
+    }
+    else
+    {
+        char* next;
+        char localized[LOCALIZED_NUMBER_BUFFER_SIZE];
+        const char* toParse;
+        if (localizeDecimalPoint(src, localized, sizeof(localized), &toParse) != 0)
+        {
+            /*never parse the original string, the locale would stop it at the '.'*/
+            result = EOF;
+        }
+        else
+        {
+            (*dst) = strtof(toParse, &next);
+            if ((toParse == next) || (((*dst) == HUGE_VALF) && (errno != 0)))
+            {
+                result = EOF;
+            }
+        }
     }
     return result;
 }
 
-/*the following function does the same as  sscanf(src, "%lf", &dst)*/
+/*the following function does the same as  sscanf(src, "%lf", &dst), but it does not depend on the locale*/
+/*numbers that have at most 53 bits of mantissa and a power of 10 up to 22 are computed exactly with one multiplication/division (Clinger's fast path)*/
+/*everything else falls back to strtod which is exact, but slow*/
 static int sscanflf(const char*src, double* dst)
 {
     int result = 1;
-    char* next;
-    (*dst) = strtod(src, &next);
-    if ((src == next) || (((*dst) == HUGE_VALL) && (errno != 0)))
+    unsigned long long mantissa;
+    int exponent10;
+    int isNegative;
+
+    if ((scanFastPathNumber(src, &mantissa, &exponent10, &isNegative) == 0) &&
+        (mantissa <= MAX_EXACT_DOUBLE_MANTISSA) &&
+        (exponent10 >= -22) &&
+        (exponent10 <= 22))
     {
-        result = EOF;
+        double value = (double)mantissa;
+        if (exponent10 < 0)
+        {
+            value /= exactDoublePowersOf10[-exponent10];
+        }
+        else
+        {
+            value *= exactDoublePowersOf10[exponent10];
+        }
+        (*dst) = isNegative ? -value : value;
+    }
+    else
+    {
+        char* next;
+        char localized[LOCALIZED_NUMBER_BUFFER_SIZE];
+        const char* toParse;
+        if (localizeDecimalPoint(src, localized, sizeof(localized), &toParse) != 0)
+        {
+            /*never parse the original string, the locale would stop it at the '.'*/
+            result = EOF;
+        }
+        else
+        {
+            (*dst) = strtod(toParse, &next);
+            if ((toParse == next) || (((*dst) == HUGE_VALL) && (errno != 0)))
+            {
+                result = EOF;
+            }
+        }
     }
     return result;
 }
@@ -3480,114 +3496,110 @@ AGENT_DATA_TYPES_RESULT CreateAgentDataType_From_String(const char* source, AGEN
                     }
                     else
                     {
-                        const char* pos2;
+                        /*the rest of the date-time is scanned in the same pass, continuing right after the minutes*/
+                        const char* pos2 = source + pos;
                         year = year*sign;
-                        if ((pos2 = strchr(source, ':')) == NULL)
-                        {
-                            /* Codes_SRS_AGENT_TYPE_SYSTEM_99_087:[ CreateAgentDataType_From_String shall return AGENT_DATA_TYPES_INVALID_ARG if source is not a valid string for a value of type type.] */
-                            result = AGENT_DATA_TYPES_INVALID_ARG;
-                            LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else
+
+                        if (*pos2 == ':')
                         {
-                            pos2 += 3;
-                            if (*pos2 == ':')
+                            size_t secondsPosition = 1;
+                            if (scanAndReadNDigitsInt(pos2, &secondsPosition, &sec, 2) != 0)
                             {
-                                if (sscanf2d(pos2, &sec) != 1)
-                                {
-                                    pos2 = NULL;
-                                }
-                                else
-                                {
-                                    pos2 += 3;
-                                }
+                                pos2 = NULL;
                             }
-
-                            if ((pos2 != NULL) &&
-                                (*pos2 == '.'))
+                            else
                             {
-                                if (sscanfdotllu(pos2, &fractionalSeconds) != 1)
-                                {
-                                    pos2 = NULL;
-                                }
-                                else
-                                {
-                                    pos2++;
-
-                                    agentData->value.edmDateTimeOffset.hasFractionalSecond = 1;
-
-                                    while ((*pos2 != '\0') &&
-                                        (IS_DIGIT(*pos2)))
-                                    {
-                                        pos2++;
-                                    }
-
-                                    if (*pos2 == '\0')
-                                    {
-                                        pos2 = NULL;
-                                    }
-                                }
+                                pos2 += secondsPosition;
                             }
+                        }
 
-                            if (pos2 == NULL)
+                        if ((pos2 != NULL) &&
+                            (*pos2 == '.'))
+                        {
+                            pos2++;
+                            if (!IS_DIGIT(*pos2))
                             {
-                                /* Codes_SRS_AGENT_TYPE_SYSTEM_99_087:[ CreateAgentDataType_From_String shall return AGENT_DATA_TYPES_INVALID_ARG if source is not a valid string for a value of type type.] */
-                                result = AGENT_DATA_TYPES_INVALID_ARG;
-                                LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+                                pos2 = NULL;
                             }
                             else
                             {
-                                hourOffset = 0;
-                                minOffset = 0;
+                                agentData->value.edmDateTimeOffset.hasFractionalSecond = 1;
 
-                                if (sscanf3d2d(pos2, &hourOffset, &minOffset) == 2)
+                                while (IS_DIGIT(*pos2))
                                 {
-                                    agentData->value.edmDateTimeOffset.hasTimeZone = 1;
+                                    /*once over the maximum the value is only kept over the maximum so the range check below fails*/
+                                    if (fractionalSeconds <= 999999999999)
+                                    {
+                                        fractionalSeconds = fractionalSeconds * 10 + (*pos2 - '0');
+                                    }
+                                    pos2++;
                                 }
 
-                                if ((strcmp(pos2, "Z\"") == 0) ||
-                                    agentData->value.edmDateTimeOffset.hasTimeZone)
+                                if (*pos2 == '\0')
                                 {
-                                    if ((ValidateDate(year, month, day) != 0) ||
-                                        (hour < 0) ||
-                                        (hour > 23) ||
-                                        (min < 0) ||
-                                        (min > 59) ||
-                                        (sec < 0) ||
-                                        (sec > 59) ||
-                                        (fractionalSeconds > 999999999999) ||
-                                        (hourOffset < -23) ||
-                                        (hourOffset > 23) ||
-                                        (minOffset < 0) ||
-                                        (minOffset > 59))
-                                    {
-                                        /* Codes_SRS_AGENT_TYPE_SYSTEM_99_087:[ CreateAgentDataType_From_String shall return AGENT_DATA_TYPES_INVALID_ARG if source is not a valid string for a value of type type.] */
-                                        result = AGENT_DATA_TYPES_INVALID_ARG;
-                                        LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                                    }
-                                    else
-                                    {
-                                        agentData->type = EDM_DATE_TIME_OFFSET_TYPE;
-                                        agentData->value.edmDateTimeOffset.dateTime.tm_year= year-1900;
-                                        agentData->value.edmDateTimeOffset.dateTime.tm_mon = month-1;
-                                        agentData->value.edmDateTimeOffset.dateTime.tm_mday = day;
-                                        agentData->value.edmDateTimeOffset.dateTime.tm_hour = hour;
-                                        agentData->value.edmDateTimeOffset.dateTime.tm_min = min;
-                                        agentData->value.edmDateTimeOffset.dateTime.tm_sec = sec;
-                                        /*fill in tm_wday and tm_yday*/
-                                        fill_tm_yday_and_tm_wday(&agentData->value.edmDateTimeOffset.dateTime);
-                                        agentData->value.edmDateTimeOffset.fractionalSecond = (uint64_t)fractionalSeconds;
-                                        agentData->value.edmDateTimeOffset.timeZoneHour = (int8_t)hourOffset;
-                                        agentData->value.edmDateTimeOffset.timeZoneMinute = (uint8_t)minOffset;
-                                        result = AGENT_DATA_TYPES_OK;
-                                    }
+                                    pos2 = NULL;
                                 }
-                                else
+                            }
+                        }
+
+                        if (pos2 == NULL)
+                        {
+                            /* Codes_SRS_AGENT_TYPE_SYSTEM_99_087:[ CreateAgentDataType_From_String shall return AGENT_DATA_TYPES_INVALID_ARG if source is not a valid string for a value of type type.] */
+                            result = AGENT_DATA_TYPES_INVALID_ARG;
+                            LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+                        }
+                        else
+                        {
+                            hourOffset = 0;
+                            minOffset = 0;
+
+                            if (sscanf3d2d(pos2, &hourOffset, &minOffset) == 2)
+                            {
+                                agentData->value.edmDateTimeOffset.hasTimeZone = 1;
+                            }
+
+                            if ((strcmp(pos2, "Z\"") == 0) ||
+                                agentData->value.edmDateTimeOffset.hasTimeZone)
+                            {
+                                if ((ValidateDate(year, month, day) != 0) ||
+                                    (hour < 0) ||
+                                    (hour > 23) ||
+                                    (min < 0) ||
+                                    (min > 59) ||
+                                    (sec < 0) ||
+                                    (sec > 59) ||
+                                    (fractionalSeconds > 999999999999) ||
+                                    (hourOffset < -23) ||
+                                    (hourOffset > 23) ||
+                                    (minOffset < 0) ||
+                                    (minOffset > 59))
                                 {
                                     /* Codes_SRS_AGENT_TYPE_SYSTEM_99_087:[ CreateAgentDataType_From_String shall return AGENT_DATA_TYPES_INVALID_ARG if source is not a valid string for a value of type type.] */
                                     result = AGENT_DATA_TYPES_INVALID_ARG;
                                     LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
                                 }
+                                else
+                                {
+                                    agentData->type = EDM_DATE_TIME_OFFSET_TYPE;
+                                    agentData->value.edmDateTimeOffset.dateTime.tm_year= year-1900;
+                                    agentData->value.edmDateTimeOffset.dateTime.tm_mon = month-1;
+                                    agentData->value.edmDateTimeOffset.dateTime.tm_mday = day;
+                                    agentData->value.edmDateTimeOffset.dateTime.tm_hour = hour;
+                                    agentData->value.edmDateTimeOffset.dateTime.tm_min = min;
+                                    agentData->value.edmDateTimeOffset.dateTime.tm_sec = sec;
+                                    /*fill in tm_wday and tm_yday*/
+                                    fill_tm_yday_and_tm_wday(&agentData->value.edmDateTimeOffset.dateTime);
+                                    agentData->value.edmDateTimeOffset.fractionalSecond = (uint64_t)fractionalSeconds;
+                                    agentData->value.edmDateTimeOffset.timeZoneHour = (int8_t)hourOffset;
+                                    agentData->value.edmDateTimeOffset.timeZoneMinute = (uint8_t)minOffset;
+                                    result = AGENT_DATA_TYPES_OK;
+                                }
+                            }
+                            else
+                            {
+                                /* Codes_SRS_AGENT_TYPE_SYSTEM_99_087:[ CreateAgentDataType_From_String shall return AGENT_DATA_TYPES_INVALID_ARG if source is not a valid string for a value of type type.] */
+                                result = AGENT_DATA_TYPES_INVALID_ARG;
+                                LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
                             }
                         }
                     }
@@ -3889,77 +3901,39 @@ result = AGENT_DATA_TYPES_OK;
                 }
                 else
                 {
-                    size_t sourcePosition = 0;
-                    if (source[sourcePosition++] != '"') /*if it doesn't start with a quote then... */
+                    /*the content between the quotes is base64url, decoded straight into the binary*/
+                    size_t encodedLength = sourceLength - 2;
+                    size_t decodedSize;
+                    if ((source[0] != '"') || (source[sourceLength - 1] != '"')) /*if it doesn't start and end with a quote then... */
+                    {
+                        result = AGENT_DATA_TYPES_INVALID_ARG;
+                    }
+                    else if ((agentData->value.edmBinary.data = (unsigned char*)malloc(BASE64_DECODED_MAX_SIZE(encodedLength))) == NULL)
+                    {
+                        result = AGENT_DATA_TYPES_ERROR;
+                    }
+                    else if (Base64Url_DecodeInto(agentData->value.edmBinary.data, BASE64_DECODED_MAX_SIZE(encodedLength), source + 1, encodedLength, &decodedSize) != 0)
                     {
+                        free(agentData->value.edmBinary.data);
+                        agentData->value.edmBinary.data = NULL;
                         result = AGENT_DATA_TYPES_INVALID_ARG;
                     }
                     else
                     {
-                        /*1. read groups of 4 base64 character and transfer those into groups of 3 "normal" characters.
-                        2. read the end of the string and produce from that the ending characters*/
-
-                        /*compute the amount of memory to allocate*/
-                        agentData->value.edmBinary.size = (((sourceLength - 2) + 4) / 4) * 3; /*this is overallocation, shall be trimmed later*/
-                        agentData->value.edmBinary.data = (unsigned char*)malloc(agentData->value.edmBinary.size); /*this is overallocation, shall be trimmed later*/
-                        if (agentData->value.edmBinary.data == NULL)
+                        /*the padding and a partial last group decode to less than the allocated size, trim the result*/
+                        void* temp = (decodedSize == BASE64_DECODED_MAX_SIZE(encodedLength)) ? agentData->value.edmBinary.data : realloc(agentData->value.edmBinary.data, decodedSize);
+                        if (temp == NULL) /*this is extremely unlikely to happen, but whatever*/
                         {
+                            free(agentData->value.edmBinary.data);
+                            agentData->value.edmBinary.data = NULL;
                             result = AGENT_DATA_TYPES_ERROR;
                         }
                         else
                         {
-
-                            size_t destinationPosition = 0;
-                            size_t consumed;
-                            /*read and store "solid" groups of 4 base64 chars*/
-                            while (scan4base64char(source + sourcePosition, sourceLength - sourcePosition, agentData->value.edmBinary.data + destinationPosition, agentData->value.edmBinary.data + destinationPosition + 1, agentData->value.edmBinary.data + destinationPosition + 2) == 0)
-                            {
-                                sourcePosition += 4;
-                                destinationPosition += 3;
-                            }
-
-                            if (scanbase64b16(source + sourcePosition, sourceLength - sourcePosition, &consumed, agentData->value.edmBinary.data + destinationPosition, agentData->value.edmBinary.data + destinationPosition + 1) == 0)
-                            {
-                                sourcePosition += consumed;
-                                destinationPosition += 2;
-                                
-                            }
-                            else if (scanbase64b8(source + sourcePosition, sourceLength - sourcePosition, &consumed, agentData->value.edmBinary.data + destinationPosition) == 0)
-                            {
-                                sourcePosition += consumed;
-                                destinationPosition += 1;
-                            }
-
-                            if (source[sourcePosition++] != '"') /*if it doesn't end with " then bail out*/
-                            { 
-                                free(agentData->value.edmBinary.data);
-                                agentData->value.edmBinary.data = NULL;
-                                result = AGENT_DATA_TYPES_INVALID_ARG;
-                            }
-                            else if (sourcePosition != sourceLength)
-                            {
-                                free(agentData->value.edmBinary.data);
-                                agentData->value.edmBinary.data = NULL;
-                                result = AGENT_DATA_TYPES_INVALID_ARG;
-                            }
-                            else
-                            {
-                                /*trim the result*/
-                                void* temp = realloc(agentData->value.edmBinary.data, destinationPosition);
-                                if (temp == NULL) /*this is extremely unlikely to happen, but whatever*/
-                                {
-                                    free(agentData->value.edmBinary.data);
-                                    agentData->value.edmBinary.data = NULL;
-                                    result = AGENT_DATA_TYPES_ERROR;
-                                }
-                                else
-                                {
-                                    agentData->type = EDM_BINARY_TYPE;
-                                    agentData->value.edmBinary.data = (unsigned char*)temp;
-                                    agentData->value.edmBinary.size = destinationPosition;
-                                    result = AGENT_DATA_TYPES_OK;
-                                }
-                            }
+                            agentData->type = EDM_BINARY_TYPE;
+                            agentData->value.edmBinary.data = (unsigned char*)temp;
+                            agentData->value.edmBinary.size = decodedSize;
+                            result = AGENT_DATA_TYPES_OK;
                         }
                     }
                 }
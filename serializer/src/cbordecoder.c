@@ -0,0 +1,618 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include "azure_c_shared_utility/gballoc.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "cbordecoder.h"
+#include "agenttypesystem.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/strings.h"
+
+DEFINE_ENUM_STRINGS(CBOR_DECODER_RESULT, CBOR_DECODER_RESULT_VALUES);
+
+/*CBOR major types (RFC 7049, 2.1), as found in the upper 3 bits of the initial byte*/
+#define CBOR_MAJOR_TYPE_UNSIGNED_INTEGER 0
+#define CBOR_MAJOR_TYPE_NEGATIVE_INTEGER 1
+#define CBOR_MAJOR_TYPE_BYTE_STRING      2
+#define CBOR_MAJOR_TYPE_TEXT_STRING      3
+#define CBOR_MAJOR_TYPE_ARRAY            4
+#define CBOR_MAJOR_TYPE_MAP              5
+#define CBOR_MAJOR_TYPE_TAG              6
+#define CBOR_MAJOR_TYPE_SIMPLE_AND_FLOAT 7
+
+#define CBOR_SIMPLE_FALSE 20
+#define CBOR_SIMPLE_TRUE  21
+#define CBOR_SIMPLE_NULL  22
+#define CBOR_FLOAT16      25
+#define CBOR_FLOAT32      26
+#define CBOR_FLOAT64      27
+
+/*payloads are at most a few levels deep, this only stops hostile input from exhausting the stack*/
+#define CBOR_MAX_NESTING_DEPTH 64
+
+typedef struct CBOR_READER_TAG
+{
+    const unsigned char* cbor;
+    size_t size;
+    size_t position;
+    SCHEMA_MODEL_TYPE_HANDLE modelHandle;
+} CBOR_READER;
+
+typedef struct CBOR_ITEM_HEAD_TAG
+{
+    unsigned char majorType;
+    unsigned char additionalInformation;
+    uint64_t argument;
+} CBOR_ITEM_HEAD;
+
+/*the leaves are allocated by the decoder and handed over to the tree*/
+static int TakeOwnershipCloneFunction(void** destination, const void* source)
+{
+    *destination = (void*)source;
+    return 0;
+}
+
+static void FreeFunction(void* value)
+{
+    free(value);
+}
+
+static CBOR_DECODER_RESULT ReadItemHead(CBOR_READER* reader, CBOR_ITEM_HEAD* head)
+{
+    CBOR_DECODER_RESULT result;
+
+    if (reader->position >= reader->size)
+    {
+        result = CBOR_DECODER_PARSE_ERROR;
+        LogError("unexpected end of CBOR data");
+    }
+    else
+    {
+        unsigned char initialByte = reader->cbor[reader->position++];
+        head->majorType = (unsigned char)(initialByte >> 5);
+        head->additionalInformation = (unsigned char)(initialByte & 0x1F);
+
+        if (head->additionalInformation < 24)
+        {
+            head->argument = head->additionalInformation;
+            result = CBOR_DECODER_OK;
+        }
+        else if (head->additionalInformation <= 27)
+        {
+            /*24..27 are followed by a 1, 2, 4 or 8 bytes big endian argument*/
+            size_t argumentSize = (size_t)1 << (head->additionalInformation - 24);
+
+            if (reader->size - reader->position < argumentSize)
+            {
+                result = CBOR_DECODER_PARSE_ERROR;
+                LogError("unexpected end of CBOR data");
+            }
+            else
+            {
+                size_t i;
+                head->argument = 0;
+                for (i = 0; i < argumentSize; i++)
+                {
+                    head->argument = (head->argument << 8) | reader->cbor[reader->position++];
+                }
+                result = CBOR_DECODER_OK;
+            }
+        }
+        else
+        {
+            /*28..30 are reserved, 31 is an indefinite length item (or a break), which is not supported*/
+            result = CBOR_DECODER_PARSE_ERROR;
+            LogError("unsupported CBOR additional information %u", (unsigned int)head->additionalInformation);
+        }
+    }
+
+    return result;
+}
+
+static CBOR_DECODER_RESULT ReadStringBytes(CBOR_READER* reader, const CBOR_ITEM_HEAD* head, const unsigned char** bytes)
+{
+    CBOR_DECODER_RESULT result;
+
+    if (head->argument > reader->size - reader->position)
+    {
+        result = CBOR_DECODER_PARSE_ERROR;
+        LogError("CBOR string of %llu bytes goes past the end of the data", (unsigned long long)head->argument);
+    }
+    else
+    {
+        *bytes = reader->cbor + reader->position;
+        reader->position += (size_t)head->argument;
+        result = CBOR_DECODER_OK;
+    }
+
+    return result;
+}
+
+static char* CopyString(const char* source, size_t length)
+{
+    char* result;
+
+    if ((result = (char*)malloc(length + 1)) == NULL)
+    {
+        LogError("unable to allocate %lu bytes", (unsigned long)(length + 1));
+    }
+    else
+    {
+        (void)memcpy(result, source, length);
+        result[length] = '\0';
+    }
+
+    return result;
+}
+
+/*the JSON decoder leaves strings escaped and quoted, text strings are turned into exactly that form*/
+static char* TextToJSON(const unsigned char* text, size_t length)
+{
+    char* result;
+    size_t jsonLength = 2;
+    size_t i;
+
+    for (i = 0; i < length; i++)
+    {
+        jsonLength += (text[i] == '"' || text[i] == '\\') ? 2 : ((text[i] < 0x20) ? 6 : 1);
+    }
+
+    if ((result = (char*)malloc(jsonLength + 1)) == NULL)
+    {
+        LogError("unable to allocate %lu bytes", (unsigned long)(jsonLength + 1));
+    }
+    else
+    {
+        char* destination = result;
+        *destination++ = '"';
+        for (i = 0; i < length; i++)
+        {
+            if ((text[i] == '"') || (text[i] == '\\'))
+            {
+                *destination++ = '\\';
+                *destination++ = (char)text[i];
+            }
+            else if (text[i] < 0x20)
+            {
+                (void)sprintf(destination, "\\u%04x", (unsigned int)text[i]);
+                destination += 6;
+            }
+            else
+            {
+                *destination++ = (char)text[i];
+            }
+        }
+        *destination++ = '"';
+        *destination = '\0';
+    }
+
+    return result;
+}
+
+static char* BytesToJSON(const unsigned char* bytes, size_t length)
+{
+    char* result;
+    STRING_HANDLE text = STRING_new();
+
+    if (text == NULL)
+    {
+        result = NULL;
+        LogError("unable to create a STRING_HANDLE");
+    }
+    else
+    {
+        /*AgentDataTypes_ToString only reads the value, so the bytes are not copied into it*/
+        AGENT_DATA_TYPE binary;
+        binary.type = EDM_BINARY_TYPE;
+        binary.value.edmBinary.size = length;
+        binary.value.edmBinary.data = (unsigned char*)bytes;
+
+        if (AgentDataTypes_ToString(text, &binary) != AGENT_DATA_TYPES_OK)
+        {
+            result = NULL;
+            LogError("unable to encode %lu bytes as base64", (unsigned long)length);
+        }
+        else
+        {
+            result = CopyString(STRING_c_str(text), STRING_length(text));
+        }
+        STRING_delete(text);
+    }
+
+    return result;
+}
+
+static double HalfToDouble(uint16_t half)
+{
+    int exponent = (half >> 10) & 0x1F;
+    int mantissa = half & 0x3FF;
+    double value;
+
+    if (exponent == 0)
+    {
+        value = mantissa / 16777216.0; /*2^24*/
+    }
+    else if (exponent != 31)
+    {
+        value = (exponent >= 25) ?
+            (double)(mantissa + 1024) * (double)(1L << (exponent - 25)) :
+            (double)(mantissa + 1024) / (double)(1L << (25 - exponent));
+    }
+    else
+    {
+        value = (mantissa == 0) ? HUGE_VAL : NAN;
+    }
+
+    return (half & 0x8000) ? -value : value;
+}
+
+static char* FloatingPointToJSON(double value, int isSinglePrecision)
+{
+    char* result;
+
+    /*same spelling as AgentDataTypes_ToString uses, and CreateAgentDataType_From_String accepts*/
+    if (value != value)
+    {
+        result = CopyString("\"NaN\"", 5);
+    }
+    else if (value == HUGE_VAL)
+    {
+        result = CopyString("\"INF\"", 5);
+    }
+    else if (value == -HUGE_VAL)
+    {
+        result = CopyString("\"-INF\"", 6);
+    }
+    else
+    {
+        char text[AGENT_DATA_TYPES_FLOATING_POINT_STRING_SIZE];
+
+        /*the shortest text that reads back as the same value, with a '.' whatever the locale*/
+        if (AgentDataTypes_FloatingPointToString(text, sizeof(text), value, isSinglePrecision) != AGENT_DATA_TYPES_OK)
+        {
+            result = NULL;
+            LogError("unable to print a floating point value");
+        }
+        else
+        {
+            result = CopyString(text, strlen(text));
+        }
+    }
+
+    return result;
+}
+
+static CBOR_DECODER_RESULT DecodeLeaf(CBOR_READER* reader, const CBOR_ITEM_HEAD* head, char** leaf)
+{
+    CBOR_DECODER_RESULT result = CBOR_DECODER_OK;
+    char text[24];
+    const unsigned char* bytes;
+
+    *leaf = NULL;
+    switch (head->majorType)
+    {
+        case CBOR_MAJOR_TYPE_UNSIGNED_INTEGER:
+            *leaf = CopyString(text, (size_t)sprintf(text, "%llu", (unsigned long long)head->argument));
+            break;
+        case CBOR_MAJOR_TYPE_NEGATIVE_INTEGER:
+            /*the value is -1 - argument, which does not fit 64 bits for the largest argument*/
+            *leaf = (head->argument == UINT64_MAX) ?
+                CopyString("-18446744073709551616", 21) :
+                CopyString(text, (size_t)sprintf(text, "-%llu", (unsigned long long)head->argument + 1));
+            break;
+        case CBOR_MAJOR_TYPE_BYTE_STRING:
+            if ((result = ReadStringBytes(reader, head, &bytes)) == CBOR_DECODER_OK)
+            {
+                *leaf = BytesToJSON(bytes, (size_t)head->argument);
+            }
+            break;
+        case CBOR_MAJOR_TYPE_TEXT_STRING:
+            if ((result = ReadStringBytes(reader, head, &bytes)) == CBOR_DECODER_OK)
+            {
+                if (memchr(bytes, '\0', (size_t)head->argument) != NULL)
+                {
+                    result = CBOR_DECODER_PARSE_ERROR;
+                    LogError("CBOR text string contains a NUL character");
+                }
+                else
+                {
+                    *leaf = TextToJSON(bytes, (size_t)head->argument);
+                }
+            }
+            break;
+        case CBOR_MAJOR_TYPE_SIMPLE_AND_FLOAT:
+            switch (head->additionalInformation)
+            {
+                case CBOR_SIMPLE_FALSE:
+                    *leaf = CopyString("false", 5);
+                    break;
+                case CBOR_SIMPLE_TRUE:
+                    *leaf = CopyString("true", 4);
+                    break;
+                case CBOR_SIMPLE_NULL:
+                    *leaf = CopyString("null", 4);
+                    break;
+                case CBOR_FLOAT16:
+                    *leaf = FloatingPointToJSON(HalfToDouble((uint16_t)head->argument), 1);
+                    break;
+                case CBOR_FLOAT32:
+                {
+                    uint32_t bits = (uint32_t)head->argument;
+                    float value;
+                    (void)memcpy(&value, &bits, sizeof(value));
+                    *leaf = FloatingPointToJSON(value, 1);
+                    break;
+                }
+                case CBOR_FLOAT64:
+                {
+                    double value;
+                    (void)memcpy(&value, &head->argument, sizeof(value));
+                    *leaf = FloatingPointToJSON(value, 0);
+                    break;
+                }
+                default:
+                    result = CBOR_DECODER_PARSE_ERROR;
+                    LogError("unsupported CBOR simple value %llu", (unsigned long long)head->argument);
+                    break;
+            }
+            break;
+        default:
+            result = CBOR_DECODER_PARSE_ERROR;
+            LogError("unexpected CBOR major type %u", (unsigned int)head->majorType);
+            break;
+    }
+
+    if ((result == CBOR_DECODER_OK) && (*leaf == NULL))
+    {
+        result = CBOR_DECODER_ERROR;
+    }
+
+    return result;
+}
+
+/*adds the node for path under currentNode, reusing the intermediate nodes that already exist (key ids and their text fallbacks are full paths)*/
+static CBOR_DECODER_RESULT AddPathNode(MULTITREE_HANDLE currentNode, const char* path, size_t pathLength, MULTITREE_HANDLE* childNode)
+{
+    CBOR_DECODER_RESULT result;
+    char* segments = CopyString(path, pathLength);
+
+    if (segments == NULL)
+    {
+        result = CBOR_DECODER_ERROR;
+    }
+    else
+    {
+        char* segment = segments;
+        char* slash;
+
+        result = CBOR_DECODER_OK;
+        while ((result == CBOR_DECODER_OK) && ((slash = strchr(segment, '/')) != NULL))
+        {
+            MULTITREE_RESULT getResult;
+            *slash = '\0';
+
+            if (((getResult = MultiTree_GetChildByName(currentNode, segment, &currentNode)) != MULTITREE_OK) &&
+                ((getResult != MULTITREE_CHILD_NOT_FOUND) || (MultiTree_AddChild(currentNode, segment, &currentNode) != MULTITREE_OK)))
+            {
+                result = CBOR_DECODER_MULTITREE_FAILED;
+                LogError("(result = %s)", ENUM_TO_STRING(CBOR_DECODER_RESULT, result));
+            }
+            segment = slash + 1;
+        }
+
+        if ((result == CBOR_DECODER_OK) &&
+            (MultiTree_AddChild(currentNode, segment, childNode) != MULTITREE_OK))
+        {
+            result = CBOR_DECODER_MULTITREE_FAILED;
+            LogError("(result = %s)", ENUM_TO_STRING(CBOR_DECODER_RESULT, result));
+        }
+        free(segments);
+    }
+
+    return result;
+}
+
+static CBOR_DECODER_RESULT DecodeItem(CBOR_READER* reader, MULTITREE_HANDLE currentNode, size_t depth);
+
+static CBOR_DECODER_RESULT DecodeArray(CBOR_READER* reader, const CBOR_ITEM_HEAD* head, MULTITREE_HANDLE currentNode, size_t depth)
+{
+    CBOR_DECODER_RESULT result = CBOR_DECODER_OK;
+    uint64_t i;
+
+    for (i = 0; (i < head->argument) && (result == CBOR_DECODER_OK); i++)
+    {
+        char arrayIndexStr[22];
+        MULTITREE_HANDLE childNode;
+
+        /*array elements are named by their index, as the JSON decoder does*/
+        (void)sprintf(arrayIndexStr, "%llu", (unsigned long long)i);
+        if (MultiTree_AddChild(currentNode, arrayIndexStr, &childNode) != MULTITREE_OK)
+        {
+            result = CBOR_DECODER_MULTITREE_FAILED;
+            LogError("(result = %s)", ENUM_TO_STRING(CBOR_DECODER_RESULT, result));
+        }
+        else
+        {
+            result = DecodeItem(reader, childNode, depth + 1);
+        }
+    }
+
+    return result;
+}
+
+static CBOR_DECODER_RESULT DecodeMap(CBOR_READER* reader, const CBOR_ITEM_HEAD* head, MULTITREE_HANDLE currentNode, size_t depth)
+{
+    CBOR_DECODER_RESULT result = CBOR_DECODER_OK;
+    uint64_t i;
+
+    for (i = 0; (i < head->argument) && (result == CBOR_DECODER_OK); i++)
+    {
+        CBOR_ITEM_HEAD keyHead;
+        MULTITREE_HANDLE childNode;
+
+        if ((result = ReadItemHead(reader, &keyHead)) != CBOR_DECODER_OK)
+        {
+            /*already logged*/
+        }
+        else if (keyHead.majorType == CBOR_MAJOR_TYPE_UNSIGNED_INTEGER)
+        {
+            const char* path = (reader->modelHandle == NULL) ? NULL : Schema_GetModelPathById(reader->modelHandle, (size_t)keyHead.argument);
+            if ((path == NULL) || (keyHead.argument != (size_t)keyHead.argument))
+            {
+                result = CBOR_DECODER_UNKNOWN_KEY_ID;
+                LogError("unknown CBOR key id %llu", (unsigned long long)keyHead.argument);
+            }
+            else
+            {
+                result = AddPathNode(currentNode, path, strlen(path), &childNode);
+            }
+        }
+        else if (keyHead.majorType == CBOR_MAJOR_TYPE_TEXT_STRING)
+        {
+            const unsigned char* key;
+            if ((result = ReadStringBytes(reader, &keyHead, &key)) != CBOR_DECODER_OK)
+            {
+                /*already logged*/
+            }
+            else if (memchr(key, '\0', (size_t)keyHead.argument) != NULL)
+            {
+                result = CBOR_DECODER_PARSE_ERROR;
+                LogError("CBOR map key contains a NUL character");
+            }
+            else if (reader->modelHandle != NULL)
+            {
+                result = AddPathNode(currentNode, (const char*)key, (size_t)keyHead.argument, &childNode);
+            }
+            else
+            {
+                char* name = CopyString((const char*)key, (size_t)keyHead.argument);
+                if (name == NULL)
+                {
+                    result = CBOR_DECODER_ERROR;
+                }
+                else
+                {
+                    if (MultiTree_AddChild(currentNode, name, &childNode) != MULTITREE_OK)
+                    {
+                        result = CBOR_DECODER_MULTITREE_FAILED;
+                        LogError("(result = %s)", ENUM_TO_STRING(CBOR_DECODER_RESULT, result));
+                    }
+                    free(name);
+                }
+            }
+        }
+        else
+        {
+            result = CBOR_DECODER_PARSE_ERROR;
+            LogError("CBOR map keys can only be text strings or key ids, found major type %u", (unsigned int)keyHead.majorType);
+        }
+
+        if (result == CBOR_DECODER_OK)
+        {
+            result = DecodeItem(reader, childNode, depth + 1);
+        }
+    }
+
+    return result;
+}
+
+static CBOR_DECODER_RESULT DecodeItem(CBOR_READER* reader, MULTITREE_HANDLE currentNode, size_t depth)
+{
+    CBOR_DECODER_RESULT result;
+    CBOR_ITEM_HEAD head;
+
+    if (depth > CBOR_MAX_NESTING_DEPTH)
+    {
+        result = CBOR_DECODER_PARSE_ERROR;
+        LogError("CBOR data is nested deeper than %d levels", CBOR_MAX_NESTING_DEPTH);
+    }
+    else
+    {
+        /*tags (date/time, bignum hints...) carry no information the tree can hold, the tagged item is decoded instead*/
+        do
+        {
+            result = ReadItemHead(reader, &head);
+        } while ((result == CBOR_DECODER_OK) && (head.majorType == CBOR_MAJOR_TYPE_TAG));
+
+        if (result != CBOR_DECODER_OK)
+        {
+            /*already logged*/
+        }
+        else if (head.majorType == CBOR_MAJOR_TYPE_ARRAY)
+        {
+            result = DecodeArray(reader, &head, currentNode, depth);
+        }
+        else if (head.majorType == CBOR_MAJOR_TYPE_MAP)
+        {
+            result = DecodeMap(reader, &head, currentNode, depth);
+        }
+        else
+        {
+            char* leaf;
+            if ((result = DecodeLeaf(reader, &head, &leaf)) == CBOR_DECODER_OK)
+            {
+                if (MultiTree_SetValue(currentNode, leaf) != MULTITREE_OK)
+                {
+                    free(leaf);
+                    result = CBOR_DECODER_MULTITREE_FAILED;
+                    LogError("(result = %s)", ENUM_TO_STRING(CBOR_DECODER_RESULT, result));
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+CBOR_DECODER_RESULT CBORDecoder_CBOR_To_MultiTree(const unsigned char* cbor, size_t size, SCHEMA_MODEL_TYPE_HANDLE modelHandle, MULTITREE_HANDLE* multiTreeHandle)
+{
+    CBOR_DECODER_RESULT result;
+
+    if ((cbor == NULL) ||
+        (size == 0) ||
+        (multiTreeHandle == NULL))
+    {
+        result = CBOR_DECODER_INVALID_ARG;
+        LogError("(result = %s)", ENUM_TO_STRING(CBOR_DECODER_RESULT, result));
+    }
+    else if ((cbor[0] >> 5) != CBOR_MAJOR_TYPE_MAP && (cbor[0] >> 5) != CBOR_MAJOR_TYPE_ARRAY)
+    {
+        /*same as JSON: the payload has to be an object or an array*/
+        result = CBOR_DECODER_PARSE_ERROR;
+        LogError("(result = %s)", ENUM_TO_STRING(CBOR_DECODER_RESULT, result));
+    }
+    else if ((*multiTreeHandle = MultiTree_Create(TakeOwnershipCloneFunction, FreeFunction)) == NULL)
+    {
+        result = CBOR_DECODER_MULTITREE_FAILED;
+        LogError("(result = %s)", ENUM_TO_STRING(CBOR_DECODER_RESULT, result));
+    }
+    else
+    {
+        CBOR_READER reader;
+        reader.cbor = cbor;
+        reader.size = size;
+        reader.position = 0;
+        reader.modelHandle = modelHandle;
+
+        if ((result = DecodeItem(&reader, *multiTreeHandle, 0)) == CBOR_DECODER_OK &&
+            (reader.position != reader.size))
+        {
+            result = CBOR_DECODER_PARSE_ERROR;
+            LogError("%lu bytes left after the CBOR data item", (unsigned long)(reader.size - reader.position));
+        }
+
+        if (result != CBOR_DECODER_OK)
+        {
+            MultiTree_Destroy(*multiTreeHandle);
+            *multiTreeHandle = NULL;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,533 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include "azure_c_shared_utility/gballoc.h"
+
+#include <stdint.h>
+#include <string.h>
+#include "cborencoder.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/strings.h"
+
+DEFINE_ENUM_STRINGS(CBOR_ENCODER_RESULT, CBOR_ENCODER_RESULT_VALUES);
+
+/*CBOR major types (RFC 7049, 2.1), already shifted in the upper 3 bits of the initial byte*/
+#define CBOR_MAJOR_TYPE_UNSIGNED_INTEGER 0x00
+#define CBOR_MAJOR_TYPE_NEGATIVE_INTEGER 0x20
+#define CBOR_MAJOR_TYPE_BYTE_STRING      0x40
+#define CBOR_MAJOR_TYPE_TEXT_STRING      0x60
+#define CBOR_MAJOR_TYPE_MAP              0xA0
+#define CBOR_MAJOR_TYPE_TAG              0xC0
+
+#define CBOR_FALSE   0xF4
+#define CBOR_TRUE    0xF5
+#define CBOR_NULL    0xF6
+#define CBOR_FLOAT32 0xFA
+#define CBOR_FLOAT64 0xFB
+
+/*tag 0: standard date/time string (RFC 3339)*/
+#define CBOR_TAG_DATE_TIME_STRING 0
+
+#define INITIAL_CBOR_WRITER_CAPACITY 64
+
+typedef struct CBOR_WRITER_TAG
+{
+    unsigned char* buffer;
+    size_t size;
+    size_t capacity;
+} CBOR_WRITER;
+
+static int EnsureCapacity(CBOR_WRITER* writer, size_t extraSize)
+{
+    int result;
+
+    if (writer->size + extraSize <= writer->capacity)
+    {
+        result = 0;
+    }
+    else
+    {
+        size_t newCapacity = (writer->capacity == 0) ? INITIAL_CBOR_WRITER_CAPACITY : writer->capacity;
+        unsigned char* newBuffer;
+
+        while (newCapacity < writer->size + extraSize)
+        {
+            newCapacity *= 2;
+        }
+
+        if ((newBuffer = (unsigned char*)realloc(writer->buffer, newCapacity)) == NULL)
+        {
+            LogError("unable to grow the CBOR buffer to %lu bytes", (unsigned long)newCapacity);
+            result = __FAILURE__;
+        }
+        else
+        {
+            writer->buffer = newBuffer;
+            writer->capacity = newCapacity;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+/*writes the initial byte of a data item and its argument in the shortest form*/
+static int WriteTypeAndArgument(CBOR_WRITER* writer, unsigned char majorType, uint64_t argument)
+{
+    int result;
+
+    if (EnsureCapacity(writer, 9) != 0)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        unsigned char* destination = writer->buffer + writer->size;
+
+        if (argument < 24)
+        {
+            destination[0] = (unsigned char)(majorType | argument);
+            writer->size += 1;
+        }
+        else if (argument <= UINT8_MAX)
+        {
+            destination[0] = (unsigned char)(majorType | 24);
+            destination[1] = (unsigned char)argument;
+            writer->size += 2;
+        }
+        else if (argument <= UINT16_MAX)
+        {
+            destination[0] = (unsigned char)(majorType | 25);
+            destination[1] = (unsigned char)(argument >> 8);
+            destination[2] = (unsigned char)argument;
+            writer->size += 3;
+        }
+        else if (argument <= UINT32_MAX)
+        {
+            destination[0] = (unsigned char)(majorType | 26);
+            destination[1] = (unsigned char)(argument >> 24);
+            destination[2] = (unsigned char)(argument >> 16);
+            destination[3] = (unsigned char)(argument >> 8);
+            destination[4] = (unsigned char)argument;
+            writer->size += 5;
+        }
+        else
+        {
+            size_t i;
+            destination[0] = (unsigned char)(majorType | 27);
+            for (i = 0; i < 8; i++)
+            {
+                destination[1 + i] = (unsigned char)(argument >> (8 * (7 - i)));
+            }
+            writer->size += 9;
+        }
+        result = 0;
+    }
+
+    return result;
+}
+
+static int WriteBytes(CBOR_WRITER* writer, unsigned char majorType, const void* bytes, size_t size)
+{
+    int result;
+
+    if ((WriteTypeAndArgument(writer, majorType, size) != 0) ||
+        (EnsureCapacity(writer, size) != 0))
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        if (size > 0)
+        {
+            (void)memcpy(writer->buffer + writer->size, bytes, size);
+            writer->size += size;
+        }
+        result = 0;
+    }
+
+    return result;
+}
+
+static int WriteSimpleValue(CBOR_WRITER* writer, unsigned char value)
+{
+    int result;
+
+    if (EnsureCapacity(writer, 1) != 0)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        writer->buffer[writer->size++] = value;
+        result = 0;
+    }
+
+    return result;
+}
+
+static int WriteSignedInteger(CBOR_WRITER* writer, int64_t value)
+{
+    return (value >= 0) ?
+        WriteTypeAndArgument(writer, CBOR_MAJOR_TYPE_UNSIGNED_INTEGER, (uint64_t)value) :
+        /*-1 - n is encoded as n, written so that INT64_MIN does not overflow*/
+        WriteTypeAndArgument(writer, CBOR_MAJOR_TYPE_NEGATIVE_INTEGER, (uint64_t)(-(value + 1)));
+}
+
+static int WriteFloat(CBOR_WRITER* writer, float value)
+{
+    int result;
+    uint32_t bits;
+
+    (void)memcpy(&bits, &value, sizeof(bits));
+    if (EnsureCapacity(writer, 5) != 0)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        unsigned char* destination = writer->buffer + writer->size;
+        destination[0] = CBOR_FLOAT32;
+        destination[1] = (unsigned char)(bits >> 24);
+        destination[2] = (unsigned char)(bits >> 16);
+        destination[3] = (unsigned char)(bits >> 8);
+        destination[4] = (unsigned char)bits;
+        writer->size += 5;
+        result = 0;
+    }
+
+    return result;
+}
+
+static int WriteDouble(CBOR_WRITER* writer, double value)
+{
+    int result;
+
+    /*a double that a float holds exactly (most sensor readings) takes 5 bytes instead of 9*/
+    if ((value == value) && ((double)(float)value == value))
+    {
+        result = WriteFloat(writer, (float)value);
+    }
+    else if (EnsureCapacity(writer, 9) != 0)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        uint64_t bits;
+        size_t i;
+        unsigned char* destination = writer->buffer + writer->size;
+
+        (void)memcpy(&bits, &value, sizeof(bits));
+        destination[0] = CBOR_FLOAT64;
+        for (i = 0; i < 8; i++)
+        {
+            destination[1 + i] = (unsigned char)(bits >> (8 * (7 - i)));
+        }
+        writer->size += 9;
+        result = 0;
+    }
+
+    return result;
+}
+
+static int WriteTextString(CBOR_WRITER* writer, const char* text)
+{
+    return WriteBytes(writer, CBOR_MAJOR_TYPE_TEXT_STRING, text, strlen(text));
+}
+
+/*types that have no CBOR counterpart are written as the text AgentDataTypes_ToString produces, without the JSON quotes*/
+static int WriteAsText(CBOR_WRITER* writer, const AGENT_DATA_TYPE* value)
+{
+    int result;
+    STRING_HANDLE text = STRING_new();
+
+    if (text == NULL)
+    {
+        LogError("unable to create a STRING_HANDLE");
+        result = __FAILURE__;
+    }
+    else
+    {
+        if (AgentDataTypes_ToString(text, value) != AGENT_DATA_TYPES_OK)
+        {
+            LogError("unable to convert a value of type %d to text", (int)value->type);
+            result = __FAILURE__;
+        }
+        else
+        {
+            const char* chars = STRING_c_str(text);
+            size_t length = STRING_length(text);
+
+            if ((length >= 2) && (chars[0] == '"') && (chars[length - 1] == '"'))
+            {
+                chars++;
+                length -= 2;
+            }
+            result = WriteBytes(writer, CBOR_MAJOR_TYPE_TEXT_STRING, chars, length);
+        }
+        STRING_delete(text);
+    }
+
+    return result;
+}
+
+static int WriteAgentDataType(CBOR_WRITER* writer, const AGENT_DATA_TYPE* value)
+{
+    int result;
+
+    switch (value->type)
+    {
+        case EDM_BOOLEAN_TYPE:
+            result = WriteSimpleValue(writer, (value->value.edmBoolean.value == EDM_TRUE) ? CBOR_TRUE : CBOR_FALSE);
+            break;
+        case EDM_BYTE_TYPE:
+            result = WriteTypeAndArgument(writer, CBOR_MAJOR_TYPE_UNSIGNED_INTEGER, value->value.edmByte.value);
+            break;
+        case EDM_SBYTE_TYPE:
+            result = WriteSignedInteger(writer, value->value.edmSbyte.value);
+            break;
+        case EDM_INT16_TYPE:
+            result = WriteSignedInteger(writer, value->value.edmInt16.value);
+            break;
+        case EDM_INT32_TYPE:
+            result = WriteSignedInteger(writer, value->value.edmInt32.value);
+            break;
+        case EDM_INT64_TYPE:
+            result = WriteSignedInteger(writer, value->value.edmInt64.value);
+            break;
+        case EDM_SINGLE_TYPE:
+            result = WriteFloat(writer, value->value.edmSingle.value);
+            break;
+        case EDM_DOUBLE_TYPE:
+            result = WriteDouble(writer, value->value.edmDouble.value);
+            break;
+        case EDM_STRING_TYPE:
+            result = WriteBytes(writer, CBOR_MAJOR_TYPE_TEXT_STRING, value->value.edmString.chars, value->value.edmString.length);
+            break;
+        case EDM_STRING_NO_QUOTES_TYPE:
+            result = WriteBytes(writer, CBOR_MAJOR_TYPE_TEXT_STRING, value->value.edmStringNoQuotes.chars, value->value.edmStringNoQuotes.length);
+            break;
+        case EDM_BINARY_TYPE:
+            result = WriteBytes(writer, CBOR_MAJOR_TYPE_BYTE_STRING, value->value.edmBinary.data, value->value.edmBinary.size);
+            break;
+        case EDM_NULL_TYPE:
+            result = WriteSimpleValue(writer, CBOR_NULL);
+            break;
+        case EDM_DATE_TIME_OFFSET_TYPE:
+            result = ((WriteTypeAndArgument(writer, CBOR_MAJOR_TYPE_TAG, CBOR_TAG_DATE_TIME_STRING) != 0) ||
+                (WriteAsText(writer, value) != 0)) ? __FAILURE__ : 0;
+            break;
+        case EDM_COMPLEX_TYPE_TYPE:
+        {
+            size_t i;
+
+            result = WriteTypeAndArgument(writer, CBOR_MAJOR_TYPE_MAP, value->value.edmComplexType.nMembers);
+            for (i = 0; (result == 0) && (i < value->value.edmComplexType.nMembers); i++)
+            {
+                if ((WriteTextString(writer, value->value.edmComplexType.fields[i].fieldName) != 0) ||
+                    (WriteAgentDataType(writer, value->value.edmComplexType.fields[i].value) != 0))
+                {
+                    result = __FAILURE__;
+                }
+            }
+            break;
+        }
+        default:
+            result = WriteAsText(writer, value);
+            break;
+    }
+
+    return result;
+}
+
+static CBOR_ENCODER_RESULT WriteTree(CBOR_WRITER* writer, MULTITREE_HANDLE treeHandle, STRING_HANDLE name)
+{
+    CBOR_ENCODER_RESULT result;
+    size_t childCount;
+
+    if (MultiTree_GetChildCount(treeHandle, &childCount) != MULTITREE_OK)
+    {
+        result = CBOR_ENCODER_MULTITREE_ERROR;
+        LogError("(result = %s)", ENUM_TO_STRING(CBOR_ENCODER_RESULT, result));
+    }
+    else if (childCount == 0)
+    {
+        const void* value;
+        if (MultiTree_GetValue(treeHandle, &value) != MULTITREE_OK)
+        {
+            result = CBOR_ENCODER_MULTITREE_ERROR;
+            LogError("(result = %s)", ENUM_TO_STRING(CBOR_ENCODER_RESULT, result));
+        }
+        else if (WriteAgentDataType(writer, (const AGENT_DATA_TYPE*)value) != 0)
+        {
+            result = CBOR_ENCODER_AGENT_DATA_TYPES_ERROR;
+            LogError("(result = %s)", ENUM_TO_STRING(CBOR_ENCODER_RESULT, result));
+        }
+        else
+        {
+            result = CBOR_ENCODER_OK;
+        }
+    }
+    else if (WriteTypeAndArgument(writer, CBOR_MAJOR_TYPE_MAP, childCount) != 0)
+    {
+        result = CBOR_ENCODER_ERROR;
+        LogError("(result = %s)", ENUM_TO_STRING(CBOR_ENCODER_RESULT, result));
+    }
+    else
+    {
+        size_t i;
+
+        result = CBOR_ENCODER_OK;
+        for (i = 0; (i < childCount) && (result == CBOR_ENCODER_OK); i++)
+        {
+            MULTITREE_HANDLE childTreeHandle;
+
+            if ((MultiTree_GetChild(treeHandle, i, &childTreeHandle) != MULTITREE_OK) ||
+                (STRING_empty(name) != 0) ||
+                (MultiTree_GetName(childTreeHandle, name) != MULTITREE_OK))
+            {
+                result = CBOR_ENCODER_MULTITREE_ERROR;
+                LogError("(result = %s)", ENUM_TO_STRING(CBOR_ENCODER_RESULT, result));
+            }
+            else if (WriteBytes(writer, CBOR_MAJOR_TYPE_TEXT_STRING, STRING_c_str(name), STRING_length(name)) != 0)
+            {
+                result = CBOR_ENCODER_ERROR;
+                LogError("(result = %s)", ENUM_TO_STRING(CBOR_ENCODER_RESULT, result));
+            }
+            else
+            {
+                result = WriteTree(writer, childTreeHandle, name);
+            }
+        }
+    }
+
+    return result;
+}
+
+CBOR_ENCODER_RESULT CBOREncoder_EncodeTree(MULTITREE_HANDLE treeHandle, unsigned char** destination, size_t* destinationSize)
+{
+    CBOR_ENCODER_RESULT result;
+
+    if ((treeHandle == NULL) ||
+        (destination == NULL) ||
+        (destinationSize == NULL))
+    {
+        result = CBOR_ENCODER_INVALID_ARG;
+        LogError("(result = %s)", ENUM_TO_STRING(CBOR_ENCODER_RESULT, result));
+    }
+    else
+    {
+        /*the name of each node is fetched into the same string, it only grows to the longest name*/
+        STRING_HANDLE name = STRING_new();
+        if (name == NULL)
+        {
+            result = CBOR_ENCODER_ERROR;
+            LogError("(result = %s)", ENUM_TO_STRING(CBOR_ENCODER_RESULT, result));
+        }
+        else
+        {
+            CBOR_WRITER writer;
+            size_t childCount;
+
+            writer.buffer = NULL;
+            writer.size = 0;
+            writer.capacity = 0;
+
+            /*the root is always a map, even when it has no children*/
+            if (MultiTree_GetChildCount(treeHandle, &childCount) != MULTITREE_OK)
+            {
+                result = CBOR_ENCODER_MULTITREE_ERROR;
+                LogError("(result = %s)", ENUM_TO_STRING(CBOR_ENCODER_RESULT, result));
+            }
+            else if (childCount == 0)
+            {
+                result = (WriteTypeAndArgument(&writer, CBOR_MAJOR_TYPE_MAP, 0) == 0) ? CBOR_ENCODER_OK : CBOR_ENCODER_ERROR;
+            }
+            else
+            {
+                result = WriteTree(&writer, treeHandle, name);
+            }
+
+            if (result != CBOR_ENCODER_OK)
+            {
+                free(writer.buffer);
+            }
+            else
+            {
+                *destination = writer.buffer;
+                *destinationSize = writer.size;
+            }
+            STRING_delete(name);
+        }
+    }
+
+    return result;
+}
+
+CBOR_ENCODER_RESULT CBOREncoder_EncodeKeyedValues(size_t valueCount, const CBOR_ENCODER_KEYED_VALUE* values, unsigned char** destination, size_t* destinationSize)
+{
+    CBOR_ENCODER_RESULT result;
+
+    if (((values == NULL) && (valueCount > 0)) ||
+        (destination == NULL) ||
+        (destinationSize == NULL))
+    {
+        result = CBOR_ENCODER_INVALID_ARG;
+        LogError("(result = %s)", ENUM_TO_STRING(CBOR_ENCODER_RESULT, result));
+    }
+    else
+    {
+        CBOR_WRITER writer;
+        size_t i;
+
+        writer.buffer = NULL;
+        writer.size = 0;
+        writer.capacity = 0;
+
+        if (WriteTypeAndArgument(&writer, CBOR_MAJOR_TYPE_MAP, valueCount) != 0)
+        {
+            result = CBOR_ENCODER_ERROR;
+            LogError("(result = %s)", ENUM_TO_STRING(CBOR_ENCODER_RESULT, result));
+        }
+        else
+        {
+            result = CBOR_ENCODER_OK;
+            for (i = 0; (i < valueCount) && (result == CBOR_ENCODER_OK); i++)
+            {
+                if ((values[i].value == NULL) ||
+                    ((values[i].keyId == CBOR_ENCODER_NO_KEY_ID) && (values[i].keyName == NULL)))
+                {
+                    result = CBOR_ENCODER_INVALID_ARG;
+                    LogError("(result = %s)", ENUM_TO_STRING(CBOR_ENCODER_RESULT, result));
+                }
+                else if (((values[i].keyId == CBOR_ENCODER_NO_KEY_ID) ?
+                    WriteTextString(&writer, values[i].keyName) :
+                    WriteTypeAndArgument(&writer, CBOR_MAJOR_TYPE_UNSIGNED_INTEGER, values[i].keyId)) != 0)
+                {
+                    result = CBOR_ENCODER_ERROR;
+                    LogError("(result = %s)", ENUM_TO_STRING(CBOR_ENCODER_RESULT, result));
+                }
+                else if (WriteAgentDataType(&writer, values[i].value) != 0)
+                {
+                    result = CBOR_ENCODER_AGENT_DATA_TYPES_ERROR;
+                    LogError("(result = %s)", ENUM_TO_STRING(CBOR_ENCODER_RESULT, result));
+                }
+            }
+        }
+
+        if (result != CBOR_ENCODER_OK)
+        {
+            free(writer.buffer);
+        }
+        else
+        {
+            *destination = writer.buffer;
+            *destinationSize = writer.size;
+        }
+    }
+
+    return result;
+}
@@ -3,6 +3,7 @@
 
 #include <stdlib.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include "azure_c_shared_utility/gballoc.h"
 
 #include "codefirst.h"
@@ -19,11 +20,38 @@ DEFINE_ENUM_STRINGS(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_RESULT_VALUES)
 #define LOG_CODEFIRST_ERROR \
     LogError("(result = %s)", ENUM_TO_STRING(CODEFIRST_RESULT, result))
 
+/*one entry for every property (or reported property) reachable from a model, model in model included*/
+typedef struct PROPERTY_PATH_ENTRY_TAG
+{
+    size_t offset; /*offset of the property from the start of the device data*/
+    size_t depth; /*0 for the properties of the model itself, 1 for the properties of its child models and so on*/
+    const REFLECTED_SOMETHING* property;
+    char* path; /*"child/grandChild/property", ready to be given to Device_PublishTransacted*/
+} PROPERTY_PATH_ENTRY;
+
+typedef struct PROPERTY_PATH_TABLE_TAG
+{
+    PROPERTY_PATH_ENTRY* entries; /*sorted by offset, at most one entry per offset*/
+    size_t count;
+} PROPERTY_PATH_TABLE;
+
+/*shared by all the devices created with the same model and reflected data*/
+typedef struct MODEL_PROPERTY_INDEX_TAG
+{
+    SCHEMA_MODEL_TYPE_HANDLE ModelHandle;
+    const REFLECTED_DATA_FROM_DATAPROVIDER* ReflectedData;
+    size_t DeviceCount;
+    char* ModelName; /*name of the model the tables have been built for, NULL when the tables are not built yet*/
+    PROPERTY_PATH_TABLE Properties;
+    PROPERTY_PATH_TABLE ReportedProperties;
+} MODEL_PROPERTY_INDEX;
+
 typedef struct DEVICE_HEADER_DATA_TAG
 {
     DEVICE_HANDLE DeviceHandle;
     const REFLECTED_DATA_FROM_DATAPROVIDER* ReflectedData;
     SCHEMA_MODEL_TYPE_HANDLE ModelHandle;
+    MODEL_PROPERTY_INDEX* PropertyIndex;
     size_t DataSize;
     unsigned char* data;
 } DEVICE_HEADER_DATA;
@@ -80,7 +108,9 @@ DEFINE_ENUM(CODEFIRST_STATE, CODEFIRST_STATE_VALUES)
 static CODEFIRST_STATE g_state = CODEFIRST_STATE_NOT_INIT;
 static const char* g_OverrideSchemaNamespace;
 static size_t g_DeviceCount = 0;
-static DEVICE_HEADER_DATA** g_Devices = NULL;
+static DEVICE_HEADER_DATA** g_Devices = NULL; /*sorted by the address of the device data*/
+static size_t g_ModelPropertyIndexCount = 0;
+static MODEL_PROPERTY_INDEX** g_ModelPropertyIndexes = NULL;
 
 static void deinitializeDesiredProperties(SCHEMA_MODEL_TYPE_HANDLE model, void* destination)
 {
@@ -153,16 +183,134 @@ static void deinitializeDesiredProperties(SCHEMA_MODEL_TYPE_HANDLE model, void*
     }
 }
 
+static void DestroyPropertyPathTable(PROPERTY_PATH_TABLE* table)
+{
+    size_t i;
+    for (i = 0; i < table->count; i++)
+    {
+        free(table->entries[i].path);
+    }
+    free(table->entries);
+    table->entries = NULL;
+    table->count = 0;
+}
+
+static MODEL_PROPERTY_INDEX* AcquireModelPropertyIndex(SCHEMA_MODEL_TYPE_HANDLE model, const REFLECTED_DATA_FROM_DATAPROVIDER* reflectedData)
+{
+    MODEL_PROPERTY_INDEX* result = NULL;
+    size_t i;
+
+    for (i = 0; i < g_ModelPropertyIndexCount; i++)
+    {
+        if ((g_ModelPropertyIndexes[i]->ModelHandle == model) &&
+            (g_ModelPropertyIndexes[i]->ReflectedData == reflectedData))
+        {
+            result = g_ModelPropertyIndexes[i];
+            break;
+        }
+    }
+
+    if (result == NULL)
+    {
+        MODEL_PROPERTY_INDEX** newIndexes;
+        if ((result = (MODEL_PROPERTY_INDEX*)malloc(sizeof(MODEL_PROPERTY_INDEX))) == NULL)
+        {
+            LogError("unable to allocate memory for the model property index");
+        }
+        else if ((newIndexes = (MODEL_PROPERTY_INDEX**)realloc(g_ModelPropertyIndexes, sizeof(MODEL_PROPERTY_INDEX*) * (g_ModelPropertyIndexCount + 1))) == NULL)
+        {
+            LogError("unable to grow the model property indexes");
+            free(result);
+            result = NULL;
+        }
+        else
+        {
+            /*the tables are built on the first CodeFirst_SendAsync/CodeFirst_SendAsyncReported that needs them*/
+            result->ModelHandle = model;
+            result->ReflectedData = reflectedData;
+            result->DeviceCount = 0;
+            result->ModelName = NULL;
+            result->Properties.entries = NULL;
+            result->Properties.count = 0;
+            result->ReportedProperties.entries = NULL;
+            result->ReportedProperties.count = 0;
+
+            g_ModelPropertyIndexes = newIndexes;
+            g_ModelPropertyIndexes[g_ModelPropertyIndexCount] = result;
+            g_ModelPropertyIndexCount++;
+        }
+    }
+
+    if (result != NULL)
+    {
+        result->DeviceCount++;
+    }
+
+    return result;
+}
+
+static void ReleaseModelPropertyIndex(MODEL_PROPERTY_INDEX* propertyIndex)
+{
+    propertyIndex->DeviceCount--;
+    if (propertyIndex->DeviceCount == 0)
+    {
+        size_t i;
+        for (i = 0; i < g_ModelPropertyIndexCount; i++)
+        {
+            if (g_ModelPropertyIndexes[i] == propertyIndex)
+            {
+                (void)memmove(&g_ModelPropertyIndexes[i], &g_ModelPropertyIndexes[i + 1], (g_ModelPropertyIndexCount - i - 1) * sizeof(MODEL_PROPERTY_INDEX*));
+                g_ModelPropertyIndexCount--;
+                break;
+            }
+        }
+
+        if (g_ModelPropertyIndexCount == 0)
+        {
+            free(g_ModelPropertyIndexes);
+            g_ModelPropertyIndexes = NULL;
+        }
+
+        DestroyPropertyPathTable(&propertyIndex->Properties);
+        DestroyPropertyPathTable(&propertyIndex->ReportedProperties);
+        free(propertyIndex->ModelName);
+        free(propertyIndex);
+    }
+}
+
 static void DestroyDevice(DEVICE_HEADER_DATA* deviceHeader)
 {
     /* Codes_SRS_CODEFIRST_99_085:[CodeFirst_DestroyDevice shall free all resources associated with a device.] */
     /* Codes_SRS_CODEFIRST_99_087:[In order to release the device handle, CodeFirst_DestroyDevice shall call Device_Destroy.] */
     
     Device_Destroy(deviceHeader->DeviceHandle);
+    ReleaseModelPropertyIndex(deviceHeader->PropertyIndex);
     free(deviceHeader->data);
     free(deviceHeader);
 }
 
+/*returns how many devices have their data starting at or before address*/
+static size_t GetDeviceUpperBound(const void* address)
+{
+    size_t low = 0;
+    size_t high = g_DeviceCount;
+
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if ((uintptr_t)g_Devices[middle]->data <= (uintptr_t)address)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
 static CODEFIRST_RESULT buildStructTypes(SCHEMA_HANDLE schemaHandle, const REFLECTED_DATA_FROM_DATAPROVIDER* reflectedData)
 {
     CODEFIRST_RESULT result = CODEFIRST_OK;
@@ -926,9 +1074,20 @@ void* CodeFirst_CreateDevice(SCHEMA_MODEL_TYPE_HANDLE model, const REFLECTED_DAT
                     result = NULL;
                     LogError(" %s ", ENUM_TO_STRING(CODEFIRST_RESULT, CODEFIRST_DEVICE_FAILED));
                 }
+                else if ((deviceHeader->PropertyIndex = AcquireModelPropertyIndex(model, metadata)) == NULL)
+                {
+                    Device_Destroy(deviceHeader->DeviceHandle);
+                    free(deviceHeader->data);
+                    free(deviceHeader);
+
+                    /* Codes_SRS_CODEFIRST_99_102:[On any other errors, Device_Create shall return NULL.] */
+                    result = NULL;
+                    LogError(" %s ", ENUM_TO_STRING(CODEFIRST_RESULT, CODEFIRST_ERROR));
+                }
                 else if ((newDevices = (DEVICE_HEADER_DATA**)realloc(g_Devices, sizeof(DEVICE_HEADER_DATA*) * (g_DeviceCount + 1))) == NULL)
                 {
                     Device_Destroy(deviceHeader->DeviceHandle);
+                    ReleaseModelPropertyIndex(deviceHeader->PropertyIndex);
                     free(deviceHeader->data);
                     free(deviceHeader);
 
@@ -939,6 +1098,7 @@ void* CodeFirst_CreateDevice(SCHEMA_MODEL_TYPE_HANDLE model, const REFLECTED_DAT
                 else
                 {
                     SCHEMA_RESULT schemaResult;
+                    g_Devices = newDevices;
                     deviceHeader->ReflectedData = metadata;
                     deviceHeader->DataSize = dataSize;
                     deviceHeader->ModelHandle = model;
@@ -946,6 +1106,7 @@ void* CodeFirst_CreateDevice(SCHEMA_MODEL_TYPE_HANDLE model, const REFLECTED_DAT
                     if (schemaResult != SCHEMA_OK)
                     {
                         Device_Destroy(deviceHeader->DeviceHandle);
+                        ReleaseModelPropertyIndex(deviceHeader->PropertyIndex);
                         free(deviceHeader->data);
                         free(deviceHeader);
 
@@ -954,8 +1115,10 @@ void* CodeFirst_CreateDevice(SCHEMA_MODEL_TYPE_HANDLE model, const REFLECTED_DAT
                     }
                     else
                     {
-                        g_Devices = newDevices;
-                        g_Devices[g_DeviceCount] = deviceHeader;
+                        /*keep the devices sorted by address so FindDevice can do a binary search*/
+                        size_t position = GetDeviceUpperBound(deviceHeader->data);
+                        (void)memmove(&g_Devices[position + 1], &g_Devices[position], (g_DeviceCount - position) * sizeof(DEVICE_HEADER_DATA*));
+                        g_Devices[position] = deviceHeader;
                         g_DeviceCount++;
 
                         /* Codes_SRS_CODEFIRST_99_101:[On success, CodeFirst_CreateDevice shall return a non NULL pointer to the device data.] */
@@ -975,23 +1138,21 @@ void CodeFirst_DestroyDevice(void* device)
     /* Codes_SRS_CODEFIRST_99_086:[If the argument is NULL, CodeFirst_DestroyDevice shall do nothing.] */
     if (device != NULL)
     {
-        size_t i;
+        size_t position = GetDeviceUpperBound(device);
 
-        for (i = 0; i < g_DeviceCount; i++)
+        if ((position > 0) && (g_Devices[position - 1]->data == device))
         {
-            if (g_Devices[i]->data == device)
-            {
-                deinitializeDesiredProperties(g_Devices[i]->ModelHandle, g_Devices[i]->data);
-                Schema_ReleaseDeviceRef(g_Devices[i]->ModelHandle);
+            size_t i = position - 1;
 
-                // Delete the Created Schema if all the devices are unassociated
-                Schema_DestroyIfUnused(g_Devices[i]->ModelHandle);
+            deinitializeDesiredProperties(g_Devices[i]->ModelHandle, g_Devices[i]->data);
+            Schema_ReleaseDeviceRef(g_Devices[i]->ModelHandle);
 
-                DestroyDevice(g_Devices[i]);
-                (void)memcpy(&g_Devices[i], &g_Devices[i + 1], (g_DeviceCount - i - 1) * sizeof(DEVICE_HEADER_DATA*));
-                g_DeviceCount--;
-                break;
-            }
+            // Delete the Created Schema if all the devices are unassociated
+            Schema_DestroyIfUnused(g_Devices[i]->ModelHandle);
+
+            DestroyDevice(g_Devices[i]);
+            (void)memmove(&g_Devices[i], &g_Devices[i + 1], (g_DeviceCount - i - 1) * sizeof(DEVICE_HEADER_DATA*));
+            g_DeviceCount--;
         }
 
         /*Codes_SRS_CODEFIRST_02_039: [ If the current device count is zero then CodeFirst_DestroyDevice shall deallocate all other used resources. ]*/
@@ -1006,96 +1167,250 @@ void CodeFirst_DestroyDevice(void* device)
 
 static DEVICE_HEADER_DATA* FindDevice(void* value)
 {
-    size_t i;
     DEVICE_HEADER_DATA* result = NULL;
 
-    for (i = 0; i < g_DeviceCount; i++)
+    /*the device data blocks do not overlap, so the only candidate is the last device starting at or before value*/
+    size_t position = GetDeviceUpperBound(value);
+    if (position > 0)
     {
-        if ((g_Devices[i]->data <= (unsigned char*)value) &&
-            (g_Devices[i]->data + g_Devices[i]->DataSize > (unsigned char*)value))
+        DEVICE_HEADER_DATA* candidate = g_Devices[position - 1];
+        if ((uintptr_t)value < (uintptr_t)(candidate->data + candidate->DataSize))
         {
-            result = g_Devices[i];
-            break;
+            result = candidate;
         }
     }
 
     return result;
 }
 
-static const REFLECTED_SOMETHING* FindValue(DEVICE_HEADER_DATA* deviceHeader, void* value, const char* modelName, size_t startOffset, STRING_HANDLE valuePath)
+/*REFLECTION_PROPERTY and REFLECTION_REPORTED_PROPERTY describe where they live in the device data in the same way*/
+static bool GetPropertyLayout(const REFLECTED_SOMETHING* something, REFLECTION_TYPE propertyType, const char* modelName, const char** name, const char** type, size_t* offset)
 {
-    const REFLECTED_SOMETHING* result;
-    size_t valueOffset = (size_t)((unsigned char*)value - (unsigned char*)deviceHeader->data) - startOffset;
+    bool result;
+
+    if ((something->type == REFLECTION_PROPERTY_TYPE) &&
+        (propertyType == REFLECTION_PROPERTY_TYPE) &&
+        (strcmp(something->what.property.modelName, modelName) == 0))
+    {
+        *name = something->what.property.name;
+        *type = something->what.property.type;
+        *offset = something->what.property.offset;
+        result = true;
+    }
+    else if ((something->type == REFLECTION_REPORTED_PROPERTY_TYPE) &&
+        (propertyType == REFLECTION_REPORTED_PROPERTY_TYPE) &&
+        (strcmp(something->what.reportedProperty.modelName, modelName) == 0))
+    {
+        *name = something->what.reportedProperty.name;
+        *type = something->what.reportedProperty.type;
+        *offset = something->what.reportedProperty.offset;
+        result = true;
+    }
+    else
+    {
+        result = false;
+    }
 
-    for (result = deviceHeader->ReflectedData->reflectedData; result != NULL; result = result->next)
+    return result;
+}
+
+static int AddPropertyPathEntries(PROPERTY_PATH_TABLE* table, size_t* capacity, const REFLECTED_SOMETHING* reflectedData, REFLECTION_TYPE propertyType, const char* modelName, size_t startOffset, const char* pathPrefix, size_t depth)
+{
+    int result = 0;
+    const REFLECTED_SOMETHING* something;
+
+    for (something = reflectedData; (result == 0) && (something != NULL); something = something->next)
     {
-        if (result->type == REFLECTION_PROPERTY_TYPE &&
-            (strcmp(result->what.property.modelName, modelName) == 0) &&
-            (result->what.property.offset <= valueOffset) &&
-            (result->what.property.offset + result->what.property.size > valueOffset))
+        const char* name;
+        const char* type;
+        size_t offset;
+
+        if (GetPropertyLayout(something, propertyType, modelName, &name, &type, &offset))
         {
-            if (startOffset != 0)
+            size_t prefixLength = (pathPrefix == NULL) ? 0 : strlen(pathPrefix);
+            size_t nameLength = strlen(name);
+            char* path;
+
+            if ((path = (char*)malloc(prefixLength + 1 + nameLength + 1)) == NULL)
             {
-                STRING_concat(valuePath, "/");
+                LogError("unable to allocate memory for the property path");
+                result = __FAILURE__;
             }
+            else
+            {
+                if (pathPrefix == NULL)
+                {
+                    (void)memcpy(path, name, nameLength + 1);
+                }
+                else
+                {
+                    (void)memcpy(path, pathPrefix, prefixLength);
+                    path[prefixLength] = '/';
+                    (void)memcpy(path + prefixLength + 1, name, nameLength + 1);
+                }
 
-            STRING_concat(valuePath, result->what.property.name);
-            break;
+                if (table->count == *capacity)
+                {
+                    size_t newCapacity = (*capacity == 0) ? 8 : (*capacity * 2);
+                    PROPERTY_PATH_ENTRY* newEntries = (PROPERTY_PATH_ENTRY*)realloc(table->entries, newCapacity * sizeof(PROPERTY_PATH_ENTRY));
+                    if (newEntries == NULL)
+                    {
+                        LogError("unable to grow the property path table");
+                        free(path);
+                        path = NULL;
+                        result = __FAILURE__;
+                    }
+                    else
+                    {
+                        table->entries = newEntries;
+                        *capacity = newCapacity;
+                    }
+                }
+
+                if (path != NULL)
+                {
+                    table->entries[table->count].offset = startOffset + offset;
+                    table->entries[table->count].depth = depth;
+                    table->entries[table->count].property = something;
+                    table->entries[table->count].path = path;
+                    table->count++;
+
+                    /* Codes_SRS_CODEFIRST_99_133:[CodeFirst_SendAsync shall allow sending of properties that are part of a child model.] */
+                    /*when type is not a model nothing matches it and the recursion stops right away*/
+                    result = AddPropertyPathEntries(table, capacity, reflectedData, propertyType, type, startOffset + offset, path, depth + 1);
+                }
+            }
         }
     }
 
-    if (result != NULL)
+    return result;
+}
+
+static int ComparePropertyPathEntries(const void* left, const void* right)
+{
+    const PROPERTY_PATH_ENTRY* leftEntry = (const PROPERTY_PATH_ENTRY*)left;
+    const PROPERTY_PATH_ENTRY* rightEntry = (const PROPERTY_PATH_ENTRY*)right;
+    int result;
+
+    if (leftEntry->offset != rightEntry->offset)
     {
-        /* Codes_SRS_CODEFIRST_99_133:[CodeFirst_SendAsync shall allow sending of properties that are part of a child model.] */
-        if (result->what.property.offset < valueOffset)
-        {
-            /* find recursively the property in the inner model, if there is one */
-            result = FindValue(deviceHeader, value, result->what.property.type, startOffset + result->what.property.offset, valuePath);
-        }
+        result = (leftEntry->offset < rightEntry->offset) ? -1 : 1;
+    }
+    else if (leftEntry->depth != rightEntry->depth)
+    {
+        result = (leftEntry->depth < rightEntry->depth) ? -1 : 1;
+    }
+    else
+    {
+        result = 0;
     }
 
     return result;
 }
 
-static const REFLECTED_SOMETHING* FindReportedProperty(DEVICE_HEADER_DATA* deviceHeader, void* value, const char* modelName, size_t startOffset, STRING_HANDLE valuePath)
+static int BuildPropertyPathTable(PROPERTY_PATH_TABLE* table, const REFLECTED_SOMETHING* reflectedData, REFLECTION_TYPE propertyType, const char* modelName)
 {
-    const REFLECTED_SOMETHING* result;
-    size_t valueOffset = (size_t)((unsigned char*)value - (unsigned char*)deviceHeader->data) - startOffset;
+    int result;
+    size_t capacity = 0;
 
-    for (result = deviceHeader->ReflectedData->reflectedData; result != NULL; result = result->next)
+    if (AddPropertyPathEntries(table, &capacity, reflectedData, propertyType, modelName, 0, NULL, 0) != 0)
+    {
+        DestroyPropertyPathTable(table);
+        result = __FAILURE__;
+    }
+    else
     {
-        if (result->type == REFLECTION_REPORTED_PROPERTY_TYPE &&
-            (strcmp(result->what.reportedProperty.modelName, modelName) == 0) &&
-            (result->what.reportedProperty.offset <= valueOffset) &&
-            (result->what.reportedProperty.offset + result->what.reportedProperty.size > valueOffset))
+        size_t i;
+        size_t kept = 0;
+
+        /*a child model and its first property start at the same offset. A pointer to that offset
+        designates the child model itself, so only the shallowest entry of every offset is kept*/
+        qsort(table->entries, table->count, sizeof(PROPERTY_PATH_ENTRY), ComparePropertyPathEntries);
+        for (i = 0; i < table->count; i++)
         {
-            if (startOffset != 0)
+            if ((kept > 0) && (table->entries[kept - 1].offset == table->entries[i].offset))
             {
-                if (STRING_concat(valuePath, "/") != 0)
-                {
-                    LogError("unable to STRING_concat");
-                    result = NULL;
-                    break;
-                }
+                free(table->entries[i].path);
             }
-
-            if (STRING_concat(valuePath, result->what.reportedProperty.name) != 0)
+            else
             {
-                LogError("unable to STRING_concat");
-                result = NULL;
-                break;
+                table->entries[kept] = table->entries[i];
+                kept++;
             }
-            break;
         }
+        table->count = kept;
+        result = 0;
     }
 
-    if (result != NULL)
+    return result;
+}
+
+/*builds the tables of propertyIndex for modelName, unless they are already built*/
+static int EnsureModelPropertyIndex(MODEL_PROPERTY_INDEX* propertyIndex, const char* modelName)
+{
+    int result;
+
+    if ((propertyIndex->ModelName != NULL) &&
+        (strcmp(propertyIndex->ModelName, modelName) == 0))
+    {
+        result = 0;
+    }
+    else
+    {
+        DestroyPropertyPathTable(&propertyIndex->Properties);
+        DestroyPropertyPathTable(&propertyIndex->ReportedProperties);
+        free(propertyIndex->ModelName);
+        propertyIndex->ModelName = NULL;
+
+        if (BuildPropertyPathTable(&propertyIndex->Properties, propertyIndex->ReflectedData->reflectedData, REFLECTION_PROPERTY_TYPE, modelName) != 0)
+        {
+            LogError("unable to build the property table of model %s", modelName);
+            result = __FAILURE__;
+        }
+        else if (BuildPropertyPathTable(&propertyIndex->ReportedProperties, propertyIndex->ReflectedData->reflectedData, REFLECTION_REPORTED_PROPERTY_TYPE, modelName) != 0)
+        {
+            LogError("unable to build the reported property table of model %s", modelName);
+            DestroyPropertyPathTable(&propertyIndex->Properties);
+            result = __FAILURE__;
+        }
+        else if (mallocAndStrcpy_s(&propertyIndex->ModelName, modelName) != 0)
+        {
+            LogError("unable to copy the model name");
+            DestroyPropertyPathTable(&propertyIndex->Properties);
+            DestroyPropertyPathTable(&propertyIndex->ReportedProperties);
+            propertyIndex->ModelName = NULL;
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+static const PROPERTY_PATH_ENTRY* FindPropertyPathEntry(const PROPERTY_PATH_TABLE* table, size_t offset)
+{
+    const PROPERTY_PATH_ENTRY* result = NULL;
+    size_t low = 0;
+    size_t high = table->count;
+
+    while (low < high)
     {
-        /* Codes_SRS_CODEFIRST_99_133:[CodeFirst_SendAsync shall allow sending of properties that are part of a child model.] */
-        if (result->what.reportedProperty.offset < valueOffset)
+        size_t middle = low + (high - low) / 2;
+        if (table->entries[middle].offset == offset)
+        {
+            result = &table->entries[middle];
+            break;
+        }
+        else if (table->entries[middle].offset < offset)
         {
-            /* find recursively the property in the inner model, if there is one */
-            result = FindReportedProperty(deviceHeader, value, result->what.reportedProperty.type, startOffset + result->what.reportedProperty.offset, valuePath);
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
         }
     }
 
@@ -1265,70 +1580,58 @@ CODEFIRST_RESULT CodeFirst_SendAsync(unsigned char** destination, size_t* destin
                 }
                 else
                 {
-                    const REFLECTED_SOMETHING* propertyReflectedData;
+                    const PROPERTY_PATH_ENTRY* propertyEntry;
                     const char* modelName;
-                    STRING_HANDLE valuePath;
 
-                    if ((valuePath = STRING_new()) == NULL)
+                    if ((modelName = Schema_GetModelName(deviceHeader->ModelHandle)) == NULL)
+                    {
+                        /* Codes_SRS_CODEFIRST_99_134:[If CodeFirst_Notify fails for any other reason it shall return CODEFIRST_ERROR.] */
+                        result = CODEFIRST_ERROR;
+                        LOG_CODEFIRST_ERROR;
+                        break;
+                    }
+                    else if (EnsureModelPropertyIndex(deviceHeader->PropertyIndex, modelName) != 0)
                     {
                         /* Codes_SRS_CODEFIRST_99_134:[If CodeFirst_Notify fails for any other reason it shall return CODEFIRST_ERROR.] */
                         result = CODEFIRST_ERROR;
                         LOG_CODEFIRST_ERROR;
                         break;
                     }
+                    else if ((propertyEntry = FindPropertyPathEntry(&deviceHeader->PropertyIndex->Properties, (size_t)((unsigned char*)value - deviceHeader->data))) == NULL)
+                    {
+                        /* Codes_SRS_CODEFIRST_99_104:[If a property cannot be associated with a device, CodeFirst_SendAsync shall return CODEFIRST_INVALID_ARG.] */
+                        result = CODEFIRST_INVALID_ARG;
+                        LOG_CODEFIRST_ERROR;
+                        break;
+                    }
                     else
                     {
-                        if ((modelName = Schema_GetModelName(deviceHeader->ModelHandle)) == NULL)
-                        {
-                            /* Codes_SRS_CODEFIRST_99_134:[If CodeFirst_Notify fails for any other reason it shall return CODEFIRST_ERROR.] */
-                            result = CODEFIRST_ERROR;
-                            LOG_CODEFIRST_ERROR;
-                            STRING_delete(valuePath);
-                            break;
-                        }
-                        else if ((propertyReflectedData = FindValue(deviceHeader, value, modelName, 0, valuePath)) == NULL)
+                        AGENT_DATA_TYPE agentDataType;
+
+                        /* Codes_SRS_CODEFIRST_99_097:[For each value marshalling to AGENT_DATA_TYPE shall be performed.] */
+                        /* Codes_SRS_CODEFIRST_99_098:[The marshalling shall be done by calling the Create_AGENT_DATA_TYPE_from_Ptr function associated with the property.] */
+                        if (propertyEntry->property->what.property.Create_AGENT_DATA_TYPE_from_Ptr(value, &agentDataType) != AGENT_DATA_TYPES_OK)
                         {
-                            /* Codes_SRS_CODEFIRST_99_104:[If a property cannot be associated with a device, CodeFirst_SendAsync shall return CODEFIRST_INVALID_ARG.] */
-                            result = CODEFIRST_INVALID_ARG;
+                            /* Codes_SRS_CODEFIRST_99_099:[If Create_AGENT_DATA_TYPE_from_Ptr fails, CodeFirst_SendAsync shall return CODEFIRST_AGENT_DATA_TYPE_ERROR.] */
+                            result = CODEFIRST_AGENT_DATA_TYPE_ERROR;
                             LOG_CODEFIRST_ERROR;
-                            STRING_delete(valuePath);
                             break;
                         }
                         else
                         {
-                            AGENT_DATA_TYPE agentDataType;
-
-                            /* Codes_SRS_CODEFIRST_99_097:[For each value marshalling to AGENT_DATA_TYPE shall be performed.] */
-                            /* Codes_SRS_CODEFIRST_99_098:[The marshalling shall be done by calling the Create_AGENT_DATA_TYPE_from_Ptr function associated with the property.] */
-                            if (propertyReflectedData->what.property.Create_AGENT_DATA_TYPE_from_Ptr(value, &agentDataType) != AGENT_DATA_TYPES_OK)
+                            /* Codes_SRS_CODEFIRST_99_092:[CodeFirst shall publish each value by using Device_PublishTransacted.] */
+                            /* Codes_SRS_CODEFIRST_99_136:[CodeFirst_SendAsync shall build the full path for each property and then pass it to Device_PublishTransacted.] */
+                            if (Device_PublishTransacted(transaction, propertyEntry->path, &agentDataType) != DEVICE_OK)
                             {
-                                /* Codes_SRS_CODEFIRST_99_099:[If Create_AGENT_DATA_TYPE_from_Ptr fails, CodeFirst_SendAsync shall return CODEFIRST_AGENT_DATA_TYPE_ERROR.] */
-                                result = CODEFIRST_AGENT_DATA_TYPE_ERROR;
+                                Destroy_AGENT_DATA_TYPE(&agentDataType);
+
+                                /* Codes_SRS_CODEFIRST_99_094:[If any Device API fail, CodeFirst_SendAsync shall return CODEFIRST_DEVICE_PUBLISH_FAILED.] */
+                                result = CODEFIRST_DEVICE_PUBLISH_FAILED;
                                 LOG_CODEFIRST_ERROR;
-                                STRING_delete(valuePath);
                                 break;
                             }
-                            else
-                            {
-                                /* Codes_SRS_CODEFIRST_99_092:[CodeFirst shall publish each value by using Device_PublishTransacted.] */
-                                /* Codes_SRS_CODEFIRST_99_136:[CodeFirst_SendAsync shall build the full path for each property and then pass it to Device_PublishTransacted.] */
-                                if (Device_PublishTransacted(transaction, STRING_c_str(valuePath), &agentDataType) != DEVICE_OK)
-                                {
-                                    Destroy_AGENT_DATA_TYPE(&agentDataType);
 
-                                    /* Codes_SRS_CODEFIRST_99_094:[If any Device API fail, CodeFirst_SendAsync shall return CODEFIRST_DEVICE_PUBLISH_FAILED.] */
-                                    result = CODEFIRST_DEVICE_PUBLISH_FAILED;
-                                    LOG_CODEFIRST_ERROR;
-                                    STRING_delete(valuePath);
-                                    break;
-                                }
-                                else
-                                {
-                                    STRING_delete(valuePath); /*anyway*/
-                                }
-
-                                Destroy_AGENT_DATA_TYPE(&agentDataType);
-                            }
+                            Destroy_AGENT_DATA_TYPE(&agentDataType);
                         }
                     }
                 }
@@ -1435,56 +1738,44 @@ CODEFIRST_RESULT CodeFirst_SendAsyncReported(unsigned char** destination, size_t
                     else
                     {
                         /*Codes_SRS_CODEFIRST_02_020: [ If values passed through va_args are not all of type REFLECTED_REPORTED_PROPERTY then CodeFirst_SendAsyncReported shall fail and return CODEFIRST_INVALID_ARG. ]*/
-                        const REFLECTED_SOMETHING* propertyReflectedData;
-                        const char* modelName;
+                        const PROPERTY_PATH_ENTRY* propertyEntry;
+                        const char* modelName = Schema_GetModelName(deviceHeader->ModelHandle);
 
-                        STRING_HANDLE valuePath;
-                        if ((valuePath = STRING_new()) == NULL)
+                        if ((modelName == NULL) ||
+                            (EnsureModelPropertyIndex(deviceHeader->PropertyIndex, modelName) != 0))
                         {
                             result = CODEFIRST_ERROR;
                             LOG_CODEFIRST_ERROR;
                             break;
                         }
+                        /*Codes_SRS_CODEFIRST_02_025: [ CodeFirst_SendAsyncReported shall compute for every AGENT_DATA_TYPE the valuePath. ]*/
+                        else if ((propertyEntry = FindPropertyPathEntry(&deviceHeader->PropertyIndex->ReportedProperties, (size_t)((unsigned char*)value - deviceHeader->data))) == NULL)
+                        {
+                            result = CODEFIRST_INVALID_ARG;
+                            LOG_CODEFIRST_ERROR;
+                            break;
+                        }
                         else
                         {
-                            modelName = Schema_GetModelName(deviceHeader->ModelHandle);
-
-                            /*Codes_SRS_CODEFIRST_02_025: [ CodeFirst_SendAsyncReported shall compute for every AGENT_DATA_TYPE the valuePath. ]*/
-                            if ((propertyReflectedData = FindReportedProperty(deviceHeader, value, modelName, 0, valuePath)) == NULL)
+                            AGENT_DATA_TYPE agentDataType;
+                            /*Codes_SRS_CODEFIRST_02_023: [ CodeFirst_SendAsyncReported shall convert all REPORTED_PROPERTY model components to AGENT_DATA_TYPE. ]*/
+                            if (propertyEntry->property->what.reportedProperty.Create_AGENT_DATA_TYPE_from_Ptr(value, &agentDataType) != AGENT_DATA_TYPES_OK)
                             {
-                                result = CODEFIRST_INVALID_ARG;
+                                result = CODEFIRST_AGENT_DATA_TYPE_ERROR;
                                 LOG_CODEFIRST_ERROR;
-                                STRING_delete(valuePath);
                                 break;
                             }
                             else
                             {
-                                AGENT_DATA_TYPE agentDataType;
-                                /*Codes_SRS_CODEFIRST_02_023: [ CodeFirst_SendAsyncReported shall convert all REPORTED_PROPERTY model components to AGENT_DATA_TYPE. ]*/
-                                if (propertyReflectedData->what.reportedProperty.Create_AGENT_DATA_TYPE_from_Ptr(value, &agentDataType) != AGENT_DATA_TYPES_OK)
+                                /*Codes_SRS_CODEFIRST_02_024: [ CodeFirst_SendAsyncReported shall call Device_PublishTransacted_ReportedProperty for every AGENT_DATA_TYPE converted from REPORTED_PROPERTY. ]*/
+                                if (Device_PublishTransacted_ReportedProperty(transaction, propertyEntry->path, &agentDataType) != DEVICE_OK)
                                 {
-                                    result = CODEFIRST_AGENT_DATA_TYPE_ERROR;
+                                    Destroy_AGENT_DATA_TYPE(&agentDataType);
+                                    result = CODEFIRST_DEVICE_PUBLISH_FAILED;
                                     LOG_CODEFIRST_ERROR;
-                                    STRING_delete(valuePath);
                                     break;
                                 }
-                                else
-                                {
-                                    /*Codes_SRS_CODEFIRST_02_024: [ CodeFirst_SendAsyncReported shall call Device_PublishTransacted_ReportedProperty for every AGENT_DATA_TYPE converted from REPORTED_PROPERTY. ]*/
-                                    if (Device_PublishTransacted_ReportedProperty(transaction, STRING_c_str(valuePath), &agentDataType) != DEVICE_OK)
-                                    {
-                                        Destroy_AGENT_DATA_TYPE(&agentDataType);
-                                        result = CODEFIRST_DEVICE_PUBLISH_FAILED;
-                                        LOG_CODEFIRST_ERROR;
-                                        STRING_delete(valuePath);
-                                        break;
-                                    }
-                                    else
-                                    {
-                                        STRING_delete(valuePath);
-                                    }
-                                    Destroy_AGENT_DATA_TYPE(&agentDataType);
-                                }
+                                Destroy_AGENT_DATA_TYPE(&agentDataType);
                             }
                         }
                     }
@@ -14,6 +14,7 @@
 #include "schema.h"
 #include "codefirst.h"
 #include "jsondecoder.h"
+#include "cbordecoder.h"
 
 DEFINE_ENUM_STRINGS(COMMANDDECODER_RESULT, COMMANDDECODER_RESULT_VALUES);
 
@@ -1036,3 +1037,115 @@ EXECUTE_COMMAND_RESULT CommandDecoder_IngestDesiredProperties(void* startAddress
     }
     return result;
 }
+
+EXECUTE_COMMAND_RESULT CommandDecoder_ExecuteCommandCBOR(COMMAND_DECODER_HANDLE handle, const unsigned char* command, size_t size)
+{
+    EXECUTE_COMMAND_RESULT result;
+
+    if ((handle == NULL) ||
+        (command == NULL) ||
+        (size == 0))
+    {
+        LogError("Invalid argument, COMMAND_DECODER_HANDLE handle=%p, const unsigned char* command=%p, size_t size=%lu", handle, command, (unsigned long)size);
+        result = EXECUTE_COMMAND_ERROR;
+    }
+    else
+    {
+        MULTITREE_HANDLE commandsTree;
+
+        /*commands are not keyed by schema ids, the command name is a value*/
+        if (CBORDecoder_CBOR_To_MultiTree(command, size, NULL, &commandsTree) != CBOR_DECODER_OK)
+        {
+            LogError("Decoding CBOR to a multi tree failed");
+            result = EXECUTE_COMMAND_ERROR;
+        }
+        else
+        {
+            result = DecodeCommand((COMMAND_DECODER_HANDLE_DATA*)handle, commandsTree);
+            MultiTree_Destroy(commandsTree);
+        }
+    }
+    return result;
+}
+
+METHODRETURN_HANDLE CommandDecoder_ExecuteMethodCBOR(COMMAND_DECODER_HANDLE handle, const char* fullMethodName, const unsigned char* methodPayload, size_t size)
+{
+    METHODRETURN_HANDLE result;
+
+    if ((handle == NULL) ||
+        (fullMethodName == NULL) ||
+        ((methodPayload == NULL) && (size != 0)))
+    {
+        LogError("Invalid argument, COMMAND_DECODER_HANDLE handle=%p, const char* fullMethodName=%p", handle, fullMethodName);
+        result = NULL;
+    }
+    else
+    {
+        COMMAND_DECODER_HANDLE_DATA* commandDecoderInstance = (COMMAND_DECODER_HANDLE_DATA*)handle;
+        if (commandDecoderInstance->methodCallback == NULL)
+        {
+            LogError("unable to execute a method when the methodCallback passed in CommandDecoder_Create is NULL");
+            result = NULL;
+        }
+        else if (size == 0)
+        {
+            result = DecodeMethod(commandDecoderInstance, fullMethodName, NULL);
+        }
+        else
+        {
+            MULTITREE_HANDLE methodTree;
+            if (CBORDecoder_CBOR_To_MultiTree(methodPayload, size, NULL, &methodTree) != CBOR_DECODER_OK)
+            {
+                LogError("Decoding CBOR to a multi tree failed");
+                result = NULL;
+            }
+            else
+            {
+                result = DecodeMethod(commandDecoderInstance, fullMethodName, methodTree);
+                MultiTree_Destroy(methodTree);
+            }
+        }
+    }
+    return result;
+}
+
+EXECUTE_COMMAND_RESULT CommandDecoder_IngestDesiredPropertiesCBOR(void* startAddress, COMMAND_DECODER_HANDLE handle, const unsigned char* cborPayload, size_t size, bool parseDesiredNode)
+{
+    EXECUTE_COMMAND_RESULT result;
+
+    if ((startAddress == NULL) ||
+        (handle == NULL) ||
+        (cborPayload == NULL) ||
+        (size == 0))
+    {
+        LogError("invalid argument COMMAND_DECODER_HANDLE handle=%p, const unsigned char* cborPayload=%p", handle, cborPayload);
+        result = EXECUTE_COMMAND_ERROR;
+    }
+    else
+    {
+        COMMAND_DECODER_HANDLE_DATA* commandDecoderInstance = (COMMAND_DECODER_HANDLE_DATA*)handle;
+        MULTITREE_HANDLE initialParsedTree;
+        MULTITREE_HANDLE desiredPropertiesTree;
+
+        /*desired properties can be keyed by the ids the model gives to their paths*/
+        if (CBORDecoder_CBOR_To_MultiTree(cborPayload, size, commandDecoderInstance->ModelHandle, &initialParsedTree) != CBOR_DECODER_OK)
+        {
+            LogError("Decoding CBOR to a multi tree failed");
+            result = EXECUTE_COMMAND_ERROR;
+        }
+        else
+        {
+            if (RemoveUnneededTwinProperties(initialParsedTree, parseDesiredNode, &desiredPropertiesTree) == false)
+            {
+                LogError("Removing unneeded twin properties failed");
+                result = EXECUTE_COMMAND_ERROR;
+            }
+            else
+            {
+                result = DecodeDesiredProperties(startAddress, commandDecoderInstance, desiredPropertiesTree);
+            }
+            MultiTree_Destroy(initialParsedTree);
+        }
+    }
+    return result;
+}
@@ -9,6 +9,7 @@
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "schema.h"
 #include "jsonencoder.h"
+#include "cborencoder.h"
 #include "agenttypesystem.h"
 #include "azure_c_shared_utility/xlogging.h"
 #include "parson.h"
@@ -23,8 +24,11 @@ typedef struct DATA_MARSHALLER_HANDLE_DATA_TAG
 {
     SCHEMA_MODEL_TYPE_HANDLE ModelHandle;
     bool IncludePropertyPath;
+    PAYLOAD_ENCODING Encoding;
 } DATA_MARSHALLER_HANDLE_DATA;
 
+static PAYLOAD_ENCODING defaultEncoding_ = PAYLOAD_ENCODING_JSON;
+
 static int NoCloneFunction(void** destination, const void* source)
 {
     *destination = (void*)source;
@@ -58,7 +62,70 @@ DATA_MARSHALLER_HANDLE DataMarshaller_Create(SCHEMA_MODEL_TYPE_HANDLE modelHandl
         /*Codes_SRS_DATA_MARSHALLER_99_018:[ DataMarshaller_Create shall create a new DataMarshaller instance and on success it shall return a non NULL handle.]*/
         result->ModelHandle = modelHandle;
         result->IncludePropertyPath = includePropertyPath;
+        result->Encoding = defaultEncoding_;
+    }
+    return result;
+}
+
+void DataMarshaller_SetDefaultEncoding(PAYLOAD_ENCODING encoding)
+{
+    defaultEncoding_ = encoding;
+}
+
+PAYLOAD_ENCODING DataMarshaller_GetDefaultEncoding(void)
+{
+    return defaultEncoding_;
+}
+
+/*with key ids every value is keyed by the schema id of its full property path, the paths the schema does not know are written as text*/
+static void SetKeyedValue(SCHEMA_MODEL_TYPE_HANDLE modelHandle, CBOR_ENCODER_KEYED_VALUE* keyedValue, const DATA_MARSHALLER_VALUE* value)
+{
+    if (Schema_GetModelPathId(modelHandle, value->PropertyPath, &keyedValue->keyId) != SCHEMA_OK)
+    {
+        keyedValue->keyId = CBOR_ENCODER_NO_KEY_ID;
+    }
+    keyedValue->keyName = value->PropertyPath;
+    keyedValue->value = value->Value;
+}
+
+static DATA_MARSHALLER_RESULT EncodeKeyedValues(size_t valueCount, const CBOR_ENCODER_KEYED_VALUE* keyedValues, unsigned char** destination, size_t* destinationSize)
+{
+    DATA_MARSHALLER_RESULT result;
+
+    if (CBOREncoder_EncodeKeyedValues(valueCount, keyedValues, destination, destinationSize) != CBOR_ENCODER_OK)
+    {
+        result = DATA_MARSHALLER_CBOR_ENCODER_ERROR;
+        LOG_DATA_MARSHALLER_ERROR
+    }
+    else
+    {
+        result = DATA_MARSHALLER_OK;
     }
+
+    return result;
+}
+
+static DATA_MARSHALLER_RESULT SendData_KeyIds(DATA_MARSHALLER_HANDLE_DATA* dataMarshallerInstance, size_t valueCount, const DATA_MARSHALLER_VALUE* values, unsigned char** destination, size_t* destinationSize)
+{
+    DATA_MARSHALLER_RESULT result;
+    CBOR_ENCODER_KEYED_VALUE* keyedValues = (CBOR_ENCODER_KEYED_VALUE*)malloc(valueCount * sizeof(CBOR_ENCODER_KEYED_VALUE));
+
+    if (keyedValues == NULL)
+    {
+        result = DATA_MARSHALLER_ERROR;
+        LOG_DATA_MARSHALLER_ERROR
+    }
+    else
+    {
+        size_t i;
+        for (i = 0; i < valueCount; i++)
+        {
+            SetKeyedValue(dataMarshallerInstance->ModelHandle, &keyedValues[i], &values[i]);
+        }
+        result = EncodeKeyedValues(valueCount, keyedValues, destination, destinationSize);
+        free(keyedValues);
+    }
+
     return result;
 }
 
@@ -118,7 +185,16 @@ DATA_MARSHALLER_RESULT DataMarshaller_SendData(DATA_MARSHALLER_HANDLE dataMarsha
             }
         }
 
-        if (i == valueCount)
+        if (i < valueCount)
+        {
+            /*result already set*/
+        }
+        else if (dataMarshallerInstance->Encoding == PAYLOAD_ENCODING_CBOR_WITH_KEY_IDS)
+        {
+            /*one flat map, the struct at root case does not apply since the key ids are those of full paths*/
+            result = SendData_KeyIds(dataMarshallerInstance, valueCount, values, destination, destinationSize);
+        }
+        else
         {
             /* Codes_SRS_DATA_MARSHALLER_99_037:[DataMarshaller shall store as MultiTree the data to be encoded by the JSONEncoder module.] */
             if ((treeHandle = MultiTree_Create(NoCloneFunction, NoFreeFunction)) == NULL)
@@ -170,7 +246,23 @@ DATA_MARSHALLER_RESULT DataMarshaller_SendData(DATA_MARSHALLER_HANDLE dataMarsha
 
                 }
 
-                if (j == valueCount)
+                if (j < valueCount)
+                {
+                    /*result already set*/
+                }
+                else if (dataMarshallerInstance->Encoding == PAYLOAD_ENCODING_CBOR)
+                {
+                    if (CBOREncoder_EncodeTree(treeHandle, destination, destinationSize) != CBOR_ENCODER_OK)
+                    {
+                        result = DATA_MARSHALLER_CBOR_ENCODER_ERROR;
+                        LOG_DATA_MARSHALLER_ERROR
+                    }
+                    else
+                    {
+                        result = DATA_MARSHALLER_OK;
+                    }
+                }
+                else
                 {
                     STRING_HANDLE payload = STRING_new();
                     if (payload == NULL)
@@ -207,7 +299,7 @@ DATA_MARSHALLER_RESULT DataMarshaller_SendData(DATA_MARSHALLER_HANDLE dataMarsha
                         }
                         STRING_delete(payload);
                     }
-                } /* if (j==valueCount)*/
+                }
                 MultiTree_Destroy(treeHandle);
             } /* MultiTree_Create */
         }
@@ -216,6 +308,65 @@ DATA_MARSHALLER_RESULT DataMarshaller_SendData(DATA_MARSHALLER_HANDLE dataMarsha
     return result;
 }
 
+/*reported properties are always sent with their complete path, so they are either keyed by id or placed in the tree by path*/
+static DATA_MARSHALLER_RESULT SendData_ReportedProperties_CBOR(DATA_MARSHALLER_HANDLE_DATA* dataMarshallerInstance, VECTOR_HANDLE values, unsigned char** destination, size_t* destinationSize)
+{
+    DATA_MARSHALLER_RESULT result;
+    size_t nReportedProperties = VECTOR_size(values);
+    size_t i;
+
+    if (dataMarshallerInstance->Encoding == PAYLOAD_ENCODING_CBOR_WITH_KEY_IDS)
+    {
+        CBOR_ENCODER_KEYED_VALUE* keyedValues = (CBOR_ENCODER_KEYED_VALUE*)malloc((nReportedProperties == 0 ? 1 : nReportedProperties) * sizeof(CBOR_ENCODER_KEYED_VALUE));
+        if (keyedValues == NULL)
+        {
+            result = DATA_MARSHALLER_ERROR;
+            LOG_DATA_MARSHALLER_ERROR
+        }
+        else
+        {
+            for (i = 0; i < nReportedProperties; i++)
+            {
+                SetKeyedValue(dataMarshallerInstance->ModelHandle, &keyedValues[i], *(DATA_MARSHALLER_VALUE**)VECTOR_element(values, i));
+            }
+            result = EncodeKeyedValues(nReportedProperties, keyedValues, destination, destinationSize);
+            free(keyedValues);
+        }
+    }
+    else
+    {
+        MULTITREE_HANDLE treeHandle = MultiTree_Create(NoCloneFunction, NoFreeFunction);
+        if (treeHandle == NULL)
+        {
+            result = DATA_MARSHALLER_MULTITREE_ERROR;
+            LOG_DATA_MARSHALLER_ERROR
+        }
+        else
+        {
+            result = DATA_MARSHALLER_OK;
+            for (i = 0; i < nReportedProperties; i++)
+            {
+                DATA_MARSHALLER_VALUE* v = *(DATA_MARSHALLER_VALUE**)VECTOR_element(values, i);
+                if (MultiTree_AddLeaf(treeHandle, v->PropertyPath, (void*)v->Value) != MULTITREE_OK)
+                {
+                    result = DATA_MARSHALLER_MULTITREE_ERROR;
+                    LOG_DATA_MARSHALLER_ERROR
+                    break;
+                }
+            }
+
+            if ((result == DATA_MARSHALLER_OK) &&
+                (CBOREncoder_EncodeTree(treeHandle, destination, destinationSize) != CBOR_ENCODER_OK))
+            {
+                result = DATA_MARSHALLER_CBOR_ENCODER_ERROR;
+                LOG_DATA_MARSHALLER_ERROR
+            }
+            MultiTree_Destroy(treeHandle);
+        }
+    }
+
+    return result;
+}
 
 DATA_MARSHALLER_RESULT DataMarshaller_SendData_ReportedProperties(DATA_MARSHALLER_HANDLE dataMarshallerHandle, VECTOR_HANDLE values, unsigned char** destination, size_t* destinationSize)
 {
@@ -238,6 +389,10 @@ DATA_MARSHALLER_RESULT DataMarshaller_SendData_ReportedProperties(DATA_MARSHALLE
             destinationSize);
         result = DATA_MARSHALLER_INVALID_ARG;
     }
+    else if (((DATA_MARSHALLER_HANDLE_DATA*)dataMarshallerHandle)->Encoding != PAYLOAD_ENCODING_JSON)
+    {
+        result = SendData_ReportedProperties_CBOR((DATA_MARSHALLER_HANDLE_DATA*)dataMarshallerHandle, values, destination, destinationSize);
+    }
     else
     {
         /*Codes_SRS_DATA_MARSHALLER_02_012: [ DataMarshaller_SendData_ReportedProperties shall create an empty JSON_Value. ]*/
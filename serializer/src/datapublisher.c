@@ -24,19 +24,30 @@ DEFINE_ENUM_STRINGS(DATA_PUBLISHER_RESULT, DATA_PUBLISHER_RESULT_VALUES)
 /* Codes_SRS_DATA_PUBLISHER_99_067:[ Before any call to DataPublisher_SetMaxBufferSize, the default max buffer size shall be equal to 10KB.] */
 static size_t maxBufferSize_ = DEFAULT_MAX_BUFFER_SIZE;
 
-typedef struct DATA_PUBLISHER_HANDLE_DATA_TAG
-{
-    DATA_MARSHALLER_HANDLE DataMarshallerHandle;
-    SCHEMA_MODEL_TYPE_HANDLE ModelHandle;
-} DATA_PUBLISHER_HANDLE_DATA;
+/*how many finished transactions a DataPublisher instance keeps around for the next DataPublisher_StartTransaction*/
+#define TRANSACTION_POOL_SIZE 4
+#define INITIAL_TRANSACTION_VALUE_CAPACITY 4
 
 typedef struct TRANSACTION_HANDLE_DATA_TAG
 {
-    DATA_PUBLISHER_HANDLE_DATA* DataPublisherInstance;
+    struct DATA_PUBLISHER_HANDLE_DATA_TAG* DataPublisherInstance;
     size_t ValueCount;
+    size_t ValueCapacity;
     DATA_MARSHALLER_VALUE* Values;
+    AGENT_DATA_TYPE* AgentValues; /*Values[i].Value points to AgentValues[i]*/
+    size_t* PropertyIds; /*PropertyIds[i] is the schema path id of Values[i].PropertyPath*/
+    struct TRANSACTION_HANDLE_DATA_TAG* NextInPool;
 } TRANSACTION_HANDLE_DATA;
 
+/*not locked, see DataPublisher_Create: the transaction pool belongs to the one thread using the instance*/
+typedef struct DATA_PUBLISHER_HANDLE_DATA_TAG
+{
+    DATA_MARSHALLER_HANDLE DataMarshallerHandle;
+    SCHEMA_MODEL_TYPE_HANDLE ModelHandle;
+    TRANSACTION_HANDLE_DATA* TransactionPool;
+    size_t TransactionPoolCount;
+} DATA_PUBLISHER_HANDLE_DATA;
+
 typedef struct REPORTED_PROPERTIES_TRANSACTION_HANDLE_DATA_TAG
 {
     DATA_PUBLISHER_HANDLE_DATA* DataPublisherInstance;
@@ -75,19 +86,48 @@ DATA_PUBLISHER_HANDLE DataPublisher_Create(SCHEMA_MODEL_TYPE_HANDLE modelHandle,
         {
             /* Codes_SRS_DATA_PUBLISHER_99_041:[ DataPublisher_Create shall create a new DataPublisher instance and return a non-NULL handle in case of success.] */
             result->ModelHandle = modelHandle;
+            result->TransactionPool = NULL;
+            result->TransactionPoolCount = 0;
         }
     }
 
     return result;
 }
 
+static void DestroyTransactionValues(TRANSACTION_HANDLE_DATA* transaction)
+{
+    size_t i;
+    for (i = 0; i < transaction->ValueCount; i++)
+    {
+        Destroy_AGENT_DATA_TYPE(&transaction->AgentValues[i]);
+    }
+    transaction->ValueCount = 0;
+}
+
+static void DestroyTransaction(TRANSACTION_HANDLE_DATA* transaction)
+{
+    DestroyTransactionValues(transaction);
+    free(transaction->Values);
+    free(transaction->AgentValues);
+    free(transaction->PropertyIds);
+    free(transaction);
+}
+
 void DataPublisher_Destroy(DATA_PUBLISHER_HANDLE dataPublisherHandle)
 {
     if (dataPublisherHandle != NULL)
     {
         DATA_PUBLISHER_HANDLE_DATA* dataPublisherInstance = (DATA_PUBLISHER_HANDLE_DATA*)dataPublisherHandle;
+
         DataMarshaller_Destroy(dataPublisherInstance->DataMarshallerHandle);
-        
+
+        while (dataPublisherInstance->TransactionPool != NULL)
+        {
+            TRANSACTION_HANDLE_DATA* transaction = dataPublisherInstance->TransactionPool;
+            dataPublisherInstance->TransactionPool = transaction->NextInPool;
+            DestroyTransaction(transaction);
+        }
+
         free(dataPublisherHandle);
     }
 }
@@ -104,17 +144,30 @@ TRANSACTION_HANDLE DataPublisher_StartTransaction(DATA_PUBLISHER_HANDLE dataPubl
     }
     else
     {
+        DATA_PUBLISHER_HANDLE_DATA* dataPublisherInstance = (DATA_PUBLISHER_HANDLE_DATA*)dataPublisherHandle;
+
         /* Codes_SRS_DATA_PUBLISHER_99_007:[ A call to DataPublisher_StartTransaction shall start a new transaction.] */
-        transaction = (TRANSACTION_HANDLE_DATA*)malloc(sizeof(TRANSACTION_HANDLE_DATA));
-        if (transaction == NULL)
+        if (dataPublisherInstance->TransactionPool != NULL)
+        {
+            /*reuse a finished transaction together with the value storage it has already grown*/
+            transaction = dataPublisherInstance->TransactionPool;
+            dataPublisherInstance->TransactionPool = transaction->NextInPool;
+            dataPublisherInstance->TransactionPoolCount--;
+            transaction->NextInPool = NULL;
+        }
+        else if ((transaction = (TRANSACTION_HANDLE_DATA*)malloc(sizeof(TRANSACTION_HANDLE_DATA))) == NULL)
         {
             LogError("Allocating transaction failed (Error code: %s)", ENUM_TO_STRING(DATA_PUBLISHER_RESULT, DATA_PUBLISHER_ERROR));
         }
         else
         {
             transaction->ValueCount = 0;
+            transaction->ValueCapacity = 0;
             transaction->Values = NULL;
-            transaction->DataPublisherInstance = (DATA_PUBLISHER_HANDLE_DATA*)dataPublisherHandle;
+            transaction->AgentValues = NULL;
+            transaction->PropertyIds = NULL;
+            transaction->NextInPool = NULL;
+            transaction->DataPublisherInstance = dataPublisherInstance;
         }
     }
 
@@ -123,10 +176,77 @@ TRANSACTION_HANDLE DataPublisher_StartTransaction(DATA_PUBLISHER_HANDLE dataPubl
     return transaction;
 }
 
+/*resolves propertyPath to the path the schema keeps for it (it outlives the transaction) and to its id*/
+static DATA_PUBLISHER_RESULT GetPropertyId(DATA_PUBLISHER_HANDLE_DATA* dataPublisherInstance, const char* propertyPath, const char** schemaPath, size_t* propertyId)
+{
+    DATA_PUBLISHER_RESULT result;
+    SCHEMA_PATH_DESCRIPTOR descriptor;
+
+    if ((Schema_GetModelPathDescriptor(dataPublisherInstance->ModelHandle, propertyPath, &descriptor) != SCHEMA_OK) ||
+        ((descriptor.propertyHandle == NULL) && (descriptor.modelHandle == NULL)))
+    {
+        /* Codes_SRS_DATA_PUBLISHER_99_040:[ When propertyPath does not exist in the supplied model, DataPublisher_Publish shall return DATA_PUBLISHER_SCHEMA_FAILED without dispatching data.] */
+        result = DATA_PUBLISHER_SCHEMA_FAILED;
+    }
+    else
+    {
+        *schemaPath = descriptor.path;
+        *propertyId = descriptor.id;
+        result = DATA_PUBLISHER_OK;
+    }
+
+    return result;
+}
+
+static int GrowTransactionValues(TRANSACTION_HANDLE_DATA* transaction)
+{
+    int result;
+    size_t newCapacity = (transaction->ValueCapacity == 0) ? INITIAL_TRANSACTION_VALUE_CAPACITY : (transaction->ValueCapacity * 2);
+    DATA_MARSHALLER_VALUE* newValues;
+    AGENT_DATA_TYPE* newAgentValues;
+    size_t* newPropertyIds;
+
+    if ((newValues = (DATA_MARSHALLER_VALUE*)realloc(transaction->Values, newCapacity * sizeof(DATA_MARSHALLER_VALUE))) == NULL)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        transaction->Values = newValues;
+        if ((newAgentValues = (AGENT_DATA_TYPE*)realloc(transaction->AgentValues, newCapacity * sizeof(AGENT_DATA_TYPE))) == NULL)
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            size_t i;
+
+            /*the values have moved*/
+            transaction->AgentValues = newAgentValues;
+            for (i = 0; i < transaction->ValueCount; i++)
+            {
+                transaction->Values[i].Value = &transaction->AgentValues[i];
+            }
+
+            if ((newPropertyIds = (size_t*)realloc(transaction->PropertyIds, newCapacity * sizeof(size_t))) == NULL)
+            {
+                result = __FAILURE__;
+            }
+            else
+            {
+                transaction->PropertyIds = newPropertyIds;
+                transaction->ValueCapacity = newCapacity;
+                result = 0;
+            }
+        }
+    }
+
+    return result;
+}
+
 DATA_PUBLISHER_RESULT DataPublisher_PublishTransacted(TRANSACTION_HANDLE transactionHandle, const char* propertyPath, const AGENT_DATA_TYPE* data)
 {
     DATA_PUBLISHER_RESULT result;
-    char* propertyPathCopy;
 
     /* Codes_SRS_DATA_PUBLISHER_99_017:[ When one or more NULL parameter(s) are specified, DataPublisher_PublishTransacted is called with a NULL transactionHandle, it shall return DATA_PUBLISHER_INVALID_ARG.] */
     if ((transactionHandle == NULL) ||
@@ -136,38 +256,19 @@ DATA_PUBLISHER_RESULT DataPublisher_PublishTransacted(TRANSACTION_HANDLE transac
         result = DATA_PUBLISHER_INVALID_ARG;
         LOG_DATA_PUBLISHER_ERROR;
     }
-    else if (mallocAndStrcpy_s(&propertyPathCopy, propertyPath) != 0)
-    {
-        /* Codes_SRS_DATA_PUBLISHER_99_020:[ For any errors not explicitly mentioned here the DataPublisher APIs shall return DATA_PUBLISHER_ERROR.] */
-        result = DATA_PUBLISHER_ERROR;
-        LOG_DATA_PUBLISHER_ERROR;
-    }
     else
     {
         TRANSACTION_HANDLE_DATA* transaction = (TRANSACTION_HANDLE_DATA*)transactionHandle;
-        AGENT_DATA_TYPE* propertyValue;
+        const char* schemaPath;
+        size_t propertyId;
+        AGENT_DATA_TYPE propertyValue;
 
-        if (!Schema_ModelPropertyByPathExists(transaction->DataPublisherInstance->ModelHandle, propertyPath))
-        {
-            free(propertyPathCopy);
-
-            /* Codes_SRS_DATA_PUBLISHER_99_040:[ When propertyPath does not exist in the supplied model, DataPublisher_Publish shall return DATA_PUBLISHER_SCHEMA_FAILED without dispatching data.] */
-            result = DATA_PUBLISHER_SCHEMA_FAILED;
-            LOG_DATA_PUBLISHER_ERROR;
-        }
-        else if ((propertyValue = (AGENT_DATA_TYPE*)malloc(sizeof(AGENT_DATA_TYPE))) == NULL)
+        if ((result = GetPropertyId(transaction->DataPublisherInstance, propertyPath, &schemaPath, &propertyId)) != DATA_PUBLISHER_OK)
         {
-            free(propertyPathCopy);
-
-            /* Codes_SRS_DATA_PUBLISHER_99_020:[ For any errors not explicitly mentioned here the DataPublisher APIs shall return DATA_PUBLISHER_ERROR.] */
-            result = DATA_PUBLISHER_ERROR;
             LOG_DATA_PUBLISHER_ERROR;
         }
-        else if (Create_AGENT_DATA_TYPE_from_AGENT_DATA_TYPE(propertyValue, data) != AGENT_DATA_TYPES_OK)
+        else if (Create_AGENT_DATA_TYPE_from_AGENT_DATA_TYPE(&propertyValue, data) != AGENT_DATA_TYPES_OK)
         {
-            free(propertyPathCopy);
-            free(propertyValue);
-
             /* Codes_SRS_DATA_PUBLISHER_99_028:[ If creating the copy fails then DATA_PUBLISHER_AGENT_DATA_TYPES_ERROR shall be returned.] */
             result = DATA_PUBLISHER_AGENT_DATA_TYPES_ERROR;
             LOG_DATA_PUBLISHER_ERROR;
@@ -175,36 +276,26 @@ DATA_PUBLISHER_RESULT DataPublisher_PublishTransacted(TRANSACTION_HANDLE transac
         else
         {
             size_t i;
-            DATA_MARSHALLER_VALUE* propertySlot = NULL;
 
             /* Codes_SRS_DATA_PUBLISHER_99_019:[ If the same property is associated twice with a transaction, then the last value shall be kept associated with the transaction.] */
             for (i = 0; i < transaction->ValueCount; i++)
             {
-                if (strcmp(transaction->Values[i].PropertyPath, propertyPath) == 0)
+                if (transaction->PropertyIds[i] == propertyId)
                 {
-                    propertySlot = &transaction->Values[i];
                     break;
                 }
             }
 
-            if (propertySlot == NULL)
+            if (i < transaction->ValueCount)
             {
-                DATA_MARSHALLER_VALUE* newValues = (DATA_MARSHALLER_VALUE*)realloc(transaction->Values, sizeof(DATA_MARSHALLER_VALUE)* (transaction->ValueCount + 1));
-                if (newValues != NULL)
-                {
-                    transaction->Values = newValues;
-                    propertySlot = &transaction->Values[transaction->ValueCount];
-                    propertySlot->Value = NULL;
-                    propertySlot->PropertyPath = NULL;
-                    transaction->ValueCount++;
-                }
+                Destroy_AGENT_DATA_TYPE(&transaction->AgentValues[i]);
+                transaction->AgentValues[i] = propertyValue;
+                result = DATA_PUBLISHER_OK;
             }
-
-            if (propertySlot == NULL)
+            else if ((transaction->ValueCount == transaction->ValueCapacity) &&
+                (GrowTransactionValues(transaction) != 0))
             {
-                Destroy_AGENT_DATA_TYPE((AGENT_DATA_TYPE*)propertyValue);
-                free(propertyValue);
-                free(propertyPathCopy);
+                Destroy_AGENT_DATA_TYPE(&propertyValue);
 
                 /* Codes_SRS_DATA_PUBLISHER_99_020:[ For any errors not explicitly mentioned here the DataPublisher APIs shall return DATA_PUBLISHER_ERROR.] */
                 result = DATA_PUBLISHER_ERROR;
@@ -212,20 +303,12 @@ DATA_PUBLISHER_RESULT DataPublisher_PublishTransacted(TRANSACTION_HANDLE transac
             }
             else
             {
-                if (propertySlot->Value != NULL)
-                {
-                    Destroy_AGENT_DATA_TYPE((AGENT_DATA_TYPE*)propertySlot->Value);
-                    free((AGENT_DATA_TYPE*)propertySlot->Value);
-                }
-                if (propertySlot->PropertyPath != NULL)
-                {
-                    char* existingValue = (char*)propertySlot->PropertyPath;
-                    free(existingValue);
-                }
-
                 /* Codes_SRS_DATA_PUBLISHER_99_016:[ When DataPublisher_PublishTransacted is invoked, DataPublisher shall associate the data with the transaction identified by the transactionHandle argument and return DATA_PUBLISHER_OK. No data shall be dispatched at the time of the call.] */
-                propertySlot->PropertyPath = propertyPathCopy;
-                propertySlot->Value = propertyValue;
+                transaction->AgentValues[i] = propertyValue;
+                transaction->Values[i].Value = &transaction->AgentValues[i];
+                transaction->Values[i].PropertyPath = schemaPath;
+                transaction->PropertyIds[i] = propertyId;
+                transaction->ValueCount++;
 
                 result = DATA_PUBLISHER_OK;
             }
@@ -295,19 +378,21 @@ DATA_PUBLISHER_RESULT DataPublisher_CancelTransaction(TRANSACTION_HANDLE transac
     else
     {
         TRANSACTION_HANDLE_DATA* transaction = (TRANSACTION_HANDLE_DATA*)transactionHandle;
-        size_t i;
+        DATA_PUBLISHER_HANDLE_DATA* dataPublisherInstance = transaction->DataPublisherInstance;
 
         /* Codes_SRS_DATA_PUBLISHER_99_015:[ DataPublisher_CancelTransaction shall dispose of any resources associated with the transaction.] */
-        for (i = 0; i < transaction->ValueCount; i++)
+        if (dataPublisherInstance->TransactionPoolCount < TRANSACTION_POOL_SIZE)
         {
-            Destroy_AGENT_DATA_TYPE((AGENT_DATA_TYPE*)transaction->Values[i].Value);
-            free((char*)transaction->Values[i].PropertyPath);
-            free((AGENT_DATA_TYPE*)transaction->Values[i].Value);
+            /*the value storage stays with the transaction so the next one does not have to grow it again*/
+            DestroyTransactionValues(transaction);
+            transaction->NextInPool = dataPublisherInstance->TransactionPool;
+            dataPublisherInstance->TransactionPool = transaction;
+            dataPublisherInstance->TransactionPoolCount++;
+        }
+        else
+        {
+            DestroyTransaction(transaction);
         }
-
-        /* Codes_SRS_DATA_PUBLISHER_99_015:[ DataPublisher_CancelTransaction shall dispose of any resources associated with the transaction.] */
-        free(transaction->Values);
-        free(transaction);
 
         /* Codes_SRS_DATA_PUBLISHER_99_013:[ A call to DataPublisher_CancelTransaction shall dispose of the transaction without dispatching
                                         the data to the DataMarshaller module and it shall return DATA_PUBLISHER_OK.] */
@@ -68,6 +68,34 @@ typedef struct MODEL_IN_MODEL_TAG
     SCHEMA_MODEL_TYPE_HANDLE modelHandle;
 } MODEL_IN_MODEL;
 
+/*the path index maps every path that can be reached from a model ("a", "a/b", "a/b/c"...) to what is found at the end of the path*/
+/*a path can name more than one kind of element at the same time (e.g. a property and a desired property having the same name)*/
+#define SCHEMA_PATH_INDEX_PROPERTY          0x01
+#define SCHEMA_PATH_INDEX_REPORTED_PROPERTY 0x02
+#define SCHEMA_PATH_INDEX_DESIRED_PROPERTY  0x04
+#define SCHEMA_PATH_INDEX_MODEL_IN_MODEL    0x08
+#define SCHEMA_PATH_INDEX_ACTION            0x10
+
+typedef struct SCHEMA_PATH_INDEX_ENTRY_TAG
+{
+    const char* path; /*NULL for an empty slot, points into the storage of the index*/
+    size_t pathLength;
+    uint32_t hash;
+    unsigned int kinds; /*bitmask of SCHEMA_PATH_INDEX_...*/
+    size_t depth; /*0 for elements of the model itself*/
+    SCHEMA_PATH_DESCRIPTOR descriptor;
+} SCHEMA_PATH_INDEX_ENTRY;
+
+/*an index is a single allocation holding this header, the slots, pathsById and the text of the paths*/
+/*it is built when the model (or one of its models in model) changes and only read afterwards*/
+typedef struct SCHEMA_PATH_INDEX_TAG
+{
+    size_t slotCount; /*always a power of 2*/
+    size_t entryCount;
+    SCHEMA_PATH_INDEX_ENTRY* slots;
+    const char** pathsById; /*pathsById[id] is the path of the entry having that id*/
+} SCHEMA_PATH_INDEX;
+
 typedef struct SCHEMA_MODEL_TYPE_HANDLE_DATA_TAG
 {
     VECTOR_HANDLE methods; /*holds SCHEMA_METHOD_HANDLE*/
@@ -81,6 +109,8 @@ typedef struct SCHEMA_MODEL_TYPE_HANDLE_DATA_TAG
     size_t ActionCount;
     VECTOR_HANDLE models;
     size_t DeviceCount;
+    struct SCHEMA_PATH_INDEX_TAG* pathIndex; /*NULL as long as the model has no elements*/
+    struct SCHEMA_PATH_INDEX_TAG* newPathIndex; /*only used while the indexes are being rebuilt, see UpdatePathIndexes*/
 } SCHEMA_MODEL_TYPE_HANDLE_DATA;
 
 typedef struct SCHEMA_STRUCT_TYPE_HANDLE_DATA_TAG
@@ -191,6 +221,354 @@ static void DestroyStruct(SCHEMA_STRUCT_TYPE_HANDLE structTypeHandle)
     }
 }
 
+/*FNV-1a*/
+static uint32_t HashPath(const char* path, size_t pathLength)
+{
+    uint32_t result = 2166136261U;
+    size_t i;
+    for (i = 0; i < pathLength; i++)
+    {
+        result ^= (unsigned char)path[i];
+        result *= 16777619U;
+    }
+    return result;
+}
+
+static SCHEMA_PATH_INDEX_ENTRY* FindPathIndexSlot(const SCHEMA_PATH_INDEX* pathIndex, const char* path, size_t pathLength, uint32_t hash)
+{
+    /*linear probing, there is always at least one empty slot*/
+    size_t i = hash & (pathIndex->slotCount - 1);
+    while ((pathIndex->slots[i].path != NULL) &&
+        ((pathIndex->slots[i].hash != hash) || (pathIndex->slots[i].pathLength != pathLength) || (memcmp(pathIndex->slots[i].path, path, pathLength) != 0)))
+    {
+        i = (i + 1) & (pathIndex->slotCount - 1);
+    }
+    return &pathIndex->slots[i];
+}
+
+/*returns the entry of the first pathLength characters of path or NULL if there is none*/
+static const SCHEMA_PATH_INDEX_ENTRY* FindPathIndexEntry(const SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType, const char* path, size_t pathLength)
+{
+    const SCHEMA_PATH_INDEX_ENTRY* result;
+    if (modelType->pathIndex == NULL)
+    {
+        /*the model has no elements*/
+        result = NULL;
+    }
+    else
+    {
+        result = FindPathIndexSlot(modelType->pathIndex, path, pathLength, HashPath(path, pathLength));
+        if (result->path == NULL)
+        {
+            result = NULL;
+        }
+    }
+    return result;
+}
+
+static bool ModelContainsModel(const SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType, const SCHEMA_MODEL_TYPE_HANDLE_DATA* otherModelType)
+{
+    bool result = false;
+    size_t n = VECTOR_size(modelType->models);
+    size_t i;
+    for (i = 0; (!result) && (i < n); i++)
+    {
+        MODEL_IN_MODEL* modelInModel = (MODEL_IN_MODEL*)VECTOR_element(modelType->models, i);
+        result = ((SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelInModel->modelHandle == otherModelType) ||
+            ModelContainsModel((SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelInModel->modelHandle, otherModelType);
+    }
+    return result;
+}
+
+typedef struct PATH_INDEX_SIZE_TAG
+{
+    size_t elementCount; /*at least the number of entries*/
+    size_t textSize; /*at least the size of the text of all the paths*/
+    size_t maxPathLength;
+} PATH_INDEX_SIZE;
+
+static void MeasurePath(PATH_INDEX_SIZE* size, size_t prefixLength, const char* name)
+{
+    size_t pathLength = prefixLength + strlen(name);
+    size->elementCount++;
+    size->textSize += pathLength + 1;
+    if (pathLength > size->maxPathLength)
+    {
+        size->maxPathLength = pathLength;
+    }
+}
+
+/*first pass of BuildPathIndex: finds out how big the index of a model is going to be*/
+static void MeasureModelElements(const SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType, PATH_INDEX_SIZE* size, size_t prefixLength)
+{
+    size_t i;
+    size_t n;
+
+    for (i = 0; i < modelType->PropertyCount; i++)
+    {
+        MeasurePath(size, prefixLength, ((SCHEMA_PROPERTY_HANDLE_DATA*)modelType->Properties[i])->PropertyName);
+    }
+
+    n = VECTOR_size(modelType->reportedProperties);
+    for (i = 0; i < n; i++)
+    {
+        MeasurePath(size, prefixLength, (*(SCHEMA_REPORTED_PROPERTY_HANDLE_DATA**)VECTOR_element(modelType->reportedProperties, i))->reportedPropertyName);
+    }
+
+    n = VECTOR_size(modelType->desiredProperties);
+    for (i = 0; i < n; i++)
+    {
+        MeasurePath(size, prefixLength, (*(SCHEMA_DESIRED_PROPERTY_HANDLE_DATA**)VECTOR_element(modelType->desiredProperties, i))->desiredPropertyName);
+    }
+
+    for (i = 0; i < modelType->ActionCount; i++)
+    {
+        MeasurePath(size, prefixLength, ((SCHEMA_ACTION_HANDLE_DATA*)modelType->Actions[i])->ActionName);
+    }
+
+    n = VECTOR_size(modelType->models);
+    for (i = 0; i < n; i++)
+    {
+        MODEL_IN_MODEL* modelInModel = (MODEL_IN_MODEL*)VECTOR_element(modelType->models, i);
+        MeasurePath(size, prefixLength, modelInModel->propertyName);
+        MeasureModelElements((SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelInModel->modelHandle, size, prefixLength + strlen(modelInModel->propertyName) + 1);
+    }
+}
+
+typedef struct PATH_INDEX_BUILDER_TAG
+{
+    SCHEMA_PATH_INDEX* pathIndex;
+    char* nextPathText; /*where the text of the next new path goes*/
+    char* scratch; /*the path being indexed, has room for the longest path*/
+} PATH_INDEX_BUILDER;
+
+/*returns the entry of scratch + name, creating it if needed*/
+static SCHEMA_PATH_INDEX_ENTRY* AddPathIndexEntry(PATH_INDEX_BUILDER* builder, size_t prefixLength, const char* name, size_t depth)
+{
+    SCHEMA_PATH_INDEX_ENTRY* result;
+    size_t nameLength = strlen(name);
+    size_t pathLength = prefixLength + nameLength;
+    uint32_t hash;
+
+    (void)memcpy(builder->scratch + prefixLength, name, nameLength);
+    hash = HashPath(builder->scratch, pathLength);
+    result = FindPathIndexSlot(builder->pathIndex, builder->scratch, pathLength, hash);
+    if (result->path == NULL)
+    {
+        (void)memcpy(builder->nextPathText, builder->scratch, pathLength);
+        builder->nextPathText[pathLength] = '\0';
+        result->path = builder->nextPathText;
+        builder->nextPathText += pathLength + 1;
+        result->pathLength = pathLength;
+        result->hash = hash;
+        result->depth = depth;
+        result->descriptor.id = builder->pathIndex->entryCount;
+        result->descriptor.path = result->path;
+        builder->pathIndex->pathsById[result->descriptor.id] = result->path;
+        builder->pathIndex->entryCount++;
+    }
+    return result;
+}
+
+/*second pass of BuildPathIndex, cannot fail since the first pass made room for everything*/
+/*offset is where the data of modelType starts, counted from the start of the data of the model being indexed*/
+static void IndexModelElements(PATH_INDEX_BUILDER* builder, const SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType, size_t prefixLength, size_t depth, size_t offset)
+{
+    size_t i;
+    size_t n;
+    SCHEMA_PATH_INDEX_ENTRY* entry;
+
+    /*the order of insertion mirrors the order of the linear searches: the first element having a name is the one found*/
+    for (i = 0; i < modelType->PropertyCount; i++)
+    {
+        SCHEMA_PROPERTY_HANDLE_DATA* property = (SCHEMA_PROPERTY_HANDLE_DATA*)modelType->Properties[i];
+        entry = AddPathIndexEntry(builder, prefixLength, property->PropertyName, depth);
+        if ((entry->kinds & SCHEMA_PATH_INDEX_PROPERTY) == 0)
+        {
+            entry->kinds |= SCHEMA_PATH_INDEX_PROPERTY;
+            entry->descriptor.propertyHandle = property;
+            entry->descriptor.type = property->PropertyType;
+        }
+    }
+
+    n = VECTOR_size(modelType->reportedProperties);
+    for (i = 0; i < n; i++)
+    {
+        SCHEMA_REPORTED_PROPERTY_HANDLE_DATA* reportedProperty = *(SCHEMA_REPORTED_PROPERTY_HANDLE_DATA**)VECTOR_element(modelType->reportedProperties, i);
+        entry = AddPathIndexEntry(builder, prefixLength, reportedProperty->reportedPropertyName, depth);
+        if ((entry->kinds & SCHEMA_PATH_INDEX_REPORTED_PROPERTY) == 0)
+        {
+            entry->kinds |= SCHEMA_PATH_INDEX_REPORTED_PROPERTY;
+            entry->descriptor.reportedPropertyHandle = reportedProperty;
+            if (entry->descriptor.type == NULL)
+            {
+                entry->descriptor.type = reportedProperty->reportedPropertyType;
+            }
+        }
+    }
+
+    n = VECTOR_size(modelType->desiredProperties);
+    for (i = 0; i < n; i++)
+    {
+        SCHEMA_DESIRED_PROPERTY_HANDLE_DATA* desiredProperty = *(SCHEMA_DESIRED_PROPERTY_HANDLE_DATA**)VECTOR_element(modelType->desiredProperties, i);
+        entry = AddPathIndexEntry(builder, prefixLength, desiredProperty->desiredPropertyName, depth);
+        if ((entry->kinds & SCHEMA_PATH_INDEX_DESIRED_PROPERTY) == 0)
+        {
+            entry->kinds |= SCHEMA_PATH_INDEX_DESIRED_PROPERTY;
+            entry->descriptor.desiredPropertyHandle = desiredProperty;
+            if (entry->descriptor.type == NULL)
+            {
+                entry->descriptor.type = desiredProperty->desiredPropertyType;
+            }
+            entry->descriptor.offset = offset + desiredProperty->offset;
+            entry->descriptor.desiredPropertyFromAGENT_DATA_TYPE = desiredProperty->desiredPropertyFromAGENT_DATA_TYPE;
+            entry->descriptor.onDesiredProperty = desiredProperty->onDesiredProperty;
+        }
+    }
+
+    for (i = 0; i < modelType->ActionCount; i++)
+    {
+        SCHEMA_ACTION_HANDLE_DATA* action = (SCHEMA_ACTION_HANDLE_DATA*)modelType->Actions[i];
+        entry = AddPathIndexEntry(builder, prefixLength, action->ActionName, depth);
+        if ((entry->kinds & SCHEMA_PATH_INDEX_ACTION) == 0)
+        {
+            entry->kinds |= SCHEMA_PATH_INDEX_ACTION;
+            entry->descriptor.actionHandle = action;
+        }
+    }
+
+    n = VECTOR_size(modelType->models);
+    for (i = 0; i < n; i++)
+    {
+        MODEL_IN_MODEL* modelInModel = (MODEL_IN_MODEL*)VECTOR_element(modelType->models, i);
+        entry = AddPathIndexEntry(builder, prefixLength, modelInModel->propertyName, depth);
+        if ((entry->kinds & SCHEMA_PATH_INDEX_MODEL_IN_MODEL) == 0)
+        {
+            /*only the first model in model having a name is walked into, same as the linear search*/
+            size_t pathLength = entry->pathLength;
+            entry->kinds |= SCHEMA_PATH_INDEX_MODEL_IN_MODEL;
+            entry->descriptor.modelHandle = modelInModel->modelHandle;
+            if ((entry->kinds & SCHEMA_PATH_INDEX_DESIRED_PROPERTY) == 0)
+            {
+                entry->descriptor.offset = offset + modelInModel->offset;
+                entry->descriptor.onDesiredProperty = modelInModel->onDesiredProperty;
+            }
+
+            builder->scratch[pathLength] = '/';
+            IndexModelElements(builder, (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelInModel->modelHandle, pathLength + 1, depth + 1, offset + modelInModel->offset);
+        }
+    }
+}
+
+static SCHEMA_PATH_INDEX* BuildPathIndex(const SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType)
+{
+    SCHEMA_PATH_INDEX* result;
+    PATH_INDEX_SIZE size;
+    size_t slotCount = 2;
+
+    size.elementCount = 0;
+    size.textSize = 0;
+    size.maxPathLength = 0;
+    MeasureModelElements(modelType, &size, 0);
+
+    /*keep the load factor under 1/2*/
+    while (slotCount < size.elementCount * 2)
+    {
+        slotCount *= 2;
+    }
+
+    if ((result = (SCHEMA_PATH_INDEX*)malloc(sizeof(SCHEMA_PATH_INDEX) + slotCount * sizeof(SCHEMA_PATH_INDEX_ENTRY) + size.elementCount * sizeof(const char*) + size.textSize + size.maxPathLength + 1)) == NULL)
+    {
+        LogError("unable to allocate the path index of the model %s", modelType->Name);
+    }
+    else
+    {
+        PATH_INDEX_BUILDER builder;
+
+        result->slotCount = slotCount;
+        result->entryCount = 0;
+        result->slots = (SCHEMA_PATH_INDEX_ENTRY*)(result + 1);
+        result->pathsById = (const char**)(result->slots + slotCount);
+        (void)memset(result->slots, 0, slotCount * sizeof(SCHEMA_PATH_INDEX_ENTRY));
+
+        builder.pathIndex = result;
+        builder.nextPathText = (char*)(result->pathsById + size.elementCount);
+        builder.scratch = builder.nextPathText + size.textSize;
+        IndexModelElements(&builder, modelType, 0, 0, 0);
+    }
+    return result;
+}
+
+/*gives a new index to changedModel and to every model having it as a model in model (their indexes hold its paths too)*/
+/*all the new indexes are built before any old one is dropped, so on failure every model keeps the index it had*/
+static int UpdatePathIndexes(SCHEMA_MODEL_TYPE_HANDLE_DATA* changedModel)
+{
+    int result;
+    size_t nSchemas = (g_schemas == NULL) ? 0 : VECTOR_size(g_schemas);
+    size_t i;
+    size_t j;
+
+    if ((changedModel->newPathIndex = BuildPathIndex(changedModel)) == NULL)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+        for (i = 0; (result == 0) && (i < nSchemas); i++)
+        {
+            SCHEMA_HANDLE_DATA* schema = *(SCHEMA_HANDLE_DATA**)VECTOR_element(g_schemas, i);
+            for (j = 0; (result == 0) && (j < schema->ModelTypeCount); j++)
+            {
+                SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)schema->ModelTypes[j];
+                if ((modelType != changedModel) &&
+                    ModelContainsModel(modelType, changedModel) &&
+                    ((modelType->newPathIndex = BuildPathIndex(modelType)) == NULL))
+                {
+                    result = __FAILURE__;
+                }
+            }
+        }
+
+        for (i = 0; i < nSchemas; i++)
+        {
+            SCHEMA_HANDLE_DATA* schema = *(SCHEMA_HANDLE_DATA**)VECTOR_element(g_schemas, i);
+            for (j = 0; j < schema->ModelTypeCount; j++)
+            {
+                SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)schema->ModelTypes[j];
+                if ((modelType != changedModel) && (modelType->newPathIndex != NULL))
+                {
+                    if (result == 0)
+                    {
+                        free(modelType->pathIndex);
+                        modelType->pathIndex = modelType->newPathIndex;
+                    }
+                    else
+                    {
+                        free(modelType->newPathIndex);
+                    }
+                    modelType->newPathIndex = NULL;
+                }
+            }
+        }
+
+        if (result == 0)
+        {
+            if (changedModel->pathIndex != NULL)
+            {
+                free(changedModel->pathIndex);
+            }
+            changedModel->pathIndex = changedModel->newPathIndex;
+        }
+        else
+        {
+            free(changedModel->newPathIndex);
+        }
+        changedModel->newPathIndex = NULL;
+    }
+    return result;
+}
+
 static void DestroyModel(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle)
 {
     SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
@@ -243,6 +621,8 @@ static void DestroyModel(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle)
     VECTOR_clear(modelType->models);
     VECTOR_destroy(modelType->models);
 
+    free(modelType->pathIndex);
+
     free(modelType->Actions);
     free(modelType);
 }
@@ -320,8 +700,19 @@ static SCHEMA_RESULT AddModelProperty(SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType,
                         modelType->Properties[modelType->PropertyCount] = (SCHEMA_PROPERTY_HANDLE)newProperty;
                         modelType->PropertyCount++;
 
-                        /* Codes_SRS_SCHEMA_99_012:[On success, Schema_AddModelProperty shall return SCHEMA_OK.] */
-                        result = SCHEMA_OK;
+                        if (UpdatePathIndexes(modelType) != 0)
+                        {
+                            /* Codes_SRS_SCHEMA_99_014:[On any other error, Schema_AddModelProperty shall return SCHEMA_ERROR.] */
+                            modelType->PropertyCount--;
+                            DestroyProperty(newProperty);
+                            result = SCHEMA_ERROR;
+                            LogError("(result = %s)", ENUM_TO_STRING(SCHEMA_RESULT, result));
+                        }
+                        else
+                        {
+                            /* Codes_SRS_SCHEMA_99_012:[On success, Schema_AddModelProperty shall return SCHEMA_OK.] */
+                            result = SCHEMA_OK;
+                        }
                     }
                 }
 
@@ -705,6 +1096,8 @@ SCHEMA_MODEL_TYPE_HANDLE Schema_CreateModelType(SCHEMA_HANDLE schemaHandle, cons
                                     modelType->Actions = NULL;
                                     modelType->SchemaHandle = schemaHandle;
                                     modelType->DeviceCount = 0;
+                                    modelType->pathIndex = NULL;
+                                    modelType->newPathIndex = NULL;
 
                                     schema->ModelTypes[schema->ModelTypeCount] = modelType;
                                     schema->ModelTypeCount++;
@@ -830,6 +1223,16 @@ SCHEMA_RESULT Schema_AddModelReportedProperty(SCHEMA_MODEL_TYPE_HANDLE modelType
                             free(reportedProperty);
                             result = SCHEMA_ERROR;
                         }
+                        else if (UpdatePathIndexes(modelType) != 0)
+                        {
+                            /*Codes_SRS_SCHEMA_02_006: [ If any error occurs then Schema_AddModelReportedProperty shall fail and return SCHEMA_ERROR. ]*/
+                            LogError("unable to index the reported property %s", reportedPropertyName);
+                            VECTOR_erase(modelType->reportedProperties, VECTOR_back(modelType->reportedProperties), 1);
+                            free((void*)reportedProperty->reportedPropertyType);
+                            free((void*)reportedProperty->reportedPropertyName);
+                            free(reportedProperty);
+                            result = SCHEMA_ERROR;
+                        }
                         else
                         {
                             /*Codes_SRS_SCHEMA_02_007: [ Otherwise Schema_AddModelReportedProperty shall succeed and return SCHEMA_OK. ]*/
@@ -912,7 +1315,18 @@ SCHEMA_ACTION_HANDLE Schema_CreateModelAction(SCHEMA_MODEL_TYPE_HANDLE modelType
 
                         modelType->Actions[modelType->ActionCount] = newAction;
                         modelType->ActionCount++;
-                        result = (SCHEMA_ACTION_HANDLE)(newAction);
+                        if (UpdatePathIndexes(modelType) != 0)
+                        {
+                            /* Codes_SRS_SCHEMA_99_106: [On any other error, Schema_CreateModelAction shall return NULL.]*/
+                            modelType->ActionCount--;
+                            DestroyAction(newAction);
+                            result = NULL;
+                            LogError("(Error code:%s)", ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ERROR));
+                        }
+                        else
+                        {
+                            result = (SCHEMA_ACTION_HANDLE)(newAction);
+                        }
                     }
 
                     /* If possible, reduce the memory of over allocation */
@@ -2279,7 +2693,14 @@ SCHEMA_RESULT Schema_AddModelModel(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, con
         temp.modelHandle = modelType;
         temp.offset = offset;
         temp.onDesiredProperty = onDesiredProperty;
-        if (mallocAndStrcpy_s((char**)&(temp.propertyName), propertyName) != 0)
+        /*a model cannot contain itself, not even through other models: it would have no end*/
+        if ((modelType == modelTypeHandle) ||
+            ModelContainsModel((SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelType, parentModel))
+        {
+            result = SCHEMA_INVALID_ARG;
+            LogError("model %s already contains model %s", ((SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelType)->Name, parentModel->Name);
+        }
+        else if (mallocAndStrcpy_s((char**)&(temp.propertyName), propertyName) != 0)
         {
             result = SCHEMA_ERROR;
             LogError("(Error code: %s)", ENUM_TO_STRING(SCHEMA_RESULT, result));
@@ -2291,10 +2712,17 @@ SCHEMA_RESULT Schema_AddModelModel(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, con
             result = SCHEMA_ERROR;
             LogError("(Error code: %s)", ENUM_TO_STRING(SCHEMA_RESULT, result));
         }
+        else if (UpdatePathIndexes(parentModel) != 0)
+        {
+            /*Codes_SRS_SCHEMA_99_174: [The function shall return SCHEMA_ERROR if any other error occurs.]*/
+            VECTOR_erase(parentModel->models, VECTOR_back(parentModel->models), 1);
+            free((void*)temp.propertyName);
+            result = SCHEMA_ERROR;
+            LogError("(Error code: %s)", ENUM_TO_STRING(SCHEMA_RESULT, result));
+        }
         else
         {
             /*Codes_SRS_SCHEMA_99_164: [If the function succeeds, then the return value shall be SCHEMA_OK.]*/
-            
             result = SCHEMA_OK;
         }
     }
@@ -2526,79 +2954,41 @@ bool Schema_ModelPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle,
     }
     else
     {
-        const char* slashPos;
-        result = false;
-
+        const SCHEMA_PATH_INDEX_ENTRY* entry;
         /* Codes_SRS_SCHEMA_99_182: [A single slash ('/') at the beginning of the path shall be ignored and the path shall still be valid.] */
         if (*propertyPath == '/')
         {
             propertyPath++;
         }
 
-        do
+        /* Codes_SRS_SCHEMA_99_179: [The propertyPath shall be assumed to be in the format model1/model2/.../propertyName.] */
+        /* Codes_SRS_SCHEMA_99_178: [The argument propertyPath shall be used to find the leaf property.] */
+        if ((entry = FindPathIndexEntry((SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle, propertyPath, strlen(propertyPath))) != NULL)
         {
-            const char* endPos;
-            size_t i;
-            size_t modelCount;
-            SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
-
-            /* Codes_SRS_SCHEMA_99_179: [The propertyPath shall be assumed to be in the format model1/model2/.../propertyName.] */
-            slashPos = strchr(propertyPath, '/');
-            endPos = slashPos;
-            if (endPos == NULL)
-            {
-                endPos = &propertyPath[strlen(propertyPath)];
-            }
-
-            /* get the child-model */
-            modelCount = VECTOR_size(modelType->models);
-            for (i = 0; i < modelCount; i++)
-            {
-                MODEL_IN_MODEL* childModel = (MODEL_IN_MODEL*)VECTOR_element(modelType->models, i);
-                if ((strncmp(childModel->propertyName, propertyPath, endPos - propertyPath) == 0) &&
-                    (strlen(childModel->propertyName) == (size_t)(endPos - propertyPath)))
-                {
-                    /* found */
-                    modelTypeHandle = childModel->modelHandle;
-                    break;
-                }
-            }
-
-            if (i < modelCount)
+            /* Codes_SRS_SCHEMA_99_177: [Schema_ModelPropertyByPathExists shall return true if a leaf property exists in the model modelTypeHandle.] */
+            /*a path that ends in a model in model is also a valid path*/
+            result = ((entry->kinds & (SCHEMA_PATH_INDEX_PROPERTY | SCHEMA_PATH_INDEX_MODEL_IN_MODEL)) != 0);
+        }
+        else
+        {
+            /*the path is walked from its start as long as it goes through models in model: a property found on the way ends it, whatever follows*/
+            /*("property/anything" exists), as it always did*/
+            const char* slashPos = strchr(propertyPath, '/');
+            result = false;
+            while ((slashPos != NULL) &&
+                ((entry = FindPathIndexEntry((SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle, propertyPath, slashPos - propertyPath)) != NULL))
             {
-                /* model found, check if there is more in the path */
-                if (slashPos == NULL)
+                if ((entry->kinds & SCHEMA_PATH_INDEX_MODEL_IN_MODEL) != 0)
                 {
-                    /* this is the last one, so this is the thing we were looking for */
-                    result = true;
-                    break;
+                    slashPos = strchr(slashPos + 1, '/');
                 }
                 else
                 {
-                    /* continue looking, there's more  */
-                    propertyPath = slashPos + 1;
-                }
-            }
-            else
-            {
-                /* no model found, let's see if this is a property */
-                /* Codes_SRS_SCHEMA_99_178: [The argument propertyPath shall be used to find the leaf property.] */
-                for (i = 0; i < modelType->PropertyCount; i++)
-                {
-                    SCHEMA_PROPERTY_HANDLE_DATA* property = (SCHEMA_PROPERTY_HANDLE_DATA*)modelType->Properties[i];
-                    if ((strncmp(property->PropertyName, propertyPath, endPos - propertyPath) == 0) &&
-                        (strlen(property->PropertyName) == (size_t)(endPos - propertyPath)))
-                    {
-                        /* found property */
-                        /* Codes_SRS_SCHEMA_99_177: [Schema_ModelPropertyByPathExists shall return true if a leaf property exists in the model modelTypeHandle.] */
-                        result = true;
-                        break;
-                    }
+                    result = ((entry->kinds & SCHEMA_PATH_INDEX_PROPERTY) != 0);
+                    break;
                 }
-
-                break;
             }
-        } while (slashPos != NULL);
+        }
     }
 
     return result;
@@ -2618,71 +3008,23 @@ bool Schema_ModelReportedPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelType
     }
     else
     {
-        const char* slashPos;
+        const SCHEMA_PATH_INDEX_ENTRY* entry;
 
         /*Codes_SRS_SCHEMA_02_021: [ If the reported property cannot be found Schema_ModelReportedPropertyByPathExists shall fail and return false. ]*/
-        result = false;
-
         /*Codes_SRS_SCHEMA_02_020: [ reportedPropertyPath shall be assumed to be in the format model1/model2/.../reportedPropertyName. ]*/
         if (*reportedPropertyPath == '/')
         {
             reportedPropertyPath++;
         }
 
-        do
-        {
-            const char* endPos;
-            size_t i;
-            size_t modelCount;
-            SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
-
-            slashPos = strchr(reportedPropertyPath, '/');
-            endPos = slashPos;
-            if (endPos == NULL)
-            {
-                endPos = &reportedPropertyPath[strlen(reportedPropertyPath)];
-            }
+        entry = FindPathIndexEntry((SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle, reportedPropertyPath, strlen(reportedPropertyPath));
 
-            modelCount = VECTOR_size(modelType->models);
-            for (i = 0; i < modelCount; i++)
-            {
-                MODEL_IN_MODEL* childModel = (MODEL_IN_MODEL*)VECTOR_element(modelType->models, i);
-                if ((strncmp(childModel->propertyName, reportedPropertyPath, endPos - reportedPropertyPath) == 0) &&
-                    (strlen(childModel->propertyName) == (size_t)(endPos - reportedPropertyPath)))
-                {
-                    /* found */
-                    modelTypeHandle = childModel->modelHandle;
-                    break;
-                }
-            }
-
-            if (i < modelCount)
-            {
-                /* model found, check if there is more in the path */
-                if (slashPos == NULL)
-                {
-                    /*Codes_SRS_SCHEMA_02_022: [ If the path reportedPropertyPath points to a sub-model, Schema_ModelReportedPropertyByPathExists shall succeed and true. ]*/
-                    /* this is the last one, so this is the thing we were looking for */
-                    result = true;
-                    break;
-                }
-                else
-                {
-                    /* continue looking, there's more  */
-                    reportedPropertyPath = slashPos + 1;
-                }
-            }
-            else
-            {
-                /* no model found, let's see if this is a property */
-                result = (VECTOR_find_if(modelType->reportedProperties, reportedPropertyExists, reportedPropertyPath) != NULL);
-                if (!result)
-                {
-                    LogError("no such reported property \"%s\"", reportedPropertyPath);
-                }
-                break;
-            }
-        } while (slashPos != NULL);
+        /*Codes_SRS_SCHEMA_02_022: [ If the path reportedPropertyPath points to a sub-model, Schema_ModelReportedPropertyByPathExists shall succeed and true. ]*/
+        result = (entry != NULL) && ((entry->kinds & (SCHEMA_PATH_INDEX_REPORTED_PROPERTY | SCHEMA_PATH_INDEX_MODEL_IN_MODEL)) != 0);
+        if (!result)
+        {
+            LogError("no such reported property \"%s\"", reportedPropertyPath);
+        }
     }
 
     return result;
@@ -2773,7 +3115,20 @@ SCHEMA_RESULT Schema_AddModelDesiredProperty(SCHEMA_MODEL_TYPE_HANDLE modelTypeH
                             desiredProperty->desiredPropertDeinitialize = desiredPropertyDeinitialize;
                             desiredProperty->onDesiredProperty = onDesiredProperty; /*NULL is a perfectly fine value*/
                             desiredProperty->offset = offset;
-                            result = SCHEMA_OK;
+                            if (UpdatePathIndexes(handleData) != 0)
+                            {
+                                /*Codes_SRS_SCHEMA_02_028: [ If any failure occurs then Schema_AddModelDesiredProperty shall fail and return SCHEMA_ERROR. ]*/
+                                LogError("unable to index the desired property %s", desiredPropertyName);
+                                VECTOR_erase(handleData->desiredProperties, VECTOR_back(handleData->desiredProperties), 1);
+                                free((void*)desiredProperty->desiredPropertyType);
+                                free((void*)desiredProperty->desiredPropertyName);
+                                free(desiredProperty);
+                                result = SCHEMA_ERROR;
+                            }
+                            else
+                            {
+                                result = SCHEMA_OK;
+                            }
                         }
                     }
                 }
@@ -2882,71 +3237,23 @@ bool Schema_ModelDesiredPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeH
     }
     else
     {
-        const char* slashPos;
+        const SCHEMA_PATH_INDEX_ENTRY* entry;
 
         /*Codes_SRS_SCHEMA_02_044: [ If the desired property cannot be found Schema_ModelDesiredPropertyByPathExists shall fail and return false. ]*/
-        result = false;
-
         /*Codes_SRS_SCHEMA_02_043: [ desiredPropertyPath shall be assumed to be in the format model1/model2/.../desiredPropertyName. ]*/
         if (*desiredPropertyPath == '/')
         {
             desiredPropertyPath++;
         }
 
-        do
-        {
-            const char* endPos;
-            size_t i;
-            size_t modelCount;
-            SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
-
-            slashPos = strchr(desiredPropertyPath, '/');
-            endPos = slashPos;
-            if (endPos == NULL)
-            {
-                endPos = &desiredPropertyPath[strlen(desiredPropertyPath)];
-            }
+        entry = FindPathIndexEntry((SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle, desiredPropertyPath, strlen(desiredPropertyPath));
 
-            modelCount = VECTOR_size(modelType->models);
-            for (i = 0; i < modelCount; i++)
-            {
-                MODEL_IN_MODEL* childModel = (MODEL_IN_MODEL*)VECTOR_element(modelType->models, i);
-                if ((strncmp(childModel->propertyName, desiredPropertyPath, endPos - desiredPropertyPath) == 0) &&
-                    (strlen(childModel->propertyName) == (size_t)(endPos - desiredPropertyPath)))
-                {
-                    /* found */
-                    modelTypeHandle = childModel->modelHandle;
-                    break;
-                }
-            }
-
-            if (i < modelCount)
-            {
-                /* model found, check if there is more in the path */
-                if (slashPos == NULL)
-                {
-                    /*Codes_SRS_SCHEMA_02_045: [ If the path desiredPropertyPath points to a sub-model, Schema_ModelDesiredPropertyByPathExists shall succeed and true. ]*/
-                    /* this is the last one, so this is the thing we were looking for */
-                    result = true;
-                    break;
-                }
-                else
-                {
-                    /* continue looking, there's more  */
-                    desiredPropertyPath = slashPos + 1;
-                }
-            }
-            else
-            {
-                /* no model found, let's see if this is a property */
-                result = (VECTOR_find_if(modelType->desiredProperties, desiredPropertyExists, desiredPropertyPath) != NULL);
-                if (!result)
-                {
-                    LogError("no such desired property \"%s\"", desiredPropertyPath);
-                }
-                break;
-            }
-        } while (slashPos != NULL);
+        /*Codes_SRS_SCHEMA_02_045: [ If the path desiredPropertyPath points to a sub-model, Schema_ModelDesiredPropertyByPathExists shall succeed and true. ]*/
+        result = (entry != NULL) && ((entry->kinds & (SCHEMA_PATH_INDEX_DESIRED_PROPERTY | SCHEMA_PATH_INDEX_MODEL_IN_MODEL)) != 0);
+        if (!result)
+        {
+            LogError("no such desired property \"%s\"", desiredPropertyPath);
+        }
     }
     return result;
 }
@@ -3042,89 +3349,43 @@ SCHEMA_MODEL_ELEMENT Schema_GetModelElementByName(SCHEMA_MODEL_TYPE_HANDLE model
     }
     else
     {
-        SCHEMA_MODEL_TYPE_HANDLE_DATA* handleData = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
+        const SCHEMA_PATH_INDEX_ENTRY* entry = FindPathIndexEntry((SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle, elementName, strlen(elementName));
 
-        SCHEMA_DESIRED_PROPERTY_HANDLE* desiredPropertyHandle = VECTOR_find_if(handleData->desiredProperties, desiredPropertyExists, elementName);
-        if (desiredPropertyHandle != NULL)
+        /*only the elements of the model itself are considered, not the ones reachable through its models in model*/
+        if ((entry == NULL) || (entry->depth != 0))
+        {
+            /*Codes_SRS_SCHEMA_02_083: [ Otherwise Schema_GetModelElementByName shall fail and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_NOT_FOUND. ]*/
+            result.elementType = SCHEMA_NOT_FOUND;
+        }
+        else if ((entry->kinds & SCHEMA_PATH_INDEX_DESIRED_PROPERTY) != 0)
         {
             /*Codes_SRS_SCHEMA_02_080: [ If elementName is a desired property then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_DESIRED_PROPERTY and SCHEMA_MODEL_ELEMENT.elementHandle.desiredPropertyHandle to the handle of the desired property. ]*/
             result.elementType = SCHEMA_DESIRED_PROPERTY;
-            result.elementHandle.desiredPropertyHandle = *desiredPropertyHandle;
+            result.elementHandle.desiredPropertyHandle = entry->descriptor.desiredPropertyHandle;
+        }
+        else if ((entry->kinds & SCHEMA_PATH_INDEX_PROPERTY) != 0)
+        {
+            /*Codes_SRS_SCHEMA_02_078: [ If elementName is a property then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_PROPERTY and SCHEMA_MODEL_ELEMENT.elementHandle.propertyHandle to the handle of the property. ]*/
+            result.elementType = SCHEMA_PROPERTY;
+            result.elementHandle.propertyHandle = entry->descriptor.propertyHandle;
+        }
+        else if ((entry->kinds & SCHEMA_PATH_INDEX_REPORTED_PROPERTY) != 0)
+        {
+            /*Codes_SRS_SCHEMA_02_079: [ If elementName is a reported property then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_REPORTED_PROPERTY and SCHEMA_MODEL_ELEMENT.elementHandle.reportedPropertyHandle to the handle of the reported property. ]*/
+            result.elementType = SCHEMA_REPORTED_PROPERTY;
+            result.elementHandle.reportedPropertyHandle = entry->descriptor.reportedPropertyHandle;
+        }
+        else if ((entry->kinds & SCHEMA_PATH_INDEX_ACTION) != 0)
+        {
+            /*Codes_SRS_SCHEMA_02_081: [ If elementName is a model action then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_MODEL_ACTION and SCHEMA_MODEL_ELEMENT.elementHandle.actionHandle to the handle of the action. ]*/
+            result.elementType = SCHEMA_MODEL_ACTION;
+            result.elementHandle.actionHandle = entry->descriptor.actionHandle;
         }
         else
         {
-            size_t nProcessedProperties = 0;
-            SCHEMA_PROPERTY_HANDLE_DATA* property = NULL;
-            for (size_t i = 0; i < handleData->PropertyCount;i++)
-            {
-                property = (SCHEMA_PROPERTY_HANDLE_DATA*)(handleData->Properties[i]);
-                if (strcmp(property->PropertyName, elementName) == 0)
-                {
-                    i = handleData->PropertyCount; /*found it*/
-                }
-                else
-                {
-                    nProcessedProperties++;
-                }
-            }
-
-            if (nProcessedProperties < handleData->PropertyCount)
-            {
-                /*Codes_SRS_SCHEMA_02_078: [ If elementName is a property then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_PROPERTY and SCHEMA_MODEL_ELEMENT.elementHandle.propertyHandle to the handle of the property. ]*/
-                result.elementType = SCHEMA_PROPERTY;
-                result.elementHandle.propertyHandle = property;
-            }
-            else
-            {
-
-                SCHEMA_REPORTED_PROPERTY_HANDLE* reportedPropertyHandle = VECTOR_find_if(handleData->reportedProperties, reportedPropertyExists, elementName);
-                if (reportedPropertyHandle != NULL)
-                {
-                    /*Codes_SRS_SCHEMA_02_079: [ If elementName is a reported property then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_REPORTED_PROPERTY and SCHEMA_MODEL_ELEMENT.elementHandle.reportedPropertyHandle to the handle of the reported property. ]*/
-                    result.elementType = SCHEMA_REPORTED_PROPERTY;
-                    result.elementHandle.reportedPropertyHandle = *reportedPropertyHandle;
-                }
-                else
-                {
-
-                    size_t nProcessedActions = 0;
-                    SCHEMA_ACTION_HANDLE_DATA* actionHandleData = NULL;
-                    for (size_t i = 0;i < handleData->ActionCount; i++)
-                    {
-                        actionHandleData = (SCHEMA_ACTION_HANDLE_DATA*)(handleData->Actions[i]);
-                        if (strcmp(actionHandleData->ActionName, elementName) == 0)
-                        {
-                            i = handleData->ActionCount; /*get out quickly*/
-                        }
-                        else
-                        {
-                            nProcessedActions++;
-                        }
-                    }
-
-                    if (nProcessedActions < handleData->ActionCount)
-                    {
-                        /*Codes_SRS_SCHEMA_02_081: [ If elementName is a model action then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_MODEL_ACTION and SCHEMA_MODEL_ELEMENT.elementHandle.actionHandle to the handle of the action. ]*/
-                        result.elementType = SCHEMA_MODEL_ACTION;
-                        result.elementHandle.actionHandle = actionHandleData;
-                    }
-                    else
-                    {
-                        MODEL_IN_MODEL* modelInModel = VECTOR_find_if(handleData->models, modelInModelExists, elementName);
-                        if (modelInModel != NULL)
-                        {
-                            /*Codes_SRS_SCHEMA_02_082: [ If elementName is a model in model then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_MODEL_IN_MODEL and SCHEMA_MODEL_ELEMENT.elementHandle.modelHandle to the handle of the model. ]*/
-                            result.elementType = SCHEMA_MODEL_IN_MODEL;
-                            result.elementHandle.modelHandle = modelInModel->modelHandle;
-                        }
-                        else
-                        {
-                            /*Codes_SRS_SCHEMA_02_083: [ Otherwise Schema_GetModelElementByName shall fail and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_NOT_FOUND. ]*/
-                            result.elementType = SCHEMA_NOT_FOUND;
-                        }
-                    }
-                }
-            }
+            /*Codes_SRS_SCHEMA_02_082: [ If elementName is a model in model then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_MODEL_IN_MODEL and SCHEMA_MODEL_ELEMENT.elementHandle.modelHandle to the handle of the model. ]*/
+            result.elementType = SCHEMA_MODEL_IN_MODEL;
+            result.elementHandle.modelHandle = entry->descriptor.modelHandle;
         }
     }
     return result;
@@ -3218,3 +3479,100 @@ void* Schema_GetMetadata(SCHEMA_HANDLE schemaHandle)
     }
     return result;
 }
+
+SCHEMA_RESULT Schema_GetModelPathDescriptor(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* path, SCHEMA_PATH_DESCRIPTOR* descriptor)
+{
+    SCHEMA_RESULT result;
+
+    if ((modelTypeHandle == NULL) ||
+        (path == NULL) ||
+        (descriptor == NULL))
+    {
+        LogError("invalid arg SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle=%p, const char* path=%p, SCHEMA_PATH_DESCRIPTOR* descriptor=%p", modelTypeHandle, path, descriptor);
+        result = SCHEMA_INVALID_ARG;
+    }
+    else
+    {
+        const SCHEMA_PATH_INDEX_ENTRY* entry;
+
+        if (*path == '/')
+        {
+            path++;
+        }
+
+        if ((entry = FindPathIndexEntry((SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle, path, strlen(path))) == NULL)
+        {
+            result = SCHEMA_ELEMENT_NOT_FOUND;
+        }
+        else
+        {
+            *descriptor = entry->descriptor;
+            result = SCHEMA_OK;
+        }
+    }
+
+    return result;
+}
+
+SCHEMA_RESULT Schema_GetModelPathId(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* path, size_t* id)
+{
+    SCHEMA_RESULT result;
+
+    if ((modelTypeHandle == NULL) ||
+        (path == NULL) ||
+        (id == NULL))
+    {
+        LogError("invalid arg SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle=%p, const char* path=%p, size_t* id=%p", modelTypeHandle, path, id);
+        result = SCHEMA_INVALID_ARG;
+    }
+    else
+    {
+        const SCHEMA_PATH_INDEX_ENTRY* entry;
+
+        if (*path == '/')
+        {
+            path++;
+        }
+
+        if ((entry = FindPathIndexEntry((SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle, path, strlen(path))) == NULL)
+        {
+            result = SCHEMA_ELEMENT_NOT_FOUND;
+        }
+        else
+        {
+            /*the ids follow the order in which the model declares its elements (properties, reported properties, desired properties, actions, models in model and what is in them)*/
+            /*so they are the same for every device built from the same model*/
+            *id = entry->descriptor.id;
+            result = SCHEMA_OK;
+        }
+    }
+
+    return result;
+}
+
+const char* Schema_GetModelPathById(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, size_t id)
+{
+    const char* result;
+
+    if (modelTypeHandle == NULL)
+    {
+        LogError("invalid arg SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle=%p", modelTypeHandle);
+        result = NULL;
+    }
+    else
+    {
+        SCHEMA_PATH_INDEX* pathIndex = ((SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle)->pathIndex;
+        if ((pathIndex == NULL) ||
+            (id >= pathIndex->entryCount))
+        {
+            LogError("there is no path with id %lu", (unsigned long)id);
+            result = NULL;
+        }
+        else
+        {
+            result = pathIndex->pathsById[id];
+        }
+    }
+
+    return result;
+}
@@ -84,6 +84,11 @@ SERIALIZER_RESULT serializer_setconfig(SERIALIZER_CONFIG which, void* value)
         DataPublisher_SetMaxBufferSize(*(size_t*)value);
         result = SERIALIZER_OK;
     }
+    else if (which == SerializePayloadEncoding)
+    {
+        DataMarshaller_SetDefaultEncoding(*(PAYLOAD_ENCODING*)value);
+        result = SERIALIZER_OK;
+    }
     /* Codes_SRS_SCHEMALIB_99_138:[ If the which argument is not one of the declared members of the SERIALIZER_CONFIG enum, serializer_setconfig shall return SERIALIZER_INVALID_ARG.] */
     else
     {
@@ -199,6 +199,9 @@ public:
     }
     MOCK_METHOD_END(STRING_HANDLE, result2)
 
+    MOCK_STATIC_METHOD_1(, STRING_HANDLE, STRING_new_with_memory, const char*, memory)
+    MOCK_METHOD_END(STRING_HANDLE, BASEIMPLEMENTATION::STRING_new_with_memory(memory))
+
     /* JSONEncoder mocks */
     MOCK_STATIC_METHOD_3(, JSON_ENCODER_RESULT, JSONEncoder_EncodeTree, MULTITREE_HANDLE, treeHandle, STRING_HANDLE, buffer, JSON_ENCODER_TOSTRING_FUNC, toStringFunc)
     MOCK_METHOD_END(JSON_ENCODER_RESULT, JSON_ENCODER_OK)
@@ -223,6 +226,7 @@ DECLARE_GLOBAL_MOCK_METHOD_1(CMocksForAgentTypeSytem, , STRING_HANDLE, STRING_cl
 DECLARE_GLOBAL_MOCK_METHOD_1(CMocksForAgentTypeSytem, , STRING_HANDLE, STRING_construct, const char*, s);
 DECLARE_GLOBAL_MOCK_METHOD_2(CMocksForAgentTypeSytem, , int, STRING_concat_with_STRING, STRING_HANDLE, s1, STRING_HANDLE, s2);
 DECLARE_GLOBAL_MOCK_METHOD_2(CMocksForAgentTypeSytem, , STRING_HANDLE, STRING_construct_n, const char*, s, size_t, n);
+DECLARE_GLOBAL_MOCK_METHOD_1(CMocksForAgentTypeSytem, , STRING_HANDLE, STRING_new_with_memory, const char*, memory);
 
 
 
@@ -4638,6 +4642,54 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(float, TEST_FLOAT_2, (float)atof(STRING_c_str(global_bufferTemp)));
 
         }
+
+        TEST_FUNCTION(AgentDataTypes_FloatingPointToString_prints_the_shortest_text_that_reads_back_the_same)
+        {
+            ///arrange
+            char text[AGENT_DATA_TYPES_FLOATING_POINT_STRING_SIZE];
+
+            ///act
+            auto res1 = AgentDataTypes_FloatingPointToString(text, sizeof(text), 0.1, 0);
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res1);
+            ASSERT_ARE_EQUAL(char_ptr, "0.1", text);
+
+            ///act
+            auto res2 = AgentDataTypes_FloatingPointToString(text, sizeof(text), (double)0.1f, 1);
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res2);
+            ASSERT_ARE_EQUAL(char_ptr, "0.1", text);
+
+            ///act
+            auto res3 = AgentDataTypes_FloatingPointToString(text, sizeof(text), -DBL_MAX, 0);
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res3);
+            ASSERT_ARE_EQUAL(char_ptr, "-1.7976931348623157e+308", text);
+        }
+
+        TEST_FUNCTION(AgentDataTypes_FloatingPointToString_with_NaN_fails)
+        {
+            ///arrange
+            char text[AGENT_DATA_TYPES_FLOATING_POINT_STRING_SIZE];
+
+            ///act
+            auto res = AgentDataTypes_FloatingPointToString(text, sizeof(text), numeric_limits<double>::quiet_NaN(), 0);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, res);
+        }
+
+        TEST_FUNCTION(AgentDataTypes_FloatingPointToString_with_a_too_small_destination_fails)
+        {
+            ///arrange
+            char text[AGENT_DATA_TYPES_FLOATING_POINT_STRING_SIZE];
+
+            ///act
+            auto res = AgentDataTypes_FloatingPointToString(text, sizeof(text) - 1, 1.5, 0);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, res);
+        }
 #endif
 
         /*Tests_SRS_AGENT_TYPE_SYSTEM_99_043:[ Creates an AGENT_DATA_TYPE containing an EDM_INT16 from int16_t]*/
@@ -12256,6 +12308,103 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             Destroy_AGENT_DATA_TYPE(&agentData);
         }
 
+        /* Tests_SRS_AGENT_TYPE_SYSTEM_99_080:[ EDM_DOUBLE] */
+        TEST_FUNCTION(AgentTypeSystem_CreateAgentDataType_From_String_EDM_DOUBLE_Fast_Path_Fraction_Succeeds)
+        {
+            // arrange
+            AGENT_DATA_TYPE agentData;
+            const char* source = "-0.000123456789";
+
+            // act
+            AGENT_DATA_TYPES_RESULT result = CreateAgentDataType_From_String(source, EDM_DOUBLE_TYPE, &agentData);
+
+            // assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, result);
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPE_TYPE, EDM_DOUBLE_TYPE, agentData.type);
+            ASSERT_ARE_EQUAL(double, strtod(source, NULL), agentData.value.edmDouble.value);
+
+            // cleanup
+            Destroy_AGENT_DATA_TYPE(&agentData);
+        }
+
+        /* Tests_SRS_AGENT_TYPE_SYSTEM_99_080:[ EDM_DOUBLE] */
+        TEST_FUNCTION(AgentTypeSystem_CreateAgentDataType_From_String_EDM_DOUBLE_Too_Many_Digits_For_Fast_Path_Succeeds)
+        {
+            // arrange
+            AGENT_DATA_TYPE agentData;
+            const char* source = "3.14159265358979323846264338327950288";
+
+            // act
+            AGENT_DATA_TYPES_RESULT result = CreateAgentDataType_From_String(source, EDM_DOUBLE_TYPE, &agentData);
+
+            // assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, result);
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPE_TYPE, EDM_DOUBLE_TYPE, agentData.type);
+            ASSERT_ARE_EQUAL(double, strtod(source, NULL), agentData.value.edmDouble.value);
+
+            // cleanup
+            Destroy_AGENT_DATA_TYPE(&agentData);
+        }
+
+        /* Tests_SRS_AGENT_TYPE_SYSTEM_99_080:[ EDM_DOUBLE] */
+        TEST_FUNCTION(AgentTypeSystem_CreateAgentDataType_From_String_EDM_DOUBLE_Slow_Path_Longer_Than_The_Localized_Copy_Succeeds_With_A_Dot_Locale)
+        {
+            // arrange
+            AGENT_DATA_TYPE agentData;
+            const char* source =
+                "0.1000000000000000055511151231257827021181583404541015625"
+                "0000000000000000000000000000000000000000000000000000000000000000000000000000000000";
+
+            // act
+            AGENT_DATA_TYPES_RESULT result = CreateAgentDataType_From_String(source, EDM_DOUBLE_TYPE, &agentData);
+
+            // assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, result);
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPE_TYPE, EDM_DOUBLE_TYPE, agentData.type);
+            ASSERT_ARE_EQUAL(double, strtod(source, NULL), agentData.value.edmDouble.value);
+
+            // cleanup
+            Destroy_AGENT_DATA_TYPE(&agentData);
+        }
+
+        /* Tests_SRS_AGENT_TYPE_SYSTEM_99_080:[ EDM_DOUBLE] */
+        TEST_FUNCTION(AgentTypeSystem_CreateAgentDataType_From_String_EDM_DOUBLE_Big_Exponent_Succeeds)
+        {
+            // arrange
+            AGENT_DATA_TYPE agentData;
+            const char* source = "1.5e200";
+
+            // act
+            AGENT_DATA_TYPES_RESULT result = CreateAgentDataType_From_String(source, EDM_DOUBLE_TYPE, &agentData);
+
+            // assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, result);
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPE_TYPE, EDM_DOUBLE_TYPE, agentData.type);
+            ASSERT_ARE_EQUAL(double, strtod(source, NULL), agentData.value.edmDouble.value);
+
+            // cleanup
+            Destroy_AGENT_DATA_TYPE(&agentData);
+        }
+
+        /* Tests_SRS_AGENT_TYPE_SYSTEM_99_080:[ EDM_DOUBLE] */
+        TEST_FUNCTION(AgentTypeSystem_CreateAgentDataType_From_String_EDM_DOUBLE_Dot_Without_Digits_Is_Parsed_Like_strtod)
+        {
+            // arrange
+            AGENT_DATA_TYPE agentData;
+            const char* source = "12.";
+
+            // act
+            AGENT_DATA_TYPES_RESULT result = CreateAgentDataType_From_String(source, EDM_DOUBLE_TYPE, &agentData);
+
+            // assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, result);
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPE_TYPE, EDM_DOUBLE_TYPE, agentData.type);
+            ASSERT_ARE_EQUAL(double, (double)12.0, agentData.value.edmDouble.value);
+
+            // cleanup
+            Destroy_AGENT_DATA_TYPE(&agentData);
+        }
+
         /* Tests_SRS_AGENT_TYPE_SYSTEM_99_089:[EDM_SINGLE] */
         TEST_FUNCTION(AgentTypeSystem_CreateAgentDataType_From_String_EDM_SINGLE_Positive_Value_Succeeds)
         {
@@ -12469,6 +12618,44 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             // cleanup
             Destroy_AGENT_DATA_TYPE(&agentData);
         }
+
+        /* Tests_SRS_AGENT_TYPE_SYSTEM_99_089:[EDM_SINGLE] */
+        TEST_FUNCTION(AgentTypeSystem_CreateAgentDataType_From_String_EDM_SINGLE_Fast_Path_Fraction_Succeeds)
+        {
+            // arrange
+            AGENT_DATA_TYPE agentData;
+            const char* source = "-21.375";
+
+            // act
+            AGENT_DATA_TYPES_RESULT result = CreateAgentDataType_From_String(source, EDM_SINGLE_TYPE, &agentData);
+
+            // assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, result);
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPE_TYPE, EDM_SINGLE_TYPE, agentData.type);
+            ASSERT_ARE_EQUAL(float, strtof(source, NULL), agentData.value.edmSingle.value);
+
+            // cleanup
+            Destroy_AGENT_DATA_TYPE(&agentData);
+        }
+
+        /* Tests_SRS_AGENT_TYPE_SYSTEM_99_089:[EDM_SINGLE] */
+        TEST_FUNCTION(AgentTypeSystem_CreateAgentDataType_From_String_EDM_SINGLE_Too_Many_Digits_For_Fast_Path_Succeeds)
+        {
+            // arrange
+            AGENT_DATA_TYPE agentData;
+            const char* source = "0.123456789012";
+
+            // act
+            AGENT_DATA_TYPES_RESULT result = CreateAgentDataType_From_String(source, EDM_SINGLE_TYPE, &agentData);
+
+            // assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, result);
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPE_TYPE, EDM_SINGLE_TYPE, agentData.type);
+            ASSERT_ARE_EQUAL(float, strtof(source, NULL), agentData.value.edmSingle.value);
+
+            // cleanup
+            Destroy_AGENT_DATA_TYPE(&agentData);
+        }
 #endif
 
         /* Tests_SRS_AGENT_TYPE_SYSTEM_99_079:[ EDM_DECIMAL] */
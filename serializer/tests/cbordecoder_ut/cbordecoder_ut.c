@@ -0,0 +1,400 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+void* my_gballoc_malloc(size_t t)
+{
+    return malloc(t);
+}
+
+void* my_gballoc_realloc(void* v, size_t t)
+{
+    return realloc(v, t);
+}
+
+void my_gballoc_free(void * t)
+{
+    free(t);
+}
+
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+#include "umocktypes_c.h"
+#include "umocktypes_stdint.h"
+
+/*the tree and the strings are the real ones, the leaves are checked after decoding*/
+#include "azure_c_shared_utility/strings.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "multitree.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "agenttypesystem.h"
+#include "schema.h"
+#undef ENABLE_MOCKS
+
+#include "testrunnerswitcher.h"
+#include "cbordecoder.h"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+#define TEST_MODEL_HANDLE ((SCHEMA_MODEL_TYPE_HANDLE)0x4242)
+
+TEST_DEFINE_ENUM_TYPE(CBOR_DECODER_RESULT, CBOR_DECODER_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(CBOR_DECODER_RESULT, CBOR_DECODER_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_RESULT_VALUES);
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+static AGENT_DATA_TYPES_RESULT my_AgentDataTypes_ToString(STRING_HANDLE destination, const AGENT_DATA_TYPE* value)
+{
+    (void)value;
+    return (STRING_concat(destination, "\"AQI\"") == 0) ? AGENT_DATA_TYPES_OK : AGENT_DATA_TYPES_ERROR;
+}
+
+static AGENT_DATA_TYPES_RESULT my_AgentDataTypes_FloatingPointToString(char* destination, size_t destinationSize, double value, int isSinglePrecision)
+{
+    (void)destinationSize;
+    (void)isSinglePrecision;
+    (void)sprintf(destination, "%g", value);
+    return AGENT_DATA_TYPES_OK;
+}
+
+static const char* my_Schema_GetModelPathById(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, size_t id)
+{
+    (void)modelTypeHandle;
+    return (id == 0) ? "temperature" : (id == 3) ? "inner/pressure" : NULL;
+}
+
+static const char* GetLeaf(MULTITREE_HANDLE tree, const char* path)
+{
+    const void* value;
+    ASSERT_ARE_EQUAL(int, (int)MULTITREE_OK, (int)MultiTree_GetLeafValue(tree, path, &value));
+    return (const char*)value;
+}
+
+BEGIN_TEST_SUITE(CBORDecoder_ut)
+
+    TEST_SUITE_INITIALIZE(TestClassInitialize)
+    {
+        TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+        g_testByTest = TEST_MUTEX_CREATE();
+        ASSERT_IS_NOT_NULL(g_testByTest);
+
+        (void)umock_c_init(on_umock_c_error);
+        (void)umocktypes_charptr_register_types();
+        (void)umocktypes_c_register_types();
+        (void)umocktypes_stdint_register_types();
+
+        REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(SCHEMA_MODEL_TYPE_HANDLE, void*);
+        REGISTER_TYPE(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_RESULT);
+
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+        REGISTER_GLOBAL_MOCK_HOOK(AgentDataTypes_ToString, my_AgentDataTypes_ToString);
+        REGISTER_GLOBAL_MOCK_HOOK(AgentDataTypes_FloatingPointToString, my_AgentDataTypes_FloatingPointToString);
+        REGISTER_GLOBAL_MOCK_HOOK(Schema_GetModelPathById, my_Schema_GetModelPathById);
+    }
+
+    TEST_SUITE_CLEANUP(TestClassCleanup)
+    {
+        umock_c_deinit();
+
+        TEST_MUTEX_DESTROY(g_testByTest);
+        TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    }
+
+    TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+    {
+        if (TEST_MUTEX_ACQUIRE(g_testByTest))
+        {
+            ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+        }
+
+        umock_c_reset_all_calls();
+    }
+
+    TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+    {
+        TEST_MUTEX_RELEASE(g_testByTest);
+    }
+
+    TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_with_NULL_cbor_fails)
+    {
+        // arrange
+        MULTITREE_HANDLE tree;
+
+        // act
+        CBOR_DECODER_RESULT result = CBORDecoder_CBOR_To_MultiTree(NULL, 1, NULL, &tree);
+
+        // assert
+        ASSERT_ARE_EQUAL(CBOR_DECODER_RESULT, CBOR_DECODER_INVALID_ARG, result);
+    }
+
+    TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_with_NULL_multiTreeHandle_fails)
+    {
+        // arrange
+        static const unsigned char cbor[] = { 0xA0 };
+
+        // act
+        CBOR_DECODER_RESULT result = CBORDecoder_CBOR_To_MultiTree(cbor, sizeof(cbor), NULL, NULL);
+
+        // assert
+        ASSERT_ARE_EQUAL(CBOR_DECODER_RESULT, CBOR_DECODER_INVALID_ARG, result);
+    }
+
+    TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_with_a_root_that_is_not_a_map_or_an_array_fails)
+    {
+        // arrange
+        static const unsigned char cbor[] = { 0x01 };
+        MULTITREE_HANDLE tree;
+
+        // act
+        CBOR_DECODER_RESULT result = CBORDecoder_CBOR_To_MultiTree(cbor, sizeof(cbor), NULL, &tree);
+
+        // assert
+        ASSERT_ARE_EQUAL(CBOR_DECODER_RESULT, CBOR_DECODER_PARSE_ERROR, result);
+    }
+
+    TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_decodes_integers_and_simple_values_to_their_JSON_text)
+    {
+        // arrange
+        /*{"a": 1, "b": -500, "c": true, "d": false, "e": null}*/
+        static const unsigned char cbor[] = { 0xA5, 0x61, 'a', 0x01, 0x61, 'b', 0x39, 0x01, 0xF3, 0x61, 'c', 0xF5, 0x61, 'd', 0xF4, 0x61, 'e', 0xF6 };
+        MULTITREE_HANDLE tree;
+
+        // act
+        CBOR_DECODER_RESULT result = CBORDecoder_CBOR_To_MultiTree(cbor, sizeof(cbor), NULL, &tree);
+
+        // assert
+        ASSERT_ARE_EQUAL(CBOR_DECODER_RESULT, CBOR_DECODER_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, "1", GetLeaf(tree, "a"));
+        ASSERT_ARE_EQUAL(char_ptr, "-500", GetLeaf(tree, "b"));
+        ASSERT_ARE_EQUAL(char_ptr, "true", GetLeaf(tree, "c"));
+        ASSERT_ARE_EQUAL(char_ptr, "false", GetLeaf(tree, "d"));
+        ASSERT_ARE_EQUAL(char_ptr, "null", GetLeaf(tree, "e"));
+
+        // cleanup
+        MultiTree_Destroy(tree);
+    }
+
+    TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_decodes_text_strings_quoted_and_escaped_like_the_JSON_decoder_leaves_them)
+    {
+        // arrange
+        /*{"s": "a\"b"}*/
+        static const unsigned char cbor[] = { 0xA1, 0x61, 's', 0x63, 'a', '"', 'b' };
+        MULTITREE_HANDLE tree;
+
+        // act
+        CBOR_DECODER_RESULT result = CBORDecoder_CBOR_To_MultiTree(cbor, sizeof(cbor), NULL, &tree);
+
+        // assert
+        ASSERT_ARE_EQUAL(CBOR_DECODER_RESULT, CBOR_DECODER_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, "\"a\\\"b\"", GetLeaf(tree, "s"));
+
+        // cleanup
+        MultiTree_Destroy(tree);
+    }
+
+    TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_prints_floats_with_the_precision_they_were_encoded_with)
+    {
+        // arrange
+        /*{"h": 1.5 (half), "f": 21.5 (float32), "d": 0.1 (float64), "n": NaN (float32)}*/
+        static const unsigned char cbor[] = { 0xA4,
+            0x61, 'h', 0xF9, 0x3E, 0x00,
+            0x61, 'f', 0xFA, 0x41, 0xAC, 0x00, 0x00,
+            0x61, 'd', 0xFB, 0x3F, 0xB9, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9A,
+            0x61, 'n', 0xFA, 0x7F, 0xC0, 0x00, 0x00 };
+        MULTITREE_HANDLE tree;
+
+        STRICT_EXPECTED_CALL(AgentDataTypes_FloatingPointToString(IGNORED_PTR_ARG, IGNORED_NUM_ARG, 1.5, 1))
+            .IgnoreArgument_destination()
+            .IgnoreArgument_destinationSize();
+        STRICT_EXPECTED_CALL(AgentDataTypes_FloatingPointToString(IGNORED_PTR_ARG, IGNORED_NUM_ARG, 21.5, 1))
+            .IgnoreArgument_destination()
+            .IgnoreArgument_destinationSize();
+        STRICT_EXPECTED_CALL(AgentDataTypes_FloatingPointToString(IGNORED_PTR_ARG, IGNORED_NUM_ARG, 0.1, 0))
+            .IgnoreArgument_destination()
+            .IgnoreArgument_destinationSize();
+
+        // act
+        CBOR_DECODER_RESULT result = CBORDecoder_CBOR_To_MultiTree(cbor, sizeof(cbor), NULL, &tree);
+
+        // assert
+        ASSERT_ARE_EQUAL(CBOR_DECODER_RESULT, CBOR_DECODER_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, "1.5", GetLeaf(tree, "h"));
+        ASSERT_ARE_EQUAL(char_ptr, "21.5", GetLeaf(tree, "f"));
+        ASSERT_ARE_EQUAL(char_ptr, "0.1", GetLeaf(tree, "d"));
+        ASSERT_ARE_EQUAL(char_ptr, "\"NaN\"", GetLeaf(tree, "n"));
+
+        // cleanup
+        MultiTree_Destroy(tree);
+    }
+
+    TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_names_array_elements_by_their_index)
+    {
+        // arrange
+        /*[10, [20]]*/
+        static const unsigned char cbor[] = { 0x82, 0x0A, 0x81, 0x14 };
+        MULTITREE_HANDLE tree;
+
+        // act
+        CBOR_DECODER_RESULT result = CBORDecoder_CBOR_To_MultiTree(cbor, sizeof(cbor), NULL, &tree);
+
+        // assert
+        ASSERT_ARE_EQUAL(CBOR_DECODER_RESULT, CBOR_DECODER_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, "10", GetLeaf(tree, "0"));
+        ASSERT_ARE_EQUAL(char_ptr, "20", GetLeaf(tree, "1/0"));
+
+        // cleanup
+        MultiTree_Destroy(tree);
+    }
+
+    TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_decodes_byte_strings_as_base64_text)
+    {
+        // arrange
+        /*{"x": h'0102'}*/
+        static const unsigned char cbor[] = { 0xA1, 0x61, 'x', 0x42, 0x01, 0x02 };
+        MULTITREE_HANDLE tree;
+
+        STRICT_EXPECTED_CALL(AgentDataTypes_ToString(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreAllArguments();
+
+        // act
+        CBOR_DECODER_RESULT result = CBORDecoder_CBOR_To_MultiTree(cbor, sizeof(cbor), NULL, &tree);
+
+        // assert
+        ASSERT_ARE_EQUAL(CBOR_DECODER_RESULT, CBOR_DECODER_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, "\"AQI\"", GetLeaf(tree, "x"));
+
+        // cleanup
+        MultiTree_Destroy(tree);
+    }
+
+    TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_resolves_key_ids_to_paths_of_the_model)
+    {
+        // arrange
+        /*{0: 21.5, 3: 7}*/
+        static const unsigned char cbor[] = { 0xA2, 0x00, 0xFA, 0x41, 0xAC, 0x00, 0x00, 0x03, 0x07 };
+        MULTITREE_HANDLE tree;
+
+        STRICT_EXPECTED_CALL(Schema_GetModelPathById(TEST_MODEL_HANDLE, 0));
+        STRICT_EXPECTED_CALL(Schema_GetModelPathById(TEST_MODEL_HANDLE, 3));
+
+        // act
+        CBOR_DECODER_RESULT result = CBORDecoder_CBOR_To_MultiTree(cbor, sizeof(cbor), TEST_MODEL_HANDLE, &tree);
+
+        // assert
+        ASSERT_ARE_EQUAL(CBOR_DECODER_RESULT, CBOR_DECODER_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, "21.5", GetLeaf(tree, "temperature"));
+        ASSERT_ARE_EQUAL(char_ptr, "7", GetLeaf(tree, "inner/pressure"));
+
+        // cleanup
+        MultiTree_Destroy(tree);
+    }
+
+    TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_with_an_unknown_key_id_fails)
+    {
+        // arrange
+        /*{5: 1}*/
+        static const unsigned char cbor[] = { 0xA1, 0x05, 0x01 };
+        MULTITREE_HANDLE tree;
+
+        // act
+        CBOR_DECODER_RESULT result = CBORDecoder_CBOR_To_MultiTree(cbor, sizeof(cbor), TEST_MODEL_HANDLE, &tree);
+
+        // assert
+        ASSERT_ARE_EQUAL(CBOR_DECODER_RESULT, CBOR_DECODER_UNKNOWN_KEY_ID, result);
+    }
+
+    TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_with_a_key_id_and_no_model_fails)
+    {
+        // arrange
+        /*{0: 1}*/
+        static const unsigned char cbor[] = { 0xA1, 0x00, 0x01 };
+        MULTITREE_HANDLE tree;
+
+        // act
+        CBOR_DECODER_RESULT result = CBORDecoder_CBOR_To_MultiTree(cbor, sizeof(cbor), NULL, &tree);
+
+        // assert
+        ASSERT_ARE_EQUAL(CBOR_DECODER_RESULT, CBOR_DECODER_UNKNOWN_KEY_ID, result);
+    }
+
+    TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_with_an_indefinite_length_map_fails)
+    {
+        // arrange
+        static const unsigned char cbor[] = { 0xBF, 0x61, 'a', 0x01, 0xFF };
+        MULTITREE_HANDLE tree;
+
+        // act
+        CBOR_DECODER_RESULT result = CBORDecoder_CBOR_To_MultiTree(cbor, sizeof(cbor), NULL, &tree);
+
+        // assert
+        ASSERT_ARE_EQUAL(CBOR_DECODER_RESULT, CBOR_DECODER_PARSE_ERROR, result);
+    }
+
+    TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_with_truncated_data_fails)
+    {
+        // arrange
+        /*the text string says 5 bytes, only 2 follow*/
+        static const unsigned char cbor[] = { 0xA1, 0x61, 'a', 0x65, 'h', 'e' };
+        MULTITREE_HANDLE tree;
+
+        // act
+        CBOR_DECODER_RESULT result = CBORDecoder_CBOR_To_MultiTree(cbor, sizeof(cbor), NULL, &tree);
+
+        // assert
+        ASSERT_ARE_EQUAL(CBOR_DECODER_RESULT, CBOR_DECODER_PARSE_ERROR, result);
+    }
+
+    TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_with_bytes_after_the_root_item_fails)
+    {
+        // arrange
+        static const unsigned char cbor[] = { 0xA0, 0x00 };
+        MULTITREE_HANDLE tree;
+
+        // act
+        CBOR_DECODER_RESULT result = CBORDecoder_CBOR_To_MultiTree(cbor, sizeof(cbor), NULL, &tree);
+
+        // assert
+        ASSERT_ARE_EQUAL(CBOR_DECODER_RESULT, CBOR_DECODER_PARSE_ERROR, result);
+    }
+
+    TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_with_too_deeply_nested_data_fails)
+    {
+        // arrange
+        unsigned char cbor[101];
+        MULTITREE_HANDLE tree;
+        (void)memset(cbor, 0x81, sizeof(cbor) - 1);
+        cbor[sizeof(cbor) - 1] = 0x01;
+
+        // act
+        CBOR_DECODER_RESULT result = CBORDecoder_CBOR_To_MultiTree(cbor, sizeof(cbor), NULL, &tree);
+
+        // assert
+        ASSERT_ARE_EQUAL(CBOR_DECODER_RESULT, CBOR_DECODER_PARSE_ERROR, result);
+    }
+
+END_TEST_SUITE(CBORDecoder_ut)
@@ -0,0 +1,426 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+void* my_gballoc_malloc(size_t t)
+{
+    return malloc(t);
+}
+
+void* my_gballoc_realloc(void* v, size_t t)
+{
+    return realloc(v, t);
+}
+
+void my_gballoc_free(void * t)
+{
+    free(t);
+}
+
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+#include "umocktypes_stdint.h"
+
+/*the tree and the strings are the real ones, the encoder output is checked byte by byte*/
+#include "azure_c_shared_utility/strings.h"
+#include "multitree.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "agenttypesystem.h"
+#undef ENABLE_MOCKS
+
+#include "testrunnerswitcher.h"
+#include "cborencoder.h"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+TEST_DEFINE_ENUM_TYPE(CBOR_ENCODER_RESULT, CBOR_ENCODER_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(CBOR_ENCODER_RESULT, CBOR_ENCODER_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_RESULT_VALUES);
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+static AGENT_DATA_TYPES_RESULT my_AgentDataTypes_ToString(STRING_HANDLE destination, const AGENT_DATA_TYPE* value)
+{
+    (void)value;
+    return (STRING_concat(destination, "\"12.50\"") == 0) ? AGENT_DATA_TYPES_OK : AGENT_DATA_TYPES_ERROR;
+}
+
+static int NoCloneFunction(void** destination, const void* source)
+{
+    *destination = (void*)source;
+    return 0;
+}
+
+static void NoFreeFunction(void* value)
+{
+    (void)value;
+}
+
+static AGENT_DATA_TYPE MakeInt32(int32_t v)
+{
+    AGENT_DATA_TYPE result;
+    result.type = EDM_INT32_TYPE;
+    result.value.edmInt32.value = v;
+    return result;
+}
+
+static AGENT_DATA_TYPE MakeDouble(double v)
+{
+    AGENT_DATA_TYPE result;
+    result.type = EDM_DOUBLE_TYPE;
+    result.value.edmDouble.value = v;
+    return result;
+}
+
+static void AssertEncodedAs(const unsigned char* expected, size_t expectedSize, const unsigned char* actual, size_t actualSize)
+{
+    ASSERT_ARE_EQUAL(size_t, expectedSize, actualSize);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(expected, actual, expectedSize));
+}
+
+BEGIN_TEST_SUITE(CBOREncoder_ut)
+
+    TEST_SUITE_INITIALIZE(TestClassInitialize)
+    {
+        TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+        g_testByTest = TEST_MUTEX_CREATE();
+        ASSERT_IS_NOT_NULL(g_testByTest);
+
+        (void)umock_c_init(on_umock_c_error);
+        (void)umocktypes_charptr_register_types();
+        (void)umocktypes_stdint_register_types();
+
+        REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
+        REGISTER_TYPE(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_RESULT);
+
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+        REGISTER_GLOBAL_MOCK_HOOK(AgentDataTypes_ToString, my_AgentDataTypes_ToString);
+    }
+
+    TEST_SUITE_CLEANUP(TestClassCleanup)
+    {
+        umock_c_deinit();
+
+        TEST_MUTEX_DESTROY(g_testByTest);
+        TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    }
+
+    TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+    {
+        if (TEST_MUTEX_ACQUIRE(g_testByTest))
+        {
+            ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+        }
+
+        umock_c_reset_all_calls();
+    }
+
+    TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+    {
+        TEST_MUTEX_RELEASE(g_testByTest);
+    }
+
+    /* CBOREncoder_EncodeTree */
+
+    TEST_FUNCTION(CBOREncoder_EncodeTree_with_NULL_treeHandle_fails)
+    {
+        // arrange
+        unsigned char* destination;
+        size_t destinationSize;
+
+        // act
+        CBOR_ENCODER_RESULT result = CBOREncoder_EncodeTree(NULL, &destination, &destinationSize);
+
+        // assert
+        ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_INVALID_ARG, result);
+    }
+
+    TEST_FUNCTION(CBOREncoder_EncodeTree_with_NULL_destination_fails)
+    {
+        // arrange
+        MULTITREE_HANDLE tree = MultiTree_Create(NoCloneFunction, NoFreeFunction);
+        size_t destinationSize;
+
+        // act
+        CBOR_ENCODER_RESULT result = CBOREncoder_EncodeTree(tree, NULL, &destinationSize);
+
+        // assert
+        ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_INVALID_ARG, result);
+
+        // cleanup
+        MultiTree_Destroy(tree);
+    }
+
+    TEST_FUNCTION(CBOREncoder_EncodeTree_with_an_empty_tree_produces_an_empty_map)
+    {
+        // arrange
+        static const unsigned char expected[] = { 0xA0 };
+        MULTITREE_HANDLE tree = MultiTree_Create(NoCloneFunction, NoFreeFunction);
+        unsigned char* destination;
+        size_t destinationSize;
+
+        // act
+        CBOR_ENCODER_RESULT result = CBOREncoder_EncodeTree(tree, &destination, &destinationSize);
+
+        // assert
+        ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result);
+        AssertEncodedAs(expected, sizeof(expected), destination, destinationSize);
+
+        // cleanup
+        free(destination);
+        MultiTree_Destroy(tree);
+    }
+
+    TEST_FUNCTION(CBOREncoder_EncodeTree_writes_integers_in_their_shortest_form)
+    {
+        // arrange
+        /*{"a": 1, "b": -500, "c": 100000}*/
+        static const unsigned char expected[] = { 0xA3, 0x61, 'a', 0x01, 0x61, 'b', 0x39, 0x01, 0xF3, 0x61, 'c', 0x1A, 0x00, 0x01, 0x86, 0xA0 };
+        AGENT_DATA_TYPE a = MakeInt32(1);
+        AGENT_DATA_TYPE b = MakeInt32(-500);
+        AGENT_DATA_TYPE c = MakeInt32(100000);
+        MULTITREE_HANDLE tree = MultiTree_Create(NoCloneFunction, NoFreeFunction);
+        unsigned char* destination;
+        size_t destinationSize;
+        (void)MultiTree_AddLeaf(tree, "a", &a);
+        (void)MultiTree_AddLeaf(tree, "b", &b);
+        (void)MultiTree_AddLeaf(tree, "c", &c);
+
+        // act
+        CBOR_ENCODER_RESULT result = CBOREncoder_EncodeTree(tree, &destination, &destinationSize);
+
+        // assert
+        ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result);
+        AssertEncodedAs(expected, sizeof(expected), destination, destinationSize);
+
+        // cleanup
+        free(destination);
+        MultiTree_Destroy(tree);
+    }
+
+    TEST_FUNCTION(CBOREncoder_EncodeTree_writes_doubles_that_fit_a_float_as_float32)
+    {
+        // arrange
+        /*{"t": 21.5, "u": 0.1}, 0.1 has no exact float representation*/
+        static const unsigned char expected[] = { 0xA2, 0x61, 't', 0xFA, 0x41, 0xAC, 0x00, 0x00, 0x61, 'u', 0xFB, 0x3F, 0xB9, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9A };
+        AGENT_DATA_TYPE t = MakeDouble(21.5);
+        AGENT_DATA_TYPE u = MakeDouble(0.1);
+        MULTITREE_HANDLE tree = MultiTree_Create(NoCloneFunction, NoFreeFunction);
+        unsigned char* destination;
+        size_t destinationSize;
+        (void)MultiTree_AddLeaf(tree, "t", &t);
+        (void)MultiTree_AddLeaf(tree, "u", &u);
+
+        // act
+        CBOR_ENCODER_RESULT result = CBOREncoder_EncodeTree(tree, &destination, &destinationSize);
+
+        // assert
+        ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result);
+        AssertEncodedAs(expected, sizeof(expected), destination, destinationSize);
+
+        // cleanup
+        free(destination);
+        MultiTree_Destroy(tree);
+    }
+
+    TEST_FUNCTION(CBOREncoder_EncodeTree_writes_strings_booleans_null_and_binary)
+    {
+        // arrange
+        /*{"s": "on", "b": true, "n": null, "x": h'0102'}*/
+        static const unsigned char expected[] = { 0xA4, 0x61, 's', 0x62, 'o', 'n', 0x61, 'b', 0xF5, 0x61, 'n', 0xF6, 0x61, 'x', 0x42, 0x01, 0x02 };
+        unsigned char bytes[] = { 0x01, 0x02 };
+        char text[] = "on";
+        AGENT_DATA_TYPE s, b, n, x;
+        MULTITREE_HANDLE tree = MultiTree_Create(NoCloneFunction, NoFreeFunction);
+        unsigned char* destination;
+        size_t destinationSize;
+        s.type = EDM_STRING_TYPE;
+        s.value.edmString.chars = text;
+        s.value.edmString.length = 2;
+        b.type = EDM_BOOLEAN_TYPE;
+        b.value.edmBoolean.value = EDM_TRUE;
+        n.type = EDM_NULL_TYPE;
+        x.type = EDM_BINARY_TYPE;
+        x.value.edmBinary.data = bytes;
+        x.value.edmBinary.size = sizeof(bytes);
+        (void)MultiTree_AddLeaf(tree, "s", &s);
+        (void)MultiTree_AddLeaf(tree, "b", &b);
+        (void)MultiTree_AddLeaf(tree, "n", &n);
+        (void)MultiTree_AddLeaf(tree, "x", &x);
+
+        // act
+        CBOR_ENCODER_RESULT result = CBOREncoder_EncodeTree(tree, &destination, &destinationSize);
+
+        // assert
+        ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result);
+        AssertEncodedAs(expected, sizeof(expected), destination, destinationSize);
+
+        // cleanup
+        free(destination);
+        MultiTree_Destroy(tree);
+    }
+
+    TEST_FUNCTION(CBOREncoder_EncodeTree_writes_nested_nodes_as_nested_maps)
+    {
+        // arrange
+        /*{"inner": {"p": 7}}*/
+        static const unsigned char expected[] = { 0xA1, 0x65, 'i', 'n', 'n', 'e', 'r', 0xA1, 0x61, 'p', 0x07 };
+        AGENT_DATA_TYPE p = MakeInt32(7);
+        MULTITREE_HANDLE tree = MultiTree_Create(NoCloneFunction, NoFreeFunction);
+        unsigned char* destination;
+        size_t destinationSize;
+        (void)MultiTree_AddLeaf(tree, "inner/p", &p);
+
+        // act
+        CBOR_ENCODER_RESULT result = CBOREncoder_EncodeTree(tree, &destination, &destinationSize);
+
+        // assert
+        ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result);
+        AssertEncodedAs(expected, sizeof(expected), destination, destinationSize);
+
+        // cleanup
+        free(destination);
+        MultiTree_Destroy(tree);
+    }
+
+    TEST_FUNCTION(CBOREncoder_EncodeTree_writes_types_without_a_CBOR_form_as_their_unquoted_text)
+    {
+        // arrange
+        /*{"d": "12.50"}*/
+        static const unsigned char expected[] = { 0xA1, 0x61, 'd', 0x65, '1', '2', '.', '5', '0' };
+        AGENT_DATA_TYPE d;
+        MULTITREE_HANDLE tree = MultiTree_Create(NoCloneFunction, NoFreeFunction);
+        unsigned char* destination;
+        size_t destinationSize;
+        d.type = EDM_DECIMAL_TYPE;
+        (void)MultiTree_AddLeaf(tree, "d", &d);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(AgentDataTypes_ToString(IGNORED_PTR_ARG, &d))
+            .IgnoreArgument_destination();
+
+        // act
+        CBOR_ENCODER_RESULT result = CBOREncoder_EncodeTree(tree, &destination, &destinationSize);
+
+        // assert
+        ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result);
+        AssertEncodedAs(expected, sizeof(expected), destination, destinationSize);
+
+        // cleanup
+        free(destination);
+        MultiTree_Destroy(tree);
+    }
+
+    TEST_FUNCTION(CBOREncoder_EncodeTree_when_the_buffer_cannot_grow_fails)
+    {
+        // arrange
+        AGENT_DATA_TYPE a = MakeInt32(1);
+        MULTITREE_HANDLE tree = MultiTree_Create(NoCloneFunction, NoFreeFunction);
+        unsigned char* destination;
+        size_t destinationSize;
+        (void)MultiTree_AddLeaf(tree, "a", &a);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG))
+            .IgnoreArgument_size()
+            .SetReturn(NULL);
+
+        // act
+        CBOR_ENCODER_RESULT result = CBOREncoder_EncodeTree(tree, &destination, &destinationSize);
+
+        // assert
+        ASSERT_ARE_NOT_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result);
+
+        // cleanup
+        MultiTree_Destroy(tree);
+    }
+
+    /* CBOREncoder_EncodeKeyedValues */
+
+    TEST_FUNCTION(CBOREncoder_EncodeKeyedValues_writes_key_ids_as_integers_and_other_keys_as_text)
+    {
+        // arrange
+        /*{0: 1, 30: 21.5, "x/y": 2}*/
+        static const unsigned char expected[] = { 0xA3, 0x00, 0x01, 0x18, 0x1E, 0xFA, 0x41, 0xAC, 0x00, 0x00, 0x63, 'x', '/', 'y', 0x02 };
+        AGENT_DATA_TYPE one = MakeInt32(1);
+        AGENT_DATA_TYPE temperature = MakeDouble(21.5);
+        AGENT_DATA_TYPE two = MakeInt32(2);
+        CBOR_ENCODER_KEYED_VALUE values[3];
+        unsigned char* destination;
+        size_t destinationSize;
+        values[0].keyId = 0;
+        values[0].keyName = "a";
+        values[0].value = &one;
+        values[1].keyId = 30;
+        values[1].keyName = "temperature";
+        values[1].value = &temperature;
+        values[2].keyId = CBOR_ENCODER_NO_KEY_ID;
+        values[2].keyName = "x/y";
+        values[2].value = &two;
+
+        // act
+        CBOR_ENCODER_RESULT result = CBOREncoder_EncodeKeyedValues(3, values, &destination, &destinationSize);
+
+        // assert
+        ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result);
+        AssertEncodedAs(expected, sizeof(expected), destination, destinationSize);
+
+        // cleanup
+        free(destination);
+    }
+
+    TEST_FUNCTION(CBOREncoder_EncodeKeyedValues_with_neither_key_id_nor_key_name_fails)
+    {
+        // arrange
+        AGENT_DATA_TYPE one = MakeInt32(1);
+        CBOR_ENCODER_KEYED_VALUE value;
+        unsigned char* destination;
+        size_t destinationSize;
+        value.keyId = CBOR_ENCODER_NO_KEY_ID;
+        value.keyName = NULL;
+        value.value = &one;
+
+        // act
+        CBOR_ENCODER_RESULT result = CBOREncoder_EncodeKeyedValues(1, &value, &destination, &destinationSize);
+
+        // assert
+        ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_INVALID_ARG, result);
+    }
+
+    TEST_FUNCTION(CBOREncoder_EncodeKeyedValues_with_NULL_values_and_a_non_zero_count_fails)
+    {
+        // arrange
+        unsigned char* destination;
+        size_t destinationSize;
+
+        // act
+        CBOR_ENCODER_RESULT result = CBOREncoder_EncodeKeyedValues(1, NULL, &destination, &destinationSize);
+
+        // assert
+        ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_INVALID_ARG, result);
+    }
+
+END_TEST_SUITE(CBOREncoder_ut)
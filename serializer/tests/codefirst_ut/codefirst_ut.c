@@ -2015,19 +2015,11 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
         STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
@@ -2066,33 +2058,17 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
         STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_new());
         STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, 0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_int_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
@@ -2115,6 +2091,80 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         CodeFirst_Deinit();
     }
 
+    /* Tests_SRS_CODEFIRST_99_095:[For each value passed to it, CodeFirst_SendAsync shall look up to which device the value belongs.] */
+    TEST_FUNCTION(CodeFirst_SendAsync_finds_the_device_of_a_property_among_several_devices)
+    {
+        // arrange
+        (void)CodeFirst_Init(NULL);
+        SimpleDevice_Model* device1 = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        SimpleDevice_Model* device2 = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        SimpleDevice_Model* device3 = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        CodeFirst_DestroyDevice(device2);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
+        EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, 0));
+        STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_int_Property", IGNORED_PTR_ARG))
+            .IgnoreArgument_transactionHandle()
+            .IgnoreArgument(3);
+        EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_transactionHandle()
+            .IgnoreArgument(2)
+            .IgnoreArgument(3);
+        device3->this_is_int_Property = 3;
+        unsigned char* destination;
+        size_t destinationSize;
+
+        // act
+        CODEFIRST_RESULT result = CodeFirst_SendAsync(&destination, &destinationSize, 1, &device3->this_is_int_Property);
+
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        CodeFirst_DestroyDevice(device1);
+        CodeFirst_DestroyDevice(device3);
+        CodeFirst_Deinit();
+    }
+
+    /* Tests_SRS_CODEFIRST_99_088:[CodeFirst_SendAsync shall send to the Device module a set of properties.] */
+    TEST_FUNCTION(CodeFirst_SendAsync_called_twice_publishes_the_same_path)
+    {
+        // arrange
+        (void)CodeFirst_Init(NULL);
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        unsigned char* destination;
+        size_t destinationSize;
+        (void)CodeFirst_SendAsync(&destination, &destinationSize, 1, &device->this_is_int_Property);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
+        EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, 0));
+        STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_int_Property", IGNORED_PTR_ARG))
+            .IgnoreArgument_transactionHandle()
+            .IgnoreArgument(3);
+        EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_transactionHandle()
+            .IgnoreArgument(2)
+            .IgnoreArgument(3);
+
+        // act
+        CODEFIRST_RESULT result = CodeFirst_SendAsync(&destination, &destinationSize, 1, &device->this_is_int_Property);
+
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
     /* Tests_SRS_CODEFIRST_99_094:[If any Device API fail, CodeFirst_SendAsync shall return CODEFIRST_DEVICE_PUBLISH_FAILED.] */
     TEST_FUNCTION(When_StartTransaction_Fails_CodeFirst_SendAsync_Fails)
     {
@@ -2150,20 +2200,12 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
         STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3).SetReturn(DEVICE_ERROR);
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_CancelTransaction(IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle();
         device->this_is_double_Property = 42.0;
@@ -2191,34 +2233,18 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
         STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_new());
         STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, 0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_int_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3).SetReturn(DEVICE_ERROR);
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_CancelTransaction(IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle();
         device->this_is_double_Property = 42.0;
@@ -2247,19 +2273,11 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
         STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
@@ -2315,10 +2333,7 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
         STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_CancelTransaction(IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle();
         device->this_is_double_Property = 42.0;
@@ -2347,15 +2362,9 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
         STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0))
             .SetReturn(AGENT_DATA_TYPES_ERROR);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_CancelTransaction(IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle();
         device->this_is_double_Property = 42.0;
@@ -2384,29 +2393,15 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
         STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_new());
         STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, 0))
             .SetReturn(AGENT_DATA_TYPES_ERROR);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_CancelTransaction(IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle();
         device->this_is_double_Property = 42.0;
@@ -2435,19 +2430,11 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
         STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_CancelTransaction(IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle();
@@ -2488,20 +2475,12 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
 
         STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
@@ -2543,33 +2522,17 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
         STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, (double)(IGNORED_NUM_ARG)));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_new());
         STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, (int32_t)(IGNORED_NUM_ARG)));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_int_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
@@ -2789,25 +2752,11 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
         STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_OUTERTYPE_MODEL_HANDLE)).SetReturn("OuterType");
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, (double)(IGNORED_NUM_ARG)));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "Inner/this_is_double2", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
@@ -2839,25 +2788,11 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
         STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_OUTERTYPE_MODEL_HANDLE)).SetReturn("OuterType");
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, (int32_t)(IGNORED_NUM_ARG)));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "Inner/this_is_int2", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
@@ -2931,19 +2866,11 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
         STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         unsigned char* destination;
         size_t destinationSize;
@@ -3486,22 +3413,15 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
 
         STRICT_EXPECTED_CALL(Device_CreateTransaction_ReportedProperties(IGNORED_PTR_ARG))
             .IgnoreArgument_deviceHandle();
-        STRICT_EXPECTED_CALL(STRING_new());
         STRICT_EXPECTED_CALL(Schema_GetModelName(IGNORED_PTR_ARG))
             .IgnoreArgument_modelTypeHandle()
             .SetReturn("TruckType");
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "reported_this_is_int"))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, IGNORED_NUM_ARG))
             .IgnoreArgument_agentData()
             .IgnoreArgument_v();
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted_ReportedProperty(IGNORED_PTR_ARG, "reported_this_is_int", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument_data();
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG))
             .IgnoreArgument_agentData();
         STRICT_EXPECTED_CALL(Device_DestroyTransaction_ReportedProperties(IGNORED_PTR_ARG))
@@ -3534,11 +3454,8 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
 
         STRICT_EXPECTED_CALL(Device_CreateTransaction_ReportedProperties(IGNORED_PTR_ARG))
             .IgnoreArgument_deviceHandle();
-        STRICT_EXPECTED_CALL(STRING_new());
         STRICT_EXPECTED_CALL(Schema_GetModelName(IGNORED_PTR_ARG))
             .IgnoreArgument_modelTypeHandle();
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_DestroyTransaction_ReportedProperties(IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle();
 
@@ -3701,19 +3618,12 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
     {
 
         STRICT_EXPECTED_CALL(Device_CreateTransaction_ReportedProperties(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
         STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "new_reported_this_is_double"))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 5.5))
             .IgnoreArgument_agentData();
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted_ReportedProperty(IGNORED_PTR_ARG, "new_reported_this_is_double", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument_data();
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG))
             .IgnoreArgument_agentData();
         STRICT_EXPECTED_CALL(Device_CommitTransaction_ReportedProperties(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
@@ -3776,11 +3686,9 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
 
         size_t calls_that_cannot_fail[] =
         {
-            2,/*Schema_GetModelName*/
-            5,/*STRING_c_str*/
-            7,/*STRING_delete*/
-            8,/*Destroy_AGENT_DATA_TYPE*/
-            10, /*Device_DestroyTransaction_ReportedProperties*/
+            1,/*Schema_GetModelName*/
+            4,/*Destroy_AGENT_DATA_TYPE*/
+            6, /*Device_DestroyTransaction_ReportedProperties*/
         };
 
         for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
@@ -3824,25 +3732,11 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
         STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_OUTERTYPE_MODEL_HANDLE)).SetReturn("OuterType");
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, (int32_t)(IGNORED_NUM_ARG)));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "Inner/this_is_int2", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
@@ -4076,19 +3970,11 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
         STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
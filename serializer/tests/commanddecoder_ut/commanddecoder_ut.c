@@ -53,6 +53,7 @@ MOCKABLE_FUNCTION(, void, onDesiredPropertyModelInModel, void*, v);
 #define ENABLE_MOCKS
 #include "codefirst.h" 
 #include "jsondecoder.h"
+#include "cbordecoder.h"
 
 MOCKABLE_FUNCTION(, EXECUTE_COMMAND_RESULT, ActionCallbackMock, void*, actionCallbackContext, const char*, relativeActionPath, const char*, actionName, size_t, parameterCount, const AGENT_DATA_TYPE*, parameterValues);
 MOCKABLE_FUNCTION(, METHODRETURN_HANDLE, methodCallbackMock, void*, methodCallbackContext, const char*, relativeMethodPath, const char*, mthodName, size_t, parameterCount, const AGENT_DATA_TYPE*, parameterValues);
@@ -115,6 +116,7 @@ IMPLEMENT_UMOCK_C_ENUM_TYPE(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_RESULT_VALUE
 
 TEST_DEFINE_ENUM_TYPE(JSON_DECODER_RESULT, JSON_DECODER_RESULT_VALUES);
 IMPLEMENT_UMOCK_C_ENUM_TYPE(JSON_DECODER_RESULT, JSON_DECODER_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(CBOR_DECODER_RESULT, CBOR_DECODER_RESULT_VALUES);
 
 TEST_DEFINE_ENUM_TYPE(MULTITREE_RESULT, MULTITREE_RESULT_VALUES);
 IMPLEMENT_UMOCK_C_ENUM_TYPE(MULTITREE_RESULT, MULTITREE_RESULT_VALUES);
@@ -323,6 +325,8 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         
         
         REGISTER_UMOCK_ALIAS_TYPE(JSON_DECODER_RESULT, int);
+        REGISTER_UMOCK_ALIAS_TYPE(CBOR_DECODER_RESULT, int);
+        REGISTER_UMOCK_ALIAS_TYPE(const unsigned char*, void*);
         REGISTER_UMOCK_ALIAS_TYPE(MULTITREE_RESULT, int);
         REGISTER_UMOCK_ALIAS_TYPE(SCHEMA_RESULT, int);
         REGISTER_UMOCK_ALIAS_TYPE(AGENT_DATA_TYPE_TYPE, int);
@@ -4060,4 +4064,98 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
     }
 
 
+    TEST_FUNCTION(CommandDecoder_ExecuteCommandCBOR_with_NULL_handle_fails)
+    {
+        ///arrange
+        static const unsigned char cbor[] = { 0xA0 };
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_ExecuteCommandCBOR(NULL, cbor, sizeof(cbor));
+
+        ///assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    TEST_FUNCTION(CommandDecoder_ExecuteCommandCBOR_with_zero_size_fails)
+    {
+        ///arrange
+        static const unsigned char cbor[] = { 0xA0 };
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_ExecuteCommandCBOR(commandDecoderHandle, cbor, 0);
+
+        ///assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    TEST_FUNCTION(CommandDecoder_ExecuteCommandCBOR_when_decoding_fails_no_command_is_dispatched)
+    {
+        ///arrange
+        static const unsigned char cbor[] = { 0xA0 };
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(CBORDecoder_CBOR_To_MultiTree(cbor, sizeof(cbor), NULL, IGNORED_PTR_ARG))
+            .IgnoreArgument_multiTreeHandle()
+            .SetReturn(CBOR_DECODER_PARSE_ERROR);
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_ExecuteCommandCBOR(commandDecoderHandle, cbor, sizeof(cbor));
+
+        ///assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    TEST_FUNCTION(CommandDecoder_ExecuteMethodCBOR_without_a_methodCallback_fails)
+    {
+        ///arrange
+        static const unsigned char cbor[] = { 0xA0 };
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, NULL, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+
+        ///act
+        METHODRETURN_HANDLE result = CommandDecoder_ExecuteMethodCBOR(commandDecoderHandle, "reset", cbor, sizeof(cbor));
+
+        ///assert
+        ASSERT_IS_NULL(result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    TEST_FUNCTION(CommandDecoder_IngestDesiredPropertiesCBOR_decodes_with_the_key_ids_of_the_model)
+    {
+        ///arrange
+        static const unsigned char cbor[] = { 0xA0 };
+        unsigned char deviceMemoryArea[100];
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(CBORDecoder_CBOR_To_MultiTree(cbor, sizeof(cbor), TEST_MODEL_HANDLE, IGNORED_PTR_ARG))
+            .IgnoreArgument_multiTreeHandle()
+            .SetReturn(CBOR_DECODER_PARSE_ERROR);
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredPropertiesCBOR(deviceMemoryArea, commandDecoderHandle, cbor, sizeof(cbor), false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
 END_TEST_SUITE(CommandDecoder_ut)
@@ -30,6 +30,7 @@ static void my_gballoc_free(void* s)
 
 #define ENABLE_MOCKS
 #include "jsonencoder.h"
+#include "cborencoder.h"
 #include "multitree.h"
 #include "schema.h"
 #include "azure_c_shared_utility/optimize_size.h"
@@ -132,6 +133,9 @@ IMPLEMENT_UMOCK_C_ENUM_TYPE(MULTITREE_RESULT, MULTITREE_RESULT_VALUES);
 TEST_DEFINE_ENUM_TYPE(JSON_ENCODER_RESULT, JSON_ENCODER_RESULT_VALUES);
 IMPLEMENT_UMOCK_C_ENUM_TYPE(JSON_ENCODER_RESULT, JSON_ENCODER_RESULT_VALUES);
 
+TEST_DEFINE_ENUM_TYPE(CBOR_ENCODER_RESULT, CBOR_ENCODER_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(CBOR_ENCODER_RESULT, CBOR_ENCODER_RESULT_VALUES);
+
 #define DEFAULT_PROPERTY_NAME_2 "blahBlah"
 
 static MULTITREE_HANDLE my_MultiTree_Create(MULTITREE_CLONE_FUNCTION cloneFunction, MULTITREE_FREE_FUNCTION freeFunction)
@@ -206,6 +210,9 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         REGISTER_UMOCK_ALIAS_TYPE(MULTITREE_RESULT, int);
         REGISTER_UMOCK_ALIAS_TYPE(DATA_MARSHALLER_RESULT, int);
         REGISTER_UMOCK_ALIAS_TYPE(JSON_ENCODER_RESULT, int);
+        REGISTER_UMOCK_ALIAS_TYPE(CBOR_ENCODER_RESULT, int);
+        REGISTER_UMOCK_ALIAS_TYPE(SCHEMA_MODEL_TYPE_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(SCHEMA_RESULT, int);
             
         REGISTER_GLOBAL_MOCK_HOOK(MultiTree_Create, my_MultiTree_Create);
         REGISTER_GLOBAL_MOCK_HOOK(MultiTree_Destroy, my_MultiTree_Destroy);
@@ -786,6 +793,100 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         DataMarshaller_Destroy(handle);
     }
 
+    TEST_FUNCTION(DataMarshaller_SendData_with_CBOR_encoding_encodes_the_tree_with_CBOREncoder)
+    {
+        ///arrange
+        DATA_MARSHALLER_HANDLE handle;
+        unsigned char* destination;
+        size_t destinationSize;
+        DATA_MARSHALLER_VALUE value[] = { { DEFAULT_PROPERTY_NAME, &floatValid }, { DEFAULT_PROPERTY_NAME_2, &intValid } };
+        DataMarshaller_SetDefaultEncoding(PAYLOAD_ENCODING_CBOR);
+        handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
+        DataMarshaller_SetDefaultEncoding(PAYLOAD_ENCODING_JSON);
+        umock_c_reset_all_calls();
+
+        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
+            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME_2, &intValid))
+            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(CBOREncoder_EncodeTree(IGNORED_PTR_ARG, &destination, &destinationSize))
+            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
+            .IgnoreArgument_treeHandle();
+
+        ///act
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 2, value, &destination, &destinationSize);
+
+        ///assert
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        DataMarshaller_Destroy(handle);
+    }
+
+    TEST_FUNCTION(DataMarshaller_SendData_with_CBOR_encoding_fails_when_CBOREncoder_fails)
+    {
+        ///arrange
+        DATA_MARSHALLER_HANDLE handle;
+        unsigned char* destination;
+        size_t destinationSize;
+        DATA_MARSHALLER_VALUE value[] = { { DEFAULT_PROPERTY_NAME, &floatValid } };
+        DataMarshaller_SetDefaultEncoding(PAYLOAD_ENCODING_CBOR);
+        handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
+        DataMarshaller_SetDefaultEncoding(PAYLOAD_ENCODING_JSON);
+        umock_c_reset_all_calls();
+
+        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
+            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(CBOREncoder_EncodeTree(IGNORED_PTR_ARG, &destination, &destinationSize))
+            .IgnoreArgument_treeHandle()
+            .SetReturn(CBOR_ENCODER_ERROR);
+        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
+            .IgnoreArgument_treeHandle();
+
+        ///act
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, value, &destination, &destinationSize);
+
+        ///assert
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_CBOR_ENCODER_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        DataMarshaller_Destroy(handle);
+    }
+
+    TEST_FUNCTION(DataMarshaller_SendData_with_CBOR_key_ids_encodes_one_flat_keyed_map)
+    {
+        ///arrange
+        DATA_MARSHALLER_HANDLE handle;
+        unsigned char* destination;
+        size_t destinationSize;
+        DATA_MARSHALLER_VALUE value[] = { { DEFAULT_PROPERTY_NAME, &floatValid }, { DEFAULT_PROPERTY_NAME_LEVEL2, &intValid } };
+        DataMarshaller_SetDefaultEncoding(PAYLOAD_ENCODING_CBOR_WITH_KEY_IDS);
+        handle = DataMarshaller_Create(TEST_MODEL_HANDLE, false);
+        DataMarshaller_SetDefaultEncoding(PAYLOAD_ENCODING_JSON);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(Schema_GetModelPathId(TEST_MODEL_HANDLE, DEFAULT_PROPERTY_NAME, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Schema_GetModelPathId(TEST_MODEL_HANDLE, DEFAULT_PROPERTY_NAME_LEVEL2, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(CBOREncoder_EncodeKeyedValues(2, IGNORED_PTR_ARG, &destination, &destinationSize));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+        ///act
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 2, value, &destination, &destinationSize);
+
+        ///assert
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        DataMarshaller_Destroy(handle);
+    }
+
     /* Tests_SRS_DATAMARSHALLER_01_002: [If the includePropertyPath argument passed to DataMarshaller_Create was false and the number of values passed to SendData is greater than 1 and at least one of them is a struct, DataMarshaller_SendData shall fallback to  including the complete property path in the output JSON.] */
     TEST_FUNCTION(when_includepropertypath_is_false_and_value_count_is_greater_than_1_and_one_but_no_structs_SendData_succeeds)
     {
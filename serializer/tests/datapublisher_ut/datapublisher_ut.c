@@ -0,0 +1,502 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+void* my_gballoc_malloc(size_t t)
+{
+    return malloc(t);
+}
+
+void* my_gballoc_calloc(size_t n, size_t t)
+{
+    return calloc(n, t);
+}
+
+void* my_gballoc_realloc(void* v, size_t t)
+{
+    return realloc(v, t);
+}
+
+void my_gballoc_free(void * t)
+{
+    free(t);
+}
+
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+#include "umocktypes_bool.h"
+#include "umocktypes_stdint.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/vector.h"
+#include "agenttypesystem.h"
+#include "schema.h"
+#include "datamarshaller.h"
+#undef ENABLE_MOCKS
+
+#include "testrunnerswitcher.h"
+#include "datapublisher.h"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+TEST_DEFINE_ENUM_TYPE(DATA_PUBLISHER_RESULT, DATA_PUBLISHER_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(SCHEMA_RESULT, SCHEMA_RESULT_VALUES);
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static const SCHEMA_MODEL_TYPE_HANDLE TEST_MODEL_HANDLE = (SCHEMA_MODEL_TYPE_HANDLE)0x4242;
+static const DATA_MARSHALLER_HANDLE TEST_DATA_MARSHALLER_HANDLE = (DATA_MARSHALLER_HANDLE)0x4243;
+
+/*the paths the schema knows, their index is their id. The last one is a reported property, the others are properties*/
+static const char* const schemaPaths[] = { "temperature", "humidity", "windSpeed", "p0", "p1", "p2", "p3", "p4", "p5", "p6", "p7", "p8", "p9", "p10", "reportedTemperature" };
+#define REPORTED_PROPERTY_PATH "reportedTemperature"
+#define UNKNOWN_PROPERTY_PATH "unknownProperty"
+#define TEST_PROPERTY_HANDLE ((SCHEMA_PROPERTY_HANDLE)0x4244)
+#define TEST_REPORTED_PROPERTY_HANDLE ((SCHEMA_REPORTED_PROPERTY_HANDLE)0x4245)
+
+/*what the last DataMarshaller_SendData got, copied because the transaction is gone once DataPublisher_EndTransaction returns*/
+#define MAX_SENT_VALUES 16
+static size_t sentValueCount;
+static char sentPropertyPaths[MAX_SENT_VALUES][32];
+static double sentValues[MAX_SENT_VALUES];
+static unsigned char sentPayload[] = { '{', '}' };
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+static DATA_MARSHALLER_HANDLE my_DataMarshaller_Create(SCHEMA_MODEL_TYPE_HANDLE modelHandle, bool includePropertyPath)
+{
+    (void)modelHandle;
+    (void)includePropertyPath;
+    return TEST_DATA_MARSHALLER_HANDLE;
+}
+
+static DATA_MARSHALLER_RESULT my_DataMarshaller_SendData(DATA_MARSHALLER_HANDLE dataMarshallerHandle, size_t valueCount, const DATA_MARSHALLER_VALUE* values, unsigned char** destination, size_t* destinationSize)
+{
+    size_t i;
+    (void)dataMarshallerHandle;
+    ASSERT_IS_TRUE(valueCount <= MAX_SENT_VALUES);
+    sentValueCount = valueCount;
+    for (i = 0; i < valueCount; i++)
+    {
+        ASSERT_IS_TRUE(strlen(values[i].PropertyPath) < sizeof(sentPropertyPaths[i]));
+        (void)strcpy(sentPropertyPaths[i], values[i].PropertyPath);
+        sentValues[i] = values[i].Value->value.edmDouble.value;
+    }
+    /*the payload is not owned by the test, nothing to free*/
+    *destination = sentPayload;
+    *destinationSize = sizeof(sentPayload);
+    return DATA_MARSHALLER_OK;
+}
+
+static SCHEMA_RESULT my_Schema_GetModelPathDescriptor(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* path, SCHEMA_PATH_DESCRIPTOR* descriptor)
+{
+    SCHEMA_RESULT result = SCHEMA_ELEMENT_NOT_FOUND;
+    size_t i;
+    (void)modelTypeHandle;
+    for (i = 0; i < COUNT_OF(schemaPaths); i++)
+    {
+        if (strcmp(schemaPaths[i], path) == 0)
+        {
+            (void)memset(descriptor, 0, sizeof(*descriptor));
+            descriptor->id = i;
+            descriptor->path = schemaPaths[i];
+            if (strcmp(path, REPORTED_PROPERTY_PATH) == 0)
+            {
+                descriptor->reportedPropertyHandle = TEST_REPORTED_PROPERTY_HANDLE;
+            }
+            else
+            {
+                descriptor->propertyHandle = TEST_PROPERTY_HANDLE;
+            }
+            result = SCHEMA_OK;
+            break;
+        }
+    }
+    return result;
+}
+
+/*only doubles are published here, a shallow copy is the whole copy*/
+static AGENT_DATA_TYPES_RESULT my_Create_AGENT_DATA_TYPE_from_AGENT_DATA_TYPE(AGENT_DATA_TYPE* dest, const AGENT_DATA_TYPE* src)
+{
+    *dest = *src;
+    return AGENT_DATA_TYPES_OK;
+}
+
+static void my_Destroy_AGENT_DATA_TYPE(AGENT_DATA_TYPE* agentData)
+{
+    /*a destroyed value that is sent again is easy to spot*/
+    agentData->type = EDM_NO_TYPE;
+    agentData->value.edmDouble.value = -1;
+}
+
+static int my_mallocAndStrcpy_s(char** destination, const char* source)
+{
+    size_t length = strlen(source);
+    *destination = (char*)my_gballoc_malloc(length + 1);
+    (void)memcpy(*destination, source, length + 1);
+    return 0;
+}
+
+static AGENT_DATA_TYPE MakeDouble(double v)
+{
+    AGENT_DATA_TYPE result;
+    result.type = EDM_DOUBLE_TYPE;
+    result.value.edmDouble.value = v;
+    return result;
+}
+
+static void PublishDouble(TRANSACTION_HANDLE transaction, const char* propertyPath, double v)
+{
+    AGENT_DATA_TYPE value = MakeDouble(v);
+    ASSERT_ARE_EQUAL(DATA_PUBLISHER_RESULT, DATA_PUBLISHER_OK, DataPublisher_PublishTransacted(transaction, propertyPath, &value));
+}
+
+static void EndTransaction(TRANSACTION_HANDLE transaction)
+{
+    unsigned char* destination;
+    size_t destinationSize;
+    ASSERT_ARE_EQUAL(DATA_PUBLISHER_RESULT, DATA_PUBLISHER_OK, DataPublisher_EndTransaction(transaction, &destination, &destinationSize));
+    ASSERT_ARE_EQUAL(void_ptr, sentPayload, destination);
+}
+
+BEGIN_TEST_SUITE(DataPublisher_ut)
+
+    TEST_SUITE_INITIALIZE(TestClassInitialize)
+    {
+        TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+        g_testByTest = TEST_MUTEX_CREATE();
+        ASSERT_IS_NOT_NULL(g_testByTest);
+
+        (void)umock_c_init(on_umock_c_error);
+        (void)umocktypes_bool_register_types();
+        (void)umocktypes_charptr_register_types();
+        (void)umocktypes_stdint_register_types();
+
+        REGISTER_UMOCK_ALIAS_TYPE(SCHEMA_MODEL_TYPE_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(DATA_MARSHALLER_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(VECTOR_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(const VECTOR_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(SCHEMA_PATH_DESCRIPTOR*, void*);
+        REGISTER_TYPE(SCHEMA_RESULT, SCHEMA_RESULT);
+        REGISTER_TYPE(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_RESULT);
+        REGISTER_TYPE(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_RESULT);
+
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_calloc, my_gballoc_calloc);
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+        REGISTER_GLOBAL_MOCK_HOOK(mallocAndStrcpy_s, my_mallocAndStrcpy_s);
+        REGISTER_GLOBAL_MOCK_HOOK(DataMarshaller_Create, my_DataMarshaller_Create);
+        REGISTER_GLOBAL_MOCK_HOOK(DataMarshaller_SendData, my_DataMarshaller_SendData);
+        REGISTER_GLOBAL_MOCK_HOOK(Schema_GetModelPathDescriptor, my_Schema_GetModelPathDescriptor);
+        REGISTER_GLOBAL_MOCK_HOOK(Create_AGENT_DATA_TYPE_from_AGENT_DATA_TYPE, my_Create_AGENT_DATA_TYPE_from_AGENT_DATA_TYPE);
+        REGISTER_GLOBAL_MOCK_HOOK(Destroy_AGENT_DATA_TYPE, my_Destroy_AGENT_DATA_TYPE);
+    }
+
+    TEST_SUITE_CLEANUP(TestClassCleanup)
+    {
+        umock_c_deinit();
+
+        TEST_MUTEX_DESTROY(g_testByTest);
+        TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    }
+
+    TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+    {
+        if (TEST_MUTEX_ACQUIRE(g_testByTest))
+        {
+            ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+        }
+
+        umock_c_reset_all_calls();
+        sentValueCount = 0;
+    }
+
+    TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+    {
+        TEST_MUTEX_RELEASE(g_testByTest);
+    }
+
+    /* Tests_SRS_DATA_PUBLISHER_99_016:[ When DataPublisher_PublishTransacted is invoked, DataPublisher shall associate the data with the transaction identified by the transactionHandle argument and return DATA_PUBLISHER_OK. No data shall be dispatched at the time of the call.] */
+    TEST_FUNCTION(DataPublisher_EndTransaction_sends_the_published_values_in_order)
+    {
+        // arrange
+        DATA_PUBLISHER_HANDLE dataPublisher = DataPublisher_Create(TEST_MODEL_HANDLE, true);
+        TRANSACTION_HANDLE transaction = DataPublisher_StartTransaction(dataPublisher);
+        PublishDouble(transaction, "temperature", 21.5);
+        PublishDouble(transaction, "humidity", 64.25);
+
+        // act
+        EndTransaction(transaction);
+
+        // assert
+        ASSERT_ARE_EQUAL(size_t, 2, sentValueCount);
+        ASSERT_ARE_EQUAL(char_ptr, "temperature", sentPropertyPaths[0]);
+        ASSERT_ARE_EQUAL(double, 21.5, sentValues[0]);
+        ASSERT_ARE_EQUAL(char_ptr, "humidity", sentPropertyPaths[1]);
+        ASSERT_ARE_EQUAL(double, 64.25, sentValues[1]);
+
+        // cleanup
+        DataPublisher_Destroy(dataPublisher);
+    }
+
+    /* Tests_SRS_DATA_PUBLISHER_99_012:[ DataPublisher_EndTransaction shall dispose of any resources associated with the transaction.] */
+    TEST_FUNCTION(DataPublisher_StartTransaction_after_EndTransaction_reuses_the_transaction_without_its_values)
+    {
+        // arrange
+        DATA_PUBLISHER_HANDLE dataPublisher = DataPublisher_Create(TEST_MODEL_HANDLE, true);
+        TRANSACTION_HANDLE first = DataPublisher_StartTransaction(dataPublisher);
+        TRANSACTION_HANDLE second;
+        PublishDouble(first, "temperature", 21.5);
+        PublishDouble(first, "humidity", 64.25);
+        EndTransaction(first);
+
+        // act
+        second = DataPublisher_StartTransaction(dataPublisher);
+        PublishDouble(second, "windSpeed", 12);
+        EndTransaction(second);
+
+        // assert
+        ASSERT_ARE_EQUAL(void_ptr, first, second);
+        ASSERT_ARE_EQUAL(size_t, 1, sentValueCount);
+        ASSERT_ARE_EQUAL(char_ptr, "windSpeed", sentPropertyPaths[0]);
+        ASSERT_ARE_EQUAL(double, 12, sentValues[0]);
+
+        // cleanup
+        DataPublisher_Destroy(dataPublisher);
+    }
+
+    /* Tests_SRS_DATA_PUBLISHER_99_015:[ DataPublisher_CancelTransaction shall dispose of any resources associated with the transaction.] */
+    TEST_FUNCTION(DataPublisher_StartTransaction_after_CancelTransaction_reuses_the_transaction_without_its_values)
+    {
+        // arrange
+        DATA_PUBLISHER_HANDLE dataPublisher = DataPublisher_Create(TEST_MODEL_HANDLE, true);
+        TRANSACTION_HANDLE first = DataPublisher_StartTransaction(dataPublisher);
+        TRANSACTION_HANDLE second;
+        unsigned char* destination;
+        size_t destinationSize;
+        PublishDouble(first, "temperature", 21.5);
+        PublishDouble(first, "humidity", 64.25);
+        ASSERT_ARE_EQUAL(DATA_PUBLISHER_RESULT, DATA_PUBLISHER_OK, DataPublisher_CancelTransaction(first));
+        umock_c_reset_all_calls();
+
+        // act
+        second = DataPublisher_StartTransaction(dataPublisher);
+        DATA_PUBLISHER_RESULT result = DataPublisher_EndTransaction(second, &destination, &destinationSize);
+
+        // assert
+        ASSERT_ARE_EQUAL(void_ptr, first, second);
+        ASSERT_ARE_EQUAL(DATA_PUBLISHER_RESULT, DATA_PUBLISHER_EMPTY_TRANSACTION, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        DataPublisher_Destroy(dataPublisher);
+    }
+
+    /* Tests_SRS_DATA_PUBLISHER_99_019:[ If the same property is associated twice with a transaction, then the last value shall be kept associated with the transaction.] */
+    TEST_FUNCTION(DataPublisher_PublishTransacted_of_the_same_property_replaces_the_earlier_value)
+    {
+        // arrange
+        DATA_PUBLISHER_HANDLE dataPublisher = DataPublisher_Create(TEST_MODEL_HANDLE, true);
+        TRANSACTION_HANDLE transaction = DataPublisher_StartTransaction(dataPublisher);
+        AGENT_DATA_TYPE value = MakeDouble(22);
+        PublishDouble(transaction, "temperature", 21.5);
+        PublishDouble(transaction, "humidity", 64.25);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(Schema_GetModelPathDescriptor(TEST_MODEL_HANDLE, "temperature", IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_AGENT_DATA_TYPE(IGNORED_PTR_ARG, &value))
+            .IgnoreArgument_dest();
+        STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
+
+        // act
+        DATA_PUBLISHER_RESULT result = DataPublisher_PublishTransacted(transaction, "temperature", &value);
+
+        // assert
+        ASSERT_ARE_EQUAL(DATA_PUBLISHER_RESULT, DATA_PUBLISHER_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        EndTransaction(transaction);
+        ASSERT_ARE_EQUAL(size_t, 2, sentValueCount);
+        ASSERT_ARE_EQUAL(char_ptr, "temperature", sentPropertyPaths[0]);
+        ASSERT_ARE_EQUAL(double, 22, sentValues[0]);
+        ASSERT_ARE_EQUAL(char_ptr, "humidity", sentPropertyPaths[1]);
+        ASSERT_ARE_EQUAL(double, 64.25, sentValues[1]);
+
+        // cleanup
+        DataPublisher_Destroy(dataPublisher);
+    }
+
+    /* Tests_SRS_DATA_PUBLISHER_99_040:[ When propertyPath does not exist in the supplied model, DataPublisher_Publish shall return DATA_PUBLISHER_SCHEMA_FAILED without dispatching data.] */
+    TEST_FUNCTION(DataPublisher_PublishTransacted_of_an_unknown_property_fails)
+    {
+        // arrange
+        DATA_PUBLISHER_HANDLE dataPublisher = DataPublisher_Create(TEST_MODEL_HANDLE, true);
+        TRANSACTION_HANDLE transaction = DataPublisher_StartTransaction(dataPublisher);
+        AGENT_DATA_TYPE value = MakeDouble(1);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(Schema_GetModelPathDescriptor(TEST_MODEL_HANDLE, UNKNOWN_PROPERTY_PATH, IGNORED_PTR_ARG));
+
+        // act
+        DATA_PUBLISHER_RESULT result = DataPublisher_PublishTransacted(transaction, UNKNOWN_PROPERTY_PATH, &value);
+
+        // assert
+        ASSERT_ARE_EQUAL(DATA_PUBLISHER_RESULT, DATA_PUBLISHER_SCHEMA_FAILED, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        (void)DataPublisher_CancelTransaction(transaction);
+        DataPublisher_Destroy(dataPublisher);
+    }
+
+    /* Tests_SRS_DATA_PUBLISHER_99_040:[ When propertyPath does not exist in the supplied model, DataPublisher_Publish shall return DATA_PUBLISHER_SCHEMA_FAILED without dispatching data.] */
+    TEST_FUNCTION(DataPublisher_PublishTransacted_of_an_unknown_property_fails_every_time)
+    {
+        // arrange
+        DATA_PUBLISHER_HANDLE dataPublisher = DataPublisher_Create(TEST_MODEL_HANDLE, true);
+        TRANSACTION_HANDLE transaction = DataPublisher_StartTransaction(dataPublisher);
+        AGENT_DATA_TYPE value = MakeDouble(1);
+        PublishDouble(transaction, "temperature", 21.5);
+        ASSERT_ARE_EQUAL(DATA_PUBLISHER_RESULT, DATA_PUBLISHER_SCHEMA_FAILED, DataPublisher_PublishTransacted(transaction, UNKNOWN_PROPERTY_PATH, &value));
+
+        // act
+        DATA_PUBLISHER_RESULT result = DataPublisher_PublishTransacted(transaction, UNKNOWN_PROPERTY_PATH, &value);
+
+        // assert
+        ASSERT_ARE_EQUAL(DATA_PUBLISHER_RESULT, DATA_PUBLISHER_SCHEMA_FAILED, result);
+        EndTransaction(transaction);
+        ASSERT_ARE_EQUAL(size_t, 1, sentValueCount);
+        ASSERT_ARE_EQUAL(char_ptr, "temperature", sentPropertyPaths[0]);
+
+        // cleanup
+        DataPublisher_Destroy(dataPublisher);
+    }
+
+    /* Tests_SRS_DATA_PUBLISHER_99_040:[ When propertyPath does not exist in the supplied model, DataPublisher_Publish shall return DATA_PUBLISHER_SCHEMA_FAILED without dispatching data.] */
+    TEST_FUNCTION(DataPublisher_PublishTransacted_of_a_reported_property_fails)
+    {
+        // arrange
+        DATA_PUBLISHER_HANDLE dataPublisher = DataPublisher_Create(TEST_MODEL_HANDLE, true);
+        TRANSACTION_HANDLE transaction = DataPublisher_StartTransaction(dataPublisher);
+        AGENT_DATA_TYPE value = MakeDouble(1);
+
+        // act
+        DATA_PUBLISHER_RESULT result = DataPublisher_PublishTransacted(transaction, REPORTED_PROPERTY_PATH, &value);
+
+        // assert
+        ASSERT_ARE_EQUAL(DATA_PUBLISHER_RESULT, DATA_PUBLISHER_SCHEMA_FAILED, result);
+
+        // cleanup
+        (void)DataPublisher_CancelTransaction(transaction);
+        DataPublisher_Destroy(dataPublisher);
+    }
+
+    TEST_FUNCTION(DataPublisher_EndTransaction_sends_the_paths_of_the_schema_not_the_ones_of_the_caller)
+    {
+        // arrange
+        DATA_PUBLISHER_HANDLE dataPublisher = DataPublisher_Create(TEST_MODEL_HANDLE, true);
+        TRANSACTION_HANDLE transaction = DataPublisher_StartTransaction(dataPublisher);
+        char propertyPath[] = "temperature";
+        PublishDouble(transaction, propertyPath, 21.5);
+        (void)strcpy(propertyPath, "overwritten");
+
+        // act
+        EndTransaction(transaction);
+
+        // assert
+        ASSERT_ARE_EQUAL(size_t, 1, sentValueCount);
+        ASSERT_ARE_EQUAL(char_ptr, "temperature", sentPropertyPaths[0]);
+
+        // cleanup
+        DataPublisher_Destroy(dataPublisher);
+    }
+
+    TEST_FUNCTION(DataPublisher_PublishTransacted_grows_the_values_past_the_initial_capacity)
+    {
+        // arrange
+        static const char* propertyPaths[] = { "p0", "p1", "p2", "p3", "p4", "p5", "p6", "p7", "p8", "p9", "p10" };
+        DATA_PUBLISHER_HANDLE dataPublisher = DataPublisher_Create(TEST_MODEL_HANDLE, true);
+        TRANSACTION_HANDLE transaction = DataPublisher_StartTransaction(dataPublisher);
+        size_t i;
+
+        // act
+        for (i = 0; i < COUNT_OF(propertyPaths); i++)
+        {
+            PublishDouble(transaction, propertyPaths[i], (double)i);
+        }
+        EndTransaction(transaction);
+
+        // assert
+        ASSERT_ARE_EQUAL(size_t, COUNT_OF(propertyPaths), sentValueCount);
+        for (i = 0; i < COUNT_OF(propertyPaths); i++)
+        {
+            ASSERT_ARE_EQUAL(char_ptr, propertyPaths[i], sentPropertyPaths[i]);
+            ASSERT_ARE_EQUAL(double, (double)i, sentValues[i]);
+        }
+
+        // cleanup
+        DataPublisher_Destroy(dataPublisher);
+    }
+
+    TEST_FUNCTION(DataPublisher_numeric_transaction_loop_does_not_allocate_once_warm)
+    {
+        // arrange
+        DATA_PUBLISHER_HANDLE dataPublisher = DataPublisher_Create(TEST_MODEL_HANDLE, true);
+        TRANSACTION_HANDLE transaction = DataPublisher_StartTransaction(dataPublisher);
+        size_t i;
+        PublishDouble(transaction, "temperature", 21.5);
+        PublishDouble(transaction, "humidity", 64.25);
+        EndTransaction(transaction);
+        umock_c_reset_all_calls();
+
+        for (i = 0; i < 3; i++)
+        {
+            STRICT_EXPECTED_CALL(Schema_GetModelPathDescriptor(TEST_MODEL_HANDLE, "temperature", IGNORED_PTR_ARG));
+            STRICT_EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_AGENT_DATA_TYPE(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+            STRICT_EXPECTED_CALL(Schema_GetModelPathDescriptor(TEST_MODEL_HANDLE, "humidity", IGNORED_PTR_ARG));
+            STRICT_EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_AGENT_DATA_TYPE(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+            STRICT_EXPECTED_CALL(DataMarshaller_SendData(TEST_DATA_MARSHALLER_HANDLE, 2, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+            STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
+            STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
+        }
+
+        // act
+        for (i = 0; i < 3; i++)
+        {
+            transaction = DataPublisher_StartTransaction(dataPublisher);
+            PublishDouble(transaction, "temperature", 22 + (double)i);
+            PublishDouble(transaction, "humidity", 65 + (double)i);
+            EndTransaction(transaction);
+        }
+
+        // assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(double, 24, sentValues[0]);
+        ASSERT_ARE_EQUAL(double, 67, sentValues[1]);
+
+        // cleanup
+        DataPublisher_Destroy(dataPublisher);
+    }
+
+END_TEST_SUITE(DataPublisher_ut)
@@ -0,0 +1,240 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "testrunnerswitcher.h"
+#include "azure_c_shared_utility/strings.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "agenttypesystem.h"
+#include "multitree.h"
+#include "jsonencoder.h"
+#include "jsondecoder.h"
+#include "cborencoder.h"
+#include "cbordecoder.h"
+
+/*kept small so the suite stays fast as a gate, raise it locally to get stable timings*/
+#ifndef PAYLOADENCODING_INT_ITERATIONS
+#define PAYLOADENCODING_INT_ITERATIONS 2000
+#endif
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+#define TELEMETRY_LEAF_COUNT 7
+
+static const char* telemetryPaths[TELEMETRY_LEAF_COUNT] =
+{
+    "deviceId",
+    "windSpeed",
+    "temperature",
+    "humidity",
+    "isOnline",
+    "location/latitude",
+    "location/longitude"
+};
+
+static AGENT_DATA_TYPE telemetryValues[TELEMETRY_LEAF_COUNT];
+
+/*the tree only points at telemetryValues, they are owned by the suite*/
+static int NoCloneFunction(void** destination, const void* source)
+{
+    *destination = (void*)source;
+    return 0;
+}
+
+static void NoFreeFunction(void* value)
+{
+    (void)value;
+}
+
+static MULTITREE_HANDLE CreateTelemetryTree(void)
+{
+    MULTITREE_HANDLE result = MultiTree_Create(NoCloneFunction, NoFreeFunction);
+    size_t i;
+    ASSERT_IS_NOT_NULL(result);
+    for (i = 0; i < TELEMETRY_LEAF_COUNT; i++)
+    {
+        ASSERT_ARE_EQUAL(int, (int)MULTITREE_OK, (int)MultiTree_AddLeaf(result, telemetryPaths[i], &telemetryValues[i]));
+    }
+    return result;
+}
+
+static size_t EncodeJSON(MULTITREE_HANDLE tree, STRING_HANDLE destination)
+{
+    ASSERT_ARE_EQUAL(int, 0, STRING_empty(destination));
+    ASSERT_ARE_EQUAL(int, (int)JSON_ENCODER_OK, (int)JSONEncoder_EncodeTree(tree, destination, (JSON_ENCODER_TOSTRING_FUNC)AgentDataTypes_ToString));
+    return STRING_length(destination);
+}
+
+static size_t EncodeCBOR(MULTITREE_HANDLE tree, unsigned char** destination)
+{
+    size_t size;
+    ASSERT_ARE_EQUAL(int, (int)CBOR_ENCODER_OK, (int)CBOREncoder_EncodeTree(tree, destination, &size));
+    return size;
+}
+
+static const char* GetLeafText(MULTITREE_HANDLE tree, const char* path)
+{
+    const void* value;
+    ASSERT_ARE_EQUAL(int, (int)MULTITREE_OK, (int)MultiTree_GetLeafValue(tree, path, &value));
+    return (const char*)value;
+}
+
+static double ElapsedNanosecondsPerOperation(clock_t start)
+{
+    return ((double)(clock() - start) / CLOCKS_PER_SEC) * 1e9 / PAYLOADENCODING_INT_ITERATIONS;
+}
+
+BEGIN_TEST_SUITE(payloadencoding_int)
+
+    TEST_SUITE_INITIALIZE(TestClassInitialize)
+    {
+        TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+        g_testByTest = TEST_MUTEX_CREATE();
+        ASSERT_IS_NOT_NULL(g_testByTest);
+
+        ASSERT_ARE_EQUAL(int, (int)AGENT_DATA_TYPES_OK, (int)Create_AGENT_DATA_TYPE_from_charz(&telemetryValues[0], "cellular-device-000042"));
+        ASSERT_ARE_EQUAL(int, (int)AGENT_DATA_TYPES_OK, (int)Create_AGENT_DATA_TYPE_from_SINT32(&telemetryValues[1], 12));
+        ASSERT_ARE_EQUAL(int, (int)AGENT_DATA_TYPES_OK, (int)Create_AGENT_DATA_TYPE_from_DOUBLE(&telemetryValues[2], 21.5));
+        ASSERT_ARE_EQUAL(int, (int)AGENT_DATA_TYPES_OK, (int)Create_AGENT_DATA_TYPE_from_DOUBLE(&telemetryValues[3], 64.25));
+        ASSERT_ARE_EQUAL(int, (int)AGENT_DATA_TYPES_OK, (int)Create_EDM_BOOLEAN_from_int(&telemetryValues[4], 1));
+        ASSERT_ARE_EQUAL(int, (int)AGENT_DATA_TYPES_OK, (int)Create_AGENT_DATA_TYPE_from_DOUBLE(&telemetryValues[5], 47.6062));
+        ASSERT_ARE_EQUAL(int, (int)AGENT_DATA_TYPES_OK, (int)Create_AGENT_DATA_TYPE_from_DOUBLE(&telemetryValues[6], -122.3321));
+    }
+
+    TEST_SUITE_CLEANUP(TestClassCleanup)
+    {
+        size_t i;
+        for (i = 0; i < TELEMETRY_LEAF_COUNT; i++)
+        {
+            Destroy_AGENT_DATA_TYPE(&telemetryValues[i]);
+        }
+
+        TEST_MUTEX_DESTROY(g_testByTest);
+        TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    }
+
+    TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+    {
+        if (TEST_MUTEX_ACQUIRE(g_testByTest))
+        {
+            ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+        }
+    }
+
+    TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+    {
+        TEST_MUTEX_RELEASE(g_testByTest);
+    }
+
+    TEST_FUNCTION(CBOR_payload_of_a_telemetry_message_is_smaller_than_the_JSON_payload)
+    {
+        ///arrange
+        MULTITREE_HANDLE tree = CreateTelemetryTree();
+        STRING_HANDLE json = STRING_new();
+        unsigned char* cbor;
+        size_t jsonSize;
+        size_t cborSize;
+        ASSERT_IS_NOT_NULL(json);
+
+        ///act
+        jsonSize = EncodeJSON(tree, json);
+        cborSize = EncodeCBOR(tree, &cbor);
+
+        ///assert
+        LogInfo("telemetry payload: JSON %lu bytes, CBOR %lu bytes", (unsigned long)jsonSize, (unsigned long)cborSize);
+        ASSERT_IS_TRUE(cborSize < jsonSize);
+
+        ///cleanup
+        free(cbor);
+        STRING_delete(json);
+        MultiTree_Destroy(tree);
+    }
+
+    TEST_FUNCTION(CBOR_payload_decodes_to_the_same_leaves_as_the_JSON_payload)
+    {
+        ///arrange
+        MULTITREE_HANDLE tree = CreateTelemetryTree();
+        STRING_HANDLE json = STRING_new();
+        unsigned char* cbor;
+        size_t cborSize;
+        char* jsonText;
+        MULTITREE_HANDLE fromJSON;
+        MULTITREE_HANDLE fromCBOR;
+        size_t i;
+        ASSERT_IS_NOT_NULL(json);
+        (void)EncodeJSON(tree, json);
+        cborSize = EncodeCBOR(tree, &cbor);
+        jsonText = (char*)malloc(STRING_length(json) + 1);
+        ASSERT_IS_NOT_NULL(jsonText);
+        (void)strcpy(jsonText, STRING_c_str(json));
+
+        ///act
+        ASSERT_ARE_EQUAL(int, (int)JSON_DECODER_OK, (int)JSONDecoder_JSON_To_MultiTree(jsonText, &fromJSON));
+        ASSERT_ARE_EQUAL(int, (int)CBOR_DECODER_OK, (int)CBORDecoder_CBOR_To_MultiTree(cbor, cborSize, NULL, &fromCBOR));
+
+        ///assert
+        for (i = 0; i < TELEMETRY_LEAF_COUNT; i++)
+        {
+            const char* jsonLeaf = GetLeafText(fromJSON, telemetryPaths[i]);
+            const char* cborLeaf = GetLeafText(fromCBOR, telemetryPaths[i]);
+            if (telemetryValues[i].type == EDM_DOUBLE_TYPE)
+            {
+                /*the text of a number can differ in its digits, not in its value*/
+                ASSERT_ARE_EQUAL(double, atof(jsonLeaf), atof(cborLeaf));
+            }
+            else
+            {
+                ASSERT_ARE_EQUAL(char_ptr, jsonLeaf, cborLeaf);
+            }
+        }
+
+        ///cleanup
+        MultiTree_Destroy(fromCBOR);
+        MultiTree_Destroy(fromJSON);
+        free(jsonText);
+        free(cbor);
+        STRING_delete(json);
+        MultiTree_Destroy(tree);
+    }
+
+    TEST_FUNCTION(CBOR_and_JSON_encoding_cost_of_a_telemetry_message)
+    {
+        ///arrange
+        MULTITREE_HANDLE tree = CreateTelemetryTree();
+        STRING_HANDLE json = STRING_new();
+        clock_t start;
+        double jsonNanoseconds;
+        double cborNanoseconds;
+        size_t i;
+        ASSERT_IS_NOT_NULL(json);
+
+        ///act
+        start = clock();
+        for (i = 0; i < PAYLOADENCODING_INT_ITERATIONS; i++)
+        {
+            (void)EncodeJSON(tree, json);
+        }
+        jsonNanoseconds = ElapsedNanosecondsPerOperation(start);
+
+        start = clock();
+        for (i = 0; i < PAYLOADENCODING_INT_ITERATIONS; i++)
+        {
+            unsigned char* cbor;
+            (void)EncodeCBOR(tree, &cbor);
+            free(cbor);
+        }
+        cborNanoseconds = ElapsedNanosecondsPerOperation(start);
+
+        ///assert
+        /*timings are reported, not asserted, they depend on the machine running the gate*/
+        LogInfo("telemetry encoding over %d iterations: JSON %.0f ns/op, CBOR %.0f ns/op", PAYLOADENCODING_INT_ITERATIONS, jsonNanoseconds, cborNanoseconds);
+
+        ///cleanup
+        STRING_delete(json);
+        MultiTree_Destroy(tree);
+    }
+
+END_TEST_SUITE(payloadencoding_int)
@@ -16,6 +16,11 @@ void* my_gballoc_malloc(size_t t)
     return malloc(t);
 }
 
+void* my_gballoc_calloc(size_t n, size_t t)
+{
+    return calloc(n, t);
+}
+
 void* my_gballoc_realloc(void* v, size_t t)
 {
     return realloc(v, t);
@@ -167,6 +172,7 @@ BEGIN_TEST_SUITE(Schema_ut)
 
         REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_calloc, my_gballoc_calloc);
         REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
         REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_realloc, NULL);
@@ -3786,6 +3792,49 @@ BEGIN_TEST_SUITE(Schema_ut)
         Schema_Destroy(schemaHandle);
     }
 
+    /* Tests_SRS_SCHEMA_99_177: [Schema_ModelPropertyByPathExists shall return true if a leaf property exists in the model modelTypeHandle.] */
+    TEST_FUNCTION(Schema_When_Property_Is_Added_To_A_Child_Model_After_A_Lookup_Schema_ModelPropertyByPathExists_Returns_True)
+    {
+        ///arrange
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        SCHEMA_MODEL_TYPE_HANDLE bigModel = Schema_CreateModelType(schemaHandle, "someBigModel");
+        SCHEMA_MODEL_TYPE_HANDLE mediumModel = Schema_CreateModelType(schemaHandle, "someMediumModel");
+        (void)Schema_AddModelModel(bigModel, "theMediumModel", mediumModel, 0, NULL);
+        bool resultBeforeAdd = Schema_ModelPropertyByPathExists(bigModel, "theMediumModel/propertyName");
+        (void)Schema_AddModelProperty(mediumModel, "propertyName", "type");
+
+        ///act
+        bool result = Schema_ModelPropertyByPathExists(bigModel, "theMediumModel/propertyName");
+
+        ///assert
+        ASSERT_IS_FALSE(resultBeforeAdd);
+        ASSERT_IS_TRUE(result);
+
+        ///cleanup
+        Schema_Destroy(schemaHandle);
+    }
+
+    /* Tests_SRS_SCHEMA_99_181: [If the property cannot be found Schema_ModelPropertyByPathExists shall return false.] */
+    TEST_FUNCTION(Schema_When_The_Path_Points_To_A_Reported_Property_Schema_ModelPropertyByPathExists_Returns_False)
+    {
+        ///arrange
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        SCHEMA_MODEL_TYPE_HANDLE bigModel = Schema_CreateModelType(schemaHandle, "someBigModel");
+        SCHEMA_MODEL_TYPE_HANDLE mediumModel = Schema_CreateModelType(schemaHandle, "someMediumModel");
+        (void)Schema_AddModelModel(bigModel, "theMediumModel", mediumModel, 0, NULL);
+        (void)Schema_AddModelReportedProperty(mediumModel, "reportedName", "type");
+
+        ///act
+        bool result = Schema_ModelPropertyByPathExists(bigModel, "theMediumModel/reportedName");
+
+        ///assert
+        ASSERT_IS_FALSE(result);
+        ASSERT_IS_TRUE(Schema_ModelReportedPropertyByPathExists(bigModel, "theMediumModel/reportedName"));
+
+        ///cleanup
+        Schema_Destroy(schemaHandle);
+    }
+
     /* Tests_SRS_SCHEMA_99_182: [A single slash ('/') at the beginning of the path shall be ignored and the path shall still be valid.] */
     TEST_FUNCTION(Schema_When_The_First_Slash_In_The_Path_With_Only_A_PropertyName_Is_Ignored)
     {
@@ -4108,6 +4157,43 @@ BEGIN_TEST_SUITE(Schema_ut)
         Schema_Destroy(schemaHandle);
     }
 
+    /*the calls that give a new path index to a model that is alone in the only schema*/
+    static void Schema_IndexModel_inert_path(size_t nReportedProperties, size_t nDesiredProperties)
+    {
+        STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG)) /*the schemas*/
+            .IgnoreArgument_handle();
+
+        for (size_t pass = 0; pass < 2; pass++) /*the index is measured, allocated then filled*/
+        {
+            STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG)) /*reported properties*/
+                .IgnoreArgument_handle();
+            for (size_t i = 0; i < nReportedProperties; i++)
+            {
+                STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, i))
+                    .IgnoreArgument_handle();
+            }
+            STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG)) /*desired properties*/
+                .IgnoreArgument_handle();
+            for (size_t i = 0; i < nDesiredProperties; i++)
+            {
+                STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, i))
+                    .IgnoreArgument_handle();
+            }
+            STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG)) /*models in model*/
+                .IgnoreArgument_handle();
+            if (pass == 0)
+            {
+                STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+                    .IgnoreArgument_size();
+            }
+        }
+
+        STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, 0)) /*looking for models containing the model*/
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, 0)) /*swapping in the new indexes*/
+            .IgnoreArgument_handle();
+    }
+
     void Schema_AddModelReportedProperty_inert_path(const char* reportedPropertyName, const char* reportedPropertyType)
     {
         STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, reportedPropertyName))
@@ -4122,6 +4208,7 @@ BEGIN_TEST_SUITE(Schema_ut)
         STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1))
             .IgnoreArgument_handle()
             .IgnoreArgument_elements();
+        Schema_IndexModel_inert_path(1, 0);
     }
 
     /*Tests_SRS_SCHEMA_02_005: [ Schema_AddModelReportedProperty shall record reportedPropertyName and reportedPropertyType. ]*/
@@ -4164,7 +4251,18 @@ BEGIN_TEST_SUITE(Schema_ut)
 
         size_t calls_that_cannot_fail[] =
         {
-            0 /*VECTOR_find_if*/
+            0, /*VECTOR_find_if*/
+            5, /*VECTOR_size*/
+            6, /*VECTOR_size*/
+            7, /*VECTOR_element*/
+            8, /*VECTOR_size*/
+            9, /*VECTOR_size*/
+            11, /*VECTOR_size*/
+            12, /*VECTOR_element*/
+            13, /*VECTOR_size*/
+            14, /*VECTOR_size*/
+            15, /*VECTOR_element*/
+            16, /*VECTOR_element*/
         };
 
         for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
@@ -4705,6 +4803,8 @@ BEGIN_TEST_SUITE(Schema_ut)
         STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1))
             .IgnoreArgument_handle()
             .IgnoreArgument_elements();
+
+        Schema_IndexModel_inert_path(0, 1);
     }
 
     /*Tests_SRS_SCHEMA_02_027: [ Schema_AddModelDesiredProperty shall add the desired property given by the name desiredPropertyName and the type desiredPropertyType to the collection of existing desired properties. ]*/
@@ -4749,7 +4849,18 @@ BEGIN_TEST_SUITE(Schema_ut)
 
         size_t calls_that_cannot_fail[] =
         {
-            0 /*VECTOR_find_if*/
+            0, /*VECTOR_find_if*/
+            5, /*VECTOR_size*/
+            6, /*VECTOR_size*/
+            7, /*VECTOR_element*/
+            8, /*VECTOR_size*/
+            9, /*VECTOR_size*/
+            11, /*VECTOR_size*/
+            12, /*VECTOR_element*/
+            13, /*VECTOR_size*/
+            14, /*VECTOR_size*/
+            15, /*VECTOR_element*/
+            16, /*VECTOR_element*/
         };
 
         for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
@@ -5643,6 +5754,48 @@ BEGIN_TEST_SUITE(Schema_ut)
         Schema_Destroy(schemaHandle);
     }
 
+    /*Tests_SRS_SCHEMA_02_083: [ Otherwise Schema_GetModelElementByName shall fail and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_NOT_FOUND. ]*/
+    TEST_FUNCTION(Schema_GetModelElementByName_with_a_path_to_a_child_element_returns_SCHEMA_NOT_FOUND)
+    {
+        ///arrange
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        SCHEMA_MODEL_TYPE_HANDLE modelType = Schema_CreateModelType(schemaHandle, "Model");
+        SCHEMA_MODEL_TYPE_HANDLE minerModel = Schema_CreateModelType(schemaHandle, "someMinerModel");
+        (void)Schema_AddModelProperty(minerModel, "regularProperty", "j");
+        (void)Schema_AddModelModel(modelType, "ManicMiner", minerModel, 5, NULL);
+
+        ///act
+        SCHEMA_MODEL_ELEMENT shouldBeNotFound = Schema_GetModelElementByName(modelType, "ManicMiner/regularProperty");
+
+        ///assert
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_NOT_FOUND, shouldBeNotFound.elementType);
+
+        ///clean
+        Schema_Destroy(schemaHandle);
+    }
+
+    /*Tests_SRS_SCHEMA_02_078: [ If elementName is a property then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_PROPERTY and SCHEMA_MODEL_ELEMENT.elementHandle.propertyHandle to the handle of the property. ]*/
+    TEST_FUNCTION(Schema_GetModelElementByName_finds_a_property_added_after_a_previous_lookup)
+    {
+        ///arrange
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        SCHEMA_MODEL_TYPE_HANDLE modelType = Schema_CreateModelType(schemaHandle, "Model");
+        (void)Schema_AddModelProperty(modelType, "firstProperty", "j");
+        SCHEMA_MODEL_ELEMENT beforeAdd = Schema_GetModelElementByName(modelType, "secondProperty");
+        (void)Schema_AddModelProperty(modelType, "secondProperty", "j");
+
+        ///act
+        SCHEMA_MODEL_ELEMENT afterAdd = Schema_GetModelElementByName(modelType, "secondProperty");
+
+        ///assert
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_NOT_FOUND, beforeAdd.elementType);
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_PROPERTY, afterAdd.elementType);
+        ASSERT_ARE_EQUAL(void_ptr, (void*)Schema_GetModelPropertyByName(modelType, "secondProperty"), (void*)afterAdd.elementHandle.propertyHandle);
+
+        ///clean
+        Schema_Destroy(schemaHandle);
+    }
+
     /*Tests_SRS_SCHEMA_02_084: [ If desiredPropertyHandle is NULL then Schema_GetModelDesiredProperty_pfOnDesiredProperty shall return NULL. ]*/
     TEST_FUNCTION(Schema_GetModelDesiredProperty_pfOnDesiredProperty_with_NULL_desiredPropertyHandle_returns_NULL)
     {
@@ -6503,4 +6656,171 @@ BEGIN_TEST_SUITE(Schema_ut)
         ///clean
         Schema_Destroy(schemaHandle);
     }
+
+    TEST_FUNCTION(Schema_GetModelPathId_with_NULL_modelTypeHandle_fails)
+    {
+        ///arrange
+        size_t id;
+
+        ///act
+        SCHEMA_RESULT result = Schema_GetModelPathId(NULL, "a", &id);
+
+        ///assert
+        ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_INVALID_ARG, result);
+    }
+
+    TEST_FUNCTION(Schema_GetModelPathId_gives_ids_in_declaration_order_and_Schema_GetModelPathById_maps_them_back)
+    {
+        ///arrange
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        SCHEMA_MODEL_TYPE_HANDLE innerModel = Schema_CreateModelType(schemaHandle, "InnerModel");
+        SCHEMA_MODEL_TYPE_HANDLE model = Schema_CreateModelType(schemaHandle, "Model");
+        size_t temperatureId;
+        size_t statusId;
+        size_t innerId;
+        size_t innerPressureId;
+        (void)Schema_AddModelProperty(innerModel, "pressure", "double");
+        (void)Schema_AddModelProperty(model, "temperature", "double");
+        (void)Schema_AddModelReportedProperty(model, "status", "ascii_char_ptr");
+        (void)Schema_AddModelModel(model, "inner", innerModel, 0, NULL);
+
+        ///act
+        SCHEMA_RESULT result1 = Schema_GetModelPathId(model, "temperature", &temperatureId);
+        SCHEMA_RESULT result2 = Schema_GetModelPathId(model, "status", &statusId);
+        SCHEMA_RESULT result3 = Schema_GetModelPathId(model, "inner", &innerId);
+        SCHEMA_RESULT result4 = Schema_GetModelPathId(model, "/inner/pressure", &innerPressureId);
+
+        ///assert
+        ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_OK, result1);
+        ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_OK, result2);
+        ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_OK, result3);
+        ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_OK, result4);
+        ASSERT_ARE_EQUAL(size_t, 0, temperatureId);
+        ASSERT_ARE_EQUAL(size_t, 1, statusId);
+        ASSERT_ARE_EQUAL(size_t, 2, innerId);
+        ASSERT_ARE_EQUAL(size_t, 3, innerPressureId);
+        ASSERT_ARE_EQUAL(char_ptr, "temperature", Schema_GetModelPathById(model, temperatureId));
+        ASSERT_ARE_EQUAL(char_ptr, "inner/pressure", Schema_GetModelPathById(model, innerPressureId));
+        ASSERT_IS_NULL(Schema_GetModelPathById(model, 4));
+
+        ///clean
+        Schema_Destroy(schemaHandle);
+    }
+
+    TEST_FUNCTION(Schema_GetModelPathId_with_an_unknown_path_returns_SCHEMA_ELEMENT_NOT_FOUND)
+    {
+        ///arrange
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        SCHEMA_MODEL_TYPE_HANDLE model = Schema_CreateModelType(schemaHandle, "Model");
+        size_t id;
+        (void)Schema_AddModelProperty(model, "temperature", "double");
+
+        ///act
+        SCHEMA_RESULT result = Schema_GetModelPathId(model, "humidity", &id);
+
+        ///assert
+        ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_ELEMENT_NOT_FOUND, result);
+
+        ///clean
+        Schema_Destroy(schemaHandle);
+    }
+
+    TEST_FUNCTION(Schema_GetModelPathDescriptor_resolves_a_desired_property_in_a_model_in_model)
+    {
+        ///arrange
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        SCHEMA_MODEL_TYPE_HANDLE innerModel = Schema_CreateModelType(schemaHandle, "InnerModel");
+        SCHEMA_MODEL_TYPE_HANDLE model = Schema_CreateModelType(schemaHandle, "Model");
+        SCHEMA_PATH_DESCRIPTOR innerDescriptor;
+        SCHEMA_PATH_DESCRIPTOR setPointDescriptor;
+        (void)Schema_AddModelModel(model, "inner", innerModel, 8, NULL);
+        (void)Schema_AddModelDesiredProperty(innerModel, "setPoint", "double", g_pfDesiredPropertyFromAGENT_DATA_TYPE, g_pfDesiredPropertyInitialize, g_pfDesiredPropertyDeinitialize, 4, g_onDesiredProperty);
+
+        ///act
+        SCHEMA_RESULT result1 = Schema_GetModelPathDescriptor(model, "inner", &innerDescriptor);
+        SCHEMA_RESULT result2 = Schema_GetModelPathDescriptor(model, "/inner/setPoint", &setPointDescriptor);
+
+        ///assert
+        ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_OK, result1);
+        ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_OK, result2);
+        ASSERT_ARE_EQUAL(void_ptr, innerModel, innerDescriptor.modelHandle);
+        ASSERT_ARE_EQUAL(size_t, 8, innerDescriptor.offset);
+        ASSERT_ARE_EQUAL(char_ptr, "inner/setPoint", setPointDescriptor.path);
+        ASSERT_ARE_EQUAL(void_ptr, Schema_GetModelDesiredPropertyByName(innerModel, "setPoint"), setPointDescriptor.desiredPropertyHandle);
+        ASSERT_IS_NULL(setPointDescriptor.propertyHandle);
+        ASSERT_ARE_EQUAL(char_ptr, "double", setPointDescriptor.type);
+        ASSERT_ARE_EQUAL(size_t, 12, setPointDescriptor.offset);
+        ASSERT_ARE_EQUAL(void_ptr, (void*)g_pfDesiredPropertyFromAGENT_DATA_TYPE, (void*)setPointDescriptor.desiredPropertyFromAGENT_DATA_TYPE);
+        ASSERT_ARE_EQUAL(void_ptr, (void*)g_onDesiredProperty, (void*)setPointDescriptor.onDesiredProperty);
+
+        ///clean
+        Schema_Destroy(schemaHandle);
+    }
+
+    TEST_FUNCTION(Schema_ModelPropertyByPathExists_does_not_allocate)
+    {
+        ///arrange
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        SCHEMA_MODEL_TYPE_HANDLE innerModel = Schema_CreateModelType(schemaHandle, "InnerModel");
+        SCHEMA_MODEL_TYPE_HANDLE model = Schema_CreateModelType(schemaHandle, "Model");
+        (void)Schema_AddModelModel(model, "inner", innerModel, 0, NULL);
+        (void)Schema_AddModelProperty(innerModel, "pressure", "double");
+        umock_c_reset_all_calls();
+
+        ///act
+        bool result = Schema_ModelPropertyByPathExists(model, "inner/pressure");
+
+        ///assert
+        ASSERT_IS_TRUE(result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///clean
+        Schema_Destroy(schemaHandle);
+    }
+
+    /*the path walk stops at the first property it meets, what follows the property is not looked at*/
+    TEST_FUNCTION(Schema_ModelPropertyByPathExists_with_a_path_going_past_a_property_returns_true)
+    {
+        ///arrange
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        SCHEMA_MODEL_TYPE_HANDLE innerModel = Schema_CreateModelType(schemaHandle, "InnerModel");
+        SCHEMA_MODEL_TYPE_HANDLE model = Schema_CreateModelType(schemaHandle, "Model");
+        (void)Schema_AddModelModel(model, "inner", innerModel, 0, NULL);
+        (void)Schema_AddModelProperty(innerModel, "pressure", "double");
+        (void)Schema_AddModelProperty(model, "prop", "double");
+
+        ///act
+        bool result1 = Schema_ModelPropertyByPathExists(model, "prop/garbage");
+        bool result2 = Schema_ModelPropertyByPathExists(model, "inner/pressure/garbage/more");
+        bool result3 = Schema_ModelPropertyByPathExists(model, "inner/garbage/pressure");
+
+        ///assert
+        ASSERT_IS_TRUE(result1);
+        ASSERT_IS_TRUE(result2);
+        ASSERT_IS_FALSE(result3);
+
+        ///clean
+        Schema_Destroy(schemaHandle);
+    }
+
+    TEST_FUNCTION(Schema_AddModelModel_that_would_make_a_model_contain_itself_fails)
+    {
+        ///arrange
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        SCHEMA_MODEL_TYPE_HANDLE innerModel = Schema_CreateModelType(schemaHandle, "InnerModel");
+        SCHEMA_MODEL_TYPE_HANDLE model = Schema_CreateModelType(schemaHandle, "Model");
+        (void)Schema_AddModelModel(model, "inner", innerModel, 0, NULL);
+
+        ///act
+        SCHEMA_RESULT result1 = Schema_AddModelModel(innerModel, "outer", model, 0, NULL);
+        SCHEMA_RESULT result2 = Schema_AddModelModel(model, "self", model, 0, NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_INVALID_ARG, result1);
+        ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_INVALID_ARG, result2);
+        ASSERT_IS_FALSE(Schema_ModelPropertyByPathExists(model, "self"));
+
+        ///clean
+        Schema_Destroy(schemaHandle);
+    }
 END_TEST_SUITE(Schema_ut)
@@ -366,6 +366,9 @@ public:
     MOCK_STATIC_METHOD_1(, void, DataMarshaller_SetMaxBufferSize, size_t, bytes)
     MOCK_VOID_METHOD_END()
 
+    MOCK_STATIC_METHOD_1(, void, DataMarshaller_SetDefaultEncoding, PAYLOAD_ENCODING, encoding)
+    MOCK_VOID_METHOD_END()
+
     /* DataPublisher mocks */
     MOCK_STATIC_METHOD_1(, void, DataPublisher_SetMaxBufferSize, size_t, bytes)
     MOCK_VOID_METHOD_END()
@@ -403,6 +406,7 @@ DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , AGENT_DATA_TYPES_RESULT
 DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , AGENT_DATA_TYPES_RESULT, Create_AGENT_DATA_TYPE_from_EDM_BINARY, AGENT_DATA_TYPE*, agentData, EDM_BINARY, v);
 DECLARE_GLOBAL_MOCK_METHOD_1(CIoTHubSchemaClientMocks, , void, BufferProcess_SetRetryInterval, uint64_t, milliseconds);
 DECLARE_GLOBAL_MOCK_METHOD_1(CIoTHubSchemaClientMocks, , void, DataMarshaller_SetMaxBufferSize, size_t, bytes);
+DECLARE_GLOBAL_MOCK_METHOD_1(CIoTHubSchemaClientMocks, , void, DataMarshaller_SetDefaultEncoding, PAYLOAD_ENCODING, encoding);
 DECLARE_GLOBAL_MOCK_METHOD_1(CIoTHubSchemaClientMocks, , void, DataPublisher_SetMaxBufferSize, size_t, bytes);
 
 DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , int, mallocAndStrcpy_s, char**, destination, const char*, source);
@@ -646,4 +650,19 @@ BEGIN_TEST_SUITE(serializer_ut)
             ASSERT_ARE_EQUAL(SERIALIZER_RESULT, SERIALIZER_OK, result);
         }
 
+        TEST_FUNCTION(serializer_setconfig_passes_the_payload_encoding_to_the_data_marshaller)
+        {
+            // arrange
+            CNiceCallComparer<CIoTHubSchemaClientMocks> mocks;
+            PAYLOAD_ENCODING encoding = PAYLOAD_ENCODING_CBOR;
+
+            STRICT_EXPECTED_CALL(mocks, DataMarshaller_SetDefaultEncoding(PAYLOAD_ENCODING_CBOR));
+
+            // act
+            SERIALIZER_RESULT result = serializer_setconfig(SerializePayloadEncoding, &encoding);
+
+            // assert
+            ASSERT_ARE_EQUAL(SERIALIZER_RESULT, SERIALIZER_OK, result);
+        }
+
 END_TEST_SUITE(serializer_ut)
@@ -315,6 +315,10 @@ public:
     MOCK_STATIC_METHOD_1(, void, DataPublisher_SetMaxBufferSize, size_t, bytes)
     MOCK_VOID_METHOD_END()
 
+    /* DataMarshaller mocks */
+    MOCK_STATIC_METHOD_1(, void, DataMarshaller_SetDefaultEncoding, PAYLOAD_ENCODING, encoding)
+    MOCK_VOID_METHOD_END()
+
     MOCK_STATIC_METHOD_2(, int, mallocAndStrcpy_s, char**, destination, const char*, source);
     int result2 = BASEIMPLEMENTATION::mallocAndStrcpy_s(destination, source);
     MOCK_METHOD_END(int, result2);
@@ -354,6 +358,7 @@ DECLARE_GLOBAL_MOCK_METHOD_1(CIoTHubSchemaClientMocks, , DEVICE_RESULT, Device_E
 DECLARE_GLOBAL_MOCK_METHOD_1(CIoTHubSchemaClientMocks, , DEVICE_RESULT, Device_CancelTransaction, TRANSACTION_HANDLE, transactionHandle);
 
 DECLARE_GLOBAL_MOCK_METHOD_1(CIoTHubSchemaClientMocks, , void, DataPublisher_SetMaxBufferSize, size_t, bytes);
+DECLARE_GLOBAL_MOCK_METHOD_1(CIoTHubSchemaClientMocks, , void, DataMarshaller_SetDefaultEncoding, PAYLOAD_ENCODING, encoding);
 
 DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , int, mallocAndStrcpy_s, char**, destination, const char*, source);
 /* Requirements tested by the virtue of using the exposed API:
@@ -0,0 +1,426 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <string.h>
+#include "testrunnerswitcher.h"
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/strings.h"
+#include "agenttypesystem.h"
+#include "multitree.h"
+#include "jsonencoder.h"
+#include "jsondecoder.h"
+#include "perf_report.h"
+
+/*iterations of one timed repetition, raise it locally to get stable timings on a noisy machine*/
+#ifndef SERIALIZER_PERF_ITERATIONS
+#define SERIALIZER_PERF_ITERATIONS 5000
+#endif
+
+#define SUITE_NAME "serializer_perf"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+#define TELEMETRY_LEAF_COUNT 7
+
+static const char* telemetryPaths[TELEMETRY_LEAF_COUNT] =
+{
+    "deviceId",
+    "windSpeed",
+    "temperature",
+    "humidity",
+    "isOnline",
+    "location/latitude",
+    "location/longitude"
+};
+
+static AGENT_DATA_TYPE telemetryValues[TELEMETRY_LEAF_COUNT];
+
+typedef struct ENCODE_CONTEXT_TAG
+{
+    MULTITREE_HANDLE tree;
+    STRING_HANDLE destination;
+} ENCODE_CONTEXT;
+
+typedef struct DECODE_CONTEXT_TAG
+{
+    const char* json;
+    size_t jsonSize;
+    char* scratch;
+} DECODE_CONTEXT;
+
+typedef struct TOSTRING_CONTEXT_TAG
+{
+    const AGENT_DATA_TYPE* value;
+    STRING_HANDLE destination;
+} TOSTRING_CONTEXT;
+
+typedef struct FROMSTRING_CONTEXT_TAG
+{
+    const char* source;
+    AGENT_DATA_TYPE_TYPE type;
+} FROMSTRING_CONTEXT;
+
+/*the tree only points at telemetryValues, they are owned by the suite*/
+static int NoCloneFunction(void** destination, const void* source)
+{
+    *destination = (void*)source;
+    return 0;
+}
+
+static void NoFreeFunction(void* value)
+{
+    (void)value;
+}
+
+static MULTITREE_HANDLE CreateTelemetryTree(void)
+{
+    MULTITREE_HANDLE result = MultiTree_Create(NoCloneFunction, NoFreeFunction);
+    size_t i;
+    ASSERT_IS_NOT_NULL(result);
+    for (i = 0; i < TELEMETRY_LEAF_COUNT; i++)
+    {
+        ASSERT_ARE_EQUAL(int, (int)MULTITREE_OK, (int)MultiTree_AddLeaf(result, telemetryPaths[i], &telemetryValues[i]));
+    }
+    return result;
+}
+
+static int JSONEncoder_EncodeTree_operation(void* context)
+{
+    ENCODE_CONTEXT* encodeContext = (ENCODE_CONTEXT*)context;
+    int result;
+    if (STRING_empty(encodeContext->destination) != 0)
+    {
+        result = __LINE__;
+    }
+    else if (JSONEncoder_EncodeTree(encodeContext->tree, encodeContext->destination, (JSON_ENCODER_TOSTRING_FUNC)AgentDataTypes_ToString) != JSON_ENCODER_OK)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+/*the decoder parses in place, so every operation starts from a fresh copy of the text, the copy is part of the timing*/
+static int JSONDecoder_JSON_To_MultiTree_operation(void* context)
+{
+    DECODE_CONTEXT* decodeContext = (DECODE_CONTEXT*)context;
+    MULTITREE_HANDLE tree;
+    int result;
+    (void)memcpy(decodeContext->scratch, decodeContext->json, decodeContext->jsonSize);
+    if (JSONDecoder_JSON_To_MultiTree(decodeContext->scratch, &tree) != JSON_DECODER_OK)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        MultiTree_Destroy(tree);
+        result = 0;
+    }
+    return result;
+}
+
+static int AgentDataTypes_ToString_operation(void* context)
+{
+    TOSTRING_CONTEXT* toStringContext = (TOSTRING_CONTEXT*)context;
+    int result;
+    if (STRING_empty(toStringContext->destination) != 0)
+    {
+        result = __LINE__;
+    }
+    else if (AgentDataTypes_ToString(toStringContext->destination, toStringContext->value) != AGENT_DATA_TYPES_OK)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+/*twin desired properties arrive as text, this is the parse of one leaf*/
+static int CreateAgentDataType_From_String_operation(void* context)
+{
+    FROMSTRING_CONTEXT* fromStringContext = (FROMSTRING_CONTEXT*)context;
+    AGENT_DATA_TYPE value;
+    int result;
+    if (CreateAgentDataType_From_String(fromStringContext->source, fromStringContext->type, &value) != AGENT_DATA_TYPES_OK)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        Destroy_AGENT_DATA_TYPE(&value);
+        result = 0;
+    }
+    return result;
+}
+
+/*the slow path of CreateAgentDataType_From_String on its own, for comparing the fast path against*/
+static int strtod_operation(void* context)
+{
+    FROMSTRING_CONTEXT* fromStringContext = (FROMSTRING_CONTEXT*)context;
+    char* end;
+    (void)strtod(fromStringContext->source, &end);
+    return (*end == '\0') ? 0 : __LINE__;
+}
+
+static void RunBenchmark(const char* benchmarkName, PERF_OPERATION operation, void* context)
+{
+    PERF_RESULT result;
+    ASSERT_ARE_EQUAL(int, 0, perf_run(SUITE_NAME, benchmarkName, SERIALIZER_PERF_ITERATIONS, operation, context, &result));
+    ASSERT_IS_TRUE(result.ns_per_op > 0);
+}
+
+static void RunToStringBenchmark(const char* benchmarkName, const AGENT_DATA_TYPE* value, const char* expectedText)
+{
+    TOSTRING_CONTEXT context;
+    context.value = value;
+    context.destination = STRING_new();
+    ASSERT_IS_NOT_NULL(context.destination);
+    ASSERT_ARE_EQUAL(int, 0, AgentDataTypes_ToString_operation(&context));
+    ASSERT_ARE_EQUAL(char_ptr, expectedText, STRING_c_str(context.destination));
+
+    RunBenchmark(benchmarkName, AgentDataTypes_ToString_operation, &context);
+
+    STRING_delete(context.destination);
+}
+
+static void RunFromStringBenchmark(const char* benchmarkName, const char* source, AGENT_DATA_TYPE_TYPE type, AGENT_DATA_TYPE* parsed)
+{
+    FROMSTRING_CONTEXT context;
+    context.source = source;
+    context.type = type;
+    ASSERT_ARE_EQUAL(int, (int)AGENT_DATA_TYPES_OK, (int)CreateAgentDataType_From_String(source, type, parsed));
+    ASSERT_ARE_EQUAL(int, (int)type, (int)parsed->type);
+
+    RunBenchmark(benchmarkName, CreateAgentDataType_From_String_operation, &context);
+}
+
+static void RunDoubleFromStringBenchmark(const char* benchmarkName, const char* source)
+{
+    AGENT_DATA_TYPE parsed;
+    RunFromStringBenchmark(benchmarkName, source, EDM_DOUBLE_TYPE, &parsed);
+    ASSERT_IS_TRUE(parsed.value.edmDouble.value == strtod(source, NULL));
+    Destroy_AGENT_DATA_TYPE(&parsed);
+}
+
+static void RunSingleFromStringBenchmark(const char* benchmarkName, const char* source)
+{
+    AGENT_DATA_TYPE parsed;
+    RunFromStringBenchmark(benchmarkName, source, EDM_SINGLE_TYPE, &parsed);
+    ASSERT_IS_TRUE(parsed.value.edmSingle.value == strtof(source, NULL));
+    Destroy_AGENT_DATA_TYPE(&parsed);
+}
+
+static void RunStrtodBenchmark(const char* benchmarkName, const char* source)
+{
+    FROMSTRING_CONTEXT context;
+    context.source = source;
+    context.type = EDM_DOUBLE_TYPE;
+    ASSERT_ARE_EQUAL(int, 0, strtod_operation(&context));
+
+    RunBenchmark(benchmarkName, strtod_operation, &context);
+}
+
+BEGIN_TEST_SUITE(serializer_perf)
+
+    TEST_SUITE_INITIALIZE(TestClassInitialize)
+    {
+        TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+        g_testByTest = TEST_MUTEX_CREATE();
+        ASSERT_IS_NOT_NULL(g_testByTest);
+        ASSERT_ARE_EQUAL(int, 0, gballoc_init());
+
+        ASSERT_ARE_EQUAL(int, (int)AGENT_DATA_TYPES_OK, (int)Create_AGENT_DATA_TYPE_from_charz(&telemetryValues[0], "cellular-device-000042"));
+        ASSERT_ARE_EQUAL(int, (int)AGENT_DATA_TYPES_OK, (int)Create_AGENT_DATA_TYPE_from_SINT32(&telemetryValues[1], 12));
+        ASSERT_ARE_EQUAL(int, (int)AGENT_DATA_TYPES_OK, (int)Create_AGENT_DATA_TYPE_from_DOUBLE(&telemetryValues[2], 21.5));
+        ASSERT_ARE_EQUAL(int, (int)AGENT_DATA_TYPES_OK, (int)Create_AGENT_DATA_TYPE_from_DOUBLE(&telemetryValues[3], 64.25));
+        ASSERT_ARE_EQUAL(int, (int)AGENT_DATA_TYPES_OK, (int)Create_EDM_BOOLEAN_from_int(&telemetryValues[4], 1));
+        ASSERT_ARE_EQUAL(int, (int)AGENT_DATA_TYPES_OK, (int)Create_AGENT_DATA_TYPE_from_DOUBLE(&telemetryValues[5], 47.6062));
+        ASSERT_ARE_EQUAL(int, (int)AGENT_DATA_TYPES_OK, (int)Create_AGENT_DATA_TYPE_from_DOUBLE(&telemetryValues[6], -122.3321));
+    }
+
+    TEST_SUITE_CLEANUP(TestClassCleanup)
+    {
+        size_t i;
+        for (i = 0; i < TELEMETRY_LEAF_COUNT; i++)
+        {
+            Destroy_AGENT_DATA_TYPE(&telemetryValues[i]);
+        }
+
+        gballoc_deinit();
+        TEST_MUTEX_DESTROY(g_testByTest);
+        TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    }
+
+    TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+    {
+        if (TEST_MUTEX_ACQUIRE(g_testByTest))
+        {
+            ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+        }
+    }
+
+    TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+    {
+        TEST_MUTEX_RELEASE(g_testByTest);
+    }
+
+    TEST_FUNCTION(JSONEncoder_EncodeTree_of_a_telemetry_message)
+    {
+        ///arrange
+        ENCODE_CONTEXT context;
+        context.tree = CreateTelemetryTree();
+        context.destination = STRING_new();
+        ASSERT_IS_NOT_NULL(context.destination);
+        ASSERT_ARE_EQUAL(int, 0, JSONEncoder_EncodeTree_operation(&context));
+
+        ///act
+        ///assert
+        RunBenchmark("JSONEncoder_EncodeTree", JSONEncoder_EncodeTree_operation, &context);
+
+        ///cleanup
+        STRING_delete(context.destination);
+        MultiTree_Destroy(context.tree);
+    }
+
+    TEST_FUNCTION(JSONDecoder_JSON_To_MultiTree_of_a_telemetry_message)
+    {
+        ///arrange
+        ENCODE_CONTEXT encodeContext;
+        DECODE_CONTEXT context;
+        encodeContext.tree = CreateTelemetryTree();
+        encodeContext.destination = STRING_new();
+        ASSERT_IS_NOT_NULL(encodeContext.destination);
+        ASSERT_ARE_EQUAL(int, 0, JSONEncoder_EncodeTree_operation(&encodeContext));
+        context.json = STRING_c_str(encodeContext.destination);
+        context.jsonSize = STRING_length(encodeContext.destination) + 1;
+        context.scratch = (char*)malloc(context.jsonSize);
+        ASSERT_IS_NOT_NULL(context.scratch);
+        ASSERT_ARE_EQUAL(int, 0, JSONDecoder_JSON_To_MultiTree_operation(&context));
+
+        ///act
+        ///assert
+        RunBenchmark("JSONDecoder_JSON_To_MultiTree", JSONDecoder_JSON_To_MultiTree_operation, &context);
+
+        ///cleanup
+        free(context.scratch);
+        STRING_delete(encodeContext.destination);
+        MultiTree_Destroy(encodeContext.tree);
+    }
+
+    TEST_FUNCTION(AgentDataTypes_ToString_of_a_DOUBLE)
+    {
+        ///arrange
+        ///act
+        ///assert
+        RunToStringBenchmark("AgentDataTypes_ToString/DOUBLE", &telemetryValues[2], "21.500000000000000");
+    }
+
+    TEST_FUNCTION(AgentDataTypes_ToString_of_a_SINT32)
+    {
+        ///arrange
+        ///act
+        ///assert
+        RunToStringBenchmark("AgentDataTypes_ToString/SINT32", &telemetryValues[1], "12");
+    }
+
+    TEST_FUNCTION(AgentDataTypes_ToString_of_a_charz)
+    {
+        ///arrange
+        ///act
+        ///assert
+        RunToStringBenchmark("AgentDataTypes_ToString/charz", &telemetryValues[0], "\"cellular-device-000042\"");
+    }
+
+    /*a desired temperature as a twin sends it, within the fast path*/
+    TEST_FUNCTION(CreateAgentDataType_From_String_of_a_DOUBLE_on_the_fast_path)
+    {
+        ///arrange
+        ///act
+        ///assert
+        RunDoubleFromStringBenchmark("CreateAgentDataType_From_String/DOUBLE/fast_path", "-122.3321");
+    }
+
+    /*a value printed with full precision has more digits than the fast path takes and goes to strtod*/
+    TEST_FUNCTION(CreateAgentDataType_From_String_of_a_DOUBLE_on_the_slow_path)
+    {
+        ///arrange
+        ///act
+        ///assert
+        RunDoubleFromStringBenchmark("CreateAgentDataType_From_String/DOUBLE/slow_path", "47.606200000000001182343112");
+    }
+
+    TEST_FUNCTION(strtod_of_the_fast_path_DOUBLE)
+    {
+        ///arrange
+        ///act
+        ///assert
+        RunStrtodBenchmark("strtod/DOUBLE/fast_path_input", "-122.3321");
+    }
+
+    TEST_FUNCTION(strtod_of_the_slow_path_DOUBLE)
+    {
+        ///arrange
+        ///act
+        ///assert
+        RunStrtodBenchmark("strtod/DOUBLE/slow_path_input", "47.606200000000001182343112");
+    }
+
+    TEST_FUNCTION(CreateAgentDataType_From_String_of_a_SINGLE_on_the_fast_path)
+    {
+        ///arrange
+        ///act
+        ///assert
+        RunSingleFromStringBenchmark("CreateAgentDataType_From_String/SINGLE/fast_path", "64.25");
+    }
+
+    /*the power of 10 is out of the range float multiplies exactly*/
+    TEST_FUNCTION(CreateAgentDataType_From_String_of_a_SINGLE_on_the_slow_path)
+    {
+        ///arrange
+        ///act
+        ///assert
+        RunSingleFromStringBenchmark("CreateAgentDataType_From_String/SINGLE/slow_path", "1.25e-12");
+    }
+
+    TEST_FUNCTION(CreateAgentDataType_From_String_of_a_DATE_TIME_OFFSET_in_UTC)
+    {
+        ///arrange
+        AGENT_DATA_TYPE parsed;
+
+        ///act
+        RunFromStringBenchmark("CreateAgentDataType_From_String/DATE_TIME_OFFSET/utc", "\"2017-06-01T12:34:56.789Z\"", EDM_DATE_TIME_OFFSET_TYPE, &parsed);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 117, parsed.value.edmDateTimeOffset.dateTime.tm_year);
+        ASSERT_ARE_EQUAL(int, 56, parsed.value.edmDateTimeOffset.dateTime.tm_sec);
+        ASSERT_ARE_EQUAL(int, 0, (int)parsed.value.edmDateTimeOffset.hasTimeZone);
+
+        ///cleanup
+        Destroy_AGENT_DATA_TYPE(&parsed);
+    }
+
+    TEST_FUNCTION(CreateAgentDataType_From_String_of_a_DATE_TIME_OFFSET_with_a_time_zone)
+    {
+        ///arrange
+        AGENT_DATA_TYPE parsed;
+
+        ///act
+        RunFromStringBenchmark("CreateAgentDataType_From_String/DATE_TIME_OFFSET/time_zone", "\"2017-06-01T12:34:56+08:00\"", EDM_DATE_TIME_OFFSET_TYPE, &parsed);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 1, (int)parsed.value.edmDateTimeOffset.hasTimeZone);
+        ASSERT_ARE_EQUAL(int, 8, (int)parsed.value.edmDateTimeOffset.timeZoneHour);
+
+        ///cleanup
+        Destroy_AGENT_DATA_TYPE(&parsed);
+    }
+
+END_TEST_SUITE(serializer_perf)